@@ -0,0 +1,83 @@
+# Runs a list of examples for a fixed number of frames and collects their results. Invoked by the RunBenchmarks target (see benchmark.cmake).
+#  Usage: cmake -DBENCHMARK_LIST=<file> -DOUTPUT_DIR=<folder> -DFRAMES=<N> -DFRAME_TIME=<ms> -DWIDTH=<N> -DHEIGHT=<N> -DTIMEOUT=<s> -P RunBenchmarks.cmake
+# BENCHMARK_LIST contains one "<name>|<executable>" line per example. For each example, OUTPUT_DIR receives:
+#  <name>.log             The output of the example
+#  <name>.benchmark.json  The frame time report written by -benchmark
+#  <name>_f<N>.tga        A screenshot of the last frame, if the example supports screenshots
+# along with summary.csv, containing a line of frame time statistics per example.
+cmake_minimum_required(VERSION 3.10)
+
+foreach(ARGUMENT BENCHMARK_LIST OUTPUT_DIR FRAMES FRAME_TIME WIDTH HEIGHT TIMEOUT)
+	if(NOT DEFINED ${ARGUMENT})
+		message(FATAL_ERROR "RunBenchmarks.cmake: ${ARGUMENT} was not defined")
+	endif()
+endforeach()
+
+# Extracts a numeric field from the (flat) report written by -benchmark
+function(read_report_value REPORT FIELD OUTPUT_VARIABLE)
+	if("${REPORT}" MATCHES "\"${FIELD}\": ([-+.0-9eE]+)")
+		set(${OUTPUT_VARIABLE} ${CMAKE_MATCH_1} PARENT_SCOPE)
+	else()
+		set(${OUTPUT_VARIABLE} "" PARENT_SCOPE)
+	endif()
+endfunction()
+
+file(STRINGS "${BENCHMARK_LIST}" BENCHMARK_ENTRIES)
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+# Frames are numbered from 0, and -quitafterframe renders the given frame before exiting
+math(EXPR LAST_FRAME "${FRAMES} - 1")
+set(SUMMARY "example,result,frames,meanMs,medianMs,p95Ms,p99Ms,minMs,maxMs\n")
+set(NUM_FAILED 0)
+
+foreach(ENTRY ${BENCHMARK_ENTRIES})
+	string(REPLACE "|" ";" ENTRY "${ENTRY}")
+	list(GET ENTRY 0 NAME)
+	list(GET ENTRY 1 EXECUTABLE)
+	get_filename_component(EXECUTABLE_DIR "${EXECUTABLE}" DIRECTORY)
+
+	# The examples write to the folder of their executable. Remove the results of previous runs so that they cannot be mistaken for this one's.
+	file(GLOB STALE_FILES "${EXECUTABLE_DIR}/${NAME}.benchmark.json" "${EXECUTABLE_DIR}/${NAME}_f*.tga" "${OUTPUT_DIR}/${NAME}.*" "${OUTPUT_DIR}/${NAME}_f*.tga")
+	if(STALE_FILES)
+		file(REMOVE ${STALE_FILES})
+	endif()
+
+	message(STATUS "Running ${NAME}")
+	execute_process(
+		COMMAND "${EXECUTABLE}" -qaf=${LAST_FRAME} -fft=${FRAME_TIME} -benchmark -c=${LAST_FRAME} -width=${WIDTH} -height=${HEIGHT} -fullscreen=0
+		WORKING_DIRECTORY "${EXECUTABLE_DIR}"
+		RESULT_VARIABLE RESULT
+		OUTPUT_VARIABLE OUTPUT
+		ERROR_VARIABLE OUTPUT
+		TIMEOUT ${TIMEOUT})
+	file(WRITE "${OUTPUT_DIR}/${NAME}.log" "${OUTPUT}")
+
+	file(GLOB SCREENSHOTS "${EXECUTABLE_DIR}/${NAME}_f*.tga")
+	if(SCREENSHOTS)
+		file(COPY ${SCREENSHOTS} DESTINATION "${OUTPUT_DIR}")
+	endif()
+
+	set(REPORT_FILE "${EXECUTABLE_DIR}/${NAME}.benchmark.json")
+	if(NOT "${RESULT}" STREQUAL "0" OR NOT EXISTS "${REPORT_FILE}")
+		message(WARNING "${NAME} failed (${RESULT}). See ${OUTPUT_DIR}/${NAME}.log")
+		string(APPEND SUMMARY "${NAME},failed,,,,,,,\n")
+		math(EXPR NUM_FAILED "${NUM_FAILED} + 1")
+		continue()
+	endif()
+
+	file(COPY "${REPORT_FILE}" DESTINATION "${OUTPUT_DIR}")
+	file(READ "${REPORT_FILE}" REPORT)
+	set(LINE "${NAME},success")
+	foreach(FIELD frameCount meanMs medianMs p95Ms p99Ms minMs maxMs)
+		read_report_value("${REPORT}" ${FIELD} VALUE)
+		string(APPEND LINE ",${VALUE}")
+	endforeach()
+	string(APPEND SUMMARY "${LINE}\n")
+	message(STATUS "${LINE}")
+endforeach()
+
+file(WRITE "${OUTPUT_DIR}/summary.csv" "${SUMMARY}")
+message(STATUS "Benchmark results written to ${OUTPUT_DIR}")
+if(NUM_FAILED GREATER 0)
+	message(FATAL_ERROR "${NUM_FAILED} example(s) failed to run")
+endif()
@@ -0,0 +1,58 @@
+cmake_minimum_required(VERSION 3.10)
+
+set(PVR_BENCHMARK_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/RunBenchmarks.cmake CACHE INTERNAL "")
+
+# Settings of the RunBenchmarks target. Every example is run for PVR_BENCHMARK_FRAMES frames with a fixed animation timestep of
+# PVR_BENCHMARK_FRAME_TIME milliseconds (-forceframetime), so that every run renders exactly the same sequence of frames.
+set(PVR_BENCHMARK_FRAMES "300" CACHE STRING "The number of frames each example renders when running the RunBenchmarks target")
+set(PVR_BENCHMARK_FRAME_TIME "16" CACHE STRING "The fixed timestep, in milliseconds, the examples animate with when running the RunBenchmarks target")
+set(PVR_BENCHMARK_WIDTH "1280" CACHE STRING "The width the examples render at when running the RunBenchmarks target")
+set(PVR_BENCHMARK_HEIGHT "800" CACHE STRING "The height the examples render at when running the RunBenchmarks target")
+set(PVR_BENCHMARK_TIMEOUT "600" CACHE STRING "The time, in seconds, after which an example is considered hung when running the RunBenchmarks target")
+set(PVR_BENCHMARK_OUTPUT_DIR "${CMAKE_BINARY_DIR}/benchmark" CACHE PATH "The folder the RunBenchmarks target collects frame time reports, screenshots and logs into")
+
+# Adds a RunBenchmarks target that runs every windowed (PVRShell) example added with add_platform_specific_executable so far,
+# collecting each example's frame time report (-benchmark), a screenshot of its last frame and its log into PVR_BENCHMARK_OUTPUT_DIR,
+# along with a summary.csv of all of them. Combined with -DPVR_WINDOW_SYSTEM=Headless, this allows running the examples on machines
+# without a display, for example using llvmpipe or lavapipe.
+#  Usage: add_benchmark_target()
+function(add_benchmark_target)
+	if(ANDROID OR IOS)
+		return()
+	endif()
+
+	get_property(EXAMPLE_TARGETS GLOBAL PROPERTY PVR_EXAMPLE_TARGETS)
+	set(BENCHMARK_TARGETS "")
+	set(BENCHMARK_LIST "")
+	foreach(TARGET_NAME ${EXAMPLE_TARGETS})
+		get_target_property(IS_COMMAND_LINE ${TARGET_NAME} COMMAND_LINE)
+		get_target_property(TARGET_LINK_LIBS ${TARGET_NAME} LINK_LIBRARIES)
+		# Command line examples (e.g. OpenCL) do not render, and only PVRShell examples understand the benchmark command line options
+		if(NOT IS_COMMAND_LINE AND TARGET_LINK_LIBS AND "PVRShell" IN_LIST TARGET_LINK_LIBS)
+			list(APPEND BENCHMARK_TARGETS ${TARGET_NAME})
+			string(APPEND BENCHMARK_LIST "${TARGET_NAME}|$<TARGET_FILE:${TARGET_NAME}>\n")
+		endif()
+	endforeach()
+
+	if(NOT BENCHMARK_TARGETS)
+		return()
+	endif()
+
+	set(BENCHMARK_LIST_FILE "${CMAKE_BINARY_DIR}/benchmark/$<CONFIG>/BenchmarkTargets.txt")
+	file(GENERATE OUTPUT "${BENCHMARK_LIST_FILE}" CONTENT "${BENCHMARK_LIST}")
+
+	add_custom_target(RunBenchmarks
+		COMMAND ${CMAKE_COMMAND}
+			"-DBENCHMARK_LIST=${BENCHMARK_LIST_FILE}"
+			"-DOUTPUT_DIR=${PVR_BENCHMARK_OUTPUT_DIR}"
+			"-DFRAMES=${PVR_BENCHMARK_FRAMES}"
+			"-DFRAME_TIME=${PVR_BENCHMARK_FRAME_TIME}"
+			"-DWIDTH=${PVR_BENCHMARK_WIDTH}"
+			"-DHEIGHT=${PVR_BENCHMARK_HEIGHT}"
+			"-DTIMEOUT=${PVR_BENCHMARK_TIMEOUT}"
+			-P "${PVR_BENCHMARK_SCRIPT}"
+		COMMENT "Running ${PVR_BENCHMARK_FRAMES} frames of each example"
+		USES_TERMINAL
+		VERBATIM)
+	add_dependencies(RunBenchmarks ${BENCHMARK_TARGETS})
+endfunction()
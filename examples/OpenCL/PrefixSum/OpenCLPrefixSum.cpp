@@ -6,6 +6,7 @@
 \brief        An example to illustrate Prefix Sum.
 ***********************************************************************************************************************/
 #include "PVRCore/PVRCore.h"
+#include "PVRCore/ParallelScan.h"
 
 #include "PVRUtils/OpenCL/OpenCLUtils.h"
 #include <iostream>
@@ -44,11 +45,13 @@ static void printHelp()
 	std::cout << "    -k                    : Name of kernel files (default = " << defaultKernelFile << ")" << std::endl;
 	std::cout << "    -n                    : Size of input vector (default = " << defaultDataSize << ")" << std::endl;
 	std::cout << "    -i                    : Number of iterations to run (default = " << defaultIterations << ")" << std::endl;
+	std::cout << "    -b                    : Benchmark mode: Sweeps the size of the input vector from 1024 up to -n, timing the CPU scans and the kernels for each size." << std::endl;
 }
 
 // Program globals, decoded from the command line
 static bool VERBOSE = false;
 static bool VALIDATE = false;
+static bool BENCHMARK = false;
 
 // Algorithms implemented
 enum AlgorithmId
@@ -212,6 +215,9 @@ static void performScan(Algorithm& algorithm, Setup& setup, Data& data, Timings&
 
 			scanIterations.push_back(scanIteration);
 
+			// The sum of a single block is never used, so there is no further level to scan. Carrying on would add a level of one
+			// element whenever the data size is a power of the block size, for which Blelloch would enqueue zero work-items.
+			if (thisNumBlocks == 1) { break; }
 			thisDataSize /= algorithm.blockSize;
 			thisInputBuffer = sumBuffer;
 			prevResultBuffer = resultBuffer;
@@ -290,6 +296,70 @@ static void calcCorrect(TYPE* inputData, TYPE* outputData, size_t dataSize)
 	for (int i = 1; i < dataSize; i++) { outputData[i] = outputData[i - 1] + inputData[i - 1]; }
 }
 
+// The CPU implementations the kernels are compared against
+enum CpuScanId
+{
+	CpuSerial = 0, // calcCorrect, one element at a time
+	CpuSimd, // pvr::async::scan, four elements at a time in SIMD registers
+	CpuParallel, // pvr::async::parallelScan, on all the CPU cores
+	NumCpuScans
+};
+const char* cpuScanNames[] = { "CPU serial", "CPU SIMD", "CPU parallel" };
+
+// Runs a CPU scan a number of times, returning the total time
+static float performCpuScan(CpuScanId id, Setup& setup, Data& data)
+{
+	pvr::Time time;
+	time.Reset();
+	for (int i = 0; i < setup.iterations; i++)
+	{
+		switch (id)
+		{
+		case CpuSerial: calcCorrect(data.inputData, data.correctData, setup.dataSize); break;
+		case CpuSimd: pvr::async::scan(data.inputData, data.resultData, setup.dataSize, pvr::async::ScanMode::Exclusive); break;
+		default: pvr::async::parallelScan(pvr::async::JobSystem::getInstance(), data.inputData, data.resultData, setup.dataSize, pvr::async::ScanMode::Exclusive); break;
+		}
+	}
+	return time.getElapsedMilliSecsF();
+}
+
+// Times every CPU scan, then every kernel, for each data size from 1024 up to the size given on the command line
+static void runBenchmark(Setup& setup, Data& data)
+{
+	const size_t maxDataSize = setup.dataSize;
+	std::vector<size_t> dataSizes;
+	for (size_t dataSize = 1024; dataSize < maxDataSize; dataSize *= 4) { dataSizes.push_back(dataSize); }
+	dataSizes.push_back(maxDataSize);
+
+	std::cout << "Milliseconds per scan, " << pvr::async::JobSystem::getInstance().getNumWorkers() + 1 << " CPU threads" << std::endl;
+	std::cout << std::left << std::setw(12) << "Size";
+	for (int i = 0; i < NumCpuScans; i++) { std::cout << std::setw(16) << cpuScanNames[i]; }
+	for (int i = 0; i < NumAlgorithms; i++) { std::cout << std::setw(16) << algorithms[i].name; }
+	std::cout << std::endl;
+
+	for (size_t dataSize : dataSizes)
+	{
+		setup.dataSize = dataSize;
+		std::vector<float> msPerScan;
+		for (int i = 0; i < NumCpuScans; i++)
+		{
+			msPerScan.push_back(performCpuScan(static_cast<CpuScanId>(i), setup, data) / setup.iterations);
+			if (VALIDATE && i != CpuSerial) { verifyResult(data.resultData, data.correctData, setup.dataSize); }
+		}
+		for (int i = 0; i < NumAlgorithms; i++)
+		{
+			Timings timings;
+			performScan(algorithms[i], setup, data, timings);
+			msPerScan.push_back(timings.kernelsTime / setup.iterations);
+		}
+
+		std::cout << std::left << std::setw(12) << dataSize;
+		for (float ms : msPerScan) { std::cout << std::setw(16) << ms; }
+		std::cout << std::endl;
+	}
+	setup.dataSize = maxDataSize;
+}
+
 // Sets things up
 static void doSetup(Setup& setup, const char* argv0, std::string& kernelFile)
 {
@@ -388,6 +458,7 @@ int main(int argc, char** argv)
 		cmdLine.getStringOption("-k", kernelFile);
 		cmdLine.getBoolOptionSetTrueIfPresent("-v", VERBOSE);
 		cmdLine.getBoolOptionSetTrueIfPresent("-va", VALIDATE);
+		cmdLine.getBoolOptionSetTrueIfPresent("-b", BENCHMARK);
 		bool help = false;
 		cmdLine.getBoolOptionSetTrueIfPresent("-h", help);
 		if (help)
@@ -419,9 +490,22 @@ int main(int argc, char** argv)
 		fillInput(data.inputData, setup.dataSize);
 		measureTimeDiff(time, "Generate input data");
 
-		// Calculate correct result
-		for (int i = 0; i < iterations; i++) { calcCorrect(data.inputData, data.correctData, setup.dataSize); }
-		float cpuMs = measureTimeDiff(time, "Calculate correct data");
+		if (BENCHMARK)
+		{
+			runBenchmark(setup, data);
+			cleanupSetup(setup);
+			return 0;
+		}
+
+		// Calculate correct result, and time the other CPU implementations against it
+		float cpuMs[NumCpuScans];
+		for (int i = 0; i < NumCpuScans; i++)
+		{
+			cpuMs[i] = performCpuScan(static_cast<CpuScanId>(i), setup, data);
+			std::cout << cpuScanNames[i] << " = " << cpuMs[i] << " ms" << std::endl;
+			if (VALIDATE && i != CpuSerial) { verifyResult(data.resultData, data.correctData, setup.dataSize); }
+		}
+		time.Reset();
 
 		// Run algorithms
 		for (int i = 0; i < NumAlgorithms; i++)
@@ -431,7 +515,8 @@ int main(int argc, char** argv)
 			std::cout << ">>>> " << algorithm.name << std::endl;
 			std::cout << "Block size = " << algorithm.blockSize << std::endl;
 			performScan(algorithm, setup, data, timings);
-			compareTimeMeasurements(cpuMs, timings.kernelsTime, "Kernels: ");
+			compareTimeMeasurements(cpuMs[CpuSerial], timings.kernelsTime, "Kernels vs CPU serial: ");
+			compareTimeMeasurements(cpuMs[CpuParallel], timings.kernelsTime, "Kernels vs CPU parallel: ");
 		}
 	}
 	catch (const std::exception& e)
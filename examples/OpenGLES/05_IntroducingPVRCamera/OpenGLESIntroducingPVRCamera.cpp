@@ -87,10 +87,19 @@ pvr::Result OpenGLESIntroducingPVRCamera::initView()
 		const char* attribNames[] = { "inVertex" };
 		uint16_t attribIndices[] = { 0 };
 		uint16_t numAttribs = 1;
+		// Cameras streaming YUV frames (e.g. on iOS, or NV12/YUYV cameras on Linux) are sampled through separate luma and chroma textures
+		std::vector<const char*> defines(Configuration::ShaderDefines, Configuration::ShaderDefines + Configuration::NumShaderDefines);
+		if (_camera.hasLumaChromaTextures()) { defines.push_back("LUMA_CHROMA=1"); }
 		_program = pvr::utils::createShaderProgram(*this, Configuration::VertexShaderFile, Configuration::FragShaderFile, attribNames, attribIndices, numAttribs,
-			Configuration::ShaderDefines, Configuration::NumShaderDefines);
+			defines.data(), static_cast<uint32_t>(defines.size()));
 		if (!_program) { return pvr::Result::UnknownError; }
 		_uvTransformLocation = gl::GetUniformLocation(_program, "uvTransform");
+		if (_camera.hasLumaChromaTextures())
+		{
+			gl::UseProgram(_program);
+			gl::Uniform1i(gl::GetUniformLocation(_program, "SamplerY"), 0);
+			gl::Uniform1i(gl::GetUniformLocation(_program, "SamplerUV"), 1);
+		}
 	}
 	_uiRenderer.init(getWidth(), getHeight(), isFullScreen(), getBackBufferColorspace() == pvr::ColorSpace::sRGB);
 	_uiRenderer.getDefaultDescription()->setText("Streaming of hardware Camera video preview");
@@ -0,0 +1,339 @@
+/*!*********************************************************************************************************************
+\File			CpuGemm.cpp
+\Title			Source file for the CPU implementations of the matrix multiplication
+\Author			PowerVR by Imagination, Developer Technology Team.
+\Copyright		Copyright(c) Imagination Technologies Limited.
+\brief			Adds the implementations for all the kernels within CpuGemm.h. The optimised kernels follow the usual
+				structure of a high performance GEMM: blocks of B and A are packed into contiguous panels sized for the
+				caches, and a register blocked micro-kernel computes a small tile of C from one sliver of each panel.
+***********************************************************************************************************************/
+#include "CpuGemm.h"
+#include "PVRCore/JobSystem.h"
+#include "PVRCore/Simd.h"
+#include <cstring>
+
+#if defined(PVR_SIMD_SSE)
+#include <immintrin.h>
+// The AVX2 micro-kernel is compiled regardless of the compiler flags, and only selected if the CPU supports it.
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CPU_GEMM_AVX2 1
+#define CPU_GEMM_AVX2_TARGET
+#elif defined(__GNUC__) || defined(__clang__)
+#define CPU_GEMM_AVX2 1
+#define CPU_GEMM_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace CpuGemm {
+namespace {
+// The number of rows of B (and columns of A) packed at once. A sliver of each packed panel fits in the L1 cache.
+const uint32_t BlockN = 256;
+// The number of rows of A packed at once, a multiple of the number of rows of every micro-kernel. Sized for the L2 cache.
+const uint32_t BlockM = 96;
+// The number of columns of B packed at once. Sized for the L3 cache.
+const uint32_t BlockP = 2048;
+// The number of columns of a packed panel of B processed by each multithreaded task, a multiple of the number of columns
+// of every micro-kernel. Splitting the columns as well as the rows gives enough tasks to keep every thread busy.
+const uint32_t TaskColumns = 256;
+// The largest tile of C computed by a micro-kernel
+const uint32_t MaxTileSize = 128;
+
+// Computes c += a * b for one (mr x nr) tile of C, where a is a sliver of mr rows of a packed block of A, and b a sliver
+// of nr columns of a packed panel of B, both kc deep.
+typedef void (*MicroKernelFunction)(uint32_t kc, const float* a, const float* b, float* c, size_t ldc);
+
+struct MicroKernel
+{
+	uint32_t mr;
+	uint32_t nr;
+	MicroKernelFunction function;
+	const char* instructionSet;
+};
+
+template<uint32_t MR, uint32_t NR>
+void microKernelScalar(uint32_t kc, const float* a, const float* b, float* c, size_t ldc)
+{
+	float acc[MR][NR] = {};
+	for (uint32_t k = 0; k < kc; ++k, a += MR, b += NR)
+	{
+		for (uint32_t r = 0; r < MR; ++r)
+		{
+			for (uint32_t col = 0; col < NR; ++col) { acc[r][col] += a[r] * b[col]; }
+		}
+	}
+	for (uint32_t r = 0; r < MR; ++r)
+	{
+		for (uint32_t col = 0; col < NR; ++col) { c[r * ldc + col] += acc[r][col]; }
+	}
+}
+
+#if defined(PVR_SIMD_SSE)
+// 4x8 tile, 8 accumulators
+void microKernelSse(uint32_t kc, const float* a, const float* b, float* c, size_t ldc)
+{
+	__m128 acc[4][2];
+	for (uint32_t r = 0; r < 4; ++r) { acc[r][0] = acc[r][1] = _mm_setzero_ps(); }
+	for (uint32_t k = 0; k < kc; ++k, a += 4, b += 8)
+	{
+		const __m128 b0 = _mm_loadu_ps(b);
+		const __m128 b1 = _mm_loadu_ps(b + 4);
+		for (uint32_t r = 0; r < 4; ++r)
+		{
+			const __m128 ar = _mm_set1_ps(a[r]);
+			acc[r][0] = _mm_add_ps(acc[r][0], _mm_mul_ps(ar, b0));
+			acc[r][1] = _mm_add_ps(acc[r][1], _mm_mul_ps(ar, b1));
+		}
+	}
+	for (uint32_t r = 0; r < 4; ++r, c += ldc)
+	{
+		_mm_storeu_ps(c, _mm_add_ps(_mm_loadu_ps(c), acc[r][0]));
+		_mm_storeu_ps(c + 4, _mm_add_ps(_mm_loadu_ps(c + 4), acc[r][1]));
+	}
+}
+#endif
+
+#if defined(CPU_GEMM_AVX2)
+// 6x16 tile, 12 accumulators, leaving 4 of the 16 ymm registers for the slivers of A and B
+CPU_GEMM_AVX2_TARGET void microKernelAvx2(uint32_t kc, const float* a, const float* b, float* c, size_t ldc)
+{
+	__m256 acc[6][2];
+	for (uint32_t r = 0; r < 6; ++r) { acc[r][0] = acc[r][1] = _mm256_setzero_ps(); }
+	for (uint32_t k = 0; k < kc; ++k, a += 6, b += 16)
+	{
+		const __m256 b0 = _mm256_loadu_ps(b);
+		const __m256 b1 = _mm256_loadu_ps(b + 8);
+		for (uint32_t r = 0; r < 6; ++r)
+		{
+			const __m256 ar = _mm256_broadcast_ss(a + r);
+			acc[r][0] = _mm256_fmadd_ps(ar, b0, acc[r][0]);
+			acc[r][1] = _mm256_fmadd_ps(ar, b1, acc[r][1]);
+		}
+	}
+	for (uint32_t r = 0; r < 6; ++r, c += ldc)
+	{
+		_mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), acc[r][0]));
+		_mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), acc[r][1]));
+	}
+}
+
+bool cpuSupportsAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) { return false; }
+	__cpuid(info, 1);
+	const bool fma = (info[2] & (1 << 12)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	// The OS must also save the ymm registers on context switches
+	if (!fma || !osxsave || (_xgetbv(0) & 6) != 6) { return false; }
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+#if defined(PVR_SIMD_NEON)
+// 4x8 tile, 8 accumulators
+void microKernelNeon(uint32_t kc, const float* a, const float* b, float* c, size_t ldc)
+{
+	float32x4_t acc[4][2];
+	for (uint32_t r = 0; r < 4; ++r) { acc[r][0] = acc[r][1] = vdupq_n_f32(0.f); }
+	for (uint32_t k = 0; k < kc; ++k, a += 4, b += 8)
+	{
+		const float32x4_t b0 = vld1q_f32(b);
+		const float32x4_t b1 = vld1q_f32(b + 4);
+		for (uint32_t r = 0; r < 4; ++r)
+		{
+			acc[r][0] = vmlaq_n_f32(acc[r][0], b0, a[r]);
+			acc[r][1] = vmlaq_n_f32(acc[r][1], b1, a[r]);
+		}
+	}
+	for (uint32_t r = 0; r < 4; ++r, c += ldc)
+	{
+		vst1q_f32(c, vaddq_f32(vld1q_f32(c), acc[r][0]));
+		vst1q_f32(c + 4, vaddq_f32(vld1q_f32(c + 4), acc[r][1]));
+	}
+}
+#endif
+
+const MicroKernel ScalarMicroKernel = { 4, 8, microKernelScalar<4, 8>, "scalar" };
+
+MicroKernel selectSimdMicroKernel()
+{
+#if defined(CPU_GEMM_AVX2)
+	if (cpuSupportsAvx2()) { return MicroKernel{ 6, 16, microKernelAvx2, "AVX2+FMA" }; }
+#endif
+#if defined(PVR_SIMD_SSE)
+	return MicroKernel{ 4, 8, microKernelSse, "SSE" };
+#elif defined(PVR_SIMD_NEON)
+	return MicroKernel{ 4, 8, microKernelNeon, "NEON" };
+#else
+	return ScalarMicroKernel;
+#endif
+}
+
+const MicroKernel& getSimdMicroKernel()
+{
+	static const MicroKernel microKernel = selectSimdMicroKernel();
+	return microKernel;
+}
+
+// Packs the (mc x kc) block of A into slivers of mr rows, each stored column by column and padded with zeros.
+void packA(const MicroKernel& microKernel, uint32_t mc, uint32_t kc, const float* A, size_t lda, float* packed)
+{
+	for (uint32_t i0 = 0; i0 < mc; i0 += microKernel.mr)
+	{
+		const uint32_t rows = std::min(microKernel.mr, mc - i0);
+		for (uint32_t k = 0; k < kc; ++k)
+		{
+			for (uint32_t r = 0; r < rows; ++r) { *packed++ = A[(i0 + r) * lda + k]; }
+			for (uint32_t r = rows; r < microKernel.mr; ++r) { *packed++ = 0.f; }
+		}
+	}
+}
+
+// Packs the slivers [sliverBegin, sliverEnd) of nr columns of the (kc x pc) panel of B, each stored row by row and padded
+// with zeros.
+void packB(const MicroKernel& microKernel, uint32_t kc, uint32_t pc, const float* B, size_t ldb, float* packed, uint32_t sliverBegin, uint32_t sliverEnd)
+{
+	for (uint32_t sliver = sliverBegin; sliver < sliverEnd; ++sliver)
+	{
+		const uint32_t j0 = sliver * microKernel.nr;
+		const uint32_t columns = std::min(microKernel.nr, pc - j0);
+		float* destination = packed + static_cast<size_t>(j0) * kc;
+		for (uint32_t k = 0; k < kc; ++k)
+		{
+			const float* source = B + k * ldb + j0;
+			for (uint32_t col = 0; col < columns; ++col) { *destination++ = source[col]; }
+			for (uint32_t col = columns; col < microKernel.nr; ++col) { *destination++ = 0.f; }
+		}
+	}
+}
+
+// Accumulates the product of a packed (mc x kc) block of A and the slivers [sliverBegin, sliverEnd) of a packed panel of
+// B, pc columns wide, into C.
+void multiplyPacked(const MicroKernel& microKernel, uint32_t mc, uint32_t kc, uint32_t pc, const float* packedA, const float* packedB, uint32_t sliverBegin,
+	uint32_t sliverEnd, float* C, size_t ldc)
+{
+	float tile[MaxTileSize];
+	for (uint32_t sliver = sliverBegin; sliver < sliverEnd; ++sliver)
+	{
+		const uint32_t j0 = sliver * microKernel.nr;
+		const uint32_t columns = std::min(microKernel.nr, pc - j0);
+		const float* b = packedB + static_cast<size_t>(j0) * kc;
+		for (uint32_t i0 = 0; i0 < mc; i0 += microKernel.mr)
+		{
+			const uint32_t rows = std::min(microKernel.mr, mc - i0);
+			const float* a = packedA + static_cast<size_t>(i0) * kc;
+			float* c = C + i0 * ldc + j0;
+			if (rows == microKernel.mr && columns == microKernel.nr) { microKernel.function(kc, a, b, c, ldc); }
+			else
+			{
+				// Partial tiles at the edges of C are computed in full, and only their valid part is accumulated
+				memset(tile, 0, sizeof(float) * microKernel.mr * microKernel.nr);
+				microKernel.function(kc, a, b, tile, microKernel.nr);
+				for (uint32_t r = 0; r < rows; ++r)
+				{
+					for (uint32_t col = 0; col < columns; ++col) { c[r * ldc + col] += tile[r * microKernel.nr + col]; }
+				}
+			}
+		}
+	}
+}
+
+void multiplyNaive(uint32_t M, uint32_t N, uint32_t P, const float* A, const float* B, float* C)
+{
+	for (size_t y = 0; y < M; y++)
+	{
+		for (size_t x = 0; x < P; x++)
+		{
+			// for each cell in the new array calculate the sum
+			float sum = 0;
+			for (size_t k = 0; k < N; k++) { sum += A[y * N + k] * B[k * P + x]; }
+			C[y * P + x] = sum;
+		}
+	}
+}
+
+void multiplyBlocked(const MicroKernel& microKernel, bool multithreaded, uint32_t M, uint32_t N, uint32_t P, const float* A, const float* B, float* C)
+{
+	assert(microKernel.mr * microKernel.nr <= MaxTileSize && BlockM % microKernel.mr == 0 && TaskColumns % microKernel.nr == 0);
+	std::fill(C, C + static_cast<size_t>(M) * P, 0.f);
+
+	const uint32_t maxSlivers = (std::min(BlockP, P) + microKernel.nr - 1) / microKernel.nr;
+	std::vector<float> packedB(static_cast<size_t>(BlockN) * maxSlivers * microKernel.nr);
+	std::vector<float> packedA(multithreaded ? 0 : static_cast<size_t>(BlockM) * BlockN);
+	pvr::async::JobSystem& jobSystem = pvr::async::JobSystem::getInstance();
+
+	for (uint32_t jc = 0; jc < P; jc += BlockP)
+	{
+		const uint32_t pc = std::min(BlockP, P - jc);
+		const uint32_t numSlivers = (pc + microKernel.nr - 1) / microKernel.nr;
+		for (uint32_t kc0 = 0; kc0 < N; kc0 += BlockN)
+		{
+			const uint32_t kc = std::min(BlockN, N - kc0);
+			const float* blockB = B + static_cast<size_t>(kc0) * P + jc;
+
+			if (!multithreaded)
+			{
+				packB(microKernel, kc, pc, blockB, P, packedB.data(), 0, numSlivers);
+				for (uint32_t ic = 0; ic < M; ic += BlockM)
+				{
+					const uint32_t mc = std::min(BlockM, M - ic);
+					packA(microKernel, mc, kc, A + static_cast<size_t>(ic) * N + kc0, N, packedA.data());
+					multiplyPacked(microKernel, mc, kc, pc, packedA.data(), packedB.data(), 0, numSlivers, C + static_cast<size_t>(ic) * P + jc, P);
+				}
+				continue;
+			}
+
+			// Pack the panel of B once, shared by all the threads, then split its product with every block of A into
+			// tasks of TaskColumns columns. Each task packs its own block of A.
+			jobSystem.parallelFor(0, numSlivers, 8, [&](uint32_t sliverBegin, uint32_t sliverEnd) { packB(microKernel, kc, pc, blockB, P, packedB.data(), sliverBegin, sliverEnd); });
+
+			const uint32_t sliversPerTask = TaskColumns / microKernel.nr;
+			const uint32_t tasksPerBlock = (numSlivers + sliversPerTask - 1) / sliversPerTask;
+			const uint32_t numBlocks = (M + BlockM - 1) / BlockM;
+			jobSystem.parallelFor(0, numBlocks * tasksPerBlock, 1, [&](uint32_t taskBegin, uint32_t taskEnd) {
+				thread_local std::vector<float> threadPackedA;
+				threadPackedA.resize(static_cast<size_t>(BlockM) * BlockN);
+				for (uint32_t task = taskBegin; task < taskEnd; ++task)
+				{
+					const uint32_t ic = (task / tasksPerBlock) * BlockM;
+					const uint32_t mc = std::min(BlockM, M - ic);
+					const uint32_t sliverBegin = (task % tasksPerBlock) * sliversPerTask;
+					packA(microKernel, mc, kc, A + static_cast<size_t>(ic) * N + kc0, N, threadPackedA.data());
+					multiplyPacked(microKernel, mc, kc, pc, threadPackedA.data(), packedB.data(), sliverBegin, std::min(numSlivers, sliverBegin + sliversPerTask),
+						C + static_cast<size_t>(ic) * P + jc, P);
+				}
+			});
+		}
+	}
+}
+} // namespace
+
+const char* getKernelName(Kernel kernel)
+{
+	static const char* names[] = { "cpu_naive", "cpu_blocked", "cpu_simd", "cpu_simd_mt" };
+	assert(kernel < Kernel::Count);
+	return names[static_cast<uint32_t>(kernel)];
+}
+
+const char* getSimdInstructionSet() { return getSimdMicroKernel().instructionSet; }
+
+void multiply(Kernel kernel, uint32_t M, uint32_t N, uint32_t P, const float* A, const float* B, float* C)
+{
+	switch (kernel)
+	{
+	case Kernel::Naive: multiplyNaive(M, N, P, A, B, C); break;
+	case Kernel::Blocked: multiplyBlocked(ScalarMicroKernel, false, M, N, P, A, B, C); break;
+	case Kernel::Simd: multiplyBlocked(getSimdMicroKernel(), false, M, N, P, A, B, C); break;
+	case Kernel::SimdMultithreaded: multiplyBlocked(getSimdMicroKernel(), true, M, N, P, A, B, C); break;
+	default: assert(false && "Unknown CPU matrix multiplication kernel");
+	}
+}
+} // namespace CpuGemm
@@ -0,0 +1,44 @@
+/*!*********************************************************************************************************************
+\File			CpuGemm.h
+\Title			Header file for the CPU implementations of the matrix multiplication
+\Author			PowerVR by Imagination, Developer Technology Team.
+\Copyright		Copyright(c) Imagination Technologies Limited.
+\brief			A CPU SGEMM engine, used as the reference the GPU results are validated against, as the CPU side of the
+				CPU/GPU comparison, and as a fallback on devices without a compute queue. Provides several variants of
+				increasing sophistication so that the benefit of each optimisation can be measured.
+***********************************************************************************************************************/
+#pragma once
+#include <PVRCore/PVRCore.h>
+
+namespace CpuGemm {
+/// <summary>The CPU implementations of C = A * B</summary>
+enum class Kernel
+{
+	Naive, ///< One dot product per element of C, straight from the unpacked matrices
+	Blocked, ///< Cache blocked, with A and B packed into contiguous panels, and a scalar micro-kernel
+	Simd, ///< Same as Blocked, but with a SIMD (AVX2+FMA, SSE or NEON) micro-kernel
+	SimdMultithreaded, ///< Same as Simd, but the blocks are shared between the threads of the pvr::async::JobSystem
+	Count
+};
+
+/// <summary>Get the name of a kernel, as used on the command line</summary>
+/// <param name="kernel">A kernel</param>
+/// <returns>The name of the kernel, e.g. "cpu_simd_mt"</returns>
+const char* getKernelName(Kernel kernel);
+
+/// <summary>Get the instruction set used by the SIMD micro-kernel on this CPU</summary>
+/// <returns>"AVX2+FMA", "SSE", "NEON" or "scalar"</returns>
+const char* getSimdInstructionSet();
+
+/// <summary>
+/// Calculates C = A * B. All the matrices are tightly packed and row major, matching the Matrix struct.
+/// </summary>
+/// <param name="kernel">The implementation to use</param>
+/// <param name="M">The height of A and C</param>
+/// <param name="N">The width of A and the height of B</param>
+/// <param name="P">The width of B and C</param>
+/// <param name="A">The (MxN) left hand side</param>
+/// <param name="B">The (NxP) right hand side</param>
+/// <param name="C">The (MxP) product. Must not alias A or B</param>
+void multiply(Kernel kernel, uint32_t M, uint32_t N, uint32_t P, const float* A, const float* B, float* C);
+} // namespace CpuGemm
@@ -6,6 +6,7 @@
 \brief			Adds the implementations for all the methods within Matrix.h
 ***********************************************************************************************************************/
 #include "Matrix.h"
+#include "CpuGemm.h"
 #include <iomanip>
 
 Matrix::Matrix(uint32_t height, uint32_t width, float* m) : _width(width), _height(height) { _m = m; }
@@ -39,17 +40,8 @@ Matrix Matrix::matMul(Matrix lhs, Matrix rhs)
 	size_t newHeight = lhs.getHeight();
 	float* m;
 	m = new float[newWidth * newHeight];
-	// begin the multiplication
-	for (size_t y = 0; y < newHeight; y++)
-	{
-		for (size_t x = 0; x < newWidth; x++)
-		{
-			// for each cell in the new array calculate the sum
-			float sum = 0;
-			for (size_t k = 0; k < lhs.getWidth(); k++) { sum += lhs(k, y) * rhs(x, k); }
-			m[y * newWidth + x] = sum;
-		}
-	}
+	// use the fastest CPU implementation, the naive one is only kept as a baseline for the CPU benchmark
+	CpuGemm::multiply(CpuGemm::Kernel::SimdMultithreaded, lhs.getHeight(), lhs.getWidth(), rhs.getWidth(), lhs.data(), rhs.data(), m);
 	return Matrix((uint32_t)newHeight, (uint32_t)newWidth, m);
 }
 
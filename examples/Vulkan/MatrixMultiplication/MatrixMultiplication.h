@@ -8,6 +8,7 @@
 
 #pragma once
 #include "Matrix.h"
+#include "CpuGemm.h"
 
 /// <summary>
 /// Runs the shaders which have been selected by the list of booleans
@@ -15,7 +16,15 @@
 /// <param name="benchmarksToRun">The list of benchmarks to run by their index</param>
 /// <param name="validate">If a CPU Matrix multiplication should be performed to verify the correctness of shader calculations</param>
 /// <param name="pathToExecutable">Used for reading in the shaders by their absolute path if regular readin fails</param>
-void runBenchmarksWithList(bool benchmarksToRun[], bool validate, char* pathToExecutable);
+/// <returns>False if the shaders could not be run because there is no Vulkan device with a compute queue</returns>
+bool runBenchmarksWithList(bool benchmarksToRun[], bool validate, char* pathToExecutable);
+
+/// <summary>
+/// Times the CPU implementations selected by the list of booleans, for each of the matrix sizes to benchmark
+/// </summary>
+/// <param name="kernelsToRun">The list of CPU kernels to run by their index</param>
+/// <param name="validate">If the results should be checked against the naive CPU implementation</param>
+void runCpuBenchmark(bool kernelsToRun[], bool validate);
 
 // Used for timing shader execution
 pvr::Time timer;
@@ -46,6 +55,11 @@ int32_t p_tile_size = 16;
 // The precision that matricies are confirmed to in validation
 float epsilon = 0.01f;
 
+// The number of times each CPU kernel is run, the fastest run is reported
+int32_t cpu_runs = 3;
+// The square matrix sizes the CPU kernels are benchmarked with, if empty M, N and P are used
+std::vector<int32_t> cpu_sizes;
+
 std::string Names[numberOfTotalTests] = { "mat_mul_naive_AT", "mat_mul_naive_BT", "mat_mul_naive_CT", "mat_mul_naive_ATCT", "mat_mul_naive_BTCT", "mat_mul_linearwg_AT",
 	"mat_mul_linearwg_BT", "mat_mul_linearwg_vec4", "mat_mul_linearwg_vec4_local", "mat_mul_tile", "mat_mul_tile_vec4", "mat_mul_tile_WF", "mat_mul_rect" };
 
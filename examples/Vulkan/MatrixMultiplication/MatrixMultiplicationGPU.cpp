@@ -29,7 +29,7 @@ uint32_t Mat_P = 0;
 
 pvr::FilePath pathToExe = pvr::FilePath("temp");
 
-void initiateVulkan(char* pathToExecutable)
+bool initiateVulkan(char* pathToExecutable)
 {
 	// store the executable path for loading the shaders later
 	pathToExe = pvr::FilePath(pathToExecutable);
@@ -43,7 +43,7 @@ void initiateVulkan(char* pathToExecutable)
 	if (_resources->instance->getNumPhysicalDevices() == 0)
 	{
 		std::cout << std::endl << "There are no vulkan enabled devices connected" << std::endl;
-		exit(-1);
+		return false;
 	}
 
 	// create debug callbacks
@@ -53,7 +53,20 @@ void initiateVulkan(char* pathToExecutable)
 	const pvr::utils::QueuePopulateInfo queuePopulateInfo = { pvrvk::QueueFlags::e_COMPUTE_BIT };
 	pvr::utils::QueueAccessInfo queueAccessInfo;
 	// create the device and retrieve the caommand queue from it
-	_resources->device = pvr::utils::createDeviceAndQueues(_resources->instance->getPhysicalDevice(0), &queuePopulateInfo, 1, &queueAccessInfo);
+	try
+	{
+		_resources->device = pvr::utils::createDeviceAndQueues(_resources->instance->getPhysicalDevice(0), &queuePopulateInfo, 1, &queueAccessInfo);
+	}
+	catch (pvrvk::Error const& err)
+	{
+		std::cout << std::endl << "Could not create a vulkan device with a compute queue: " << err.what() << std::endl;
+		return false;
+	}
+	if (queueAccessInfo.familyId == static_cast<uint32_t>(-1))
+	{
+		std::cout << std::endl << "The vulkan device does not have a compute queue" << std::endl;
+		return false;
+	}
 	_resources->commandQueue = _resources->device->getQueue(queueAccessInfo.familyId, queueAccessInfo.queueId);
 	_resources->commandQueue->setObjectName("ComputeQueue");
 
@@ -73,6 +86,7 @@ void initiateVulkan(char* pathToExecutable)
 	descPoolCreateInfo.setMaxDescriptorSets(1);
 	_resources->descriptorPool = _resources->device->createDescriptorPool(descPoolCreateInfo);
 	_resources->descriptorPool->setObjectName("DescriptorPool");
+	return true;
 }
 
 void makeDescriptors()
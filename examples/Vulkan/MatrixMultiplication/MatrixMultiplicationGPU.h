@@ -50,7 +50,8 @@ struct DeviceResources
 /// <summary>
 /// Creates the device resources struct and then begins instancing the vulkan variables
 /// </summary>
-void initiateVulkan(char* pathToExecutable);
+/// <returns>False if there is no Vulkan device with a compute queue, in which case only the CPU can be benchmarked</returns>
+bool initiateVulkan(char* pathToExecutable);
 
 /// <summary>
 /// Creates the descriptor sets that the pipeline will use to find and use the buffers
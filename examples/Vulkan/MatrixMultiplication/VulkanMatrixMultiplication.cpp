@@ -10,6 +10,8 @@
 #include <PVRCore/PVRCore.h>
 #include "MatrixMultiplicationGPU.h"
 #include "MatrixMultiplication.h"
+#include "PVRCore/JobSystem.h"
+#include <array>
 
 /// <summary>
 /// Prints the supported command line paramaters.
@@ -22,8 +24,7 @@ void printHelp()
 	std::cout << std::left << std::setw(20) << "\t-i"
 			  << "Displays information about what this benchmark does." << std::endl;
 	std::cout << std::left << std::setw(20) << "\t-va"
-			  << "Produces a niave CPU multiplication and stores the result to check against the GPU results to validate their correctness.";
-	std::cout << " Will take an order of magnitude longer than the GPU." << std::endl;
+			  << "Produces a CPU multiplication and stores the result to check against the GPU results to validate their correctness." << std::endl;
 	std::cout << std::left << std::setw(20) << "\t-shaders=[names]";
 	std::cout << "Will run the specified shaders by name, shader names are specificed as a list of comma seperated values. If left empty this will run all tests in a demo mode"
 			  << std::endl;
@@ -57,6 +58,25 @@ void printHelp()
 	std::cout << std::left << std::setw(27) << " " << std::left << std::setw(30) << "mat_mul_rect";
 	std::cout << "A generalisation of the square tiling, each invocation produces one cell in the product" << std::endl;
 
+	std::cout << std::left << std::setw(20) << "\t-cpu_benchmark";
+	std::cout << "Times the CPU implementations before the shaders, reporting the GFLOPS of each. With -va they are validated against cpu_naive" << std::endl;
+	std::cout << std::left << std::setw(20) << "\t-cpu_only";
+	std::cout << "Only runs the CPU benchmark. The CPU benchmark is also run when no Vulkan device with a compute queue is found" << std::endl;
+	std::cout << std::left << std::setw(20) << "\t-cpu_kernels=[names]";
+	std::cout << "Will run the specified CPU implementations by name, as a list of comma seperated values. If left empty this will run all of them" << std::endl;
+	std::cout << std::left << std::setw(27) << " " << std::left << std::setw(30) << "cpu_naive";
+	std::cout << "One dot product per cell of the product, no optimisations" << std::endl;
+	std::cout << std::left << std::setw(27) << " " << std::left << std::setw(30) << "cpu_blocked";
+	std::cout << "Cache blocked, the matrices are packed into contiguous panels, and a scalar micro-kernel computes small tiles of the product" << std::endl;
+	std::cout << std::left << std::setw(27) << " " << std::left << std::setw(30) << "cpu_simd";
+	std::cout << "Same as cpu_blocked, with an AVX2, SSE or NEON micro-kernel" << std::endl;
+	std::cout << std::left << std::setw(27) << " " << std::left << std::setw(30) << "cpu_simd_mt";
+	std::cout << "Same as cpu_simd, with the tiles shared between all the CPU cores. This is the one used for -va" << std::endl;
+	std::cout << std::left << std::setw(20) << "\t-cpu_sizes=[sizes]";
+	std::cout << "Benchmarks the CPU implementations with square matrices of each of the comma seperated sizes instead of M, N and P" << std::endl;
+	std::cout << std::left << std::setw(20) << "\t-cpu_runs=";
+	std::cout << "Sets the number of times each CPU implementation is run, the fastest run is reported" << std::endl;
+
 	std::cout << std::left << std::setw(20) << "\t-M=";
 	std::cout << "Sets the height of matrices A and C" << std::endl;
 	std::cout << std::left << std::setw(20) << "\t-N=";
@@ -134,6 +154,7 @@ int main(int argc, char** argv)
 		std::cout << std::left << std::setw(20) << "\t-tile_m=" << TestVariables::m_tile_size << std::endl;
 		std::cout << std::left << std::setw(20) << "\t-tile_n=" << TestVariables::n_tile_size << std::endl;
 		std::cout << std::left << std::setw(20) << "\t-tile_p=" << TestVariables::p_tile_size << std::endl;
+		std::cout << std::left << std::setw(20) << "\t-cpu_runs=" << TestVariables::cpu_runs << std::endl;
 		exit(0);
 	}
 
@@ -165,6 +186,27 @@ int main(int argc, char** argv)
 		std::cout << "Running demo version" << std::endl;
 	}
 
+	// Decide which CPU implementations to benchmark, all of them unless the user specifies some
+	bool cpuBenchmark = false;
+	bool cpuOnly = false;
+	cmdLine.getBoolOptionSetTrueIfPresent("-cpu_benchmark", cpuBenchmark);
+	cmdLine.getBoolOptionSetTrueIfPresent("-cpu_only", cpuOnly);
+	bool cpuKernelsToRun[static_cast<size_t>(CpuGemm::Kernel::Count)] = { true, true, true, true };
+	std::vector<std::string> cpuKernelNames;
+	if (cmdLine.getStringOptionList("-cpu_kernels", cpuKernelNames))
+	{
+		for (size_t j = 0; j < static_cast<size_t>(CpuGemm::Kernel::Count); j++)
+		{
+			cpuKernelsToRun[j] = std::find(cpuKernelNames.begin(), cpuKernelNames.end(), CpuGemm::getKernelName(static_cast<CpuGemm::Kernel>(j))) != cpuKernelNames.end();
+		}
+	}
+	std::vector<std::string> cpuSizes;
+	if (cmdLine.getStringOptionList("-cpu_sizes", cpuSizes))
+	{
+		for (const std::string& size : cpuSizes) { TestVariables::cpu_sizes.push_back(std::stoi(size)); }
+	}
+	cmdLine.getIntOption("-cpu_runs", TestVariables::cpu_runs);
+
 	// now take the user input for the matrix dimensions
 	cmdLine.getIntOption("-M", TestVariables::M);
 	cmdLine.getIntOption("-m", TestVariables::M);
@@ -202,11 +244,105 @@ int main(int argc, char** argv)
 	std::cout << "Done! " << std::left << std::setw(5) << timer.getElapsedMilliSecs() << " (ms)" << std::endl;
 	timer.Reset();
 
-	// run the appropriate list of benchmarks
-	runBenchmarksWithList(testToRun, validate, argv[0]);
+	// run the CPU implementations first, so that the shaders can be compared against them
+	if (cpuBenchmark || cpuOnly) { runCpuBenchmark(cpuKernelsToRun, validate); }
+
+	// run the appropriate list of benchmarks, the CPU is the fallback if there is no device to run them on
+	if (!cpuOnly && !runBenchmarksWithList(testToRun, validate, argv[0]) && !cpuBenchmark)
+	{
+		std::cout << "==Vulkan compute is not available, running the CPU benchmark instead" << std::endl;
+		runCpuBenchmark(cpuKernelsToRun, validate);
+	}
+}
+
+/// <summary>
+/// Formats the number of floating point operations per second of a matrix multiplication
+/// </summary>
+std::string toGflopsString(uint32_t M, uint32_t N, uint32_t P, float microSecs)
+{
+	// every cell of the (MxP) product takes N multiplications and N additions
+	const double gflops = 2.0 * M * N * P / (std::max(microSecs, 1.f) * 1000.0);
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(1) << gflops << " GFLOPS";
+	return ss.str();
+}
+
+/// <summary>
+/// Produces random matrix data, in the same way as Matrix::RandomMat
+/// </summary>
+std::vector<float> makeRandomData(size_t numOfElements)
+{
+	std::vector<float> m(numOfElements);
+	for (float& element : m) { element = static_cast<float>(rand()) / static_cast<float>(RAND_MAX); }
+	return m;
+}
+
+void runCpuBenchmark(bool kernelsToRun[], bool validate)
+{
+	std::cout << std::left << std::setw(55) << "==Running CPU tests";
+	std::cout << "(" << CpuGemm::getSimdInstructionSet() << ", " << pvr::async::JobSystem::getInstance().getNumWorkers() + 1 << " threads)" << std::endl;
+
+	// benchmark the matrices that have already been produced, unless other sizes were requested
+	std::vector<std::array<uint32_t, 3>> sizes;
+	if (TestVariables::cpu_sizes.empty()) { sizes.push_back({ { (uint32_t)TestVariables::M, (uint32_t)TestVariables::N, (uint32_t)TestVariables::P } }); }
+	for (int32_t size : TestVariables::cpu_sizes) { sizes.push_back({ { (uint32_t)size, (uint32_t)size, (uint32_t)size } }); }
+
+	for (const std::array<uint32_t, 3>& size : sizes)
+	{
+		const uint32_t M = size[0];
+		const uint32_t N = size[1];
+		const uint32_t P = size[2];
+		std::vector<float> randomA;
+		std::vector<float> randomB;
+		const float* A = TestVariables::A.data();
+		const float* B = TestVariables::B.data();
+		if (!TestVariables::cpu_sizes.empty())
+		{
+			randomA = makeRandomData((size_t)M * N);
+			randomB = makeRandomData((size_t)N * P);
+			A = randomA.data();
+			B = randomB.data();
+		}
+
+		std::vector<float> product((size_t)M * P);
+		std::vector<float> reference;
+		if (validate)
+		{
+			reference.resize(product.size());
+			CpuGemm::multiply(CpuGemm::Kernel::Naive, M, N, P, A, B, reference.data());
+		}
+
+		for (size_t i = 0; i < static_cast<size_t>(CpuGemm::Kernel::Count); i++)
+		{
+			if (!kernelsToRun[i]) { continue; }
+			const CpuGemm::Kernel kernel = static_cast<CpuGemm::Kernel>(i);
+			std::cout << "\t" << std::left << std::setw(47)
+					  << std::string(CpuGemm::getKernelName(kernel)) + " (" + std::to_string(M) + "x" + std::to_string(N) + "x" + std::to_string(P) + ")";
+
+			// run it several times and keep the fastest, so that the first run warms up the caches and the threads
+			float bestMicroSecs = std::numeric_limits<float>::max();
+			for (int32_t run = 0; run < std::max(TestVariables::cpu_runs, 1); run++)
+			{
+				timer.Reset();
+				CpuGemm::multiply(kernel, M, N, P, A, B, product.data());
+				bestMicroSecs = std::min(bestMicroSecs, timer.getElapsedMicroSecsF());
+			}
+			std::cout << "Done! " << std::left << std::setw(5) << static_cast<uint64_t>(bestMicroSecs / 1000.f) << " (ms)  " << toGflopsString(M, N, P, bestMicroSecs);
+
+			if (validate)
+			{
+				if (Matrix::validate(Matrix(M, P, reference.data()), Matrix(M, P, product.data()), TestVariables::epsilon)) { std::cout << "  (SUCCESS)"; }
+				else
+				{
+					std::cout << "  (FAILURE)";
+				}
+			}
+			std::cout << std::endl;
+		}
+	}
 }
 
-void runBenchmarksWithList(bool benchmarksToRun[], bool validate, char* pathToExecutable)
+bool runBenchmarksWithList(bool benchmarksToRun[], bool validate, char* pathToExecutable)
 {
 	if (validate)
 	{
@@ -220,7 +356,7 @@ void runBenchmarksWithList(bool benchmarksToRun[], bool validate, char* pathToEx
 	// first set up vulkan
 	std::cout << std::left << std::setw(55) << "==Initiating Vulkan";
 	timer.Reset();
-	initiateVulkan(pathToExecutable);
+	if (!initiateVulkan(pathToExecutable)) { return false; }
 	makeDescriptors();
 	makePipelineLayout();
 	makeBuffers(TestVariables::M, TestVariables::N, TestVariables::P);
@@ -265,7 +401,9 @@ void runBenchmarksWithList(bool benchmarksToRun[], bool validate, char* pathToEx
 			// correctly timed compute work
 			timer.Reset();
 			doComputeWork(TestVariables::XWorkgroupsToLaunch[i], TestVariables::YWorkgroupsToLaunch[i]);
-			std::cout << "Done! " << std::left << std::setw(5) << timer.getElapsedMilliSecs() << " (ms)";
+			const float microSecs = timer.getElapsedMicroSecsF();
+			std::cout << "Done! " << std::left << std::setw(5) << static_cast<uint64_t>(microSecs / 1000.f) << " (ms)  "
+					  << toGflopsString(TestVariables::M, TestVariables::N, TestVariables::P, microSecs);
 
 			// if we are validating then check the output matrix against our cpu version.
 			if (validate)
@@ -279,4 +417,5 @@ void runBenchmarksWithList(bool benchmarksToRun[], bool validate, char* pathToEx
 			std::cout << std::endl;
 		}
 	}
+	return true;
 }
@@ -0,0 +1,428 @@
+/*!
+\brief Renders 10000 animated sprites and a few texts with the instanced pvr::ui::SpriteBatch, and reports the CPU cost and number of draws.
+\file VulkanSpriteBatching.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#include "PVRShell/PVRShell.h"
+#include "PVRUtils/PVRUtilsVk.h"
+
+const uint32_t NumSprites = 10000;
+const uint32_t TextureSize = 64;
+const uint32_t NumStatsFrames = 60;
+
+namespace SpriteTexture {
+enum Enum
+{
+	Circle,
+	AtlasFirst,
+	AtlasLast = AtlasFirst + 3,
+	Logo,
+	Count
+};
+}
+
+struct SpriteState
+{
+	glm::vec2 position;
+	glm::vec2 velocity;
+	float rotation;
+	float angularVelocity;
+	float scale;
+	glm::vec4 color;
+	uint32_t texture;
+	pvr::ui::SpriteBlendMode blendMode;
+};
+
+struct DeviceResources
+{
+	pvrvk::Instance instance;
+	pvr::utils::DebugUtilsCallbacks debugUtilsCallbacks;
+	pvrvk::Device device;
+	pvrvk::Swapchain swapchain;
+	pvrvk::Queue queue;
+
+	pvr::utils::vma::Allocator vmaAllocator;
+
+	pvrvk::CommandPool commandPool;
+
+	std::vector<pvrvk::Framebuffer> onScreenFramebuffer;
+	std::vector<pvrvk::CommandBuffer> commandBuffers;
+
+	std::vector<pvrvk::Semaphore> imageAcquiredSemaphores;
+	std::vector<pvrvk::Semaphore> presentationSemaphores;
+	std::vector<pvrvk::Fence> perFrameResourcesFences;
+
+	pvr::ui::UIRenderer uiRenderer;
+	pvr::ui::SpriteBatch spriteBatch;
+	pvr::ui::Image images[SpriteTexture::Count];
+	pvr::ui::Text statsText;
+
+	~DeviceResources()
+	{
+		if (device) { device->waitIdle(); }
+		uint32_t l = swapchain ? swapchain->getSwapchainLength() : 0;
+		for (uint32_t i = 0; i < l; ++i)
+		{
+			if (perFrameResourcesFences[i]) perFrameResourcesFences[i]->wait();
+		}
+	}
+};
+
+/// <summary>Implementing the pvr::Shell functions.</summary>
+class VulkanSpriteBatching : public pvr::Shell
+{
+	std::unique_ptr<DeviceResources> _deviceResources;
+	std::vector<SpriteState> _sprites;
+	uint32_t _frameId;
+	bool _isPaused;
+
+	// CPU time spent collecting, sorting and recording the sprites, averaged over NumStatsFrames frames
+	uint64_t _batchTimeNs;
+	uint32_t _numStatsFrames;
+
+public:
+	virtual pvr::Result initApplication();
+	virtual pvr::Result initView();
+	virtual pvr::Result releaseView();
+	virtual pvr::Result quitApplication();
+	virtual pvr::Result renderFrame();
+	virtual void eventMappedInput(pvr::SimplifiedInput key);
+
+	void createTextures(pvrvk::CommandBuffer& uploadCmd);
+	void updateSprites(float dt);
+	void recordCommandBuffer(uint32_t swapchainIndex);
+};
+
+/// <summary>Code in initApplication() will be called by Shell once per run, before the rendering context is created.
+/// Used to initialize variables that are not dependent on it(e.g.external modules, loading meshes, etc.).If the rendering
+/// context is lost, initApplication() will not be called again.</summary>
+/// <returns>Result::Success if no error occurred.</returns>
+pvr::Result VulkanSpriteBatching::initApplication()
+{
+	_frameId = 0;
+	_isPaused = false;
+	_batchTimeNs = 0;
+	_numStatsFrames = 0;
+	return pvr::Result::Success;
+}
+
+/// <summary>Code in quitApplication() will be called by pvr::Shell once per run, just before exiting the program.</summary>
+/// <returns>Result::Success if no error occurred</returns>.
+pvr::Result VulkanSpriteBatching::quitApplication() { return pvr::Result::Success; }
+
+/// <summary>Generates the sprite textures procedurally: a soft circle, and a 2x2 atlas of rings and squares.</summary>
+/// <param name="uploadCmd">The command buffer to record the uploads into.</param>
+void VulkanSpriteBatching::createTextures(pvrvk::CommandBuffer& uploadCmd)
+{
+	pvr::TextureHeader hd;
+	hd.channelType = pvr::VariableType::UnsignedByteNorm;
+	hd.pixelFormat = pvr::PixelFormat::RGBA_8888();
+	hd.colorSpace = pvr::ColorSpace::lRGB;
+	hd.width = TextureSize;
+	hd.height = TextureSize;
+
+	pvr::Texture circle(hd);
+	uint8_t* data = circle.getDataPointer();
+	for (uint32_t j = 0; j < TextureSize; ++j)
+	{
+		for (uint32_t i = 0; i < TextureSize; ++i)
+		{
+			const glm::vec2 p = (glm::vec2(i, j) + .5f) / static_cast<float>(TextureSize) * 2.f - 1.f;
+			const float alpha = glm::clamp(1.f - glm::length(p), 0.f, 1.f);
+			uint8_t* texel = data + 4 * (j * TextureSize + i);
+			texel[0] = texel[1] = texel[2] = 255;
+			texel[3] = static_cast<uint8_t>(alpha * 255.f);
+		}
+	}
+
+	pvr::Texture atlas(hd);
+	data = atlas.getDataPointer();
+	const uint32_t cell = TextureSize / 2;
+	for (uint32_t j = 0; j < TextureSize; ++j)
+	{
+		for (uint32_t i = 0; i < TextureSize; ++i)
+		{
+			const uint32_t cellIndex = (j / cell) * 2 + i / cell;
+			const glm::vec2 p = (glm::vec2(i % cell, j % cell) + .5f) / static_cast<float>(cell) * 2.f - 1.f;
+			const float radius = glm::length(p);
+			bool inside = false;
+			switch (cellIndex)
+			{
+			case 0: inside = radius > .6f && radius < .9f; break; // ring
+			case 1: inside = std::max(std::abs(p.x), std::abs(p.y)) < .8f; break; // square
+			case 2: inside = std::abs(p.x) + std::abs(p.y) < .9f; break; // diamond
+			default: inside = std::abs(p.x) < .25f || std::abs(p.y) < .25f; break; // cross
+			}
+			uint8_t* texel = data + 4 * (j * TextureSize + i);
+			texel[0] = texel[1] = texel[2] = 255;
+			texel[3] = inside ? 255 : 0;
+		}
+	}
+
+	pvrvk::ImageView circleView = pvr::utils::uploadImageAndView(_deviceResources->device, circle, true, uploadCmd, pvrvk::ImageUsageFlags::e_SAMPLED_BIT,
+		pvrvk::ImageLayout::e_SHADER_READ_ONLY_OPTIMAL, _deviceResources->vmaAllocator, _deviceResources->vmaAllocator);
+	pvrvk::ImageView atlasView = pvr::utils::uploadImageAndView(_deviceResources->device, atlas, true, uploadCmd, pvrvk::ImageUsageFlags::e_SAMPLED_BIT,
+		pvrvk::ImageLayout::e_SHADER_READ_ONLY_OPTIMAL, _deviceResources->vmaAllocator, _deviceResources->vmaAllocator);
+
+	pvr::ui::UIRenderer& uiRenderer = _deviceResources->uiRenderer;
+	_deviceResources->images[SpriteTexture::Circle] = uiRenderer.createImage(circleView);
+	// The four atlas cells share one texture, so the batch merges them into the same draws.
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		const pvrvk::Rect2Df uv(static_cast<float>(i % 2) * .5f, static_cast<float>(i / 2) * .5f, .5f, .5f);
+		_deviceResources->images[SpriteTexture::AtlasFirst + i] = uiRenderer.createImageFromAtlas(atlasView, uv, uiRenderer.getSamplerBilinear());
+	}
+	_deviceResources->images[SpriteTexture::Logo] = uiRenderer.getSdkLogo();
+}
+
+/// <summary>Code in initView() will be called by Shell upon initialization or after a change  in the rendering context. Used to initialize variables that are dependent on the
+/// rendering context(e.g.textures, vertex buffers, etc.).</summary>
+/// <returns>Result::Success if no error occurred.</returns>
+pvr::Result VulkanSpriteBatching::initView()
+{
+	// Create the empty API objects.
+	_deviceResources = std::make_unique<DeviceResources>();
+
+	// Create a Vulkan 1.0 instance and retrieve compatible physical devices
+	pvr::utils::VulkanVersion VulkanVersion(1, 0, 0);
+	_deviceResources->instance = pvr::utils::createInstance(this->getApplicationName(), VulkanVersion, pvr::utils::InstanceExtensions(VulkanVersion));
+
+	if (_deviceResources->instance->getNumPhysicalDevices() == 0)
+	{
+		setExitMessage("Unable not find a compatible Vulkan physical device.");
+		return pvr::Result::UnknownError;
+	}
+
+	// Create the surface
+	pvrvk::Surface surface =
+		pvr::utils::createSurface(_deviceResources->instance, _deviceResources->instance->getPhysicalDevice(0), this->getWindow(), this->getDisplay(), this->getConnection());
+
+	// Create a default set of debug utils messengers or debug callbacks using either VK_EXT_debug_utils or VK_EXT_debug_report respectively
+	_deviceResources->debugUtilsCallbacks = pvr::utils::createDebugUtilsCallbacks(_deviceResources->instance);
+
+	pvr::utils::QueuePopulateInfo queuePopulateInfo = { pvrvk::QueueFlags::e_GRAPHICS_BIT, surface };
+	pvr::utils::QueueAccessInfo queueAccessInfo;
+	_deviceResources->device = pvr::utils::createDeviceAndQueues(_deviceResources->instance->getPhysicalDevice(0), &queuePopulateInfo, 1, &queueAccessInfo);
+
+	// get the queue
+	_deviceResources->queue = _deviceResources->device->getQueue(queueAccessInfo.familyId, queueAccessInfo.queueId);
+	_deviceResources->queue->setObjectName("GraphicsQueue");
+
+	_deviceResources->vmaAllocator = pvr::utils::vma::createAllocator(pvr::utils::vma::AllocatorCreateInfo(_deviceResources->device));
+
+	// Create the command pool
+	_deviceResources->commandPool =
+		_deviceResources->device->createCommandPool(pvrvk::CommandPoolCreateInfo(queueAccessInfo.familyId, pvrvk::CommandPoolCreateFlags::e_RESET_COMMAND_BUFFER_BIT));
+
+	pvrvk::SurfaceCapabilitiesKHR surfaceCapabilities = _deviceResources->instance->getPhysicalDevice(0)->getSurfaceCapabilities(surface);
+
+	// validate the supported swapchain image usage
+	pvrvk::ImageUsageFlags swapchainImageUsage = pvrvk::ImageUsageFlags::e_COLOR_ATTACHMENT_BIT;
+	if (pvr::utils::isImageUsageSupportedBySurface(surfaceCapabilities, pvrvk::ImageUsageFlags::e_TRANSFER_SRC_BIT))
+	{ swapchainImageUsage |= pvrvk::ImageUsageFlags::e_TRANSFER_SRC_BIT; }
+
+	auto swapChainCreateOutput = pvr::utils::createSwapchainRenderpassFramebuffers(_deviceResources->device, surface, getDisplayAttributes(),
+		pvr::utils::CreateSwapchainParameters().setAllocator(_deviceResources->vmaAllocator).setColorImageUsageFlags(swapchainImageUsage));
+
+	_deviceResources->swapchain = swapChainCreateOutput.swapchain;
+	_deviceResources->onScreenFramebuffer = swapChainCreateOutput.framebuffer;
+
+	const bool isSrgb = getBackBufferColorspace() == pvr::ColorSpace::sRGB;
+	_deviceResources->uiRenderer.init(getWidth(), getHeight(), isFullScreen(), swapChainCreateOutput.renderPass, 0, isSrgb, _deviceResources->commandPool,
+		_deviceResources->queue, true, true, true, 64, 64);
+
+	const uint32_t swapchainLength = _deviceResources->swapchain->getSwapchainLength();
+	_deviceResources->commandBuffers.resize(swapchainLength);
+	_deviceResources->presentationSemaphores.resize(swapchainLength);
+	_deviceResources->imageAcquiredSemaphores.resize(swapchainLength);
+	_deviceResources->perFrameResourcesFences.resize(swapchainLength);
+	for (uint32_t i = 0; i < swapchainLength; ++i)
+	{
+		_deviceResources->commandBuffers[i] = _deviceResources->commandPool->allocateCommandBuffer();
+		_deviceResources->commandBuffers[i]->setObjectName("CommandBufferSwapchain" + std::to_string(i));
+		_deviceResources->presentationSemaphores[i] = _deviceResources->device->createSemaphore();
+		_deviceResources->imageAcquiredSemaphores[i] = _deviceResources->device->createSemaphore();
+		_deviceResources->presentationSemaphores[i]->setObjectName("PresentationSemaphoreSwapchain" + std::to_string(i));
+		_deviceResources->imageAcquiredSemaphores[i]->setObjectName("ImageAcquiredSemaphoreSwapchain" + std::to_string(i));
+		_deviceResources->perFrameResourcesFences[i] = _deviceResources->device->createFence(pvrvk::FenceCreateFlags::e_SIGNALED_BIT);
+		_deviceResources->perFrameResourcesFences[i]->setObjectName("FenceSwapchain" + std::to_string(i));
+	}
+
+	// Upload the sprite textures
+	_deviceResources->commandBuffers[0]->begin();
+	createTextures(_deviceResources->commandBuffers[0]);
+	_deviceResources->commandBuffers[0]->end();
+	pvrvk::SubmitInfo submitInfo;
+	submitInfo.commandBuffers = &_deviceResources->commandBuffers[0];
+	submitInfo.numCommandBuffers = 1;
+	_deviceResources->queue->submit(&submitInfo, 1);
+	_deviceResources->queue->waitIdle();
+	_deviceResources->commandBuffers[0]->reset(pvrvk::CommandBufferResetFlags::e_RELEASE_RESOURCES_BIT);
+
+	for (pvr::ui::Image& image : _deviceResources->images) { image->commitUpdates(); }
+
+	_deviceResources->spriteBatch.init(_deviceResources->uiRenderer, isSrgb, swapchainLength, NumSprites + 16);
+
+	_deviceResources->uiRenderer.getDefaultTitle()->setText("SpriteBatching");
+	_deviceResources->uiRenderer.getDefaultTitle()->commitUpdates();
+	_deviceResources->uiRenderer.getDefaultControls()->setText("Action1: Pause / resume");
+	_deviceResources->uiRenderer.getDefaultControls()->commitUpdates();
+	_deviceResources->statsText = _deviceResources->uiRenderer.createText(255);
+	_deviceResources->statsText->setAnchor(pvr::ui::Anchor::TopLeft, glm::vec2(-.98f, .8f));
+	_deviceResources->statsText->setScale(glm::vec2(.6f));
+	_deviceResources->statsText->commitUpdates();
+
+	// Scatter the sprites over the screen, with a mix of textures and blend modes.
+	_sprites.resize(NumSprites);
+	for (SpriteState& sprite : _sprites)
+	{
+		sprite.position = glm::vec2(pvr::randomrange(0.f, static_cast<float>(getWidth())), pvr::randomrange(0.f, static_cast<float>(getHeight())));
+		sprite.velocity = glm::vec2(pvr::randomrange(-150.f, 150.f), pvr::randomrange(-150.f, 150.f));
+		sprite.rotation = pvr::randomrange(0.f, glm::two_pi<float>());
+		sprite.angularVelocity = pvr::randomrange(-3.f, 3.f);
+		sprite.scale = pvr::randomrange(.15f, .4f);
+		sprite.color = glm::vec4(pvr::randomrange(.2f, 1.f), pvr::randomrange(.2f, 1.f), pvr::randomrange(.2f, 1.f), pvr::randomrange(.5f, 1.f));
+		sprite.texture = static_cast<uint32_t>(pvr::randomrange(0.f, static_cast<float>(SpriteTexture::Logo) - .001f));
+		sprite.blendMode = sprite.texture == SpriteTexture::Circle ? pvr::ui::SpriteBlendMode::Additive : pvr::ui::SpriteBlendMode::Alpha;
+	}
+	// A few logos on top of everything else
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		_sprites[i].texture = SpriteTexture::Logo;
+		_sprites[i].scale = .5f;
+		_sprites[i].color = glm::vec4(1.f);
+		_sprites[i].blendMode = pvr::ui::SpriteBlendMode::Alpha;
+	}
+	return pvr::Result::Success;
+}
+
+/// <summary>Code in releaseView() will be called by Shell when the application quits or before a change in the rendering context.</summary>
+/// <returns>Result::Success if no error occurred.</returns>
+pvr::Result VulkanSpriteBatching::releaseView()
+{
+	_deviceResources.reset();
+	return pvr::Result::Success;
+}
+
+/// <summary>Moves and spins the sprites, bouncing them off the edges of the screen.</summary>
+/// <param name="dt">The time since the last frame, in seconds.</param>
+void VulkanSpriteBatching::updateSprites(float dt)
+{
+	PVR_PROFILE_SCOPE("updateSprites");
+	const glm::vec2 screen(static_cast<float>(getWidth()), static_cast<float>(getHeight()));
+	for (SpriteState& sprite : _sprites)
+	{
+		sprite.position += sprite.velocity * dt;
+		sprite.rotation += sprite.angularVelocity * dt;
+		for (uint32_t axis = 0; axis < 2; ++axis)
+		{
+			if ((sprite.position[axis] < 0.f && sprite.velocity[axis] < 0.f) || (sprite.position[axis] > screen[axis] && sprite.velocity[axis] > 0.f))
+			{ sprite.velocity[axis] = -sprite.velocity[axis]; }
+		}
+	}
+}
+
+/// <summary>Records the frame: every sprite goes through the SpriteBatch, which merges them into a handful of draws.</summary>
+/// <param name="swapchainIndex">The swapchain image to record the frame for.</param>
+void VulkanSpriteBatching::recordCommandBuffer(uint32_t swapchainIndex)
+{
+	pvrvk::CommandBuffer& commandBuffer = _deviceResources->commandBuffers[swapchainIndex];
+	pvr::ui::SpriteBatch& spriteBatch = _deviceResources->spriteBatch;
+
+	commandBuffer->begin(pvrvk::CommandBufferUsageFlags::e_ONE_TIME_SUBMIT_BIT);
+	const pvrvk::ClearValue clearValues[2] = { pvrvk::ClearValue(0.f, 0.f, 0.f, 1.f), pvrvk::ClearValue(1.f, 0u) };
+	commandBuffer->beginRenderPass(_deviceResources->onScreenFramebuffer[swapchainIndex], true, clearValues, ARRAY_SIZE(clearValues));
+
+	const uint64_t beginNs = pvr::Profiler::getInstance().getTimestampNs();
+	{
+		PVR_PROFILE_SCOPE("SpriteBatch");
+		spriteBatch.begin(swapchainIndex);
+		for (const SpriteState& sprite : _sprites)
+		{
+			spriteBatch.draw(_deviceResources->images[sprite.texture], sprite.position, glm::vec2(sprite.scale), sprite.rotation, sprite.color, sprite.blendMode,
+				sprite.texture == SpriteTexture::Logo ? 1 : 0);
+		}
+		spriteBatch.draw(_deviceResources->uiRenderer.getDefaultTitle(), 2);
+		spriteBatch.draw(_deviceResources->uiRenderer.getDefaultControls(), 2);
+		spriteBatch.draw(_deviceResources->statsText, 2);
+		spriteBatch.end(commandBuffer);
+	}
+	_batchTimeNs += pvr::Profiler::getInstance().getTimestampNs() - beginNs;
+
+	commandBuffer->endRenderPass();
+	commandBuffer->end();
+
+	if (++_numStatsFrames == NumStatsFrames)
+	{
+		char stats[256];
+		snprintf(stats, sizeof(stats), "Sprites: %u\nDraw calls: %u (%u without batching)\nBatch CPU time: %.3f ms", spriteBatch.getNumSprites(), spriteBatch.getNumDrawCalls(),
+			spriteBatch.getNumSprites(), static_cast<double>(_batchTimeNs) / (1e6 * NumStatsFrames));
+		Log(LogLevel::Information, "%s", stats);
+		_deviceResources->statsText->getTextElement()->setText(stats);
+		_deviceResources->statsText->commitUpdates();
+		_batchTimeNs = 0;
+		_numStatsFrames = 0;
+	}
+}
+
+/// <summary>Main rendering loop function of the program. The shell will call this function every frame.</summary>
+/// <returns>Result::Success if no error occurred.</returns>
+pvr::Result VulkanSpriteBatching::renderFrame()
+{
+	_deviceResources->swapchain->acquireNextImage(uint64_t(-1), _deviceResources->imageAcquiredSemaphores[_frameId]);
+
+	const uint32_t swapchainIndex = _deviceResources->swapchain->getSwapchainIndex();
+
+	// The sprite batch writes into the slice of its streams owned by this swapchain image, so wait for the GPU to be done with it.
+	_deviceResources->perFrameResourcesFences[swapchainIndex]->wait();
+	_deviceResources->perFrameResourcesFences[swapchainIndex]->reset();
+
+	if (!_isPaused) { updateSprites(std::min(static_cast<float>(getFrameTime()) * .001f, .1f)); }
+	recordCommandBuffer(swapchainIndex);
+
+	pvrvk::SubmitInfo submitInfo;
+	pvrvk::PipelineStageFlags waitStage = pvrvk::PipelineStageFlags::e_COLOR_ATTACHMENT_OUTPUT_BIT;
+	submitInfo.commandBuffers = &_deviceResources->commandBuffers[swapchainIndex];
+	submitInfo.numCommandBuffers = 1;
+	submitInfo.waitSemaphores = &_deviceResources->imageAcquiredSemaphores[_frameId];
+	submitInfo.numWaitSemaphores = 1;
+	submitInfo.signalSemaphores = &_deviceResources->presentationSemaphores[_frameId];
+	submitInfo.numSignalSemaphores = 1;
+	submitInfo.waitDstStageMask = &waitStage;
+	_deviceResources->queue->submit(&submitInfo, 1, _deviceResources->perFrameResourcesFences[swapchainIndex]);
+
+	if (this->shouldTakeScreenshot())
+	{
+		pvr::utils::takeScreenshot(_deviceResources->queue, _deviceResources->commandPool, _deviceResources->swapchain, swapchainIndex, this->getScreenshotFileName(),
+			_deviceResources->vmaAllocator, _deviceResources->vmaAllocator);
+	}
+
+	pvrvk::PresentInfo presentInfo;
+	presentInfo.imageIndices = &swapchainIndex;
+	presentInfo.numSwapchains = 1;
+	presentInfo.swapchains = &_deviceResources->swapchain;
+	presentInfo.numWaitSemaphores = 1;
+	presentInfo.waitSemaphores = &_deviceResources->presentationSemaphores[_frameId];
+	_deviceResources->queue->present(presentInfo);
+
+	_frameId = (_frameId + 1) % _deviceResources->swapchain->getSwapchainLength();
+
+	return pvr::Result::Success;
+}
+
+/// <summary>Handles user input and updates live variables accordingly.</summary>
+/// <param name="key">Input key to handle</param>
+void VulkanSpriteBatching::eventMappedInput(pvr::SimplifiedInput key)
+{
+	switch (key)
+	{
+	case pvr::SimplifiedInput::Action1: _isPaused = !_isPaused; break;
+	case pvr::SimplifiedInput::ActionClose: exitShell(); break;
+	default: break;
+	}
+}
+
+/// <summary>This function must be implemented by the user of the shell. The user should return its pvr::Shell object defining the behaviour of the application.</summary>
+/// <returns>Return a unique ptr to the demo supplied by the user.</returns>
+std::unique_ptr<pvr::Shell> pvr::newDemo() { return std::make_unique<VulkanSpriteBatching>(); }
@@ -10,6 +10,13 @@
 #include "PVRAssets/Helper.h"
 #include "PVRAssets/fileio/PODReader.h"
 #include "PVRAssets/fileio/GltfReader.h"
+#include "PVRAssets/fileio/ModelCache.h"
+#include "PVRCore/stream/BufferStream.h"
+#include "PVRCore/stream/FileCache.h"
+#include "PVRCore/stream/FilePath.h"
+#include "PVRCore/stream/MappedFileStream.h"
+#include "PVRCore/strings/CompileTimeHash.h"
+#include <ctime>
 namespace pvr {
 namespace assets {
 namespace helper {
@@ -158,6 +165,53 @@ void VertexIndexRead(const uint8_t* data, const IndexType type, uint32_t* const
 	}
 }
 
+namespace {
+// A memcpy with a compile time size compiles to a handful of (vector) register moves instead of a library call.
+template<uint32_t ElementSize>
+inline void copyStridedElements(uint8_t* dst, uint32_t dstStride, const uint8_t* src, uint32_t srcStride, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; ++i, dst += dstStride, src += srcStride) { memcpy(dst, src, ElementSize); }
+}
+
+inline void copyStridedElements(uint8_t* dst, uint32_t dstStride, const uint8_t* src, uint32_t srcStride, uint32_t elementSize, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; ++i, dst += dstStride, src += srcStride) { memcpy(dst, src, elementSize); }
+}
+} // namespace
+
+void interleaveVertexAttributes(const VertexAttributeSource* sources, uint32_t numSources, uint32_t numVertices, uint8_t* out, uint32_t outStride)
+{
+	// A single, tightly packed attribute is just a copy.
+	if (numSources == 1 && sources[0].stride == outStride && sources[0].size == outStride && sources[0].offset == 0)
+	{
+		memcpy(out, sources[0].data, static_cast<size_t>(numVertices) * outStride);
+		return;
+	}
+
+	// Work in blocks of vertices small enough that the destination block stays in the cache while every attribute is
+	// written into it, instead of walking the whole destination once per attribute.
+	const uint32_t blockSize = std::max(1u, (32u * 1024u) / std::max(1u, outStride));
+	for (uint32_t first = 0; first < numVertices; first += blockSize)
+	{
+		const uint32_t count = std::min(blockSize, numVertices - first);
+		uint8_t* dstBlock = out + static_cast<size_t>(first) * outStride;
+		for (uint32_t s = 0; s < numSources; ++s)
+		{
+			const VertexAttributeSource& source = sources[s];
+			uint8_t* dst = dstBlock + source.offset;
+			const uint8_t* src = source.data + static_cast<size_t>(first) * source.stride;
+			switch (source.size)
+			{
+			case 4: copyStridedElements<4>(dst, outStride, src, source.stride, count); break;
+			case 8: copyStridedElements<8>(dst, outStride, src, source.stride, count); break;
+			case 12: copyStridedElements<12>(dst, outStride, src, source.stride, count); break;
+			case 16: copyStridedElements<16>(dst, outStride, src, source.stride, count); break;
+			default: copyStridedElements(dst, outStride, src, source.stride, source.size, count); break;
+			}
+		}
+	}
+}
+
 pvr::assets::ModelFileFormat getModelFormatFromFilename(const std::string& modelFile)
 {
 	std::string file(modelFile);
@@ -168,7 +222,7 @@ pvr::assets::ModelFileFormat getModelFormatFromFilename(const std::string& model
 		std::string s = file.substr(period + 1);
 		std::transform(s.begin(), s.end(), s.begin(), [](char c) { return static_cast<char>(tolower(c)); });
 		if (!s.compare("pod")) { return pvr::assets::ModelFileFormat::POD; }
-		if (!s.compare("gltf")) { return pvr::assets::ModelFileFormat::GLTF; }
+		if (!s.compare("gltf") || !s.compare("glb")) { return pvr::assets::ModelFileFormat::GLTF; }
 	}
 	return pvr::assets::ModelFileFormat::UNKNOWN;
 }
@@ -222,6 +276,81 @@ ModelHandle loadModel(const IAssetProvider& app, const pvr::Stream& modelFile)
 	default: throw InvalidArgumentError("type", "Unknown model file format passed");
 	}
 }
+
+ModelHandle loadModel(const IAssetProvider& app, const std::string& modelFile, const std::string& cacheDirectory)
+{
+	std::unique_ptr<Stream> assetStream = app.getAssetStream(modelFile);
+	const std::string& sourcePath = assetStream->getFileName();
+
+	// Models with the same name in different directories must not share a cache, so the cache is keyed on the full path
+	// the asset was actually opened from.
+	const std::string cacheFile = addTrailingDirectorySeparator(cacheDirectory) + strings::createFormatted("%s.%016llx%s", FilePath(modelFile).getFilename().c_str(),
+		static_cast<unsigned long long>(hash64_bytes(sourcePath.data(), sourcePath.size())), ModelCacheExtension);
+
+	ModelCacheSource source;
+	bool sourceIsFile = getModelSourceFileInfo(sourcePath, source);
+	std::vector<uint8_t> sourceData;
+	bool sourceHashed = false;
+
+	ModelHandle handle = std::make_shared<Model>();
+	bool loadedFromCache = false;
+	{
+		MappedFileStream cache(cacheFile, false);
+		ModelCacheSource cachedSource;
+		if (cache.isReadable() && readModelCacheSource(cache.getMappedData(), cache.getSize(), cachedSource))
+		{
+			// If the source file still has the size and modification time it had when the cache was written, it is not read
+			// at all. Otherwise its contents are hashed and compared.
+			bool sameFile = sourceIsFile && cachedSource.size == source.size && cachedSource.modifiedTime == source.modifiedTime;
+			if (!sameFile)
+			{
+				sourceData = assetStream->readToEnd<uint8_t>();
+				source.hash = computeModelSourceHash(sourceData.data(), sourceData.size());
+				sourceHashed = true;
+			}
+			if (sameFile || cachedSource.hash == source.hash)
+			{
+				loadedFromCache = readModelCache(cache.getMappedData(), cache.getSize(), *handle);
+				// Same contents under a new timestamp (for example after a fresh checkout): rewrite the cache below, so that the
+				// next launch takes the fast path.
+				if (loadedFromCache && (sameFile || !sourceIsFile)) { return handle; }
+			}
+		}
+	}
+
+	if (!loadedFromCache)
+	{
+		// No valid cache. Parse the source from memory, then bake a cache for the next launch.
+		if (!sourceHashed)
+		{
+			sourceData = assetStream->readToEnd<uint8_t>();
+			source.hash = computeModelSourceHash(sourceData.data(), sourceData.size());
+		}
+		BufferStream sourceStream(sourcePath, static_cast<const void*>(sourceData.data()), sourceData.size());
+		switch (helper::getModelFormatFromFilename(modelFile))
+		{
+		case pvr::assets::ModelFileFormat::POD: pvr::assets::readPOD(sourceStream, *handle); break;
+		case pvr::assets::ModelFileFormat::GLTF: pvr::assets::readGLTF(sourceStream, app, *handle); break;
+		default: throw InvalidArgumentError("type", "Unknown model file format passed");
+		}
+	}
+
+	// A source modified within the timestamp granularity of the file system could be modified again without its
+	// modification time changing. Record no modification time in that case, so that the next launch hashes the source
+	// (and then rewrites the cache with the, by then settled, modification time). 2 seconds covers FAT, the coarsest.
+	const int64_t timestampGranularity = 2;
+	ModelCacheSource writtenSource = source;
+	if (sourceIsFile && static_cast<int64_t>(time(nullptr)) - static_cast<int64_t>(source.modifiedTime) < timestampGranularity) { writtenSource.modifiedTime = 0; }
+	try
+	{
+		writeFileAtomically(cacheFile, [&](Stream& cache) { writeModelCache(*handle, writtenSource, cache); });
+	}
+	catch (const std::exception& e)
+	{
+		Log(LogLevel::Warning, "Could not write model cache '%s': %s", cacheFile.c_str(), e.what());
+	}
+	return handle;
+}
 } // namespace assets
 } // namespace pvr
 //!\endcond
@@ -26,6 +26,26 @@ void VertexRead(const uint8_t* data, const DataType type, uint32_t count, float*
 /// <param name="out">of index data read</param>
 void VertexIndexRead(const uint8_t* data, const IndexType type, uint32_t* const out);
 
+/// <summary>Describes one source stream of vertex attribute data to be interleaved by interleaveVertexAttributes.</summary>
+struct VertexAttributeSource
+{
+	const uint8_t* data; //!< Pointer to the first element of the attribute in the source
+	uint32_t stride; //!< Distance in bytes between consecutive elements in the source
+	uint32_t size; //!< Size in bytes of a single element (e.g. 12 for a vec3 of floats)
+	uint32_t offset; //!< Offset in bytes of the attribute inside each destination vertex
+};
+
+/// <summary>Interleave a number of vertex attribute streams into a single interleaved vertex buffer. The copy is
+/// done attribute by attribute over blocks of vertices that fit in the cache, and common element sizes (4, 8, 12 and
+/// 16 bytes) use fixed size copies the compiler can turn into plain (vector) loads and stores. This is much faster
+/// than a memcpy per vertex per attribute for large meshes.</summary>
+/// <param name="sources">The attribute streams to interleave</param>
+/// <param name="numSources">The number of attribute streams</param>
+/// <param name="numVertices">The number of vertices to interleave</param>
+/// <param name="out">The destination. Must be at least numVertices * outStride bytes.</param>
+/// <param name="outStride">The stride of the destination (size of one interleaved vertex)</param>
+void interleaveVertexAttributes(const VertexAttributeSource* sources, uint32_t numSources, uint32_t numVertices, uint8_t* out, uint32_t outStride);
+
 /// <summary>Retrieves the model definition type using the extension of the given filename.</summary>
 /// <param name="modelFile">The name of the model file to use for determining its model file format</param>
 pvr::assets::ModelFileFormat getModelFormatFromFilename(const std::string& modelFile);
@@ -47,5 +67,23 @@ pvr::assets::ModelHandle loadModel(const IAssetProvider& app, const std::string&
 /// <param name="modelFile"></param>
 /// <returns>Returns a successfully created pvr::assets::ModelHandle object otherwise will throw</returns>
 pvr::assets::ModelHandle loadModel(const IAssetProvider& app, const pvr::Stream& model);
+
+/// <summary>Load a model file, using a baked binary model cache to skip parsing on every launch after the first.</summary>
+/// <param name="app">An asset provider used to load the model file</param>
+/// <param name="modelFile">The name of the model file (POD or glTF)</param>
+/// <param name="cacheDirectory">A writable directory where model caches are kept, for example Shell::getWritePath()</param>
+/// <returns>Returns a successfully created pvr::assets::ModelHandle object otherwise will throw</returns>
+/// <remarks>Caches are kept inside <paramRef name="cacheDirectory"/>, one per source file, keyed on the full path the
+/// model was opened from. If the source file has the same size and modification time as when its cache was written,
+/// the model is rebuilt from the memory mapped cache without reading the source. Otherwise the source is read and
+/// hashed: if its contents are unchanged the cache is still used, else the source is parsed as usual and a new cache is
+/// written. Caches are replaced atomically, so a cache being read or mapped by another process is never truncated, and
+/// failure to write the cache is not an error. A source modified within 2 seconds of being cached is always hashed on
+/// the next load, since a second modification inside the file system's timestamp granularity would not change its
+/// modification time. Tools that preserve modification times while changing contents at the same size (for example
+/// some copy or restore tools) still defeat the size and modification time check: clear the caches after using them.
+/// For glTF, only the .gltf file itself is checked: caches must be cleared manually if only external buffers change.
+/// </remarks>
+pvr::assets::ModelHandle loadModel(const IAssetProvider& app, const std::string& modelFile, const std::string& cacheDirectory);
 } // namespace assets
 } // namespace pvr
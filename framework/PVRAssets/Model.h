@@ -1356,7 +1356,12 @@ public:
 	/// <summary>Get a reference to the internal data of this Model. Handle with care.</summary>
 	/// <returns>Return internal data</returns>
 	InternalData& getInternalData() { return _data; }
+
+	/// <summary>Get a const reference to the internal data of this Model.</summary>
+	/// <returns>Return internal data</returns>
+	const InternalData& getInternalData() const { return _data; }
 	CustomData& getFormattedUserData() { return _data.formattedUserData; }
+	const CustomData& getFormattedUserData() const { return _data.formattedUserData; }
 
 	/// <summary>Get the properties of a camera. This is additional info on the class (remarks or documentation).</summary>
 	/// <param name="cameraIdx">The index of the camera.</param>
@@ -1,5 +1,6 @@
 #include "GltfReader.h"
 #include "PVRAssets/Model.h"
+#include "PVRAssets/Helper.h"
 #include "PVRCore/stream/FilePath.h"
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_NO_STB_IMAGE
@@ -582,141 +583,179 @@ enum class VertexAttributeIndex
 	Count,
 };
 
-void parseAllMesh(const tinygltf::Model& tinyModel, pvr::assets::Model& asset, std::vector<MeshprimitivesIterator>& meshPrimitives)
+// Rename the TEXCOORD semantic to UV (for compatibility with POD)
+std::string getFrameworkSemantic(const std::string& tinySemantic)
 {
-	uint32_t meshIndex = 0;
-	const auto& tinyAccessors = tinyModel.accessors;
+	if (pvr::strings::startsWith(tinySemantic, "TEXCOORD_"))
+	{
+		uint32_t index = 0;
+		const int r = sscanf(tinySemantic.c_str(), "TEXCOORD_%d", &index);
+		if (r == 1) { return pvr::strings::createFormatted("UV%d", index); }
+	}
+	return tinySemantic;
+}
 
+// For each buffer, find the last gltf mesh that reads vertex or index data from it, or -1 if no mesh does.
+std::vector<int32_t> findLastMeshUsingBuffers(const tinygltf::Model& tinyModel)
+{
+	std::vector<int32_t> lastMesh(tinyModel.buffers.size(), -1);
+	auto markAccessor = [&](int32_t accessorIndex, int32_t meshIndex) {
+		if (accessorIndex < 0) { return; }
+		const tinygltf::Accessor& tinyAccessor = tinyModel.accessors[accessorIndex];
+		if (tinyAccessor.bufferView < 0) { return; }
+		lastMesh[tinyModel.bufferViews[tinyAccessor.bufferView].buffer] = meshIndex;
+	};
+	for (int32_t m = 0; m < static_cast<int32_t>(tinyModel.meshes.size()); ++m)
+	{
+		for (const tinygltf::Primitive& tinyPrimitive : tinyModel.meshes[m].primitives)
+		{
+			for (const auto& attrib : tinyPrimitive.attributes) { markAccessor(attrib.second, m); }
+			markAccessor(tinyPrimitive.indices, m);
+		}
+	}
+	return lastMesh;
+}
+
+void parseMeshPrimitive(const tinygltf::Model& tinyModel, const tinygltf::Primitive& tinyPrimitive, pvr::assets::Mesh& mesh)
+{
 	struct GltfAttribute
 	{
 		const unsigned char* data;
+		size_t byteOffset; // offset of the first element from the start of the buffer view
 		uint32_t strideInBytes;
-		uint32_t attribStrideInBytes;
+		uint32_t sizeInBytes;
 		std::pair<pvr::DataType, size_t> dataType;
 		uint32_t N;
-		pvr::StringHash semantic;
-		GltfAttribute() : data(), strideInBytes(), attribStrideInBytes(), dataType(), N() {}
+		int32_t bufferView;
+		std::string semantic;
 	};
 
-	for (uint32_t m = 0; m < tinyModel.meshes.size(); ++m)
-	{
-		const tinygltf::Mesh& tinyMesh = tinyModel.meshes[m];
-		// store the mesh primitives range
-		meshPrimitives[m].begin = &asset.getMesh(meshIndex);
-		meshPrimitives[m].numPrimitives = static_cast<uint32_t>(tinyMesh.primitives.size());
-
-		// process primitive meshes
-		std::vector<char> attributeInterleaved;
-
-		for (uint32_t p = 0; p < tinyMesh.primitives.size(); ++p)
-		{
-			std::vector<GltfAttribute> gltfAttributes;
-
-			pvr::assets::Mesh& mesh = asset.getMesh(meshIndex);
-			const tinygltf::Primitive& tinyPrimitive = tinyMesh.primitives[p];
-			mesh.setPrimitiveType(tinyGltf_primitiveTopology(static_cast<int32_t>(tinyPrimitive.mode)));
-
-			// VERTEX ATTRIBUTES
-			uint32_t numvertices = 0;
-
-			uint32_t dataAttribsStride = 0;
+	mesh.setPrimitiveType(tinyGltf_primitiveTopology(static_cast<int32_t>(tinyPrimitive.mode)));
 
-			uint32_t totalBufferSizeInBytes = 0;
-			bool isInterleaved = false;
+	auto& meshInfo = mesh.getMeshInfo();
+	meshInfo.min = glm::vec3(std::numeric_limits<float>::max());
+	meshInfo.max = glm::vec3(std::numeric_limits<float>::lowest());
 
-			auto& meshInfo = mesh.getMeshInfo();
-
-			meshInfo.min = glm::vec3(std::numeric_limits<float>::max());
-			meshInfo.max = glm::vec3(std::numeric_limits<float>::lowest());
+	// VERTEX ATTRIBUTES
+	std::vector<GltfAttribute> gltfAttributes;
+	gltfAttributes.reserve(tinyPrimitive.attributes.size());
+	uint32_t numVertices = 0;
+	for (const auto& attrib : tinyPrimitive.attributes)
+	{
+		const tinygltf::Accessor& tinyAccessor = tinyModel.accessors[attrib.second];
+		if (tinyAccessor.bufferView < 0) { continue; } // Accessors without a buffer view (all zeroes) carry no data.
+		const tinygltf::BufferView& tinyBufferView = tinyModel.bufferViews[tinyAccessor.bufferView];
+		const tinygltf::Buffer& tinyBuffer = tinyModel.buffers[tinyBufferView.buffer];
 
-			for (auto attrib : tinyPrimitive.attributes)
-			{
-				const tinygltf::Accessor& tinyAccessor = tinyAccessors[attrib.second];
-				const tinygltf::BufferView& tinyBufferView = tinyModel.bufferViews[tinyAccessor.bufferView];
-				const tinygltf::Buffer& tinyBuffer = tinyModel.buffers[tinyBufferView.buffer];
+		// bounding box
+		if (attrib.first == "POSITION")
+		{
+			meshInfo.min = glm::min(glm::vec3(tinyAccessor.minValues[0], tinyAccessor.minValues[1], tinyAccessor.minValues[2]), meshInfo.min);
+			meshInfo.max = glm::max(glm::vec3(tinyAccessor.maxValues[0], tinyAccessor.maxValues[1], tinyAccessor.maxValues[2]), meshInfo.max);
+		}
 
-				// bounding box
-				if (attrib.first == "POSITION")
-				{
-					meshInfo.min = glm::min(glm::vec3(tinyAccessor.minValues[0], tinyAccessor.minValues[1], tinyAccessor.minValues[2]), meshInfo.min);
-					meshInfo.max = glm::max(glm::vec3(tinyAccessor.maxValues[0], tinyAccessor.maxValues[1], tinyAccessor.maxValues[2]), meshInfo.max);
-				}
+		GltfAttribute attribute;
+		attribute.N = tinyGltf_getTypeNumComponents(tinyAccessor.type); // Get number of component this type has. e.g vec3, vec4
+		attribute.dataType = tinyGltf_getComponentTypeToDataType(tinyAccessor.componentType);
+		attribute.sizeInBytes = attribute.N * static_cast<uint32_t>(attribute.dataType.second);
+		attribute.strideInBytes = tinyBufferView.byteStride ? static_cast<uint32_t>(tinyBufferView.byteStride) : attribute.sizeInBytes;
+		attribute.byteOffset = tinyAccessor.byteOffset;
+		attribute.data = tinyBuffer.data.data() + tinyBufferView.byteOffset + tinyAccessor.byteOffset;
+		attribute.bufferView = tinyAccessor.bufferView;
+		attribute.semantic = getFrameworkSemantic(attrib.first);
+		gltfAttributes.emplace_back(attribute);
+		numVertices = static_cast<uint32_t>(tinyAccessor.count);
+	}
 
-				gltfAttributes.push_back(GltfAttribute());
-				gltfAttributes.back().data = tinyBuffer.data.data() + tinyBufferView.byteOffset + tinyAccessor.byteOffset;
-				gltfAttributes.back().strideInBytes = tinyBufferView.byteStride
-					? static_cast<uint32_t>(tinyBufferView.byteStride)
-					: tinyGltf_getTypeNumComponents(tinyAccessor.type) * tinyGltf_getComponentTypeToDataType(tinyAccessor.componentType).second;
-				gltfAttributes.back().N = tinyGltf_getTypeNumComponents(tinyAccessor.type); // Get number of component this type has. e.g vec3, vec4
-				gltfAttributes.back().dataType = tinyGltf_getComponentTypeToDataType(tinyAccessor.componentType);
-				gltfAttributes.back().semantic = attrib.first;
-				numvertices = static_cast<uint32_t>(tinyAccessor.count);
-				dataAttribsStride += static_cast<uint32_t>(gltfAttributes.back().strideInBytes);
-
-				if (gltfAttributes.back().strideInBytes > (gltfAttributes.back().N * gltfAttributes.back().dataType.second)) { isInterleaved = true; }
-			}
+	// If all attributes are read from the same strided buffer view, the source is already interleaved exactly as the
+	// framework expects, so the whole vertex range is copied in one go. Otherwise the attributes are interleaved in bulk.
+	bool isInterleaved = !gltfAttributes.empty() && tinyModel.bufferViews[gltfAttributes[0].bufferView].byteStride != 0;
+	size_t firstByte = std::numeric_limits<size_t>::max();
+	size_t lastByte = 0;
+	for (const GltfAttribute& attribute : gltfAttributes)
+	{
+		isInterleaved = isInterleaved && attribute.bufferView == gltfAttributes[0].bufferView;
+		firstByte = std::min(firstByte, attribute.byteOffset);
+		lastByte = std::max(lastByte, attribute.byteOffset + attribute.sizeInBytes);
+	}
+	isInterleaved = isInterleaved && lastByte - firstByte <= gltfAttributes[0].strideInBytes;
 
-			totalBufferSizeInBytes = dataAttribsStride * numvertices;
-			uint32_t bufferOffset = 0;
+	uint32_t vertexStride = 0;
+	if (isInterleaved)
+	{
+		const tinygltf::BufferView& tinyBufferView = tinyModel.bufferViews[gltfAttributes[0].bufferView];
+		const tinygltf::Buffer& tinyBuffer = tinyModel.buffers[tinyBufferView.buffer];
+		vertexStride = gltfAttributes[0].strideInBytes;
+		const uint32_t totalBufferSizeInBytes = vertexStride * numVertices;
+
+		// The last vertex does not need to be padded up to the full stride in the source.
+		const size_t begin = tinyBufferView.byteOffset + firstByte;
+		const size_t available = std::min<size_t>(totalBufferSizeInBytes, tinyBuffer.data.size() - begin);
+		if (available == totalBufferSizeInBytes) { mesh.addData(tinyBuffer.data.data() + begin, totalBufferSizeInBytes, vertexStride, 0); }
+		else
+		{
+			mesh.addData(nullptr, totalBufferSizeInBytes, vertexStride, 0);
+			memcpy(mesh.getInternalData().vertexAttributeDataBlocks[0].data(), tinyBuffer.data.data() + begin, available);
+		}
+		for (GltfAttribute& attribute : gltfAttributes) { attribute.byteOffset -= firstByte; }
+	}
+	else
+	{
+		std::vector<pvr::assets::helper::VertexAttributeSource> sources(gltfAttributes.size());
+		for (size_t i = 0; i < gltfAttributes.size(); ++i)
+		{
+			sources[i].data = gltfAttributes[i].data;
+			sources[i].stride = gltfAttributes[i].strideInBytes;
+			sources[i].size = gltfAttributes[i].sizeInBytes;
+			sources[i].offset = vertexStride;
+			gltfAttributes[i].byteOffset = vertexStride;
+			vertexStride += gltfAttributes[i].sizeInBytes;
+		}
+		// Interleave straight into the mesh's own data block, so that no intermediate copy of the vertices exists.
+		mesh.addData(nullptr, vertexStride * numVertices, vertexStride, 0);
+		pvr::assets::helper::interleaveVertexAttributes(sources.data(), static_cast<uint32_t>(sources.size()), numVertices,
+			mesh.getInternalData().vertexAttributeDataBlocks[0].data(), vertexStride);
+	}
 
-			// If the vertices already interleaved than do nothing  and copy the data, else interleave the vertices.
-			// Interleave the vertices.
-			if (!isInterleaved)
-			{
-				attributeInterleaved.resize(totalBufferSizeInBytes);
+	for (const GltfAttribute& attribute : gltfAttributes)
+	{
+		pvr::assets::VertexAttributeData attribData;
+		attribData.setN(static_cast<uint8_t>(attribute.N));
+		attribData.setDataType(attribute.dataType.first);
+		attribData.setDataIndex(0);
+		attribData.setOffset(static_cast<uint32_t>(attribute.byteOffset));
+		attribData.setSemantic(attribute.semantic);
+		mesh.addVertexAttribute(attribData);
+	}
 
-				for (uint32_t i = 0; i < numvertices; ++i)
-				{
-					for (std::size_t j = 0, attrSize = gltfAttributes.size(); j < attrSize; ++j)
-					{
-						if (gltfAttributes[j].data != nullptr)
-						{
-							const auto& tinyAttrib = gltfAttributes[j];
-							memcpy(attributeInterleaved.data() + bufferOffset, tinyAttrib.data + tinyAttrib.strideInBytes * i, tinyAttrib.strideInBytes);
-
-							// set the vertex attribute only once for each attribute.
-							if (i == 0)
-							{
-								pvr::assets::VertexAttributeData attribData;
-
-								attribData.setN((uint8_t)tinyAttrib.N);
-								attribData.setDataType(tinyAttrib.dataType.first);
-								attribData.setDataIndex(0);
-								attribData.setOffset(bufferOffset);
-
-								std::string semantic = tinyAttrib.semantic;
-								// Rename the TEXCOORD semantic to UV (for compatibility with POD)
-								if (pvr::strings::startsWith(semantic, "TEXCOORD_"))
-								{
-									uint32_t index = 0;
-									const int r = sscanf(semantic.c_str(), "TEXCOORD_%d", &index);
-									if (r == 1) { semantic = pvr::strings::createFormatted("UV%d", index); }
-								}
-								attribData.setSemantic(semantic);
-								mesh.addVertexAttribute(attribData);
-							}
-
-							bufferOffset += static_cast<uint32_t>(tinyAttrib.dataType.second) * tinyAttrib.N;
-						}
-					}
-				}
-				mesh.addData((const uint8_t*)attributeInterleaved.data(), totalBufferSizeInBytes, dataAttribsStride, 0);
-			}
+	mesh.setNumVertices(numVertices);
 
-			mesh.setNumVertices(numvertices);
+	if (tinyPrimitive.indices != -1)
+	{
+		const tinygltf::Accessor& tinyAccessor = tinyModel.accessors[tinyPrimitive.indices];
+		const tinygltf::BufferView& tinyBufferView = tinyModel.bufferViews[tinyAccessor.bufferView];
+		const tinygltf::Buffer& tinyBuffer = tinyModel.buffers[tinyBufferView.buffer];
 
-			if (tinyPrimitive.indices != -1)
-			{
-				const tinygltf::Accessor& tinyAccessor = tinyAccessors[tinyPrimitive.indices];
-				const tinygltf::BufferView& tinyBufferView = tinyModel.bufferViews[tinyAccessor.bufferView];
-				const tinygltf::Buffer& tinyBuffer = tinyModel.buffers[tinyBufferView.buffer];
+		pvr::IndexType indexType = tinyGltf_getIndexType(tinyAccessor.componentType);
+		mesh.addFaces(tinyBuffer.data.data() + tinyBufferView.byteOffset + tinyAccessor.byteOffset,
+			(indexType == pvr::IndexType::IndexType16Bit ? sizeof(uint16_t) : sizeof(uint32_t)) * static_cast<uint32_t>(tinyAccessor.count), indexType);
+	}
+}
 
-				pvr::IndexType indexType = tinyGltf_getIndexType(tinyAccessor.componentType);
-				mesh.addFaces(tinyBuffer.data.data() + tinyBufferView.byteOffset + tinyAccessor.byteOffset,
-					(indexType == pvr::IndexType::IndexType16Bit ? sizeof(uint16_t) : sizeof(uint32_t)) * static_cast<uint32_t>(tinyAccessor.count), indexType);
-			}
+// Parses the vertex and index data of all meshes. This must be done last, as buffers are released as soon as the
+// last mesh using them has been processed, so that the source buffers and the meshes never both exist in full.
+void parseAllMesh(tinygltf::Model& tinyModel, pvr::assets::Model& asset)
+{
+	const std::vector<int32_t> lastMeshUsingBuffer = findLastMeshUsingBuffers(tinyModel);
+	uint32_t meshIndex = 0;
+	for (uint32_t m = 0; m < tinyModel.meshes.size(); ++m)
+	{
+		// process primitive meshes
+		for (const tinygltf::Primitive& tinyPrimitive : tinyModel.meshes[m].primitives) { parseMeshPrimitive(tinyModel, tinyPrimitive, asset.getMesh(meshIndex++)); }
 
-			++meshIndex; // next mesh
+		for (size_t b = 0; b < tinyModel.buffers.size(); ++b)
+		{
+			if (lastMeshUsingBuffer[b] == static_cast<int32_t>(m)) { std::vector<unsigned char>().swap(tinyModel.buffers[b].data); }
 		}
 	}
 }
@@ -753,22 +792,20 @@ public:
 		(void)basedir; // UNREFERENCE_VARIABLE
 		auto stream = assetProvider->getAssetStream(basedir == "" ? filename : basedir + std::string(1, pvr::FilePath::getDirectorySeparator()) + filename);
 		if (!stream) { return false; }
-		const uint32_t sz = static_cast<uint32_t>(stream->getSize());
-		out->resize(sz);
-		size_t readSize = 0;
-		stream->read(out->size(), 1, out->data(), readSize);
-		if (checkSize)
+		const size_t sz = stream->getSize();
+		// Check the size before reading, so that a mismatching (possibly huge) file is never loaded.
+		if (checkSize && reqBytes != sz)
 		{
-			if (reqBytes == sz) { return true; }
-			else
-			{
-				std::stringstream ss;
-				ss << "File size mismatch : " << filename << ", requestedBytes " << reqBytes << ", but got " << sz << std::endl;
-				if (err) { (*err) += ss.str(); }
-				return false;
-			}
+			std::stringstream ss;
+			ss << "File size mismatch : " << filename << ", requestedBytes " << reqBytes << ", but got " << sz << std::endl;
+			if (err) { (*err) += ss.str(); }
+			return false;
 		}
-		return true;
+		// The file is read with a single call straight into the buffer tinygltf keeps, with no staging copy.
+		out->resize(sz);
+		size_t readSize = 0;
+		if (sz) { stream->read(1, sz, out->data(), readSize); }
+		return readSize == sz;
 	}
 
 private:
@@ -790,20 +827,25 @@ void readGLTF(const ::pvr::Stream& stream, const IAssetProvider& assetProvider,
 	tinygltf::Model tinyModel;
 	tinygltf::TinyGLTF tinyLoader;
 	std::string err;
-	std::vector<char> data = stream.readToEnd<char>();
-	uint32_t findIndex = static_cast<uint32_t>(stream.getFileName().find_last_of("."));
-	std::string ext = stream.getFileName().substr(findIndex, std::string::npos);
+	std::vector<unsigned char> data = stream.readToEnd<unsigned char>();
 	std::string dir;
 	pvr::strings::getFileDirectory(stream.getFileName(), dir);
 
 	GltfFileLoader gltfStreamProvider(assetProvider);
 
-	if (!tinyLoader.LoadASCIIFromString(
-			gltfStreamProvider, &tinyModel, &err, static_cast<const char*>(data.data()), static_cast<uint32_t>(data.size()), dir, tinygltf::SectionCheck::NO_REQUIRE))
+	// Binary glTF (.glb) is recognised by its magic rather than by the extension, so that unnamed streams work too.
+	const bool isBinary = data.size() >= 4 && memcmp(data.data(), "glTF", 4) == 0;
+	const bool loaded = isBinary
+		? tinyLoader.LoadBinaryFromMemory(gltfStreamProvider, &tinyModel, &err, data.data(), static_cast<uint32_t>(data.size()), dir, tinygltf::SectionCheck::NO_REQUIRE)
+		: tinyLoader.LoadASCIIFromString(gltfStreamProvider, &tinyModel, &err, reinterpret_cast<const char*>(data.data()), static_cast<uint32_t>(data.size()), dir,
+			  tinygltf::SectionCheck::NO_REQUIRE);
+	if (!loaded)
 	{
 		Log("%s", err.c_str());
 		throw pvr::FileNotFoundError(err);
 	}
+	// Everything has been copied out of the file contents, so release them before the meshes are built.
+	std::vector<unsigned char>().swap(data);
 
 	auto extraData = gltfExtraToCustomData(tinyModel.scenes[0].extras);
 	asset.getFormattedUserData() = extraData;
@@ -838,11 +880,15 @@ void readGLTF(const ::pvr::Stream& stream, const IAssetProvider& assetProvider,
 	const uint32_t numAssetNodes = numMeshNodes + numLightNodes + numCameraNodes;
 	asset.allocNodes(numNodes + numAssetNodes);
 
-	// Parse all the meshes
 	// Keep a list which maps between the gltf mesh with the framework meshes.
 	// For each gltf meshes there must be at least 1 or more (more than one primitives) framework meshes.
 	std::vector<MeshprimitivesIterator> meshPrimitives(tinyModel.meshes.size());
-	parseAllMesh(tinyModel, asset, meshPrimitives);
+	for (uint32_t m = 0, meshIndex = 0; m < tinyModel.meshes.size(); ++m)
+	{
+		meshPrimitives[m].begin = &asset.getMesh(meshIndex);
+		meshPrimitives[m].numPrimitives = static_cast<uint32_t>(tinyModel.meshes[m].primitives.size());
+		meshIndex += meshPrimitives[m].numPrimitives;
+	}
 
 	uint32_t cameraNodeIndex = 0;
 
@@ -872,6 +918,9 @@ void readGLTF(const ::pvr::Stream& stream, const IAssetProvider& assetProvider,
 
 	// Cameras
 	parseAllCameras(tinyModel, asset);
+
+	// Parse all the meshes. Done last, as it releases the gltf buffers as it goes.
+	parseAllMesh(tinyModel, asset);
 } // namespace assets
 } // namespace assets
 } // namespace pvr
@@ -0,0 +1,715 @@
+/*!
+\brief Implementation of the baked binary model cache.
+\file PVRAssets/fileio/ModelCache.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRAssets/fileio/ModelCache.h"
+#include "PVRCore/strings/CompileTimeHash.h"
+#include "PVRCore/Log.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace pvr {
+namespace assets {
+namespace {
+const uint32_t c_modelCacheMagic = 0x4D525650; // "PVRM"
+const size_t c_blockAlignment = 16;
+
+// Fixed size header at the very start of the cache. The payload starts right after it, on a block boundary.
+struct ModelCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t payloadSize;
+	uint64_t sourceHash;
+	uint64_t sourceSize;
+	uint64_t sourceModifiedTime;
+	uint64_t reserved;
+};
+static_assert(sizeof(ModelCacheHeader) % c_blockAlignment == 0, "Model cache header must keep the payload aligned");
+
+class CacheWriter
+{
+public:
+	CacheWriter() { _data.reserve(1024 * 1024); }
+
+	template<typename T>
+	void write(const T& value)
+	{
+		append(&value, sizeof(T));
+	}
+
+	void writeString(const std::string& str)
+	{
+		write(static_cast<uint32_t>(str.size()));
+		append(str.data(), str.size());
+	}
+
+	// Large arrays are written as aligned blocks so that the reader can copy them out with a single memcpy.
+	void writeBlock(const void* data, size_t size)
+	{
+		write(static_cast<uint64_t>(size));
+		_data.resize((_data.size() + c_blockAlignment - 1) & ~(c_blockAlignment - 1), 0);
+		append(data, size);
+	}
+
+	template<typename T>
+	void writeVector(const std::vector<T>& vec)
+	{
+		writeBlock(vec.data(), vec.size() * sizeof(T));
+	}
+
+	const std::vector<uint8_t>& getData() const { return _data; }
+
+private:
+	void append(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		_data.insert(_data.end(), bytes, bytes + size);
+	}
+
+	std::vector<uint8_t> _data;
+};
+
+class CacheReader
+{
+public:
+	CacheReader(const uint8_t* begin, size_t size) : _begin(begin), _current(begin), _end(begin + size) {}
+
+	template<typename T>
+	T read()
+	{
+		T value;
+		readRaw(&value, sizeof(T));
+		return value;
+	}
+
+	void readRaw(void* outData, size_t size) { memcpy(outData, advance(size), size); }
+
+	std::string readString()
+	{
+		uint32_t size = read<uint32_t>();
+		const char* chars = reinterpret_cast<const char*>(advance(size));
+		return std::string(chars, size);
+	}
+
+	// Returns a pointer to the block inside the cache. The pointer stays valid as long as the cache memory does.
+	const uint8_t* readBlock(size_t& outSize)
+	{
+		outSize = static_cast<size_t>(read<uint64_t>());
+		size_t offset = static_cast<size_t>(_current - _begin);
+		advance(((offset + c_blockAlignment - 1) & ~(c_blockAlignment - 1)) - offset);
+		return advance(outSize);
+	}
+
+	template<typename T>
+	void readVector(std::vector<T>& outVector)
+	{
+		size_t size;
+		const uint8_t* block = readBlock(size);
+		if (size % sizeof(T)) { throw InvalidDataError("[ModelCache]: Block size is not a multiple of its element size"); }
+		outVector.resize(size / sizeof(T));
+		if (size) { memcpy(outVector.data(), block, size); }
+	}
+
+private:
+	const uint8_t* advance(size_t size)
+	{
+		if (static_cast<size_t>(_end - _current) < size) { throw InvalidDataError("[ModelCache]: Attempted to read past the end of the cache"); }
+		const uint8_t* retval = _current;
+		_current += size;
+		return retval;
+	}
+
+	const uint8_t* _begin;
+	const uint8_t* _current;
+	const uint8_t* _end;
+};
+
+//////////////////////////////////////////////// WRITING ////////////////////////////////////////////////
+void writeFreeValue(CacheWriter& writer, const FreeValue& value)
+{
+	writer.write(static_cast<uint32_t>(value.dataType()));
+	writer.write(value.arrayElements());
+	// The FreeValue always carries its value inline, so the whole 64 byte storage is written verbatim.
+	uint8_t storage[64];
+	memcpy(storage, &value.interpretValueAs<uint8_t>(), sizeof(storage));
+	writer.write(storage);
+}
+
+void writeSemantics(CacheWriter& writer, const std::map<StringHash, FreeValue>& semantics)
+{
+	writer.write(static_cast<uint32_t>(semantics.size()));
+	for (auto& semantic : semantics)
+	{
+		writer.writeString(semantic.first.str());
+		writeFreeValue(writer, semantic.second);
+	}
+}
+
+void writeCustomData(CacheWriter& writer, const CustomData& data)
+{
+	writer.write(static_cast<uint32_t>(data.GetType()));
+	switch (data.GetType())
+	{
+	case CustomData::Type::NONE: break;
+	case CustomData::Type::NUMBER: writer.write(data.GetDouble()); break;
+	case CustomData::Type::INT: writer.write(static_cast<int32_t>(data.GetInt())); break;
+	case CustomData::Type::BOOL: writer.write(static_cast<uint8_t>(data.GetBool())); break;
+	case CustomData::Type::STRING: writer.writeString(data.GetString()); break;
+	case CustomData::Type::BINARY: writer.writeVector(data.GetBinary()); break;
+	case CustomData::Type::ARRAY:
+		writer.write(static_cast<uint32_t>(data.ArrayLen()));
+		for (auto& element : data.GetArray()) { writeCustomData(writer, element); }
+		break;
+	case CustomData::Type::OBJECT:
+	{
+		std::vector<std::string> keys = data.Keys();
+		writer.write(static_cast<uint32_t>(keys.size()));
+		for (auto& key : keys)
+		{
+			writer.writeString(key);
+			writeCustomData(writer, data.Get(key));
+		}
+		break;
+	}
+	}
+}
+
+void writeMesh(CacheWriter& writer, const Mesh& mesh)
+{
+	const Mesh::InternalData& data = mesh.getInternalData();
+	writeSemantics(writer, data.semantics);
+
+	// Attributes are written in the order of their indices, so that re-inserting them reproduces the same indices.
+	std::vector<size_t> attributeIndices;
+	for (auto it = data.vertexAttributes.indexed_begin(); it != data.vertexAttributes.indexed_end(); ++it) { attributeIndices.emplace_back(it->second); }
+	std::sort(attributeIndices.begin(), attributeIndices.end());
+
+	writer.write(static_cast<uint32_t>(attributeIndices.size()));
+	for (size_t index : attributeIndices)
+	{
+		const Mesh::VertexAttributeData& attribute = data.vertexAttributes[index];
+		writer.writeString(attribute.getSemantic().str());
+		writer.write(static_cast<uint32_t>(attribute.getVertexLayout().dataType));
+		writer.write(static_cast<uint32_t>(attribute.getN()));
+		writer.write(attribute.getOffset());
+		writer.write(attribute.getDataIndex());
+	}
+
+	writer.write(static_cast<uint32_t>(data.vertexAttributeDataBlocks.size()));
+	for (auto& block : data.vertexAttributeDataBlocks)
+	{
+		writer.write(static_cast<uint32_t>(block.stride));
+		writer.writeBlock(block.data(), block.size());
+	}
+
+	writer.write(data.numBones);
+	writer.write(static_cast<uint32_t>(data.faces.getDataType()));
+	writer.writeBlock(data.faces.getData(), data.faces.getDataSize());
+
+	const Mesh::MeshInfo& info = data.primitiveData;
+	writer.write(info.numVertices);
+	writer.write(info.numFaces);
+	writer.writeVector(info.stripLengths);
+	writer.write(info.numPatchSubdivisions);
+	writer.write(info.numPatches);
+	writer.write(info.numControlPointsPerPatch);
+	writer.write(info.units);
+	writer.write(static_cast<uint32_t>(info.primitiveType));
+	writer.write(static_cast<uint8_t>(info.isIndexed));
+	writer.write(static_cast<uint8_t>(info.isSkinned));
+	writer.write(info.min);
+	writer.write(info.max);
+
+	writer.write(data.skeleton);
+	writer.write(data.unpackMatrix);
+}
+
+void writeNode(CacheWriter& writer, const Node& node)
+{
+	const Node::InternalData& data = node.getInternalData();
+	writer.writeString(data.name.str());
+	writer.write(data.objectIndex);
+	writer.write(data.materialIndex);
+	writer.write(data.parentIndex);
+	writer.writeVector(data.userData);
+	writeCustomData(writer, data.formattedUserData);
+	writer.write(data.frameTransform);
+	writer.write(data.scale);
+	writer.write(data.rotation);
+	writer.write(data.translation);
+	writer.write(data.transformFlags);
+	writer.write(data.skin);
+	writer.write(static_cast<uint8_t>(data.hasAnimation));
+}
+
+void writeMaterial(CacheWriter& writer, const Material& material)
+{
+	const Material::InternalData& data = material.getInternalData();
+	writeSemantics(writer, data.materialSemantics);
+	writer.write(static_cast<uint32_t>(data.textureIndices.size()));
+	for (auto& texture : data.textureIndices)
+	{
+		writer.writeString(texture.first.str());
+		writer.write(texture.second);
+	}
+	writer.writeString(data.name.str());
+	writer.writeString(data.effectFile.str());
+	writer.writeString(data.effectName.str());
+	writer.writeVector(data.userData);
+	writeCustomData(writer, data.formattedUserData);
+}
+
+void writeCamera(CacheWriter& writer, const Camera& camera)
+{
+	const Camera::InternalData& data = camera.getInternalData();
+	writer.write(data.targetNodeIdx);
+	writer.write(data.farClip);
+	writer.write(data.nearClip);
+	writer.writeVector(data.fovs);
+	writeCustomData(writer, camera.getFormattedUserData());
+}
+
+void writeLight(CacheWriter& writer, const Light& light)
+{
+	const Light::InternalData& data = light.getInternalData();
+	writer.write(data.spotTargetNodeIdx);
+	writer.write(data.color);
+	writer.write(static_cast<uint32_t>(data.type));
+	writer.write(data.constantAttenuation);
+	writer.write(data.linearAttenuation);
+	writer.write(data.quadraticAttenuation);
+	writer.write(data.falloffAngle);
+	writer.write(data.falloffExponent);
+}
+
+void writeAnimationData(CacheWriter& writer, const AnimationData& animation)
+{
+	const AnimationData::InternalData& data = animation.getInternalData();
+	writer.write(data.flags);
+	writer.writeVector(data.positionIndices);
+	writer.writeVector(data.rotationIndices);
+	writer.writeVector(data.scaleIndices);
+	writer.writeVector(data.matrixIndices);
+	writer.write(data.numFrames);
+	writer.writeString(data.animationName);
+	writer.writeVector(data.timeInSeconds);
+	writer.write(static_cast<uint32_t>(data.keyFrames.size()));
+	for (auto& keyFrame : data.keyFrames)
+	{
+		writer.writeVector(keyFrame.timeInSeconds);
+		writer.writeVector(keyFrame.scale);
+		writer.writeVector(keyFrame.rotate);
+		writer.writeVector(keyFrame.translation);
+		writer.writeVector(keyFrame.mat4);
+		writer.write(static_cast<uint32_t>(keyFrame.interpolation));
+	}
+	writer.write(data.startTime);
+	writer.write(data.endTime);
+	writeCustomData(writer, data.formattedUserData);
+}
+
+void writeAnimationInstance(CacheWriter& writer, const Model::InternalData& modelData, const AnimationInstance& instance)
+{
+	// Pointers into the model are converted to indices so that they can be re-targeted on load.
+	uint32_t animationIndex = static_cast<uint32_t>(-1);
+	for (uint32_t i = 0; i < modelData.animationsData.size(); ++i)
+	{
+		if (&modelData.animationsData[i] == instance.animationData) { animationIndex = i; }
+	}
+	writer.write(animationIndex);
+	writer.write(static_cast<uint32_t>(instance.keyframeChannels.size()));
+	for (auto& channel : instance.keyframeChannels)
+	{
+		writer.write(channel.keyFrame);
+		std::vector<uint32_t> nodeIndices(channel.nodes.size());
+		for (size_t i = 0; i < channel.nodes.size(); ++i)
+		{ nodeIndices[i] = static_cast<uint32_t>(static_cast<const Node*>(channel.nodes[i]) - modelData.nodes.data()); }
+		writer.writeVector(nodeIndices);
+	}
+}
+
+
+//////////////////////////////////////////////// READING ////////////////////////////////////////////////
+void readFreeValue(CacheReader& reader, FreeValue& value)
+{
+	GpuDatatypes dataType = static_cast<GpuDatatypes>(reader.read<uint32_t>());
+	uint32_t arrayElements = reader.read<uint32_t>();
+	reader.readRaw(&value.interpretValueAs<uint8_t>(), 64);
+	value.setDataType(dataType);
+	value.setArrayElements(arrayElements);
+}
+
+void readSemantics(CacheReader& reader, std::map<StringHash, FreeValue>& semantics)
+{
+	uint32_t count = reader.read<uint32_t>();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		StringHash semantic(reader.readString());
+		readFreeValue(reader, semantics[semantic]);
+	}
+}
+
+CustomData readCustomData(CacheReader& reader)
+{
+	CustomData::Type type = static_cast<CustomData::Type>(reader.read<uint32_t>());
+	switch (type)
+	{
+	case CustomData::Type::NONE: return CustomData();
+	case CustomData::Type::NUMBER: return CustomData(reader.read<double>());
+	case CustomData::Type::INT: return CustomData(static_cast<int>(reader.read<int32_t>()));
+	case CustomData::Type::BOOL: return CustomData(reader.read<uint8_t>() != 0);
+	case CustomData::Type::STRING: return CustomData(reader.readString());
+	case CustomData::Type::BINARY:
+	{
+		size_t size;
+		const uint8_t* block = reader.readBlock(size);
+		return CustomData(block, size);
+	}
+	case CustomData::Type::ARRAY:
+	{
+		CustomData::Array array(reader.read<uint32_t>());
+		for (auto& element : array) { element = readCustomData(reader); }
+		return CustomData(array);
+	}
+	case CustomData::Type::OBJECT:
+	{
+		CustomData::Object object;
+		uint32_t count = reader.read<uint32_t>();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			std::string key = reader.readString();
+			object[key] = readCustomData(reader);
+		}
+		return CustomData(object);
+	}
+	}
+	throw InvalidDataError("[ModelCache]: Unknown formatted user data type");
+}
+
+void readMesh(CacheReader& reader, Mesh& mesh)
+{
+	Mesh::InternalData& data = mesh.getInternalData();
+	readSemantics(reader, data.semantics);
+
+	uint32_t numAttributes = reader.read<uint32_t>();
+	for (uint32_t i = 0; i < numAttributes; ++i)
+	{
+		StringHash semantic(reader.readString());
+		DataType dataType = static_cast<DataType>(reader.read<uint32_t>());
+		uint32_t width = reader.read<uint32_t>();
+		uint32_t offset = reader.read<uint32_t>();
+		uint32_t dataIndex = reader.read<uint32_t>();
+		mesh.addVertexAttribute(semantic, dataType, width, offset, dataIndex);
+	}
+
+	data.vertexAttributeDataBlocks.resize(reader.read<uint32_t>());
+	for (auto& block : data.vertexAttributeDataBlocks)
+	{
+		block.stride = static_cast<uint16_t>(reader.read<uint32_t>());
+		reader.readVector<unsigned char>(block);
+	}
+
+	data.numBones = reader.read<uint32_t>();
+	IndexType indexType = static_cast<IndexType>(reader.read<uint32_t>());
+	size_t faceDataSize;
+	const uint8_t* faceData = reader.readBlock(faceDataSize);
+	data.faces.setData(faceData, static_cast<uint32_t>(faceDataSize), indexType);
+
+	Mesh::MeshInfo& info = data.primitiveData;
+	info.numVertices = reader.read<uint32_t>();
+	info.numFaces = reader.read<uint32_t>();
+	reader.readVector(info.stripLengths);
+	info.numPatchSubdivisions = reader.read<uint32_t>();
+	info.numPatches = reader.read<uint32_t>();
+	info.numControlPointsPerPatch = reader.read<uint32_t>();
+	info.units = reader.read<float>();
+	info.primitiveType = static_cast<PrimitiveTopology>(reader.read<uint32_t>());
+	info.isIndexed = reader.read<uint8_t>() != 0;
+	info.isSkinned = reader.read<uint8_t>() != 0;
+	info.min = reader.read<glm::vec3>();
+	info.max = reader.read<glm::vec3>();
+
+	data.skeleton = reader.read<int32_t>();
+	data.unpackMatrix = reader.read<glm::mat4x4>();
+}
+
+void readNode(CacheReader& reader, Node& node)
+{
+	Node::InternalData& data = node.getInternalData();
+	data.name = reader.readString();
+	data.objectIndex = reader.read<uint32_t>();
+	data.materialIndex = reader.read<uint32_t>();
+	data.parentIndex = reader.read<uint32_t>();
+	reader.readVector(data.userData);
+	data.formattedUserData = readCustomData(reader);
+	reader.readRaw(data.frameTransform, sizeof(data.frameTransform));
+	data.scale = reader.read<glm::vec3>();
+	data.rotation = reader.read<glm::quat>();
+	data.translation = reader.read<glm::vec3>();
+	data.transformFlags = reader.read<uint32_t>();
+	data.skin = reader.read<int32_t>();
+	data.hasAnimation = reader.read<uint8_t>() != 0;
+}
+
+void readMaterial(CacheReader& reader, Material& material)
+{
+	Material::InternalData& data = material.getInternalData();
+	readSemantics(reader, data.materialSemantics);
+	uint32_t numTextures = reader.read<uint32_t>();
+	for (uint32_t i = 0; i < numTextures; ++i)
+	{
+		StringHash semantic(reader.readString());
+		data.textureIndices[semantic] = reader.read<uint32_t>();
+	}
+	data.name = reader.readString();
+	data.effectFile = reader.readString();
+	data.effectName = reader.readString();
+	reader.readVector(data.userData);
+	data.formattedUserData = readCustomData(reader);
+}
+
+void readCamera(CacheReader& reader, Camera& camera)
+{
+	Camera::InternalData& data = camera.getInternalData();
+	data.targetNodeIdx = reader.read<int32_t>();
+	data.farClip = reader.read<float>();
+	data.nearClip = reader.read<float>();
+	reader.readVector(data.fovs);
+	camera.getFormattedUserData() = readCustomData(reader);
+}
+
+void readLight(CacheReader& reader, Light& light)
+{
+	Light::InternalData& data = light.getInternalData();
+	data.spotTargetNodeIdx = reader.read<int32_t>();
+	data.color = reader.read<glm::vec3>();
+	data.type = static_cast<Light::LightType>(reader.read<uint32_t>());
+	data.constantAttenuation = reader.read<float>();
+	data.linearAttenuation = reader.read<float>();
+	data.quadraticAttenuation = reader.read<float>();
+	data.falloffAngle = reader.read<float>();
+	data.falloffExponent = reader.read<float>();
+}
+
+void readAnimationData(CacheReader& reader, AnimationData& animation)
+{
+	AnimationData::InternalData& data = animation.getInternalData();
+	data.flags = reader.read<uint32_t>();
+	reader.readVector(data.positionIndices);
+	reader.readVector(data.rotationIndices);
+	reader.readVector(data.scaleIndices);
+	reader.readVector(data.matrixIndices);
+	data.numFrames = reader.read<uint32_t>();
+	data.animationName = reader.readString();
+	reader.readVector(data.timeInSeconds);
+	data.keyFrames.resize(reader.read<uint32_t>());
+	for (auto& keyFrame : data.keyFrames)
+	{
+		reader.readVector(keyFrame.timeInSeconds);
+		reader.readVector(keyFrame.scale);
+		reader.readVector(keyFrame.rotate);
+		reader.readVector(keyFrame.translation);
+		reader.readVector(keyFrame.mat4);
+		keyFrame.interpolation = static_cast<KeyFrameData::InterpolationType>(reader.read<uint32_t>());
+	}
+	data.startTime = reader.read<float>();
+	data.endTime = reader.read<float>();
+	data.formattedUserData = readCustomData(reader);
+}
+
+void readAnimationInstance(CacheReader& reader, Model::InternalData& modelData, AnimationInstance& instance)
+{
+	uint32_t animationIndex = reader.read<uint32_t>();
+	if (animationIndex != static_cast<uint32_t>(-1))
+	{
+		if (animationIndex >= modelData.animationsData.size()) { throw InvalidDataError("[ModelCache]: Invalid animation index"); }
+		instance.animationData = &modelData.animationsData[animationIndex];
+	}
+	instance.keyframeChannels.resize(reader.read<uint32_t>());
+	std::vector<uint32_t> nodeIndices;
+	for (auto& channel : instance.keyframeChannels)
+	{
+		channel.keyFrame = reader.read<uint32_t>();
+		reader.readVector(nodeIndices);
+		channel.nodes.resize(nodeIndices.size());
+		for (size_t i = 0; i < nodeIndices.size(); ++i)
+		{
+			if (nodeIndices[i] >= modelData.nodes.size()) { throw InvalidDataError("[ModelCache]: Invalid animated node index"); }
+			channel.nodes[i] = &modelData.nodes[nodeIndices[i]];
+		}
+	}
+}
+
+void readModel(CacheReader& reader, Model& model)
+{
+	Model::InternalData& data = model.getInternalData();
+	readSemantics(reader, data.semantics);
+	reader.readRaw(data.clearColor, sizeof(data.clearColor));
+	reader.readRaw(data.ambientColor, sizeof(data.ambientColor));
+
+	// All arrays are sized before they are populated, so that pointers into them (animation channels) remain stable.
+	data.meshes.resize(reader.read<uint32_t>());
+	for (auto& mesh : data.meshes) { readMesh(reader, mesh); }
+	data.cameras.resize(reader.read<uint32_t>());
+	for (auto& camera : data.cameras) { readCamera(reader, camera); }
+	data.lights.resize(reader.read<uint32_t>());
+	for (auto& light : data.lights) { readLight(reader, light); }
+	data.textures.resize(reader.read<uint32_t>());
+	for (auto& texture : data.textures) { texture.setName(reader.readString()); }
+	data.materials.resize(reader.read<uint32_t>());
+	for (auto& material : data.materials) { readMaterial(reader, material); }
+	data.nodes.resize(reader.read<uint32_t>());
+	for (auto& node : data.nodes) { readNode(reader, node); }
+	data.skeletons.resize(reader.read<uint32_t>());
+	for (auto& skeleton : data.skeletons)
+	{
+		skeleton.name = reader.readString();
+		reader.readVector(skeleton.bones);
+		reader.readVector(skeleton.invBindMatrices);
+	}
+	data.animationsData.resize(reader.read<uint32_t>());
+	for (auto& animation : data.animationsData) { readAnimationData(reader, animation); }
+	data.animationInstances.resize(reader.read<uint32_t>());
+	for (auto& instance : data.animationInstances) { readAnimationInstance(reader, data, instance); }
+
+	data.numMeshNodes = reader.read<uint32_t>();
+	data.numLightNodes = reader.read<uint32_t>();
+	data.numCameraNodes = reader.read<uint32_t>();
+	data.numFrames = reader.read<uint32_t>();
+	data.currentFrame = reader.read<float>();
+	data.FPS = reader.read<float>();
+	reader.readVector(data.userData);
+	data.units = reader.read<float>();
+	data.flags = reader.read<uint32_t>();
+	data.formattedUserData = readCustomData(reader);
+}
+
+void writeModel(CacheWriter& writer, const Model& model)
+{
+	const Model::InternalData& data = model.getInternalData();
+	writeSemantics(writer, data.semantics);
+	writer.write(data.clearColor);
+	writer.write(data.ambientColor);
+
+	writer.write(static_cast<uint32_t>(data.meshes.size()));
+	for (auto& mesh : data.meshes) { writeMesh(writer, mesh); }
+	writer.write(static_cast<uint32_t>(data.cameras.size()));
+	for (auto& camera : data.cameras) { writeCamera(writer, camera); }
+	writer.write(static_cast<uint32_t>(data.lights.size()));
+	for (auto& light : data.lights) { writeLight(writer, light); }
+	writer.write(static_cast<uint32_t>(data.textures.size()));
+	for (auto& texture : data.textures) { writer.writeString(texture.getName().str()); }
+	writer.write(static_cast<uint32_t>(data.materials.size()));
+	for (auto& material : data.materials) { writeMaterial(writer, material); }
+	writer.write(static_cast<uint32_t>(data.nodes.size()));
+	for (auto& node : data.nodes) { writeNode(writer, node); }
+	writer.write(static_cast<uint32_t>(data.skeletons.size()));
+	for (auto& skeleton : data.skeletons)
+	{
+		writer.writeString(skeleton.name);
+		writer.writeVector(skeleton.bones);
+		writer.writeVector(skeleton.invBindMatrices);
+	}
+	writer.write(static_cast<uint32_t>(data.animationsData.size()));
+	for (auto& animation : data.animationsData) { writeAnimationData(writer, animation); }
+	writer.write(static_cast<uint32_t>(data.animationInstances.size()));
+	for (auto& instance : data.animationInstances) { writeAnimationInstance(writer, data, instance); }
+
+	writer.write(data.numMeshNodes);
+	writer.write(data.numLightNodes);
+	writer.write(data.numCameraNodes);
+	writer.write(data.numFrames);
+	writer.write(data.currentFrame);
+	writer.write(data.FPS);
+	writer.writeVector(data.userData);
+	writer.write(data.units);
+	writer.write(data.flags);
+	writeCustomData(writer, data.formattedUserData);
+}
+} // namespace
+
+uint64_t computeModelSourceHash(const void* sourceData, size_t sourceSize)
+{
+	uint64_t hash = hash64_bytes(&ModelCacheVersion, sizeof(ModelCacheVersion));
+	return hash64_bytes(sourceData, sourceSize, hash);
+}
+
+bool getModelSourceFileInfo(const std::string& path, ModelCacheSource& outSource)
+{
+#ifdef _WIN32
+	struct _stat64 fileStat;
+	if (_stat64(path.c_str(), &fileStat) != 0 || !(fileStat.st_mode & _S_IFREG)) { return false; }
+#else
+	struct stat fileStat;
+	if (stat(path.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) { return false; }
+#endif
+	outSource.size = static_cast<uint64_t>(fileStat.st_size);
+	outSource.modifiedTime = static_cast<uint64_t>(fileStat.st_mtime);
+	return true;
+}
+
+void writeModelCache(const Model& model, const ModelCacheSource& source, Stream& stream)
+{
+	CacheWriter writer;
+	writeModel(writer, model);
+
+	ModelCacheHeader header = {};
+	header.magic = c_modelCacheMagic;
+	header.version = ModelCacheVersion;
+	header.payloadSize = writer.getData().size();
+	header.sourceHash = source.hash;
+	header.sourceSize = source.size;
+	header.sourceModifiedTime = source.modifiedTime;
+	stream.writeExact(sizeof(header), 1, &header);
+	stream.writeExact(1, writer.getData().size(), writer.getData().data());
+}
+
+bool isModelCache(const void* data, size_t size)
+{
+	if (!data || size < sizeof(ModelCacheHeader)) { return false; }
+	ModelCacheHeader header;
+	memcpy(&header, data, sizeof(header));
+	return header.magic == c_modelCacheMagic && header.version == ModelCacheVersion && header.payloadSize <= size - sizeof(header);
+}
+
+bool readModelCacheSource(const void* data, size_t size, ModelCacheSource& outSource)
+{
+	if (!isModelCache(data, size)) { return false; }
+	ModelCacheHeader header;
+	memcpy(&header, data, sizeof(header));
+	outSource.hash = header.sourceHash;
+	outSource.size = header.sourceSize;
+	outSource.modifiedTime = header.sourceModifiedTime;
+	return true;
+}
+
+bool readModelCache(const void* data, size_t size, Model& outModel)
+{
+	if (!isModelCache(data, size)) { return false; }
+	ModelCacheHeader header;
+	memcpy(&header, data, sizeof(header));
+
+	// Block alignment is computed relative to the start of the cache, which is page aligned when the cache is mapped.
+	CacheReader reader(static_cast<const uint8_t*>(data), sizeof(header) + static_cast<size_t>(header.payloadSize));
+	try
+	{
+		reader.readRaw(&header, sizeof(header));
+		readModel(reader, outModel);
+	}
+	catch (const InvalidDataError& e)
+	{
+		Log(LogLevel::Warning, "Discarding corrupted model cache: %s", e.what());
+		outModel.destroy();
+		return false;
+	}
+	return true;
+}
+} // namespace assets
+} // namespace pvr
+//!\endcond
@@ -0,0 +1,78 @@
+/*!
+\brief Functions to write and read baked binary model caches, a flat representation of a fully loaded pvr::assets::Model.
+\file PVRAssets/fileio/ModelCache.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+
+#include "PVRAssets/Model.h"
+#include "PVRCore/stream/Stream.h"
+
+namespace pvr {
+namespace assets {
+
+/// <summary>The current version of the model cache format. Caches written with a different version are rejected.</summary>
+static const uint32_t ModelCacheVersion = 2;
+
+/// <summary>The file extension used for model caches created by loadModel.</summary>
+static const char* const ModelCacheExtension = ".pvrmc";
+
+/// <summary>Identifies the source file a model cache was created from.</summary>
+struct ModelCacheSource
+{
+	uint64_t hash; //!< Hash of the source contents (see computeModelSourceHash)
+	uint64_t size; //!< Size of the source file in bytes
+	uint64_t modifiedTime; //!< Last modification time of the source file in seconds, or 0 if it is not a file on disk
+
+	/// <summary>Constructor. Creates an unknown source.</summary>
+	ModelCacheSource() : hash(0), size(0), modifiedTime(0) {}
+};
+
+/// <summary>Compute the content hash used to validate a model cache against its source file.</summary>
+/// <param name="sourceData">Pointer to the complete contents of the source model file (POD, glTF...)</param>
+/// <param name="sourceSize">The size, in bytes, of the source data</param>
+/// <returns>A 64 bit hash of the source data combined with the cache format version.</returns>
+uint64_t computeModelSourceHash(const void* sourceData, size_t sourceSize);
+
+/// <summary>Query the size and modification time of a source model file on disk, without reading it.</summary>
+/// <param name="path">The path of the source file</param>
+/// <param name="outSource">The size and modifiedTime members are populated. The hash is not touched.</param>
+/// <returns>True if the file exists on disk, false otherwise (for example for Android or Windows resource assets).
+/// </returns>
+bool getModelSourceFileInfo(const std::string& path, ModelCacheSource& outSource);
+
+/// <summary>Serialize a fully loaded Model into a model cache. All meshes, nodes, materials, textures, cameras, lights,
+/// skeletons and animations are written as a flat sequence of 16-byte aligned blocks. References between objects
+/// (for example animation channels to nodes) are stored as indices, never as pointers.</summary>
+/// <param name="model">The model to serialize</param>
+/// <param name="source">The source the model was loaded from. It is stored in the cache header and can be retrieved
+/// with readModelCacheSource to check whether the cache is up to date.</param>
+/// <param name="stream">A writable stream to write the cache to</param>
+void writeModelCache(const Model& model, const ModelCacheSource& source, Stream& stream);
+
+/// <summary>Read the source information stored in the header of a model cache.</summary>
+/// <param name="data">Pointer to the start of the cache</param>
+/// <param name="size">The size of the cache in bytes</param>
+/// <param name="outSource">The source the cache was created from</param>
+/// <returns>True if the data is a model cache of the current version, otherwise false.</returns>
+bool readModelCacheSource(const void* data, size_t size, ModelCacheSource& outSource);
+
+/// <summary>Rebuild a Model from a model cache residing in memory, typically a memory mapped file. No per-element
+/// parsing takes place: every array of the model is block-copied out of the cache. The caller is responsible for
+/// checking that the cache is up to date (see readModelCacheSource).</summary>
+/// <param name="data">Pointer to the start of the cache</param>
+/// <param name="size">The size of the cache in bytes</param>
+/// <param name="outModel">The model to populate. It is left empty if the cache is rejected.</param>
+/// <returns>True if the cache was valid and the model was populated, false if the cache was truncated or written by
+/// a different version of the format.</returns>
+bool readModelCache(const void* data, size_t size, Model& outModel);
+
+/// <summary>Check if a block of memory starts with a valid model cache header.</summary>
+/// <param name="data">Pointer to the start of the data</param>
+/// <param name="size">The size of the data in bytes</param>
+/// <returns>True if the data looks like a model cache of the current version</returns>
+bool isModelCache(const void* data, size_t size);
+
+} // namespace assets
+} // namespace pvr
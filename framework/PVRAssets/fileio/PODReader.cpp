@@ -11,6 +11,8 @@
 #include "PVRCore/Log.h"
 #include "PVRAssets/Helper.h"
 #include "PVRCore/stream/Stream.h"
+#include "PVRCore/stream/BufferStream.h"
+#include "PVRCore/JobSystem.h"
 #include <cstdio>
 #include <algorithm>
 using std::vector;
@@ -24,10 +26,11 @@ void readBytes(const Stream& stream, T& data)
 	stream.readExact(sizeof(T), 1, &data);
 }
 
+// Arrays are always read with a single call, never element by element.
 template<typename T>
 void readByteArray(const Stream& stream, T* data, uint32_t count)
 {
-	for (uint32_t i = 0; i < count; ++i) { readBytes(stream, data[i]); }
+	if (count) { stream.readExact(1, sizeof(T) * count, data); }
 }
 
 template<typename T>
@@ -48,11 +51,8 @@ template<typename T>
 inline void read4Bytes(const Stream& stream, T& data)
 {
 	// PVR_STATIC_ASSERT(read4BytesSizeAssert, sizeof(T) == 4)
-	unsigned char ub[4];
-	stream.readExact(4, 1, &ub);
-	uint32_t p;
-	p = static_cast<uint32_t>((ub[3] << 24) | (ub[2] << 16) | (ub[1] << 8) | ub[0]);
-	memcpy(&data, &p, 4);
+	stream.readExact(1, 4, &data);
+	utils::littleEndianToHost32(&data, 1);
 }
 
 template<typename T>
@@ -72,7 +72,9 @@ template<typename T>
 void read4ByteArray(const Stream& stream, T* data, uint32_t count)
 {
 	// PVR_STATIC_ASSERT(read4ByteArraySizeAssert, sizeof(T) == 4)
-	for (uint32_t i = 0; i < count; ++i) { read4Bytes(stream, data[i]); }
+	if (!count) { return; }
+	stream.readExact(1, 4 * static_cast<size_t>(count), data);
+	utils::littleEndianToHost32(data, count);
 }
 
 template<typename VectorType>
@@ -86,18 +88,17 @@ template<typename T>
 inline void read2Bytes(const Stream& stream, T& data)
 {
 	// PVR_STATIC_ASSERT(read2BytesSizeAssert, sizeof(T) == 2)
-	unsigned char ub[2];
-	size_t dataRead;
-	stream.read(2, 1, &ub, dataRead);
-	unsigned short* p = reinterpret_cast<unsigned short*>(&data);
-	*p = static_cast<unsigned short>((ub[1] << 8) | ub[0]);
+	stream.readExact(1, 2, &data);
+	utils::littleEndianToHost16(&data, 1);
 }
 
 template<typename T>
 void read2ByteArray(const Stream& stream, T* data, uint32_t count)
 {
 	// PVR_STATIC_ASSERT(read2ByteArraySizeAssert, sizeof(T) == 2)
-	for (uint32_t i = 0; i < count; ++i) { read2Bytes(stream, data[i]); }
+	if (!count) { return; }
+	stream.readExact(1, 2 * static_cast<size_t>(count), data);
+	utils::littleEndianToHost16(data, count);
 }
 
 template<typename T, typename vector_T>
@@ -134,13 +135,10 @@ template<typename T>
 inline bool read4BytesChecked(const Stream& stream, T& data)
 {
 	// PVR_STATIC_ASSERT(read4BytesSizeAssert, sizeof(T) == 4)
-	unsigned char ub[4];
 	size_t dataRead;
-	stream.read(4, 1, &ub, dataRead);
+	stream.read(4, 1, &data, dataRead);
 	if (dataRead != 1) { return false; }
-	uint32_t p;
-	p = static_cast<uint32_t>((ub[3] << 24) | (ub[2] << 16) | (ub[1] << 8) | ub[0]);
-	memcpy(&data, &p, 4);
+	utils::littleEndianToHost32(&data, 1);
 	return true;
 }
 
@@ -246,7 +244,7 @@ void readVertexData(const Stream& stream, assets::Mesh& mesh, const char* const
 				{
 				case 1: readByteArrayIntoVector<uint8_t>(stream, data, dataLength); break;
 				case 2: read2ByteArrayIntoVector<uint16_t>(stream, data, dataLength / 2); break;
-				case 4: read2ByteArrayIntoVector<uint32_t>(stream, data, dataLength / 4); break;
+				case 4: read4ByteArrayIntoVector<uint32_t>(stream, data, dataLength / 4); break;
 				default:
 				{
 					throw InvalidDataError("[PODReader::readVertexData] : Vertex DataType width was >4");
@@ -479,10 +477,9 @@ void readLightBlock(const Stream& stream, Light& light)
 }
 
 // Return the durration (time in sec) of this keyframe.
-float addKeyFrameTimeInMS(pvr::assets::Model& model, uint32_t numFrames, pvr::assets::KeyFrameData& outKeyFrame)
+float addKeyFrameTimeInMS(float fps, uint32_t numFrames, pvr::assets::KeyFrameData& outKeyFrame)
 {
 	// do the time
-	const float fps = model.getFPS();
 	const float duration = numFrames / fps;
 
 	// divide the durration between number of frames
@@ -492,19 +489,37 @@ float addKeyFrameTimeInMS(pvr::assets::Model& model, uint32_t numFrames, pvr::as
 	return duration;
 }
 
-void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Model::Node& node)
+// The animation data of a single node block. Node blocks are decoded in parallel, so instead of appending to the
+// shared animation of the model directly, each node collects its own, which is merged in node order afterwards.
+struct NodeAnimation
+{
+	enum Fields
+	{
+		Flags = 0x1,
+		PositionIndices = 0x2,
+		RotationIndices = 0x4,
+		ScaleIndices = 0x8,
+		MatrixIndices = 0x10,
+	};
+	std::vector<pvr::assets::KeyFrameData> keyFrames;
+	assets::AnimationInstance::KeyframeChannel nodeKeyframe[3]; // srt or mat4 as 0. Key frame indices are into keyFrames.
+	uint32_t fieldsRead; // The fields of the shared animation data that this node overrides
+	uint32_t flags;
+	std::vector<uint32_t> positionIndices;
+	std::vector<uint32_t> rotationIndices;
+	std::vector<uint32_t> scaleIndices;
+	std::vector<uint32_t> matrixIndices;
+	NodeAnimation() : fieldsRead(0), flags(0) {}
+};
+
+void readNodeBlock(const Stream& stream, float fps, assets::Model::Node& node, NodeAnimation& animation)
 {
 	uint32_t identifier, dataLength;
 	assets::Model::Node::InternalData& nodeInternData = node.getInternalData();
-	assets::AnimationData& animationData = model.getInternalData().animationsData[0];
-	assets::AnimationInstance& animationInstance = model.getAnimationInstance(0);
-
-	assets::AnimationInstance::KeyframeChannel nodeKeyframe[3]; // srt or mat4 as 0
-	animationInstance.animationData = &animationData;
+	assets::AnimationInstance::KeyframeChannel* nodeKeyframe = animation.nodeKeyframe;
+	std::vector<pvr::assets::KeyFrameData>& keyFrames = animation.keyFrames;
 
 	float animationTotalDurration = 0.0f;
-	AnimationData::InternalData& animInternData = animationData.getInternalData();
-	animInternData.numFrames = 0;
 	bool isOldFormat = false;
 	float pos[3] = { 0, 0, 0 };
 	float rotation[4] = { 0, 0, 0, 1 };
@@ -528,13 +543,6 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 				if (nodeInternData.transformFlags & pvr::assets::Node::InternalData::TransformFlags::Matrix) { memcpy(nodeInternData.frameTransform, matrix, sizeof(matrix)); }
 			}
 
-			for (uint32_t i = 0; i < ARRAY_SIZE(nodeKeyframe); ++i)
-			{
-				if (nodeKeyframe[i].nodes.size()) { animationInstance.keyframeChannels.emplace_back(nodeKeyframe[i]); }
-			}
-
-			animationData.computeDuration();
-
 			return;
 		}
 		case pod::e_nodeIndex | pod::c_startTagMask: read4Bytes(stream, nodeInternData.objectIndex); break;
@@ -570,16 +578,16 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 			transformArraySize = dataLength / sizeof(float) / 3;
 			if (transformArraySize > 1)
 			{
-				animationData.getInternalData().keyFrames.emplace_back(pvr::assets::KeyFrameData());
-				keyFrameData = &animationData.getInternalData().keyFrames.back();
+				keyFrames.emplace_back(pvr::assets::KeyFrameData());
+				keyFrameData = &keyFrames.back();
 
 				nodeKeyframe[2].nodes.emplace_back(&node);
-				nodeKeyframe[2].keyFrame = static_cast<uint32_t>(animationData.getInternalData().keyFrames.size()) - 1;
+				nodeKeyframe[2].keyFrame = static_cast<uint32_t>(keyFrames.size()) - 1;
 
 				keyFrameData->translation.resize(transformArraySize);
 				memcpy(keyFrameData->translation.data(), transformationData.data(), dataLength);
 				keyFrameData->interpolation = pvr::assets::KeyFrameData::InterpolationType::Linear;
-				animationTotalDurration = std::max(addKeyFrameTimeInMS(model, transformArraySize, *keyFrameData), animationTotalDurration);
+				animationTotalDurration = std::max(addKeyFrameTimeInMS(fps, transformArraySize, *keyFrameData), animationTotalDurration);
 				nodeInternData.hasAnimation = true;
 			}
 
@@ -597,10 +605,10 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 			read4ByteArrayIntoVector<float, float>(stream, transformationData, dataLength / sizeof(float));
 			if (transformArraySize > 1)
 			{
-				animationData.getInternalData().keyFrames.emplace_back(pvr::assets::KeyFrameData());
-				keyFrameData = &animationData.getInternalData().keyFrames.back();
+				keyFrames.emplace_back(pvr::assets::KeyFrameData());
+				keyFrameData = &keyFrames.back();
 				nodeKeyframe[1].nodes.emplace_back(&node);
-				nodeKeyframe[1].keyFrame = static_cast<uint32_t>(animationData.getInternalData().keyFrames.size()) - 1;
+				nodeKeyframe[1].keyFrame = static_cast<uint32_t>(keyFrames.size()) - 1;
 
 				keyFrameData->rotate.resize(transformArraySize);
 
@@ -611,7 +619,7 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 				}
 
 				keyFrameData->interpolation = pvr::assets::KeyFrameData::InterpolationType::Linear;
-				animationTotalDurration = std::max(addKeyFrameTimeInMS(model, transformArraySize, *keyFrameData), animationTotalDurration);
+				animationTotalDurration = std::max(addKeyFrameTimeInMS(fps, transformArraySize, *keyFrameData), animationTotalDurration);
 				nodeInternData.hasAnimation = true;
 			}
 			// store the first frame as the node transformation
@@ -628,10 +636,10 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 			read4ByteArrayIntoVector<float, float>(stream, transformationData, dataLength / sizeof(float));
 			if (transformArraySize > 1)
 			{
-				animationData.getInternalData().keyFrames.emplace_back(pvr::assets::KeyFrameData());
-				keyFrameData = &animationData.getInternalData().keyFrames.back();
+				keyFrames.emplace_back(pvr::assets::KeyFrameData());
+				keyFrameData = &keyFrames.back();
 				nodeKeyframe[0].nodes.emplace_back(&node);
-				nodeKeyframe[0].keyFrame = static_cast<uint32_t>(animationData.getInternalData().keyFrames.size()) - 1;
+				nodeKeyframe[0].keyFrame = static_cast<uint32_t>(keyFrames.size()) - 1;
 
 				keyFrameData->scale.resize(transformArraySize);
 
@@ -639,7 +647,7 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 				{ keyFrameData->scale[k] = glm::vec3(transformationData[k * 7], transformationData[k * 7 + 1], transformationData[k * 7 + 2]); }
 
 				keyFrameData->interpolation = pvr::assets::KeyFrameData::InterpolationType::Linear;
-				animationTotalDurration = std::max(addKeyFrameTimeInMS(model, transformArraySize, *keyFrameData), animationTotalDurration);
+				animationTotalDurration = std::max(addKeyFrameTimeInMS(fps, transformArraySize, *keyFrameData), animationTotalDurration);
 				nodeInternData.hasAnimation = true;
 			}
 
@@ -656,10 +664,10 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 			transformArraySize = dataLength / sizeof(float) / 16;
 			if (transformArraySize > 1)
 			{
-				animationData.getInternalData().keyFrames.emplace_back(pvr::assets::KeyFrameData());
-				keyFrameData = &animationData.getInternalData().keyFrames.back();
+				keyFrames.emplace_back(pvr::assets::KeyFrameData());
+				keyFrameData = &keyFrames.back();
 				nodeKeyframe[0].nodes.emplace_back(&node);
-				nodeKeyframe[0].keyFrame = static_cast<uint32_t>(animationData.getInternalData().keyFrames.size()) - 1;
+				nodeKeyframe[0].keyFrame = static_cast<uint32_t>(keyFrames.size()) - 1;
 				keyFrameData->mat4.resize(transformArraySize);
 				for (uint32_t m = 0; m < transformArraySize; m++) {
 				    for (uint32_t n = 0; n < 4; n++) {
@@ -669,28 +677,31 @@ void readNodeBlock(const Stream& stream, pvr::assets::Model& model, assets::Mode
 				}
 
 				keyFrameData->interpolation = pvr::assets::KeyFrameData::InterpolationType::Linear;
-				animationTotalDurration = std::max(addKeyFrameTimeInMS(model, transformArraySize, *keyFrameData), animationTotalDurration);
+				animationTotalDurration = std::max(addKeyFrameTimeInMS(fps, transformArraySize, *keyFrameData), animationTotalDurration);
 			}
 			memcpy(nodeInternData.frameTransform, transformationData.data(), sizeof(float) * 16);
 			nodeInternData.transformFlags = pvr::assets::Node::InternalData::TransformFlags::Matrix;
 
 			break;
-		case pod::e_nodeAnimationFlags | pod::c_startTagMask: read4Bytes(stream, animInternData.flags); break;
+		case pod::e_nodeAnimationFlags | pod::c_startTagMask:
+			read4Bytes(stream, animation.flags);
+			animation.fieldsRead |= NodeAnimation::Flags;
+			break;
 		case pod::e_nodeAnimationPositionIndex | pod::c_startTagMask:
-			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animInternData.positionIndices, dataLength / sizeof(uint32_t));
-			animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.positionIndices.size()));
+			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animation.positionIndices, dataLength / sizeof(uint32_t));
+			animation.fieldsRead |= NodeAnimation::PositionIndices;
 			break;
 		case pod::e_nodeAnimationRotationIndex | pod::c_startTagMask:
-			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animInternData.rotationIndices, dataLength / sizeof(uint32_t));
-			animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.rotationIndices.size()));
+			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animation.rotationIndices, dataLength / sizeof(uint32_t));
+			animation.fieldsRead |= NodeAnimation::RotationIndices;
 			break;
 		case pod::e_nodeAnimationScaleIndex | pod::c_startTagMask:
-			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animInternData.scaleIndices, dataLength / sizeof(uint32_t));
-			animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.scaleIndices.size()));
+			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animation.scaleIndices, dataLength / sizeof(uint32_t));
+			animation.fieldsRead |= NodeAnimation::ScaleIndices;
 			break;
 		case pod::e_nodeAnimationMatrixIndex | pod::c_startTagMask:
-			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animInternData.matrixIndices, dataLength / sizeof(uint32_t));
-			animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.matrixIndices.size()));
+			read4ByteArrayIntoVector<uint32_t, uint32_t>(stream, animation.matrixIndices, dataLength / sizeof(uint32_t));
+			animation.fieldsRead |= NodeAnimation::MatrixIndices;
 			break;
 		case pod::e_nodeUserData | pod::c_startTagMask: readByteArrayIntoVector<uint8_t>(stream, nodeInternData.userData, dataLength); break;
 		default: stream.seek(dataLength, Stream::SeekOriginFromCurrent); break;
@@ -703,59 +714,13 @@ static void fixInterleavedEndiannessUsingVertexData(StridedBuffer& interleaved,
 {
 	if (!data.getN()) { return; }
 	size_t ui32TypeSize = dataTypeSize(data.getVertexLayout().dataType);
-	char ub[4];
-	uint8_t* pData = interleaved.data() + static_cast<size_t>(data.getOffset());
-	switch (ui32TypeSize)
-	{
-	case 1: return;
-	case 2:
-	{
-		for (uint32_t i = 0; i < numVertices; ++i)
-		{
-			for (uint32_t j = 0; j < data.getN(); ++j)
-			{
-				ub[0] = pData[ui32TypeSize * j + 0];
-				ub[1] = pData[ui32TypeSize * j + 1];
-				((unsigned short*)pData)[j] = (unsigned short)((ub[1] << 8) | ub[0]);
-			}
-			pData += interleaved.stride;
-		}
-	}
-	break;
-	case 4:
-	{
-		for (uint32_t i = 0; i < numVertices; ++i)
-		{
-			for (uint32_t j = 0; j < data.getN(); ++j)
-			{
-				ub[0] = pData[ui32TypeSize * j + 0];
-				ub[1] = pData[ui32TypeSize * j + 1];
-				ub[2] = pData[ui32TypeSize * j + 2];
-				ub[3] = pData[ui32TypeSize * j + 3];
-				((uint32_t*)pData)[j] = static_cast<uint32_t>(((ub[3] << 24) | (ub[2] << 16) | (ub[1] << 8) | ub[0]));
-			}
-			pData += interleaved.stride;
-		}
-	}
-	break;
-	default:
-	{
-		throw InvalidDataError("[PODReader::fixInterleavedEndiannessUsingVertexData] Interleaved endianness fix - data type had width >4!");
-	}
-	};
-}
-
-static bool isLittleEndian()
-{
-	short int word = 0x0001;
-	char ret;
-	memcpy(&ret, &word, sizeof(char));
-	return ret ? true : false;
+	if (ui32TypeSize > 4) { throw InvalidDataError("[PODReader::fixInterleavedEndiannessUsingVertexData] Interleaved endianness fix - data type had width >4!"); }
+	utils::swapBytesStrided(interleaved.data() + static_cast<size_t>(data.getOffset()), ui32TypeSize, data.getN(), numVertices, interleaved.stride);
 }
 
 static void fixInterleavedEndianness(assets::Mesh::InternalData& data, int32_t interleavedDataIndex)
 {
-	if (interleavedDataIndex == -1 || isLittleEndian()) { return; }
+	if (interleavedDataIndex == -1 || utils::isLittleEndian()) { return; }
 	StridedBuffer& interleavedData = data.vertexAttributeDataBlocks[interleavedDataIndex];
 	assets::Mesh::VertexAttributeContainer::iterator walk = data.vertexAttributes.begin();
 	for (; walk != data.vertexAttributes.end(); ++walk)
@@ -924,7 +889,9 @@ void mergeBoneBatches(uint32_t boneIndexAttributeId, pvr::assets::Mesh& mesh, Bo
 	bonebatches.offsets[0] = 0;
 }
 
-void readMeshBlock(const Stream& stream, assets::Mesh& mesh, assets::Model& model)
+// The bones of the skeleton of the mesh (if any) are returned in outSkeletonBones rather than added to the model,
+// as meshes are decoded in parallel. Skeletons are created afterwards, in mesh order.
+void readMeshBlock(const Stream& stream, assets::Mesh& mesh, std::vector<uint32_t>& outSkeletonBones)
 {
 	BoneBatches boneBatches;
 
@@ -951,15 +918,7 @@ void readMeshBlock(const Stream& stream, assets::Mesh& mesh, assets::Model& mode
 			if (vDataId >= 0) { mergeBoneBatches(vDataId, mesh, boneBatches); }
 
 			// each mesh has own skeleton.
-			// Create a skeleton
-			if (boneBatches.batches.size())
-			{
-				model.getInternalData().skeletons.emplace_back(Skeleton());
-				Skeleton& skeleton = model.getInternalData().skeletons.back();
-
-				mesh.getInternalData().skeleton = static_cast<int32_t>(model.getInternalData().skeletons.size()) - 1;
-				skeleton.bones = boneBatches.batches;
-			}
+			outSkeletonBones = std::move(boneBatches.batches);
 
 			return;
 		}
@@ -1044,7 +1003,107 @@ void readMeshBlock(const Stream& stream, assets::Mesh& mesh, assets::Model& mode
 	if (boneBatches.numBones.size() != numBoneBatches) { throw InvalidDataError("[PODReader::readMeshBlock]: Number of bone batches was incorrect."); }
 }
 
-void readSceneBlock(const Stream& stream, assets::Model& model)
+// A block of the scene (mesh, node, material...) found by the scanning pass, to be decoded later.
+struct PodBlock
+{
+	uint32_t identifier; // The start tag of the block
+	uint32_t index; // The index of the object the block describes
+	size_t offset; // The offset of the contents of the block, right after its start tag
+	size_t size; // The size of the contents of the block, including its end tag
+	float fps; // The FPS of the scene at the point the block was found
+};
+
+// Skip a whole block without decoding it, leaving the stream right after its end tag (or at the end of the stream if
+// the block is not terminated).
+void skipBlock(const Stream& stream, uint32_t endTag)
+{
+	uint32_t identifier, dataLength;
+	while (readTag(stream, identifier, dataLength))
+	{
+		if (identifier == endTag) { return; }
+		stream.seek(dataLength, Stream::SeekOriginFromCurrent);
+	}
+}
+
+// Decode all blocks found by the scanning pass. Blocks only write to their own object, so they are decoded in
+// parallel, largest first. The little shared state they produce (skeletons, animation) is merged in file order after.
+void decodeSceneBlocks(const std::vector<PodBlock>& blocks, const uint8_t* podData, const std::string& fileName, assets::Model& model)
+{
+	assets::Model::InternalData& modelInternalData = model.getInternalData();
+	std::vector<std::vector<uint32_t>> skeletonBones(modelInternalData.meshes.size());
+	std::vector<NodeAnimation> nodeAnimations(modelInternalData.nodes.size());
+
+	std::vector<size_t> order(blocks.size());
+	for (size_t i = 0; i < order.size(); ++i) { order[i] = i; }
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return blocks[a].size > blocks[b].size; });
+
+	// One block per chunk, so that the workers pick up the blocks in order of decreasing size.
+	async::JobSystem::getInstance().parallelFor(0, static_cast<uint32_t>(order.size()), 1, [&](uint32_t first, uint32_t last) {
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const PodBlock& block = blocks[order[i]];
+			BufferStream blockStream(fileName, static_cast<const void*>(podData + block.offset), block.size);
+			switch (block.identifier)
+			{
+			case pod::e_sceneCamera | pod::c_startTagMask: readCameraBlock(blockStream, modelInternalData.cameras[block.index], block.fps); break;
+			case pod::e_sceneLight | pod::c_startTagMask: readLightBlock(blockStream, modelInternalData.lights[block.index]); break;
+			case pod::e_sceneMesh | pod::c_startTagMask: readMeshBlock(blockStream, modelInternalData.meshes[block.index], skeletonBones[block.index]); break;
+			case pod::e_sceneNode | pod::c_startTagMask: readNodeBlock(blockStream, block.fps, modelInternalData.nodes[block.index], nodeAnimations[block.index]); break;
+			case pod::e_sceneTexture | pod::c_startTagMask: readTextureBlock(blockStream, modelInternalData.textures[block.index]); break;
+			case pod::e_sceneMaterial | pod::c_startTagMask: readMaterialBlock(blockStream, modelInternalData.materials[block.index]); break;
+			}
+		}
+	});
+
+	// each mesh has own skeleton.
+	for (size_t i = 0; i < skeletonBones.size(); ++i)
+	{
+		if (skeletonBones[i].size())
+		{
+			modelInternalData.skeletons.emplace_back(Skeleton());
+			modelInternalData.meshes[i].getInternalData().skeleton = static_cast<int32_t>(modelInternalData.skeletons.size()) - 1;
+			modelInternalData.skeletons.back().bones = std::move(skeletonBones[i]);
+		}
+	}
+
+	AnimationData& animationData = modelInternalData.animationsData[0];
+	AnimationInstance& animationInstance = modelInternalData.animationInstances[0];
+	AnimationData::InternalData& animInternData = animationData.getInternalData();
+	for (NodeAnimation& nodeAnimation : nodeAnimations)
+	{
+		animationInstance.animationData = &animationData;
+		animInternData.numFrames = 0;
+		if (nodeAnimation.fieldsRead & NodeAnimation::Flags) { animInternData.flags = nodeAnimation.flags; }
+		if (nodeAnimation.fieldsRead & NodeAnimation::PositionIndices) { animInternData.positionIndices = std::move(nodeAnimation.positionIndices); }
+		if (nodeAnimation.fieldsRead & NodeAnimation::RotationIndices) { animInternData.rotationIndices = std::move(nodeAnimation.rotationIndices); }
+		if (nodeAnimation.fieldsRead & NodeAnimation::ScaleIndices) { animInternData.scaleIndices = std::move(nodeAnimation.scaleIndices); }
+		if (nodeAnimation.fieldsRead & NodeAnimation::MatrixIndices) { animInternData.matrixIndices = std::move(nodeAnimation.matrixIndices); }
+		if (nodeAnimation.fieldsRead & NodeAnimation::PositionIndices)
+		{ animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.positionIndices.size())); }
+		if (nodeAnimation.fieldsRead & NodeAnimation::RotationIndices)
+		{ animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.rotationIndices.size())); }
+		if (nodeAnimation.fieldsRead & NodeAnimation::ScaleIndices)
+		{ animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.scaleIndices.size())); }
+		if (nodeAnimation.fieldsRead & NodeAnimation::MatrixIndices)
+		{ animInternData.numFrames = std::max(animInternData.numFrames, static_cast<uint32_t>(animInternData.matrixIndices.size())); }
+
+		const uint32_t firstKeyFrame = static_cast<uint32_t>(animInternData.keyFrames.size());
+		for (auto& keyFrame : nodeAnimation.keyFrames) { animInternData.keyFrames.emplace_back(std::move(keyFrame)); }
+		for (uint32_t i = 0; i < ARRAY_SIZE(nodeAnimation.nodeKeyframe); ++i)
+		{
+			if (nodeAnimation.nodeKeyframe[i].nodes.size())
+			{
+				nodeAnimation.nodeKeyframe[i].keyFrame += firstKeyFrame;
+				animationInstance.keyframeChannels.emplace_back(std::move(nodeAnimation.nodeKeyframe[i]));
+			}
+		}
+	}
+	if (nodeAnimations.size()) { animationData.computeDuration(); }
+}
+
+// Reads the scene in two passes. The first one reads the scene properties and only records where each mesh, node,
+// material, texture, camera and light block is. The blocks are then decoded in parallel by decodeSceneBlocks.
+void readSceneBlock(const Stream& stream, const uint8_t* podData, assets::Model& model)
 {
 	uint32_t identifier, dataLength, temporaryInt;
 	assets::Model::InternalData& modelInternalData = model.getInternalData();
@@ -1055,6 +1114,18 @@ void readSceneBlock(const Stream& stream, assets::Model& model)
 	AnimationData& animation = modelInternalData.animationsData[0];
 	animation.setAnimationName("Default Animation");
 
+	std::vector<PodBlock> blocks;
+	auto recordBlock = [&](uint32_t index) {
+		PodBlock block;
+		block.identifier = identifier;
+		block.index = index;
+		block.offset = static_cast<size_t>(stream.getPosition());
+		block.fps = model.getFPS();
+		skipBlock(stream, identifier | pod::c_endTagMask);
+		block.size = static_cast<size_t>(stream.getPosition()) - block.offset;
+		blocks.emplace_back(block);
+	};
+
 	while (readTag(stream, identifier, dataLength))
 	{
 		switch (identifier)
@@ -1068,6 +1139,8 @@ void readSceneBlock(const Stream& stream, assets::Model& model)
 			if (numTextures != modelInternalData.textures.size()) { throw InvalidDataError("[PODReader::readSceneBlock]: Unknown error - Number of textures was incorrect."); }
 			if (numNodes != modelInternalData.nodes.size()) { throw InvalidDataError("[PODReader::readSceneBlock]: Unknown error - Number of nodes was incorrect."); }
 
+			decodeSceneBlocks(blocks, podData, stream.getFileName(), model);
+
 			// Loop through the skeleton and compute the bone's inverse bin matrices.
 			for (auto& skin : model.getInternalData().skeletons)
 			{
@@ -1111,12 +1184,12 @@ void readSceneBlock(const Stream& stream, assets::Model& model)
 			modelInternalData.materials.resize(temporaryInt);
 			break;
 		case pod::e_sceneNumFrames | pod::c_startTagMask: read4Bytes(stream, modelInternalData.numFrames); break;
-		case pod::e_sceneCamera | pod::c_startTagMask: readCameraBlock(stream, modelInternalData.cameras[numCameras++], model.getFPS()); break;
-		case pod::e_sceneLight | pod::c_startTagMask: readLightBlock(stream, modelInternalData.lights[numLights++]); break;
-		case pod::e_sceneMesh | pod::c_startTagMask: readMeshBlock(stream, modelInternalData.meshes[numMeshes++], model); break;
-		case pod::e_sceneNode | pod::c_startTagMask: readNodeBlock(stream, model, modelInternalData.nodes[numNodes++]); break;
-		case pod::e_sceneTexture | pod::c_startTagMask: readTextureBlock(stream, modelInternalData.textures[numTextures++]); break;
-		case pod::e_sceneMaterial | pod::c_startTagMask: readMaterialBlock(stream, modelInternalData.materials[numMaterials++]); break;
+		case pod::e_sceneCamera | pod::c_startTagMask: recordBlock(numCameras++); break;
+		case pod::e_sceneLight | pod::c_startTagMask: recordBlock(numLights++); break;
+		case pod::e_sceneMesh | pod::c_startTagMask: recordBlock(numMeshes++); break;
+		case pod::e_sceneNode | pod::c_startTagMask: recordBlock(numNodes++); break;
+		case pod::e_sceneTexture | pod::c_startTagMask: recordBlock(numTextures++); break;
+		case pod::e_sceneMaterial | pod::c_startTagMask: recordBlock(numMaterials++); break;
 		case pod::e_sceneFlags | pod::c_startTagMask: read4Bytes(stream, modelInternalData.flags); break;
 		case pod::e_sceneFPS | pod::c_startTagMask:
 			uint32_t fps;
@@ -1128,6 +1201,8 @@ void readSceneBlock(const Stream& stream, assets::Model& model)
 		default: stream.seek(dataLength, Stream::SeekOriginFromCurrent);
 		}
 	}
+	// The scene was not terminated. Still decode everything that was found, as a single pass reader would have.
+	decodeSceneBlocks(blocks, podData, stream.getFileName(), model);
 }
 } // namespace
 
@@ -1135,8 +1210,14 @@ namespace pvr {
 namespace assets {
 void readPOD(const ::pvr::Stream& stream, Model& model)
 {
+	// The whole file is brought into memory with a single read. All parsing then happens on this memory, which lets the
+	// blocks of the scene be decoded in parallel, each through its own stream.
+	const std::vector<uint8_t> podData = stream.readToEnd<uint8_t>();
+	if (podData.empty()) { return; }
+	BufferStream podStream(stream.getFileName(), static_cast<const void*>(podData.data()), podData.size());
+
 	uint32_t identifier, dataLength;
-	while (readTag(stream, identifier, dataLength))
+	while (readTag(podStream, identifier, dataLength))
 	{
 		switch (identifier)
 		{
@@ -1146,14 +1227,14 @@ void readPOD(const ::pvr::Stream& stream, Model& model)
 			if (dataLength != pod::c_PODFormatVersionLength) { throw InvalidDataError("[PODReader::readAsset_]: File Version Mismatch"); }
 			// ... it is. Check to see if the std::string matches
 			char filesVersion[pod::c_PODFormatVersionLength];
-			stream.readExact(1, dataLength, &filesVersion[0]);
+			podStream.readExact(1, dataLength, &filesVersion[0]);
 			if (strcmp(filesVersion, pod::c_PODFormatVersion) != 0) { throw InvalidDataError("[PODReader::readAsset_]: File Version Mismatch"); }
 		}
 			continue;
-		case pod::Scene | pod::c_startTagMask: readSceneBlock(stream, model); return;
+		case pod::Scene | pod::c_startTagMask: readSceneBlock(podStream, podData.data(), model); return;
 		default:
 			// Unhandled data, skip it
-			stream.seek(dataLength, Stream::SeekOriginFromCurrent);
+			podStream.seek(dataLength, Stream::SeekOriginFromCurrent);
 		}
 	}
 }
@@ -45,6 +45,8 @@ uint32_t AnimationData::getFlags() const { return _data.flags; }
 
 AnimationData::InternalData& AnimationData::getInternalData() { return _data; }
 
+const AnimationData::InternalData& AnimationData::getInternalData() const { return _data; }
+
 void AnimationInstance::updateAnimation(float time)
 {
 	time *= 0.001f; // ms to sec.
@@ -204,6 +204,10 @@ public:
 	/// <returns>A pointer to the internal structure of this object</returns>
 	InternalData& getInternalData(); // If you know what you're doing
 
+	/// <summary>Gets a direct, read-only reference to the data representation of this object. Advanced tasks only.</summary>
+	/// <returns>A const reference to the internal structure of this object</returns>
+	const InternalData& getInternalData() const;
+
 private:
 	InternalData _data;
 	// cache
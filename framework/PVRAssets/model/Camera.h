@@ -82,8 +82,14 @@ public:
 	/// <returns>A (modifiable) reference to the internal data.
 	inline InternalData& getInternalData() { return _data; }
 
+	/// <summary>Get a const reference to the internal data of this object.</summary>
+	/// <returns>A (read-only) reference to the internal data.
+	inline const InternalData& getInternalData() const { return _data; }
+
 	CustomData& getFormattedUserData() { return _customData; }
 
+	const CustomData& getFormattedUserData() const { return _customData; }
+
 private:
 	CustomData _customData;
 	InternalData _data;
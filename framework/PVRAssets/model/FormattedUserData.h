@@ -84,6 +84,10 @@ namespace assets {
 		{
 			return arrayValue;
 		}
+		inline const std::vector<uint8_t>& GetBinary() const
+		{
+			return binaryValue;
+		}
 
 		// Lookup value from an array
 		const CustomData& Get(std::size_t idx) const
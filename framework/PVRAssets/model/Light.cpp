@@ -48,6 +48,8 @@ void Light::setFalloffAngle(float fa) { _data.falloffAngle = fa; }
 void Light::setFalloffExponent(float fe) { _data.falloffExponent = fe; }
 
 Light::InternalData& Light::getInternalData() { return _data; }
+
+const Light::InternalData& Light::getInternalData() const { return _data; }
 } // namespace assets
 } // namespace pvr
 //!\endcond
\ No newline at end of file
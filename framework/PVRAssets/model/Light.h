@@ -112,6 +112,10 @@ public:
 	/// <returns>A reference to the internal representation of this object</returns>
 	InternalData& getInternalData(); // If you know what you're doing
 
+	/// <summary>Get a const reference to the internal representation of this object.</summary>
+	/// <returns>A const reference to the internal representation of this object</returns>
+	const InternalData& getInternalData() const;
+
 private:
 	InternalData _data;
 };
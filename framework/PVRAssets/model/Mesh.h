@@ -476,6 +476,10 @@ public:
 	/// <summary>Get a reference to the internal representation and data of this Mesh. Handle with care.</summary>
 	/// <returns>The internal representation of this object.</returns>
 	InternalData& getInternalData() { return _data; }
+
+	/// <summary>Get a const reference to the internal representation and data of this Mesh.</summary>
+	/// <returns>The internal representation of this object.</returns>
+	const InternalData& getInternalData() const { return _data; }
 };
 } // namespace assets
 } // namespace pvr
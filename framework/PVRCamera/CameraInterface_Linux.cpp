@@ -0,0 +1,676 @@
+/*!
+\brief Linux (Video4Linux2) implementation of the camera streaming interface.
+\file PVRCamera/CameraInterface_Linux.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#include "PVRCamera/CameraInterface.h"
+#include "PVRCore/Errors.h"
+#include "PVRCore/Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/videodev2.h>
+//!\cond NO_DOXYGEN
+
+// Camera sources are selected with the PVR_CAMERA_FRONT and PVR_CAMERA_BACK environment variables. Each may name either a V4L2 device node
+// (e.g. /dev/video2) or a raw video file that is replayed in a loop. Raw files describe their contents in their name, following the pattern
+// <name>_<width>x<height>_<format>[_<fps>fps].<ext> where format is one of nv12, yuyv, rgb565 or rgba, e.g. "parking_1280x720_nv12_30fps.yuv",
+// as produced by "ffmpeg -i input.mp4 -pix_fmt nv12 -f rawvideo parking_1280x720_nv12_30fps.yuv".
+// Without a variable, the Front camera is the first capture device found and the Back camera the second one (or the first if there is only one).
+// If no source can be opened, a static test image is streamed instead so that applications keep running on machines without a camera.
+namespace pvr {
+namespace {
+const uint32_t NoSlot = 0xFFFFFFFFu;
+const uint32_t MaxSlots = 32; // Released slots are tracked in a 32 bit mask
+const int CapturePollTimeoutMs = 50;
+
+enum class FrameFormat
+{
+	RGBA,
+	RGB565,
+	NV12,
+	YUYV,
+};
+
+bool isLumaChroma(FrameFormat format) { return format == FrameFormat::NV12 || format == FrameFormat::YUYV; }
+
+// One of the buffers cycling between a frame source, the capture thread and the renderer.
+struct FrameSlot
+{
+	uint8_t* data = nullptr; // Raw frame, either the driver's mmap'd buffer or memory owned by the source
+	size_t size = 0;
+	const uint8_t* planes[2] = { nullptr, nullptr }; // RGB or luma plane, and chroma plane, ready for upload
+	uint32_t strides[2] = { 0, 0 };
+	std::vector<uint8_t> converted; // Planar copy of packed YUYV frames
+};
+
+class FrameSource
+{
+public:
+	virtual ~FrameSource() {}
+
+	// Waits for at most timeoutMs for a new frame. Returns the index of the slot holding it, or NoSlot.
+	virtual uint32_t acquireFrame(int timeoutMs) = 0;
+
+	// Gives a slot back to the source so that it can be filled again.
+	virtual void recycleFrame(uint32_t slot) = 0;
+
+	FrameFormat format = FrameFormat::RGBA;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t stride = 0;
+	std::vector<FrameSlot> slots;
+};
+
+int xioctl(int fd, unsigned long request, void* arg)
+{
+	int result;
+	do {
+		result = ioctl(fd, request, arg);
+	} while (result == -1 && errno == EINTR);
+	return result;
+}
+
+bool isCaptureDevice(int fd)
+{
+	v4l2_capability caps = {};
+	if (xioctl(fd, VIDIOC_QUERYCAP, &caps) == -1) { return false; }
+	uint32_t capabilities = (caps.capabilities & V4L2_CAP_DEVICE_CAPS) ? caps.device_caps : caps.capabilities;
+	return (capabilities & V4L2_CAP_VIDEO_CAPTURE) && (capabilities & V4L2_CAP_STREAMING);
+}
+
+// Captures from a Video4Linux2 device using memory mapped buffers. Frames are handed over without copies: a slot is the driver's buffer itself,
+// and is only queued back to the driver once the renderer has uploaded it.
+class V4l2FrameSource : public FrameSource
+{
+public:
+	V4l2FrameSource(const std::string& path, uint32_t preferredWidth, uint32_t preferredHeight) : _fd(-1)
+	{
+		_fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+		if (_fd == -1) { throw InvalidOperationError("PVRCamera: Could not open video device [" + path + "]: " + strerror(errno)); }
+		try
+		{
+			if (!isCaptureDevice(_fd)) { throw InvalidOperationError("PVRCamera: [" + path + "] is not a streaming video capture device"); }
+			setFormat(path, preferredWidth, preferredHeight);
+			mapBuffers(path);
+
+			v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+			if (xioctl(_fd, VIDIOC_STREAMON, &type) == -1) { throw InvalidOperationError("PVRCamera: Could not start streaming from [" + path + "]"); }
+		}
+		catch (...)
+		{
+			release();
+			throw;
+		}
+	}
+
+	~V4l2FrameSource() { release(); }
+
+	uint32_t acquireFrame(int timeoutMs) override
+	{
+		pollfd pfd = { _fd, POLLIN, 0 };
+		if (poll(&pfd, 1, timeoutMs) <= 0 || !(pfd.revents & POLLIN)) { return NoSlot; }
+
+		v4l2_buffer buffer = {};
+		buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		buffer.memory = V4L2_MEMORY_MMAP;
+		if (xioctl(_fd, VIDIOC_DQBUF, &buffer) == -1)
+		{
+			if (errno != EAGAIN) { Log(LogLevel::Warning, "PVRCamera: VIDIOC_DQBUF failed: %s", strerror(errno)); }
+			return NoSlot;
+		}
+		if (buffer.flags & V4L2_BUF_FLAG_ERROR)
+		{
+			recycleFrame(buffer.index);
+			return NoSlot;
+		}
+		return buffer.index;
+	}
+
+	void recycleFrame(uint32_t slot) override
+	{
+		v4l2_buffer buffer = {};
+		buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		buffer.memory = V4L2_MEMORY_MMAP;
+		buffer.index = slot;
+		if (xioctl(_fd, VIDIOC_QBUF, &buffer) == -1) { Log(LogLevel::Warning, "PVRCamera: VIDIOC_QBUF failed: %s", strerror(errno)); }
+	}
+
+private:
+	int _fd;
+
+	void setFormat(const std::string& path, uint32_t preferredWidth, uint32_t preferredHeight)
+	{
+		// Prefer the formats that need no conversion at all, then the ones the renderer can still upload directly.
+		static const struct
+		{
+			uint32_t fourcc;
+			FrameFormat format;
+		} preferredFormats[] = {
+			{ V4L2_PIX_FMT_NV12, FrameFormat::NV12 },
+			{ V4L2_PIX_FMT_YUYV, FrameFormat::YUYV },
+			{ V4L2_PIX_FMT_RGB565, FrameFormat::RGB565 },
+#ifdef V4L2_PIX_FMT_RGBA32
+			{ V4L2_PIX_FMT_RGBA32, FrameFormat::RGBA },
+#endif
+		};
+
+		std::vector<uint32_t> supported;
+		v4l2_fmtdesc description = {};
+		description.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		for (description.index = 0; xioctl(_fd, VIDIOC_ENUM_FMT, &description) == 0; ++description.index) { supported.push_back(description.pixelformat); }
+
+		for (const auto& candidate : preferredFormats)
+		{
+			if (std::find(supported.begin(), supported.end(), candidate.fourcc) == supported.end()) { continue; }
+
+			v4l2_format fmt = {};
+			fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+			fmt.fmt.pix.width = preferredWidth ? preferredWidth : 640;
+			fmt.fmt.pix.height = preferredHeight ? preferredHeight : 480;
+			fmt.fmt.pix.pixelformat = candidate.fourcc;
+			fmt.fmt.pix.field = V4L2_FIELD_NONE;
+			if (xioctl(_fd, VIDIOC_S_FMT, &fmt) == -1 || fmt.fmt.pix.pixelformat != candidate.fourcc) { continue; }
+
+			format = candidate.format;
+			width = fmt.fmt.pix.width;
+			height = fmt.fmt.pix.height;
+			stride = fmt.fmt.pix.bytesperline;
+			return;
+		}
+		throw InvalidOperationError("PVRCamera: [" + path + "] does not support any of the NV12, YUYV, RGB565 or RGBA formats");
+	}
+
+	void mapBuffers(const std::string& path)
+	{
+		// One buffer being filled by the driver, one ready, one being uploaded, and one spare so the driver never runs dry.
+		v4l2_requestbuffers request = {};
+		request.count = 4;
+		request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		request.memory = V4L2_MEMORY_MMAP;
+		if (xioctl(_fd, VIDIOC_REQBUFS, &request) == -1 || request.count < 3)
+		{ throw InvalidOperationError("PVRCamera: Could not allocate enough capture buffers for [" + path + "]"); }
+
+		slots.resize(std::min(request.count, MaxSlots));
+		for (uint32_t i = 0; i < slots.size(); ++i)
+		{
+			v4l2_buffer buffer = {};
+			buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+			buffer.memory = V4L2_MEMORY_MMAP;
+			buffer.index = i;
+			if (xioctl(_fd, VIDIOC_QUERYBUF, &buffer) == -1) { throw InvalidOperationError("PVRCamera: VIDIOC_QUERYBUF failed for [" + path + "]"); }
+
+			void* memory = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, buffer.m.offset);
+			if (memory == MAP_FAILED) { throw InvalidOperationError("PVRCamera: Could not map the capture buffers of [" + path + "]"); }
+			slots[i].data = static_cast<uint8_t*>(memory);
+			slots[i].size = buffer.length;
+			recycleFrame(i);
+		}
+	}
+
+	void release()
+	{
+		if (_fd == -1) { return; }
+		v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		xioctl(_fd, VIDIOC_STREAMOFF, &type);
+		for (auto& slot : slots)
+		{
+			if (slot.data) { munmap(slot.data, slot.size); }
+		}
+		slots.clear();
+		close(_fd);
+		_fd = -1;
+	}
+};
+
+// Replays a raw video file in a loop at its nominal frame rate, so that the capture pipeline can be exercised without a camera.
+class FileFrameSource : public FrameSource
+{
+public:
+	FileFrameSource(const std::string& path) : _frameInterval(std::chrono::microseconds(1000000 / 30))
+	{
+		parseFileName(path);
+
+		_file.open(path, std::ios::binary);
+		if (!_file) { throw InvalidOperationError("PVRCamera: Could not open replay file [" + path + "]"); }
+
+		slots.resize(3);
+		_storage.resize(slots.size());
+		for (uint32_t i = 0; i < slots.size(); ++i)
+		{
+			_storage[i].resize(getFrameSize());
+			slots[i].data = _storage[i].data();
+			slots[i].size = _storage[i].size();
+			_freeSlots.push_back(i);
+		}
+		if (!readFrame(_storage[0])) { throw InvalidOperationError("PVRCamera: Replay file [" + path + "] does not contain a complete frame"); }
+		_file.seekg(0);
+		_nextFrameTime = std::chrono::steady_clock::now();
+	}
+
+	uint32_t acquireFrame(int timeoutMs) override
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		if (_freeSlots.empty() || _nextFrameTime > deadline)
+		{
+			std::this_thread::sleep_until(deadline);
+			return NoSlot;
+		}
+		std::this_thread::sleep_until(_nextFrameTime);
+		_nextFrameTime += _frameInterval;
+
+		uint32_t slot = _freeSlots.back();
+		_freeSlots.pop_back();
+		if (!readFrame(_storage[slot]))
+		{
+			_freeSlots.push_back(slot);
+			return NoSlot;
+		}
+		return slot;
+	}
+
+	// Only ever called from the capture thread, so the free list needs no synchronisation.
+	void recycleFrame(uint32_t slot) override { _freeSlots.push_back(slot); }
+
+private:
+	std::ifstream _file;
+	std::vector<std::vector<uint8_t> > _storage;
+	std::vector<uint32_t> _freeSlots;
+	std::chrono::steady_clock::duration _frameInterval;
+	std::chrono::steady_clock::time_point _nextFrameTime;
+
+	size_t getFrameSize() const
+	{
+		switch (format)
+		{
+		case FrameFormat::NV12: return stride * height * 3 / 2;
+		default: return stride * height;
+		}
+	}
+
+	bool readFrame(std::vector<uint8_t>& frame)
+	{
+		for (int attempt = 0; attempt < 2; ++attempt)
+		{
+			if (_file.read(reinterpret_cast<char*>(frame.data()), frame.size())) { return true; }
+			// End of the file: loop back to the first frame.
+			_file.clear();
+			_file.seekg(0);
+		}
+		return false;
+	}
+
+	void parseFileName(const std::string& path)
+	{
+		std::string name = path.substr(path.find_last_of('/') + 1);
+		name = name.substr(0, name.find_last_of('.'));
+
+		bool hasSize = false, hasFormat = false;
+		size_t begin = 0;
+		while (begin <= name.size())
+		{
+			size_t end = name.find('_', begin);
+			if (end == std::string::npos) { end = name.size(); }
+			const std::string token = name.substr(begin, end - begin);
+			uint32_t a = 0, b = 0;
+			char trailing = 0;
+
+			if (sscanf(token.c_str(), "%ux%u%c", &a, &b, &trailing) == 2 && a && b)
+			{
+				width = a;
+				height = b;
+				hasSize = true;
+			}
+			else if (sscanf(token.c_str(), "%ufps%c", &a, &trailing) == 1 && a && token.size() > 3 && token.compare(token.size() - 3, 3, "fps") == 0)
+			{
+				_frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::microseconds(1000000 / a));
+			}
+			else
+			{
+				static const std::pair<const char*, FrameFormat> formatNames[] = { { "nv12", FrameFormat::NV12 }, { "yuyv", FrameFormat::YUYV },
+					{ "rgb565", FrameFormat::RGB565 }, { "rgba", FrameFormat::RGBA } };
+				for (const auto& formatName : formatNames)
+				{
+					if (token == formatName.first)
+					{
+						format = formatName.second;
+						hasFormat = true;
+					}
+				}
+			}
+			begin = end + 1;
+		}
+		if (!hasSize || !hasFormat)
+		{
+			throw InvalidArgumentError("path",
+				"PVRCamera: Replay file names must follow the pattern <name>_<width>x<height>_<nv12|yuyv|rgb565|rgba>[_<fps>fps].<ext>, but got [" + path + "]");
+		}
+		switch (format)
+		{
+		case FrameFormat::NV12: stride = width; break;
+		case FrameFormat::YUYV:
+		case FrameFormat::RGB565: stride = width * 2; break;
+		case FrameFormat::RGBA: stride = width * 4; break;
+		}
+	}
+};
+
+bool isRegularFile(const std::string& path)
+{
+	struct stat info;
+	return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+std::string findCaptureDevice(HWCamera::Enum camera)
+{
+	std::vector<std::string> devices;
+	for (int i = 0; i < 64 && devices.size() < 2; ++i)
+	{
+		std::string path = "/dev/video" + std::to_string(i);
+		int fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+		if (fd == -1) { continue; }
+		if (isCaptureDevice(fd)) { devices.push_back(path); }
+		close(fd);
+	}
+	if (devices.empty()) { return std::string(); }
+	return (camera == HWCamera::Back && devices.size() > 1) ? devices[1] : devices[0];
+}
+} // namespace
+
+class CameraInterfaceImpl
+{
+public:
+	CameraInterface* parent;
+	std::unique_ptr<FrameSource> source;
+	std::thread captureThread;
+	std::atomic<bool> running;
+	std::atomic<uint32_t> readySlot; // Latest frame published by the capture thread that the renderer has not picked up yet
+	std::atomic<uint32_t> releasedSlots; // Mask of the slots the renderer has finished uploading
+	GLuint textures[2];
+	uint32_t width, height;
+	bool projectionMatrixChanged;
+
+	CameraInterfaceImpl(CameraInterface* parent)
+		: parent(parent), running(false), readySlot(NoSlot), releasedSlots(0), width(0), height(0), projectionMatrixChanged(true)
+	{
+		textures[0] = textures[1] = 0;
+	}
+
+	~CameraInterfaceImpl() { stopCapture(); }
+
+	void initializeSession(HWCamera::Enum camera, int preferredResX, int preferredResY)
+	{
+		destroySession();
+
+		const char* configured = getenv(camera == HWCamera::Back ? "PVR_CAMERA_BACK" : "PVR_CAMERA_FRONT");
+		std::string path = configured ? configured : findCaptureDevice(camera);
+		try
+		{
+			if (path.empty()) { throw InvalidOperationError("PVRCamera: No video capture device found"); }
+			if (isRegularFile(path)) { source = std::make_unique<FileFrameSource>(path); }
+			else
+			{
+				source = std::make_unique<V4l2FrameSource>(path, static_cast<uint32_t>(std::max(preferredResX, 0)), static_cast<uint32_t>(std::max(preferredResY, 0)));
+			}
+		}
+		catch (const std::exception& e)
+		{
+			Log(LogLevel::Warning, "%s. Streaming a static test image instead.", e.what());
+			generateTestImage(preferredResX > 0 ? preferredResX : 512, preferredResY > 0 ? preferredResY : 512);
+			return;
+		}
+
+		width = source->width;
+		height = source->height;
+		Log(LogLevel::Information, "PVRCamera: Streaming %ux%u %s frames from [%s]", width, height, isLumaChroma(source->format) ? "YUV" : "RGB", path.c_str());
+		createTextures();
+
+		running = true;
+		captureThread = std::thread(&CameraInterfaceImpl::captureLoop, this);
+	}
+
+	void destroySession()
+	{
+		stopCapture();
+		source.reset();
+		if (textures[0] || textures[1]) { gl::DeleteTextures(textures[1] ? 2 : 1, textures); }
+		textures[0] = textures[1] = 0;
+		parent->_isReady = false;
+	}
+
+	bool hasLumaChroma() const { return source && isLumaChroma(source->format); }
+
+	// Called on the rendering thread: uploads the latest published frame, if any, and hands its slot back to the capture thread.
+	bool updateImage()
+	{
+		if (!source) { return false; }
+		uint32_t slot = readySlot.exchange(NoSlot, std::memory_order_acq_rel);
+		if (slot == NoSlot) { return false; }
+
+		const FrameSlot& frame = source->slots[slot];
+		gl::PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		switch (source->format)
+		{
+		case FrameFormat::NV12:
+			uploadPlane(textures[0], frame.planes[0], frame.strides[0], width, height, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1);
+			uploadPlane(textures[1], frame.planes[1], frame.strides[1], width / 2, height / 2, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, 2);
+			break;
+		case FrameFormat::YUYV:
+			uploadPlane(textures[0], frame.planes[0], frame.strides[0], width, height, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1);
+			uploadPlane(textures[1], frame.planes[1], frame.strides[1], width / 2, height, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, 2);
+			break;
+		case FrameFormat::RGB565: uploadPlane(textures[0], frame.planes[0], frame.strides[0], width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2); break;
+		case FrameFormat::RGBA: uploadPlane(textures[0], frame.planes[0], frame.strides[0], width, height, GL_RGBA, GL_UNSIGNED_BYTE, 4); break;
+		}
+		gl::PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		// glTexSubImage2D has consumed the data by the time it returns, so the slot can be recycled straight away.
+		releasedSlots.fetch_or(1u << slot, std::memory_order_acq_rel);
+		parent->_isReady = true;
+		return true;
+	}
+
+private:
+	void stopCapture()
+	{
+		running = false;
+		if (captureThread.joinable()) { captureThread.join(); }
+		readySlot = NoSlot;
+		releasedSlots = 0;
+	}
+
+	// The capture thread and the renderer exchange slots through two atomics only: the capture thread publishes each new frame into readySlot,
+	// recycling the previous one if the renderer never picked it up, and the renderer returns slots through the releasedSlots mask. Together with
+	// the buffer being filled by the source this forms a lock-free triple buffer where the renderer always sees the most recent frame.
+	void captureLoop()
+	{
+		while (running)
+		{
+			uint32_t released = releasedSlots.exchange(0, std::memory_order_acq_rel);
+			for (uint32_t slot = 0; released; ++slot, released >>= 1)
+			{
+				if (released & 1u) { source->recycleFrame(slot); }
+			}
+
+			uint32_t slot = source->acquireFrame(CapturePollTimeoutMs);
+			if (slot == NoSlot) { continue; }
+			prepareFrame(source->slots[slot]);
+
+			uint32_t stale = readySlot.exchange(slot, std::memory_order_acq_rel);
+			if (stale != NoSlot) { source->recycleFrame(stale); }
+		}
+	}
+
+	// Runs on the capture thread so that the rendering thread only has to upload.
+	void prepareFrame(FrameSlot& frame)
+	{
+		const uint32_t stride = source->stride;
+		switch (source->format)
+		{
+		case FrameFormat::NV12:
+			frame.planes[0] = frame.data;
+			frame.planes[1] = frame.data + stride * height;
+			frame.strides[0] = frame.strides[1] = stride;
+			break;
+		case FrameFormat::YUYV:
+		{
+			// Split the packed Y0 U Y1 V macro-pixels into a full resolution luma plane and a half width interleaved chroma plane.
+			frame.converted.resize(width * height * 2);
+			uint8_t* luma = frame.converted.data();
+			uint8_t* chroma = luma + width * height;
+			for (uint32_t y = 0; y < height; ++y)
+			{
+				const uint8_t* src = frame.data + y * stride;
+				for (uint32_t x = 0; x < width / 2; ++x, src += 4)
+				{
+					*luma++ = src[0];
+					*luma++ = src[2];
+					*chroma++ = src[1];
+					*chroma++ = src[3];
+				}
+			}
+			frame.planes[0] = frame.converted.data();
+			frame.planes[1] = frame.converted.data() + width * height;
+			frame.strides[0] = frame.strides[1] = width;
+			break;
+		}
+		case FrameFormat::RGB565:
+		case FrameFormat::RGBA:
+			frame.planes[0] = frame.data;
+			frame.strides[0] = stride;
+			break;
+		}
+	}
+
+	void createTexture(GLuint texture, uint32_t texWidth, uint32_t texHeight, GLenum format, GLenum type)
+	{
+		gl::BindTexture(GL_TEXTURE_2D, texture);
+		gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		gl::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		gl::TexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format), static_cast<GLsizei>(texWidth), static_cast<GLsizei>(texHeight), 0, format, type, nullptr);
+	}
+
+	void createTextures()
+	{
+		gl::GetError(); // Make sure you don't break due to previous errors
+		switch (source->format)
+		{
+		case FrameFormat::NV12:
+		case FrameFormat::YUYV:
+			gl::GenTextures(2, textures);
+			createTexture(textures[0], width, height, GL_LUMINANCE, GL_UNSIGNED_BYTE);
+			createTexture(textures[1], width / 2, source->format == FrameFormat::NV12 ? height / 2 : height, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE);
+			break;
+		case FrameFormat::RGB565:
+			gl::GenTextures(1, textures);
+			createTexture(textures[0], width, height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5);
+			break;
+		case FrameFormat::RGBA:
+			gl::GenTextures(1, textures);
+			createTexture(textures[0], width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+			break;
+		}
+		if (gl::GetError() != GL_NO_ERROR) { throw PvrError("PVRCamera, Linux version - Error while creating the camera textures."); }
+	}
+
+	void uploadPlane(GLuint texture, const uint8_t* data, uint32_t stride, uint32_t planeWidth, uint32_t planeHeight, GLenum format, GLenum type, uint32_t bytesPerPixel)
+	{
+		gl::BindTexture(GL_TEXTURE_2D, texture);
+		if (stride == planeWidth * bytesPerPixel)
+		{ gl::TexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(planeWidth), static_cast<GLsizei>(planeHeight), format, type, data); }
+		else
+		{
+			// Padded rows: GL_UNPACK_ROW_LENGTH is not available on OpenGL ES 2.0, so upload row by row.
+			for (uint32_t y = 0; y < planeHeight; ++y)
+			{ gl::TexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(y), static_cast<GLsizei>(planeWidth), 1, format, type, data + y * stride); }
+		}
+	}
+
+	void generateTestImage(int imageWidth, int imageHeight)
+	{
+		width = static_cast<uint32_t>(imageWidth);
+		height = static_cast<uint32_t>(imageHeight);
+		std::vector<uint32_t> pixels(width * height);
+		for (uint32_t j = 0; j < height; ++j)
+		{
+			for (uint32_t i = 0; i < width; ++i) { pixels[j * width + i] = (((i / 32) ^ (j / 32)) & 1) ? 0xFFC0C0C0 : 0xFF606060; }
+		}
+
+		gl::GetError(); // Make sure you don't break due to previous errors
+		gl::GenTextures(1, textures);
+		createTexture(textures[0], width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+		gl::TexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		if (gl::GetError() != GL_NO_ERROR) { throw PvrError("PVRCamera, Linux version - Error while generating the test camera texture."); }
+		parent->_isReady = true;
+	}
+};
+
+CameraInterface::CameraInterface() { pImpl = new CameraInterfaceImpl(this); }
+CameraInterface::~CameraInterface() { delete static_cast<CameraInterfaceImpl*>(pImpl); }
+
+void CameraInterface::initializeSession(HWCamera::Enum camera, int preferredResX, int preferredResY)
+{
+	static_cast<CameraInterfaceImpl*>(pImpl)->initializeSession(camera, preferredResX, preferredResY);
+}
+
+void CameraInterface::destroySession() { static_cast<CameraInterfaceImpl*>(pImpl)->destroySession(); }
+
+bool CameraInterface::updateImage() { return static_cast<CameraInterfaceImpl*>(pImpl)->updateImage(); }
+
+bool CameraInterface::hasProjectionMatrixChanged() { return static_cast<CameraInterfaceImpl*>(pImpl)->projectionMatrixChanged; }
+
+const glm::mat4& CameraInterface::getProjectionMatrix()
+{
+	// Captured rows are stored top to bottom, so flip the texture coordinates vertically.
+	static const glm::mat4 proj(1., 0., 0., 0., 0., -1., 0., 0., 0., 0., 1., 0., 0., 1., 0., 1.);
+	static_cast<CameraInterfaceImpl*>(pImpl)->projectionMatrixChanged = false;
+	return proj;
+}
+
+GLuint CameraInterface::getRgbTexture()
+{
+	CameraInterfaceImpl* impl = static_cast<CameraInterfaceImpl*>(pImpl);
+	return impl->hasLumaChroma() ? 0 : impl->textures[0];
+}
+
+GLuint CameraInterface::getLuminanceTexture()
+{
+	CameraInterfaceImpl* impl = static_cast<CameraInterfaceImpl*>(pImpl);
+	return impl->hasLumaChroma() ? impl->textures[0] : 0;
+}
+
+GLuint CameraInterface::getChrominanceTexture()
+{
+	CameraInterfaceImpl* impl = static_cast<CameraInterfaceImpl*>(pImpl);
+	return impl->hasLumaChroma() ? impl->textures[1] : 0;
+}
+
+bool CameraInterface::getCameraResolution(uint32_t& x, uint32_t& y)
+{
+	x = static_cast<CameraInterfaceImpl*>(pImpl)->width;
+	y = static_cast<CameraInterfaceImpl*>(pImpl)->height;
+	return x && y;
+}
+
+bool CameraInterface::hasRgbTexture() { return !static_cast<CameraInterfaceImpl*>(pImpl)->hasLumaChroma(); }
+
+bool CameraInterface::hasLumaChromaTextures() { return static_cast<CameraInterfaceImpl*>(pImpl)->hasLumaChroma(); }
+} // namespace pvr
+//!\endcond
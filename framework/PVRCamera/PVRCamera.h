@@ -17,7 +17,7 @@
 
 \section overview Overview
 *****************************
-PVRCamera provides an easy-to-use interface between the platform's Camera of Android or iOS and the rest of the Framework. Please refer to the relevant examples (e.g. TextureStreaming) for its use.
+PVRCamera provides an easy-to-use interface between the platform's Camera of Android, iOS or Linux (Video4Linux2) and the rest of the Framework. Please refer to the relevant examples (e.g. TextureStreaming) for its use.
 
 Except for linking to the native library, PVRCamera requires a few lines of Java code to be added (for Android applications), and to be available for linking.
 
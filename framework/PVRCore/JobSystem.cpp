@@ -0,0 +1,285 @@
+/*!
+\brief Implementation of the JobSystem thread pool.
+\file PVRCore/JobSystem.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRCore/JobSystem.h"
+#include "PVRCore/Profiler.h"
+#include "PVRCore/Log.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace pvr {
+namespace async {
+namespace impl {
+struct Job
+{
+	explicit Job(std::function<void()>&& work) : function(std::move(work)), pendingDependencies(1), complete(false) {}
+
+	std::function<void()> function;
+	std::atomic<uint32_t> pendingDependencies;
+	std::atomic<bool> complete;
+	std::exception_ptr exception;
+	std::mutex mutex;
+	std::condition_variable completed;
+	std::vector<JobHandle> dependents;
+};
+} // namespace impl
+
+struct JobSystem::WorkerQueue
+{
+	std::mutex mutex;
+	std::deque<JobHandle> jobs;
+};
+
+struct JobSystem::SleepState
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+};
+
+namespace {
+struct CurrentWorker
+{
+	const JobSystem* system;
+	uint32_t index;
+};
+thread_local CurrentWorker currentWorker = { nullptr, 0 };
+} // namespace
+
+JobSystem& JobSystem::getInstance()
+{
+	static JobSystem jobSystem(getDefaultNumWorkers());
+	return jobSystem;
+}
+
+uint32_t JobSystem::getDefaultNumWorkers()
+{
+	const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 2 ? hardwareThreads - 1 : 1;
+}
+
+JobSystem::JobSystem(uint32_t numWorkers) : _numQueued(0), _nextQueue(0), _done(false), _sleep(new SleepState)
+{
+	numWorkers = std::max(numWorkers, 1u);
+	// Make sure the profiler outlives the workers, as jobs may contain profile scopes.
+	Profiler::getInstance();
+	_queues.reserve(numWorkers);
+	for (uint32_t i = 0; i < numWorkers; ++i) { _queues.emplace_back(new WorkerQueue); }
+	_threads.reserve(numWorkers);
+	for (uint32_t i = 0; i < numWorkers; ++i) { _threads.emplace_back(&JobSystem::workerLoop, this, i); }
+	Log(LogLevel::Information, "JobSystem: %u worker threads spawned.", numWorkers);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleep->mutex);
+		_done = true;
+	}
+	_sleep->condition.notify_all();
+	for (std::thread& thread : _threads) { thread.join(); }
+}
+
+uint32_t JobSystem::getCurrentWorkerIndex() const
+{
+	return currentWorker.system == this ? currentWorker.index : static_cast<uint32_t>(-1);
+}
+
+JobHandle JobSystem::submit(std::function<void()> function, const JobHandle* dependencies, uint32_t numDependencies)
+{
+	JobHandle job = std::make_shared<impl::Job>(std::move(function));
+	for (uint32_t i = 0; i < numDependencies; ++i)
+	{
+		const JobHandle& dependency = dependencies[i];
+		if (!dependency) { continue; }
+		std::lock_guard<std::mutex> lock(dependency->mutex);
+		if (!dependency->complete)
+		{
+			++job->pendingDependencies;
+			dependency->dependents.push_back(job);
+		}
+	}
+	// Release the reference held during registration: the last dependency to complete schedules the job.
+	if (--job->pendingDependencies == 0) { schedule(job); }
+	return job;
+}
+
+void JobSystem::schedule(const JobHandle& job)
+{
+	uint32_t queueIndex = getCurrentWorkerIndex();
+	if (queueIndex >= _queues.size()) { queueIndex = _nextQueue++ % static_cast<uint32_t>(_queues.size()); }
+	// Counted before being pushed so that the counter never underflows: it may only briefly overestimate.
+	++_numQueued;
+	{
+		WorkerQueue& queue = *_queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+	// Taking the lock orders the increment with a worker checking it before going to sleep.
+	{
+		std::lock_guard<std::mutex> lock(_sleep->mutex);
+	}
+	_sleep->condition.notify_one();
+}
+
+bool JobSystem::popJob(JobHandle& outJob)
+{
+	if (!_numQueued.load(std::memory_order_relaxed)) { return false; }
+	const uint32_t numQueues = static_cast<uint32_t>(_queues.size());
+	const uint32_t workerIndex = getCurrentWorkerIndex();
+	uint32_t start = workerIndex;
+	if (workerIndex < numQueues)
+	{
+		// Own queue first, newest job first for cache locality.
+		WorkerQueue& queue = *_queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			outJob = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			--_numQueued;
+			return true;
+		}
+	}
+	else
+	{
+		start = _nextQueue.load(std::memory_order_relaxed) % numQueues;
+	}
+	// Steal the oldest job of another queue.
+	for (uint32_t i = 0; i < numQueues; ++i)
+	{
+		const uint32_t victim = (start + 1 + i) % numQueues;
+		if (victim == workerIndex) { continue; }
+		WorkerQueue& queue = *_queues[victim];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			outJob = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			--_numQueued;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+	try
+	{
+		job->function();
+	}
+	catch (...)
+	{
+		job->exception = std::current_exception();
+	}
+	// Release anything captured by the job as soon as possible.
+	job->function = nullptr;
+
+	std::vector<JobHandle> dependents;
+	{
+		std::lock_guard<std::mutex> lock(job->mutex);
+		job->complete = true;
+		dependents.swap(job->dependents);
+	}
+	job->completed.notify_all();
+	for (const JobHandle& dependent : dependents)
+	{
+		if (--dependent->pendingDependencies == 0) { schedule(dependent); }
+	}
+}
+
+bool JobSystem::tryRunPendingJob()
+{
+	JobHandle job;
+	if (!popJob(job)) { return false; }
+	execute(job);
+	return true;
+}
+
+bool JobSystem::tryRunJob(const JobHandle& job)
+{
+	// A job with pending dependencies is not in any queue yet, and is not found.
+	if (!_numQueued.load(std::memory_order_relaxed)) { return false; }
+	for (const std::unique_ptr<WorkerQueue>& queuePtr : _queues)
+	{
+		WorkerQueue& queue = *queuePtr;
+		std::unique_lock<std::mutex> lock(queue.mutex);
+		auto it = std::find(queue.jobs.begin(), queue.jobs.end(), job);
+		if (it != queue.jobs.end())
+		{
+			queue.jobs.erase(it);
+			--_numQueued;
+			lock.unlock();
+			execute(job);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobSystem::isComplete(const JobHandle& job) { return !job || job->complete.load(std::memory_order_acquire); }
+
+void JobSystem::wait(const JobHandle& job)
+{
+	if (!job) { return; }
+	// Only workers help with arbitrary jobs: they must, so that jobs waiting for jobs cannot deadlock the pool. Any other
+	// thread takes over the awaited job if it is still queued, and otherwise leaves the work to the workers.
+	const bool helpWithAnyJob = isWorkerThread();
+	while (!isComplete(job))
+	{
+		if (!(helpWithAnyJob ? tryRunPendingJob() : tryRunJob(job)))
+		{
+			// Nothing to help with: sleep until the job completes, but wake up regularly in case new work arrives.
+			std::unique_lock<std::mutex> lock(job->mutex);
+			job->completed.wait_for(lock, std::chrono::milliseconds(1), [&job] { return job->complete.load(); });
+		}
+	}
+	if (job->exception) { std::rethrow_exception(job->exception); }
+}
+
+void JobSystem::waitAll(const JobHandle* jobs, uint32_t numJobs)
+{
+	std::exception_ptr exception;
+	for (uint32_t i = 0; i < numJobs; ++i)
+	{
+		try
+		{
+			wait(jobs[i]);
+		}
+		catch (...)
+		{
+			if (!exception) { exception = std::current_exception(); }
+		}
+	}
+	if (exception) { std::rethrow_exception(exception); }
+}
+
+void JobSystem::workerLoop(uint32_t workerIndex)
+{
+	currentWorker.system = this;
+	currentWorker.index = workerIndex;
+	Profiler::getInstance().setThreadName("Job worker " + std::to_string(workerIndex));
+
+	for (;;)
+	{
+		JobHandle job;
+		if (popJob(job))
+		{
+			execute(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(_sleep->mutex);
+		_sleep->condition.wait(lock, [this] { return _done || _numQueued > 0; });
+		if (_done && !_numQueued) { break; }
+	}
+}
+} // namespace async
+} // namespace pvr
+//!\endcond
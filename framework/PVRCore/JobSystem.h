@@ -0,0 +1,171 @@
+/*!
+\brief A process-wide thread pool with work stealing, job dependencies and parallel-for helpers.
+\file PVRCore/JobSystem.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace pvr {
+namespace async {
+namespace impl {
+struct Job;
+} // namespace impl
+
+/// <summary>A reference counted handle to a job submitted to a JobSystem. Can be used to wait for the job, or as a
+/// dependency of other jobs. A default constructed (null) handle counts as already complete.</summary>
+typedef std::shared_ptr<impl::Job> JobHandle;
+
+/// <summary>A thread pool with one worker per core (leaving one for the submitting thread). Each worker owns a
+/// double ended queue: it pushes and pops its own jobs at the back, and idle workers steal from the front of the
+/// others. Jobs submitted from non-worker threads are spread across the queues round-robin. Workers that wait for a
+/// job execute other pending jobs in the meantime, so jobs can safely wait for other jobs. Other threads (such as the
+/// render thread) never execute jobs they did not ask for: waiting only executes the awaited job itself, if no worker
+/// has started it yet, so a wait cannot be delayed by unrelated long running work.</summary>
+/// <remarks>Use getInstance() for the process-wide pool shared by the framework loaders and the application, rather
+/// than creating pools (and threads) per subsystem.</remarks>
+class JobSystem
+{
+public:
+	/// <summary>Get the process-wide job system. Created on first use with getDefaultNumWorkers() workers.</summary>
+	/// <returns>The process-wide job system</returns>
+	static JobSystem& getInstance();
+
+	/// <summary>The number of workers used by the process-wide job system: one less than the number of hardware
+	/// threads, and at least one.</summary>
+	/// <returns>The default number of workers</returns>
+	static uint32_t getDefaultNumWorkers();
+
+	/// <summary>Constructor. Spawns the worker threads.</summary>
+	/// <param name="numWorkers">The number of worker threads. Clamped to at least one.</param>
+	explicit JobSystem(uint32_t numWorkers);
+
+	/// <summary>Destructor. Finishes all queued jobs, then joins the worker threads.</summary>
+	~JobSystem();
+
+	/// <summary>Get the number of worker threads.</summary>
+	/// <returns>The number of worker threads</returns>
+	uint32_t getNumWorkers() const { return static_cast<uint32_t>(_threads.size()); }
+
+	/// <summary>Submit a job.</summary>
+	/// <param name="function">The work to execute. Any exception it throws is captured and rethrown by wait().</param>
+	/// <param name="dependencies">Jobs that must complete before this one starts. May contain null handles.</param>
+	/// <param name="numDependencies">The number of dependencies</param>
+	/// <returns>A handle to the job</returns>
+	JobHandle submit(std::function<void()> function, const JobHandle* dependencies = nullptr, uint32_t numDependencies = 0);
+
+	/// <summary>Submit a job that depends on a single other job.</summary>
+	/// <param name="function">The work to execute</param>
+	/// <param name="dependency">A job that must complete before this one starts</param>
+	/// <returns>A handle to the job</returns>
+	JobHandle submitAfter(std::function<void()> function, const JobHandle& dependency) { return submit(std::move(function), &dependency, 1); }
+
+	/// <summary>Query if a job has completed (successfully or not).</summary>
+	/// <param name="job">The job</param>
+	/// <returns>True if the job has completed or is null</returns>
+	static bool isComplete(const JobHandle& job);
+
+	/// <summary>Wait for a job to complete, and rethrow the exception thrown by the job, if any. On a worker thread, other
+	/// pending jobs are executed in the meantime. On any other thread, only the awaited job is executed, if it is still
+	/// queued, and the thread otherwise blocks.</summary>
+	/// <param name="job">The job to wait for</param>
+	void wait(const JobHandle& job);
+
+	/// <summary>Wait for a number of jobs. Rethrows the first exception thrown by any of them, after all have completed.</summary>
+	/// <param name="jobs">The jobs to wait for</param>
+	/// <param name="numJobs">The number of jobs</param>
+	void waitAll(const JobHandle* jobs, uint32_t numJobs);
+
+	/// <summary>Execute one pending job on the calling thread, if there is one. Useful to make progress while blocking
+	/// on something that is itself produced by a job. The job may be any job of the system, so avoid calling this from
+	/// threads with their own latency requirements, such as the render thread.</summary>
+	/// <returns>True if a job was executed, false if no job was pending</returns>
+	bool tryRunPendingJob();
+
+	/// <summary>Query if the calling thread is one of the workers of this job system.</summary>
+	/// <returns>True if called from a job executed by a worker of this job system</returns>
+	bool isWorkerThread() const { return getCurrentWorkerIndex() < _queues.size(); }
+
+	/// <summary>Split [begin, end) into chunks of at most grainSize items and execute them in parallel, using the
+	/// workers and the calling thread. Returns when all chunks are complete, and rethrows the first exception.</summary>
+	/// <param name="begin">The first index</param>
+	/// <param name="end">One past the last index</param>
+	/// <param name="grainSize">The maximum number of indices per chunk. 0 picks one so that there are a few chunks per worker.</param>
+	/// <param name="function">Called as function(chunkBegin, chunkEnd) for each chunk</param>
+	template<typename Function>
+	void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const Function& function)
+	{
+		if (end <= begin) { return; }
+		const uint32_t count = end - begin;
+		if (!grainSize) { grainSize = std::max(1u, count / (4 * (getNumWorkers() + 1))); }
+		const uint32_t numChunks = (count + grainSize - 1) / grainSize;
+		if (numChunks == 1)
+		{
+			function(begin, end);
+			return;
+		}
+
+		// Each job claims chunks from a shared counter until none are left, so the number of jobs (and of allocations) is
+		// bounded by the number of workers rather than the number of chunks.
+		std::atomic<uint32_t> nextChunk(0);
+		auto runChunks = [&]() {
+			for (uint32_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+			{
+				const uint32_t chunkBegin = begin + chunk * grainSize;
+				function(chunkBegin, std::min(end, chunkBegin + grainSize));
+			}
+		};
+		std::vector<JobHandle> jobs(std::min(numChunks - 1, getNumWorkers()));
+		for (JobHandle& job : jobs) { job = submit(runChunks); }
+		std::exception_ptr exception;
+		try
+		{
+			runChunks();
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+			nextChunk = numChunks;
+		}
+		try
+		{
+			waitAll(jobs.data(), static_cast<uint32_t>(jobs.size()));
+		}
+		catch (...)
+		{
+			if (!exception) { exception = std::current_exception(); }
+		}
+		if (exception) { std::rethrow_exception(exception); }
+	}
+
+private:
+	struct WorkerQueue;
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void schedule(const JobHandle& job);
+	bool popJob(JobHandle& outJob);
+	bool tryRunJob(const JobHandle& job);
+	void execute(const JobHandle& job);
+	void workerLoop(uint32_t workerIndex);
+	uint32_t getCurrentWorkerIndex() const;
+
+	std::vector<std::unique_ptr<WorkerQueue>> _queues;
+	std::vector<std::thread> _threads;
+	std::atomic<uint32_t> _numQueued;
+	std::atomic<uint32_t> _nextQueue;
+	std::atomic<bool> _done;
+	struct SleepState;
+	std::unique_ptr<SleepState> _sleep;
+};
+} // namespace async
+} // namespace pvr
@@ -18,6 +18,7 @@
 #include "PVRCore/texture/TextureLoad.h"
 #include "PVRCore/stream/FilePath.h"
 #include "PVRCore/Time_.h"
+#include "PVRCore/Profiler.h"
 
 #include <iterator>
 // RefCounted.h has been made deprecated and is now unused throughout the PowerVR SDK
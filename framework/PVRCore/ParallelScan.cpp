@@ -0,0 +1,117 @@
+/*!
+\brief Implementation of the SIMD prefix sums of PVRCore/ParallelScan.h.
+\file PVRCore/ParallelScan.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRCore/ParallelScan.h"
+#include "PVRCore/Simd.h"
+
+namespace pvr {
+namespace async {
+namespace impl {
+namespace {
+// Four lanes of floats or of 32 bit integers, and the handful of operations the scans need on them.
+#if defined(PVR_SIMD_SSE)
+inline __m128 splat4(float value) { return _mm_set1_ps(value); }
+inline __m128i splat4(int32_t value) { return _mm_set1_epi32(value); }
+inline __m128 load4(const float* source) { return _mm_loadu_ps(source); }
+inline __m128i load4(const int32_t* source) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source)); }
+inline void store4(float* destination, __m128 value) { _mm_storeu_ps(destination, value); }
+inline void store4(int32_t* destination, __m128i value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), value); }
+inline __m128 add4(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+inline __m128i add4(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+// Moves every lane up by one or two lanes, shifting in zeros
+inline __m128 shiftLanes1(__m128 value) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(value), 4)); }
+inline __m128i shiftLanes1(__m128i value) { return _mm_slli_si128(value, 4); }
+inline __m128 shiftLanes2(__m128 value) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(value), 8)); }
+inline __m128i shiftLanes2(__m128i value) { return _mm_slli_si128(value, 8); }
+inline __m128 broadcastLast(__m128 value) { return _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 3, 3)); }
+inline __m128i broadcastLast(__m128i value) { return _mm_shuffle_epi32(value, _MM_SHUFFLE(3, 3, 3, 3)); }
+inline float firstLane(__m128 value) { return _mm_cvtss_f32(value); }
+inline int32_t firstLane(__m128i value) { return _mm_cvtsi128_si32(value); }
+#elif defined(PVR_SIMD_NEON)
+inline float32x4_t splat4(float value) { return vdupq_n_f32(value); }
+inline int32x4_t splat4(int32_t value) { return vdupq_n_s32(value); }
+inline float32x4_t load4(const float* source) { return vld1q_f32(source); }
+inline int32x4_t load4(const int32_t* source) { return vld1q_s32(source); }
+inline void store4(float* destination, float32x4_t value) { vst1q_f32(destination, value); }
+inline void store4(int32_t* destination, int32x4_t value) { vst1q_s32(destination, value); }
+inline float32x4_t add4(float32x4_t a, float32x4_t b) { return vaddq_f32(a, b); }
+inline int32x4_t add4(int32x4_t a, int32x4_t b) { return vaddq_s32(a, b); }
+inline float32x4_t shiftLanes1(float32x4_t value) { return vextq_f32(vdupq_n_f32(0.f), value, 3); }
+inline int32x4_t shiftLanes1(int32x4_t value) { return vextq_s32(vdupq_n_s32(0), value, 3); }
+inline float32x4_t shiftLanes2(float32x4_t value) { return vextq_f32(vdupq_n_f32(0.f), value, 2); }
+inline int32x4_t shiftLanes2(int32x4_t value) { return vextq_s32(vdupq_n_s32(0), value, 2); }
+inline float32x4_t broadcastLast(float32x4_t value) { return vdupq_n_f32(vgetq_lane_f32(value, 3)); }
+inline int32x4_t broadcastLast(int32x4_t value) { return vdupq_n_s32(vgetq_lane_s32(value, 3)); }
+inline float firstLane(float32x4_t value) { return vgetq_lane_f32(value, 0); }
+inline int32_t firstLane(int32x4_t value) { return vgetq_lane_s32(value, 0); }
+#endif
+
+#if defined(PVR_SIMD_SSE) || defined(PVR_SIMD_NEON)
+template<typename T>
+T scanBlockSimd(const T* input, T* output, size_t count, ScanMode mode, T carry)
+{
+	auto carry4 = splat4(carry);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// In-register inclusive scan of the four elements, then offset by the sum of everything before them
+		auto scan4 = load4(input + i);
+		scan4 = add4(scan4, shiftLanes1(scan4));
+		scan4 = add4(scan4, shiftLanes2(scan4));
+		store4(output + i, add4(carry4, mode == ScanMode::Inclusive ? scan4 : shiftLanes1(scan4)));
+		carry4 = add4(carry4, broadcastLast(scan4));
+	}
+	return scanBlock<T>(input + i, output + i, count - i, mode, firstLane(carry4));
+}
+
+template<typename T>
+T sumBlockSimd(const T* input, size_t count)
+{
+	// Two accumulators to hide the latency of the additions
+	auto sum0 = splat4(T());
+	auto sum1 = splat4(T());
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		sum0 = add4(sum0, load4(input + i));
+		sum1 = add4(sum1, load4(input + i + 4));
+	}
+	sum0 = add4(sum0, sum1);
+	sum0 = add4(sum0, shiftLanes1(sum0));
+	sum0 = add4(sum0, shiftLanes2(sum0));
+	return firstLane(broadcastLast(sum0)) + sumBlock<T>(input + i, count - i);
+}
+#else
+template<typename T>
+T scanBlockSimd(const T* input, T* output, size_t count, ScanMode mode, T carry)
+{
+	return scanBlock<T>(input, output, count, mode, carry);
+}
+
+template<typename T>
+T sumBlockSimd(const T* input, size_t count)
+{
+	return sumBlock<T>(input, count);
+}
+#endif
+} // namespace
+
+float scanBlock(const float* input, float* output, size_t count, ScanMode mode, float carry) { return scanBlockSimd(input, output, count, mode, carry); }
+int32_t scanBlock(const int32_t* input, int32_t* output, size_t count, ScanMode mode, int32_t carry) { return scanBlockSimd(input, output, count, mode, carry); }
+// Two's complement addition is the same for signed and unsigned integers, so unsigned arrays use the signed scan.
+uint32_t scanBlock(const uint32_t* input, uint32_t* output, size_t count, ScanMode mode, uint32_t carry)
+{
+	return static_cast<uint32_t>(
+		scanBlockSimd(reinterpret_cast<const int32_t*>(input), reinterpret_cast<int32_t*>(output), count, mode, static_cast<int32_t>(carry)));
+}
+float sumBlock(const float* input, size_t count) { return sumBlockSimd(input, count); }
+int32_t sumBlock(const int32_t* input, size_t count) { return sumBlockSimd(input, count); }
+uint32_t sumBlock(const uint32_t* input, size_t count) { return static_cast<uint32_t>(sumBlockSimd(reinterpret_cast<const int32_t*>(input), count)); }
+} // namespace impl
+} // namespace async
+} // namespace pvr
+//!\endcond
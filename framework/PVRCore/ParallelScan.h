@@ -0,0 +1,126 @@
+/*!
+\brief Prefix sums (scans) of arrays, on one thread or spread over the threads of a JobSystem.
+\file PVRCore/ParallelScan.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/JobSystem.h"
+
+namespace pvr {
+namespace async {
+/// <summary>Whether the element itself is included in its own prefix sum</summary>
+enum class ScanMode
+{
+	Inclusive, ///< output[i] = initial + input[0] + ... + input[i]
+	Exclusive ///< output[i] = initial + input[0] + ... + input[i - 1], so output[0] = initial
+};
+
+/// <summary>The default number of elements scanned by each task of parallelScan</summary>
+static const uint32_t DefaultScanBlockSize = 16384;
+
+//!\cond NO_DOXYGEN
+namespace impl {
+// Scans count elements starting from carry, and returns carry plus the sum of all the elements. Input and output may be
+// the same array.
+template<typename T>
+T scanBlock(const T* input, T* output, size_t count, ScanMode mode, T carry)
+{
+	if (mode == ScanMode::Inclusive)
+	{
+		for (size_t i = 0; i < count; ++i) { output[i] = carry = carry + input[i]; }
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T value = input[i];
+			output[i] = carry;
+			carry = carry + value;
+		}
+	}
+	return carry;
+}
+
+template<typename T>
+T sumBlock(const T* input, size_t count)
+{
+	T sum = T();
+	for (size_t i = 0; i < count; ++i) { sum = sum + input[i]; }
+	return sum;
+}
+
+// SIMD versions (SSE2 or NEON) for the most common element types. The elements are scanned four at a time within a
+// register, by adding the register to itself shifted by one, then two, lanes.
+float scanBlock(const float* input, float* output, size_t count, ScanMode mode, float carry);
+int32_t scanBlock(const int32_t* input, int32_t* output, size_t count, ScanMode mode, int32_t carry);
+uint32_t scanBlock(const uint32_t* input, uint32_t* output, size_t count, ScanMode mode, uint32_t carry);
+float sumBlock(const float* input, size_t count);
+int32_t sumBlock(const int32_t* input, size_t count);
+uint32_t sumBlock(const uint32_t* input, size_t count);
+} // namespace impl
+//!\endcond
+
+/// <summary>Compute the prefix sums of an array on the calling thread. float, int32_t and uint32_t arrays are scanned
+/// with SIMD instructions where available; any other type with an operator+ and a zero default value is scanned one
+/// element at a time.</summary>
+/// <param name="input">The elements to scan</param>
+/// <param name="output">Receives the count prefix sums. May be the same array as input</param>
+/// <param name="count">The number of elements</param>
+/// <param name="mode">Inclusive or exclusive scan</param>
+/// <param name="initial">A value added to every prefix sum, e.g. the total of a previous part of the array</param>
+/// <returns>initial plus the sum of all the elements, which for compaction is the number of elements kept</returns>
+template<typename T>
+T scan(const T* input, T* output, size_t count, ScanMode mode, T initial = T())
+{
+	return impl::scanBlock(input, output, count, mode, initial);
+}
+
+/// <summary>Compute the prefix sums of an array using the workers of a JobSystem and the calling thread. The array is
+/// split into blocks; a first pass sums each block in parallel, the block sums are scanned serially to find the value
+/// each block starts from, and a second pass scans each block in parallel starting from that value. Each element is
+/// therefore read twice, so arrays of no more than one block are scanned on the calling thread instead.</summary>
+/// <param name="jobSystem">The JobSystem to run the passes on</param>
+/// <param name="input">The elements to scan</param>
+/// <param name="output">Receives the count prefix sums. May be the same array as input</param>
+/// <param name="count">The number of elements</param>
+/// <param name="mode">Inclusive or exclusive scan</param>
+/// <param name="initial">A value added to every prefix sum</param>
+/// <param name="blockSize">The number of elements handled by each task</param>
+/// <returns>initial plus the sum of all the elements</returns>
+/// <remarks>Floating point sums are associated differently than by scan, so the results may differ by rounding.</remarks>
+template<typename T>
+T parallelScan(JobSystem& jobSystem, const T* input, T* output, size_t count, ScanMode mode, T initial = T(), uint32_t blockSize = DefaultScanBlockSize)
+{
+	blockSize = std::max(blockSize, 1u);
+	if (count <= blockSize || jobSystem.getNumWorkers() == 0) { return scan(input, output, count, mode, initial); }
+
+	const uint32_t numBlocks = static_cast<uint32_t>((count + blockSize - 1) / blockSize);
+	std::vector<T> blockStarts(numBlocks);
+	jobSystem.parallelFor(0, numBlocks, 1, [&](uint32_t blockBegin, uint32_t blockEnd) {
+		for (uint32_t block = blockBegin; block < blockEnd; ++block)
+		{
+			const size_t offset = static_cast<size_t>(block) * blockSize;
+			blockStarts[block] = impl::sumBlock(input + offset, std::min<size_t>(blockSize, count - offset));
+		}
+	});
+
+	T total = initial;
+	for (T& blockStart : blockStarts)
+	{
+		const T blockSum = blockStart;
+		blockStart = total;
+		total = total + blockSum;
+	}
+
+	jobSystem.parallelFor(0, numBlocks, 1, [&](uint32_t blockBegin, uint32_t blockEnd) {
+		for (uint32_t block = blockBegin; block < blockEnd; ++block)
+		{
+			const size_t offset = static_cast<size_t>(block) * blockSize;
+			impl::scanBlock(input + offset, output + offset, std::min<size_t>(blockSize, count - offset), mode, blockStarts[block]);
+		}
+	});
+	return total;
+}
+} // namespace async
+} // namespace pvr
@@ -0,0 +1,386 @@
+/*!
+\brief Implementation of the hierarchical Profiler.
+\file PVRCore/Profiler.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRCore/Profiler.h"
+#include "PVRCore/stream/Stream.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+namespace pvr {
+struct Profiler::Track
+{
+	// A slot of the ring. The fields are atomics so that a reader can copy a slot while its producer overwrites it, and
+	// the sequence number tells the reader whether the copy is the event it expected, complete and untorn.
+	struct Slot
+	{
+		// 2 * (index + 1) once the event with this index has been completely written, odd while an event is being written.
+		std::atomic<uint64_t> sequence;
+		std::atomic<const char*> name;
+		std::atomic<uint64_t> beginNs;
+		std::atomic<uint64_t> endNs;
+		std::atomic<uint32_t> frame;
+		std::atomic<uint16_t> depth;
+	};
+
+	Track(const std::string& name, uint32_t id) : name(name), id(id), slots(nullptr), firstIndex(0), writeIndex(0), depth(0) {}
+	~Track() { delete[] slots.load(std::memory_order_relaxed); }
+
+	// Guarded by the tracks mutex.
+	std::string name;
+	uint32_t id;
+	// Allocated by the producer of the track on its first event recorded while the profiler is enabled, then never replaced.
+	std::atomic<Slot*> slots;
+	// Events before this index were recorded by a thread that has exited. Guarded by the tracks mutex.
+	uint64_t firstIndex;
+	// Only ever incremented by the producer of the track, with release semantics, after the event has been written.
+	std::atomic<uint64_t> writeIndex;
+	// Only touched by the owning thread.
+	uint16_t depth;
+	// Only used for named tracks, which can be written from any thread.
+	std::mutex writeMutex;
+
+	void push(const ProfileEvent& event, bool enabled)
+	{
+		Slot* ring = slots.load(std::memory_order_relaxed);
+		if (!ring)
+		{
+			if (!enabled) { return; }
+			// Value-initialised, so every sequence starts at 0, which matches no event.
+			ring = new Slot[kEventsPerTrack]();
+			slots.store(ring, std::memory_order_release);
+		}
+		const uint64_t index = writeIndex.load(std::memory_order_relaxed);
+		Slot& slot = ring[index & (kEventsPerTrack - 1)];
+		slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.name.store(event.name, std::memory_order_relaxed);
+		slot.beginNs.store(event.beginNs, std::memory_order_relaxed);
+		slot.endNs.store(event.endNs, std::memory_order_relaxed);
+		slot.frame.store(event.frame, std::memory_order_relaxed);
+		slot.depth.store(event.depth, std::memory_order_relaxed);
+		slot.sequence.store(2 * index + 2, std::memory_order_release);
+		writeIndex.store(index + 1, std::memory_order_release);
+	}
+
+	// Copy the event with the given index. Fails if the slot has been, or is being, overwritten by a newer event.
+	bool read(uint64_t index, ProfileEvent& outEvent) const
+	{
+		const Slot* ring = slots.load(std::memory_order_acquire);
+		if (!ring) { return false; }
+		const Slot& slot = ring[index & (kEventsPerTrack - 1)];
+		const uint64_t sequence = 2 * index + 2;
+		if (slot.sequence.load(std::memory_order_acquire) != sequence) { return false; }
+		outEvent.name = slot.name.load(std::memory_order_relaxed);
+		outEvent.beginNs = slot.beginNs.load(std::memory_order_relaxed);
+		outEvent.endNs = slot.endNs.load(std::memory_order_relaxed);
+		outEvent.frame = slot.frame.load(std::memory_order_relaxed);
+		outEvent.depth = slot.depth.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return slot.sequence.load(std::memory_order_relaxed) == sequence;
+	}
+};
+
+// Hands the track of a thread back to the profiler when the thread exits, so that a later thread can reuse it.
+struct Profiler::ThreadTrackOwner
+{
+	Track* track;
+
+	ThreadTrackOwner() : track(nullptr) {}
+	~ThreadTrackOwner()
+	{
+		if (track) { Profiler::getInstance().releaseThreadTrack(*track); }
+	}
+};
+
+namespace {
+void appendJsonString(std::string& out, const char* str)
+{
+	out += '"';
+	for (; *str; ++str)
+	{
+		const char c = *str;
+		if (c == '"' || c == '\\')
+		{
+			out += '\\';
+			out += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20) { out += ' '; }
+		else
+		{
+			out += c;
+		}
+	}
+	out += '"';
+}
+
+void appendMicroseconds(std::string& out, uint64_t ns)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%llu.%03u", static_cast<unsigned long long>(ns / 1000), static_cast<unsigned>(ns % 1000));
+	out += buffer;
+}
+} // namespace
+
+Profiler& Profiler::getInstance()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler()
+	: _enabled(false), _frameIndex(0), _frameStarts(new std::atomic<uint64_t>[kFramesKept]), _nextTrackId(1), _counterSamples(new ProfileCounterSample[kCounterSamplesKept]),
+	  _counterWriteIndex(0)
+{
+	for (uint32_t i = 0; i < kFramesKept; ++i) { _frameStarts[i].store(0, std::memory_order_relaxed); }
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+	if (enabled && !isEnabled()) { nextFrame(); }
+	_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::nextFrame()
+{
+	const uint32_t frame = _frameIndex.load(std::memory_order_relaxed) + 1;
+	_frameStarts[frame & (kFramesKept - 1)].store(getTimestampNs(), std::memory_order_relaxed);
+	_frameIndex.store(frame, std::memory_order_release);
+}
+
+uint64_t Profiler::getFrameStartNs(uint32_t frame) const
+{
+	const uint32_t current = _frameIndex.load(std::memory_order_acquire);
+	if (frame > current || current - frame >= kFramesKept) { return 0; }
+	return _frameStarts[frame & (kFramesKept - 1)].load(std::memory_order_relaxed);
+}
+
+Profiler::Track& Profiler::getThreadTrack()
+{
+	static thread_local ThreadTrackOwner owner;
+	if (!owner.track)
+	{
+		std::ostringstream threadName;
+		threadName << "Thread " << std::this_thread::get_id();
+		std::lock_guard<std::mutex> lock(_tracksMutex);
+		if (_freeThreadTracks.empty())
+		{
+			_tracks.emplace_back(new Track(threadName.str(), _nextTrackId++));
+			owner.track = _tracks.back().get();
+		}
+		else
+		{
+			// Reuse the track (and ring) of an exited thread, under a new id so that its events are not attributed to this one.
+			owner.track = _freeThreadTracks.back();
+			_freeThreadTracks.pop_back();
+			owner.track->name = threadName.str();
+			owner.track->id = _nextTrackId++;
+			owner.track->firstIndex = owner.track->writeIndex.load(std::memory_order_relaxed);
+			owner.track->depth = 0;
+		}
+	}
+	return *owner.track;
+}
+
+void Profiler::releaseThreadTrack(Track& track)
+{
+	std::lock_guard<std::mutex> lock(_tracksMutex);
+	_freeThreadTracks.push_back(&track);
+}
+
+Profiler::Track& Profiler::getNamedTrack(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(_tracksMutex);
+	for (auto& track : _tracks)
+	{
+		if (track->name == name) { return *track; }
+	}
+	_tracks.emplace_back(new Track(name, _nextTrackId++));
+	return *_tracks.back();
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+	Track& track = getThreadTrack();
+	std::lock_guard<std::mutex> lock(_tracksMutex);
+	track.name = name;
+}
+
+uint16_t Profiler::pushDepth() { return getThreadTrack().depth++; }
+
+void Profiler::popDepth()
+{
+	Track& track = getThreadTrack();
+	if (track.depth) { --track.depth; }
+}
+
+void Profiler::recordCpuEvent(const char* name, uint64_t beginNs, uint64_t endNs, uint32_t frame, uint16_t depth)
+{
+	const ProfileEvent event = { name, beginNs, endNs, frame, depth };
+	getThreadTrack().push(event, isEnabled());
+}
+
+void Profiler::recordTrackEvent(const std::string& track, const ProfileEvent& event)
+{
+	Track& namedTrack = getNamedTrack(track);
+	std::lock_guard<std::mutex> lock(namedTrack.writeMutex);
+	namedTrack.push(event, isEnabled());
+}
+
+void Profiler::recordCounter(const char* name, double value)
+{
+	if (!isEnabled()) { return; }
+	const ProfileCounterSample sample = { name, getTimestampNs(), getFrameIndex(), value };
+	std::lock_guard<std::mutex> lock(_countersMutex);
+	_counterSamples[_counterWriteIndex++ & (kCounterSamplesKept - 1)] = sample;
+}
+
+void Profiler::collectEvents(const Track& track, uint32_t firstFrame, uint32_t lastFrame, std::vector<ProfileEvent>& outEvents) const
+{
+	const uint64_t end = track.writeIndex.load(std::memory_order_acquire);
+	const uint64_t available = std::min<uint64_t>(end - track.firstIndex, kEventsPerTrack);
+	ProfileEvent event;
+	for (uint64_t i = end - available; i < end; ++i)
+	{
+		// The producer may be overwriting the oldest events while we read: those are skipped rather than read torn.
+		if (track.read(i, event) && event.frame >= firstFrame && event.frame <= lastFrame) { outEvents.push_back(event); }
+	}
+	std::sort(outEvents.begin(), outEvents.end(), [](const ProfileEvent& a, const ProfileEvent& b) { return a.beginNs < b.beginNs || (a.beginNs == b.beginNs && a.depth < b.depth); });
+}
+
+void Profiler::exportChromeTrace(Stream& stream, uint32_t numFrames) const
+{
+	const uint32_t current = getFrameIndex();
+	uint32_t firstFrame = 0;
+	uint32_t lastFrame = current;
+	if (numFrames)
+	{
+		lastFrame = current ? current - 1 : 0;
+		firstFrame = lastFrame >= numFrames ? lastFrame - numFrames + 1 : 0;
+	}
+
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"PowerVR SDK\"}}";
+
+	for (uint32_t frame = std::max(firstFrame, current >= kFramesKept ? current - kFramesKept + 1 : 0); frame <= lastFrame; ++frame)
+	{
+		const uint64_t frameStart = getFrameStartNs(frame);
+		if (!frameStart && frame) { continue; }
+		json += ",\n{\"name\":\"Frame ";
+		json += std::to_string(frame);
+		json += "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":";
+		appendMicroseconds(json, frameStart);
+		json += '}';
+	}
+
+	std::vector<ProfileEvent> events;
+	std::lock_guard<std::mutex> lock(_tracksMutex);
+	for (const auto& track : _tracks)
+	{
+		const std::string tid = std::to_string(track->id);
+		json += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+		json += tid;
+		json += ",\"args\":{\"name\":";
+		appendJsonString(json, track->name.c_str());
+		json += "}}";
+
+		events.clear();
+		collectEvents(*track, firstFrame, lastFrame, events);
+		for (const ProfileEvent& event : events)
+		{
+			json += ",\n{\"name\":";
+			appendJsonString(json, event.name);
+			json += ",\"ph\":\"X\",\"pid\":1,\"tid\":";
+			json += tid;
+			json += ",\"ts\":";
+			appendMicroseconds(json, event.beginNs);
+			json += ",\"dur\":";
+			appendMicroseconds(json, event.endNs > event.beginNs ? event.endNs - event.beginNs : 0);
+			json += ",\"args\":{\"frame\":";
+			json += std::to_string(event.frame);
+			json += "}}";
+		}
+	}
+
+	std::lock_guard<std::mutex> countersLock(_countersMutex);
+	const uint64_t numSamples = std::min<uint64_t>(_counterWriteIndex, kCounterSamplesKept);
+	char value[32];
+	for (uint64_t i = _counterWriteIndex - numSamples; i < _counterWriteIndex; ++i)
+	{
+		const ProfileCounterSample& sample = _counterSamples[i & (kCounterSamplesKept - 1)];
+		if (sample.frame < firstFrame || sample.frame > lastFrame) { continue; }
+		json += ",\n{\"name\":";
+		appendJsonString(json, sample.name);
+		json += ",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":";
+		appendMicroseconds(json, sample.timeNs);
+		snprintf(value, sizeof(value), "%.17g", sample.value);
+		json += ",\"args\":{\"value\":";
+		json += value;
+		json += "}}";
+	}
+	json += "\n]}\n";
+	stream.writeExact(1, json.size(), json.data());
+}
+
+std::vector<ProfileSummaryEntry> Profiler::getSummary(uint32_t numFrames) const
+{
+	std::vector<ProfileSummaryEntry> summary;
+	const uint32_t current = getFrameIndex();
+	if (!numFrames || !current) { return summary; }
+	const uint32_t lastFrame = current - 1;
+	const uint32_t firstFrame = lastFrame >= numFrames ? lastFrame - numFrames + 1 : 0;
+	const double framesCounted = static_cast<double>(lastFrame - firstFrame + 1);
+
+	std::vector<ProfileEvent> events;
+	std::lock_guard<std::mutex> lock(_tracksMutex);
+	for (const auto& track : _tracks)
+	{
+		events.clear();
+		collectEvents(*track, firstFrame, lastFrame, events);
+		const size_t trackStart = summary.size();
+		for (const ProfileEvent& event : events)
+		{
+			auto it = std::find_if(summary.begin() + trackStart, summary.end(),
+				[&event](const ProfileSummaryEntry& entry) { return entry.depth == event.depth && strcmp(entry.name, event.name) == 0; });
+			if (it == summary.end())
+			{
+				ProfileSummaryEntry entry = { track->name, event.name, event.depth, 0, 0.0 };
+				summary.push_back(entry);
+				it = summary.end() - 1;
+			}
+			++it->calls;
+			it->averageMs += static_cast<double>(event.endNs > event.beginNs ? event.endNs - event.beginNs : 0) * 1e-6;
+		}
+		for (auto it = summary.begin() + trackStart; it != summary.end(); ++it) { it->averageMs /= framesCounted; }
+	}
+	return summary;
+}
+
+std::string Profiler::getSummaryString(uint32_t numFrames) const
+{
+	const std::vector<ProfileSummaryEntry> summary = getSummary(numFrames);
+	std::string text;
+	const std::string* currentTrack = nullptr;
+	char line[160];
+	for (const ProfileSummaryEntry& entry : summary)
+	{
+		if (!currentTrack || *currentTrack != entry.track)
+		{
+			currentTrack = &entry.track;
+			text += entry.track;
+			text += '\n';
+		}
+		text.append(2u * (entry.depth + 1u), ' ');
+		snprintf(line, sizeof(line), "%s: %.3f ms (%u)\n", entry.name, entry.averageMs, entry.calls);
+		text += line;
+	}
+	return text;
+}
+} // namespace pvr
+//!\endcond
@@ -0,0 +1,217 @@
+/*!
+\brief A lightweight hierarchical CPU/GPU profiler with Chrome trace export.
+\file PVRCore/Profiler.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/Time_.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pvr {
+class Stream;
+
+/// <summary>A single timed zone recorded by the Profiler.</summary>
+struct ProfileEvent
+{
+	const char* name; //!< The name of the zone. Must point to a string that outlives the profiler (normally a literal)
+	uint64_t beginNs; //!< Start time in nanoseconds, on the Profiler timeline
+	uint64_t endNs; //!< End time in nanoseconds, on the Profiler timeline
+	uint32_t frame; //!< The index of the frame the zone began in
+	uint16_t depth; //!< The nesting depth of the zone on its track
+};
+
+/// <summary>A single sample of a named counter (for example memory usage) recorded by the Profiler.</summary>
+struct ProfileCounterSample
+{
+	const char* name; //!< The name of the counter. Must point to a string that outlives the profiler (normally a literal)
+	uint64_t timeNs; //!< The time the sample was taken in nanoseconds, on the Profiler timeline
+	uint32_t frame; //!< The index of the frame the sample was taken in
+	double value; //!< The value of the counter
+};
+
+/// <summary>Aggregated statistics of one zone over a number of frames, as returned by Profiler::getSummary.</summary>
+struct ProfileSummaryEntry
+{
+	std::string track; //!< The name of the track (thread or GPU queue) the zone was recorded on
+	const char* name; //!< The name of the zone
+	uint16_t depth; //!< The nesting depth of the zone
+	uint32_t calls; //!< The total number of times the zone was recorded over the frames considered
+	double averageMs; //!< The average time spent in the zone per frame, in milliseconds
+};
+
+/// <summary>A hierarchical profiler. CPU zones are recorded with ProfileScope (or PVR_PROFILE_SCOPE) into a fixed
+/// size ring buffer per thread: recording takes no locks and, after the first event of the thread, does no allocations,
+/// and the only synchronisation is a sequence number per slot, written by the owning thread, that lets readers skip
+/// events overwritten while they read. GPU zones are added by the API specific helpers (for example
+/// pvr::utils::GpuProfiler for Vulkan) once their timestamps have been resolved. Call nextFrame() once per frame so that
+/// the recorded events can be aligned to frames.</summary>
+/// <remarks>The profiler is disabled by default and ProfileScope is then a single relaxed atomic load. Each track
+/// keeps the last kEventsPerTrack events: older events are overwritten. The ring of a track is only allocated once an
+/// event is recorded on it while the profiler is enabled, and the track of a thread that exits is handed to the next
+/// new thread, which drops the events of the exited thread. Threads that never record and short lived threads therefore
+/// cost next to nothing. Define PVR_DISABLE_PROFILER to compile PVR_PROFILE_SCOPE out completely.</remarks>
+class Profiler
+{
+public:
+	/// <summary>The number of events each track keeps. Must be a power of two.</summary>
+	static const uint32_t kEventsPerTrack = 16384;
+	/// <summary>The number of frame start times kept. Must be a power of two.</summary>
+	static const uint32_t kFramesKept = 256;
+	/// <summary>The number of counter samples kept. Must be a power of two.</summary>
+	static const uint32_t kCounterSamplesKept = 4096;
+
+	/// <summary>Get the global profiler.</summary>
+	/// <returns>The global profiler</returns>
+	static Profiler& getInstance();
+
+	/// <summary>Enable or disable recording. Enabling also starts a new frame.</summary>
+	/// <param name="enabled">True to start recording, false to stop</param>
+	void setEnabled(bool enabled);
+
+	/// <summary>Query if the profiler is currently recording.</summary>
+	/// <returns>True if recording, otherwise false</returns>
+	bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+	/// <summary>Mark the start of a new frame. Should be called once per frame by the thread driving the frame loop.</summary>
+	void nextFrame();
+
+	/// <summary>Get the index of the current frame.</summary>
+	/// <returns>The index of the current frame</returns>
+	uint32_t getFrameIndex() const { return _frameIndex.load(std::memory_order_relaxed); }
+
+	/// <summary>Get the time at which a recent frame started.</summary>
+	/// <param name="frame">The index of the frame. Only the last kFramesKept frames are available.</param>
+	/// <returns>The start time of the frame in nanoseconds on the Profiler timeline, or 0 if unavailable</returns>
+	uint64_t getFrameStartNs(uint32_t frame) const;
+
+	/// <summary>Get the current time on the Profiler timeline.</summary>
+	/// <returns>The nanoseconds elapsed since the profiler was created</returns>
+	uint64_t getTimestampNs() const { return _time.getElapsedNanoSecs(); }
+
+	/// <summary>Set the name the calling thread will be shown with in the exported trace.</summary>
+	/// <param name="name">The name of the thread</param>
+	void setThreadName(const std::string& name);
+
+	/// <summary>Record a completed CPU zone on the track of the calling thread. Normally used through ProfileScope.</summary>
+	/// <param name="name">The name of the zone. Must outlive the profiler.</param>
+	/// <param name="beginNs">The start time of the zone, from getTimestampNs()</param>
+	/// <param name="endNs">The end time of the zone, from getTimestampNs()</param>
+	/// <param name="frame">The frame the zone began in</param>
+	/// <param name="depth">The nesting depth of the zone</param>
+	void recordCpuEvent(const char* name, uint64_t beginNs, uint64_t endNs, uint32_t frame, uint16_t depth);
+
+	/// <summary>Record a completed zone on a named track other than the calling thread, for example a GPU queue.
+	/// Tracks are created on first use. Safe to call from any thread.</summary>
+	/// <param name="track">The name of the track</param>
+	/// <param name="event">The event to record</param>
+	void recordTrackEvent(const std::string& track, const ProfileEvent& event);
+
+	/// <summary>Record the current value of a named counter. Counters are exported as counter tracks in the Chrome trace.
+	/// Safe to call from any thread. Does nothing if the profiler is disabled.</summary>
+	/// <param name="name">The name of the counter. Must outlive the profiler (normally a string literal).</param>
+	/// <param name="value">The value of the counter</param>
+	void recordCounter(const char* name, double value);
+
+	/// <summary>Export the recorded events in the Chrome trace event format (load in chrome://tracing or Perfetto).
+	/// Each track becomes a thread, each frame start becomes a global instant event and each counter becomes a counter track.</summary>
+	/// <param name="stream">A writable stream to write the JSON to</param>
+	/// <param name="numFrames">Only export events from the last numFrames complete frames. 0 exports everything kept.</param>
+	void exportChromeTrace(Stream& stream, uint32_t numFrames = 0) const;
+
+	/// <summary>Aggregate the recorded zones of the last numFrames complete frames.</summary>
+	/// <param name="numFrames">The number of complete frames to average over</param>
+	/// <returns>One entry per track, zone name and depth, ordered by track then by first occurrence</returns>
+	std::vector<ProfileSummaryEntry> getSummary(uint32_t numFrames) const;
+
+	/// <summary>Format the result of getSummary as indented text, one zone per line, suitable for an on-screen overlay.</summary>
+	/// <param name="numFrames">The number of complete frames to average over</param>
+	/// <returns>The summary text</returns>
+	std::string getSummaryString(uint32_t numFrames) const;
+
+	/// <summary>Enter a zone on the calling thread. Used by ProfileScope.</summary>
+	/// <returns>The nesting depth of the new zone</returns>
+	uint16_t pushDepth();
+
+	/// <summary>Leave a zone on the calling thread. Used by ProfileScope.</summary>
+	void popDepth();
+
+private:
+	struct Track;
+	struct ThreadTrackOwner;
+
+	Profiler();
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	Track& getThreadTrack();
+	Track& getNamedTrack(const std::string& name);
+	void releaseThreadTrack(Track& track);
+	void collectEvents(const Track& track, uint32_t firstFrame, uint32_t lastFrame, std::vector<ProfileEvent>& outEvents) const;
+
+	Time _time;
+	std::atomic<bool> _enabled;
+	std::atomic<uint32_t> _frameIndex;
+	std::unique_ptr<std::atomic<uint64_t>[]> _frameStarts;
+	mutable std::mutex _tracksMutex;
+	std::vector<std::unique_ptr<Track>> _tracks;
+	std::vector<Track*> _freeThreadTracks;
+	uint32_t _nextTrackId;
+	mutable std::mutex _countersMutex;
+	std::unique_ptr<ProfileCounterSample[]> _counterSamples;
+	uint64_t _counterWriteIndex;
+};
+
+/// <summary>Records a CPU zone for the lifetime of the object, on the track of the thread that created it.</summary>
+class ProfileScope
+{
+public:
+	/// <summary>Begin a zone. Does nothing if the profiler is disabled.</summary>
+	/// <param name="name">The name of the zone. Must outlive the profiler (normally a string literal).</param>
+	explicit ProfileScope(const char* name) : _name(nullptr)
+	{
+		Profiler& profiler = Profiler::getInstance();
+		if (profiler.isEnabled())
+		{
+			_name = name;
+			_depth = profiler.pushDepth();
+			_frame = profiler.getFrameIndex();
+			_beginNs = profiler.getTimestampNs();
+		}
+	}
+
+	/// <summary>End the zone and record it.</summary>
+	~ProfileScope()
+	{
+		if (_name)
+		{
+			Profiler& profiler = Profiler::getInstance();
+			profiler.recordCpuEvent(_name, _beginNs, profiler.getTimestampNs(), _frame, _depth);
+			profiler.popDepth();
+		}
+	}
+
+private:
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+	const char* _name;
+	uint64_t _beginNs;
+	uint32_t _frame;
+	uint16_t _depth;
+};
+} // namespace pvr
+
+#if defined(PVR_DISABLE_PROFILER)
+#define PVR_PROFILE_SCOPE(name)
+#else
+#define PVR_PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define PVR_PROFILE_SCOPE_NAME_(line) PVR_PROFILE_SCOPE_CONCAT_(pvrProfileScope_, line)
+/// <summary>Profile the rest of the enclosing C++ scope as a zone with the given (string literal) name.</summary>
+#define PVR_PROFILE_SCOPE(name) ::pvr::ProfileScope PVR_PROFILE_SCOPE_NAME_(__LINE__)(name)
+#endif
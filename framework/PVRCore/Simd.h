@@ -0,0 +1,20 @@
+/*!
+\brief Detects the SIMD instruction set available to the compiler and includes its intrinsics.
+\file PVRCore/Simd.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+
+// At most one of PVR_SIMD_SSE and PVR_SIMD_NEON is defined. Code using them must keep a scalar fallback for targets that
+// have neither. SSE2 is required rather than SSE alone, as it is the baseline of every x86-64 target and provides the
+// integer and cast intrinsics as well as the floating point ones.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+/// <summary>Defined to 1 if SSE and SSE2 intrinsics are available.</summary>
+#define PVR_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+/// <summary>Defined to 1 if NEON intrinsics are available.</summary>
+#define PVR_SIMD_NEON 1
+#endif
@@ -7,6 +7,7 @@ MoodyCamel's BlockingConcurrentQueue.
 */
 #pragma once
 #include "../external/concurrent_queue/blockingconcurrentqueue.h"
+#include "PVRCore/JobSystem.h"
 
 #include <thread>
 #include <mutex>
@@ -14,6 +15,9 @@ MoodyCamel's BlockingConcurrentQueue.
 #include <condition_variable>
 #include <sstream>
 #include <deque>
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 //  ASYNCHRONOUS FRAMEWORK: Framework async loader base etc //
 namespace pvr {
@@ -162,11 +166,107 @@ private:
 	virtual T get_() const = 0;
 };
 
-/// <summary>The AsyncScheduler is an abstract Scheduling system of a homogeneous task queue running on a background
-/// thread, i.e. a queue of work of a particular type. It provides its child classes wioth access to the actual queue
-/// and the synchronization semaphores in order to facilitate easier implementation. Specifically, it is expected that
-/// the user will provide functions to enqueue and dequeue work, while this class provides the running loop (actually
-/// executing the tasks, calling the callbacks etc</summary>
+/// <summary>Wait until a semaphore that is used as a completion flag (signalled once when work completes) is
+/// signalled, then signal it again so that it stays signalled for further waits. When called from a worker of the
+/// process-wide JobSystem, pending jobs are executed while waiting, so that a job can safely wait for another job.
+/// Any other thread (such as the render thread) simply blocks, and never executes unrelated jobs.</summary>
+/// <param name="semaphore">The completion semaphore</param>
+inline void waitForCompletion(Semaphore& semaphore)
+{
+	JobSystem& jobSystem = JobSystem::getInstance();
+	if (jobSystem.isWorkerThread())
+	{
+		while (!semaphore.tryWait())
+		{
+			if (!jobSystem.tryRunPendingJob() && semaphore.wait(1000)) { break; }
+		}
+	}
+	else
+	{
+		semaphore.wait();
+	}
+	semaphore.signal();
+}
+
+/// <summary>An IFrameworkAsyncResult for a function executed as a job of a JobSystem. Create with submit.</summary>
+/// <typeparam name="T">The type of the return value of the function</typeparam>
+template<typename T>
+class JobFuture_ : public IFrameworkAsyncResult<T>, public std::enable_shared_from_this<JobFuture_<T>>
+{
+public:
+	/// <summary>The type of the optional callback that is called at the end of the operation</summary>
+	typedef typename IFrameworkAsyncResult<T>::Callback CallbackType;
+
+	/// <summary>Execute a function as a job and return a future to its result.</summary>
+	/// <param name="jobSystem">The job system to execute the function on</param>
+	/// <param name="function">The function to execute</param>
+	/// <param name="callback">An optional callback, called on the worker thread once the result is available</param>
+	/// <param name="dependencies">Jobs that must complete before the function is executed</param>
+	/// <param name="numDependencies">The number of dependencies</param>
+	/// <returns>The future</returns>
+	static std::shared_ptr<JobFuture_<T>> submit(
+		JobSystem& jobSystem, std::function<T()> function, CallbackType callback = nullptr, const JobHandle* dependencies = nullptr, uint32_t numDependencies = 0)
+	{
+		std::shared_ptr<JobFuture_<T>> future(new JobFuture_<T>(jobSystem));
+		future->setTheCallback(callback);
+		// The job keeps the future alive until it has run, even if the caller drops it. The job system releases the
+		// function once it has run, which breaks the cycle between the future and its job.
+		future->_job = jobSystem.submit(
+			[future, function]() {
+				try
+				{
+					future->_result = function();
+					future->_successful = true;
+				}
+				catch (...)
+				{
+					future->_exception = std::current_exception();
+				}
+				future->executeCallBack(future);
+			},
+			dependencies, numDependencies);
+		return future;
+	}
+
+	/// <summary>Get the job executing the function, for example to use it as a dependency of other jobs.</summary>
+	/// <returns>The job</returns>
+	const JobHandle& getJob() const { return _job; }
+
+private:
+	explicit JobFuture_(JobSystem& jobSystem) : _jobSystem(&jobSystem) {}
+
+	T get_() const
+	{
+		if (!this->_inCallback) { _jobSystem->wait(_job); }
+		if (_exception) { std::rethrow_exception(_exception); }
+		return _result;
+	}
+	bool isComplete_() const { return JobSystem::isComplete(_job); }
+	void cleanup_() {}
+
+	JobSystem* _jobSystem;
+	JobHandle _job;
+	T _result;
+	std::exception_ptr _exception;
+};
+
+/// <summary>Execute a function on the process-wide JobSystem and return an IFrameworkAsyncResult to its result.
+/// get() rethrows any exception thrown by the function.</summary>
+/// <param name="function">The function to execute</param>
+/// <param name="callback">An optional callback, called on the worker thread once the result is available</param>
+/// <typeparam name="T">The type of the return value of the function</typeparam>
+/// <returns>A future to the result</returns>
+template<typename T>
+inline typename IFrameworkAsyncResult<T>::PointerType runAsync(std::function<T()> function, typename IFrameworkAsyncResult<T>::Callback callback = nullptr)
+{
+	return JobFuture_<T>::submit(JobSystem::getInstance(), std::move(function), callback);
+}
+
+/// <summary>The AsyncScheduler is an abstract Scheduling system of a homogeneous task queue, i.e. a queue of work of
+/// a particular type. The work is executed by the process-wide JobSystem rather than by a thread owned by the
+/// scheduler: at most maxConcurrency jobs drain the queue at any time, so a scheduler whose work is not thread safe
+/// (for example because it records into a single command pool) keeps executing it one item at a time, in order.
+/// Derived classes provide functions that create the futures and pass them to enqueue.</summary>
 /// <typeparam name="ValueType">The type of the return value that will be returned by the functions</typeparam>
 /// <typeparam name="FutureType">The type of the future (which will also be the input to the worker function)</typeparam>
 /// <typeparam name="worker">The function pointer that will be called to perform the work</typeparam>
@@ -188,106 +288,79 @@ public:
 	/// <returns>The number of queued items (access is synchronized)</returns>
 	uint32_t getNumQueuedItems()
 	{
-		_queueSemaphore.wait();
-		uint32_t retval = static_cast<uint32_t>(_queue.size());
-		_queueSemaphore.signal();
-		return retval;
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		return static_cast<uint32_t>(_queue.size());
 	}
 
-	/// <summary>Destructor (virtual)</summary>
+	/// <summary>Destructor (virtual). Waits for all the queued work to be executed.</summary>
 	virtual ~AsyncScheduler()
 	{
-		bool didit = false;
-		_queueSemaphore.wait(); // protect the _done variable
-		if (!_done)
+		std::vector<JobHandle> drainJobs;
+		{
+			std::lock_guard<std::mutex> lock(_queueMutex);
+			drainJobs.swap(_drainJobs);
+		}
+		for (const JobHandle& job : drainJobs)
 		{
-			didit = true;
-			_done = true;
-			_workSemaphore.signal();
+			try
+			{
+				_jobSystem.wait(job);
+			}
+			catch (...)
+			{}
 		}
-		_queueSemaphore.signal();
-		if (didit) // Only join if it was actually running. Duh!
-		{ _thread.join(); } }
+	}
 
 protected:
-	/// <summary>Constructor (empty, spawns worker thread and waits)</summary>
-	AsyncScheduler()
+	/// <summary>Constructor.</summary>
+	/// <param name="maxConcurrency">The maximum number of items executed in parallel. 1 executes the items in order.</param>
+	explicit AsyncScheduler(uint32_t maxConcurrency = 1) : _jobSystem(JobSystem::getInstance()), _maxConcurrency(std::max(maxConcurrency, 1u)), _numDrainJobs(0) {}
+
+	/// <summary>Add an item of work to the queue, and start a job to execute it if fewer than maxConcurrency are running.</summary>
+	/// <param name="future">The item of work, passed to worker</param>
+	void enqueue(FutureType future)
 	{
-		_done = false;
-		_thread = std::thread(&AsyncScheduler::run, this);
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		_queue.emplace_back(std::move(future));
+		if (_numDrainJobs < _maxConcurrency)
+		{
+			++_numDrainJobs;
+			// Forget the drain jobs that are already done, so that the list does not grow over the lifetime of the scheduler.
+			_drainJobs.erase(std::remove_if(_drainJobs.begin(), _drainJobs.end(), [](const JobHandle& job) { return JobSystem::isComplete(job); }), _drainJobs.end());
+			_drainJobs.push_back(_jobSystem.submit([this]() { drain(); }));
+		}
 	}
 
-	/// <summary>This semaphore is the counter for enqueued work. Signal it once when adding work to the queue.</summary>
-	Semaphore _workSemaphore;
-	/// <summary>This is basically a mutex for the queue. Wait on it to lock the queue, then signal it when done.</summary>
-	Semaphore _queueSemaphore;
-	/// <summary>This is the work queue. Each item enqueued will be processed by worker.</summary>
+	/// <summary>This is the work queue. Each item enqueued will be processed by worker. Guarded by _queueMutex.</summary>
 	std::deque<FutureType> _queue;
+	/// <summary>Guards the queue.</summary>
+	std::mutex _queueMutex;
 	/// <summary>String information regarding the tasks operations.</summary>
 	std::string _myInfo;
 
 private:
-	std::thread _thread;
-	std::atomic_bool _done;
-	void run()
+	JobSystem& _jobSystem;
+	const uint32_t _maxConcurrency;
+	uint32_t _numDrainJobs;
+	std::vector<JobHandle> _drainJobs;
+
+	void drain()
 	{
-		Log(LogLevel::Information,
-			"%s : Asynchronous Scheduler starting. "
-			"1 worker thread spawned. The worker thread will be sleeping as long as no work is being performed, "
-			"and will be released when the async sheduler is destroyed.",
-			_myInfo.c_str());
-
-		std::string _str_0_unlock_ = (_myInfo + " : LOOP ENTER: Unlocking the queue.");
-		std::string _str_1_wait_work_ = (_myInfo + " : Queue unlocked, waiting for work to be scheduled");
-		std::string _str_2_queuelock_ = (_myInfo + " : Work scheduled, Obtaining queue lock");
-		std::string _str_3_queueLocked_ = (_myInfo + " : Queue lock obtained, testing to determine work/exit");
-		std::string _str_4_exit_signal_ = (_myInfo + " : Queue was signalled without items - must be the exit signal. Exiting...");
-		std::string _str_5_obtaining_work_ = (_myInfo + " : Queue had items: Obtaining work!");
-		std::string _str_6_obtained_work_ = (_myInfo + " : Work obtained, Releasing the queue.");
-		std::string _str_7_executing_work_ = (_myInfo + " : Queue released, Executing work.");
-		std::string _str_8_execution_done_ = (_myInfo + " : Work execution done, locking the queue.");
-		std::string _str_9_looping_up_ = (_myInfo + " : Queue locked, LOOPING!");
-
-		// Are we done?
-		// a) The queue will be empty on the first iteration.
-		// b) Even if the queue is empty, consumers may be blocked on results.
-		// c) Even if done, consumers may be blocked on results.
-		while (!_done || _queue.size())
+		for (;;)
 		{
-			DebugLog(_str_0_unlock_.c_str());
-			_queueSemaphore.signal(); // First iteration: Signal that we are actually waiting on the queue, essentially priming it,
-			// consumers to start adding items.
-			// Subsequent iterations: Release the check we are doing on the queue.
-			DebugLog(_str_1_wait_work_.c_str());
-			_workSemaphore.wait(); // Wait for work to arrive
-			DebugLog(_str_2_queuelock_.c_str());
-			_queueSemaphore.wait(); // Work has arrived! Or has it? Lock the queue, as we need to check that it is not empty,
-			DebugLog(_str_3_queueLocked_.c_str());
-			// and to unqueue items.
-			if (!_queue.size()) // Are we done? Was this a signal for work or for us to finish?
-			{
-				DebugLog(_str_4_exit_signal_.c_str());
-				// Someone signalled the queue without putting items in. This means we are finished.
-				assertion(_done); // duh?
-				break;
-			}
-			else // Yay! Work to do!
+			FutureType future;
 			{
-				DebugLog(_str_5_obtaining_work_.c_str());
-
-				FutureType future = std::move(_queue.front()); // Get work.
+				std::lock_guard<std::mutex> lock(_queueMutex);
+				if (_queue.empty())
+				{
+					--_numDrainJobs;
+					return;
+				}
+				future = std::move(_queue.front());
 				_queue.pop_front();
-				DebugLog(_str_6_obtained_work_.c_str());
-				_queueSemaphore.signal(); // Release the krak... QUEUE.
-				DebugLog(_str_7_executing_work_.c_str());
-				worker(future); // Load a texture! Yay!
-				DebugLog(_str_8_execution_done_.c_str());
 			}
-			_queueSemaphore.wait(); // Continue. Lock the queue to check it out.
-			DebugLog(_str_9_looping_up_.c_str());
+			worker(future);
 		}
-		_queueSemaphore.signal(); // Finish. Release the queue.
-		Log(LogLevel::Information, "%s: Asynchronous asset loader closing down. Freeing workers.", _myInfo.c_str());
 	}
 };
 } // namespace async
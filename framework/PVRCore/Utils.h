@@ -10,6 +10,7 @@
 #include <array>
 #include <cassert>
 #include <cstring>
+#include "PVRCore/Simd.h"
 #ifndef PVRCORE_NO_GLM
 #include "glm.h"
 #endif
@@ -114,6 +115,117 @@ inline void memCopyToVolatile(volatile T1& dst, const T2& src)
 	memcpy(&const_cast<T1&>(dst), &src, sizeof(T1));
 }
 
+/// <summary>Check the endianness of the platform.</summary>
+/// <returns>True if the platform is little endian, otherwise false</returns>
+inline bool isLittleEndian()
+{
+	const uint16_t word = 0x0001;
+	uint8_t firstByte;
+	memcpy(&firstByte, &word, 1);
+	return firstByte != 0;
+}
+
+/// <summary>Reverse the byte order of an array of 16 bit values in place. Uses SSE2 or NEON to swap 16 bytes at a time
+/// where available.</summary>
+/// <param name="data">Pointer to the values. Does not need to be aligned.</param>
+/// <param name="count">The number of 16 bit values</param>
+inline void swapBytes16(void* data, size_t count)
+{
+	uint8_t* bytes = static_cast<uint8_t*>(data);
+	size_t i = 0;
+#if defined(PVR_SIMD_SSE)
+	for (; i + 8 <= count; i += 8, bytes += 16)
+	{
+		__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+		value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), value);
+	}
+#elif defined(PVR_SIMD_NEON)
+	for (; i + 8 <= count; i += 8, bytes += 16) { vst1q_u8(bytes, vrev16q_u8(vld1q_u8(bytes))); }
+#endif
+	for (; i < count; ++i, bytes += 2)
+	{
+		uint16_t value;
+		memcpy(&value, bytes, 2);
+		value = static_cast<uint16_t>((value >> 8) | (value << 8));
+		memcpy(bytes, &value, 2);
+	}
+}
+
+/// <summary>Reverse the byte order of an array of 32 bit values in place. Uses SSE2 or NEON to swap 16 bytes at a time
+/// where available.</summary>
+/// <param name="data">Pointer to the values. Does not need to be aligned.</param>
+/// <param name="count">The number of 32 bit values</param>
+inline void swapBytes32(void* data, size_t count)
+{
+	uint8_t* bytes = static_cast<uint8_t*>(data);
+	size_t i = 0;
+#if defined(PVR_SIMD_SSE)
+	for (; i + 4 <= count; i += 4, bytes += 16)
+	{
+		__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+		// Swap the bytes of each 16 bit half, then swap the two halves of each 32 bit value.
+		value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+		value = _mm_or_si128(_mm_slli_epi32(value, 16), _mm_srli_epi32(value, 16));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), value);
+	}
+#elif defined(PVR_SIMD_NEON)
+	for (; i + 4 <= count; i += 4, bytes += 16) { vst1q_u8(bytes, vrev32q_u8(vld1q_u8(bytes))); }
+#endif
+	for (; i < count; ++i, bytes += 4)
+	{
+		uint32_t value;
+		memcpy(&value, bytes, 4);
+		value = (value >> 24) | ((value >> 8) & 0x0000FF00u) | ((value << 8) & 0x00FF0000u) | (value << 24);
+		memcpy(bytes, &value, 4);
+	}
+}
+
+/// <summary>Reverse the byte order of a strided array of elements (for example one attribute of interleaved
+/// vertex data) in place.</summary>
+/// <param name="data">Pointer to the first element</param>
+/// <param name="componentSize">The size of each component, in bytes. Must be 1, 2 or 4. Nothing is done for 1.</param>
+/// <param name="numComponents">The number of components in each element (e.g. 3 for a vec3)</param>
+/// <param name="numElements">The number of elements</param>
+/// <param name="stride">The distance, in bytes, between the start of consecutive elements</param>
+inline void swapBytesStrided(void* data, size_t componentSize, size_t numComponents, size_t numElements, size_t stride)
+{
+	uint8_t* element = static_cast<uint8_t*>(data);
+	// Tightly packed data is swapped as one big array.
+	if (stride == componentSize * numComponents)
+	{
+		numComponents *= numElements;
+		numElements = 1;
+	}
+	for (size_t i = 0; i < numElements; ++i, element += stride)
+	{
+		switch (componentSize)
+		{
+		case 2: swapBytes16(element, numComponents); break;
+		case 4: swapBytes32(element, numComponents); break;
+		default: break;
+		}
+	}
+}
+
+/// <summary>Convert an array of little endian 16 bit values to the byte order of the platform, in place. Does nothing
+/// on little endian platforms.</summary>
+/// <param name="data">Pointer to the values</param>
+/// <param name="count">The number of 16 bit values</param>
+inline void littleEndianToHost16(void* data, size_t count)
+{
+	if (!isLittleEndian()) { swapBytes16(data, count); }
+}
+
+/// <summary>Convert an array of little endian 32 bit values to the byte order of the platform, in place. Does nothing
+/// on little endian platforms.</summary>
+/// <param name="data">Pointer to the values</param>
+/// <param name="count">The number of 32 bit values</param>
+inline void littleEndianToHost32(void* data, size_t count)
+{
+	if (!isLittleEndian()) { swapBytes32(data, count); }
+}
+
 #ifndef PVRCORE_NO_GLM
 
 /// <summary>Convert the linear rgb color values in to srgb color space.</summary>
@@ -0,0 +1,731 @@
+/*!
+\brief Implementation of the compiled (binary) PFX effect format.
+\file PVRCore/pfx/PFXCache.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRCore/pfx/PFXCache.h"
+#include "PVRCore/stream/FileStream.h"
+#include "PVRCore/strings/CompileTimeHash.h"
+#include "PVRCore/Log.h"
+#include <cstring>
+#include <unordered_map>
+
+namespace pvr {
+namespace pfx {
+namespace {
+const uint32_t c_pfxCacheMagic = 0x58465650; // "PVFX"
+
+// Fixed size header at the very start of the compiled effect.
+struct PfxCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceHash;
+	uint64_t payloadSize;
+};
+
+class CacheWriter
+{
+public:
+	template<typename T>
+	void write(const T& value)
+	{
+		append(&value, sizeof(T));
+	}
+
+	template<typename Enum_>
+	void writeEnum(Enum_ value)
+	{
+		write(static_cast<uint32_t>(value));
+	}
+
+	void writeString(const std::string& str)
+	{
+		write(static_cast<uint32_t>(str.size()));
+		append(str.data(), str.size());
+	}
+
+	void writeBytes(const std::vector<uint8_t>& bytes) { append(bytes.data(), bytes.size()); }
+
+	const std::vector<uint8_t>& getData() const { return _data; }
+
+private:
+	void append(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		_data.insert(_data.end(), bytes, bytes + size);
+	}
+
+	std::vector<uint8_t> _data;
+};
+
+// Writes the body of the effect, replacing every string by its index in a table of unique strings.
+class EffectWriter : public CacheWriter
+{
+public:
+	void writeId(const std::string& str)
+	{
+		auto it = _stringIds.find(str);
+		if (it == _stringIds.end())
+		{
+			it = _stringIds.emplace(str, static_cast<uint32_t>(_strings.size())).first;
+			_strings.emplace_back(&it->first);
+		}
+		write(it->second);
+	}
+
+	void writeStringTable(CacheWriter& writer) const
+	{
+		writer.write(static_cast<uint32_t>(_strings.size()));
+		for (const std::string* str : _strings) { writer.writeString(*str); }
+	}
+
+private:
+	std::unordered_map<std::string, uint32_t> _stringIds;
+	std::vector<const std::string*> _strings;
+};
+
+class CacheReader
+{
+public:
+	CacheReader(const uint8_t* begin, size_t size) : _current(begin), _end(begin + size) {}
+
+	template<typename T>
+	T read()
+	{
+		T value;
+		memcpy(&value, advance(sizeof(T)), sizeof(T));
+		return value;
+	}
+
+	template<typename Enum_>
+	Enum_ readEnum()
+	{
+		return static_cast<Enum_>(read<uint32_t>());
+	}
+
+	std::string readString()
+	{
+		uint32_t size = read<uint32_t>();
+		const char* chars = reinterpret_cast<const char*>(advance(size));
+		return std::string(chars, size);
+	}
+
+	bool isAtEnd() const { return _current == _end; }
+
+private:
+	const uint8_t* advance(size_t size)
+	{
+		if (static_cast<size_t>(_end - _current) < size) { throw InvalidDataError("[PfxCache]: Attempted to read past the end of the compiled effect"); }
+		const uint8_t* retval = _current;
+		_current += size;
+		return retval;
+	}
+
+	const uint8_t* _current;
+	const uint8_t* _end;
+};
+
+// Reads the body of the effect. Each unique string is hashed once, when it is first referenced, and then copied.
+class EffectReader : public CacheReader
+{
+public:
+	EffectReader(const uint8_t* begin, size_t size) : CacheReader(begin, size) {}
+
+	void readStringTable()
+	{
+		uint32_t numStrings = read<uint32_t>();
+		_strings.resize(numStrings);
+		_hashes.resize(numStrings);
+		_isHashed.assign(numStrings, false);
+		for (uint32_t i = 0; i < numStrings; ++i) { _strings[i] = readString(); }
+	}
+
+	const std::string& readIdString() { return _strings[readIndex()]; }
+
+	const StringHash& readId()
+	{
+		uint32_t index = readIndex();
+		if (!_isHashed[index])
+		{
+			_hashes[index] = StringHash(_strings[index]);
+			_isHashed[index] = true;
+		}
+		return _hashes[index];
+	}
+
+private:
+	uint32_t readIndex()
+	{
+		uint32_t index = read<uint32_t>();
+		if (index >= _strings.size()) { throw InvalidDataError("[PfxCache]: String index out of range"); }
+		return index;
+	}
+
+	std::vector<std::string> _strings;
+	std::vector<StringHash> _hashes;
+	std::vector<bool> _isHashed;
+};
+
+std::unique_ptr<Stream> openDependency(const std::string& filename, const IAssetProvider* assetProvider)
+{
+	if (assetProvider) { return assetProvider->getAssetStream(filename, false); }
+	return FileStream::createFileStream(filename, "rb", false);
+}
+
+bool hashDependency(const std::string& filename, const IAssetProvider* assetProvider, uint64_t& outHash)
+{
+	std::unique_ptr<Stream> stream = openDependency(filename, assetProvider);
+	if (!stream || !stream->isReadable()) { return false; }
+	std::vector<uint8_t> contents = stream->readToEnd<uint8_t>();
+	outHash = hash64_bytes(contents.data(), contents.size());
+	return true;
+}
+
+//////////////////////////////////////////////// WRITING ////////////////////////////////////////////////
+void writeStencilState(EffectWriter& writer, const StencilState& state)
+{
+	writer.writeEnum(state.opDepthPass);
+	writer.writeEnum(state.opDepthFail);
+	writer.writeEnum(state.opStencilFail);
+	writer.write(state.compareMask);
+	writer.write(state.writeMask);
+	writer.write(state.reference);
+	writer.writeEnum(state.compareOp);
+}
+
+void writeShaderReference(EffectWriter& writer, const effect::Effect& effect, effect::ShaderReference shader)
+{
+	// Pipelines point straight into the shader maps of the effect, so find which api version the shader belongs to.
+	for (auto& api : effect.versionedShaders)
+	{
+		auto it = api.second.find(shader->name);
+		if (it != api.second.end() && &it->second == shader)
+		{
+			writer.writeId(api.first);
+			writer.writeId(shader->name);
+			return;
+		}
+	}
+	throw InvalidArgumentError("effect", "[PfxCache]: Pipeline references a shader that does not belong to the effect");
+}
+
+void writePipeline(EffectWriter& writer, const effect::Effect& effect, const effect::PipelineDefinition& pipeline)
+{
+	writer.writeId(pipeline.name);
+
+	writer.write(static_cast<uint32_t>(pipeline.shaders.size()));
+	for (effect::ShaderReference shader : pipeline.shaders) { writeShaderReference(writer, effect, shader); }
+
+	writer.write(static_cast<uint32_t>(pipeline.uniforms.size()));
+	for (auto& uniform : pipeline.uniforms)
+	{
+		writer.write(uniform.set);
+		writer.write(uniform.binding);
+		writer.writeId(uniform.semantic);
+		writer.writeId(uniform.variableName);
+		writer.writeEnum(uniform.dataType);
+		writer.write(uniform.arrayElements);
+		writer.writeEnum(uniform.scope);
+	}
+
+	writer.write(static_cast<uint32_t>(pipeline.attributes.size()));
+	for (auto& attribute : pipeline.attributes)
+	{
+		writer.writeId(attribute.semantic);
+		writer.writeId(attribute.variableName);
+		writer.writeEnum(attribute.dataType);
+		writer.write(attribute.location);
+		writer.write(attribute.vboBinding);
+	}
+
+	writer.write(static_cast<uint32_t>(pipeline.textures.size()));
+	for (auto& texture : pipeline.textures)
+	{
+		writer.writeId(texture.textureName);
+		writer.write(texture.set);
+		writer.write(texture.binding);
+		writer.writeId(texture.variableName);
+		writer.write(static_cast<int8_t>(texture.samplerFilter));
+		writer.writeEnum(texture.wrapS);
+		writer.writeEnum(texture.wrapT);
+		writer.writeEnum(texture.wrapR);
+		writer.writeId(texture.semantic);
+	}
+
+	writer.write(static_cast<uint32_t>(pipeline.buffers.size()));
+	for (auto& buffer : pipeline.buffers)
+	{
+		writer.write(buffer.set);
+		writer.write(buffer.binding);
+		writer.writeId(buffer.semantic);
+		writer.writeId(buffer.bufferName);
+		writer.writeEnum(buffer.type);
+	}
+
+	writer.write(static_cast<uint8_t>(pipeline.blending.blendEnable));
+	writer.writeEnum(pipeline.blending.srcBlendColor);
+	writer.writeEnum(pipeline.blending.dstBlendColor);
+	writer.writeEnum(pipeline.blending.blendOpColor);
+	writer.writeEnum(pipeline.blending.srcBlendAlpha);
+	writer.writeEnum(pipeline.blending.dstBlendAlpha);
+	writer.writeEnum(pipeline.blending.blendOpAlpha);
+	writer.writeEnum(pipeline.blending.channelWriteMask);
+
+	writer.write(static_cast<uint32_t>(pipeline.inputAttachments.size()));
+	for (auto& inputAttachment : pipeline.inputAttachments)
+	{
+		writer.write(inputAttachment.set);
+		writer.write(inputAttachment.binding);
+		writer.write(inputAttachment.targetIndex);
+	}
+
+	writer.write(static_cast<uint32_t>(pipeline.vertexBinding.size()));
+	for (auto& binding : pipeline.vertexBinding)
+	{
+		writer.write(binding.index);
+		writer.writeEnum(binding.stepRate);
+	}
+
+	writer.write(static_cast<uint8_t>(pipeline.enableDepthTest));
+	writer.write(static_cast<uint8_t>(pipeline.enableDepthWrite));
+	writer.writeEnum(pipeline.depthCmpFunc);
+	writer.write(static_cast<uint8_t>(pipeline.enableStencilTest));
+	writeStencilState(writer, pipeline.stencilFront);
+	writeStencilState(writer, pipeline.stencilBack);
+	writer.writeEnum(pipeline.windingOrder);
+	writer.writeEnum(pipeline.cullFace);
+}
+
+void writePass(EffectWriter& writer, const effect::Pass& pass)
+{
+	writer.writeId(pass.name);
+	writer.writeId(pass.targetDepthStencil);
+	writer.write(static_cast<uint32_t>(pass.subpasses.size()));
+	for (auto& subpass : pass.subpasses)
+	{
+		for (auto& target : subpass.targets) { writer.writeId(target); }
+		for (auto& input : subpass.inputs) { writer.writeId(input); }
+		writer.write(static_cast<uint8_t>(subpass.useDepthStencil));
+
+		writer.write(static_cast<uint32_t>(subpass.groups.size()));
+		for (auto& group : subpass.groups)
+		{
+			writer.writeId(group.name);
+			writer.write(static_cast<uint32_t>(group.pipelines.size()));
+			for (auto& pipeline : group.pipelines)
+			{
+				writer.writeId(pipeline.pipelineName);
+				writer.write(static_cast<uint32_t>(pipeline.conditions.size()));
+				for (auto& condition : pipeline.conditions)
+				{
+					writer.writeEnum(condition.type);
+					writer.writeId(condition.value);
+				}
+				writer.write(static_cast<uint32_t>(pipeline.identifiers.size()));
+				for (auto& identifier : pipeline.identifiers) { writer.writeId(identifier); }
+			}
+		}
+	}
+}
+
+void writeEffect(EffectWriter& writer, const effect::Effect& effect)
+{
+	writer.writeId(effect.name);
+
+	writer.write(static_cast<uint32_t>(effect.headerAttributes.size()));
+	for (auto& attribute : effect.headerAttributes)
+	{
+		writer.writeId(attribute.first);
+		writer.writeId(attribute.second);
+	}
+
+	// Shader sources that were not api specific are duplicated into every api version. The string table stores them once.
+	writer.write(static_cast<uint32_t>(effect.versionedShaders.size()));
+	for (auto& api : effect.versionedShaders)
+	{
+		writer.writeId(api.first);
+		writer.write(static_cast<uint32_t>(api.second.size()));
+		for (auto& shader : api.second)
+		{
+			writer.writeId(shader.second.name);
+			writer.writeEnum(shader.second.type);
+			writer.writeId(shader.second.source);
+		}
+	}
+
+	writer.write(static_cast<uint32_t>(effect.textures.size()));
+	for (auto& texture : effect.textures)
+	{
+		writer.writeId(texture.second.name);
+		writer.writeId(texture.second.path);
+		writer.write(texture.second.width);
+		writer.write(texture.second.height);
+		writer.write(texture.second.format.format.getPixelTypeId());
+		writer.writeEnum(texture.second.format.dataType);
+		writer.writeEnum(texture.second.format.colorSpace);
+	}
+
+	writer.write(static_cast<uint32_t>(effect.buffers.size()));
+	for (auto& buffer : effect.buffers)
+	{
+		writer.writeId(buffer.second.name);
+		writer.writeEnum(buffer.second.allSupportedBindings);
+		writer.write(static_cast<uint8_t>(buffer.second.isDynamic));
+		writer.writeEnum(buffer.second.scope);
+		writer.write(static_cast<uint8_t>(buffer.second.multibuffering));
+		writer.write(static_cast<uint32_t>(buffer.second.entries.size()));
+		for (auto& entry : buffer.second.entries)
+		{
+			writer.writeId(entry.semantic);
+			writer.writeEnum(entry.dataType);
+			writer.write(entry.arrayElements);
+		}
+	}
+
+	// Written after the shaders, so that the shader references can be resolved while reading.
+	writer.write(static_cast<uint32_t>(effect.versionedPipelines.size()));
+	for (auto& api : effect.versionedPipelines)
+	{
+		writer.writeId(api.first);
+		writer.write(static_cast<uint32_t>(api.second.size()));
+		for (auto& pipeline : api.second) { writePipeline(writer, effect, pipeline.second); }
+	}
+
+	writer.write(static_cast<uint32_t>(effect.passes.size()));
+	for (auto& pass : effect.passes) { writePass(writer, pass); }
+}
+
+//////////////////////////////////////////////// READING ////////////////////////////////////////////////
+void readStencilState(EffectReader& reader, StencilState& state)
+{
+	state.opDepthPass = reader.readEnum<StencilOp>();
+	state.opDepthFail = reader.readEnum<StencilOp>();
+	state.opStencilFail = reader.readEnum<StencilOp>();
+	state.compareMask = reader.read<uint32_t>();
+	state.writeMask = reader.read<uint32_t>();
+	state.reference = reader.read<uint32_t>();
+	state.compareOp = reader.readEnum<CompareOp>();
+}
+
+void readPipeline(EffectReader& reader, effect::Effect& effect, effect::PipelineDefinition& pipeline)
+{
+	pipeline.name = reader.readId();
+
+	pipeline.shaders.resize(reader.read<uint32_t>());
+	for (auto& shader : pipeline.shaders)
+	{
+		const StringHash& api = reader.readId();
+		const StringHash& name = reader.readId();
+		auto apiShaders = effect.versionedShaders.find(api);
+		if (apiShaders == effect.versionedShaders.end()) { throw InvalidDataError("[PfxCache]: Pipeline references a shader of an unknown api version"); }
+		auto it = apiShaders->second.find(name);
+		if (it == apiShaders->second.end()) { throw InvalidDataError("[PfxCache]: Pipeline references an unknown shader"); }
+		shader = &it->second;
+	}
+
+	pipeline.uniforms.resize(reader.read<uint32_t>());
+	for (auto& uniform : pipeline.uniforms)
+	{
+		uniform.set = reader.read<int8_t>();
+		uniform.binding = reader.read<int8_t>();
+		uniform.semantic = reader.readId();
+		uniform.variableName = reader.readId();
+		uniform.dataType = reader.readEnum<GpuDatatypes>();
+		uniform.arrayElements = reader.read<uint32_t>();
+		uniform.scope = reader.readEnum<VariableScope>();
+	}
+
+	pipeline.attributes.resize(reader.read<uint32_t>());
+	for (auto& attribute : pipeline.attributes)
+	{
+		attribute.semantic = reader.readId();
+		attribute.variableName = reader.readId();
+		attribute.dataType = reader.readEnum<GpuDatatypes>();
+		attribute.location = reader.read<uint8_t>();
+		attribute.vboBinding = reader.read<uint8_t>();
+	}
+
+	pipeline.textures.resize(reader.read<uint32_t>());
+	for (auto& texture : pipeline.textures)
+	{
+		texture.textureName = reader.readId();
+		texture.set = reader.read<uint8_t>();
+		texture.binding = reader.read<uint8_t>();
+		texture.variableName = reader.readId();
+		texture.samplerFilter = static_cast<PackedSamplerFilter>(reader.read<int8_t>());
+		texture.wrapS = reader.readEnum<SamplerAddressMode>();
+		texture.wrapT = reader.readEnum<SamplerAddressMode>();
+		texture.wrapR = reader.readEnum<SamplerAddressMode>();
+		texture.semantic = reader.readId();
+	}
+
+	pipeline.buffers.resize(reader.read<uint32_t>());
+	for (auto& buffer : pipeline.buffers)
+	{
+		buffer.set = reader.read<int8_t>();
+		buffer.binding = reader.read<int8_t>();
+		buffer.semantic = reader.readId();
+		buffer.bufferName = reader.readId();
+		buffer.type = reader.readEnum<DescriptorType>();
+	}
+
+	pipeline.blending.blendEnable = reader.read<uint8_t>() != 0;
+	pipeline.blending.srcBlendColor = reader.readEnum<BlendFactor>();
+	pipeline.blending.dstBlendColor = reader.readEnum<BlendFactor>();
+	pipeline.blending.blendOpColor = reader.readEnum<BlendOp>();
+	pipeline.blending.srcBlendAlpha = reader.readEnum<BlendFactor>();
+	pipeline.blending.dstBlendAlpha = reader.readEnum<BlendFactor>();
+	pipeline.blending.blendOpAlpha = reader.readEnum<BlendOp>();
+	pipeline.blending.channelWriteMask = reader.readEnum<ColorChannelFlags>();
+
+	pipeline.inputAttachments.resize(reader.read<uint32_t>());
+	for (auto& inputAttachment : pipeline.inputAttachments)
+	{
+		inputAttachment.set = reader.read<int8_t>();
+		inputAttachment.binding = reader.read<int8_t>();
+		inputAttachment.targetIndex = reader.read<int8_t>();
+	}
+
+	pipeline.vertexBinding.resize(reader.read<uint32_t>());
+	for (auto& binding : pipeline.vertexBinding)
+	{
+		binding.index = reader.read<uint32_t>();
+		binding.stepRate = reader.readEnum<StepRate>();
+	}
+
+	pipeline.enableDepthTest = reader.read<uint8_t>() != 0;
+	pipeline.enableDepthWrite = reader.read<uint8_t>() != 0;
+	pipeline.depthCmpFunc = reader.readEnum<CompareOp>();
+	pipeline.enableStencilTest = reader.read<uint8_t>() != 0;
+	readStencilState(reader, pipeline.stencilFront);
+	readStencilState(reader, pipeline.stencilBack);
+	pipeline.windingOrder = reader.readEnum<PolygonWindingOrder>();
+	pipeline.cullFace = reader.readEnum<Face>();
+}
+
+void readPass(EffectReader& reader, effect::Pass& pass)
+{
+	pass.name = reader.readId();
+	pass.targetDepthStencil = reader.readId();
+	pass.subpasses.resize(reader.read<uint32_t>());
+	for (auto& subpass : pass.subpasses)
+	{
+		for (auto& target : subpass.targets) { target = reader.readId(); }
+		for (auto& input : subpass.inputs) { input = reader.readId(); }
+		subpass.useDepthStencil = reader.read<uint8_t>() != 0;
+
+		subpass.groups.resize(reader.read<uint32_t>());
+		for (auto& group : subpass.groups)
+		{
+			group.name = reader.readId();
+			group.pipelines.resize(reader.read<uint32_t>());
+			for (auto& pipeline : group.pipelines)
+			{
+				pipeline.pipelineName = reader.readId();
+				pipeline.conditions.resize(reader.read<uint32_t>());
+				for (auto& condition : pipeline.conditions)
+				{
+					condition.type = reader.readEnum<effect::PipelineCondition::ConditionType>();
+					condition.value = reader.readId();
+				}
+				pipeline.identifiers.resize(reader.read<uint32_t>());
+				for (auto& identifier : pipeline.identifiers) { identifier = reader.readId(); }
+			}
+		}
+	}
+}
+
+// The maps were written in order, so every element is inserted at the end, without searching the map.
+void readEffect(EffectReader& reader, effect::Effect& effect)
+{
+	effect.name = reader.readId();
+
+	for (uint32_t numAttributes = reader.read<uint32_t>(); numAttributes > 0; --numAttributes)
+	{
+		const StringHash& key = reader.readId();
+		effect.headerAttributes.emplace_hint(effect.headerAttributes.end(), key, reader.readIdString());
+	}
+
+	for (uint32_t numApis = reader.read<uint32_t>(); numApis > 0; --numApis)
+	{
+		auto& shaders = effect.versionedShaders.emplace_hint(effect.versionedShaders.end(), reader.readId(), std::map<StringHash, effect::Shader>())->second;
+		for (uint32_t numShaders = reader.read<uint32_t>(); numShaders > 0; --numShaders)
+		{
+			effect::Shader shader;
+			shader.name = reader.readId();
+			shader.type = reader.readEnum<ShaderType>();
+			shader.source = reader.readIdString();
+			shaders.emplace_hint(shaders.end(), shader.name, std::move(shader));
+		}
+	}
+
+	for (uint32_t numTextures = reader.read<uint32_t>(); numTextures > 0; --numTextures)
+	{
+		effect::TextureDefinition texture;
+		texture.name = reader.readId();
+		texture.path = reader.readId();
+		texture.width = reader.read<uint32_t>();
+		texture.height = reader.read<uint32_t>();
+		texture.format.format = PixelFormat(reader.read<uint64_t>());
+		texture.format.dataType = reader.readEnum<VariableType>();
+		texture.format.colorSpace = reader.readEnum<ColorSpace>();
+		effect.textures.emplace_hint(effect.textures.end(), texture.name, std::move(texture));
+	}
+
+	for (uint32_t numBuffers = reader.read<uint32_t>(); numBuffers > 0; --numBuffers)
+	{
+		effect::BufferDefinition buffer;
+		buffer.name = reader.readId();
+		buffer.allSupportedBindings = reader.readEnum<BufferUsageFlags>();
+		buffer.isDynamic = reader.read<uint8_t>() != 0;
+		buffer.scope = reader.readEnum<VariableScope>();
+		buffer.multibuffering = reader.read<uint8_t>() != 0;
+		buffer.entries.resize(reader.read<uint32_t>());
+		for (auto& entry : buffer.entries)
+		{
+			entry.semantic = reader.readId();
+			entry.dataType = reader.readEnum<GpuDatatypes>();
+			entry.arrayElements = reader.read<uint32_t>();
+		}
+		effect.buffers.emplace_hint(effect.buffers.end(), buffer.name, std::move(buffer));
+	}
+
+	for (uint32_t numApis = reader.read<uint32_t>(); numApis > 0; --numApis)
+	{
+		auto& pipelines = effect.versionedPipelines.emplace_hint(effect.versionedPipelines.end(), reader.readId(), std::map<StringHash, effect::PipelineDefinition>())->second;
+		for (uint32_t numPipelines = reader.read<uint32_t>(); numPipelines > 0; --numPipelines)
+		{
+			effect::PipelineDefinition pipeline;
+			readPipeline(reader, effect, pipeline);
+			pipelines.emplace_hint(pipelines.end(), pipeline.name, std::move(pipeline));
+		}
+	}
+
+	effect.passes.resize(reader.read<uint32_t>());
+	for (auto& pass : effect.passes) { readPass(reader, pass); }
+	effect.versions.clear();
+}
+
+bool readHeader(const void* data, size_t size, PfxCacheHeader& outHeader)
+{
+	if (!data || size < sizeof(PfxCacheHeader)) { return false; }
+	memcpy(&outHeader, data, sizeof(outHeader));
+	return outHeader.magic == c_pfxCacheMagic && outHeader.version == PfxCacheVersion && outHeader.payloadSize <= size - sizeof(outHeader);
+}
+
+bool checkDependencies(CacheReader& reader, const IAssetProvider* assetProvider)
+{
+	for (uint32_t numDependencies = reader.read<uint32_t>(); numDependencies > 0; --numDependencies)
+	{
+		std::string filename = reader.readString();
+		uint64_t expectedHash = reader.read<uint64_t>();
+		uint64_t hash;
+		if (!hashDependency(filename, assetProvider, hash) || hash != expectedHash)
+		{
+			Log(LogLevel::Information, "PfxCache: Compiled effect is stale, as [%s] has changed", filename.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+void skipDependencies(CacheReader& reader)
+{
+	for (uint32_t numDependencies = reader.read<uint32_t>(); numDependencies > 0; --numDependencies)
+	{
+		reader.readString();
+		reader.read<uint64_t>();
+	}
+}
+
+EffectReader createPayloadReader(const void* data, const PfxCacheHeader& header)
+{
+	return EffectReader(static_cast<const uint8_t*>(data) + sizeof(header), static_cast<size_t>(header.payloadSize));
+}
+} // namespace
+
+uint64_t computePfxSourceHash(const void* sourceData, size_t sourceSize)
+{
+	uint64_t hash = hash64_bytes(&PfxCacheVersion, sizeof(PfxCacheVersion));
+	return hash64_bytes(sourceData, sourceSize, hash);
+}
+
+void writePFXCache(const effect::Effect& effect, uint64_t sourceHash, const std::vector<std::string>& dependencies, const IAssetProvider* assetProvider, Stream& stream)
+{
+	EffectWriter body;
+	writeEffect(body, effect);
+
+	// Payload: the dependencies, then the string table, then the body that references it.
+	CacheWriter payload;
+	std::vector<std::pair<const std::string*, uint64_t>> hashedDependencies;
+	for (auto& dependency : dependencies)
+	{
+		uint64_t hash;
+		if (hashDependency(dependency, assetProvider, hash)) { hashedDependencies.emplace_back(&dependency, hash); }
+		else
+		{
+			Log(LogLevel::Warning, "PfxCache: Could not open dependency [%s]. Changes to it will not invalidate the compiled effect.", dependency.c_str());
+		}
+	}
+	payload.write(static_cast<uint32_t>(hashedDependencies.size()));
+	for (auto& dependency : hashedDependencies)
+	{
+		payload.writeString(*dependency.first);
+		payload.write(dependency.second);
+	}
+	body.writeStringTable(payload);
+	payload.writeBytes(body.getData());
+
+	PfxCacheHeader header = {};
+	header.magic = c_pfxCacheMagic;
+	header.version = PfxCacheVersion;
+	header.sourceHash = sourceHash;
+	header.payloadSize = payload.getData().size();
+	stream.writeExact(sizeof(header), 1, &header);
+	stream.writeExact(1, payload.getData().size(), payload.getData().data());
+}
+
+bool isPFXCache(const void* data, size_t size)
+{
+	PfxCacheHeader header;
+	return readHeader(data, size, header);
+}
+
+bool readPFXCache(const void* data, size_t size, uint64_t sourceHash, const IAssetProvider* assetProvider, effect::Effect& outEffect)
+{
+	PfxCacheHeader header;
+	if (!readHeader(data, size, header) || header.sourceHash != sourceHash) { return false; }
+
+	EffectReader reader = createPayloadReader(data, header);
+	try
+	{
+		if (!checkDependencies(reader, assetProvider)) { return false; }
+		reader.readStringTable();
+		readEffect(reader, outEffect);
+		if (!reader.isAtEnd()) { throw InvalidDataError("[PfxCache]: Unexpected data after the end of the effect"); }
+	}
+	catch (const InvalidDataError& e)
+	{
+		Log(LogLevel::Warning, "Discarding corrupted compiled effect: %s", e.what());
+		outEffect.clear();
+		return false;
+	}
+	return true;
+}
+
+void readPFXCache(const void* data, size_t size, effect::Effect& outEffect)
+{
+	PfxCacheHeader header;
+	if (!readHeader(data, size, header)) { throw InvalidDataError("[PfxCache]: Not a compiled effect, or compiled with a different version of the format"); }
+
+	EffectReader reader = createPayloadReader(data, header);
+	skipDependencies(reader);
+	reader.readStringTable();
+	readEffect(reader, outEffect);
+}
+} // namespace pfx
+} // namespace pvr
+//!\endcond
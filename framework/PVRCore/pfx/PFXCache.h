@@ -0,0 +1,63 @@
+/*!
+\brief Functions to write and read compiled PFX effects, a compact binary representation of a fully resolved pvr::effect::Effect.
+\file PVRCore/pfx/PFXCache.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/IAssetProvider.h"
+#include "PVRCore/pfx/Effect.h"
+
+namespace pvr {
+namespace pfx {
+
+/// <summary>The current version of the compiled effect format. Compiled effects written with a different version are rejected.</summary>
+static const uint32_t PfxCacheVersion = 1;
+
+/// <summary>The file extension used for compiled effects created by readPFX.</summary>
+static const char* const PfxCacheExtension = ".pfxc";
+
+/// <summary>Compute the content hash used to validate a compiled effect against its source PFX file.</summary>
+/// <param name="sourceData">Pointer to the complete contents of the PFX file</param>
+/// <param name="sourceSize">The size, in bytes, of the source data</param>
+/// <returns>A 64 bit hash of the source data combined with the compiled effect format version.</returns>
+uint64_t computePfxSourceHash(const void* sourceData, size_t sourceSize);
+
+/// <summary>Serialize a fully resolved Effect into a compiled effect. Every string of the effect (names, semantics,
+/// api versions...) is stored once in a string table and referenced by index, enumerations are stored by value, and
+/// the shader references of the pipelines are stored as (api, shader) pairs.</summary>
+/// <param name="effect">The effect to serialize</param>
+/// <param name="sourceHash">The hash of the PFX the effect was read from (see computePfxSourceHash). It is stored in
+/// the header and checked when the compiled effect is read back. Use 0 for effects compiled offline.</param>
+/// <param name="dependencies">The files (normally the shader sources) that were pulled in while reading the PFX. Their
+/// names and content hashes are stored, so that editing a shader invalidates the compiled effect. May be empty.</param>
+/// <param name="assetProvider">The asset provider used to open the dependencies. If null, they are opened as files.</param>
+/// <param name="stream">A writable stream to write the compiled effect to</param>
+void writePFXCache(const effect::Effect& effect, uint64_t sourceHash, const std::vector<std::string>& dependencies, const IAssetProvider* assetProvider, Stream& stream);
+
+/// <summary>Check if a block of memory starts with a valid compiled effect header.</summary>
+/// <param name="data">Pointer to the start of the data</param>
+/// <param name="size">The size of the data in bytes</param>
+/// <returns>True if the data looks like a compiled effect of the current version</returns>
+bool isPFXCache(const void* data, size_t size);
+
+/// <summary>Rebuild an Effect from a compiled effect residing in memory, after validating it against its source.</summary>
+/// <param name="data">Pointer to the start of the compiled effect</param>
+/// <param name="size">The size of the compiled effect in bytes</param>
+/// <param name="sourceHash">The expected hash of the source PFX. If the hash stored in the compiled effect does not
+/// match, the compiled effect is considered stale.</param>
+/// <param name="assetProvider">The asset provider used to re-hash the recorded dependencies. If null, they are opened as files.</param>
+/// <param name="outEffect">The effect to populate. It is left empty if the compiled effect is rejected.</param>
+/// <returns>True if the compiled effect was valid and up to date and the effect was populated, false if it was
+/// stale, truncated, or written by a different version of the format.</returns>
+bool readPFXCache(const void* data, size_t size, uint64_t sourceHash, const IAssetProvider* assetProvider, effect::Effect& outEffect);
+
+/// <summary>Rebuild an Effect from a compiled effect residing in memory, without validating it against any source.
+/// Used to load effects that were compiled offline and are shipped instead of their PFX.</summary>
+/// <param name="data">Pointer to the start of the compiled effect</param>
+/// <param name="size">The size of the compiled effect in bytes</param>
+/// <param name="outEffect">The effect to populate</param>
+void readPFXCache(const void* data, size_t size, effect::Effect& outEffect);
+
+} // namespace pfx
+} // namespace pvr
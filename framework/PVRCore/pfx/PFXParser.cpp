@@ -7,9 +7,14 @@
 
 //!\cond NO_DOXYGEN
 #include "PVRCore/pfx/PFXParser.h"
+#include "PVRCore/pfx/PFXCache.h"
 #include "PVRCore/strings/StringFunctions.h"
 #include "PVRCore/stream/FileStream.h"
 #include "PVRCore/stream/BufferStream.h"
+#include "PVRCore/stream/FileCache.h"
+#include "PVRCore/stream/FilePath.h"
+#include "PVRCore/stream/MappedFileStream.h"
+#include "PVRCore/strings/CompileTimeHash.h"
 #include "PVRCore/texture/Texture.h"
 #include "PVRCore/Log.h"
 #include "pugixml.hpp"
@@ -1120,21 +1125,30 @@ void addVersions(effect::Effect& effect, pugi::xml_node root)
 	for (auto it = apiversions.begin(); it != apiversions.end(); ++it) { effect.addVersion(*it); }
 }
 
-} // namespace
-
-effect::Effect readPFX(const ::pvr::Stream& stream, const ::pvr::IAssetProvider* assetProvider)
+// Forwards to the asset provider of the application, recording the files the parser pulls in (the shader sources),
+// so that they can be checked when the compiled effect is loaded.
+class DependencyRecorder : public IAssetProvider
 {
-	effect::Effect asset;
-	readPFX(stream, assetProvider, asset);
-	return asset;
-}
+public:
+	explicit DependencyRecorder(const IAssetProvider& assetProvider) : _assetProvider(assetProvider) {}
 
-void readPFX(const ::pvr::Stream& stream, const ::pvr::IAssetProvider* assetProvider, effect::Effect& asset)
-{
-	std::vector<char> v = stream.readToEnd<char>();
+	std::unique_ptr<Stream> getAssetStream(const std::string& filename, bool logErrorOnNotFound = true) const override
+	{
+		_dependencies.emplace_back(filename);
+		return _assetProvider.getAssetStream(filename, logErrorOnNotFound);
+	}
 
+	const std::vector<std::string>& getDependencies() const { return _dependencies; }
+
+private:
+	const IAssetProvider& _assetProvider;
+	mutable std::vector<std::string> _dependencies;
+};
+
+void parsePFX(std::vector<char>& source, const ::pvr::IAssetProvider* assetProvider, effect::Effect& asset)
+{
 	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_buffer_inplace(v.data(), v.size());
+	pugi::xml_parse_result result = doc.load_buffer_inplace(source.data(), source.size());
 
 	if (result.status != pugi::xml_parse_status::status_ok || !doc || !doc.root()) { throw InvalidDataError("[PfxParser::readAsset_]: Failed to parse PFX file - not valid XML"); }
 	if (!doc.root().first_child() || std::string(doc.root().first_child().name()) != std::string("pfx"))
@@ -1158,6 +1172,59 @@ void readPFX(const ::pvr::Stream& stream, const ::pvr::IAssetProvider* assetProv
 	addEffects(asset, effects.begin(), effects.end());
 }
 
+} // namespace
+
+effect::Effect readPFX(const ::pvr::Stream& stream, const ::pvr::IAssetProvider* assetProvider)
+{
+	effect::Effect asset;
+	readPFX(stream, assetProvider, asset);
+	return asset;
+}
+
+void readPFX(const ::pvr::Stream& stream, const ::pvr::IAssetProvider* assetProvider, effect::Effect& asset)
+{
+	std::vector<char> v = stream.readToEnd<char>();
+	if (isPFXCache(v.data(), v.size())) { readPFXCache(v.data(), v.size(), asset); }
+	else
+	{
+		parsePFX(v, assetProvider, asset);
+	}
+}
+
+void readPFX(const IAssetProvider& assetProvider, const std::string& pfxFile, const std::string& cacheDirectory, effect::Effect& outEffect)
+{
+	std::unique_ptr<Stream> pfxStream = assetProvider.getAssetStream(pfxFile);
+	if (!pfxStream) { throw FileNotFoundError(pfxFile, "PfxParser: Could not open the PFX file"); }
+	std::vector<char> source = pfxStream->readToEnd<char>();
+	uint64_t sourceHash = computePfxSourceHash(source.data(), source.size());
+
+	// Effects with the same name in different directories must not share a compiled effect, so it is keyed on the full
+	// path the asset was actually opened from.
+	const std::string& sourcePath = pfxStream->getFileName();
+	const std::string cacheFile = addTrailingDirectorySeparator(cacheDirectory) +
+		strings::createFormatted("%s.%016llx%s", FilePath(pfxFile).getFilename().c_str(), static_cast<unsigned long long>(hash64_bytes(sourcePath.data(), sourcePath.size())),
+			PfxCacheExtension);
+
+	{
+		MappedFileStream cache(cacheFile, false);
+		if (cache.isReadable() && readPFXCache(cache.getMappedData(), cache.getSize(), sourceHash, &assetProvider, outEffect)) { return; }
+	}
+
+	// No valid compiled effect. Parse the PFX from the bytes already in memory, then compile it for the next load.
+	DependencyRecorder recorder(assetProvider);
+	outEffect.clear();
+	parsePFX(source, &recorder, outEffect);
+
+	try
+	{
+		writeFileAtomically(cacheFile, [&](Stream& cache) { writePFXCache(outEffect, sourceHash, recorder.getDependencies(), &assetProvider, cache); });
+	}
+	catch (const std::exception& e)
+	{
+		Log(LogLevel::Warning, "Could not write compiled effect '%s': %s", cacheFile.c_str(), e.what());
+	}
+}
+
 } // namespace pfx
 
 } // namespace pvr
@@ -16,8 +16,22 @@ namespace pfx {
 effect::Effect readPFX(const ::pvr::Stream& stream, const IAssetProvider* assetProvider);
 
 /// <summary>PFX reader.</summary>
+/// <remarks>The stream may also contain a compiled effect (see PFXCache.h), which is then loaded directly instead of
+/// being parsed.</remarks>
 void readPFX(const ::pvr::Stream& stream, const IAssetProvider* assetProvider, effect::Effect& outEffect);
 
+/// <summary>PFX reader, using a compiled effect to skip parsing the XML on every load after the first.</summary>
+/// <param name="assetProvider">An asset provider used to load the PFX file and its shaders</param>
+/// <param name="pfxFile">The name of the PFX file</param>
+/// <param name="cacheDirectory">A writable directory where compiled effects are kept, for example Shell::getWritePath()</param>
+/// <param name="outEffect">The effect to populate</param>
+/// <remarks>The PFX file is always read and hashed. If a compiled effect exists for it in <paramRef name="cacheDirectory"/>,
+/// was created from identical PFX contents, and none of the shader files it pulled in have changed, the effect is rebuilt
+/// from the memory mapped compiled effect. Otherwise the PFX is parsed as usual and a new compiled effect is written.
+/// The compiled effect is named after the PFX file and a hash of the full path it was opened from, and is replaced
+/// atomically. Failure to write the compiled effect is not an error.</remarks>
+void readPFX(const IAssetProvider& assetProvider, const std::string& pfxFile, const std::string& cacheDirectory, effect::Effect& outEffect);
+
 } // namespace pfx
 
 } // namespace pvr
@@ -0,0 +1,139 @@
+/*!
+\brief Implementation of the on-disk cache helpers.
+\file PVRCore/stream/FileCache.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRCore/stream/FileCache.h"
+#include "PVRCore/stream/FilePath.h"
+#include "PVRCore/stream/FileStream.h"
+#include "PVRCore/stream/MappedFileStream.h"
+#include "PVRCore/Log.h"
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+namespace pvr {
+namespace {
+uint64_t getCurrentProcessId()
+{
+#if defined(_WIN32)
+	return static_cast<uint64_t>(GetCurrentProcessId());
+#else
+	return static_cast<uint64_t>(getpid());
+#endif
+}
+
+// Unlike std::rename on Windows, replaces the destination if it exists.
+bool replaceFile(const std::string& source, const std::string& destination)
+{
+#if defined(_WIN32)
+	return MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return std::rename(source.c_str(), destination.c_str()) == 0;
+#endif
+}
+} // namespace
+
+void writeFileAtomically(const std::string& path, const std::function<void(Stream&)>& writeContents)
+{
+	std::ostringstream tempPathStream;
+	tempPathStream << path << "." << getCurrentProcessId() << "." << std::this_thread::get_id() << ".tmp";
+	const std::string tempPath = tempPathStream.str();
+	try
+	{
+		{
+			FileStream file(tempPath, "wb");
+			writeContents(file);
+		}
+		if (!replaceFile(tempPath, path)) { throw FileIOError(path, "Could not replace the file with '" + tempPath + "'"); }
+	}
+	catch (...)
+	{
+		std::remove(tempPath.c_str());
+		throw;
+	}
+}
+
+void writeFileAtomically(const std::string& path, const void* data, size_t size)
+{
+	writeFileAtomically(path, [data, size](Stream& stream) { stream.writeExact(1, size, data); });
+}
+
+std::string addTrailingDirectorySeparator(const std::string& directory)
+{
+	if (directory.empty() || directory.back() == '/' || directory.back() == FilePath::getDirectorySeparator()) { return directory; }
+	return directory + FilePath::getDirectorySeparator();
+}
+
+BinaryFileCache::BinaryFileCache(const std::string& directory, const char* extension, Validator validator)
+	: _directory(addTrailingDirectorySeparator(directory)), _extension(extension), _validator(validator), _numHits(0), _numMisses(0)
+{}
+
+std::string BinaryFileCache::getEntryPath(uint64_t key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+	return _directory + name + _extension;
+}
+
+bool BinaryFileCache::find(uint64_t key, std::vector<char>& outData)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _entries.find(key);
+		if (it != _entries.end())
+		{
+			outData = it->second;
+			++_numHits;
+			return true;
+		}
+	}
+	if (!_directory.empty())
+	{
+		MappedFileStream file(getEntryPath(key), false);
+		const size_t size = file.isReadable() ? file.getSize() : 0;
+		const char* data = static_cast<const char*>(file.getMappedData());
+		// Entries are content addressed: any readable, well formed file with the right name is valid.
+		if (size && (!_validator || _validator(data, size)))
+		{
+			outData.assign(data, data + size);
+			std::lock_guard<std::mutex> lock(_mutex);
+			_entries[key] = outData;
+			++_numHits;
+			return true;
+		}
+	}
+	++_numMisses;
+	return false;
+}
+
+void BinaryFileCache::insert(uint64_t key, std::vector<char> data)
+{
+	const std::string path = _directory.empty() ? std::string() : getEntryPath(key);
+	if (!path.empty())
+	{
+		try
+		{
+			writeFileAtomically(path, data.data(), data.size());
+		}
+		catch (const std::exception& e)
+		{
+			Log(LogLevel::Warning, "Could not write cache entry '%s': %s", path.c_str(), e.what());
+		}
+	}
+	std::lock_guard<std::mutex> lock(_mutex);
+	_entries[key] = std::move(data);
+}
+
+void BinaryFileCache::erase(uint64_t key)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries.erase(key);
+	}
+	if (!_directory.empty()) { std::remove(getEntryPath(key).c_str()); }
+}
+} // namespace pvr
+//!\endcond
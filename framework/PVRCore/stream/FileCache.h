@@ -0,0 +1,96 @@
+/*!
+\brief Helpers for on-disk caches: atomic file replacement and a content addressed cache of binary blobs.
+\file PVRCore/stream/FileCache.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/stream/Stream.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pvr {
+/// <summary>Write a file through a temporary file in the same directory, then rename it over the destination. A reader,
+/// including one that has the previous version memory mapped, never sees a partially written file, and a process
+/// killed while writing leaves the previous version intact. The temporary file is named after the process and thread,
+/// so concurrent writers never share one.</summary>
+/// <param name="path">The path of the file to write. An existing file is replaced.</param>
+/// <param name="writeContents">Writes the contents of the file to the stream it is passed</param>
+/// <remarks>Throws a FileIOError if the file cannot be written or renamed. The temporary file is removed in that case.
+/// </remarks>
+void writeFileAtomically(const std::string& path, const std::function<void(Stream&)>& writeContents);
+
+/// <summary>Write a block of memory to a file atomically. See the overload taking a function.</summary>
+/// <param name="path">The path of the file to write. An existing file is replaced.</param>
+/// <param name="data">The contents of the file</param>
+/// <param name="size">The size of the contents in bytes</param>
+void writeFileAtomically(const std::string& path, const void* data, size_t size);
+
+/// <summary>Append a directory separator to a directory path, unless it is empty or already ends with one.</summary>
+/// <param name="directory">A directory path</param>
+/// <returns>The directory path, ready to have a file name appended</returns>
+std::string addTrailingDirectorySeparator(const std::string& directory);
+
+/// <summary>A content addressed cache of binary blobs, for example compiled shaders. Entries are keyed by a hash of
+/// everything that affects their contents, so stale entries are never returned and never need to be invalidated.
+/// Entries are kept in memory and, if a directory is provided, also stored on disk (one file per entry, named after the
+/// key) so that they are reused by later launches. Safe to use from multiple threads.</summary>
+class BinaryFileCache
+{
+public:
+	/// <summary>A function checking that the contents of a file read from disk are a well formed entry</summary>
+	typedef bool (*Validator)(const void* data, size_t size);
+
+	/// <summary>Constructor.</summary>
+	/// <param name="directory">A writable directory to persist the cache in. Leave empty for an in-memory only cache.
+	/// </param>
+	/// <param name="extension">The file extension of the entries, including the dot</param>
+	/// <param name="validator">Optional. Entries read from disk for which it returns false are ignored.</param>
+	BinaryFileCache(const std::string& directory, const char* extension, Validator validator = nullptr);
+
+	/// <summary>Look up an entry.</summary>
+	/// <param name="key">The key</param>
+	/// <param name="outData">Receives the contents of the entry if it is found</param>
+	/// <returns>True if the entry was found in memory or on disk</returns>
+	bool find(uint64_t key, std::vector<char>& outData);
+
+	/// <summary>Add an entry. Failure to write it to disk is logged and otherwise ignored.</summary>
+	/// <param name="key">The key</param>
+	/// <param name="data">The contents of the entry</param>
+	void insert(uint64_t key, std::vector<char> data);
+
+	/// <summary>Remove an entry from memory and from disk.</summary>
+	/// <param name="key">The key</param>
+	void erase(uint64_t key);
+
+	/// <summary>Get the directory the cache is persisted in.</summary>
+	/// <returns>The directory, or an empty string for an in-memory cache</returns>
+	const std::string& getDirectory() const { return _directory; }
+
+	/// <summary>Get the number of successful lookups so far.</summary>
+	/// <returns>The number of cache hits</returns>
+	uint32_t getNumHits() const { return _numHits; }
+
+	/// <summary>Get the number of failed lookups so far.</summary>
+	/// <returns>The number of cache misses</returns>
+	uint32_t getNumMisses() const { return _numMisses; }
+
+private:
+	BinaryFileCache(const BinaryFileCache&) = delete;
+	BinaryFileCache& operator=(const BinaryFileCache&) = delete;
+
+	std::string getEntryPath(uint64_t key) const;
+
+	std::string _directory;
+	std::string _extension;
+	Validator _validator;
+	std::mutex _mutex;
+	std::unordered_map<uint64_t, std::vector<char>> _entries;
+	std::atomic<uint32_t> _numHits;
+	std::atomic<uint32_t> _numMisses;
+};
+} // namespace pvr
@@ -0,0 +1,135 @@
+/*!
+\brief A read-only Stream that memory-maps a file.
+\file PVRCore/stream/MappedFileStream.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/stream/BufferStream.h"
+#include <string>
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pvr {
+/// <summary>A read-only Stream that maps a whole file into the address space of the process instead of reading it
+/// through the C runtime. The mapped memory can be accessed directly using getMappedData, which allows file formats
+/// designed for it to be consumed in place without intermediate copies.</summary>
+/// <remarks>The mapping lives as long as the stream. Pages are brought in lazily by the operating system, so
+/// mapping a large file is cheap until its contents are actually touched.</remarks>
+class MappedFileStream : public BufferStream
+{
+public:
+	/// <summary>Constructor. Opens and maps the file with the provided path.</summary>
+	/// <param name="filePath">The path of the file to map</param>
+	/// <param name="errorOnFileNotFound">If true, a FileNotFoundError is thrown if the file cannot be opened or mapped.
+	/// If false, the stream is left in a non-readable state instead.</param>
+	explicit MappedFileStream(const std::string& filePath, bool errorOnFileNotFound = true) : BufferStream(filePath)
+	{
+		_isReadable = false;
+		_isWritable = false;
+		_isRandomAccess = false;
+		if (!map())
+		{
+			unmap();
+			if (errorOnFileNotFound) { throw FileNotFoundError(filePath, "[MappedFileStream] Failed to map file."); }
+		}
+	}
+
+	/// <summary>Destructor. Unmaps the file.</summary>
+	~MappedFileStream() { unmap(); }
+
+	/// <summary>Get a pointer to the start of the mapped file contents.</summary>
+	/// <returns>A pointer to the mapped data, or NULL if the file could not be mapped (or is empty).</returns>
+	const void* getMappedData() const { return _originalData; }
+
+	/// <summary>Create a MappedFileStream.</summary>
+	/// <param name="filename">The path of the file to map</param>
+	/// <param name="errorOnFileNotFound">If true, throw if the file cannot be mapped</param>
+	/// <returns>A unique pointer to the new stream.</returns>
+	static std::unique_ptr<MappedFileStream> createMappedFileStream(const std::string& filename, bool errorOnFileNotFound = true)
+	{
+		return std::make_unique<MappedFileStream>(filename, errorOnFileNotFound);
+	}
+
+private:
+	bool map()
+	{
+#if defined(_WIN32)
+		_fileHandle = CreateFileA(_fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (_fileHandle == INVALID_HANDLE_VALUE) { return false; }
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(_fileHandle, &fileSize)) { return false; }
+		_bufferSize = static_cast<size_t>(fileSize.QuadPart);
+		if (_bufferSize != 0)
+		{
+			_mappingHandle = CreateFileMappingA(_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (!_mappingHandle) { return false; }
+			_originalData = MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+			if (!_originalData) { return false; }
+		}
+#else
+		int fd = open(_fileName.c_str(), O_RDONLY);
+		if (fd < 0) { return false; }
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0)
+		{
+			close(fd);
+			return false;
+		}
+		_bufferSize = static_cast<size_t>(fileStat.st_size);
+		if (_bufferSize != 0)
+		{
+			void* mapped = mmap(nullptr, _bufferSize, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped == MAP_FAILED)
+			{
+				close(fd);
+				_bufferSize = 0;
+				return false;
+			}
+			_originalData = mapped;
+		}
+		// The mapping keeps its own reference to the file, so the descriptor is not needed any more.
+		close(fd);
+#endif
+		_currentPointer = _originalData;
+		_bufferPosition = 0;
+		_isReadable = true;
+		_isRandomAccess = true;
+		return true;
+	}
+
+	void unmap()
+	{
+#if defined(_WIN32)
+		if (_originalData) { UnmapViewOfFile(_originalData); }
+		if (_mappingHandle) { CloseHandle(_mappingHandle); }
+		if (_fileHandle != INVALID_HANDLE_VALUE) { CloseHandle(_fileHandle); }
+		_mappingHandle = NULL;
+		_fileHandle = INVALID_HANDLE_VALUE;
+#else
+		if (_originalData) { munmap(const_cast<void*>(_originalData), _bufferSize); }
+#endif
+		_originalData = nullptr;
+		_currentPointer = nullptr;
+		_bufferSize = 0;
+		_bufferPosition = 0;
+	}
+
+#if defined(_WIN32)
+	HANDLE _fileHandle = INVALID_HANDLE_VALUE;
+	HANDLE _mappingHandle = NULL;
+#endif
+};
+} // namespace pvr
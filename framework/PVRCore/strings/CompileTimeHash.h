@@ -53,6 +53,32 @@ inline uint32_t hash32_bytes(const void* bytes, size_t count)
 	return hashValue;
 }
 
+/// <summary>Function object hashing a number of bytes into a 64 bit unsigned Integer (FNV-1a). Suitable for content
+/// hashing of files and blobs, where the 32 bit version would collide too easily.</summary>
+/// <param name="bytes">Pointer to a block of memory.</param>
+/// <param name="count">Number of bytes to hash.</param>
+/// <param name="seed">A previous hash value to continue from. Allows hashing non-contiguous data.</param>
+/// <returns>The hash of the value.</returns>
+inline uint64_t hash64_bytes(const void* bytes, size_t count, uint64_t seed = 14695981039346656037ULL)
+{
+	uint64_t hashValue = seed;
+	const unsigned char* current = static_cast<const unsigned char*>(bytes);
+	const unsigned char* end = current + count;
+	while (current < end)
+	{
+		hashValue = (hashValue ^ *current) * 1099511628211ULL;
+		++current;
+	}
+	return hashValue;
+}
+
+/// <summary>Continue a 64 bit FNV-1a hash with a string. The terminator is hashed too, so that moving characters
+/// between consecutive strings changes the hash.</summary>
+/// <param name="str">The string to hash</param>
+/// <param name="seed">A previous hash value to continue from</param>
+/// <returns>The hash of the value.</returns>
+inline uint64_t hash64_string(const std::string& str, uint64_t seed = 14695981039346656037ULL) { return hash64_bytes(str.c_str(), str.size() + 1, seed); }
+
 /// <summary>Class template denoting a hash. Specializations only - no default implementation.
 /// (int32_t/int64_t/uint32_t/uint64_t/string)</summary>
 /// <typeparam name="T">type of the value to hash.</typeparam>
@@ -26,11 +26,11 @@ public:
 
 	TextureLoadFuture_() {}
 
-	Semaphore* workSemaphore; ///< A pointer to an externally used semaphore (normally the one used by the queue)
 	std::string filename; ///< The filename from which the texture is loaded
 	IAssetProvider* loader; ///< The AssetProvider to use to load the texture
 	TextureFileFormat format; ///< The format of the texture
 	mutable SemaphorePtr resultSemaphore; ///< The semaphore that is used to wait for the result
+	std::shared_ptr<std::mutex> callbackMutex; ///< Serialises the callbacks of the textures of the same loader
 	/// <summary>The result of the operation will be stored here</summary>
 	TexturePtr result;
 	/// <summary>A pointer to an exception to throw</summary>
@@ -39,10 +39,10 @@ public:
 	/// <summary>Load the texture synchronously and signal the result semaphore. Normally called by the worker thread</summary>
 	void loadNow()
 	{
-		std::unique_ptr<Stream> stream = loader->getAssetStream(filename);
 		_successful = false;
 		try
 		{
+			std::unique_ptr<Stream> stream = loader->getAssetStream(filename);
 			*result = textureLoad(*stream, format);
 			_successful = true;
 		}
@@ -53,7 +53,11 @@ public:
 		}
 
 		resultSemaphore->signal();
-		executeCallBack(shared_from_this());
+		if (_completionCallback)
+		{
+			std::lock_guard<std::mutex> lock(*callbackMutex);
+			executeCallBack(shared_from_this());
+		}
 	}
 	/// <summary>Set a function to be called when the texture loading has been finished.</summary>
 	/// <param name="callback">Set a function to be called when the texture loading has been finished.</param>
@@ -62,11 +66,7 @@ public:
 private:
 	TexturePtr get_() const
 	{
-		if (!_inCallback)
-		{
-			resultSemaphore->wait();
-			resultSemaphore->signal();
-		}
+		if (!_inCallback) { waitForCompletion(*resultSemaphore); }
 		return result;
 	}
 	bool isComplete_() const
@@ -92,14 +92,17 @@ namespace impl {
 inline void textureLoadAsyncWorker(TextureLoadFuture future) { future->loadNow(); }
 } // namespace impl
 
-/// <summary>A class that loads Textures in a (single) different thread and provides futures to them.
-/// Create an instance of it, and then just call loadTextureAsync foreach texture to load. When each texture
-/// has completed loading, a callback may be called, otherwise you can use all the typical functionality
-/// of futures, such as querying if loading is comlete, or using a blocking wait to get the result</summary>
+/// <summary>A class that loads Textures on the process-wide JobSystem and provides futures to them. Textures are
+/// loaded in parallel, on as many workers as are available, but the completion callbacks of a loader never run
+/// concurrently, so they need no synchronisation of their own. As the loads run in parallel, the callbacks may run in
+/// a different order than the textures were requested. Create an instance of it, and then just call
+/// loadTextureAsync foreach texture to load. When each texture has completed loading, a callback may be called,
+/// otherwise you can use all the typical functionality of futures, such as querying if loading is comlete, or using a
+/// blocking wait to get the result</summary>
 class TextureAsyncLoader : public AsyncScheduler<TexturePtr, TextureLoadFuture, &impl::textureLoadAsyncWorker>
 {
 public:
-	TextureAsyncLoader() { _myInfo = "TextureAsyncLoader"; }
+	TextureAsyncLoader() : AsyncScheduler(JobSystem::getInstance().getNumWorkers()), _callbackMutex(std::make_shared<std::mutex>()) { _myInfo = "TextureAsyncLoader"; }
 	/// <summary>This function enqueues a "load texture" on a background thread, and returns an object
 	/// that can be used to query and wait for the result.</summary>
 	/// <param name="filename">The filename of the texture to load</param>
@@ -116,14 +119,14 @@ public:
 		params.loader = loader;
 		params.result = std::make_shared<Texture>();
 		params.resultSemaphore = std::make_shared<Semaphore>();
-		params.workSemaphore = &_workSemaphore;
 		params.setCallBack(callback);
-		_queueSemaphore.wait();
-		_queue.emplace_back(future);
-		_queueSemaphore.signal();
-		_workSemaphore.signal();
+		params.callbackMutex = _callbackMutex;
+		enqueue(future);
 		return future;
 	}
+
+private:
+	std::shared_ptr<std::mutex> _callbackMutex;
 };
 } // namespace async
 } // namespace pvr
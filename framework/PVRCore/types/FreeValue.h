@@ -569,6 +569,11 @@ public:
 	/// <param name="datatype">The datatype to define this FreeValue.</param>
 	void setDataType(GpuDatatypes datatype) { dataType_ = datatype; }
 
+	/// <summary>Define the number of array elements of this FreeValue. The value is not touched: this only changes how
+	/// it is interpreted, and the elements must still fit in the 64 bytes of inline storage.</summary>
+	/// <param name="arrayElements">The number of array elements</param>
+	void setArrayElements(uint32_t arrayElements) { arrayElements_ = arrayElements; }
+
 	/// <summary>Set the value of this object</summary>
 	/// <typeparam name="Type_">The type of the value. Used to interpret the object
 	/// and alos set the datatype.</typeparam>
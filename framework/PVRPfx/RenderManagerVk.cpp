@@ -16,7 +16,11 @@
 #include "PVRUtils/Vulkan/HelperVk.h"
 #include "PVRCore/strings/StringHash.h"
 #include "PVRCore/math/MathUtils.h"
+#include "PVRCore/JobSystem.h"
 #include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <exception>
 namespace pvr {
 namespace utils {
 using namespace pvrvk;
@@ -1792,41 +1796,330 @@ bool RendermanModel::getModelSemantic(const StringHash& semantic, TypedMem& memo
 
 /////////// RENDERING COMMANDS - (various classes of the RenderManager) ///////////
 
+namespace {
+// Tracks what has been bound in a command buffer, so that consecutive nodes only bind the pipeline and descriptor sets
+// that actually changed.
+struct NodeBindingState
+{
+	GraphicsPipeline prevPipeline;
+	DescriptorSet prevSets[FrameworkCaps::MaxDescriptorSetBindings];
+	const uint32_t* prevDynamicOffsets[FrameworkCaps::MaxDescriptorSetBindings] = {};
+
+	void recordNode(RendermanNode& node, CommandBufferBase& cmdBuffer, uint16_t swapIdx)
+	{
+		bool bindSets[FrameworkCaps::MaxDescriptorSetBindings] = { true, true, true, true };
+		auto& renderpipeline = *node.pipelineMaterial_->pipeline_;
+		GraphicsPipeline& pipeline = renderpipeline.apiPipeline;
+
+		bool bindPipeline = (!prevPipeline || pipeline != prevPipeline);
+		prevPipeline = pipeline;
+
+		for (uint32_t setid = 0; setid < FrameworkCaps::MaxDescriptorSetBindings; ++setid)
+		{
+			if (!renderpipeline.pipelineInfo->descSetExists[setid])
+			{
+				bindSets[setid] = false;
+				continue;
+			}
+			uint32_t setswapid = renderpipeline.pipelineInfo->descSetIsMultibuffered[setid] ? swapIdx : 0;
+			const std::vector<uint32_t>& nodeDynamicOffsets = node.getDynamicOffsets(setid, swapIdx);
+			bindSets[setid] = (bindPipeline || node.pipelineMaterial_->sets[setid][setswapid] != prevSets[setid] || nodeDynamicOffsets.data() != prevDynamicOffsets[setid]);
+
+			if (bindSets[setid])
+			{
+				prevSets[setid] = node.pipelineMaterial_->sets[setid][setswapid];
+				prevDynamicOffsets[setid] = nodeDynamicOffsets.data();
+			}
+		}
+		node.recordRenderingCommands(cmdBuffer, swapIdx, bindPipeline, bindSets);
+	}
+};
+
+ClearValue getPassClearColor(const RendermanPass& pass)
+{
+	// use the clear color from the model if found, else use the default
+	for (const RendermanSubpass& subpass : pass.subpasses)
+	{
+		for (const RendermanSubpassGroup& group : subpass.groups)
+		{
+			for (const RendermanModel* model : group.allModels)
+			{
+				if (model)
+				{
+					const float* color = model->assetModel->getInternalData().clearColor;
+					return ClearValue(color[0], color[1], color[2], 1.0f);
+				}
+			}
+		}
+	}
+	return ClearValue();
+}
+} // namespace
+
 void RenderManager::recordAllRenderingCommands(CommandBuffer& cmdBuffer, uint16_t swapIdx, bool recordBeginEndRenderPass)
 {
 	for (auto& effect : _renderStructure.effects) { effect.recordRenderingCommands(cmdBuffer, swapIdx, recordBeginEndRenderPass); }
 }
 
-void RendermanEffect::recordRenderingCommands(CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRenderPass)
+void RenderManager::initParallelRecording(uint32_t queueFamilyIndex, uint32_t drawsPerChunk)
 {
-	for (auto& pass : passes) { pass.recordRenderingCommands(cmdBuffer, swapIdx, beginEndRenderPass); }
+	pvrvk::Device device = getDevice().lock();
+	const uint32_t numRecorders = async::JobSystem::getInstance().getNumWorkers() + 1;
+	_drawsPerChunk = std::max(drawsPerChunk, 1u);
+	_parallelRecorders.clear();
+	_parallelRecorders.resize(_swapchain->getSwapchainLength());
+	for (std::vector<ParallelRecorder>& recorders : _parallelRecorders)
+	{
+		recorders.resize(numRecorders);
+		for (ParallelRecorder& recorder : recorders)
+		{
+			recorder.commandPool = device->createCommandPool(pvrvk::CommandPoolCreateInfo(queueFamilyIndex, pvrvk::CommandPoolCreateFlags::e_TRANSIENT_BIT));
+			recorder.numUsed = 0;
+		}
+	}
 }
 
-void RendermanPass::recordRenderingCommands(CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRendermanPass)
+void RenderManager::recordAllRenderingCommandsParallel(CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRenderPass)
+{
+	if (_parallelRecorders.empty()) { throw InvalidOperationError("RenderManager: initParallelRecording must be called before recordAllRenderingCommandsParallel"); }
+
+	// The command buffers recorded for this swapchain image the last time are no longer in use, as the primary command
+	// buffer executing them is being re-recorded.
+	for (ParallelRecorder& recorder : _parallelRecorders[swapIdx])
+	{
+		recorder.commandPool->reset(pvrvk::CommandPoolResetFlags::e_NONE);
+		recorder.numUsed = 0;
+	}
+
+	for (RendermanEffect& effect : _renderStructure.effects)
+	{
+		for (RendermanPass& pass : effect.passes) { recordPassParallel_(pass, cmdBuffer, swapIdx, beginEndRenderPass); }
+	}
+}
+
+void RenderManager::recordPassParallel_(RendermanPass& pass, CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRenderPass)
+{
+	const Framebuffer& framebuffer = pass.framebuffer[swapIdx];
+
+	// Flatten the renderables of each subpass in recording order, and decide which subpasses are worth splitting.
+	std::vector<std::vector<RendermanNode*>> subpassNodes(pass.subpasses.size());
+	std::vector<bool> useSecondaries(pass.subpasses.size());
+	for (uint32_t subpassId = 0; subpassId < pass.subpasses.size(); ++subpassId)
+	{
+		for (RendermanSubpassGroup& group : pass.subpasses[subpassId].groups)
+		{
+			for (RendermanSubpassGroupModel& subpassModel : group.subpassGroupModels)
+			{
+				for (RendermanNode& node : subpassModel.nodes) { subpassNodes[subpassId].push_back(&node); }
+			}
+		}
+		// Without beginning the render pass ourselves, the caller has started it expecting secondary command buffers.
+		useSecondaries[subpassId] = !beginEndRenderPass || subpassNodes[subpassId].size() > _drawsPerChunk;
+	}
+
+	if (beginEndRenderPass)
+	{
+		const ClearValue clearColor = getPassClearColor(pass);
+		cmdBuffer->beginRenderPass(framebuffer, framebuffer->getRenderPass(),
+			pvrvk::Rect2D(pvrvk::Offset2D(0, 0), pvrvk::Extent2D(framebuffer->getDimensions().getWidth(), framebuffer->getDimensions().getHeight())), !useSecondaries[0],
+			&clearColor, 1);
+	}
+
+	std::vector<ParallelRecorder>& recorders = _parallelRecorders[swapIdx];
+	for (uint32_t subpassId = 0; subpassId < pass.subpasses.size(); ++subpassId)
+	{
+		if (subpassId) { cmdBuffer->nextSubpass(useSecondaries[subpassId] ? pvrvk::SubpassContents::e_SECONDARY_COMMAND_BUFFERS : pvrvk::SubpassContents::e_INLINE); }
+		if (!useSecondaries[subpassId])
+		{
+			pass.subpasses[subpassId].recordRenderingCommands(CommandBufferBase(cmdBuffer), swapIdx);
+			continue;
+		}
+
+		// Split the subpass into chunks of about _drawsPerChunk draws, each recorded into its own secondary command buffer.
+		// Every job recording chunks uses its own command pool, as command pools cannot be used from several threads at once.
+		const std::vector<RendermanNode*>& nodes = subpassNodes[subpassId];
+		const uint32_t numNodes = static_cast<uint32_t>(nodes.size());
+		const uint32_t numChunks = std::max((numNodes + _drawsPerChunk - 1) / _drawsPerChunk, 1u);
+		const uint32_t chunkSize = (numNodes + numChunks - 1) / numChunks;
+		std::vector<SecondaryCommandBuffer> chunkCmdBuffers(numChunks);
+		std::atomic<uint32_t> nextRecorder(0);
+		std::atomic<uint32_t> nextChunk(0);
+		auto recordChunks = [&, subpassId]() {
+			ParallelRecorder& recorder = recorders[nextRecorder++];
+			for (uint32_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+			{
+				if (recorder.numUsed == recorder.commandBuffers.size()) { recorder.commandBuffers.push_back(recorder.commandPool->allocateSecondaryCommandBuffer()); }
+				SecondaryCommandBuffer& secondary = recorder.commandBuffers[recorder.numUsed++];
+				secondary->begin(framebuffer, subpassId, pvrvk::CommandBufferUsageFlags::e_RENDER_PASS_CONTINUE_BIT | pvrvk::CommandBufferUsageFlags::e_ONE_TIME_SUBMIT_BIT);
+				NodeBindingState state;
+				CommandBufferBase base(secondary);
+				for (uint32_t node = chunk * chunkSize; node < std::min(numNodes, (chunk + 1) * chunkSize); ++node) { state.recordNode(*nodes[node], base, swapIdx); }
+				secondary->end();
+				chunkCmdBuffers[chunk] = secondary;
+			}
+		};
+
+		async::JobSystem& jobSystem = async::JobSystem::getInstance();
+		std::vector<async::JobHandle> jobs(std::min(numChunks, static_cast<uint32_t>(recorders.size())) - 1);
+		for (async::JobHandle& job : jobs) { job = jobSystem.submit(recordChunks); }
+		std::exception_ptr exception;
+		try
+		{
+			recordChunks();
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+			nextChunk = numChunks;
+		}
+		try
+		{
+			jobSystem.waitAll(jobs.data(), static_cast<uint32_t>(jobs.size()));
+		}
+		catch (...)
+		{
+			if (!exception) { exception = std::current_exception(); }
+		}
+		if (exception) { std::rethrow_exception(exception); }
+
+		cmdBuffer->executeCommands(chunkCmdBuffers.data(), numChunks);
+	}
+
+	if (beginEndRenderPass) { cmdBuffer->endRenderPass(); }
+}
+
+void RenderManager::createSemanticUpdatePlan()
 {
-	if (beginEndRendermanPass)
+	RendermanSemanticUpdatePlan plan;
+	for (RendermanEffect& effect : _renderStructure.effects)
 	{
-		// use the clear color from the model if found, else use the default
-		ClearValue clearColor;
-		for (uint32_t i = 0; i < subpasses.size(); ++i)
+		for (RendermanPass& pass : effect.passes)
 		{
-			for (uint32_t j = 0; j < subpasses[i].groups.size(); ++j)
+			for (RendermanSubpass& subpass : pass.subpasses)
 			{
-				for (RendermanModel* model : subpasses[i].groups[j].allModels)
+				for (RendermanSubpassGroup& subpassGroup : subpass.groups)
 				{
-					if (model)
+					if (subpassGroup.subpassGroupModels.empty()) { continue; }
+					for (RendermanPipeline& pipe : subpassGroup.pipelines) { plan.pipelines.push_back(&pipe); }
+					for (RendermanSubpassGroupModel& subpassModel : subpassGroup.subpassGroupModels)
 					{
-						float *color = model->assetModel->getInternalData().clearColor;
-						clearColor.setColorValue(color[0], color[1], color[2], 1.0f);
-						i = j = static_cast<uint32_t>(-1); // break the outer loop as well.
-						break;
+						for (RendermanNode& node : subpassModel.nodes)
+						{
+							if (!node.automaticEntrySemantics.empty() || !node.automaticUniformSemantics.empty()) { plan.nodes.push_back(&node); }
+						}
 					}
 				}
 			}
 		}
+	}
 
-		recordRenderingCommandsWithClearColor(cmdBuffer, swapIdx, clearColor);
+	// Gather the byte ranges each node writes, for every swapchain image. The granularity is the dynamic slice, which is
+	// what a node owns in a dynamic buffer; nodes sharing a slice (e.g. of a non-dynamic buffer) are then conservatively
+	// treated as conflicting even if they write different entries of it.
+	struct WriteRange
+	{
+		const void* buffer;
+		uint64_t begin;
+		uint64_t end;
+		uint32_t node;
+	};
+	std::vector<WriteRange> writes;
+	for (uint32_t nodeId = 0; nodeId < plan.nodes.size(); ++nodeId)
+	{
+		for (const AutomaticNodeBufferEntrySemantic& sem : plan.nodes[nodeId]->automaticEntrySemantics)
+		{
+			for (uint32_t slice : sem.bufferDynamicSlice)
+			{
+				const uint64_t begin = sem.structuredBufferView->getDynamicSliceOffset(slice);
+				writes.push_back(WriteRange{ sem.buffer->get(), begin, begin + sem.structuredBufferView->getDynamicSliceSize(), nodeId });
+			}
+		}
+	}
+
+	// Sweep the ranges of each buffer in order, joining the nodes of any overlapping ranges into the same group.
+	std::vector<uint32_t> group(plan.nodes.size());
+	std::iota(group.begin(), group.end(), 0u);
+	auto findGroup = [&group](uint32_t node) {
+		while (group[node] != node) { node = group[node] = group[group[node]]; }
+		return node;
+	};
+	std::sort(writes.begin(), writes.end(), [](const WriteRange& a, const WriteRange& b) { return a.buffer != b.buffer ? std::less<const void*>()(a.buffer, b.buffer) : a.begin < b.begin; });
+	for (size_t i = 1, furthest = 0; i < writes.size(); ++i)
+	{
+		if (writes[i].buffer == writes[furthest].buffer && writes[i].begin < writes[furthest].end)
+		{
+			uint32_t a = findGroup(writes[i].node), b = findGroup(writes[furthest].node);
+			if (a != b) { group[std::max(a, b)] = std::min(a, b); }
+			if (writes[i].end > writes[furthest].end) { furthest = i; }
+		}
+		else
+		{
+			furthest = i;
+		}
+	}
+
+	// Lay the batches out contiguously, keeping the original node order inside each batch so that nodes writing to the
+	// same memory are still updated in the same order as by updateAutomaticSemantics.
+	std::vector<uint32_t> batchOfNode(plan.nodes.size());
+	std::vector<uint32_t> batchSizes;
+	std::vector<uint32_t> batchOfGroup(plan.nodes.size(), static_cast<uint32_t>(-1));
+	for (uint32_t nodeId = 0; nodeId < plan.nodes.size(); ++nodeId)
+	{
+		uint32_t& batch = batchOfGroup[findGroup(nodeId)];
+		if (batch == static_cast<uint32_t>(-1))
+		{
+			batch = static_cast<uint32_t>(batchSizes.size());
+			batchSizes.push_back(0);
+		}
+		batchOfNode[nodeId] = batch;
+		++batchSizes[batch];
+	}
+	plan.batchOffsets.resize(batchSizes.size() + 1, 0);
+	for (uint32_t batch = 0; batch < batchSizes.size(); ++batch) { plan.batchOffsets[batch + 1] = plan.batchOffsets[batch] + batchSizes[batch]; }
+	std::vector<RendermanNode*> orderedNodes(plan.nodes.size());
+	std::vector<uint32_t> cursor(plan.batchOffsets.begin(), plan.batchOffsets.end() - 1);
+	for (uint32_t nodeId = 0; nodeId < plan.nodes.size(); ++nodeId) { orderedNodes[cursor[batchOfNode[nodeId]]++] = plan.nodes[nodeId]; }
+	plan.nodes.swap(orderedNodes);
+
+	Log(LogLevel::Information, "RenderManager: Semantic update plan created: %u pipelines, %u nodes in %u independent batches", static_cast<uint32_t>(plan.pipelines.size()),
+		static_cast<uint32_t>(plan.nodes.size()), plan.getNumBatches());
+	_semanticUpdatePlan = std::move(plan);
+	_semanticUpdatePlanValid = true;
+}
+
+void RenderManager::updateAutomaticSemanticsParallel(uint32_t swapidx, uint32_t minBatchesPerJob)
+{
+	if (!_semanticUpdatePlanValid) { createSemanticUpdatePlan(); }
+	const RendermanSemanticUpdatePlan& plan = _semanticUpdatePlan;
+
+	std::vector<bool> wasUpdating;
+	for (RendermanEffect& effect : _renderStructure.effects)
+	{
+		wasUpdating.push_back(effect.isUpdating[swapidx]);
+		if (!wasUpdating.back()) { effect.beginBufferUpdates(swapidx); }
 	}
+
+	// Per-model semantics may be shared by all the nodes of a pipeline, so they are updated first, on this thread.
+	for (RendermanPipeline* pipe : plan.pipelines) { pipe->updateAutomaticModelSemantics(swapidx); }
+
+	async::JobSystem::getInstance().parallelFor(0, plan.getNumBatches(), std::max(minBatchesPerJob, 1u), [&plan, swapidx](uint32_t firstBatch, uint32_t lastBatch) {
+		for (uint32_t node = plan.batchOffsets[firstBatch]; node < plan.batchOffsets[lastBatch]; ++node) { plan.nodes[node]->updateAutomaticSemantics(swapidx); }
+	});
+
+	for (uint32_t effect = 0; effect < _renderStructure.effects.size(); ++effect)
+	{
+		if (!wasUpdating[effect]) { _renderStructure.effects[effect].endBufferUpdates(swapidx); }
+	}
+}
+
+void RendermanEffect::recordRenderingCommands(CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRenderPass)
+{
+	for (auto& pass : passes) { pass.recordRenderingCommands(cmdBuffer, swapIdx, beginEndRenderPass); }
+}
+
+void RendermanPass::recordRenderingCommands(CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRendermanPass)
+{
+	if (beginEndRendermanPass) { recordRenderingCommandsWithClearColor(cmdBuffer, swapIdx, getPassClearColor(*this)); }
 	else
 	{
 		recordRenderingCommands_(cmdBuffer, swapIdx, nullptr, 0);
@@ -1857,46 +2150,15 @@ void RendermanSubpassGroup::recordRenderingCommands(CommandBufferBase cmdBuffer,
 
 void RendermanSubpassGroupModel::recordRenderingCommands(CommandBufferBase cmdBuffer, uint16_t swapIdx)
 {
-	DescriptorSet prev_sets[4] = {};
-
-	bool bindSets[FrameworkCaps::MaxDescriptorSetBindings] = { true, true, true, true };
-
-	const uint32_t swapchainLength = backToModel().backToRenderManager().getSwapchain()->getSwapchainLength();
-
-	std::vector<std::vector<const uint32_t*>> dynamicOffsets(FrameworkCaps::MaxDescriptorSetBindings, std::vector<const uint32_t*>(swapchainLength, 0));
-
-	GraphicsPipeline prev_pipeline = nullptr;
+	NodeBindingState state;
 	uint32_t nodeId = 0;
 	for (auto& node : nodes)
 	{
-		auto& renderpipeline = *node.pipelineMaterial_->pipeline_;
-		GraphicsPipeline& pipeline = renderpipeline.apiPipeline;
-
-		bool bindPipeline = (!prev_pipeline || pipeline != prev_pipeline);
-		prev_pipeline = pipeline;
-
-		for (uint32_t setid = 0; setid < FrameworkCaps::MaxDescriptorSetBindings; ++setid)
-		{
-			if (!renderpipeline.pipelineInfo->descSetExists[setid])
-			{
-				bindSets[setid] = false;
-				continue;
-			}
-			uint32_t setswapid = renderpipeline.pipelineInfo->descSetIsMultibuffered[setid] ? swapIdx : 0;
-			const std::vector<uint32_t>& nodeDynamicOffsets = node.getDynamicOffsets(setid, swapIdx);
-			bindSets[setid] = (bindPipeline || node.pipelineMaterial_->sets[setid][setswapid] != prev_sets[setid] || nodeDynamicOffsets.data() != dynamicOffsets[setid][swapIdx]);
-
-			if (bindSets[setid])
-			{
-				prev_sets[setid] = node.pipelineMaterial_->sets[setid][setswapid];
-				dynamicOffsets[setid][swapIdx] = nodeDynamicOffsets.data();
-			}
-		}
 #ifdef PVR_RENDERMANAGER_DEBUG_RENDERING_COMMANDS
-		Log(LogLevel::Information, "RendermanSubpassGroupModel::recordRenderingCommands nodeid: %d, pipeline name: %s", nodeId, renderpipeline.name.c_str());
+		Log(LogLevel::Information, "RendermanSubpassGroupModel::recordRenderingCommands nodeid: %d, pipeline name: %s", nodeId, node.pipelineMaterial_->pipeline_->name.c_str());
 #endif
 		++nodeId;
-		node.recordRenderingCommands(cmdBuffer, swapIdx, bindPipeline, bindSets);
+		state.recordNode(node, cmdBuffer, swapIdx);
 	}
 }
 
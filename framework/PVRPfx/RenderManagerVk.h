@@ -1244,6 +1244,25 @@ struct RendermanStructure
 	std::deque<RendermanEffect> effects; //!< The root of the tree: The list of effects contained.
 };
 
+/// <summary>A precomputed plan used to update the automatic per-node semantics of a RenderManager in parallel. The
+/// nodes are split into batches so that no two batches ever write to the same bytes of a buffer: nodes whose writes may
+/// overlap (for example several nodes sharing a non-dynamic buffer) are placed in the same batch, in their original
+/// order, so each batch can be updated by a different thread with the same result as a serial update.</summary>
+struct RendermanSemanticUpdatePlan
+{
+	std::vector<RendermanPipeline*> pipelines; //!< The pipelines whose per-model semantics are updated (serially) before the nodes
+	std::vector<RendermanNode*> nodes; //!< The nodes with automatic semantics, ordered so that the nodes of each batch are contiguous
+	std::vector<uint32_t> batchOffsets; //!< Batch i contains the nodes [batchOffsets[i], batchOffsets[i + 1])
+
+	/// <summary>Get the number of batches that can be updated concurrently.</summary>
+	/// <returns>The number of batches</returns>
+	uint32_t getNumBatches() const { return batchOffsets.empty() ? 0 : static_cast<uint32_t>(batchOffsets.size() - 1); }
+
+	/// <summary>Query if the plan has been built.</summary>
+	/// <returns>True if the plan is empty (not built, or nothing to update)</returns>
+	bool empty() const { return pipelines.empty() && nodes.empty(); }
+};
+
 // The RendermanStructure. This class contains all the different effects that have been added.
 // RendermanEffect[]
 //	map<StringHash, StructuredMemoryView> effectBuffers
@@ -1513,6 +1532,20 @@ private:
 	IAssetProvider* _assetProvider;
 	pvr::utils::vma::Allocator _vmaAllocator;
 	bool _astcSupported;
+	RendermanSemanticUpdatePlan _semanticUpdatePlan;
+	bool _semanticUpdatePlanValid;
+
+	// A command pool, and the secondary command buffers allocated from it, used by one recording job at a time.
+	struct ParallelRecorder
+	{
+		pvrvk::CommandPool commandPool;
+		std::vector<pvrvk::SecondaryCommandBuffer> commandBuffers;
+		uint32_t numUsed;
+	};
+	std::vector<std::vector<ParallelRecorder>> _parallelRecorders; // Per swapchain image, one per recording thread
+	uint32_t _drawsPerChunk;
+
+	void recordPassParallel_(RendermanPass& pass, pvrvk::CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRenderPass);
 
 	/// <summary>Generate the RenderManager, create the structure, add all rendering effects, create the API objects, and
 	/// in general, cook everything. Call AFTER any calls to addEffect(...) and addModel...(...). Call BEFORE any
@@ -1524,7 +1557,7 @@ private:
 public:
 	/// <summary>Constructor. Creates an empty rendermanager. In order to use it, you need to addEffect() and addModel() to
 	/// populate it, then buildRenderObjects(), then createAutomaticSemantics(), generate</summary>
-	RenderManager() : _astcSupported(false) {}
+	RenderManager() : _astcSupported(false), _semanticUpdatePlanValid(false), _drawsPerChunk(64) {}
 
 	/// <summary>Get the Asset Provider object that was set when initializing this RenderManager</summary>
 	/// <returns>The Asset Provider object that was set when initializing this RenderManager</returns>
@@ -1888,6 +1921,26 @@ public:
 	/// (potentially using the RenderNodeIterator (call renderables()) and record rendering commands from them.</remarks>
 	void recordAllRenderingCommands(pvrvk::CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRenderPass = true);
 
+	/// <summary>Prepare the RenderManager for recordAllRenderingCommandsParallel. Creates, for each swapchain image, one
+	/// command pool per recording thread (the process-wide JobSystem workers and the calling thread).</summary>
+	/// <param name="queueFamilyIndex">The queue family of the queue the primary command buffers will be submitted to</param>
+	/// <param name="drawsPerChunk">The number of draws recorded into each secondary command buffer. Subpasses with no
+	/// more draws than this are recorded inline into the primary command buffer, as splitting them would cost more than
+	/// it saves.</param>
+	void initParallelRecording(uint32_t queueFamilyIndex, uint32_t drawsPerChunk = 64);
+
+	/// <summary>Same as recordAllRenderingCommands, but the renderables of each subpass are split into chunks of draws
+	/// that are recorded into secondary command buffers in parallel, on the process-wide JobSystem, and then executed
+	/// from <paramref name="cmdBuffer"/>. initParallelRecording must have been called first.</summary>
+	/// <param name="cmdBuffer">A Primary command buffer to record the commands into</param>
+	/// <param name="swapIdx">The current swap chain (framebuffer image) index to record commands for. The secondary
+	/// command buffers previously recorded for this index are reused, so the primary command buffer previously recorded
+	/// for it must no longer be executing.</param>
+	/// <param name="beginEndRenderPass">If set to true, record a beginRenderPass() at the beginning and endRenderPass() at
+	/// the end of each pass. If false, the render pass must have been begun with secondary command buffer contents
+	/// (inlineFirstSubpass = false), and every subpass is recorded into secondary command buffers.</param>
+	void recordAllRenderingCommandsParallel(pvrvk::CommandBuffer& cmdBuffer, uint16_t swapIdx, bool beginEndRenderPass = true);
+
 	/// <summary>Return number of effects this render manager owns</summary>
 	/// <returns>Number of effects</returns>
 	size_t getNumEffects() const { return _renderStructure.effects.size(); }
@@ -1913,6 +1966,7 @@ public:
 				}
 			}
 		}
+		_semanticUpdatePlanValid = false;
 	}
 
 	/// <summary>Iterates all the nodes semantics per-effect, per-pass, per-subpass, per-model, per-node, and updates their
@@ -1923,6 +1977,24 @@ public:
 		for (RendermanEffect& effect : _renderStructure.effects) { effect.updateAutomaticSemantics(swapidx); }
 	}
 
+	/// <summary>Build the plan used by updateAutomaticSemanticsParallel: the list of pipelines and nodes to update, and
+	/// the partitioning of the nodes into batches that never write to the same buffer ranges. Called automatically by the
+	/// first updateAutomaticSemanticsParallel after createAutomaticSemantics; call it explicitly to keep that cost out of
+	/// the first frame.</summary>
+	void createSemanticUpdatePlan();
+
+	/// <summary>Get the plan used by updateAutomaticSemanticsParallel.</summary>
+	/// <returns>The semantic update plan. Empty if it has not been built yet.</returns>
+	const RendermanSemanticUpdatePlan& getSemanticUpdatePlan() const { return _semanticUpdatePlan; }
+
+	/// <summary>Same as updateAutomaticSemantics, but the per-node semantics are updated in parallel on the process-wide
+	/// JobSystem, partitioned according to the semantic update plan. The per-model semantics are still updated on the
+	/// calling thread, before the nodes. The models must not be modified while this function executes.</summary>
+	/// <param name="swapidx">swapchain index</param>
+	/// <param name="minBatchesPerJob">The minimum number of batches (usually one node each) updated by each job. Lower
+	/// values balance the load better, higher values reduce the scheduling overhead.</param>
+	void updateAutomaticSemanticsParallel(uint32_t swapidx, uint32_t minBatchesPerJob = 32);
+
 	/// <summary>Setter of RenderManager::_astcSupported
 	/// <param name="astcSupported">Value to set</param>
 	void setASTCSupported(bool astcSupported) { _astcSupported = astcSupported; }
@@ -0,0 +1,85 @@
+/*!
+\brief Contains the implementation for the pvr::platform::ShellOS class for headless (offscreen) rendering on Linux. No window or
+display connection is created: OpenGL ES renders to a pbuffer and Vulkan presents to a VK_EXT_headless_surface surface. Used to run
+the examples on software implementations (llvmpipe, lavapipe) and on machines without a display, e.g. for automated benchmarking.
+\file PVRShell/OS/Linux/Headless/ShellOS.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRShell/OS/ShellOS.h"
+#include "PVRShell/OS/Linux/InternalOS.h"
+#include "PVRCore/Log.h"
+
+namespace pvr {
+namespace platform {
+
+class HeadlessInternalOS : public InternalOS
+{
+public:
+	HeadlessInternalOS(ShellOS* shellOS) : InternalOS(shellOS) {}
+
+	virtual ~HeadlessInternalOS() {}
+};
+
+// Setup the capabilities.
+const ShellOS::Capabilities ShellOS::_capabilities = { Capability::Unsupported, Capability::Unsupported };
+
+ShellOS::ShellOS(OSApplication application, OSDATA osdata) : _instance(application) { _OSImplementation = std::make_unique<HeadlessInternalOS>(this); }
+
+ShellOS::~ShellOS() {}
+
+void ShellOS::updatePointingDeviceLocation() {}
+
+bool ShellOS::init(DisplayAttributes& data)
+{
+	if (!_OSImplementation) { return false; }
+
+	return true;
+}
+
+bool ShellOS::initializeWindow(DisplayAttributes& data)
+{
+	// There is no monitor whose resolution could be used, so the offscreen surface always has the requested size.
+	DisplayAttributes defaults;
+	data.fullscreen = false;
+	data.x = data.y = 0;
+	if (data.width == 0) { data.width = defaults.width; }
+	if (data.height == 0) { data.height = defaults.height; }
+	Log(LogLevel::Information, "Headless: Rendering offscreen at %ux%u", data.width, data.height);
+	_OSImplementation->setIsInitialized(true);
+	return true;
+}
+
+void ShellOS::releaseWindow() { _OSImplementation->setIsInitialized(false); }
+
+OSApplication ShellOS::getApplication() const { return _instance; }
+
+OSConnection ShellOS::getConnection() const { return nullptr; }
+
+OSDisplay ShellOS::getDisplay() const { return nullptr; }
+
+OSWindow ShellOS::getWindow() const { return nullptr; }
+
+bool ShellOS::handleOSEvents()
+{
+	// Keyboard input from the terminal is still processed, so that a headless run can be interrupted.
+	return _OSImplementation->handleOSEvents(_shell);
+}
+
+bool ShellOS::isInitialized() { return _OSImplementation && _OSImplementation->isInitialized(); }
+
+bool ShellOS::popUpMessage(const char* title, const char* message, ...) const
+{
+	if (!message) { return false; }
+
+	va_list arg;
+	va_start(arg, message);
+	Log(LogLevel::Information, message, arg);
+	va_end(arg);
+
+	return true;
+}
+} // namespace platform
+} // namespace pvr
+//!\endcond
@@ -14,8 +14,8 @@
 #endif
 #elif defined(__linux__)
 #if not defined(__ANDROID__)
-#if not(defined(X11) || defined(XCB) || defined(Wayland) || defined(NullWS))
-#error Please define a valid window system to compile PVRShell for Linux - Supported window systems are X11, XCB, Wayland, or NullWS. Please pass the desired window system using -DPVR_WINDOW_SYSTEM=[NullWS,X11,XCB,Wayland].
+#if not(defined(X11) || defined(XCB) || defined(Wayland) || defined(NullWS) || defined(Headless))
+#error Please define a valid window system to compile PVRShell for Linux - Supported window systems are X11, XCB, Wayland, NullWS or Headless. Please pass the desired window system using -DPVR_WINDOW_SYSTEM=[NullWS,X11,XCB,Wayland,Headless].
 #endif
 #endif
 #endif
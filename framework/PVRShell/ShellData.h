@@ -65,6 +65,9 @@ struct ShellData
 
 	float FPS; //!< The current frames per second
 	bool showFPS; //!< Indicates whether the current fps should be printed
+	bool profile; //!< Indicates whether the Profiler should record, and a Chrome trace be written on ReleaseView
+	bool benchmark; //!< Indicates whether the duration of each frame should be recorded, and a summary be written on ReleaseView
+	std::vector<float> benchmarkFrameTimes; //!< The measured (wall clock) duration of each frame since InitView, in milliseconds
 
 	Api contextType; //!< The API used
 	Api minContextType; //!< The minimum API supported
@@ -74,7 +77,7 @@ struct ShellData
 		: timeAtInitApplication(static_cast<uint64_t>(-1)), lastFrameTime(static_cast<uint64_t>(-1)), currentFrameTime(static_cast<uint64_t>(-1)), os(0), commandLine(0),
 		  captureFrameStart(-1), captureFrameStop(-1), captureFrameScale(1), trapPointerOnDrag(true), forceFrameTime(false), fakeFrameTime(16), exiting(false), frameNo(0),
 		  forceReleaseInitWindow(false), forceReleaseInitView(false), dieAfterFrame(-1), dieAfterTime(-1), startTime(0), safetyCritical(false), jsonGeneration(false),
-		  outputInfo(false), weAreDone(false), FPS(0.0f), showFPS(false), contextType(Api::Unspecified), minContextType(Api::Unspecified) {};		
+		  outputInfo(false), weAreDone(false), FPS(0.0f), showFPS(false), profile(false), benchmark(false), contextType(Api::Unspecified), minContextType(Api::Unspecified) {};		
 };
 } // namespace platform
 } // namespace pvr
@@ -10,7 +10,10 @@
 #include "PVRCore/stream/FileStream.h"
 #include "PVRCore/Log.h"
 #include "PVRCore/Time_.h"
+#include "PVRCore/Profiler.h"
 #include <map>
+#include <algorithm>
+#include <numeric>
 #include <cstdlib>
 #include <cmath>
 #include <sstream>
@@ -298,6 +301,12 @@ void setForceFrameTime(Shell& shell, const char* arg, const char* val)
 void showVersion(Shell& shell, const char* /*arg*/, const char* /*val*/) { Log(LogLevel::Information, "Version: '%hs'", shell.getSDKVersion()); }
 void setShowFps(Shell& shell, const char* /*arg*/, const char* /*val*/) { shell.setShowFPS(true); }
 void showInfo(Shell& shell, const char* /*arg*/, const char* /*val*/) { shell.getOS()._shellData.outputInfo = true; }
+void setProfile(Shell& shell, const char* /*arg*/, const char* /*val*/)
+{
+	shell.getOS()._shellData.profile = true;
+	Profiler::getInstance().setEnabled(true);
+}
+void setBenchmark(Shell& shell, const char* /*arg*/, const char* /*val*/) { shell.getOS()._shellData.benchmark = true; }
 void showCommandLineOptions(Shell& shell, const char* arg, const char* val);
 } // namespace
 
@@ -311,7 +320,7 @@ const std::map<std::string, SetShellParameterPtr> supportedCommandLineOptions{ s
 	std::make_pair("-depthbpp", &setDepthBpp), std::make_pair("-dbpp", &setDepthBpp), std::make_pair("-stencilbpp", &setStencilBpp), std::make_pair("-dbpp", &setStencilBpp),
 	std::make_pair("-c", &setCaptureFrames), std::make_pair("-screenshotscale", &setScreenshotScale), std::make_pair("-priority", &setContextPriority),
 	std::make_pair("-config", &setDesiredCconfigId), std::make_pair("-forceframetime", &setForceFrameTime), std::make_pair("-fft", &setForceFrameTime),
-	std::make_pair("-version", &showVersion), std::make_pair("-fps", &setShowFps), std::make_pair("-info", &showInfo), std::make_pair("-h", &showCommandLineOptions),
+	std::make_pair("-version", &showVersion), std::make_pair("-fps", &setShowFps), std::make_pair("-info", &showInfo), std::make_pair("-profile", &setProfile), std::make_pair("-benchmark", &setBenchmark), std::make_pair("-h", &showCommandLineOptions),
 	std::make_pair("-help", &showCommandLineOptions), std::make_pair("--help", &showCommandLineOptions), std::make_pair("-safetycritical", &setSafetyCritical),
 	std::make_pair("-jsongeneration", &setJsonGeneration) };
 
@@ -326,6 +335,48 @@ void showCommandLineOptions(Shell& /*shell*/, const char* /*arg*/, const char* /
 	for (; it != end; ++it) { sstream << ", " << it->first; }
 	Log(LogLevel::Information, "%s", sstream.str().c_str());
 }
+
+// Percentile of an already sorted, non-empty list of frame times, using the nearest-rank method.
+float percentile(const std::vector<float>& sortedFrameTimes, float fraction)
+{
+	size_t rank = static_cast<size_t>(std::ceil(fraction * sortedFrameTimes.size()));
+	return sortedFrameTimes[std::min(std::max(rank, size_t(1)), sortedFrameTimes.size()) - 1];
+}
+
+void writeBenchmarkReport(const std::string& path, const Shell& shell, const ShellData& shellData)
+{
+	const std::vector<float>& frameTimes = shellData.benchmarkFrameTimes;
+	std::vector<float> sorted(frameTimes);
+	std::sort(sorted.begin(), sorted.end());
+	const float total = std::accumulate(sorted.begin(), sorted.end(), 0.0f);
+	const float mean = total / sorted.size();
+
+	Log(LogLevel::Information, "Benchmark: %u frames, mean %.3fms, median %.3fms, p95 %.3fms, p99 %.3fms, min %.3fms, max %.3fms", static_cast<uint32_t>(sorted.size()), mean,
+		percentile(sorted, .5f), percentile(sorted, .95f), percentile(sorted, .99f), sorted.front(), sorted.back());
+
+	std::stringstream json;
+	json << "{\n";
+	json << "\t\"application\": \"" << shell.getApplicationName() << "\",\n";
+	json << "\t\"api\": \"" << apiName(shellData.contextType) << "\",\n";
+	json << "\t\"width\": " << shellData.attributes.width << ",\n";
+	json << "\t\"height\": " << shellData.attributes.height << ",\n";
+	json << "\t\"fixedFrameTimeMs\": " << (shellData.forceFrameTime ? shellData.fakeFrameTime : 0) << ",\n";
+	json << "\t\"frameCount\": " << sorted.size() << ",\n";
+	json << "\t\"totalMs\": " << total << ",\n";
+	json << "\t\"meanMs\": " << mean << ",\n";
+	json << "\t\"medianMs\": " << percentile(sorted, .5f) << ",\n";
+	json << "\t\"p95Ms\": " << percentile(sorted, .95f) << ",\n";
+	json << "\t\"p99Ms\": " << percentile(sorted, .99f) << ",\n";
+	json << "\t\"minMs\": " << sorted.front() << ",\n";
+	json << "\t\"maxMs\": " << sorted.back() << ",\n";
+	json << "\t\"frameTimesMs\": [";
+	for (size_t i = 0; i < frameTimes.size(); ++i) { json << (i ? ", " : "") << frameTimes[i]; }
+	json << "]\n}\n";
+
+	const std::string report = json.str();
+	FileStream reportFile(path, "wb");
+	reportFile.writeExact(1, report.size(), report.data());
+}
 } // namespace
 
 Result StateMachine::init()
@@ -567,6 +618,34 @@ Result StateMachine::executeReleaseView()
 {
 	Log(LogLevel::Debug, "StateMachine::executeReleaseView executing");
 	Result result = _shell->shellReleaseView();
+	if (_shellData.profile)
+	{
+		const std::string tracePath = _shell->getWritePath() + _shell->getApplicationName() + ".trace.json";
+		try
+		{
+			FileStream traceFile(tracePath, "wb");
+			Profiler::getInstance().exportChromeTrace(traceFile);
+			Log(LogLevel::Information, "Profiler trace written to %s", tracePath.c_str());
+		}
+		catch (const std::exception& e)
+		{
+			Log(LogLevel::Warning, "Could not write the profiler trace to %s: %s", tracePath.c_str(), e.what());
+		}
+	}
+	if (_shellData.benchmark && !_shellData.benchmarkFrameTimes.empty())
+	{
+		const std::string reportPath = _shell->getWritePath() + _shell->getApplicationName() + ".benchmark.json";
+		try
+		{
+			writeBenchmarkReport(reportPath, *_shell, _shellData);
+			Log(LogLevel::Information, "Benchmark report written to %s", reportPath.c_str());
+		}
+		catch (const std::exception& e)
+		{
+			Log(LogLevel::Warning, "Could not write the benchmark report to %s: %s", reportPath.c_str(), e.what());
+		}
+		_shellData.benchmarkFrameTimes.clear();
+	}
 	_shellData.forceReleaseInitView = false;
 
 	if (result != Result::Success)
@@ -590,7 +669,15 @@ Result StateMachine::executeFrame()
 	ShellOS::handleOSEvents();
 
 	// Call RenderScene
-	Result result = _shell->shellRenderFrame();
+	Result result;
+	const uint64_t frameStart = _shellData.timer.getElapsedMicroSecs();
+	{
+		PVR_PROFILE_SCOPE("renderFrame");
+		result = _shell->shellRenderFrame();
+	}
+	// Always measured with the real timer: -forceframetime only affects the time reported to the application.
+	if (_shellData.benchmark && result == Result::Success)
+	{ _shellData.benchmarkFrameTimes.push_back((_shellData.timer.getElapsedMicroSecs() - frameStart) * .001f); }
 
 	if (_shellData.weAreDone && result == Result::Success) { result = Result::ExitRenderFrame; }
 
@@ -637,6 +724,7 @@ Result StateMachine::executeFrame()
 
 	// Increment our frame number
 	++_shellData.frameNo;
+	if (_shellData.profile) { Profiler::getInstance().nextFrame(); }
 	if (_shellData.weAreDone) { Log(LogLevel::Debug, "[StateMachine]: We Are Done"); }
 	return result;
 }
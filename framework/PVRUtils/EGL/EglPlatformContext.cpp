@@ -72,6 +72,25 @@ void logEGLConfiguration(const DisplayAttributes& attributes)
 
 void EglContext_::release()
 {
+	if (_parentContext)
+	{
+		// A shared context only owns its context and pbuffer surface. The display belongs to the parent context.
+		if (_platformContextHandles)
+		{
+			EGLDisplay display = _parentContext->_platformContextHandles->display;
+			if (_platformContextHandles->context && _platformContextHandles->context == egl::GetCurrentContext())
+			{ egl::MakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT); }
+			if (_platformContextHandles->context) { egl::DestroyContext(display, _platformContextHandles->context); }
+			if (_platformContextHandles->drawSurface) { egl::DestroySurface(display, _platformContextHandles->drawSurface); }
+			_platformContextHandles->context = EGL_NO_CONTEXT;
+			_platformContextHandles->drawSurface = EGL_NO_SURFACE;
+			--_parentContext->_numSharedContexts;
+		}
+		_platformContextHandles.reset();
+		return;
+	}
+	// The shared contexts use the display of this context, which is terminated below.
+	assertion(_numSharedContexts == 0, "EglContext: The shared contexts must be released before the context they were created from");
 	if (_initialized)
 	{
 		// Check the current context/surface/display. If they are equal to the handles in this class, remove them from the current context
@@ -186,7 +205,11 @@ static inline bool isGlesVersionSupported(EGLDisplay display, Api graphicsapi, b
 
 	{
 		configAttributes[i++] = EGL_SURFACE_TYPE;
+#if defined(Headless)
+		configAttributes[i++] = EGL_PBUFFER_BIT;
+#else
 		configAttributes[i++] = EGL_WINDOW_BIT;
+#endif
 
 		switch (graphicsapi)
 		{
@@ -437,8 +460,13 @@ static inline void initializeContext(bool wantWindow, DisplayAttributes& origina
 
 			if (wantWindow)
 			{
+				// Headless builds have no window to present to and render into an offscreen pbuffer instead.
 				configAttributes[i++] = EGL_SURFACE_TYPE;
+#if defined(Headless)
+				configAttributes[i++] = EGL_PBUFFER_BIT;
+#else
 				configAttributes[i++] = EGL_WINDOW_BIT;
+#endif
 			}
 
 			switch (graphicsapi)
@@ -1070,6 +1098,17 @@ void EglContext_::init(OSWindow window, OSDisplay display, DisplayAttributes& at
 		Log(LogLevel::Information, "[EglContext::init] Enabling Linear window backbuffer.");
 	}
 
+#if defined(Headless)
+	{
+		uint32_t attrib = eglattribs[0] == EGL_NONE ? 0 : 2;
+		eglattribs[attrib++] = EGL_WIDTH;
+		eglattribs[attrib++] = static_cast<EGLint>(attributes.width);
+		eglattribs[attrib++] = EGL_HEIGHT;
+		eglattribs[attrib++] = static_cast<EGLint>(attributes.height);
+	}
+	_platformContextHandles->drawSurface = _platformContextHandles->readSurface = egl::CreatePbufferSurface(_platformContextHandles->display, config, eglattribs);
+	Log(LogLevel::Information, "[EglContext::init] Headless: Rendering to a %ux%u pbuffer surface.", attributes.width, attributes.height);
+#else
 	_platformContextHandles->drawSurface = _platformContextHandles->readSurface = egl::CreateWindowSurface(_platformContextHandles->display, config,
 #if defined(Wayland)
 		_platformContextHandles->eglWindow,
@@ -1077,6 +1116,7 @@ void EglContext_::init(OSWindow window, OSDisplay display, DisplayAttributes& at
 		reinterpret_cast<EGLNativeWindowType>(window),
 #endif // Wayland
 		eglattribs);
+#endif // Headless
 #endif //SC_ENABLED
 	if (_platformContextHandles->drawSurface == EGL_NO_SURFACE) { throw InvalidOperationError("[EglContext::init] Could not create the EGL Surface."); }
 
@@ -1127,6 +1167,7 @@ std::unique_ptr<EglContext_> EglContext_::createSharedContextFromEGLContext()
 	EGLConfig config;
 
 	sharedContext->_parentContext = this;
+	++_numSharedContexts;
 	sharedContext->_platformContextHandles = std::make_shared<NativePlatformHandles_>();
 
 	createSharedContext(*sharedContext->_parentContext->_attributes, sharedContext->_parentContext->_platformContextHandles, sharedContext->_platformContextHandles,
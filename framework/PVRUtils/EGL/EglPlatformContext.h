@@ -15,6 +15,7 @@ Graphics context.
 #else
 #include "PVRUtils/EGL/EglPlatformHandles.h"
 #endif
+#include <atomic>
 #include <map>
 
 /// <summary>Main PowerVR Framework namespace</summary>
@@ -29,12 +30,13 @@ class EglContext_
 public:
 	EglContext_()
 		: _platformContextHandles(), _swapInterval(-2), _initialized(false), _preInitialized(false), _apiType(Api::Unspecified), _maxApiVersion(Api::Unspecified), _attributes(0),
-		  _isDiscardSupported(false), _parentContext(0)
+		  _isDiscardSupported(false), _parentContext(0), _numSharedContexts(0)
 	{}
 
 	virtual ~EglContext_() { release(); }
 
-	/// <summary>Release this object</summary>
+	/// <summary>Release this object. The shared contexts created from a context (see createSharedContextFromEGLContext)
+	/// must be released before it.</summary>
 	void release();
 
 	/// <summary>Get maximum api version supported</summary>
@@ -86,7 +88,9 @@ public:
 	/// <returns>Returns the OpenGL ES handle for the on screen frame buffer object.</returns>
 	uint32_t getOnScreenFbo();
 
-	/// <summary>Creates an instance of a shared platform context</summary>
+	/// <summary>Creates an instance of a shared platform context. The shared context uses the display of this context,
+	/// so it must be released before this context is: releasing this context while shared contexts are alive is an
+	/// error.</summary>
 	/// <returns>A unique pointer to a EglContext_ instance.</returns>
 	std::unique_ptr<EglContext_> createSharedContextFromEGLContext();
 
@@ -102,6 +106,7 @@ private:
 	DisplayAttributes* _attributes;
 	bool _isDiscardSupported;
 	platform::EglContext_* _parentContext;
+	std::atomic<uint32_t> _numSharedContexts; // Shared contexts created from this one that have not been released yet
 
 	// Must be called after the context has been active in order to query the driver for resource limitations.
 	void populateMaxApiVersion();
@@ -8,9 +8,15 @@
 #if !SC_ENABLED
 #include "PVRCore/stream/Stream.h"
 #include "PVRCore/strings/StringFunctions.h"
+#include "PVRCore/strings/CompileTimeHash.h"
+#include "PVRCore/Profiler.h"
 #include "PVRUtils/OpenGLES/ShaderUtilsGles.h"
 #include "PVRUtils/OpenGLES/BindingsGles.h"
 #include "PVRUtils/OpenGLES/ErrorsGles.h"
+#include "PVRUtils/EGL/EglPlatformContext.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 namespace pvr {
 namespace utils {
@@ -56,6 +62,32 @@ GLenum getGlslShaderType(ShaderType shaderType)
 	}
 	return glEnum;
 }
+
+// Bump when the key or the file layout changes.
+const uint32_t ProgramBinaryCacheVersion = 1;
+const uint32_t ProgramBinaryMagicNumber = 0x42525650; // "PVRB"
+
+struct ProgramBinaryFileHeader
+{
+	uint32_t magic;
+	uint32_t format;
+	uint32_t size;
+};
+
+// Entries are content addressed: any well formed file with the right name is valid.
+bool isValidProgramBinaryEntry(const void* data, size_t size)
+{
+	ProgramBinaryFileHeader header = { 0, 0, 0 };
+	if (size >= sizeof(header)) { memcpy(&header, data, sizeof(header)); }
+	return header.magic == ProgramBinaryMagicNumber && header.size && header.size == size - sizeof(header);
+}
+
+void hashGlString(GLenum name, uint64_t& key)
+{
+	const char* str = reinterpret_cast<const char*>(gl::GetString(name));
+	if (!str) { str = ""; }
+	key = hash64_bytes(str, strlen(str) + 1, key);
+}
 } // namespace
 
 static inline GLuint loadShaderUtil(const std::string& shaderSrc, ShaderType shaderType, const char* const* defines, uint32_t defineCount)
@@ -162,7 +194,8 @@ GLuint loadShader(const Stream& shaderSource, ShaderType shaderType, const char*
 	return outShader;
 }
 
-GLuint createShaderProgram(const GLuint pShaders[], uint32_t count, const char** const sAttribs, const uint16_t* attribIndex, uint32_t attribCount, std::string* infologptr)
+static GLuint linkShaderProgram(
+	const GLuint pShaders[], uint32_t count, const char* const* sAttribs, const uint16_t* attribIndex, uint32_t attribCount, std::string* infologptr, bool retrievable)
 {
 	pvr::utils::throwOnGlError("createShaderProgram begin");
 	GLuint outShaderProg = gl::CreateProgram();
@@ -177,6 +210,7 @@ GLuint createShaderProgram(const GLuint pShaders[], uint32_t count, const char**
 	{
 		for (uint32_t i = 0; i < attribCount; ++i) { gl::BindAttribLocation(outShaderProg, attribIndex[i], sAttribs[i]); }
 	}
+	if (retrievable) { gl::ProgramParameteri(outShaderProg, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
 	pvr::utils::throwOnGlError("createShaderProgram begin linkProgram");
 	gl::LinkProgram(outShaderProg);
 	pvr::utils::throwOnGlError("createShaderProgram end linkProgram");
@@ -195,13 +229,203 @@ GLuint createShaderProgram(const GLuint pShaders[], uint32_t count, const char**
 		{
 			gl::GetProgramInfoLog(outShaderProg, infoLogLength, &charWriten, &infolog[0]);
 			Log(LogLevel::Debug, infolog.c_str());
+			gl::DeleteProgram(outShaderProg);
 			throw InvalidOperationError("Failed to link program with infolog " + infolog);
 		}
+		gl::DeleteProgram(outShaderProg);
 		throw InvalidOperationError("Failed to link shader");
 	}
 	pvr::utils::throwOnGlError("createShaderProgram end");
 	return outShaderProg;
 }
+
+GLuint createShaderProgram(const GLuint pShaders[], uint32_t count, const char** const sAttribs, const uint16_t* attribIndex, uint32_t attribCount, std::string* infologptr)
+{
+	return linkShaderProgram(pShaders, count, sAttribs, attribIndex, attribCount, infologptr, false);
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory) : _cache(directory, ".glbin", isValidProgramBinaryEntry) {}
+
+bool ProgramBinaryCache::find(uint64_t key, GLenum& outFormat, std::vector<char>& outBinary)
+{
+	std::vector<char> data;
+	if (!_cache.find(key, data)) { return false; }
+	ProgramBinaryFileHeader header;
+	memcpy(&header, data.data(), sizeof(header));
+	outFormat = static_cast<GLenum>(header.format);
+	outBinary.assign(data.begin() + sizeof(header), data.end());
+	return true;
+}
+
+void ProgramBinaryCache::insert(uint64_t key, GLenum format, const std::vector<char>& binary)
+{
+	const ProgramBinaryFileHeader header = { ProgramBinaryMagicNumber, static_cast<uint32_t>(format), static_cast<uint32_t>(binary.size()) };
+	std::vector<char> data(sizeof(header) + binary.size());
+	memcpy(data.data(), &header, sizeof(header));
+	if (!binary.empty()) { memcpy(data.data() + sizeof(header), binary.data(), binary.size()); }
+	_cache.insert(key, std::move(data));
+}
+
+void ProgramBinaryCache::erase(uint64_t key) { _cache.erase(key); }
+
+bool isProgramBinaryCacheSupported()
+{
+	const char* version = reinterpret_cast<const char*>(gl::GetString(GL_VERSION));
+	int major = 0;
+	if (!version || sscanf(version, "OpenGL ES %d", &major) != 1 || major < 3) { return false; }
+	GLint numFormats = 0;
+	gl::GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	return numFormats > 0;
+}
+
+uint64_t computeProgramBinaryCacheKey(const ShaderProgramSource& programSource)
+{
+	const uint32_t header[] = { ProgramBinaryCacheVersion, static_cast<uint32_t>(programSource.shaders.size()), static_cast<uint32_t>(programSource.attribNames.size()),
+		static_cast<uint32_t>(programSource.defines.size()) };
+	uint64_t key = hash64_bytes(header, sizeof(header));
+	// GL_VERSION carries the driver version on all known implementations.
+	hashGlString(GL_VENDOR, key);
+	hashGlString(GL_RENDERER, key);
+	hashGlString(GL_VERSION, key);
+	for (const auto& shader : programSource.shaders)
+	{
+		const uint32_t type = static_cast<uint32_t>(shader.first);
+		key = hash64_bytes(&type, sizeof(type), key);
+		key = hash64_string(shader.second, key);
+	}
+	for (size_t i = 0; i < programSource.attribNames.size(); ++i)
+	{
+		const uint32_t index = i < programSource.attribIndices.size() ? programSource.attribIndices[i] : 0;
+		key = hash64_bytes(&index, sizeof(index), key);
+		key = hash64_string(programSource.attribNames[i], key);
+	}
+	for (const std::string& define : programSource.defines) { key = hash64_string(define, key); }
+	return key;
+}
+
+GLuint createShaderProgram(const ShaderProgramSource& programSource, ProgramBinaryCache* cache, std::string* infolog)
+{
+	const bool useCache = cache && isProgramBinaryCacheSupported();
+	uint64_t key = 0;
+	if (useCache)
+	{
+		key = computeProgramBinaryCacheKey(programSource);
+		GLenum format = 0;
+		std::vector<char> binary;
+		if (cache->find(key, format, binary))
+		{
+			pvr::utils::throwOnGlError("createShaderProgram begin ProgramBinary");
+			GLuint program = gl::CreateProgram();
+			gl::ProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+			GLint glStatus = 0;
+			gl::GetProgramiv(program, GL_LINK_STATUS, &glStatus);
+			if (glStatus && gl::GetError() == GL_NO_ERROR) { return program; }
+			// Rejected, typically after a driver update that kept the same version string. Clear the error it may have
+			// raised (e.g. an unsupported format) and rebuild from source.
+			gl::GetError();
+			gl::DeleteProgram(program);
+			cache->erase(key);
+			Log(LogLevel::Information, "ProgramBinaryCache: Program binary %016llx was rejected by the driver. Rebuilding it from source.", static_cast<unsigned long long>(key));
+		}
+	}
+
+	std::vector<const char*> defines(programSource.defines.size());
+	for (size_t i = 0; i < defines.size(); ++i) { defines[i] = programSource.defines[i].c_str(); }
+	std::vector<const char*> attribNames(programSource.attribNames.size());
+	for (size_t i = 0; i < attribNames.size(); ++i) { attribNames[i] = programSource.attribNames[i].c_str(); }
+	const uint32_t numAttribs = static_cast<uint32_t>(std::min(attribNames.size(), programSource.attribIndices.size()));
+
+	std::vector<GLuint> shaders;
+	shaders.reserve(programSource.shaders.size());
+	GLuint program = 0;
+	try
+	{
+		for (const auto& shader : programSource.shaders)
+		{ shaders.push_back(loadShader(shader.second, shader.first, defines.data(), static_cast<uint32_t>(defines.size()))); }
+		program = linkShaderProgram(shaders.data(), static_cast<uint32_t>(shaders.size()), attribNames.data(), programSource.attribIndices.data(), numAttribs, infolog, useCache);
+	}
+	catch (...)
+	{
+		for (GLuint shader : shaders) { gl::DeleteShader(shader); }
+		throw;
+	}
+	for (GLuint shader : shaders) { gl::DeleteShader(shader); }
+
+	if (useCache)
+	{
+		GLint length = 0;
+		gl::GetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length > 0)
+		{
+			std::vector<char> binary(static_cast<size_t>(length));
+			GLsizei written = 0;
+			GLenum format = 0;
+			gl::GetProgramBinary(program, length, &written, &format, binary.data());
+			if (written > 0)
+			{
+				binary.resize(static_cast<size_t>(written));
+				cache->insert(key, format, binary);
+			}
+		}
+		pvr::utils::throwOnGlError("createShaderProgram GetProgramBinary");
+	}
+	return program;
+}
+
+ProgramBinaryCacheWarmer::ProgramBinaryCacheWarmer(platform::EglContext_& context, ProgramBinaryCache& cache, std::vector<ShaderProgramSource> programs)
+	: _sharedContext(context.createSharedContextFromEGLContext()), _cache(cache), _programs(std::move(programs)), _numProcessed(0), _cancelled(false), _complete(false)
+{
+	_thread = std::thread(&ProgramBinaryCacheWarmer::run, this);
+}
+
+ProgramBinaryCacheWarmer::~ProgramBinaryCacheWarmer()
+{
+	_cancelled = true;
+	wait();
+}
+
+void ProgramBinaryCacheWarmer::wait()
+{
+	if (_thread.joinable()) { _thread.join(); }
+}
+
+void ProgramBinaryCacheWarmer::run()
+{
+	Profiler::getInstance().setThreadName("Program binary cache warmer");
+	try
+	{
+		// A GL context can only be current on one thread at a time, which is why this uses a dedicated thread rather
+		// than the JobSystem workers.
+		_sharedContext->makeCurrent();
+		if (!isProgramBinaryCacheSupported()) { Log(LogLevel::Information, "ProgramBinaryCacheWarmer: Program binaries are not supported by this context."); }
+		else
+		{
+			for (const ShaderProgramSource& programSource : _programs)
+			{
+				if (_cancelled) { break; }
+				PVR_PROFILE_SCOPE("warmProgramBinary");
+				try
+				{
+					gl::DeleteProgram(createShaderProgram(programSource, &_cache));
+				}
+				catch (const std::exception& e)
+				{
+					Log(LogLevel::Warning, "ProgramBinaryCacheWarmer: Failed to build program: %s", e.what());
+				}
+				++_numProcessed;
+			}
+		}
+#if !TARGET_OS_IPHONE
+		egl::MakeCurrent(egl::GetCurrentDisplay(), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#endif
+	}
+	catch (const std::exception& e)
+	{
+		Log(LogLevel::Warning, "ProgramBinaryCacheWarmer: %s", e.what());
+	}
+	_complete = true;
+}
+
 } // namespace utils
 } // namespace pvr
 #endif
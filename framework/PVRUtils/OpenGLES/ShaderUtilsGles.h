@@ -11,8 +11,14 @@
 #include "PVRCore/IAssetProvider.h"
 #include "PVRUtils/PVRUtilsTypes.h"
 #include "PVRCore/texture/TextureLoad.h"
+#include "PVRCore/stream/FileCache.h"
+#include <atomic>
+#include <thread>
 
 namespace pvr {
+namespace platform {
+class EglContext_;
+} // namespace platform
 namespace utils {
 
 /// <summary>Load shader from shader source. Will implicitly load on the current context.</summary>
@@ -44,14 +50,191 @@ GLuint createShaderProgram(
 	const GLuint pShaders[], uint32_t shadersCount, const char** const attribNames, const uint16_t* attribIndices, uint32_t attribsCount, std::string* infolog = NULL);
 /// @endcond
 
+/// <summary>Describes everything that goes into building a shader program: the source of each stage, the attribute
+/// bindings and the preprocessor definitions. Owns its strings, so that it can be kept around or handed to another
+/// thread (see ProgramBinaryCacheWarmer).</summary>
+struct ShaderProgramSource
+{
+	std::vector<std::pair<ShaderType, std::string>> shaders; //!< The type and source text of each stage
+	std::vector<std::string> attribNames; //!< The names of the attributes to bind
+	std::vector<uint16_t> attribIndices; //!< The binding index of each attribute in attribNames
+	std::vector<std::string> defines; //!< The preprocessor definitions passed to every stage
+
+	/// <summary>Add a stage.</summary>
+	/// <param name="shaderType">The type (stage) of the shader</param>
+	/// <param name="shaderSource">The shader source text</param>
+	/// <returns>This object (allows chained calls)</returns>
+	ShaderProgramSource& addShader(ShaderType shaderType, const std::string& shaderSource)
+	{
+		shaders.emplace_back(shaderType, shaderSource);
+		return *this;
+	}
+
+	/// <summary>Add a stage, reading its source from an asset.</summary>
+	/// <param name="app">An AssetProvider to use for loading the shader</param>
+	/// <param name="shaderType">The type (stage) of the shader</param>
+	/// <param name="filename">The filename of the shader. Ignored if NULL.</param>
+	/// <returns>This object (allows chained calls)</returns>
+	ShaderProgramSource& addShader(const IAssetProvider& app, ShaderType shaderType, const char* filename)
+	{
+		if (filename)
+		{
+			shaders.emplace_back(shaderType, std::string());
+			app.getAssetStream(filename)->readIntoString(shaders.back().second);
+		}
+		return *this;
+	}
+
+	/// <summary>Set the attribute bindings.</summary>
+	/// <param name="names">The names of the attributes</param>
+	/// <param name="indices">The binding index of each attribute</param>
+	/// <param name="count">The number of attributes</param>
+	/// <returns>This object (allows chained calls)</returns>
+	ShaderProgramSource& setAttributes(const char* const* names, const uint16_t* indices, uint32_t count)
+	{
+		attribNames.assign(names, names + (names ? count : 0));
+		attribIndices.assign(indices, indices + (indices ? count : 0));
+		return *this;
+	}
+
+	/// <summary>Set the preprocessor definitions.</summary>
+	/// <param name="defineList">The definitions</param>
+	/// <param name="count">The number of definitions</param>
+	/// <returns>This object (allows chained calls)</returns>
+	ShaderProgramSource& setDefines(const char* const* defineList, uint32_t count)
+	{
+		defines.assign(defineList, defineList + (defineList ? count : 0));
+		return *this;
+	}
+};
+
+/// <summary>An on-disk cache of linked program binaries (glGetProgramBinary). Entries are keyed by
+/// computeProgramBinaryCacheKey, i.e. by a hash of the sources, defines, attribute bindings, GL_RENDERER and
+/// GL_VERSION (which carries the driver version), so a driver update or a shader edit simply misses the cache. A binary
+/// the driver still rejects is dropped and the program is rebuilt from source. Entries are kept in memory and, if a
+/// directory is provided, also stored on disk (one .glbin file per entry). Safe to use from multiple threads.</summary>
+class ProgramBinaryCache
+{
+public:
+	/// <summary>Constructor.</summary>
+	/// <param name="directory">A writable directory to persist the cache in, for example Shell::getWritePath(). Leave
+	/// empty for an in-memory only cache.</param>
+	explicit ProgramBinaryCache(const std::string& directory = std::string());
+
+	/// <summary>Look up an entry.</summary>
+	/// <param name="key">The key, from computeProgramBinaryCacheKey</param>
+	/// <param name="outFormat">Receives the binary format if the entry is found</param>
+	/// <param name="outBinary">Receives the program binary if the entry is found</param>
+	/// <returns>True if the entry was found in memory or on disk</returns>
+	bool find(uint64_t key, GLenum& outFormat, std::vector<char>& outBinary);
+
+	/// <summary>Add an entry. Failure to write it to disk is logged and otherwise ignored.</summary>
+	/// <param name="key">The key, from computeProgramBinaryCacheKey</param>
+	/// <param name="format">The binary format returned by glGetProgramBinary</param>
+	/// <param name="binary">The program binary</param>
+	void insert(uint64_t key, GLenum format, const std::vector<char>& binary);
+
+	/// <summary>Remove an entry, for example because the driver rejected it.</summary>
+	/// <param name="key">The key, from computeProgramBinaryCacheKey</param>
+	void erase(uint64_t key);
+
+	/// <summary>Get the directory the cache is persisted in.</summary>
+	/// <returns>The directory, or an empty string for an in-memory cache</returns>
+	const std::string& getDirectory() const { return _cache.getDirectory(); }
+
+	/// <summary>Get the number of successful lookups so far.</summary>
+	/// <returns>The number of cache hits</returns>
+	uint32_t getNumHits() const { return _cache.getNumHits(); }
+
+	/// <summary>Get the number of failed lookups so far.</summary>
+	/// <returns>The number of cache misses</returns>
+	uint32_t getNumMisses() const { return _cache.getNumMisses(); }
+
+private:
+	BinaryFileCache _cache;
+};
+
+/// <summary>Query if the current context can retrieve and load program binaries (OpenGL ES 3.0 or later, with at
+/// least one program binary format). If not, a ProgramBinaryCache passed to createShaderProgram is ignored.</summary>
+/// <returns>True if program binaries are supported by the current context</returns>
+bool isProgramBinaryCacheSupported();
+
+/// <summary>Compute the ProgramBinaryCache key of a program on the current context: a hash of the stages and their
+/// sources, the attribute bindings, the defines, GL_VENDOR, GL_RENDERER and GL_VERSION.</summary>
+/// <param name="programSource">The program</param>
+/// <returns>The cache key</returns>
+uint64_t computeProgramBinaryCacheKey(const ShaderProgramSource& programSource);
+
+/// <summary>Create a native shader program, loading it from a program binary cache if possible. On a miss (or if the
+/// cached binary is rejected by the driver) the program is compiled and linked from source and its binary added to the
+/// cache. Will implicitly load on the current context.</summary>
+/// <param name="programSource">The sources, attribute bindings and defines of the program</param>
+/// <param name="cache">The program binary cache. If NULL, or if the context does not support program binaries, the
+/// program is always built from source.</param>
+/// <param name="infolog">OPTIONAL Output, the infolog of the shader</param>
+/// <returns>The program object</returns>
+GLuint createShaderProgram(const ShaderProgramSource& programSource, ProgramBinaryCache* cache, std::string* infolog = NULL);
+
+/// <summary>Populates a ProgramBinaryCache in the background, so that the programs an application will need later (for
+/// example every define permutation of its materials) are already cached when it asks for them. The programs are
+/// built on a dedicated thread, using an EGL context shared with the application's, and deleted once their binary has
+/// been retrieved. Programs already in the cache are only loaded, which also primes the in-memory cache.</summary>
+/// <remarks>The application thread can keep creating programs from the same cache in the meantime: a program it asks
+/// for before the warmer has reached it is simply built from source on the application thread.</remarks>
+class ProgramBinaryCacheWarmer
+{
+public:
+	/// <summary>Constructor. Creates the shared context and starts the background thread.</summary>
+	/// <param name="context">The application's EGL context, which the background context will share objects with</param>
+	/// <param name="cache">The cache to populate. Must outlive this object.</param>
+	/// <param name="programs">The programs to build</param>
+	ProgramBinaryCacheWarmer(platform::EglContext_& context, ProgramBinaryCache& cache, std::vector<ShaderProgramSource> programs);
+
+	/// <summary>Destructor. Skips the programs that have not been started yet, then waits for the thread.</summary>
+	~ProgramBinaryCacheWarmer();
+
+	/// <summary>Query if all the programs have been processed.</summary>
+	/// <returns>True if the background thread has finished</returns>
+	bool isComplete() const { return _complete; }
+
+	/// <summary>Get the number of programs processed so far.</summary>
+	/// <returns>The number of programs processed so far</returns>
+	uint32_t getNumProcessed() const { return _numProcessed; }
+
+	/// <summary>Wait until all the programs have been processed.</summary>
+	void wait();
+
+private:
+	ProgramBinaryCacheWarmer(const ProgramBinaryCacheWarmer&) = delete;
+	ProgramBinaryCacheWarmer& operator=(const ProgramBinaryCacheWarmer&) = delete;
+
+	void run();
+
+	std::unique_ptr<platform::EglContext_> _sharedContext;
+	ProgramBinaryCache& _cache;
+	std::vector<ShaderProgramSource> _programs;
+	std::atomic<uint32_t> _numProcessed;
+	std::atomic<bool> _cancelled;
+	std::atomic<bool> _complete;
+	std::thread _thread;
+};
+
 /// <summary>Create a native shader program from a compute shader</summary>
 /// <param name="app">An AssetProvider to use for loading shaders from memory</param>
 /// <param name="compShaderFilename">The filename of a compute shader</param>
 /// <param name="defines">A list of defines to be added to the shaders</param>
 /// <param name="numDefines">The number of defines to be added to the shaders</param>
+/// <param name="cache">An optional program binary cache</param>
 /// <returns>The program object</returns>
-inline GLuint createComputeShaderProgram(IAssetProvider& app, const char* compShaderFilename, const char* const* defines = 0, uint32_t numDefines = 0)
+inline GLuint createComputeShaderProgram(IAssetProvider& app, const char* compShaderFilename, const char* const* defines = 0, uint32_t numDefines = 0, ProgramBinaryCache* cache = nullptr)
 {
+	if (cache)
+	{
+		ShaderProgramSource programSource;
+		programSource.addShader(app, pvr::ShaderType::ComputeShader, compShaderFilename).setDefines(defines, numDefines);
+		return createShaderProgram(programSource, cache);
+	}
+
 	GLuint shader = 0;
 	GLuint program = 0;
 
@@ -84,11 +267,25 @@ inline GLuint createComputeShaderProgram(IAssetProvider& app, const char* compSh
 /// <param name="numAttribs">Number of attributes in <paramref name="attribNames">attribNames</paramref> and <paramref name="attribIndices">attribIndices</paramref>.</param>
 /// <param name="defines">A list of defines to be added to the shaders</param>
 /// <param name="numDefines">The number of defines to be added to the shaders</param>
+/// <param name="cache">An optional program binary cache</param>
 /// <returns>The program object</returns>
 inline GLuint createShaderProgram(const IAssetProvider& app, const char* vertShaderFilename, const char* tessCtrlShaderFilename, const char* tessEvalShaderFilename,
 	const char* geometryShaderFilename, const char* fragShaderFilename, const char** attribNames, const uint16_t* attribIndices, uint32_t numAttribs,
-	const char* const* defines = 0, uint32_t numDefines = 0)
+	const char* const* defines = 0, uint32_t numDefines = 0, ProgramBinaryCache* cache = nullptr)
 {
+	if (cache)
+	{
+		ShaderProgramSource programSource;
+		programSource.addShader(app, pvr::ShaderType::VertexShader, vertShaderFilename)
+			.addShader(app, pvr::ShaderType::TessControlShader, tessCtrlShaderFilename)
+			.addShader(app, pvr::ShaderType::TessEvaluationShader, tessEvalShaderFilename)
+			.addShader(app, pvr::ShaderType::GeometryShader, geometryShaderFilename)
+			.addShader(app, pvr::ShaderType::FragmentShader, fragShaderFilename)
+			.setAttributes(attribNames, attribIndices, numAttribs)
+			.setDefines(defines, numDefines);
+		return createShaderProgram(programSource, cache);
+	}
+
 	GLuint shaders[6] = { 0 };
 	GLuint program = 0;
 	uint32_t count = 0;
@@ -139,11 +336,12 @@ inline GLuint createShaderProgram(const IAssetProvider& app, const char* vertSha
 /// <param name="numAttribs">Number of attributes in <paramref name="attribNames">attribNames</paramref> and <paramref name="attribIndices">attribIndices</paramref>.</param>
 /// <param name="defines">A list of defines to be added to the shaders</param>
 /// <param name="numDefines">The number of defines to be added to the shaders</param>
+/// <param name="cache">An optional program binary cache</param>
 /// <returns>The program object</returns>
 inline GLuint createShaderProgram(const IAssetProvider& app, const char* vertShaderFilename, const char* fragShaderFilename, const char** attribNames, const uint16_t* attribIndices,
-	uint32_t numAttribs, const char* const* defines = 0, uint32_t numDefines = 0)
+	uint32_t numAttribs, const char* const* defines = 0, uint32_t numDefines = 0, ProgramBinaryCache* cache = nullptr)
 {
-	return createShaderProgram(app, vertShaderFilename, nullptr, nullptr, nullptr, fragShaderFilename, attribNames, attribIndices, numAttribs, defines, numDefines);
+	return createShaderProgram(app, vertShaderFilename, nullptr, nullptr, nullptr, fragShaderFilename, attribNames, attribIndices, numAttribs, defines, numDefines, cache);
 }
 /// @endcond
 } // namespace utils
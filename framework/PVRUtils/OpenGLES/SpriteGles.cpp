@@ -112,11 +112,13 @@ void Image_::onRender(uint64_t parentId) const
 		_uiRenderer->_uiStateTracker.boundTextureChanged = true;
 	}
 
+	// Consecutive images share the vertex buffer and layout, and often the uniform values: let the cache filter those.
+	utils::GlStateCache& stateCache = _uiRenderer->_stateCache;
 #if !SC_ENABLED
 	if (_uiRenderer->getApiVersion() > Api::OpenGLES2)
 	{
 		_uiRenderer->_uiStateTracker.sampler7 = getSampler();
-		gl::BindSampler(7, getSampler());
+		stateCache.bindSampler(7, getSampler());
 		debugThrowOnApiError("Image_::onRender bind sampler");
 	}
 #endif
@@ -124,7 +126,7 @@ void Image_::onRender(uint64_t parentId) const
 	GLuint vbo = _uiRenderer->getImageVbo();
 	debugThrowOnApiError("Image_::onRender getImageVbo");
 	_uiRenderer->_uiStateTracker.vbo = vbo;
-	gl::BindBuffer(GL_ARRAY_BUFFER, vbo);
+	stateCache.bindBuffer(GL_ARRAY_BUFFER, vbo);
 	debugThrowOnApiError("Image_::onRender bind vbo");
 
 	_uiRenderer->_uiStateTracker.vertexAttribBindings[0] = 0;
@@ -134,7 +136,7 @@ void Image_::onRender(uint64_t parentId) const
 	_uiRenderer->_uiStateTracker.vertexAttribStride[0] = sizeof(float) * 6;
 	_uiRenderer->_uiStateTracker.vertexAttribOffset[0] = NULL;
 
-	gl::VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 6, NULL); // myVertex
+	stateCache.vertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 6, NULL); // myVertex
 	debugThrowOnApiError("Image_::onRender vertexattribptr 0");
 
 	_uiRenderer->_uiStateTracker.vertexAttribBindings[1] = 1;
@@ -144,16 +146,16 @@ void Image_::onRender(uint64_t parentId) const
 	_uiRenderer->_uiStateTracker.vertexAttribStride[1] = sizeof(float) * 6;
 	_uiRenderer->_uiStateTracker.vertexAttribOffset[1] = reinterpret_cast<GLvoid*>(sizeof(float) * 4);
 
-	gl::VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 6, reinterpret_cast<const void*>(sizeof(float) * 4)); // myUv
+	stateCache.vertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 6, reinterpret_cast<const void*>(sizeof(float) * 4)); // myUv
 	debugThrowOnApiError("Image_::onRender vertexattribptr 1");
 
-	gl::UniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformMVPmtx], 1, GL_FALSE, glm::value_ptr(_mvpData[parentId].mvp));
+	stateCache.uniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformMVPmtx], glm::value_ptr(_mvpData[parentId].mvp));
 	debugThrowOnApiError("Image_::onRender uniform 0");
-	gl::Uniform4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformColor], 1, glm::value_ptr(_color));
+	stateCache.uniform4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformColor], glm::value_ptr(_color));
 	debugThrowOnApiError("Image_::onRender uniform 1");
-	gl::Uniform1i(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformAlphaMode], _alphaMode);
+	stateCache.uniform1i(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformAlphaMode], _alphaMode);
 	debugThrowOnApiError("Image_::onRender uniform 2");
-	gl::UniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformUVmtx], 1, GL_FALSE,
+	stateCache.uniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformUVmtx],
 		glm::value_ptr(glm::translate(glm::vec3(_uv.x, _uv.y, 0.0f)) * glm::scale(glm::vec3(_uv.width, _uv.height, 1.0f))));
 	debugThrowOnApiError("Image_::onRender uniform 3");
 
@@ -182,7 +184,7 @@ Image_::Image_(make_shared_enabler, UIRenderer& uiRenderer, const GLuint& textur
 	if (_uiRenderer->getApiVersion() > Api::OpenGLES2 && _sampler != 0)
 	{
 		_sampler = useMipmaps ? uiRenderer.getSamplerTrilinear() : uiRenderer.getSamplerBilinear();
-		gl::BindSampler(7, _sampler);
+		_uiRenderer->_stateCache.bindSampler(7, _sampler);
 		_uiRenderer->_uiStateTracker.sampler7 = _sampler;
 	}
 #endif
@@ -289,7 +291,7 @@ Font_::Font_(make_shared_enabler, UIRenderer& uiRenderer, const GLuint& tex2D, c
 	if (uiRenderer.getApiVersion() > Api::OpenGLES2)
 	{
 		_sampler = (sampler != 0) ? sampler : uiRenderer.getSamplerBilinear();
-		gl::BindSampler(7, _sampler);
+		_uiRenderer->_stateCache.bindSampler(7, _sampler);
 		_uiRenderer->_uiStateTracker.sampler7 = static_cast<GLint>(_sampler);
 	}
 	else
@@ -441,10 +443,19 @@ void TextElement_::updateVbo() const
 		}
 		_uiRenderer->_uiStateTracker.vbo = _vbo;
 		gl::BindBuffer(GL_ARRAY_BUFFER, _vbo);
-		gl::BufferData(GL_ARRAY_BUFFER, (static_cast<uint32_t>(sizeof(Vertex) * _vertices.size())), _vertices.data(), GL_STATIC_DRAW);
+		// Text is typically updated every frame (counters, statistics), so reuse the buffer storage whenever the new text
+		// fits instead of reallocating it, and grow it geometrically when it does not.
+		const uint32_t size = static_cast<uint32_t>(sizeof(Vertex) * _vertices.size());
+		if (size > _vboSize)
+		{
+			_vboSize = std::max(size, _vboSize * 2);
+			gl::BufferData(GL_ARRAY_BUFFER, _vboSize, nullptr, GL_DYNAMIC_DRAW);
+		}
+		gl::BufferSubData(GL_ARRAY_BUFFER, 0, size, _vertices.data());
 
 		// rebind previous buffer so state remains the same
 		if (_uiRenderer->_uiStateTracker.vbo != _uiRenderer->_currentState.vbo) { gl::BindBuffer(GL_ARRAY_BUFFER, _uiRenderer->_currentState.vbo); }
+		_uiRenderer->_stateCache.invalidateBuffer(GL_ARRAY_BUFFER);
 	}
 	debugThrowOnApiError("TextElement_::updateVbo exit");
 }
@@ -455,8 +466,9 @@ void TextElement_::onRender() const
 	{
 		_uiRenderer->_uiStateTracker.vbo = _vbo;
 		_uiRenderer->_uiStateTracker.ibo = _uiRenderer->getFontIbo();
-		gl::BindBuffer(GL_ARRAY_BUFFER, _vbo);
-		gl::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, _uiRenderer->getFontIbo());
+		utils::GlStateCache& stateCache = _uiRenderer->_stateCache;
+		stateCache.bindBuffer(GL_ARRAY_BUFFER, _vbo);
+		stateCache.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _uiRenderer->getFontIbo());
 
 		_uiRenderer->_uiStateTracker.vertexAttribBindings[0] = 0;
 		_uiRenderer->_uiStateTracker.vertexAttribSizes[0] = 4;
@@ -465,7 +477,7 @@ void TextElement_::onRender() const
 		_uiRenderer->_uiStateTracker.vertexAttribStride[0] = sizeof(float) * 6;
 		_uiRenderer->_uiStateTracker.vertexAttribOffset[0] = NULL;
 
-		gl::VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 6, NULL); // myVertex
+		stateCache.vertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 6, NULL); // myVertex
 
 		_uiRenderer->_uiStateTracker.vertexAttribBindings[1] = 1;
 		_uiRenderer->_uiStateTracker.vertexAttribSizes[1] = 2;
@@ -474,7 +486,7 @@ void TextElement_::onRender() const
 		_uiRenderer->_uiStateTracker.vertexAttribStride[1] = sizeof(float) * 6;
 		_uiRenderer->_uiStateTracker.vertexAttribOffset[1] = reinterpret_cast<GLvoid*>(sizeof(float) * 4);
 
-		gl::VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 6, reinterpret_cast<const void*>(sizeof(float) * 4)); // myUv
+		stateCache.vertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 6, reinterpret_cast<const void*>(sizeof(float) * 4)); // myUv
 
 #if SC_ENABLED
 		gl::DrawRangeElements(GL_TRIANGLES, 0, _vertices.size()-1, (glm::min<int32_t>(_numCachedVerts, 0xFFFC) >> 1) * 3, GL_UNSIGNED_SHORT, 0);
@@ -540,15 +552,16 @@ void Text_::calculateMvp(uint64_t parentIds, glm::mat4 const& srt, const glm::ma
 
 void Text_::onRender(uint64_t parentId) const
 {
+	utils::GlStateCache& stateCache = _uiRenderer->_stateCache;
 #if !SC_ENABLED
 	if (_uiRenderer->getApiVersion() > Api::OpenGLES2)
 	{
 		if (static_cast<GLuint>(_uiRenderer->_uiStateTracker.sampler7) != getFont()->getSampler())
 		{
-			gl::BindSampler(7, getFont()->getSampler());
 			_uiRenderer->_uiStateTracker.sampler7 = getFont()->getSampler();
 			_uiRenderer->_uiStateTracker.sampler7Changed = true;
 		}
+		stateCache.bindSampler(7, getFont()->getSampler());
 	}
 #endif
 	if (_uiRenderer->_uiStateTracker.activeTextureUnit != GL_TEXTURE7)
@@ -565,10 +578,10 @@ void Text_::onRender(uint64_t parentId) const
 		_uiRenderer->_uiStateTracker.boundTextureChanged = true;
 	}
 
-	gl::UniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformMVPmtx], 1, GL_FALSE, glm::value_ptr(_mvpData[parentId].mvp));
-	gl::Uniform4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformColor], 1, glm::value_ptr(_color));
-	gl::Uniform1i(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformAlphaMode], _alphaMode);
-	gl::UniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformUVmtx], 1, GL_FALSE, glm::value_ptr(mat4(1.)));
+	stateCache.uniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformMVPmtx], glm::value_ptr(_mvpData[parentId].mvp));
+	stateCache.uniform4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformColor], glm::value_ptr(_color));
+	stateCache.uniform1i(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformAlphaMode], _alphaMode);
+	stateCache.uniformMatrix4fv(_uiRenderer->getProgramData().uniforms[UIRenderer::ProgramData::UniformUVmtx], glm::value_ptr(mat4(1.)));
 
 	_textElement->onRender();
 }
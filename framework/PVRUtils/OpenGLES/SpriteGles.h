@@ -754,7 +754,7 @@ public:
 	/// <param name="uiRenderer">The UIRenderer to use when creating the Font.</param>
 	/// <param name="font">The font to use for the text element.</param>
 	TextElement_(make_shared_enabler, UIRenderer& uiRenderer, const Font& font)
-		: _isUtf8(false), _isTextDirty(false), _font(font), _vbo(static_cast<GLuint>(-1)), _vboCreated(false), _uiRenderer(&uiRenderer)
+		: _isUtf8(false), _isTextDirty(false), _font(font), _vbo(static_cast<GLuint>(-1)), _vboCreated(false), _vboSize(0), _uiRenderer(&uiRenderer)
 	{}
 
 	/// <summary>Constructor for a Text element. Do not use - use the UIRenderer::createTextElement</summary>
@@ -762,7 +762,7 @@ public:
 	/// <param name="str">The Text string to use for the text element.</param>
 	/// <param name="font">The font to use for the text element.</param>
 	TextElement_(make_shared_enabler, UIRenderer& uiRenderer, const std::string& str, const Font& font)
-		: _font(font), _vbo(static_cast<GLuint>(-1)), _vboCreated(false), _uiRenderer(&uiRenderer)
+		: _font(font), _vbo(static_cast<GLuint>(-1)), _vboCreated(false), _vboSize(0), _uiRenderer(&uiRenderer)
 	{
 		setText(str);
 		updateText();
@@ -773,7 +773,7 @@ public:
 	/// <param name="str">The Text string to use for the text element.</param>
 	/// <param name="font">The font to use for the text element.</param>
 	TextElement_(make_shared_enabler, UIRenderer& uiRenderer, const std::wstring& str, const Font& font)
-		: _font(font), _vbo(static_cast<uint32_t>(-1)), _vboCreated(false), _uiRenderer(&uiRenderer)
+		: _font(font), _vbo(static_cast<uint32_t>(-1)), _vboCreated(false), _vboSize(0), _uiRenderer(&uiRenderer)
 	{
 		setText(str);
 		updateText();
@@ -0,0 +1,358 @@
+/*!
+\brief Implementation of the GlStateCache.
+\file PVRUtils/OpenGLES/StateCacheGles.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/OpenGLES/StateCacheGles.h"
+#include <cstring>
+
+namespace pvr {
+namespace utils {
+namespace {
+const uint32_t ElementArrayBufferIndex = 1;
+
+inline uint64_t getUniformKey(GLuint program, GLint location) { return (static_cast<uint64_t>(program) << 32) | static_cast<uint32_t>(location); }
+} // namespace
+
+int32_t GlStateCache::getBufferTargetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: return 0;
+	case GL_ELEMENT_ARRAY_BUFFER: return ElementArrayBufferIndex;
+#if !SC_ENABLED
+	case GL_UNIFORM_BUFFER: return 2;
+	case GL_COPY_READ_BUFFER: return 3;
+	case GL_COPY_WRITE_BUFFER: return 4;
+	case GL_PIXEL_UNPACK_BUFFER: return 5;
+	case GL_PIXEL_PACK_BUFFER: return 6;
+	case GL_TRANSFORM_FEEDBACK_BUFFER: return 7;
+#endif
+	default: return -1;
+	}
+}
+
+int32_t GlStateCache::getTextureTargetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D: return 0;
+#if !SC_ENABLED
+	case GL_TEXTURE_CUBE_MAP: return 1;
+	case GL_TEXTURE_3D: return 2;
+	case GL_TEXTURE_2D_ARRAY: return 3;
+#endif
+	default: return -1;
+	}
+}
+
+int32_t GlStateCache::getCapabilityIndex(GLenum capability)
+{
+	switch (capability)
+	{
+	case GL_BLEND: return 0;
+	case GL_CULL_FACE: return 1;
+	case GL_DEPTH_TEST: return 2;
+	case GL_STENCIL_TEST: return 3;
+	case GL_SCISSOR_TEST: return 4;
+	case GL_POLYGON_OFFSET_FILL: return 5;
+	default: return -1;
+	}
+}
+
+void GlStateCache::invalidate()
+{
+	_programKnown = false;
+	_activeTextureKnown = false;
+	_activeTexture = GL_TEXTURE0;
+	memset(_texturesKnown, 0, sizeof(_texturesKnown));
+	memset(_samplersKnown, 0, sizeof(_samplersKnown));
+	memset(_buffersKnown, 0, sizeof(_buffersKnown));
+	_vertexArrayKnown = false;
+	_indexedBindings.clear();
+	invalidateVertexArrayState();
+
+	memset(_capabilitiesKnown, 0, sizeof(_capabilitiesKnown));
+	_blendFuncKnown = false;
+	_blendEquationKnown = false;
+	_colorMaskKnown = false;
+	_depthMaskKnown = false;
+	_depthFuncKnown = false;
+	_cullFaceKnown = false;
+	_frontFaceKnown = false;
+}
+
+void GlStateCache::invalidateVertexArrayState()
+{
+	_buffersKnown[ElementArrayBufferIndex] = false;
+	for (VertexAttribute& attribute : _attributes)
+	{
+		attribute.enabledKnown = false;
+		attribute.pointerKnown = false;
+	}
+}
+
+void GlStateCache::invalidateUniforms(GLuint program)
+{
+	for (auto it = _uniforms.begin(); it != _uniforms.end();)
+	{
+		if (static_cast<GLuint>(it->first >> 32) == program) { it = _uniforms.erase(it); }
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void GlStateCache::invalidateBuffer(GLenum target)
+{
+	const int32_t index = getBufferTargetIndex(target);
+	if (index >= 0) { _buffersKnown[index] = false; }
+}
+
+void GlStateCache::useProgram(GLuint program)
+{
+	if (update(_programKnown, _program, program)) { gl::UseProgram(program); }
+}
+
+void GlStateCache::activeTexture(GLenum textureUnit)
+{
+	if (update(_activeTextureKnown, _activeTexture, textureUnit)) { gl::ActiveTexture(textureUnit); }
+}
+
+void GlStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	const int32_t targetIndex = getTextureTargetIndex(target);
+	const uint32_t unit = _activeTexture - GL_TEXTURE0;
+	if (targetIndex < 0 || !_activeTextureKnown || unit >= MaxTextureUnits)
+	{
+		++_statistics.forwarded;
+		gl::BindTexture(target, texture);
+		return;
+	}
+	if (update(_texturesKnown[unit][targetIndex], _textures[unit][targetIndex], texture)) { gl::BindTexture(target, texture); }
+}
+
+void GlStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	const int32_t index = getBufferTargetIndex(target);
+	if (index < 0)
+	{
+		++_statistics.forwarded;
+		gl::BindBuffer(target, buffer);
+		return;
+	}
+	if (update(_buffersKnown[index], _buffers[index], buffer)) { gl::BindBuffer(target, buffer); }
+}
+
+void GlStateCache::setEnabled(GLenum capability, bool enabled)
+{
+	const int32_t index = getCapabilityIndex(capability);
+	if (index < 0 || update(_capabilitiesKnown[index], _capabilities[index], enabled))
+	{
+		if (index < 0) { ++_statistics.forwarded; }
+		enabled ? gl::Enable(capability) : gl::Disable(capability);
+	}
+}
+
+void GlStateCache::blendFuncSeparate(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha)
+{
+	const GLenum blendFunc[] = { srcRgb, dstRgb, srcAlpha, dstAlpha };
+	if (_blendFuncKnown && !memcmp(_blendFunc, blendFunc, sizeof(blendFunc)))
+	{
+		++_statistics.skipped;
+		return;
+	}
+	++_statistics.forwarded;
+	_blendFuncKnown = true;
+	memcpy(_blendFunc, blendFunc, sizeof(blendFunc));
+	gl::BlendFuncSeparate(srcRgb, dstRgb, srcAlpha, dstAlpha);
+}
+
+void GlStateCache::blendEquationSeparate(GLenum modeRgb, GLenum modeAlpha)
+{
+	if (_blendEquationKnown && _blendEquation[0] == modeRgb && _blendEquation[1] == modeAlpha)
+	{
+		++_statistics.skipped;
+		return;
+	}
+	++_statistics.forwarded;
+	_blendEquationKnown = true;
+	_blendEquation[0] = modeRgb;
+	_blendEquation[1] = modeAlpha;
+	gl::BlendEquationSeparate(modeRgb, modeAlpha);
+}
+
+void GlStateCache::colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+	const GLboolean mask[] = { red, green, blue, alpha };
+	if (_colorMaskKnown && !memcmp(_colorMask, mask, sizeof(mask)))
+	{
+		++_statistics.skipped;
+		return;
+	}
+	++_statistics.forwarded;
+	_colorMaskKnown = true;
+	memcpy(_colorMask, mask, sizeof(mask));
+	gl::ColorMask(red, green, blue, alpha);
+}
+
+void GlStateCache::depthMask(GLboolean enabled)
+{
+	if (update(_depthMaskKnown, _depthMask, enabled)) { gl::DepthMask(enabled); }
+}
+
+void GlStateCache::depthFunc(GLenum func)
+{
+	if (update(_depthFuncKnown, _depthFunc, func)) { gl::DepthFunc(func); }
+}
+
+void GlStateCache::cullFace(GLenum mode)
+{
+	if (update(_cullFaceKnown, _cullFace, mode)) { gl::CullFace(mode); }
+}
+
+void GlStateCache::frontFace(GLenum mode)
+{
+	if (update(_frontFaceKnown, _frontFace, mode)) { gl::FrontFace(mode); }
+}
+
+void GlStateCache::setVertexAttribArrayEnabled(GLuint index, bool enabled)
+{
+	if (index >= MaxVertexAttributes || update(_attributes[index].enabledKnown, _attributes[index].enabled, enabled))
+	{
+		if (index >= MaxVertexAttributes) { ++_statistics.forwarded; }
+		enabled ? gl::EnableVertexAttribArray(index) : gl::DisableVertexAttribArray(index);
+	}
+}
+
+void GlStateCache::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+	// The attribute captures the buffer bound to GL_ARRAY_BUFFER, so the call is only redundant if that is known.
+	const bool arrayBufferKnown = _buffersKnown[0];
+	if (index < MaxVertexAttributes && arrayBufferKnown)
+	{
+		VertexAttribute& attribute = _attributes[index];
+		if (attribute.pointerKnown && attribute.buffer == _buffers[0] && attribute.size == size && attribute.type == type && attribute.normalized == normalized &&
+			attribute.stride == stride && attribute.pointer == pointer)
+		{
+			++_statistics.skipped;
+			return;
+		}
+		attribute.pointerKnown = true;
+		attribute.buffer = _buffers[0];
+		attribute.size = size;
+		attribute.type = type;
+		attribute.normalized = normalized;
+		attribute.stride = stride;
+		attribute.pointer = pointer;
+	}
+	else if (index < MaxVertexAttributes)
+	{
+		_attributes[index].pointerKnown = false;
+	}
+	++_statistics.forwarded;
+	gl::VertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void GlStateCache::setUniform(GLint location, UniformType type, const void* data, uint32_t size)
+{
+	if (location < 0) { return; }
+	if (!_programKnown)
+	{
+		// Uniforms are set on the current program, so they can only be cached once it is known.
+		++_statistics.forwarded;
+		forwardUniform(location, type, data);
+		return;
+	}
+	CachedUniform& cached = _uniforms[getUniformKey(_program, location)];
+	if (cached.size == size && cached.type == type && !memcmp(cached.data, data, size))
+	{
+		++_statistics.skipped;
+		return;
+	}
+	cached.type = type;
+	cached.size = size;
+	memcpy(cached.data, data, size);
+	++_statistics.forwarded;
+	forwardUniform(location, type, data);
+}
+
+void GlStateCache::forwardUniform(GLint location, UniformType type, const void* data)
+{
+	switch (type)
+	{
+	case UniformType::Int: gl::Uniform1i(location, *static_cast<const GLint*>(data)); break;
+	case UniformType::Float: gl::Uniform1f(location, *static_cast<const GLfloat*>(data)); break;
+	case UniformType::Vec4: gl::Uniform4fv(location, 1, static_cast<const GLfloat*>(data)); break;
+	case UniformType::Mat4: gl::UniformMatrix4fv(location, 1, GL_FALSE, static_cast<const GLfloat*>(data)); break;
+	}
+}
+
+#if !SC_ENABLED
+void GlStateCache::bindSampler(GLuint unit, GLuint sampler)
+{
+	if (unit >= MaxTextureUnits)
+	{
+		++_statistics.forwarded;
+		gl::BindSampler(unit, sampler);
+		return;
+	}
+	if (update(_samplersKnown[unit], _samplers[unit], sampler)) { gl::BindSampler(unit, sampler); }
+}
+
+void GlStateCache::bindVertexArray(GLuint vertexArray)
+{
+	if (!update(_vertexArrayKnown, _vertexArray, vertexArray)) { return; }
+	// The element array buffer and the vertex attributes are part of the vertex array object.
+	invalidateVertexArrayState();
+	if (_api > Api::OpenGLES2) { gl::BindVertexArray(vertexArray); }
+	else
+	{
+		gl::ext::BindVertexArrayOES(vertexArray);
+	}
+}
+
+void GlStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	IndexedBinding* binding = nullptr;
+	for (IndexedBinding& indexedBinding : _indexedBindings)
+	{
+		if (indexedBinding.target == target && indexedBinding.index == index)
+		{
+			binding = &indexedBinding;
+			break;
+		}
+	}
+	if (binding && binding->buffer == buffer && binding->offset == offset && binding->size == size)
+	{
+		++_statistics.skipped;
+		return;
+	}
+	if (!binding)
+	{
+		_indexedBindings.push_back(IndexedBinding());
+		binding = &_indexedBindings.back();
+		binding->target = target;
+		binding->index = index;
+	}
+	binding->buffer = buffer;
+	binding->offset = offset;
+	binding->size = size;
+
+	// glBindBufferRange also binds the buffer to the generic binding point of the target.
+	const int32_t targetIndex = getBufferTargetIndex(target);
+	if (targetIndex >= 0)
+	{
+		_buffersKnown[targetIndex] = true;
+		_buffers[targetIndex] = buffer;
+	}
+	++_statistics.forwarded;
+	gl::BindBufferRange(target, index, buffer, offset, size);
+}
+#endif
+} // namespace utils
+} // namespace pvr
+//!\endcond
@@ -0,0 +1,305 @@
+/*!
+\brief Contains the GlStateCache, a shadow of the OpenGL ES state that filters out redundant state changes and uniform updates.
+\file PVRUtils/OpenGLES/StateCacheGles.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#if SC_ENABLED
+#include "PVRUtils/OpenGLSC/BindingsGlsc.h"
+#else
+#include "PVRUtils/OpenGLES/BindingsGles.h"
+#endif
+#include "PVRCore/types/Types.h"
+#include <unordered_map>
+#include <vector>
+
+namespace pvr {
+namespace utils {
+/// <summary>Keeps a shadow copy of the OpenGL ES state it is used to set, and only forwards the calls that actually change
+/// it. Binds, enables, blend, depth and rasterizer state, vertex attribute setup and uniform values all go through the
+/// cache, so code that sets up its state per draw (for example per sprite) only pays for what differs from the previous draw.</summary>
+/// <remarks>The cache only knows about the state set through it. Whenever other code may have touched the OpenGL ES
+/// state (at the start of a frame, or after calling into the application or a third party library), call invalidate():
+/// the next call for each state is then always forwarded. Uniform values belong to programs rather than to the context,
+/// so they survive invalidate() but must be dropped with invalidateUniforms() when a program is relinked or deleted, or
+/// when its uniforms are set without going through the cache. Element array buffer and vertex attribute state is tracked
+/// for the currently bound vertex array object only, and is forgotten whenever a different one is bound.</remarks>
+class GlStateCache
+{
+public:
+	/// <summary>Counters of the calls that went through the cache.</summary>
+	struct Statistics
+	{
+		uint32_t forwarded; //!< The number of calls forwarded to OpenGL ES
+		uint32_t skipped; //!< The number of redundant calls filtered out
+	};
+
+	/// <summary>The number of texture units tracked. Binds to higher units are always forwarded.</summary>
+	static const uint32_t MaxTextureUnits = 16;
+	/// <summary>The number of vertex attributes tracked. Calls for higher attributes are always forwarded.</summary>
+	static const uint32_t MaxVertexAttributes = 16;
+
+	/// <summary>Constructor. Every state starts as unknown.</summary>
+	/// <param name="api">The OpenGL ES version of the context. Determines how vertex array objects are bound.</param>
+	explicit GlStateCache(Api api = Api::OpenGLES3) : _api(api) { invalidate(); resetStatistics(); }
+
+	/// <summary>Set the OpenGL ES version of the context.</summary>
+	/// <param name="api">The OpenGL ES version of the context</param>
+	void setApi(Api api) { _api = api; }
+
+	/// <summary>Forget all the context state (bindings, enables, fixed function and vertex attribute state), so the next
+	/// call for each of them is forwarded. Cached uniform values are kept.</summary>
+	void invalidate();
+
+	/// <summary>Forget the cached uniform values of a program.</summary>
+	/// <param name="program">The program. Must be called before a program is relinked or deleted.</param>
+	void invalidateUniforms(GLuint program);
+
+	/// <summary>Forget the cached uniform values of all programs.</summary>
+	void invalidateAllUniforms() { _uniforms.clear(); }
+
+	/// <summary>Forget the binding of a buffer target, for example after binding a buffer directly through OpenGL ES.</summary>
+	/// <param name="target">The buffer target</param>
+	void invalidateBuffer(GLenum target);
+
+	/// <summary>Get the counters of forwarded and skipped calls.</summary>
+	/// <returns>The statistics</returns>
+	const Statistics& getStatistics() const { return _statistics; }
+
+	/// <summary>Reset the counters of forwarded and skipped calls, typically once per frame.</summary>
+	void resetStatistics()
+	{
+		_statistics.forwarded = 0;
+		_statistics.skipped = 0;
+	}
+
+	/// <summary>glUseProgram</summary>
+	/// <param name="program">The program</param>
+	void useProgram(GLuint program);
+
+	/// <summary>glActiveTexture</summary>
+	/// <param name="textureUnit">The texture unit, GL_TEXTURE0 + i</param>
+	void activeTexture(GLenum textureUnit);
+
+	/// <summary>glBindTexture on the active texture unit.</summary>
+	/// <param name="target">GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D or GL_TEXTURE_2D_ARRAY</param>
+	/// <param name="texture">The texture</param>
+	void bindTexture(GLenum target, GLuint texture);
+
+	/// <summary>Make a texture unit active and bind a texture to it.</summary>
+	/// <param name="unit">The index of the texture unit (not GL_TEXTURE0 + i)</param>
+	/// <param name="target">The texture target</param>
+	/// <param name="texture">The texture</param>
+	void bindTexture(uint32_t unit, GLenum target, GLuint texture)
+	{
+		activeTexture(GL_TEXTURE0 + unit);
+		bindTexture(target, texture);
+	}
+
+	/// <summary>glBindBuffer</summary>
+	/// <param name="target">The buffer target</param>
+	/// <param name="buffer">The buffer</param>
+	void bindBuffer(GLenum target, GLuint buffer);
+
+	/// <summary>glEnable / glDisable</summary>
+	/// <param name="capability">GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_STENCIL_TEST, GL_SCISSOR_TEST or GL_POLYGON_OFFSET_FILL.
+	/// Other capabilities are always forwarded.</param>
+	/// <param name="enabled">Whether to enable or disable the capability</param>
+	void setEnabled(GLenum capability, bool enabled);
+
+	/// <summary>glBlendFuncSeparate</summary>
+	/// <param name="srcRgb">The source RGB factor</param>
+	/// <param name="dstRgb">The destination RGB factor</param>
+	/// <param name="srcAlpha">The source alpha factor</param>
+	/// <param name="dstAlpha">The destination alpha factor</param>
+	void blendFuncSeparate(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha);
+
+	/// <summary>glBlendEquationSeparate</summary>
+	/// <param name="modeRgb">The RGB blend equation</param>
+	/// <param name="modeAlpha">The alpha blend equation</param>
+	void blendEquationSeparate(GLenum modeRgb, GLenum modeAlpha);
+
+	/// <summary>glColorMask</summary>
+	/// <param name="red">Write red</param>
+	/// <param name="green">Write green</param>
+	/// <param name="blue">Write blue</param>
+	/// <param name="alpha">Write alpha</param>
+	void colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+
+	/// <summary>glDepthMask</summary>
+	/// <param name="enabled">Write depth</param>
+	void depthMask(GLboolean enabled);
+
+	/// <summary>glDepthFunc</summary>
+	/// <param name="func">The depth comparison function</param>
+	void depthFunc(GLenum func);
+
+	/// <summary>glCullFace</summary>
+	/// <param name="mode">The faces to cull</param>
+	void cullFace(GLenum mode);
+
+	/// <summary>glFrontFace</summary>
+	/// <param name="mode">The winding order of front faces</param>
+	void frontFace(GLenum mode);
+
+	/// <summary>glEnableVertexAttribArray / glDisableVertexAttribArray</summary>
+	/// <param name="index">The vertex attribute</param>
+	/// <param name="enabled">Whether to enable or disable the attribute array</param>
+	void setVertexAttribArrayEnabled(GLuint index, bool enabled);
+
+	/// <summary>glVertexAttribPointer. Redundant only if the same buffer is bound to GL_ARRAY_BUFFER as when the
+	/// attribute was last set.</summary>
+	/// <param name="index">The vertex attribute</param>
+	/// <param name="size">The number of components</param>
+	/// <param name="type">The component type</param>
+	/// <param name="normalized">Whether fixed point components are normalized</param>
+	/// <param name="stride">The stride in bytes</param>
+	/// <param name="pointer">The offset into the bound GL_ARRAY_BUFFER</param>
+	void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+
+	/// <summary>glUniform1i on the current program.</summary>
+	/// <param name="location">The uniform location. -1 is ignored.</param>
+	/// <param name="value">The value</param>
+	void uniform1i(GLint location, GLint value) { setUniform(location, UniformType::Int, &value, sizeof(value)); }
+
+	/// <summary>glUniform1f on the current program.</summary>
+	/// <param name="location">The uniform location. -1 is ignored.</param>
+	/// <param name="value">The value</param>
+	void uniform1f(GLint location, GLfloat value) { setUniform(location, UniformType::Float, &value, sizeof(value)); }
+
+	/// <summary>glUniform4fv of a single vec4 on the current program.</summary>
+	/// <param name="location">The uniform location. -1 is ignored.</param>
+	/// <param name="value">The 4 components</param>
+	void uniform4fv(GLint location, const GLfloat* value) { setUniform(location, UniformType::Vec4, value, sizeof(GLfloat) * 4); }
+
+	/// <summary>glUniformMatrix4fv of a single, non transposed mat4 on the current program.</summary>
+	/// <param name="location">The uniform location. -1 is ignored.</param>
+	/// <param name="value">The 16 components, column major</param>
+	void uniformMatrix4fv(GLint location, const GLfloat* value) { setUniform(location, UniformType::Mat4, value, sizeof(GLfloat) * 16); }
+
+#if !SC_ENABLED
+	/// <summary>glBindSampler. OpenGL ES 3.0 and above.</summary>
+	/// <param name="unit">The index of the texture unit</param>
+	/// <param name="sampler">The sampler</param>
+	void bindSampler(GLuint unit, GLuint sampler);
+
+	/// <summary>glBindVertexArray (glBindVertexArrayOES on OpenGL ES 2.0). Forgets the element array buffer and vertex
+	/// attribute state when the vertex array object changes.</summary>
+	/// <param name="vertexArray">The vertex array object</param>
+	void bindVertexArray(GLuint vertexArray);
+
+	/// <summary>glBindBufferRange. OpenGL ES 3.0 and above. Also updates the generic binding of the target, as
+	/// glBindBufferRange does.</summary>
+	/// <param name="target">GL_UNIFORM_BUFFER, GL_TRANSFORM_FEEDBACK_BUFFER, GL_SHADER_STORAGE_BUFFER or GL_ATOMIC_COUNTER_BUFFER</param>
+	/// <param name="index">The binding point</param>
+	/// <param name="buffer">The buffer</param>
+	/// <param name="offset">The offset of the range in bytes</param>
+	/// <param name="size">The size of the range in bytes</param>
+	void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+#endif
+
+private:
+	enum class UniformType : uint8_t
+	{
+		Int,
+		Float,
+		Vec4,
+		Mat4
+	};
+
+	struct CachedUniform
+	{
+		UniformType type;
+		uint32_t size;
+		uint32_t data[16];
+	};
+
+	struct VertexAttribute
+	{
+		bool enabledKnown;
+		bool enabled;
+		bool pointerKnown;
+		GLuint buffer;
+		GLint size;
+		GLenum type;
+		GLboolean normalized;
+		GLsizei stride;
+		const void* pointer;
+	};
+
+	struct IndexedBinding
+	{
+		GLenum target;
+		GLuint index;
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	// Returns true if the call must be forwarded, and records the new value. Counts the call either way.
+	template<typename T>
+	bool update(bool& known, T& cached, const T& value)
+	{
+		if (known && cached == value)
+		{
+			++_statistics.skipped;
+			return false;
+		}
+		known = true;
+		cached = value;
+		++_statistics.forwarded;
+		return true;
+	}
+
+	static int32_t getBufferTargetIndex(GLenum target);
+	static int32_t getTextureTargetIndex(GLenum target);
+	static int32_t getCapabilityIndex(GLenum capability);
+	void invalidateVertexArrayState();
+	void setUniform(GLint location, UniformType type, const void* data, uint32_t size);
+	void forwardUniform(GLint location, UniformType type, const void* data);
+
+	static const uint32_t NumBufferTargets = 8;
+	static const uint32_t NumTextureTargets = 4;
+	static const uint32_t NumCapabilities = 6;
+
+	Api _api;
+	Statistics _statistics;
+
+	bool _programKnown;
+	GLuint _program;
+	bool _activeTextureKnown;
+	GLenum _activeTexture;
+	bool _texturesKnown[MaxTextureUnits][NumTextureTargets];
+	GLuint _textures[MaxTextureUnits][NumTextureTargets];
+	bool _samplersKnown[MaxTextureUnits];
+	GLuint _samplers[MaxTextureUnits];
+	bool _buffersKnown[NumBufferTargets];
+	GLuint _buffers[NumBufferTargets];
+	bool _vertexArrayKnown;
+	GLuint _vertexArray;
+	std::vector<IndexedBinding> _indexedBindings;
+	VertexAttribute _attributes[MaxVertexAttributes];
+
+	bool _capabilitiesKnown[NumCapabilities];
+	bool _capabilities[NumCapabilities];
+	bool _blendFuncKnown;
+	GLenum _blendFunc[4];
+	bool _blendEquationKnown;
+	GLenum _blendEquation[2];
+	bool _colorMaskKnown;
+	GLboolean _colorMask[4];
+	bool _depthMaskKnown;
+	GLboolean _depthMask;
+	bool _depthFuncKnown;
+	GLenum _depthFunc;
+	bool _cullFaceKnown;
+	GLenum _cullFace;
+	bool _frontFaceKnown;
+	GLenum _frontFace;
+
+	// Keyed by program << 32 | location.
+	std::unordered_map<uint64_t, CachedUniform> _uniforms;
+};
+} // namespace utils
+} // namespace pvr
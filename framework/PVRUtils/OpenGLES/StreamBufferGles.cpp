@@ -0,0 +1,171 @@
+/*!
+\brief Implementation of the GlStreamBuffer.
+\file PVRUtils/OpenGLES/StreamBufferGles.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/OpenGLES/StreamBufferGles.h"
+#include "PVRUtils/OpenGLES/HelperGles.h"
+#include "PVRUtils/OpenGLES/ErrorsGles.h"
+#include <cstring>
+
+namespace pvr {
+namespace utils {
+namespace {
+inline GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment) { return ((value + alignment - 1) / alignment) * alignment; }
+} // namespace
+
+void GlStreamBuffer::init(GLenum target, GLsizeiptr segmentSize, uint32_t numFramesInFlight, GLsizeiptr alignment, GlStateCache* stateCache)
+{
+	release();
+	if (segmentSize <= 0 || !numFramesInFlight) { throw InvalidArgumentError("segmentSize, numFramesInFlight", "GlStreamBuffer: The segment size and number of frames in flight must not be zero"); }
+	_api = getCurrentGlesVersion();
+	_stateCache = stateCache;
+	_target = target;
+
+	if (!alignment)
+	{
+		alignment = 16;
+		if (target == GL_UNIFORM_BUFFER && _api > Api::OpenGLES2)
+		{
+			GLint uniformAlignment = 0;
+			gl::GetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+			alignment = std::max<GLsizeiptr>(alignment, uniformAlignment);
+		}
+	}
+	_alignment = alignment;
+	_segmentSize = alignUp(segmentSize, _alignment);
+	_numSegments = numFramesInFlight;
+	// So that the first beginFrame() starts with the first segment.
+	_currentSegment = _numSegments - 1;
+	_offset = 0;
+	_isInFrame = false;
+
+	gl::GenBuffers(1, &_buffer);
+	bind();
+	gl::BufferData(_target, _segmentSize * _numSegments, nullptr, GL_STREAM_DRAW);
+	debugThrowOnApiError("GlStreamBuffer::init create buffer");
+
+	if (usesFences()) { _fences.assign(_numSegments, nullptr); }
+	else
+	{
+		_staging.resize(static_cast<size_t>(_segmentSize));
+	}
+}
+
+void GlStreamBuffer::release()
+{
+	if (!_buffer) { return; }
+	for (GLsync fence : _fences)
+	{
+		if (fence) { gl::DeleteSync(fence); }
+	}
+	_fences.clear();
+	_staging.clear();
+	gl::DeleteBuffers(1, &_buffer);
+	if (_stateCache) { _stateCache->invalidateBuffer(_target); }
+	_buffer = 0;
+	_stateCache = nullptr;
+	_segmentSize = 0;
+	_offset = 0;
+	_mappedOffset = -1;
+	_isInFrame = false;
+}
+
+void GlStreamBuffer::bind()
+{
+	if (_stateCache) { _stateCache->bindBuffer(_target, _buffer); }
+	else
+	{
+		gl::BindBuffer(_target, _buffer);
+	}
+}
+
+void GlStreamBuffer::beginFrame()
+{
+	if (_isInFrame) { throw InvalidOperationError("GlStreamBuffer::beginFrame: endFrame was not called for the previous frame"); }
+	_currentSegment = (_currentSegment + 1) % _numSegments;
+
+	if (usesFences() && _fences[_currentSegment])
+	{
+		// The fence was inserted numFramesInFlight frames ago, so this normally returns immediately.
+		GLenum result;
+		do
+		{
+			result = gl::ClientWaitSync(_fences[_currentSegment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+		} while (result == GL_TIMEOUT_EXPIRED);
+		gl::DeleteSync(_fences[_currentSegment]);
+		_fences[_currentSegment] = nullptr;
+		if (result == GL_WAIT_FAILED) { throw OperationFailedError("GlStreamBuffer::beginFrame: Waiting for the fence of the segment failed"); }
+	}
+	_offset = 0;
+	_isInFrame = true;
+}
+
+void GlStreamBuffer::endFrame()
+{
+	if (!_isInFrame) { throw InvalidOperationError("GlStreamBuffer::endFrame: beginFrame was not called"); }
+	if (_mappedOffset >= 0) { unmap(); }
+	if (usesFences()) { _fences[_currentSegment] = gl::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); }
+	_isInFrame = false;
+}
+
+void* GlStreamBuffer::map(GLsizeiptr size, GLintptr& outOffset)
+{
+	if (!_isInFrame) { throw InvalidOperationError("GlStreamBuffer::map: Must be called between beginFrame and endFrame"); }
+	if (_mappedOffset >= 0) { throw InvalidOperationError("GlStreamBuffer::map: The previous allocation is still mapped"); }
+	if (_offset + size > _segmentSize)
+	{
+		throw OperationFailedError(strings::createFormatted("GlStreamBuffer::map: Allocating %lld bytes exceeds the %lld bytes left in the segment of the frame", static_cast<long long>(size),
+			static_cast<long long>(_segmentSize - _offset)));
+	}
+
+	const GLintptr segmentOffset = static_cast<GLintptr>(_currentSegment) * _segmentSize;
+	outOffset = segmentOffset + _offset;
+	void* data;
+	if (usesFences())
+	{
+		bind();
+		// Unsynchronized: the fence waited for in beginFrame() guarantees that the GPU no longer reads this range.
+		data = gl::MapBufferRange(_target, outOffset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (!data) { throw OperationFailedError("GlStreamBuffer::map: glMapBufferRange failed"); }
+	}
+	else
+	{
+		data = _staging.data() + _offset;
+	}
+	_mappedOffset = outOffset;
+	_mappedSize = size;
+	_offset = std::min(_segmentSize, alignUp(_offset + size, _alignment));
+	return data;
+}
+
+void GlStreamBuffer::unmap()
+{
+	if (_mappedOffset < 0) { return; }
+	bind();
+	if (usesFences())
+	{
+		if (gl::UnmapBuffer(_target) == GL_FALSE) { Log(LogLevel::Warning, "GlStreamBuffer::unmap: The buffer contents were corrupted while mapped."); }
+	}
+	else
+	{
+		const GLintptr segmentOffset = static_cast<GLintptr>(_currentSegment) * _segmentSize;
+		gl::BufferSubData(_target, _mappedOffset, _mappedSize, _staging.data() + (_mappedOffset - segmentOffset));
+	}
+	debugThrowOnApiError("GlStreamBuffer::unmap");
+	_mappedOffset = -1;
+	_mappedSize = 0;
+}
+
+GLintptr GlStreamBuffer::write(const void* data, GLsizeiptr size)
+{
+	GLintptr offset;
+	memcpy(map(size, offset), data, static_cast<size_t>(size));
+	unmap();
+	return offset;
+}
+} // namespace utils
+} // namespace pvr
+//!\endcond
@@ -0,0 +1,109 @@
+/*!
+\brief Contains the GlStreamBuffer, a fenced ring buffer for streaming per frame vertex and uniform data with OpenGL ES.
+\file PVRUtils/OpenGLES/StreamBufferGles.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRUtils/OpenGLES/StateCacheGles.h"
+
+namespace pvr {
+namespace utils {
+/// <summary>A linear allocator over a buffer object split into one segment per frame in flight, for data that is written
+/// by the CPU once per frame (dynamic vertices, per draw uniform blocks, ...). Each frame allocates from its own segment,
+/// and writes to it through glMapBufferRange with GL_MAP_UNSYNCHRONIZED_BIT, so the driver never has to synchronise or
+/// rename the buffer. Instead, a glFenceSync is inserted at the end of each frame, and waited for before the segment is
+/// reused numFramesInFlight frames later, which normally has long completed.</summary>
+/// <remarks>Fences and glMapBufferRange require OpenGL ES 3.0. On OpenGL ES 2.0 the stream keeps the same interface, but
+/// data is staged in CPU memory and uploaded with glBufferSubData when it is unmapped, and the driver is left to
+/// synchronise. Allocations are rounded up to the alignment passed to init(), which for uniform buffers must be a multiple
+/// of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.</remarks>
+class GlStreamBuffer
+{
+public:
+	/// <summary>Constructor. Creates an uninitialised stream. Call init() before use.</summary>
+	GlStreamBuffer()
+		: _api(Api::Unspecified), _stateCache(nullptr), _buffer(0), _target(GL_ARRAY_BUFFER), _segmentSize(0), _alignment(0), _numSegments(0), _currentSegment(0),
+		  _offset(0), _mappedOffset(-1), _mappedSize(0), _isInFrame(false)
+	{}
+
+	/// <summary>Destructor. Releases the buffer object and the fences.</summary>
+	~GlStreamBuffer() { release(); }
+
+	/// <summary>Create the buffer object.</summary>
+	/// <param name="target">The target the buffer is bound to for mapping (GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER or GL_UNIFORM_BUFFER)</param>
+	/// <param name="segmentSize">The number of bytes that can be allocated per frame</param>
+	/// <param name="numFramesInFlight">The number of frames the GPU can be behind the CPU. One segment is created per frame.</param>
+	/// <param name="alignment">The alignment of every allocation. 0 uses GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for uniform
+	/// buffers and 16 bytes otherwise.</param>
+	/// <param name="stateCache">If not null, the buffer is bound through this state cache, which is then kept up to date.</param>
+	void init(GLenum target, GLsizeiptr segmentSize, uint32_t numFramesInFlight, GLsizeiptr alignment = 0, GlStateCache* stateCache = nullptr);
+
+	/// <summary>Delete the buffer object and the fences. The GPU must have finished with the buffer.</summary>
+	void release();
+
+	/// <summary>Query if the stream has been initialised.</summary>
+	/// <returns>True if init() has been called</returns>
+	bool isInitialized() const { return _buffer != 0; }
+
+	/// <summary>Move on to the next segment, waiting for the GPU to finish reading it if needed, and reset its allocator.
+	/// Call once per frame, before any allocation.</summary>
+	void beginFrame();
+
+	/// <summary>Insert a fence after the commands of the frame, which protects the segment until they have completed.
+	/// Call once per frame, after the last draw reading data of the frame has been issued.</summary>
+	void endFrame();
+
+	/// <summary>Allocate a range of the current segment and map it for writing. The range must be unmapped with unmap()
+	/// before it is used by a draw, and before the next call to map().</summary>
+	/// <param name="size">The number of bytes to allocate</param>
+	/// <param name="outOffset">The offset of the allocation in the buffer object, to use as the vertex attribute pointer,
+	/// index offset or uniform buffer range offset</param>
+	/// <returns>A pointer to write the data to</returns>
+	void* map(GLsizeiptr size, GLintptr& outOffset);
+
+	/// <summary>Unmap the range returned by the last call to map(). Leaves the buffer bound to its target.</summary>
+	void unmap();
+
+	/// <summary>Allocate a range of the current segment and copy data into it.</summary>
+	/// <param name="data">The data</param>
+	/// <param name="size">The number of bytes to copy</param>
+	/// <returns>The offset of the allocation in the buffer object</returns>
+	GLintptr write(const void* data, GLsizeiptr size);
+
+	/// <summary>Get the buffer object.</summary>
+	/// <returns>The buffer object</returns>
+	GLuint getBuffer() const { return _buffer; }
+
+	/// <summary>Get the number of bytes that can still be allocated this frame.</summary>
+	/// <returns>The number of bytes left in the current segment</returns>
+	GLsizeiptr getRemainingSize() const { return _segmentSize - _offset; }
+
+	/// <summary>Get the number of bytes that can be allocated per frame.</summary>
+	/// <returns>The size of a segment</returns>
+	GLsizeiptr getSegmentSize() const { return _segmentSize; }
+
+private:
+	GlStreamBuffer(const GlStreamBuffer&) = delete;
+	GlStreamBuffer& operator=(const GlStreamBuffer&) = delete;
+
+	void bind();
+	bool usesFences() const { return _api > Api::OpenGLES2; }
+
+	Api _api;
+	GlStateCache* _stateCache;
+	GLuint _buffer;
+	GLenum _target;
+	GLsizeiptr _segmentSize;
+	GLsizeiptr _alignment;
+	uint32_t _numSegments;
+	uint32_t _currentSegment;
+	GLsizeiptr _offset;
+	GLintptr _mappedOffset;
+	GLsizeiptr _mappedSize;
+	bool _isInFrame;
+	std::vector<GLsync> _fences;
+	std::vector<unsigned char> _staging; // OpenGL ES 2.0 only
+};
+} // namespace utils
+} // namespace pvr
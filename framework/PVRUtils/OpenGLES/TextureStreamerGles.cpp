@@ -0,0 +1,256 @@
+/*!
+\brief Contains the implementation of the OpenGL ES texture streamer.
+\file PVRUtils/OpenGLES/TextureStreamerGles.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/OpenGLES/TextureStreamerGles.h"
+#include "PVRUtils/OpenGLES/ErrorsGles.h"
+#include "PVRCore/Log.h"
+
+namespace pvr {
+namespace utils {
+TextureStreamFuture_::~TextureStreamFuture_()
+{
+	if (!_fence) { return; }
+	// The last reference may be dropped on any thread, where no context of the share group may be current. Sync objects
+	// are shared, so one of the upload contexts deletes the fence on its own thread instead.
+	std::lock_guard<std::mutex> lock(_orphanedFences->mutex);
+	if (_orphanedFences->isOpen) { _orphanedFences->fences.emplace_back(_fence); }
+	// Otherwise the streamer has been released: the fence is only destroyed along with the share group.
+}
+
+void TextureStreamFuture_::uploadNow(GLuint pixelUnpackBuffer, bool isEs2)
+{
+	_successful = false;
+	try
+	{
+		TexturePtr texture = _texture;
+		if (_asyncTexture)
+		{
+			texture = _asyncTexture->get();
+			if (!_asyncTexture->isSuccessful() || !texture) { throw InvalidOperationError("TextureStreamerGles: The texture to upload could not be loaded"); }
+		}
+
+		TextureUploadResults results = textureUpload(*texture, isEs2, _allowDecompress, pixelUnpackBuffer);
+		_result.target = results.target;
+		_result.image = results.image;
+		_result.format = results.format;
+		_result.isDecompressed = results.isDecompressed;
+
+		if (isEs2) { gl::Finish(); }
+		else
+		{
+			// Flush so that the fence is guaranteed to signal even if this context submits nothing else.
+			GLsync fence = gl::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			gl::Flush();
+			std::lock_guard<std::mutex> lock(_fenceMutex);
+			_fence = fence;
+		}
+		debugThrowOnApiError("TextureStreamerGles: Failed to upload texture");
+		_successful = true;
+	}
+	catch (...)
+	{
+		_exception = std::current_exception();
+		_successful = false;
+	}
+	complete();
+}
+
+void TextureStreamFuture_::fail(std::exception_ptr exception)
+{
+	_exception = exception;
+	_successful = false;
+	complete();
+}
+
+void TextureStreamFuture_::complete()
+{
+	_texture.reset();
+	_asyncTexture.reset();
+
+	_resultSemaphore->signal();
+	executeCallBack(shared_from_this());
+}
+
+void TextureStreamFuture_::handOver() const
+{
+	std::lock_guard<std::mutex> lock(_fenceMutex);
+	if (_fence)
+	{
+		// Make the context of the calling thread wait for the upload on the GPU, without blocking the CPU.
+		gl::WaitSync(_fence, 0, GL_TIMEOUT_IGNORED);
+		gl::DeleteSync(_fence);
+		_fence = nullptr;
+	}
+}
+
+StreamedTextureGles TextureStreamFuture_::get_() const
+{
+	if (_inCallback) { return _result; }
+	async::waitForCompletion(*_resultSemaphore);
+	if (_exception) { std::rethrow_exception(_exception); }
+	handOver();
+	return _result;
+}
+
+bool TextureStreamFuture_::isComplete_() const
+{
+	if (_resultSemaphore->tryWait())
+	{
+		_resultSemaphore->signal();
+		return true;
+	}
+	return false;
+}
+
+bool TextureStreamFuture_::isReadyForRendering() const
+{
+	if (!isComplete_()) { return false; }
+	std::lock_guard<std::mutex> lock(_fenceMutex);
+	if (!_fence) { return true; }
+	GLenum status = gl::ClientWaitSync(_fence, 0, 0);
+	if (status == GL_WAIT_FAILED) { throw GlError(gl::GetError(), "TextureStreamerGles: Failed to poll the fence of an upload"); }
+	return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void TextureStreamerGles::init(platform::EglContext_& renderContext, uint32_t numContexts)
+{
+	if (isInitialized()) { throw InvalidOperationError("TextureStreamerGles: Streamer already initialized"); }
+	if (numContexts == 0) { throw InvalidArgumentError("numContexts", "TextureStreamerGles: At least one upload context is required"); }
+
+	_isEs2 = renderContext.getApiVersion() < Api::OpenGLES3;
+	_exit = false;
+	_orphanedFences = std::make_shared<impl::OrphanedFencesGles>();
+
+	// Contexts are created on this thread, and only made current on the workers.
+	_workers.resize(numContexts);
+	for (Worker& worker : _workers) { worker.context = renderContext.createSharedContextFromEGLContext(); }
+	for (Worker& worker : _workers) { worker.thread = std::thread(&TextureStreamerGles::workerLoop, this, worker.context.get()); }
+
+	Log(LogLevel::Information, "TextureStreamerGles: Started %u upload contexts (%s)", numContexts, _isEs2 ? "OpenGL ES 2.0, synchronous" : "pixel unpack buffers and fences");
+}
+
+void TextureStreamerGles::release()
+{
+	if (_workers.empty()) { return; }
+	{
+		// Fences orphaned from now on could be missed by the workers as they exit.
+		std::lock_guard<std::mutex> lock(_orphanedFences->mutex);
+		_orphanedFences->isOpen = false;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		_exit = true;
+	}
+	_queueCondition.notify_all();
+	for (Worker& worker : _workers)
+	{
+		if (worker.thread.joinable()) { worker.thread.join(); }
+	}
+	// The contexts have been released from their threads, so they can now be destroyed here.
+	_workers.clear();
+	_orphanedFences.reset();
+}
+
+uint32_t TextureStreamerGles::getNumQueuedItems()
+{
+	std::lock_guard<std::mutex> lock(_queueMutex);
+	return static_cast<uint32_t>(_queue.size());
+}
+
+TextureStreamFuture TextureStreamerGles::uploadTextureAsync(const AsyncTexture& texture, bool allowDecompress, CallbackType callback)
+{
+	if (!texture) { throw InvalidArgumentError("texture", "TextureStreamerGles: Texture future was null"); }
+	TextureStreamFuture future(new TextureStreamFuture_());
+	future->_asyncTexture = texture;
+	future->_allowDecompress = allowDecompress;
+	future->_resultSemaphore = std::make_shared<async::Semaphore>();
+	future->_orphanedFences = _orphanedFences;
+	future->setTheCallback(callback);
+	enqueue(future);
+	return future;
+}
+
+TextureStreamFuture TextureStreamerGles::uploadTextureAsync(const TexturePtr& texture, bool allowDecompress, CallbackType callback)
+{
+	if (!texture) { throw InvalidArgumentError("texture", "TextureStreamerGles: Texture was null"); }
+	TextureStreamFuture future(new TextureStreamFuture_());
+	future->_texture = texture;
+	future->_allowDecompress = allowDecompress;
+	future->_resultSemaphore = std::make_shared<async::Semaphore>();
+	future->_orphanedFences = _orphanedFences;
+	future->setTheCallback(callback);
+	enqueue(future);
+	return future;
+}
+
+void TextureStreamerGles::enqueue(const TextureStreamFuture& future)
+{
+	if (!isInitialized()) { throw InvalidOperationError("TextureStreamerGles: Streamer not initialized"); }
+	{
+		std::lock_guard<std::mutex> lock(_queueMutex);
+		_queue.push_back(future);
+	}
+	_queueCondition.notify_one();
+}
+
+void TextureStreamerGles::deleteOrphanedFences()
+{
+	std::vector<GLsync> fences;
+	{
+		std::lock_guard<std::mutex> lock(_orphanedFences->mutex);
+		fences.swap(_orphanedFences->fences);
+	}
+	for (GLsync fence : fences) { gl::DeleteSync(fence); }
+}
+
+void TextureStreamerGles::workerLoop(platform::EglContext_* context)
+{
+	std::exception_ptr contextError;
+	try
+	{
+		context->makeCurrent();
+	}
+	catch (...)
+	{
+		Log(LogLevel::Error, "TextureStreamerGles: Could not make an upload context current. Its uploads will fail.");
+		contextError = std::current_exception();
+	}
+
+	// Each worker stages its uploads in its own buffer. Orphaning it on every upload lets the driver keep
+	// the previous storage alive until the copy out of it has completed.
+	GLuint pixelUnpackBuffer = 0;
+	if (!contextError && !_isEs2) { gl::GenBuffers(1, &pixelUnpackBuffer); }
+
+	for (;;)
+	{
+		TextureStreamFuture future;
+		{
+			std::unique_lock<std::mutex> lock(_queueMutex);
+			_queueCondition.wait(lock, [this] { return _exit || !_queue.empty(); });
+			// Drain the queue before exiting, so that every future handed out gets completed.
+			if (_queue.empty()) { break; }
+			future = std::move(_queue.front());
+			_queue.pop_front();
+		}
+		if (contextError) { future->fail(contextError); }
+		else
+		{
+			deleteOrphanedFences();
+			future->uploadNow(pixelUnpackBuffer, _isEs2);
+		}
+	}
+
+	if (contextError) { return; }
+	deleteOrphanedFences();
+	if (pixelUnpackBuffer) { gl::DeleteBuffers(1, &pixelUnpackBuffer); }
+	gl::Finish();
+	egl::MakeCurrent(egl::GetCurrentDisplay(), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	egl::ReleaseThread();
+}
+} // namespace utils
+} // namespace pvr
+//!\endcond
@@ -0,0 +1,186 @@
+/*!
+\brief Contains a futures system for streaming textures into OpenGL ES on a pool of shared contexts.
+\file PVRUtils/OpenGLES/TextureStreamerGles.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/texture/TextureLoadAsync.h"
+#include "PVRUtils/OpenGLES/TextureUtilsGles.h"
+#include "PVRUtils/EGL/EglPlatformContext.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace pvr {
+namespace utils {
+/// <summary>Provides a reference counted pointer to a pvr::Texture which will be used for loading API agnostic texture data to disk.</summary>
+typedef std::shared_ptr<Texture> TexturePtr;
+
+/// <summary>Provides a reference counted pointer to a IFrameworkAsyncResult specialised by a TexturePtr which will be used
+/// as the main interface for using API agnostic asynchronous textures.</summary>
+typedef std::shared_ptr<async::IFrameworkAsyncResult<TexturePtr>> AsyncTexture;
+
+/// <summary>An OpenGL ES texture uploaded by a TextureStreamerGles.</summary>
+struct StreamedTextureGles
+{
+	/// <summary>The texture target of the texture</summary>
+	GLenum target;
+
+	/// <summary>The texture object. Owned by the application once the upload is complete.</summary>
+	GLuint image;
+
+	/// <summary>The format of the created texture</summary>
+	PixelFormat format;
+
+	/// <summary>Will be set to 'true' if the texture was (software) decompressed to a supported uncompressed format</summary>
+	bool isDecompressed;
+
+	/// <summary>Default constructor for a StreamedTextureGles structure.</summary>
+	StreamedTextureGles() : target(0), image(0), isDecompressed(false) {}
+};
+
+class TextureStreamerGles;
+
+namespace impl {
+/// <summary>The fences of futures that were destroyed before handing their texture over. A fence may be destroyed on
+/// any thread, where no context of the share group may be current, so the upload contexts delete these instead.</summary>
+struct OrphanedFencesGles
+{
+	std::mutex mutex; //!< Protects the members below
+	std::vector<GLsync> fences; //!< The fences to delete
+	bool isOpen; //!< False once the streamer is released, after which orphaned fences are left to the render context
+
+	/// <summary>Constructor.</summary>
+	OrphanedFencesGles() : isOpen(true) {}
+};
+} // namespace impl
+
+/// <summary>A future to a texture streamed by a TextureStreamerGles. The upload is executed by one of the upload
+/// contexts of the streamer, which inserts a fence after its commands. get() hands the texture over to the context
+/// current on the calling thread by making it wait (on the GPU) for that fence, so it must be called on the render
+/// thread before the texture is used.</summary>
+struct TextureStreamFuture_ : public async::IFrameworkAsyncResult<StreamedTextureGles>, public std::enable_shared_from_this<TextureStreamFuture_>
+{
+public:
+	/// <summary>The type of the optional callback that is called at the end of the operation</summary>
+	typedef IFrameworkAsyncResult<StreamedTextureGles>::Callback CallbackType;
+
+	/// <summary>Destructor. If the texture was never handed over, its fence is passed to the upload contexts to delete.</summary>
+	~TextureStreamFuture_();
+
+	/// <summary>Query if the texture can be used by the render thread without the GPU waiting for the upload. Unlike
+	/// isComplete(), which only reports that the upload commands have been issued, this polls the fence of the upload,
+	/// so it can be used to only draw with streamed textures once they have actually arrived. Must be called on the
+	/// render thread.</summary>
+	/// <returns>True if the upload has completed on the GPU (or failed)</returns>
+	/// <remarks>Throws a GlError if the fence of the upload cannot be polled.</remarks>
+	bool isReadyForRendering() const;
+
+private:
+	friend class TextureStreamerGles;
+	TextureStreamFuture_() : _allowDecompress(true), _fence(nullptr) {}
+
+	void uploadNow(GLuint pixelUnpackBuffer, bool isEs2);
+	void fail(std::exception_ptr exception);
+	void complete();
+	void handOver() const;
+	StreamedTextureGles get_() const;
+	bool isComplete_() const;
+	void cleanup_() {}
+
+	TexturePtr _texture;
+	AsyncTexture _asyncTexture;
+	bool _allowDecompress;
+	mutable async::SemaphorePtr _resultSemaphore;
+	mutable std::mutex _fenceMutex;
+	mutable GLsync _fence;
+	std::shared_ptr<impl::OrphanedFencesGles> _orphanedFences;
+	StreamedTextureGles _result;
+	std::exception_ptr _exception;
+};
+
+/// <summary>A ref-counted pointer to a TextureStreamFuture_.</summary>
+typedef std::shared_ptr<TextureStreamFuture_> TextureStreamFuture;
+
+/// <summary>Streams textures into OpenGL ES in the background, on a small pool of worker threads, each owning a pbuffer
+/// context shared with the render context. On OpenGL ES 3.0 and above, texture data is staged in a pixel unpack buffer
+/// per worker so that the driver copies it asynchronously, and each upload is followed by a glFenceSync that the render
+/// context waits for in TextureStreamFuture_::get(), so neither thread ever blocks on the other's GPU work. On OpenGL ES
+/// 2.0 the workers upload directly and call glFinish instead.
+/// Takes the same texture futures as ImageApiAsyncUploader, so the loading (for example by a TextureAsyncLoader) and
+/// the uploading of the textures can be chained and overlapped.</summary>
+class TextureStreamerGles
+{
+public:
+	/// <summary>The type of the optional callback that is called at the end of the operation</summary>
+	typedef TextureStreamFuture_::CallbackType CallbackType;
+
+	/// <summary>Constructor. Creates an uninitialised streamer. Call init() before use.</summary>
+	TextureStreamerGles() : _isEs2(false), _exit(false) {}
+
+	/// <summary>Destructor. Finishes the queued uploads, then releases the workers and their contexts.</summary>
+	~TextureStreamerGles() { release(); }
+
+	/// <summary>Create the upload contexts and start the workers.</summary>
+	/// <param name="renderContext">The render context, with which the upload contexts share their objects. Must outlive
+	/// the streamer.</param>
+	/// <param name="numContexts">The number of upload contexts and worker threads. A couple of them are normally enough to
+	/// keep the copy engine busy.</param>
+	void init(platform::EglContext_& renderContext, uint32_t numContexts = 2);
+
+	/// <summary>Finish the queued uploads, then stop the workers and destroy their contexts.</summary>
+	void release();
+
+	/// <summary>Query if the streamer has been initialised.</summary>
+	/// <returns>True if init() has been called</returns>
+	bool isInitialized() const { return !_workers.empty(); }
+
+	/// <summary>Get the number of upload contexts.</summary>
+	/// <returns>The number of upload contexts</returns>
+	uint32_t getNumContexts() const { return static_cast<uint32_t>(_workers.size()); }
+
+	/// <summary>Get the number of uploads that have not been picked up by a worker yet.</summary>
+	/// <returns>The number of queued uploads</returns>
+	uint32_t getNumQueuedItems();
+
+	/// <summary>Queue the upload of a texture and return a future to the OpenGL ES texture.</summary>
+	/// <param name="texture">A texture future (for example from a TextureAsyncLoader). The worker waits for it.</param>
+	/// <param name="allowDecompress">Allow unsupported PVRTC textures to be decompressed to RGBA8</param>
+	/// <param name="callback">An optional callback, called on the worker thread once the upload commands have been issued.
+	/// Do not use the texture from the callback: it is only handed over to the render context by get().</param>
+	/// <returns>A future to the uploaded texture</returns>
+	TextureStreamFuture uploadTextureAsync(const AsyncTexture& texture, bool allowDecompress = true, CallbackType callback = nullptr);
+
+	/// <summary>Queue the upload of a texture already in memory and return a future to the OpenGL ES texture.</summary>
+	/// <param name="texture">The texture to upload. It is referenced, not copied, until the upload is complete.</param>
+	/// <param name="allowDecompress">Allow unsupported PVRTC textures to be decompressed to RGBA8</param>
+	/// <param name="callback">An optional callback, called on the worker thread once the upload commands have been issued</param>
+	/// <returns>A future to the uploaded texture</returns>
+	TextureStreamFuture uploadTextureAsync(const TexturePtr& texture, bool allowDecompress = true, CallbackType callback = nullptr);
+
+private:
+	TextureStreamerGles(const TextureStreamerGles&) = delete;
+	TextureStreamerGles& operator=(const TextureStreamerGles&) = delete;
+
+	struct Worker
+	{
+		EglContext context;
+		std::thread thread;
+	};
+
+	void enqueue(const TextureStreamFuture& future);
+	void workerLoop(platform::EglContext_* context);
+	void deleteOrphanedFences();
+
+	bool _isEs2;
+	std::vector<Worker> _workers;
+	std::deque<TextureStreamFuture> _queue;
+	std::mutex _queueMutex;
+	std::condition_variable _queueCondition;
+	bool _exit;
+	std::shared_ptr<impl::OrphanedFencesGles> _orphanedFences;
+};
+} // namespace utils
+} // namespace pvr
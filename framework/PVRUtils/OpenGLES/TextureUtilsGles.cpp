@@ -12,10 +12,13 @@
 #include "PVRUtils/OpenGLES/ErrorsGles.h"
 #include "PVRUtils/OpenGLES/ConvertToGlesTypes.h"
 #include <algorithm>
+#include <cstring>
 
 namespace pvr {
 namespace utils {
-TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allowDecompress)
+TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allowDecompress) { return textureUpload(texture, isEs2, allowDecompress, 0); }
+
+TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allowDecompress, GLuint pixelUnpackBuffer)
 {
 	TextureUploadResults retval;
 	// Check that the texture is valid.
@@ -392,6 +395,14 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 		}
 	}
 
+	// When uploading through a pixel unpack buffer, the data is copied into the buffer and the pointers passed to
+	// glTex(Sub)Image become offsets into it, so that the driver can copy to the texture asynchronously.
+	const unsigned char* uploadDataBase = nullptr;
+	auto getUploadData = [textureToUse, &uploadDataBase](uint32_t mipLevel, uint32_t arrayMember, uint32_t face) -> const unsigned char* {
+		const unsigned char* data = textureToUse->getDataPointer(mipLevel, arrayMember, face);
+		return (uploadDataBase && data) ? reinterpret_cast<const unsigned char*>(static_cast<uintptr_t>(data - uploadDataBase)) : data;
+	};
+
 	// Setup the texture object.
 	{
 		// Check the error here, in case the extension loader or anything else raised any errors.
@@ -424,6 +435,23 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 
 	try
 	{
+#if !SC_ENABLED
+		if (pixelUnpackBuffer && !isEs2)
+		{
+			const GLsizeiptr dataSize = static_cast<GLsizeiptr>(textureToUse->getDataSize());
+			gl::BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelUnpackBuffer);
+			uploadDataBase = textureToUse->getDataPointer();
+			// Orphan the previous contents, so that a buffer reused for consecutive uploads never stalls.
+			gl::BufferData(GL_PIXEL_UNPACK_BUFFER, dataSize, nullptr, GL_STREAM_DRAW);
+			void* mapped = gl::MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, dataSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			if (!mapped) { throw OperationFailedError("[textureUpload]: Mapping the pixel unpack buffer failed"); }
+			memcpy(mapped, uploadDataBase, static_cast<size_t>(dataSize));
+			gl::UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			utils::throwOnGlError("[textureUpload]: Filling the pixel unpack buffer failed");
+		}
+#else
+		(void)pixelUnpackBuffer;
+#endif
 		// Load the texture.
 		{
 			debugThrowOnApiError("[textureUpload] GL has a raised error before attempting to define texture storage.");
@@ -443,13 +471,13 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 						{
 							gl::CompressedTexSubImage2D(retval.target, static_cast<GLint>(uiMIPLevel), 0, 0, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), glInternalFormat,
-								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glCompressedTexSubImage2D");
 						}
 						else
 						{
 							gl::TexSubImage2D(retval.target, static_cast<GLint>(uiMIPLevel), 0, 0, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
-								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), glFormat, glType, textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), glFormat, glType, getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glTexSubImage2D failed");
 						}
 					}
@@ -462,14 +490,14 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 						{
 							gl::CompressedTexImage2D(retval.target, static_cast<GLint>(uiMIPLevel), glInternalFormat, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), 0, textureToUse->getDataSize(uiMIPLevel, false, false),
-								textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glCompressedTexImage2D");
 						}
 						else
 						{
 							if (isEs2) { glInternalFormat = glFormat; }
 							gl::TexImage2D(retval.target, static_cast<GLint>(uiMIPLevel), glInternalFormat, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
-								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), 0, glFormat, glType, textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), 0, glFormat, glType, getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glTexImage2D");
 						}
 					}
@@ -499,7 +527,7 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 								gl::CompressedTexSubImage2D(eTexImageTarget + uiFace, static_cast<GLint>(uiMIPLevel), 0, 0,
 									static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), glInternalFormat,
 									static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)),
-									textureToUse->getDataPointer(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
+									getUploadData(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
 								utils::throwOnGlError("[textureUpload]:(cubemap face) glCompressedTexSubImage2D Failed");
 							}
 							else
@@ -508,7 +536,7 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 								// non-existant face.
 								gl::TexSubImage2D(eTexImageTarget + uiFace, static_cast<GLint>(uiMIPLevel), 0, 0, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 									static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), glFormat, glType,
-									textureToUse->getDataPointer(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
+									getUploadData(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
 								utils::throwOnGlError("[textureUpload]:(cubemap face) glTexSubImage2D Failed");
 							}
 						}
@@ -529,7 +557,7 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 								gl::CompressedTexImage2D(eTexImageTarget + uiFace, static_cast<GLint>(uiMIPLevel), glInternalFormat,
 									static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), 0,
 									static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)),
-									textureToUse->getDataPointer(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
+									getUploadData(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
 								utils::throwOnGlError("[textureUpload]:(cubemap face) glCompressedTexImage2D Failed");
 							}
 							else
@@ -538,7 +566,7 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 								// non-existant face.
 								gl::TexImage2D(eTexImageTarget + uiFace, static_cast<GLint>(uiMIPLevel), glInternalFormat, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 									static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), 0, glFormat, glType,
-									textureToUse->getDataPointer(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
+									getUploadData(uiMIPLevel, 0, uiFace % textureToUse->getNumFaces()));
 								utils::throwOnGlError("[textureUpload]:(cubemap face) glTexImage2D Failed");
 							}
 						}
@@ -562,14 +590,14 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 						{
 							gl::CompressedTexSubImage3D(retval.target, static_cast<GLint>(uiMIPLevel), 0, 0, 0, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), textureToUse->getDepth(uiMIPLevel), glInternalFormat,
-								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]:(cubemap face) glCompressedTexSubImage3D Failed");
 						}
 						else
 						{
 							gl::TexSubImage3D(retval.target, static_cast<GLint>(uiMIPLevel), 0, 0, 0, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), textureToUse->getDepth(uiMIPLevel), glFormat, glType,
-								textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]:(cubemap face) glTexSubImage3D Failed");
 						}
 					}
@@ -582,14 +610,14 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 						{
 							gl::CompressedTexImage3D(retval.target, static_cast<GLint>(uiMIPLevel), glInternalFormat, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getDepth(uiMIPLevel)), 0,
-								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glCompressedTexImage3D Failed");
 						}
 						else
 						{
 							gl::TexImage3D(retval.target, static_cast<GLint>(uiMIPLevel), glInternalFormat, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getDepth(uiMIPLevel)), 0, glFormat, glType,
-								textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glTexImage3D Failed");
 						}
 					}
@@ -612,14 +640,14 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 						{
 							gl::CompressedTexSubImage3D(retval.target, static_cast<GLint>(uiMIPLevel), 0, 0, 0, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getNumArrayMembers()), glInternalFormat,
-								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glCompressedTexSubImage3D Failed");
 						}
 						else
 						{
 							gl::TexSubImage3D(retval.target, static_cast<GLint>(uiMIPLevel), 0, 0, 0, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getNumArrayMembers()), glFormat, glType,
-								textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glTexSubImage3D Failed");
 						}
 					}
@@ -632,14 +660,14 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 						{
 							gl::CompressedTexImage3D(retval.target, static_cast<GLint>(uiMIPLevel), glInternalFormat, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getNumArrayMembers()), 0,
-								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								static_cast<GLsizei>(textureToUse->getDataSize(uiMIPLevel, false, false)), getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glCompressedTexImage3D Failed");
 						}
 						else
 						{
 							gl::TexImage3D(retval.target, static_cast<GLint>(uiMIPLevel), glInternalFormat, static_cast<GLsizei>(textureToUse->getWidth(uiMIPLevel)),
 								static_cast<GLsizei>(textureToUse->getHeight(uiMIPLevel)), static_cast<GLsizei>(textureToUse->getNumArrayMembers()), 0, glFormat, glType,
-								textureToUse->getDataPointer(uiMIPLevel, 0, 0));
+								getUploadData(uiMIPLevel, 0, 0));
 							utils::throwOnGlError("[textureUpload]: glTexImage3D Failed");
 						}
 					}
@@ -655,9 +683,15 @@ TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allo
 	catch (...)
 	{
 		gl::BindTexture(retval.target, 0);
+#if !SC_ENABLED
+		if (uploadDataBase) { gl::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); }
+#endif
 		throw;
 	}
 	gl::BindTexture(retval.target, 0);
+#if !SC_ENABLED
+	if (uploadDataBase) { gl::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); }
+#endif
 	return retval;
 }
 } // namespace utils
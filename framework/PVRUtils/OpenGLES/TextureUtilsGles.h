@@ -60,5 +60,17 @@ private:
 /// whether it was actually decompressed. The "result" field will contain Result::Success
 /// on success, errorcode otherwise. See the Texture</returns>
 TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allowDecompress);
+
+/// <summary>Upload a texture to the GPU on the current context through a pixel unpack buffer. The texture data is
+/// copied into the buffer, which is orphaned first so that it can be reused for consecutive uploads, and the texture is
+/// then defined from the buffer, letting the driver perform the copy asynchronously.</summary>
+/// <param name="texture">The pvr::Texture to upload to the GPU</param>
+/// <param name="isEs2">Signifies whether the current context is ES2 only. Pixel unpack buffers require OpenGL ES 3.0, so
+/// ES2 contexts (and OpenGL SC) upload directly from the texture data, as if pixelUnpackBuffer was 0.</param>
+/// <param name="allowDecompress">Set to true to allow to attempt to de-compress unsupported compressed textures.</param>
+/// <param name="pixelUnpackBuffer">A buffer object to stage the data in, or 0 to upload directly from the texture data.
+/// GL_PIXEL_UNPACK_BUFFER is bound to 0 on return.</param>
+/// <returns>A TextureUploadResults object containing the uploaded texture and all necessary information</returns>
+TextureUploadResults textureUpload(const Texture& texture, bool isEs2, bool allowDecompress, GLuint pixelUnpackBuffer);
 } // namespace utils
 } // namespace pvr
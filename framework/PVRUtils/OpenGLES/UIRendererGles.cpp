@@ -547,6 +547,7 @@ void UIRenderer::init(uint32_t width, uint32_t height, bool fullscreen, bool isF
 	throw OperationFailedError("Can't use UIRenderer with this API.");
 #endif
 	_api = pvr::utils::getCurrentGlesVersion();
+	_stateCache.setApi(_api);
 
 	debugThrowOnApiError("");
 	release();
@@ -591,6 +592,7 @@ void UIRenderer::init(uint32_t width, uint32_t height, bool fullscreen, bool isF
 
 	checkStateChanged();
 	restoreState();
+	_stateCache.invalidate();
 	debugThrowOnApiError("UIRenderer::init RestoreState");
 }
 
@@ -6,6 +6,7 @@
 */
 #pragma once
 #include "PVRUtils/OpenGLES/SpriteGles.h"
+#include "PVRUtils/OpenGLES/StateCacheGles.h"
 #include "PVRCore/texture/Texture.h"
 #include "PVRCore/math/MathUtils.h"
 
@@ -278,7 +279,7 @@ public:
 		  _samplerBilinear(std::move(rhs._samplerBilinear)), _samplerTrilinear(std::move(rhs._samplerTrilinear)), _fontIbo(std::move(rhs._fontIbo)),
 		  _fontIboCreated(std::move(rhs._fontIboCreated)), _imageVbo(std::move(rhs._imageVbo)), _imageVboCreated(std::move(rhs._imageVboCreated)),
 		  _screenDimensions(std::move(rhs._screenDimensions)), _screenRotation(std::move(rhs._screenRotation)), _groupId(std::move(rhs._groupId)),
-		  _sprites(std::move(rhs._sprites)), _textElements(std::move(rhs._textElements)), _fonts(std::move(rhs._fonts))
+		  _sprites(std::move(rhs._sprites)), _textElements(std::move(rhs._textElements)), _fonts(std::move(rhs._fonts)), _stateCache(std::move(rhs._stateCache))
 	{
 		_program = std::move(rhs._program);
 		rhs._program = 0;
@@ -308,6 +309,7 @@ public:
 		_groupId = std::move(rhs._groupId);
 		_fontIboCreated = std::move(rhs._fontIboCreated);
 		_imageVboCreated = std::move(rhs._imageVboCreated);
+		_stateCache = std::move(rhs._stateCache);
 		updateResourceOwnership();
 		return *this;
 	}
@@ -358,6 +360,7 @@ public:
 #endif
 
 		_screenRotation = .0f;
+		_stateCache.invalidateUniforms(_program);
 		_program = 0;
 		_fontIboCreated = false;
 		_imageVboCreated = false;
@@ -519,6 +522,7 @@ public:
 		storeCurrentGlState();
 		checkStateChanged();
 		setUiState();
+		resetStateCache();
 	}
 
 	/// <summary>Begins direct rendering for the UIRenderer. A GLStateTracker structure is used for more efficient state tracking management.
@@ -530,6 +534,7 @@ public:
 	{
 		checkStateChanged(stateTracker);
 		setUiState();
+		resetStateCache();
 	}
 
 	/// <summary>Ends rendering and resets the state</summary>
@@ -537,12 +542,17 @@ public:
 	{
 		checkStateChanged();
 		restoreState();
+		_stateCache.invalidate();
 	}
 
 	/// <summary>Ends rendering and fills out the GLStateTracker structure which can be used by the caller for more efficient state tracking management.</summary>
 	/// <param name="stateTracker">A GLStateTracker structure which stores the current OpenGL ES state as well as indicating which states have been changed
 	/// since the last time the caller called beginRendering. The Caller has the responsibility of restoring and managing the OpenGL ES state.</param>
-	void endRendering(GLStateTracker& stateTracker) { stateTracker = _uiStateTracker; }
+	void endRendering(GLStateTracker& stateTracker)
+	{
+		stateTracker = _uiStateTracker;
+		_stateCache.invalidate();
+	}
 
 	/// <summary>The UIRenderer has a built-in default pvr::ui::Font that can always be used when the UIRenderer is
 	/// initialized. Used throughout the PowerVR SDK Examples.</summary>
@@ -628,6 +638,11 @@ public:
 	/// <returns>pvr::ui::GLStateTracker</returns>
 	GLStateTracker getStateTracker() const { return _uiStateTracker; }
 
+	/// <summary>Return the cache the sprites set their OpenGL ES state and uniforms through. Its statistics show how many
+	/// redundant calls were filtered out since the last beginRendering.</summary>
+	/// <returns>The state cache used by the ui renderer</returns>
+	const utils::GlStateCache& getStateCache() const { return _stateCache; }
+
 	/// <summary>Return the OpenGL ES version assumed by the UIRenderer (the bound context version from when it was created)</summary>
 	/// <returns>The API version assumed by the UIRenderer.</returns>
 	Api getApiVersion() { return _api; }
@@ -639,6 +654,14 @@ private:
 	void checkStateChanged(const GLStateTracker& stateTracker);
 	void restoreState();
 
+	// Only the state set between beginRendering and endRendering is known: the application may change anything outside.
+	void resetStateCache()
+	{
+		_stateCache.invalidate();
+		_stateCache.resetStatistics();
+		_stateCache.useProgram(_program);
+	}
+
 	void updateResourceOwnership()
 	{
 		std::for_each(_sprites.begin(), _sprites.end(), [this](SpriteWeakRef& sprite) { sprite.lock()->setUIRenderer(this); });
@@ -694,6 +717,7 @@ private:
 
 	GLStateTracker _uiStateTracker;
 	GLState _currentState;
+	utils::GlStateCache _stateCache;
 
 	Api _api;
 };
@@ -0,0 +1,801 @@
+/*!
+\brief Implementation of the CPU Image Based Lighting bakers.
+\file PVRUtils/PBRBaker.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/PBRBaker.h"
+#include "PVRUtils/PBRUtils.h"
+#include "PVRCore/JobSystem.h"
+#include "PVRCore/Profiler.h"
+#include "PVRCore/Simd.h"
+#include "PVRCore/stream/FileStream.h"
+#include "PVRCore/textureio/TextureWriterPVR.h"
+#include <cmath>
+#include <cstring>
+
+namespace pvr {
+namespace utils {
+namespace {
+const float Pi = 3.14159265358979323846f;
+
+// Four floats, either four lanes of a computation or one RGBA colour.
+#if defined(PVR_SIMD_SSE)
+typedef __m128 Float4;
+inline Float4 splat4(float value) { return _mm_set1_ps(value); }
+inline Float4 load4(const float* source) { return _mm_loadu_ps(source); }
+inline void store4(float* destination, Float4 value) { _mm_storeu_ps(destination, value); }
+inline Float4 add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+inline Float4 mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+inline Float4 madd4(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline Float4 div4(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+inline Float4 max4(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+// a > b ? value : 0, per lane
+inline Float4 selectGreater4(Float4 a, Float4 b, Float4 value) { return _mm_and_ps(_mm_cmpgt_ps(a, b), value); }
+#elif defined(PVR_SIMD_NEON)
+typedef float32x4_t Float4;
+inline Float4 splat4(float value) { return vdupq_n_f32(value); }
+inline Float4 load4(const float* source) { return vld1q_f32(source); }
+inline void store4(float* destination, Float4 value) { vst1q_f32(destination, value); }
+inline Float4 add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+inline Float4 sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+inline Float4 mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+inline Float4 madd4(Float4 a, Float4 b, Float4 c) { return vmlaq_f32(c, a, b); }
+inline Float4 div4(Float4 a, Float4 b)
+{
+#if defined(__aarch64__)
+	return vdivq_f32(a, b);
+#else
+	Float4 reciprocal = vrecpeq_f32(b);
+	reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+	reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+	return vmulq_f32(a, reciprocal);
+#endif
+}
+inline Float4 max4(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+inline Float4 selectGreater4(Float4 a, Float4 b, Float4 value) { return vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(a, b), vreinterpretq_u32_f32(value))); }
+#else
+struct Float4
+{
+	float v[4];
+};
+inline Float4 splat4(float value) { return Float4{ { value, value, value, value } }; }
+inline Float4 load4(const float* source) { return Float4{ { source[0], source[1], source[2], source[3] } }; }
+inline void store4(float* destination, Float4 value) { memcpy(destination, value.v, sizeof(value.v)); }
+#define PVR_PBR_LANEWISE(expression) \
+	Float4 result; \
+	for (int i = 0; i < 4; ++i) { result.v[i] = expression; } \
+	return result
+inline Float4 add4(Float4 a, Float4 b) { PVR_PBR_LANEWISE(a.v[i] + b.v[i]); }
+inline Float4 sub4(Float4 a, Float4 b) { PVR_PBR_LANEWISE(a.v[i] - b.v[i]); }
+inline Float4 mul4(Float4 a, Float4 b) { PVR_PBR_LANEWISE(a.v[i] * b.v[i]); }
+inline Float4 madd4(Float4 a, Float4 b, Float4 c) { PVR_PBR_LANEWISE(a.v[i] * b.v[i] + c.v[i]); }
+inline Float4 div4(Float4 a, Float4 b) { PVR_PBR_LANEWISE(a.v[i] / b.v[i]); }
+inline Float4 max4(Float4 a, Float4 b) { PVR_PBR_LANEWISE(a.v[i] > b.v[i] ? a.v[i] : b.v[i]); }
+inline Float4 selectGreater4(Float4 a, Float4 b, Float4 value) { PVR_PBR_LANEWISE(a.v[i] > b.v[i] ? value.v[i] : 0.f); }
+#undef PVR_PBR_LANEWISE
+#endif
+
+inline float sum4(Float4 value)
+{
+	float lanes[4];
+	store4(lanes, value);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+inline uint32_t roundUpToMultipleOf4(uint32_t value) { return (value + 3u) & ~3u; }
+
+// Converting texels between pixel formats and RGBA floats
+enum class PixelEncoding
+{
+	Channels,
+	SharedExponentR9G9B9E5,
+	PackedFloatB10G11R11,
+};
+
+enum ChannelTarget : int32_t
+{
+	ChannelLuminance = -1,
+	ChannelIgnored = -2,
+};
+
+struct PixelCodec
+{
+	PixelEncoding encoding;
+	bool isFloat;
+	uint32_t pixelSize;
+	uint32_t numChannels;
+	int32_t channelTarget[4]; // The RGBA component of each channel, or a ChannelTarget
+	uint32_t channelOffset[4];
+	uint32_t channelBits[4];
+};
+
+PixelCodec getPixelCodec(const PixelFormat& format, VariableType variableType, const char* argumentName)
+{
+	PixelCodec codec = {};
+	codec.encoding = PixelEncoding::Channels;
+	codec.pixelSize = 4;
+	if (format.getPixelTypeId() == static_cast<uint64_t>(CompressedPixelFormat::SharedExponentR9G9B9E5))
+	{
+		codec.encoding = PixelEncoding::SharedExponentR9G9B9E5;
+		return codec;
+	}
+	if (format.getPixelTypeId() == GeneratePixelType3<'b', 'g', 'r', 10, 11, 11>::ID)
+	{
+		codec.encoding = PixelEncoding::PackedFloatB10G11R11;
+		return codec;
+	}
+	if (format.getPart().High == 0) { throw InvalidArgumentError(argumentName, "PBR baker: Compressed pixel formats are not supported"); }
+
+	codec.isFloat = variableType == VariableType::SignedFloat || variableType == VariableType::UnsignedFloat;
+	if (!codec.isFloat && variableType != VariableType::UnsignedByteNorm)
+	{ throw InvalidArgumentError(argumentName, "PBR baker: Only float and unsigned normalised variable types are supported"); }
+
+	codec.pixelSize = 0;
+	for (uint8_t channel = 0; channel < 4; ++channel)
+	{
+		const char content = format.getChannelContent(channel);
+		if (content == 0) { break; }
+		const uint32_t bits = format.getChannelBits(channel);
+		if (codec.isFloat ? (bits != 16 && bits != 32) : (bits != 8))
+		{ throw InvalidArgumentError(argumentName, "PBR baker: Float channels must be 16 or 32 bit, and normalised channels 8 bit"); }
+		switch (content)
+		{
+		case 'r': codec.channelTarget[channel] = 0; break;
+		case 'g': codec.channelTarget[channel] = 1; break;
+		case 'b': codec.channelTarget[channel] = 2; break;
+		case 'a': codec.channelTarget[channel] = 3; break;
+		case 'l': codec.channelTarget[channel] = ChannelLuminance; break;
+		default: codec.channelTarget[channel] = ChannelIgnored; break;
+		}
+		codec.channelOffset[channel] = codec.pixelSize;
+		codec.channelBits[channel] = bits;
+		codec.pixelSize += bits / 8;
+		++codec.numChannels;
+	}
+	if (!codec.numChannels) { throw InvalidArgumentError(argumentName, "PBR baker: The pixel format has no channels"); }
+	return codec;
+}
+
+// The unsigned 11 and 10 bit floats of B10G11R11: a 5 bit exponent and a 6 or 5 bit mantissa.
+inline float decodeUnsignedFloat(uint32_t bits, uint32_t mantissaBits)
+{
+	const uint32_t exponent = bits >> mantissaBits;
+	const uint32_t mantissa = bits & ((1u << mantissaBits) - 1u);
+	if (exponent == 0) { return ldexpf(static_cast<float>(mantissa), -14 - static_cast<int>(mantissaBits)); }
+	if (exponent == 31) { return mantissa ? 0.f : 65024.f; }
+	return ldexpf(static_cast<float>((1u << mantissaBits) | mantissa), static_cast<int>(exponent) - 15 - static_cast<int>(mantissaBits));
+}
+
+inline uint32_t encodeUnsignedFloat(float value, uint32_t mantissaBits)
+{
+	const uint32_t maxBits = (30u << mantissaBits) | ((1u << mantissaBits) - 1u);
+	if (!(value > 0.f)) { return 0; } // Also catches NaN
+	if (value < ldexpf(1.f, -14)) { return static_cast<uint32_t>(value * ldexpf(1.f, 14 + static_cast<int>(mantissaBits)) + .5f); }
+	int exponent;
+	const float fraction = frexpf(value, &exponent); // value = fraction * 2^exponent, fraction in [0.5, 1)
+	uint32_t biasedExponent = static_cast<uint32_t>(exponent - 1 + 15);
+	uint32_t mantissa = static_cast<uint32_t>((fraction * 2.f - 1.f) * static_cast<float>(1u << mantissaBits) + .5f);
+	if (mantissa == (1u << mantissaBits))
+	{
+		mantissa = 0;
+		++biasedExponent;
+	}
+	if (biasedExponent >= 31) { return maxBits; }
+	return (biasedExponent << mantissaBits) | mantissa;
+}
+
+inline uint32_t encodeSharedExponent(const float* rgba)
+{
+	const float maxValue = 65408.f; // (511 / 512) * 2^16
+	float rgb[3];
+	for (int i = 0; i < 3; ++i) { rgb[i] = rgba[i] > 0.f ? std::min(rgba[i], maxValue) : 0.f; }
+	const float maxComponent = std::max(rgb[0], std::max(rgb[1], rgb[2]));
+	if (maxComponent <= 0.f) { return 0; }
+	int exponent = std::max(-16, static_cast<int>(floorf(log2f(maxComponent)))) + 1 + 15;
+	if (static_cast<uint32_t>(maxComponent / ldexpf(1.f, exponent - 24) + .5f) == 512u) { ++exponent; }
+	const float scale = ldexpf(1.f, 24 - exponent);
+	uint32_t result = static_cast<uint32_t>(exponent) << 27;
+	for (int i = 0; i < 3; ++i) { result |= std::min(511u, static_cast<uint32_t>(rgb[i] * scale + .5f)) << (9 * i); }
+	return result;
+}
+
+void decodePixel(const PixelCodec& codec, const unsigned char* source, float* rgba)
+{
+	rgba[0] = rgba[1] = rgba[2] = 0.f;
+	rgba[3] = 1.f;
+	if (codec.encoding != PixelEncoding::Channels)
+	{
+		uint32_t packed;
+		memcpy(&packed, source, sizeof(packed));
+		if (codec.encoding == PixelEncoding::SharedExponentR9G9B9E5)
+		{
+			const float scale = ldexpf(1.f, static_cast<int>(packed >> 27) - 24);
+			for (int i = 0; i < 3; ++i) { rgba[i] = static_cast<float>((packed >> (9 * i)) & 0x1FFu) * scale; }
+		}
+		else
+		{
+			rgba[0] = decodeUnsignedFloat(packed & 0x7FFu, 6);
+			rgba[1] = decodeUnsignedFloat((packed >> 11) & 0x7FFu, 6);
+			rgba[2] = decodeUnsignedFloat(packed >> 22, 5);
+		}
+		return;
+	}
+
+	for (uint32_t channel = 0; channel < codec.numChannels; ++channel)
+	{
+		const unsigned char* data = source + codec.channelOffset[channel];
+		float value;
+		if (!codec.isFloat) { value = static_cast<float>(*data) * (1.f / 255.f); }
+		else if (codec.channelBits[channel] == 32)
+		{
+			memcpy(&value, data, sizeof(value));
+		}
+		else
+		{
+			glm::detail::hdata half;
+			memcpy(&half, data, sizeof(half));
+			value = glm::detail::toFloat32(half);
+		}
+		const int32_t target = codec.channelTarget[channel];
+		if (target >= 0) { rgba[target] = value; }
+		else if (target == ChannelLuminance)
+		{
+			rgba[0] = rgba[1] = rgba[2] = value;
+		}
+	}
+}
+
+void encodePixel(const PixelCodec& codec, const float* rgba, unsigned char* destination)
+{
+	if (codec.encoding != PixelEncoding::Channels)
+	{
+		uint32_t packed;
+		if (codec.encoding == PixelEncoding::SharedExponentR9G9B9E5) { packed = encodeSharedExponent(rgba); }
+		else
+		{
+			packed = encodeUnsignedFloat(rgba[0], 6) | (encodeUnsignedFloat(rgba[1], 6) << 11) | (encodeUnsignedFloat(rgba[2], 5) << 22);
+		}
+		memcpy(destination, &packed, sizeof(packed));
+		return;
+	}
+
+	for (uint32_t channel = 0; channel < codec.numChannels; ++channel)
+	{
+		unsigned char* data = destination + codec.channelOffset[channel];
+		const int32_t target = codec.channelTarget[channel];
+		float value = 0.f;
+		if (target >= 0) { value = rgba[target]; }
+		else if (target == ChannelLuminance)
+		{
+			value = rgba[0] * .2126f + rgba[1] * .7152f + rgba[2] * .0722f;
+		}
+
+		if (!codec.isFloat) { *data = static_cast<unsigned char>(std::min(std::max(value, 0.f), 1.f) * 255.f + .5f); }
+		else if (codec.channelBits[channel] == 32)
+		{
+			memcpy(data, &value, sizeof(value));
+		}
+		else
+		{
+			const glm::detail::hdata half = glm::detail::toFloat16(value);
+			memcpy(data, &half, sizeof(half));
+		}
+	}
+}
+
+TextureHeader createOutputHeader(PixelFormat pixelFormat, VariableType variableType, uint32_t size, uint32_t numFaces, uint32_t numMipLevels)
+{
+	TextureHeader header;
+	header.setChannelType(variableType);
+	header.setColorSpace(ColorSpace::lRGB);
+	header.setDepth(1);
+	header.setWidth(size);
+	header.setHeight(size);
+	header.setNumMipMapLevels(numMipLevels);
+	header.setNumFaces(numFaces);
+	header.setNumArrayMembers(1);
+	header.setPixelFormat(pixelFormat);
+	return header;
+}
+
+// Cube map addressing, in the usual +X, -X, +Y, -Y, +Z, -Z face order. s and t are in [-1, 1].
+inline void getFaceDirection(uint32_t face, float s, float t, float* direction)
+{
+	switch (face)
+	{
+	case 0: direction[0] = 1.f, direction[1] = -t, direction[2] = -s; break;
+	case 1: direction[0] = -1.f, direction[1] = -t, direction[2] = s; break;
+	case 2: direction[0] = s, direction[1] = 1.f, direction[2] = t; break;
+	case 3: direction[0] = s, direction[1] = -1.f, direction[2] = -t; break;
+	case 4: direction[0] = s, direction[1] = -t, direction[2] = 1.f; break;
+	default: direction[0] = -s, direction[1] = -t, direction[2] = -1.f; break;
+	}
+}
+
+// The inverse of getFaceDirection, with s and t returned in [0, 1].
+inline uint32_t getFaceCoordinates(float x, float y, float z, float& s, float& t)
+{
+	const float absX = fabsf(x), absY = fabsf(y), absZ = fabsf(z);
+	uint32_t face;
+	float majorAxis, sc, tc;
+	if (absX >= absY && absX >= absZ)
+	{
+		face = x > 0.f ? 0 : 1;
+		majorAxis = absX;
+		sc = x > 0.f ? -z : z;
+		tc = -y;
+	}
+	else if (absY >= absZ)
+	{
+		face = y > 0.f ? 2 : 3;
+		majorAxis = absY;
+		sc = x;
+		tc = y > 0.f ? z : -z;
+	}
+	else
+	{
+		face = z > 0.f ? 4 : 5;
+		majorAxis = absZ;
+		sc = z > 0.f ? x : -x;
+		tc = -y;
+	}
+	const float scale = .5f / majorAxis;
+	s = sc * scale + .5f;
+	t = tc * scale + .5f;
+	return face;
+}
+
+// An RGBA float copy of the environment, with a box filtered mip chain for filtered importance sampling.
+struct FloatCubeMap
+{
+	uint32_t size;
+	std::vector<std::vector<float>> levels; // 6 faces of getSize(level)^2 texels each
+
+	uint32_t getNumLevels() const { return static_cast<uint32_t>(levels.size()); }
+	uint32_t getSize(uint32_t level) const { return std::max(size >> level, 1u); }
+	const float* getFace(uint32_t level, uint32_t face) const
+	{
+		const uint32_t levelSize = getSize(level);
+		return levels[level].data() + static_cast<size_t>(face) * levelSize * levelSize * 4;
+	}
+};
+
+FloatCubeMap loadCubeMap(const Texture& environmentMap)
+{
+	PVR_PROFILE_SCOPE("PBRBaker::loadCubeMap");
+	if (environmentMap.getNumFaces() != 6 || environmentMap.getWidth() != environmentMap.getHeight() || environmentMap.getDepth() != 1)
+	{ throw InvalidArgumentError("environmentMap", "PBR baker: The environment map must be a square cube map"); }
+	const PixelCodec codec = getPixelCodec(environmentMap.getPixelFormat(), environmentMap.getChannelType(), "environmentMap");
+
+	FloatCubeMap cube;
+	cube.size = environmentMap.getWidth();
+	uint32_t numLevels = 1;
+	while ((cube.size >> numLevels) != 0) { ++numLevels; }
+	cube.levels.resize(numLevels);
+
+	async::JobSystem& jobs = async::JobSystem::getInstance();
+	const uint32_t size = cube.size;
+	cube.levels[0].resize(static_cast<size_t>(6) * size * size * 4);
+	jobs.parallelFor(0, 6 * size, 0, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t row = begin; row < end; ++row)
+		{
+			const uint32_t face = row / size;
+			const unsigned char* source = environmentMap.getDataPointer(0, 0, face) + static_cast<size_t>(row % size) * size * codec.pixelSize;
+			float* destination = cube.levels[0].data() + static_cast<size_t>(row) * size * 4;
+			for (uint32_t x = 0; x < size; ++x) { decodePixel(codec, source + x * codec.pixelSize, destination + x * 4); }
+		}
+	});
+
+	for (uint32_t level = 1; level < numLevels; ++level)
+	{
+		const uint32_t parentSize = cube.getSize(level - 1);
+		const uint32_t levelSize = cube.getSize(level);
+		cube.levels[level].resize(static_cast<size_t>(6) * levelSize * levelSize * 4);
+		jobs.parallelFor(0, 6 * levelSize, 0, [&](uint32_t begin, uint32_t end) {
+			const Float4 quarter = splat4(.25f);
+			for (uint32_t row = begin; row < end; ++row)
+			{
+				const uint32_t face = row / levelSize;
+				const uint32_t y = row % levelSize;
+				const float* parent = cube.getFace(level - 1, face);
+				const float* row0 = parent + static_cast<size_t>(std::min(y * 2, parentSize - 1)) * parentSize * 4;
+				const float* row1 = parent + static_cast<size_t>(std::min(y * 2 + 1, parentSize - 1)) * parentSize * 4;
+				float* destination = cube.levels[level].data() + static_cast<size_t>(row) * levelSize * 4;
+				for (uint32_t x = 0; x < levelSize; ++x)
+				{
+					const uint32_t x0 = std::min(x * 2, parentSize - 1) * 4;
+					const uint32_t x1 = std::min(x * 2 + 1, parentSize - 1) * 4;
+					const Float4 sum = add4(add4(load4(row0 + x0), load4(row0 + x1)), add4(load4(row1 + x0), load4(row1 + x1)));
+					store4(destination + x * 4, mul4(sum, quarter));
+				}
+			}
+		});
+	}
+	return cube;
+}
+
+inline Float4 sampleBilinear(const FloatCubeMap& cube, uint32_t level, uint32_t face, float s, float t)
+{
+	const uint32_t size = cube.getSize(level);
+	const float maxCoordinate = static_cast<float>(size - 1);
+	const float fx = std::min(std::max(s * static_cast<float>(size) - .5f, 0.f), maxCoordinate);
+	const float fy = std::min(std::max(t * static_cast<float>(size) - .5f, 0.f), maxCoordinate);
+	const uint32_t x0 = static_cast<uint32_t>(fx), y0 = static_cast<uint32_t>(fy);
+	const uint32_t x1 = std::min(x0 + 1, size - 1), y1 = std::min(y0 + 1, size - 1);
+	const float wx = fx - static_cast<float>(x0), wy = fy - static_cast<float>(y0);
+
+	const float* texels = cube.getFace(level, face);
+	const float* row0 = texels + static_cast<size_t>(y0) * size * 4;
+	const float* row1 = texels + static_cast<size_t>(y1) * size * 4;
+	const Float4 top = madd4(sub4(load4(row0 + x1 * 4), load4(row0 + x0 * 4)), splat4(wx), load4(row0 + x0 * 4));
+	const Float4 bottom = madd4(sub4(load4(row1 + x1 * 4), load4(row1 + x0 * 4)), splat4(wx), load4(row1 + x0 * 4));
+	return madd4(sub4(bottom, top), splat4(wy), top);
+}
+
+inline Float4 sampleTrilinear(const FloatCubeMap& cube, float x, float y, float z, float lod)
+{
+	float s, t;
+	const uint32_t face = getFaceCoordinates(x, y, z, s, t);
+	const uint32_t level = static_cast<uint32_t>(lod);
+	const Float4 color = sampleBilinear(cube, level, face, s, t);
+	const float fraction = lod - static_cast<float>(level);
+	if (fraction <= 0.f || level + 1 >= cube.getNumLevels()) { return color; }
+	return madd4(sub4(sampleBilinear(cube, level + 1, face, s, t), color), splat4(fraction), color);
+}
+
+// The GGX sample directions of one roughness, in the tangent space of the reflection vector, as structures of arrays
+// padded to a multiple of 4 with zero weight samples.
+struct PrefilterSamples
+{
+	std::vector<float> x, y, z, weight, lod;
+	float totalWeight;
+
+	void add(float sampleX, float sampleY, float sampleZ, float sampleWeight, float sampleLod)
+	{
+		x.push_back(sampleX);
+		y.push_back(sampleY);
+		z.push_back(sampleZ);
+		weight.push_back(sampleWeight);
+		lod.push_back(sampleLod);
+		totalWeight += sampleWeight;
+	}
+};
+
+PrefilterSamples createPrefilterSamples(float roughness, uint32_t numSamples, const FloatCubeMap& cube, uint32_t outputSize)
+{
+	PrefilterSamples samples;
+	samples.totalWeight = 0.f;
+	if (roughness <= 0.f)
+	{
+		// A perfect mirror: every sample would be the reflection vector itself, read from the level matching the output.
+		samples.add(0.f, 0.f, 1.f, 1.f, std::max(log2f(static_cast<float>(cube.size) / static_cast<float>(outputSize)), 0.f));
+	}
+	else
+	{
+		const glm::vec3 N(0.f, 0.f, 1.f);
+		const float alphaSquared = roughness * roughness * roughness * roughness;
+		const float texelSolidAngle = 4.f * Pi / (6.f * static_cast<float>(cube.size) * static_cast<float>(cube.size));
+		const float maxLod = static_cast<float>(cube.getNumLevels() - 1);
+		for (uint32_t i = 0; i < numSamples; ++i)
+		{
+			const glm::vec3 H = importanceSampleGGX(hammersley(i, numSamples), roughness, N);
+			// With the usual N = V = R assumption, L is the reflection of N about H.
+			const float NoH = H.z;
+			const glm::vec3 L = 2.f * NoH * H - N;
+			if (L.z <= 0.f) { continue; }
+
+			// Filtered importance sampling: read the sample from the mip level whose texels cover its solid angle.
+			// With N = V the pdf D * NoH / (4 * VoH) reduces to D / 4.
+			const float denominator = NoH * NoH * (alphaSquared - 1.f) + 1.f;
+			const float pdf = alphaSquared / (Pi * denominator * denominator) * .25f;
+			const float sampleSolidAngle = 1.f / (static_cast<float>(numSamples) * pdf + .0001f);
+			const float lod = std::min(std::max(.5f * log2f(sampleSolidAngle / texelSolidAngle) + 1.f, 0.f), maxLod);
+			samples.add(L.x, L.y, L.z, L.z, lod);
+		}
+	}
+	while (samples.x.size() & 3u) { samples.add(0.f, 0.f, 1.f, 0.f, 0.f); }
+	return samples;
+}
+
+// Computes one tangent frame per texel, then transforms 4 sample directions at a time into it.
+void prefilterRows(const FloatCubeMap& cube, const PrefilterSamples& samples, const PixelCodec& codec, Texture& output, uint32_t level, uint32_t rowBegin, uint32_t rowEnd)
+{
+	const uint32_t size = output.getWidth(level);
+	const float invSize = 1.f / static_cast<float>(size);
+	const float invTotalWeight = 1.f / samples.totalWeight;
+	const uint32_t numSamples = static_cast<uint32_t>(samples.x.size());
+	float directionX[4], directionY[4], directionZ[4];
+
+	for (uint32_t row = rowBegin; row < rowEnd; ++row)
+	{
+		const uint32_t face = row / size;
+		const uint32_t y = row % size;
+		unsigned char* destination = output.getDataPointer(level, 0, face) + static_cast<size_t>(y) * size * codec.pixelSize;
+		for (uint32_t x = 0; x < size; ++x)
+		{
+			float normal[3];
+			getFaceDirection(face, (static_cast<float>(x) + .5f) * invSize * 2.f - 1.f, (static_cast<float>(y) + .5f) * invSize * 2.f - 1.f, normal);
+			const glm::vec3 N = glm::normalize(glm::vec3(normal[0], normal[1], normal[2]));
+			const glm::vec3 up = fabsf(N.z) < .999f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(1.f, 0.f, 0.f);
+			const glm::vec3 T = glm::normalize(glm::cross(up, N));
+			const glm::vec3 B = glm::cross(N, T);
+			const Float4 tx = splat4(T.x), ty = splat4(T.y), tz = splat4(T.z);
+			const Float4 bx = splat4(B.x), by = splat4(B.y), bz = splat4(B.z);
+			const Float4 nx = splat4(N.x), ny = splat4(N.y), nz = splat4(N.z);
+
+			Float4 color = splat4(0.f);
+			for (uint32_t i = 0; i < numSamples; i += 4)
+			{
+				const Float4 sx = load4(&samples.x[i]), sy = load4(&samples.y[i]), sz = load4(&samples.z[i]);
+				store4(directionX, madd4(tx, sx, madd4(bx, sy, mul4(nx, sz))));
+				store4(directionY, madd4(ty, sx, madd4(by, sy, mul4(ny, sz))));
+				store4(directionZ, madd4(tz, sx, madd4(bz, sy, mul4(nz, sz))));
+				for (uint32_t lane = 0; lane < 4; ++lane)
+				{
+					const Float4 sample = sampleTrilinear(cube, directionX[lane], directionY[lane], directionZ[lane], samples.lod[i + lane]);
+					color = madd4(sample, splat4(samples.weight[i + lane]), color);
+				}
+			}
+			float rgba[4];
+			store4(rgba, mul4(color, splat4(invTotalWeight)));
+			rgba[3] = 1.f;
+			encodePixel(codec, rgba, destination + x * codec.pixelSize);
+		}
+	}
+}
+
+// The real spherical harmonics basis functions of the first three bands.
+inline void evaluateSphericalHarmonicsBasis(float x, float y, float z, float* basis)
+{
+	basis[0] = .282095f;
+	basis[1] = .488603f * y;
+	basis[2] = .488603f * z;
+	basis[3] = .488603f * x;
+	basis[4] = 1.092548f * x * y;
+	basis[5] = 1.092548f * y * z;
+	basis[6] = .315392f * (3.f * z * z - 1.f);
+	basis[7] = 1.092548f * x * z;
+	basis[8] = .546274f * (x * x - y * y);
+}
+
+// The integral of the solid angle of a cube face from its centre to (x, y), in face coordinates.
+inline float getCubeAreaElement(float x, float y) { return atan2f(x * y, sqrtf(x * x + y * y + 1.f)); }
+
+SphericalHarmonics9 projectCubeMap(const FloatCubeMap& cube)
+{
+	PVR_PROFILE_SCOPE("PBRBaker::projectToSphericalHarmonics");
+	// Nine coefficients only capture the lowest frequencies, so a 64x64 mip level projects as well as the full map.
+	uint32_t level = 0;
+	while (cube.getSize(level) > 64 && level + 1 < cube.getNumLevels()) { ++level; }
+	const uint32_t size = cube.getSize(level);
+	const float invSize = 1.f / static_cast<float>(size);
+
+	// One partial sum (9 RGBA coefficients and the solid angle) per row, summed in order afterwards so that the
+	// result does not depend on the scheduling.
+	const uint32_t numRows = 6 * size;
+	std::vector<float> rowSums(static_cast<size_t>(numRows) * 40);
+	async::JobSystem::getInstance().parallelFor(0, numRows, 0, [&](uint32_t begin, uint32_t end) {
+		float basis[9];
+		for (uint32_t row = begin; row < end; ++row)
+		{
+			const uint32_t face = row / size;
+			const uint32_t y = row % size;
+			const float* texels = cube.getFace(level, face) + static_cast<size_t>(y) * size * 4;
+			Float4 sums[9];
+			for (uint32_t i = 0; i < 9; ++i) { sums[i] = splat4(0.f); }
+			float solidAngleSum = 0.f;
+
+			const float t = (static_cast<float>(y) + .5f) * invSize * 2.f - 1.f;
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				const float s = (static_cast<float>(x) + .5f) * invSize * 2.f - 1.f;
+				const float x0 = s - invSize, x1 = s + invSize, y0 = t - invSize, y1 = t + invSize;
+				const float solidAngle = getCubeAreaElement(x0, y0) - getCubeAreaElement(x0, y1) - getCubeAreaElement(x1, y0) + getCubeAreaElement(x1, y1);
+				float direction[3];
+				getFaceDirection(face, s, t, direction);
+				const float invLength = 1.f / sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+				evaluateSphericalHarmonicsBasis(direction[0] * invLength, direction[1] * invLength, direction[2] * invLength, basis);
+
+				const Float4 color = load4(texels + x * 4);
+				for (uint32_t i = 0; i < 9; ++i) { sums[i] = madd4(color, splat4(basis[i] * solidAngle), sums[i]); }
+				solidAngleSum += solidAngle;
+			}
+			float* rowSum = rowSums.data() + static_cast<size_t>(row) * 40;
+			for (uint32_t i = 0; i < 9; ++i) { store4(rowSum + i * 4, sums[i]); }
+			rowSum[36] = solidAngleSum;
+		}
+	});
+
+	double totals[9][3] = {};
+	double totalSolidAngle = 0.;
+	for (uint32_t row = 0; row < numRows; ++row)
+	{
+		const float* rowSum = rowSums.data() + static_cast<size_t>(row) * 40;
+		for (uint32_t i = 0; i < 9; ++i)
+		{
+			for (uint32_t channel = 0; channel < 3; ++channel) { totals[i][channel] += rowSum[i * 4 + channel]; }
+		}
+		totalSolidAngle += rowSum[36];
+	}
+
+	// Correct the small error of the discrete solid angles, which should add up to 4 pi.
+	const double normalisation = 4. * Pi / totalSolidAngle;
+	SphericalHarmonics9 result;
+	for (uint32_t i = 0; i < 9; ++i)
+	{
+		for (uint32_t channel = 0; channel < 3; ++channel) { result.coefficients[i][channel] = static_cast<float>(totals[i][channel] * normalisation); }
+	}
+	return result;
+}
+
+uint32_t getNumMipLevels(uint32_t size)
+{
+	return static_cast<uint32_t>(log2(static_cast<float>(size)) + 1.0f);
+}
+} // namespace
+
+Texture bakeCookTorranceBRDFLUT(uint32_t mapDim, uint32_t numSamples)
+{
+	PVR_PROFILE_SCOPE("PBRBaker::bakeCookTorranceBRDFLUT");
+	if (!mapDim || !numSamples) { throw InvalidArgumentError("mapDim, numSamples", "bakeCookTorranceBRDFLUT: The size and number of samples must not be zero"); }
+	TextureHeader header;
+	header.setWidth(mapDim);
+	header.setHeight(mapDim);
+	header.setChannelType(VariableType::SignedFloat);
+	header.setNumFaces(1);
+	header.setNumMipMapLevels(1);
+	header.setPixelFormat(PixelFormat::RG_1616());
+	Texture result(header);
+	const PixelCodec codec = getPixelCodec(header.getPixelFormat(), header.getChannelType(), "header");
+
+	const uint32_t numPaddedSamples = roundUpToMultipleOf4(numSamples);
+	const float invNumSamples = 1.f / static_cast<float>(numSamples);
+	async::JobSystem::getInstance().parallelFor(0, mapDim, 0, [&](uint32_t begin, uint32_t end) {
+		// Only the x and z components of the half vectors matter, as V has no y component. The padding samples have
+		// H = 0, which makes N dot L negative so that they are discarded.
+		std::vector<float> halfX(numPaddedSamples, 0.f), halfZ(numPaddedSamples, 0.f);
+		const glm::vec3 N(0.0f, 0.0f, 1.0f);
+		const Float4 zero = splat4(0.f), one = splat4(1.f), two = splat4(2.f), epsilon = splat4(.001f);
+
+		for (uint32_t y = begin; y < end; ++y)
+		{
+			// Rows share the roughness, hence the sample directions.
+			const float roughness = (static_cast<float>(y) + .5f) / static_cast<float>(mapDim);
+			for (uint32_t i = 0; i < numSamples; ++i)
+			{
+				const glm::vec3 H = importanceSampleGGX(hammersley(i, numSamples), roughness, N);
+				halfX[i] = H.x;
+				halfZ[i] = H.z;
+			}
+			const float k = (roughness * roughness) * .5f;
+			const Float4 kVector = splat4(k), oneMinusK = splat4(1.f - k);
+
+			unsigned char* destination = result.getDataPointer() + static_cast<size_t>(y) * mapDim * codec.pixelSize;
+			for (uint32_t x = 0; x < mapDim; ++x)
+			{
+				const float NoV = (static_cast<float>(x) + .5f) / static_cast<float>(mapDim);
+				const float currentNoV = std::max(NoV, .001f);
+				const Float4 vx = splat4(sqrtf(std::min(std::max(1.f - NoV * NoV, 0.f), 1.f)));
+				const Float4 vz = splat4(NoV);
+				// G1(k, NoV) / (NoH * NoV) is the same for all samples.
+				const Float4 viewTerm = splat4(G1(k, currentNoV) / currentNoV);
+
+				Float4 sumA = zero, sumB = zero;
+				for (uint32_t i = 0; i < numPaddedSamples; i += 4)
+				{
+					const Float4 hx = load4(&halfX[i]), hz = load4(&halfZ[i]);
+					const Float4 VoHUnclamped = madd4(vx, hx, mul4(vz, hz));
+					const Float4 NoL = sub4(mul4(mul4(two, VoHUnclamped), hz), vz);
+					const Float4 NoH = max4(hz, epsilon);
+					const Float4 VoH = max4(VoHUnclamped, epsilon);
+
+					const Float4 G1L = div4(NoL, madd4(NoL, oneMinusK, kVector));
+					const Float4 G_Vis = div4(mul4(mul4(G1L, viewTerm), VoH), NoH);
+					const Float4 oneMinusVoH = sub4(one, VoH);
+					const Float4 oneMinusVoHSquared = mul4(oneMinusVoH, oneMinusVoH);
+					const Float4 Fc = mul4(mul4(oneMinusVoHSquared, oneMinusVoHSquared), oneMinusVoH);
+					const Float4 FcG_Vis = mul4(Fc, G_Vis);
+
+					sumA = add4(sumA, selectGreater4(NoL, zero, sub4(G_Vis, FcG_Vis)));
+					sumB = add4(sumB, selectGreater4(NoL, zero, FcG_Vis));
+				}
+				const float rgba[4] = { sum4(sumA) * invNumSamples, sum4(sumB) * invNumSamples, 0.f, 1.f };
+				encodePixel(codec, rgba, destination + x * codec.pixelSize);
+			}
+		}
+	});
+	return result;
+}
+
+SphericalHarmonics9 projectToSphericalHarmonics(const Texture& environmentMap) { return projectCubeMap(loadCubeMap(environmentMap)); }
+
+Texture bakeIrradianceMap(const SphericalHarmonics9& radiance, PixelFormat outputPixelFormat, VariableType outputVariableType, uint32_t mapSize)
+{
+	PVR_PROFILE_SCOPE("PBRBaker::bakeIrradianceMap");
+	if (!mapSize) { throw InvalidArgumentError("mapSize", "bakeIrradianceMap: The map size must not be zero"); }
+	const PixelCodec codec = getPixelCodec(outputPixelFormat, outputVariableType, "outputPixelFormat");
+	const uint32_t numMipLevels = getNumMipLevels(mapSize);
+	Texture result(createOutputHeader(outputPixelFormat, outputVariableType, mapSize, 6, numMipLevels));
+
+	// Convolution with the clamped cosine lobe scales the bands by pi, 2pi/3 and pi/4. The maps store irradiance / pi.
+	const float bandScales[9] = { 1.f, 2.f / 3.f, 2.f / 3.f, 2.f / 3.f, .25f, .25f, .25f, .25f, .25f };
+	float coefficients[9][4];
+	for (uint32_t i = 0; i < 9; ++i)
+	{
+		for (uint32_t channel = 0; channel < 3; ++channel) { coefficients[i][channel] = radiance.coefficients[i][channel] * bandScales[i]; }
+		coefficients[i][3] = 0.f;
+	}
+
+	for (uint32_t level = 0; level < numMipLevels; ++level)
+	{
+		const uint32_t size = result.getWidth(level);
+		const float invSize = 1.f / static_cast<float>(size);
+		async::JobSystem::getInstance().parallelFor(0, 6 * size, 0, [&](uint32_t begin, uint32_t end) {
+			float basis[9];
+			for (uint32_t row = begin; row < end; ++row)
+			{
+				const uint32_t face = row / size;
+				const uint32_t y = row % size;
+				unsigned char* destination = result.getDataPointer(level, 0, face) + static_cast<size_t>(y) * size * codec.pixelSize;
+				for (uint32_t x = 0; x < size; ++x)
+				{
+					float direction[3];
+					getFaceDirection(face, (static_cast<float>(x) + .5f) * invSize * 2.f - 1.f, (static_cast<float>(y) + .5f) * invSize * 2.f - 1.f, direction);
+					const float invLength = 1.f / sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+					evaluateSphericalHarmonicsBasis(direction[0] * invLength, direction[1] * invLength, direction[2] * invLength, basis);
+
+					Float4 irradiance = splat4(0.f);
+					for (uint32_t i = 0; i < 9; ++i) { irradiance = madd4(load4(coefficients[i]), splat4(basis[i]), irradiance); }
+					float rgba[4];
+					store4(rgba, max4(irradiance, splat4(0.f)));
+					rgba[3] = 1.f;
+					encodePixel(codec, rgba, destination + x * codec.pixelSize);
+				}
+			}
+		});
+	}
+	return result;
+}
+
+Texture bakeIrradianceMap(const Texture& environmentMap, PixelFormat outputPixelFormat, VariableType outputVariableType, uint32_t mapSize)
+{
+	return bakeIrradianceMap(projectToSphericalHarmonics(environmentMap), outputPixelFormat, outputVariableType, mapSize);
+}
+
+Texture bakePreFilteredMap(const Texture& environmentMap, PixelFormat outputPixelFormat, VariableType outputVariableType, uint32_t mapSize, bool zeroRoughnessIsExternal,
+	int numMipLevelsToDiscard, uint32_t mapNumSamples)
+{
+	PVR_PROFILE_SCOPE("PBRBaker::bakePreFilteredMap");
+	if (!mapSize || (mapSize & (mapSize - 1))) { throw InvalidArgumentError("mapSize", "bakePreFilteredMap: The map size must be a power of two"); }
+	if (!mapNumSamples) { throw InvalidArgumentError("mapNumSamples", "bakePreFilteredMap: The number of samples must not be zero"); }
+	const int numLevelsAfterDiscard = static_cast<int>(getNumMipLevels(mapSize)) - numMipLevelsToDiscard;
+	if (numLevelsAfterDiscard < 1) { throw InvalidArgumentError("numMipLevelsToDiscard", "bakePreFilteredMap: All mip levels would be discarded"); }
+	const uint32_t numMipLevels = static_cast<uint32_t>(numLevelsAfterDiscard);
+
+	const PixelCodec codec = getPixelCodec(outputPixelFormat, outputVariableType, "outputPixelFormat");
+	const FloatCubeMap cube = loadCubeMap(environmentMap);
+	Texture result(createOutputHeader(outputPixelFormat, outputVariableType, mapSize, 6, numMipLevels));
+
+	const float maxmip = static_cast<float>(numMipLevels - 1);
+	for (uint32_t mipLevel = 0; mipLevel < numMipLevels; ++mipLevel)
+	{
+		// The same roughness per level as generatePreFilteredMapMipmapStyle, so that the maps are interchangeable.
+		const float mip = static_cast<float>(mipLevel);
+		float roughness = maxmip > 0.f ? mip / maxmip : 0.f;
+		if (zeroRoughnessIsExternal && maxmip > 0.f) { roughness = mip * (1.f / maxmip) * (1.f - 1.f / maxmip) + 1.f / maxmip; }
+
+		const uint32_t size = result.getWidth(mipLevel);
+		const PrefilterSamples samples = createPrefilterSamples(roughness, mapNumSamples, cube, size);
+		async::JobSystem::getInstance().parallelFor(
+			0, 6 * size, 0, [&](uint32_t begin, uint32_t end) { prefilterRows(cube, samples, codec, result, mipLevel, begin, end); });
+	}
+	return result;
+}
+
+void saveBakedTexture(const Texture& texture, const std::string& filename) { assetWriters::writePVR(texture, FileStream(filename, "wb")); }
+} // namespace utils
+} // namespace pvr
+//!\endcond
@@ -0,0 +1,72 @@
+/*!
+\brief Contains API independent, multithreaded CPU bakers for the Image Based Lighting maps used for Physically Based Rendering.
+\file PVRUtils/PBRBaker.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/texture/Texture.h"
+#include <string>
+
+namespace pvr {
+namespace utils {
+/// <summary>The second order (9 coefficient) spherical harmonics projection of the radiance of an environment.</summary>
+struct SphericalHarmonics9
+{
+	/// <summary>The coefficients, in the order L00, L1-1, L10, L11, L2-2, L2-1, L20, L21, L22, each as red, green, blue</summary>
+	float coefficients[9][3];
+};
+
+/// <summary>Generates a Cook Torrance BRDF lookup table on the CPU. The table is identical to the one generated by
+/// generateCookTorranceBRDFLUT: RG_1616 SignedFloat, with N dot V along x and roughness along y. Rows are baked in
+/// parallel on the pvr::async::JobSystem, and the samples of each texel are accumulated four at a time with SIMD.</summary>
+/// <param name="mapDim">The width and height of the table</param>
+/// <param name="numSamples">The number of importance sampled GGX directions used per texel</param>
+/// <returns>The generated texture</returns>
+Texture bakeCookTorranceBRDFLUT(uint32_t mapDim = 256, uint32_t numSamples = 1024);
+
+/// <summary>Projects the radiance of an environment cube map onto the first 9 spherical harmonics basis functions.</summary>
+/// <param name="environmentMap">A square cube map. Supported formats are 8 bit normalised, 16 and 32 bit float channels,
+/// RGB9E5 and B10G11R11 unsigned float.</param>
+/// <returns>The spherical harmonics coefficients</returns>
+SphericalHarmonics9 projectToSphericalHarmonics(const Texture& environmentMap);
+
+/// <summary>Generates a mipmapped diffuse irradiance cube map on the CPU, from the spherical harmonics projection of
+/// the environment. The irradiance is divided by pi, as expected by the shaders of the generateIrradianceMap maps.</summary>
+/// <param name="radiance">The spherical harmonics projection of the environment</param>
+/// <param name="outputPixelFormat">The format of the generated map</param>
+/// <param name="outputVariableType">The variable type of the generated map</param>
+/// <param name="mapSize">The size of the map to generate. All mip levels down to 1x1 are generated.</param>
+/// <returns>The generated texture</returns>
+Texture bakeIrradianceMap(const SphericalHarmonics9& radiance, PixelFormat outputPixelFormat, VariableType outputVariableType, uint32_t mapSize = 64);
+
+/// <summary>Generates a mipmapped diffuse irradiance cube map on the CPU. Equivalent to calling
+/// bakeIrradianceMap(projectToSphericalHarmonics(environmentMap), ...).</summary>
+/// <param name="environmentMap">A square cube map, in one of the formats supported by projectToSphericalHarmonics</param>
+/// <param name="outputPixelFormat">The format of the generated map</param>
+/// <param name="outputVariableType">The variable type of the generated map</param>
+/// <param name="mapSize">The size of the map to generate</param>
+/// <returns>The generated texture</returns>
+Texture bakeIrradianceMap(const Texture& environmentMap, PixelFormat outputPixelFormat, VariableType outputVariableType, uint32_t mapSize = 64);
+
+/// <summary>Generates a GGX prefiltered specular cube map on the CPU, laid out like the maps of generatePreFilteredMapMipmapStyle:
+/// each mip level corresponds to a roughness value from 0 to 1.0. Uses filtered importance sampling, reading each sample from
+/// the mip level of the environment that matches its solid angle, so far fewer samples are needed than on the GPU.
+/// Texels of all faces are baked in parallel on the pvr::async::JobSystem.</summary>
+/// <param name="environmentMap">A square cube map, in one of the formats supported by projectToSphericalHarmonics</param>
+/// <param name="outputPixelFormat">The format of the generated map</param>
+/// <param name="outputVariableType">The variable type of the generated map</param>
+/// <param name="mapSize">The size of the map to generate. Must be a power of two.</param>
+/// <param name="zeroRoughnessIsExternal">Denotes that the source environment map itself will be used for the roughness 0 level</param>
+/// <param name="numMipLevelsToDiscard">The number of mip map levels to discard from the bottom of the chain</param>
+/// <param name="mapNumSamples">The number of samples to use per texel</param>
+/// <returns>The generated texture</returns>
+Texture bakePreFilteredMap(const Texture& environmentMap, PixelFormat outputPixelFormat, VariableType outputVariableType, uint32_t mapSize, bool zeroRoughnessIsExternal,
+	int numMipLevelsToDiscard, uint32_t mapNumSamples = 1024);
+
+/// <summary>Saves a baked texture, including all of its faces and mip levels, as a PVR file.</summary>
+/// <param name="texture">The texture to save</param>
+/// <param name="filename">The path of the file to create</param>
+void saveBakedTexture(const Texture& texture, const std::string& filename);
+} // namespace utils
+} // namespace pvr
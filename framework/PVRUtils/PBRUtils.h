@@ -8,6 +8,7 @@
 #pragma once
 #include "PVRCore/glm.h"
 #include "PVRCore/texture/Texture.h"
+#include "PVRUtils/PBRBaker.h"
 namespace pvr {
 namespace utils {
 namespace {
@@ -27,7 +28,7 @@ inline glm::vec2 hammersley(uint32_t i, uint32_t N)
 inline float G1(float k, float NoV) { return NoV / (NoV * (1.0f - k) + k); }
 
 // Geometric Shadowing function
-float gSmith(float NoL, float NoV, float roughness)
+inline float gSmith(float NoL, float NoV, float roughness)
 {
 	float k = (roughness * roughness) * 0.5f;
 	return G1(k, NoL) * G1(k, NoV);
@@ -35,7 +36,7 @@ float gSmith(float NoL, float NoV, float roughness)
 
 // Sample a half-vector in world space
 // Based on http://blog.selfshadow.com/publications/s2013-shading-course/karis/s2013_pbs_epic_slides.pdf
-glm::vec3 importanceSampleGGX(glm::vec2 Xi, float roughness, glm::vec3 N)
+inline glm::vec3 importanceSampleGGX(glm::vec2 Xi, float roughness, glm::vec3 N)
 {
 	// Maps a 2D point to a hemisphere with spread based on roughness
 	float a = roughness * roughness;
@@ -53,7 +54,7 @@ glm::vec3 importanceSampleGGX(glm::vec2 Xi, float roughness, glm::vec3 N)
 }
 
 // http://blog.selfshadow.com/publications/s2013-shading-course/karis/s2013_pbs_epic_notes_v2.pdf
-glm::vec2 integrateBRDF(float roughness, float NoV)
+inline glm::vec2 integrateBRDF(float roughness, float NoV)
 {
 	const glm::vec3 N = glm::vec3(0.0, 0.0, 1.0); // normal always pointing forward.
 	const glm::vec3 V = glm::vec3(sqrt(glm::clamp(1.0 - NoV * NoV, 0.0, 1.0)), 0.0, NoV);
@@ -88,40 +89,9 @@ glm::vec2 integrateBRDF(float roughness, float NoV)
 }
 } // namespace
 
-/// <summary>Generates BRDF lookup table image.</summary>
+/// <summary>Generates BRDF lookup table image. Delegates to the multithreaded bakeCookTorranceBRDFLUT.</summary>
 /// <param name="mapDim">Out put image size. Default 256</param>
 /// <returns>A generated texture containing a Cook Torrance BRDF Lookup table</returns>
-inline pvr::Texture generateCookTorranceBRDFLUT(uint32_t mapDim = 256)
-{
-	pvr::TextureHeader header;
-	header.setWidth(mapDim);
-	header.setHeight(mapDim);
-	header.setChannelType(pvr::VariableType::SignedFloat);
-	header.setNumFaces(1);
-	header.setNumMipMapLevels(1);
-	header.setPixelFormat(pvr::PixelFormat::RG_1616());
-
-	pvr::Texture returnTex(header);
-
-	const uint32_t stride = sizeof(glm::detail::hdata);
-	const uint32_t formatStride = stride * 2;
-
-	uint32_t offset = 0;
-	for (uint32_t j = 0; j < mapDim; ++j) // y
-	{
-		for (uint32_t i = 0; i < mapDim; ++i) // x
-		{
-			glm::vec2 v2 = integrateBRDF((static_cast<float>(j) + .5f) / static_cast<float>(mapDim), ((static_cast<float>(i) + .5f) / static_cast<float>(mapDim)));
-			glm::detail::hdata halfR = glm::detail::toFloat16(v2.r);
-			glm::detail::hdata halfG = glm::detail::toFloat16(v2.g);
-
-			memcpy(returnTex.getDataPointer() + offset, &halfR, stride);
-			memcpy(returnTex.getDataPointer() + offset + stride, &halfG, stride);
-			offset += formatStride;
-		}
-	}
-
-	return returnTex;
-}
+inline pvr::Texture generateCookTorranceBRDFLUT(uint32_t mapDim = 256) { return bakeCookTorranceBRDFLUT(mapDim); }
 } // namespace utils
 } // namespace pvr
@@ -14,4 +14,7 @@
 #include "PVRUtils/OpenGLES/ErrorsGles.h"
 #include "PVRUtils/OpenGLES/ConvertToGlesTypes.h"
 #include "PVRUtils/OpenGLES/TextureUtilsGles.h"
+#include "PVRUtils/OpenGLES/StateCacheGles.h"
+#include "PVRUtils/OpenGLES/StreamBufferGles.h"
+#include "PVRUtils/OpenGLES/TextureStreamerGles.h"
 #include "PVRAssets/Helper.h"
@@ -10,9 +10,15 @@
 #include "PVRAssets/PVRAssets.h"
 #include "PVRVk/PVRVk.h"
 #include "PVRUtils/Vulkan/UIRendererVk.h"
+#include "PVRUtils/Vulkan/SpriteBatchVk.h"
 #include "PVRUtils/Vulkan/HelperVk.h"
 #include "PVRUtils/Vulkan/ShaderUtilsVk.h"
 #include "PVRUtils/Vulkan/AsynchronousVk.h"
+#include "PVRUtils/Vulkan/GpuProfilerVk.h"
+#include "PVRUtils/Vulkan/RenderGraphVk.h"
+#include "PVRUtils/Vulkan/MemoryManagerVk.h"
+#include "PVRUtils/Vulkan/FrameResourcesVk.h"
+#include "PVRUtils/Vulkan/QueueSchedulerVk.h"
 #include "PVRUtils/StructuredMemory.h"
 
 /*****************************************************************************/
@@ -23,6 +23,158 @@ class StructuredMemoryEntry;
 class StructuredBufferView;
 //!\endcond
 
+/// <summary>Records the byte ranges of each dynamic slice of a buffer that were written since they were last cleared, so that only those
+/// ranges need to be flushed or copied to the GPU. Overlapping and adjacent writes are merged as they are recorded, so writing the
+/// members of a structure one after the other produces a single range.</summary>
+class DirtyRangeTracker
+{
+public:
+	/// <summary>A range of bytes [begin, end) of the buffer</summary>
+	struct Range
+	{
+		uint64_t begin; //!< The offset of the first byte of the range from the start of the buffer
+		uint64_t end; //!< The offset of the byte following the range
+
+		/// <summary>Get the size of the range</summary>
+		/// <returns>The size in bytes</returns>
+		uint64_t size() const { return end - begin; }
+	};
+
+	/// <summary>The maximum number of ranges kept for a dynamic slice. Beyond it, the two ranges separated by the smallest gap are merged,
+	/// flushing the bytes in between as well, which bounds the cost of recording a write and the number of ranges to flush.</summary>
+	static const uint32_t MaxRangesPerSlice = 16;
+
+	/// <summary>Constructor. Call init() before recording writes.</summary>
+	DirtyRangeTracker() : _dynamicSliceSize(0) {}
+
+	/// <summary>Set the layout of the buffer and clear all the ranges</summary>
+	/// <param name="numDynamicSlices">The number of dynamic slices of the buffer</param>
+	/// <param name="dynamicSliceSize">The size in bytes of each dynamic slice</param>
+	void init(uint32_t numDynamicSlices, uint64_t dynamicSliceSize)
+	{
+		_slices.assign(std::max(numDynamicSlices, 1u), std::vector<Range>());
+		for (auto& slice : _slices) { slice.reserve(MaxRangesPerSlice + 1); }
+		_dynamicSliceSize = dynamicSliceSize;
+	}
+
+	/// <summary>Record that bytes of the buffer were written</summary>
+	/// <param name="offset">The offset of the first byte written from the start of the buffer</param>
+	/// <param name="size">The number of bytes written</param>
+	void markDirty(uint64_t offset, uint64_t size)
+	{
+		if (_slices.empty()) { return; }
+		const uint32_t lastSlice = static_cast<uint32_t>(_slices.size()) - 1;
+		while (size)
+		{
+			// Writes are split at the slice boundaries, so that each slice can be flushed on its own
+			const uint32_t slice = _dynamicSliceSize ? static_cast<uint32_t>(std::min<uint64_t>(offset / _dynamicSliceSize, lastSlice)) : 0;
+			const uint64_t sliceEnd = (slice == lastSlice || !_dynamicSliceSize) ? offset + size : (slice + 1) * _dynamicSliceSize;
+			const uint64_t end = std::min(offset + size, sliceEnd);
+			addRange(_slices[slice], offset, end);
+			size -= end - offset;
+			offset = end;
+		}
+	}
+
+	/// <summary>Record that a whole dynamic slice was written</summary>
+	/// <param name="dynamicSlice">The dynamic slice</param>
+	void markDynamicSliceDirty(uint32_t dynamicSlice)
+	{
+		std::vector<Range>& ranges = _slices[dynamicSlice];
+		ranges.clear();
+		ranges.push_back(Range{ dynamicSlice * _dynamicSliceSize, (dynamicSlice + 1) * _dynamicSliceSize });
+	}
+
+	/// <summary>Check whether any byte of a dynamic slice was written since it was last cleared</summary>
+	/// <param name="dynamicSlice">The dynamic slice</param>
+	/// <returns>True if the dynamic slice has dirty ranges</returns>
+	bool isDirty(uint32_t dynamicSlice) const { return !_slices[dynamicSlice].empty(); }
+
+	/// <summary>Get the ranges written in a dynamic slice since it was last cleared</summary>
+	/// <param name="dynamicSlice">The dynamic slice</param>
+	/// <returns>The ranges, sorted, disjoint and not adjacent to each other</returns>
+	const std::vector<Range>& getDirtyRanges(uint32_t dynamicSlice) const { return _slices[dynamicSlice]; }
+
+	/// <summary>Get the ranges written in a dynamic slice, expanded to a multiple of an alignment, such as nonCoherentAtomSize, and merged
+	/// where the expanded ranges touch</summary>
+	/// <param name="dynamicSlice">The dynamic slice</param>
+	/// <param name="alignment">The alignment of the offset and size of the ranges. Must be a power of two</param>
+	/// <param name="limit">The size of the buffer or memory the ranges must not extend past. The last range may then end unaligned at the limit</param>
+	/// <param name="outRanges">Receives the ranges. Must hold MaxRangesPerSlice ranges</param>
+	/// <returns>The number of ranges</returns>
+	uint32_t getAlignedDirtyRanges(uint32_t dynamicSlice, uint64_t alignment, uint64_t limit, Range* outRanges) const
+	{
+		debug_assertion(alignment && (alignment & (alignment - 1)) == 0, "DirtyRangeTracker: The alignment must be a power of two");
+		uint32_t numRanges = 0;
+		for (const Range& range : _slices[dynamicSlice])
+		{
+			const uint64_t begin = range.begin & ~(alignment - 1);
+			const uint64_t end = std::min((range.end + alignment - 1) & ~(alignment - 1), limit);
+			if (numRanges && begin <= outRanges[numRanges - 1].end) { outRanges[numRanges - 1].end = std::max(outRanges[numRanges - 1].end, end); }
+			else
+			{
+				outRanges[numRanges++] = Range{ begin, end };
+			}
+		}
+		return numRanges;
+	}
+
+	/// <summary>Clear the ranges of a dynamic slice, typically once they have been flushed</summary>
+	/// <param name="dynamicSlice">The dynamic slice</param>
+	void clear(uint32_t dynamicSlice) { _slices[dynamicSlice].clear(); }
+
+	/// <summary>Clear the ranges of all the dynamic slices</summary>
+	void clearAll()
+	{
+		for (auto& slice : _slices) { slice.clear(); }
+	}
+
+	/// <summary>Get the number of dynamic slices tracked</summary>
+	/// <returns>The number of dynamic slices</returns>
+	uint32_t getNumDynamicSlices() const { return static_cast<uint32_t>(_slices.size()); }
+
+private:
+	static void addRange(std::vector<Range>& ranges, uint64_t begin, uint64_t end)
+	{
+		// Fast path: values are usually written in increasing order of offset
+		if (ranges.empty() || begin > ranges.back().end) { ranges.push_back(Range{ begin, end }); }
+		else if (begin >= ranges.back().begin)
+		{
+			ranges.back().end = std::max(ranges.back().end, end);
+			return;
+		}
+		else
+		{
+			// Merge with every range that overlaps or touches [begin, end)
+			auto first = std::lower_bound(ranges.begin(), ranges.end(), begin, [](const Range& range, uint64_t value) { return range.end < value; });
+			auto last = first;
+			while (last != ranges.end() && last->begin <= end)
+			{
+				begin = std::min(begin, last->begin);
+				end = std::max(end, last->end);
+				++last;
+			}
+			first = ranges.erase(first, last);
+			ranges.insert(first, Range{ begin, end });
+		}
+
+		if (ranges.size() > MaxRangesPerSlice)
+		{
+			// Merge the two neighbours separated by the smallest gap
+			size_t closest = 0;
+			for (size_t i = 1; i + 1 < ranges.size(); ++i)
+			{
+				if (ranges[i + 1].begin - ranges[i].end < ranges[closest + 1].begin - ranges[closest].end) { closest = i; }
+			}
+			ranges[closest].end = ranges[closest + 1].end;
+			ranges.erase(ranges.begin() + closest + 1);
+		}
+	}
+
+	std::vector<std::vector<Range>> _slices; // Per dynamic slice: sorted, disjoint and non adjacent ranges
+	uint64_t _dynamicSliceSize;
+};
+
 /// <summary>Defines a memory element description. The element will be provided with a name,
 /// type and number of array elements. The element itself may also contain child memory elements</summary>
 class StructuredMemoryDescription
@@ -217,6 +369,7 @@ private:
 	uint64_t _minDynamicAlignment;
 	void* _mappedMemory;
 	uint32_t _mappedDynamicSlice;
+	DirtyRangeTracker* _dirtyRanges; // Only set on the root, when the StructuredBufferView tracks the ranges written
 
 	struct IsEqual
 	{
@@ -355,7 +508,7 @@ public:
 	/// <summary>A default Constructor for a StructuredMemoryEntry.</summary>
 	StructuredMemoryEntry()
 		: _name(), _parent(0), _type(GpuDatatypes::none), _baseAlignment(0), _numArrayElements(0), _variableArray(0), _size(0), _singleElementSize(0), _arrayMemberSize(0),
-		  _offset(0), _minDynamicAlignment(0), _mappedMemory(nullptr), _mappedDynamicSlice(0)
+		  _offset(0), _minDynamicAlignment(0), _mappedMemory(nullptr), _mappedDynamicSlice(0), _dirtyRanges(nullptr)
 	{}
 
 	/// <summary>A Copy constructor for a StructuredMemoryEntry.</summary>
@@ -377,6 +530,7 @@ public:
 		_minDynamicAlignment = other._minDynamicAlignment;
 		_mappedMemory = other._mappedMemory;
 		_mappedDynamicSlice = other._mappedDynamicSlice;
+		_dirtyRanges = other._dirtyRanges;
 	}
 
 	/// <summary>Destructor. Virtual (for polymorphic use).</summary>
@@ -401,6 +555,7 @@ public:
 		std::swap(first._minDynamicAlignment, second._minDynamicAlignment);
 		std::swap(first._mappedMemory, second._mappedMemory);
 		std::swap(first._mappedDynamicSlice, second._mappedDynamicSlice);
+		std::swap(first._dirtyRanges, second._dirtyRanges);
 	}
 
 	/// <summary>Copy Assignment operator.</summary>
@@ -556,11 +711,13 @@ private:
 	friend class StructuredBufferView;
 	uint32_t _offset;
 	void* _mappedMemory;
+	DirtyRangeTracker* _dirtyRanges;
+	uint64_t _mappedSliceOffset; // The offset in the buffer of the mapped memory, to record the ranges written relative to the buffer
 	uint32_t _level;
 	uint32_t _indices[5]; // This, is the array index of each ancestor item up the chain. Is carried to children elements to enable offset calcs.
 	const StructuredMemoryEntry& _prototype;
 	StructuredBufferViewElement(const StructuredMemoryEntry& entry, uint32_t level, uint32_t elementArrayIndex, const uint32_t* parentIndices, uint32_t dynamicSlice = 0)
-		: _mappedMemory(nullptr), _level(level), _prototype(entry)
+		: _mappedMemory(nullptr), _dirtyRanges(nullptr), _mappedSliceOffset(0), _level(level), _prototype(entry)
 	{
 		_indices[0] = elementArrayIndex;
 		if (parentIndices) { memcpy(_indices + 1, parentIndices, sizeof(uint32_t) * (level)); }
@@ -582,8 +739,10 @@ private:
 			mappedDynamicSlice = parent->getMappedDynamicSlice();
 			// store the mapped memory so we only have to do this lookup once rather than each time setValue is called
 			_mappedMemory = parent->getMappedMemory();
+			_dirtyRanges = parent->_dirtyRanges;
 			parent = parent->getParent();
 		}
+		_mappedSliceOffset = mappedDynamicSlice * dynamicSliceSize;
 
 		// at this point dynamicSliceSize matches the root size
 		debug_assertion(dynamicSlice >= mappedDynamicSlice, "StructuredBufferViewElement: Mapped dynamic slice must be greater than or equal to the current dynamic slice");
@@ -597,6 +756,11 @@ private:
 		return _mappedMemory;
 	}
 
+	void markDirty(uint64_t offset, uint64_t size)
+	{
+		if (_dirtyRanges) { _dirtyRanges->markDirty(_mappedSliceOffset + offset, size); }
+	}
+
 public:
 	/// <summary>Gets an element using a name</summary>
 	/// <param name="str">The name of the element to retrieve</param>
@@ -718,11 +882,13 @@ public:
   void setValue(const ParamType& value)\
   {\
   memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), &value, (size_t)getValueSize()); \
+  markDirty(getOffset(), getValueSize()); \
   }\
   \
   void setValue(const ParamType* value)\
   {\
     memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), value, (size_t)getValueSize()); \
+    markDirty(getOffset(), getValueSize()); \
   }
 	DEFINE_SETVALUE_FOR_TYPE(float)
 	DEFINE_SETVALUE_FOR_TYPE(uint32_t)
@@ -747,15 +913,27 @@ public:
 
 	/// <summary>Sets the value (glm::vec3 specific) for this element taking the source by reference</summary>
 	/// <param name="value">The value to set by reference</param>
-	void setValue(const glm::vec3& value) { memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), &value, sizeof(glm::vec3)); }
+	void setValue(const glm::vec3& value)
+	{
+		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), &value, sizeof(glm::vec3));
+		markDirty(getOffset(), sizeof(glm::vec3));
+	}
 
 	/// <summary>Sets the value (glm::ivec3 specific) for this element taking the source by reference</summary>
 	/// <param name="value">The value to set by reference</param>
-	void setValue(const glm::ivec3& value) { memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), &value, sizeof(glm::ivec3)); }
+	void setValue(const glm::ivec3& value)
+	{
+		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), &value, sizeof(glm::ivec3));
+		markDirty(getOffset(), sizeof(glm::ivec3));
+	}
 
 	/// <summary>Sets the value (glm::ivec3 specific) for this element taking the source by reference</summary>
 	/// <param name="value">The value to set by reference</param>
-	void setValue(const glm::uvec3& value) { memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), &value, sizeof(glm::uvec3)); }
+	void setValue(const glm::uvec3& value)
+	{
+		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), &value, sizeof(glm::uvec3));
+		markDirty(getOffset(), sizeof(glm::uvec3));
+	}
 
 	/// <summary>Sets the value (glm::vec3 specific) for this element taking the source by pointer</summary>
 	/// <param name="value">The value to set by pointer</param>
@@ -763,6 +941,7 @@ public:
 	{
 		for (uint32_t i = 0; i < this->_prototype.getNumArrayElements(); ++i)
 		{ memcpy(static_cast<char*>(getMappedMemory()) + getOffset() + sizeof(glm::vec4) * i, value + i, sizeof(glm::vec3)); }
+		if (_prototype.getNumArrayElements()) { markDirty(getOffset(), sizeof(glm::vec4) * (_prototype.getNumArrayElements() - 1) + sizeof(glm::vec3)); }
 	}
 
 	/// <summary>Sets the value (glm::ivec3 specific) for this element taking the source by pointer</summary>
@@ -771,6 +950,7 @@ public:
 	{
 		for (uint32_t i = 0; i < this->_prototype.getNumArrayElements(); ++i)
 		{ memcpy(static_cast<char*>(getMappedMemory()) + getOffset() + sizeof(glm::ivec4) * i, value + i, sizeof(glm::ivec3)); }
+		if (_prototype.getNumArrayElements()) { markDirty(getOffset(), sizeof(glm::ivec4) * (_prototype.getNumArrayElements() - 1) + sizeof(glm::ivec3)); }
 	}
 
 	/// <summary>Sets the value (glm::uvec3 specific) for this element taking the source by pointer</summary>
@@ -779,6 +959,7 @@ public:
 	{
 		for (uint32_t i = 0; i < this->_prototype.getNumArrayElements(); ++i)
 		{ memcpy(static_cast<char*>(getMappedMemory()) + getOffset() + sizeof(glm::uvec4) * i, value + i, sizeof(glm::uvec3)); }
+		if (_prototype.getNumArrayElements()) { markDirty(getOffset(), sizeof(glm::uvec4) * (_prototype.getNumArrayElements() - 1) + sizeof(glm::uvec3)); }
 	}
 
 	/// <summary>Sets the value (glm::mat2x3 specific) for this element taking the source by reference</summary>
@@ -787,6 +968,7 @@ public:
 	{
 		glm::mat2x4 newvalue(value);
 		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), (const void*)&newvalue, (size_t)getValueSize());
+		markDirty(getOffset(), getValueSize());
 	}
 
 	/// <summary>Sets the value (glm::mat3x3 specific) for this element taking the source by reference</summary>
@@ -795,6 +977,7 @@ public:
 	{
 		glm::mat3x4 newvalue(value);
 		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), (const void*)&newvalue, (size_t)getValueSize());
+		markDirty(getOffset(), getValueSize());
 	}
 
 	/// <summary>Sets the value (glm::mat4x3 specific) for this element taking the source by reference</summary>
@@ -803,6 +986,7 @@ public:
 	{
 		glm::mat4x4 newvalue(value);
 		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), (const void*)&newvalue, (size_t)getValueSize());
+		markDirty(getOffset(), getValueSize());
 	}
 
 	/// <summary>Sets the value (glm::mat2x3 specific) for this element taking the source by pointer</summary>
@@ -811,6 +995,7 @@ public:
 	{
 		glm::mat2x4 newvalue(*value);
 		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), (const void*)&newvalue, (size_t)getValueSize());
+		markDirty(getOffset(), getValueSize());
 	}
 
 	/// <summary>Sets the value (glm::mat3x3 specific) for this element taking the source by pointer</summary>
@@ -819,6 +1004,7 @@ public:
 	{
 		glm::mat3x4 newvalue(*value);
 		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), (const void*)&newvalue, (size_t)getValueSize());
+		markDirty(getOffset(), getValueSize());
 	}
 
 	/// <summary>Sets the value (glm::mat4x3 specific) for this element taking the source by pointer</summary>
@@ -827,6 +1013,7 @@ public:
 	{
 		glm::mat4x4 newvalue(*value);
 		memcpy(static_cast<char*>(getMappedMemory()) + getOffset(), (const void*)&newvalue, (size_t)getValueSize());
+		markDirty(getOffset(), getValueSize());
 	}
 
 	/// <summary>Sets the value of this element using a FreeValue which encapsulates various data types</summary>
@@ -844,6 +1031,7 @@ public:
 		{
 			memcpy((char*)getMappedMemory() + getOffset(), value.raw(), (size_t)getValueSize());
 		}
+		markDirty(getOffset(), getValueSize());
 	}
 
 	/// <summary>Sets the value for this element using typed memory</summary>
@@ -871,6 +1059,7 @@ public:
 				uint64_t myoff = startoff + _prototype._arrayMemberSize * i;
 				uint64_t myvaluesize = getSize(value.dataType());
 				memcpy((char*)getMappedMemory() + (size_t)myoff, &tmp[0][0], (size_t)myvaluesize);
+				markDirty(myoff, myvaluesize);
 			}
 		}
 		else
@@ -878,6 +1067,7 @@ public:
 			uint64_t myoff = getOffset();
 			uint64_t myvaluesize = value.dataSize();
 			memcpy((char*)getMappedMemory() + (size_t)myoff, value.raw(), (size_t)myvaluesize);
+			markDirty(myoff, myvaluesize);
 		}
 	}
 
@@ -911,20 +1101,34 @@ class StructuredBufferView
 private:
 	uint32_t _numDynamicSlices;
 	StructuredMemoryEntry _root;
+	DirtyRangeTracker _dirtyRanges;
+	bool _trackDirtyRanges;
+
+	// The root points to the tracker of the view that owns it, so this must be called whenever the root is copied or swapped
+	void fixDirtyRangeTracker() { _root._dirtyRanges = _trackDirtyRanges ? &_dirtyRanges : nullptr; }
+
+	void resetDirtyRanges()
+	{
+		if (_trackDirtyRanges) { _dirtyRanges.init(_numDynamicSlices, getDynamicSliceSize()); }
+	}
 
 public:
 	/// <summary>Constructor. Creates an empty StructuredBufferView.</summary>
-	StructuredBufferView() : _numDynamicSlices(1) {}
+	StructuredBufferView() : _numDynamicSlices(1), _trackDirtyRanges(false) {}
 
 	/// <summary>Constructor. Creates an empty StructuredBufferView.</summary>
-	StructuredBufferView(const StructuredBufferView& other) : _numDynamicSlices(other._numDynamicSlices), _root(other._root)
+	StructuredBufferView(const StructuredBufferView& other)
+		: _numDynamicSlices(other._numDynamicSlices), _root(other._root), _dirtyRanges(other._dirtyRanges), _trackDirtyRanges(other._trackDirtyRanges)
 	{ //
 		_root.fixParentPointers(0);
+		fixDirtyRangeTracker();
 	}
 	/// <summary>Constructor. Creates an empty StructuredBufferView.</summary>
-	StructuredBufferView(const StructuredBufferView&& other) : _numDynamicSlices(other._numDynamicSlices), _root(std::move(other._root))
+	StructuredBufferView(const StructuredBufferView&& other)
+		: _numDynamicSlices(other._numDynamicSlices), _root(std::move(other._root)), _dirtyRanges(std::move(other._dirtyRanges)), _trackDirtyRanges(other._trackDirtyRanges)
 	{ //
 		_root.fixParentPointers(0);
+		fixDirtyRangeTracker();
 	}
 
 	StructuredBufferView& operator=(StructuredBufferView other)
@@ -938,8 +1142,51 @@ public:
 	{
 		swap(first._root, second._root);
 		std::swap(first._numDynamicSlices, second._numDynamicSlices);
+		std::swap(first._dirtyRanges, second._dirtyRanges);
+		std::swap(first._trackDirtyRanges, second._trackDirtyRanges);
 		first._root.fixParentPointers(0);
 		second._root.fixParentPointers(0);
+		first.fixDirtyRangeTracker();
+		second.fixDirtyRangeTracker();
+	}
+
+	/// <summary>Enable or disable recording the byte ranges written through the elements of this view. When enabled, every setValue records
+	/// the range it wrote, so that only the ranges written need to be flushed, or copied from a staging buffer, rather than whole dynamic
+	/// slices (see getDirtyRanges()). Values written directly to the mapped memory must be recorded with markDirty(). Enabling clears the ranges.</summary>
+	/// <param name="enable">True to record the ranges written</param>
+	void enableDirtyRangeTracking(bool enable = true)
+	{
+		_trackDirtyRanges = enable;
+		resetDirtyRanges();
+		fixDirtyRangeTracker();
+	}
+
+	/// <summary>Check whether the ranges written through the elements of this view are recorded</summary>
+	/// <returns>True if dirty range tracking is enabled</returns>
+	bool isDirtyRangeTrackingEnabled() const { return _trackDirtyRanges; }
+
+	/// <summary>Get the ranges written since they were last cleared, per dynamic slice, as offsets from the start of the buffer. Clear the
+	/// ranges of a dynamic slice once it has been flushed or copied.</summary>
+	/// <returns>The dirty ranges</returns>
+	DirtyRangeTracker& getDirtyRanges() { return _dirtyRanges; }
+
+	/// <summary>Get the ranges written since they were last cleared, per dynamic slice, as offsets from the start of the buffer</summary>
+	/// <returns>The dirty ranges</returns>
+	const DirtyRangeTracker& getDirtyRanges() const { return _dirtyRanges; }
+
+	/// <summary>Record a write to the buffer that did not go through the elements of this view. Ignored unless dirty range tracking is enabled.</summary>
+	/// <param name="offset">The offset of the first byte written from the start of the buffer</param>
+	/// <param name="size">The number of bytes written</param>
+	void markDirty(uint64_t offset, uint64_t size)
+	{
+		if (_trackDirtyRanges) { _dirtyRanges.markDirty(offset, size); }
+	}
+
+	/// <summary>Record that a whole dynamic slice was written. Ignored unless dirty range tracking is enabled.</summary>
+	/// <param name="dynamicSlice">The dynamic slice</param>
+	void markDynamicSliceDirty(uint32_t dynamicSlice)
+	{
+		if (_trackDirtyRanges) { _dirtyRanges.markDynamicSliceDirty(dynamicSlice); }
 	}
 
 	/// <summary>Assigns memory for this structured buffer view to point towards. Can also set the mapped dynamic
@@ -980,7 +1227,11 @@ public:
 
 	/// <summary>Initialises the StructuredBufferView for a non-dynamic buffer.</summary>
 	/// <param name="desc">The description to use for initialising the StructuredBufferView</param>
-	void init(const StructuredMemoryDescription& desc) { _root.init(desc); }
+	void init(const StructuredMemoryDescription& desc)
+	{
+		_root.init(desc);
+		resetDirtyRanges();
+	}
 
 	/// <summary>Initialises the StructuredBufferView for a dynamic buffer.</summary>
 	/// <param name="desc">The description to use for initialising the StructuredBufferView</param>
@@ -993,6 +1244,7 @@ public:
 	{
 		_root.initDynamic(desc, usage, minUboDynamicAlignment, minSsboDynamicAlignment);
 		_numDynamicSlices = numDynamicSlices;
+		resetDirtyRanges();
 	}
 
 	/// <summary>Gets an element using a name</summary>
@@ -1087,7 +1339,11 @@ public:
 	/// <summary>Sets the element array size for the last entry in the StructuredBufferViewElement.
 	/// Only the last element in the StructuredBufferViewElement may have its size set from the api</summary>
 	/// <param name="arraySize">The size of the array</param>
-	void setLastElementArraySize(uint32_t arraySize) { return _root.setLastElementArraySize(arraySize); }
+	void setLastElementArraySize(uint32_t arraySize)
+	{
+		_root.setLastElementArraySize(arraySize);
+		resetDirtyRanges();
+	}
 
 	/// <summary>Retrieve the index of a variable by its name</summary>
 	/// <param name="name">The name of a element</param>
@@ -116,11 +116,7 @@ private:
 	pvrvk::ImageView _result;
 	pvrvk::ImageView get_() const
 	{
-		if (!_inCallback)
-		{
-			_resultSemaphore->wait();
-			_resultSemaphore->signal();
-		}
+		if (!_inCallback) { async::waitForCompletion(*_resultSemaphore); }
 		return _result;
 	}
 
@@ -148,9 +144,9 @@ typedef std::shared_ptr<ImageUploadFuture_> ImageUploadFuture;
 /// <param name="uploadFuture">An image upload future to be uploaded on a separate thread.</param>
 inline void imageUploadAsyncWorker(ImageUploadFuture uploadFuture) { uploadFuture->loadNow(); }
 
-/// <summary>This class wraps a worker thread that uploads texture to the GPU asynchronously and returns
-/// futures to them. This class would normally be used with Texture Futures as well, in order to do both
-/// of the operations asynchronously.</summary>
+/// <summary>This class uploads textures to the GPU asynchronously on the process-wide JobSystem and returns
+/// futures to them. Uploads are executed one at a time, in order, as they share a command pool. This class would
+/// normally be used with Texture Futures as well, in order to do both of the operations asynchronously.</summary>
 class ImageApiAsyncUploader : public async::AsyncScheduler<pvrvk::ImageView, ImageUploadFuture, imageUploadAsyncWorker>
 {
 private:
@@ -211,10 +207,7 @@ public:
 		params.setCallBack(callback);
 		params._callbackBeforeSignal = callbackBeforeSignal;
 		params._cmdQueueMutex = _cmdQueueMutex;
-		_queueSemaphore.wait();
-		_queue.emplace_back(future);
-		_queueSemaphore.signal();
-		_workSemaphore.signal();
+		enqueue(future);
 		return future;
 	}
 };
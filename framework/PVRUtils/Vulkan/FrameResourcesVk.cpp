@@ -0,0 +1,137 @@
+/*!
+\brief Implementations of the LinearAllocator and FrameResourceRing classes.
+\file PVRUtils/Vulkan/FrameResourcesVk.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/Vulkan/FrameResourcesVk.h"
+#include "PVRCore/Errors.h"
+#include "PVRCore/Log.h"
+#include <cassert>
+
+namespace pvr {
+namespace utils {
+LinearAllocator::LinearAllocator(size_t capacity) : _block(capacity ? new char[capacity] : nullptr), _capacity(capacity), _offset(0), _overflowSize(0) {}
+
+void* LinearAllocator::allocate(size_t size, size_t alignment)
+{
+	assert(alignment && (alignment & (alignment - 1)) == 0 && "LinearAllocator: The alignment must be a power of two");
+	if (_block)
+	{
+		const uintptr_t base = reinterpret_cast<uintptr_t>(_block.get());
+		const size_t alignedOffset = ((base + _offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+		if (alignedOffset + size <= _capacity)
+		{
+			_offset = alignedOffset + size;
+			return _block.get() + alignedOffset;
+		}
+	}
+
+	// Does not fit: serve it from the heap, and remember how much was needed so that reset() can grow the block
+	const size_t overflowSize = size + alignment - 1;
+	_overflow.emplace_back(new char[overflowSize]);
+	_overflowSize += overflowSize;
+	const uintptr_t address = reinterpret_cast<uintptr_t>(_overflow.back().get());
+	return reinterpret_cast<void*>((address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+}
+
+void LinearAllocator::reset()
+{
+	if (!_overflow.empty())
+	{
+		const size_t newCapacity = _offset + _overflowSize;
+		Log(LogLevel::Debug, "LinearAllocator: Growing from %llu to %llu bytes", static_cast<unsigned long long>(_capacity), static_cast<unsigned long long>(newCapacity));
+		_block.reset(new char[newCapacity]);
+		_capacity = newCapacity;
+		_overflow.clear();
+		_overflowSize = 0;
+	}
+	_offset = 0;
+}
+
+void FrameResourceRing::init(const pvrvk::Device& device, const FrameResourceRingCreateInfo& createInfo)
+{
+	if (!createInfo.framesInFlight) { throw InvalidArgumentError("createInfo.framesInFlight", "FrameResourceRing: At least one frame in flight is required"); }
+	release();
+
+	if (createInfo.useTimelineSemaphore)
+	{
+		pvrvk::SemaphoreCreateInfo semaphoreCreateInfo;
+		_timelineSemaphore = device->createTimelineSemaphore(semaphoreCreateInfo);
+		_timelineSemaphore->setObjectName("FrameResourceRingTimelineSemaphore");
+	}
+
+	_slots.resize(createInfo.framesInFlight);
+	for (uint32_t i = 0; i < createInfo.framesInFlight; ++i)
+	{
+		Slot& slot = _slots[i];
+		if (!createInfo.useTimelineSemaphore)
+		{
+			slot.fence = device->createFence();
+			slot.fence->setObjectName("FrameResourceRingFence" + std::to_string(i));
+		}
+		slot.deferredObjects.reserve(createInfo.deferredObjectsPerFrame);
+		slot.scratch = LinearAllocator(createInfo.scratchBytesPerFrame);
+	}
+
+	// Objects deferred before the first frame go to the last slot, which is the last to be reused
+	_frameIndex = createInfo.framesInFlight - 1;
+	_frameNumber = 0;
+}
+
+void FrameResourceRing::release()
+{
+	for (Slot& slot : _slots) { waitForSlot(slot); }
+	_slots.clear();
+	_timelineSemaphore.reset();
+	_frameIndex = 0;
+	_frameNumber = 0;
+}
+
+void FrameResourceRing::waitForSlot(Slot& slot)
+{
+	if (!slot.pending) { return; }
+	if (_timelineSemaphore) { _timelineSemaphore->wait(slot.timelineValue); }
+	else
+	{
+		slot.fence->wait();
+	}
+	slot.pending = false;
+}
+
+uint32_t FrameResourceRing::beginFrame()
+{
+	assert(!_slots.empty() && "FrameResourceRing: init must be called before beginFrame");
+	_frameIndex = (_frameIndex + 1) % getNumFramesInFlight();
+	++_frameNumber;
+
+	Slot& slot = _slots[_frameIndex];
+	waitForSlot(slot);
+	// The fence is either signalled by the frame waited for above or was never submitted, so it can always be reset here
+	if (slot.fence) { slot.fence->reset(); }
+	slot.timelineValue = _frameNumber;
+	// clear() keeps the capacity, so the vector is only reallocated when a frame defers more objects than ever before
+	slot.deferredObjects.clear();
+	slot.scratch.reset();
+	return _frameIndex;
+}
+
+const pvrvk::Fence& FrameResourceRing::getFrameFence() const
+{
+	const Slot& slot = _slots[_frameIndex];
+	if (!slot.fence) { throw InvalidOperationError("FrameResourceRing: The frames are tracked with a timeline semaphore, use getFrameSignalValue"); }
+	return slot.fence;
+}
+
+uint64_t FrameResourceRing::getFrameSignalValue() const
+{
+	if (!_timelineSemaphore) { throw InvalidOperationError("FrameResourceRing: The frames are tracked with fences, use getFrameFence"); }
+	// Frame numbers start at 1, above the initial value of the semaphore, and only ever increase
+	return _slots[_frameIndex].timelineValue;
+}
+
+void FrameResourceRing::markFrameSubmitted() { _slots[_frameIndex].pending = true; }
+} // namespace utils
+} // namespace pvr
+//!\endcond
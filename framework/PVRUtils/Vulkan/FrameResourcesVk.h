@@ -0,0 +1,185 @@
+/*!
+\brief A ring of frame-in-flight slots, each tracking the completion of one frame on the GPU, and owning the objects
+that must outlive it and the CPU scratch memory used to build it.
+\file PVRUtils/Vulkan/FrameResourcesVk.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRVk/DeviceVk.h"
+#include "PVRVk/FenceVk.h"
+#include "PVRVk/TimelineSemaphoreVk.h"
+#include "PVRUtils/MultiObject.h"
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace pvr {
+namespace utils {
+/// <summary>A bump allocator for short lived CPU memory. Allocating only advances an offset into a single block, and
+/// reset() frees everything at once. Allocations that do not fit are served from the heap until the next reset(), which
+/// then grows the block so that subsequent cycles of the same size do not touch the heap.</summary>
+class LinearAllocator
+{
+public:
+	/// <summary>Constructor</summary>
+	/// <param name="capacity">The initial size of the block in bytes</param>
+	explicit LinearAllocator(size_t capacity = 0);
+
+	/// <summary>Allocate uninitialised memory, valid until the next reset()</summary>
+	/// <param name="size">The size in bytes</param>
+	/// <param name="alignment">The alignment in bytes. Must be a power of two</param>
+	/// <returns>The memory</returns>
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	/// <summary>Allocate an uninitialised array, valid until the next reset(). The elements are never destroyed, so
+	/// T must be trivially destructible.</summary>
+	/// <param name="count">The number of elements</param>
+	/// <returns>The first element</returns>
+	template<typename T>
+	T* allocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "LinearAllocator: The memory is released without destroying the elements");
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	/// <summary>Free all the allocations. If some did not fit in the block since the last reset, the block is
+	/// reallocated large enough to hold all of them.</summary>
+	void reset();
+
+	/// <summary>Get the size of the block</summary>
+	/// <returns>The size of the block in bytes</returns>
+	size_t getCapacity() const { return _capacity; }
+
+	/// <summary>Get the number of bytes allocated since the last reset, including alignment padding and the allocations
+	/// that did not fit in the block</summary>
+	/// <returns>The number of bytes allocated</returns>
+	size_t getUsedSize() const { return _offset + _overflowSize; }
+
+private:
+	std::unique_ptr<char[]> _block;
+	size_t _capacity;
+	size_t _offset;
+	std::vector<std::unique_ptr<char[]>> _overflow;
+	size_t _overflowSize;
+};
+
+/// <summary>The parameters of a FrameResourceRing</summary>
+struct FrameResourceRingCreateInfo
+{
+	uint32_t framesInFlight; //!< The number of frames the CPU may record ahead of the GPU
+	size_t scratchBytesPerFrame; //!< The initial size of each frame's LinearAllocator
+	size_t deferredObjectsPerFrame; //!< The number of deferred destructions each frame can hold before allocating
+	bool useTimelineSemaphore; //!< Track frames with the values of one timeline semaphore instead of one fence per frame
+
+	/// <summary>Constructor</summary>
+	/// <param name="framesInFlight">The number of frames the CPU may record ahead of the GPU</param>
+	/// <param name="scratchBytesPerFrame">The initial size of each frame's LinearAllocator</param>
+	FrameResourceRingCreateInfo(uint32_t framesInFlight = 2, size_t scratchBytesPerFrame = 64 * 1024)
+		: framesInFlight(framesInFlight), scratchBytesPerFrame(scratchBytesPerFrame), deferredObjectsPerFrame(64), useTimelineSemaphore(false)
+	{}
+};
+
+/// <summary>A ring of frame-in-flight slots, replacing the hand-written per-frame fences of the examples. Each frame:
+/// call beginFrame(), which waits until the GPU has finished the frame that last used the same slot (and for nothing
+/// else), then releases the objects whose destruction was deferred by that frame, and resets its scratch memory.
+/// Signal the completion of the frame from its last queue submission with getFrameFence() (or, with a timeline
+/// semaphore, getTimelineSemaphore() and getFrameSignalValue()), then call markFrameSubmitted() once that submission
+/// has succeeded. A frame that is not submitted is simply not waited for. The CPU therefore runs at most framesInFlight frames
+/// ahead of the GPU. Resources duplicated per frame can be kept in a pvr::Multi and indexed with current().
+/// After the first few frames, none of this allocates from the heap. All of the methods must be called from the thread
+/// that records the frames.</summary>
+class FrameResourceRing
+{
+public:
+	/// <summary>Constructor. Call init() before use.</summary>
+	FrameResourceRing() : _frameIndex(0), _frameNumber(0) {}
+
+	/// <summary>Destructor. Waits for the frames still in flight before releasing their objects.</summary>
+	~FrameResourceRing() { release(); }
+
+	/// <summary>Create the fences or timeline semaphore, and the scratch memory of each frame</summary>
+	/// <param name="device">The device the frames are submitted to</param>
+	/// <param name="createInfo">The number of frames in flight and the size of their resources</param>
+	void init(const pvrvk::Device& device, const FrameResourceRingCreateInfo& createInfo = FrameResourceRingCreateInfo());
+
+	/// <summary>Wait for every frame in flight, then release all the deferred objects and synchronisation objects</summary>
+	void release();
+
+	/// <summary>Start a new frame in the next slot. Waits for the GPU to finish the frame that last used the slot, if it
+	/// was submitted, then releases the objects deferred by that frame and resets its fence and scratch memory.</summary>
+	/// <returns>The index of the slot, in [0, framesInFlight)</returns>
+	uint32_t beginFrame();
+
+	/// <summary>Get the fence the last queue submission of the current frame must signal. The fence is already reset by
+	/// beginFrame().</summary>
+	/// <returns>The fence of the current slot</returns>
+	const pvrvk::Fence& getFrameFence() const;
+
+	/// <summary>Get the value the last queue submission of the current frame must signal on getTimelineSemaphore().
+	/// Only valid if the ring was created with useTimelineSemaphore.</summary>
+	/// <returns>The timeline value of the current frame</returns>
+	uint64_t getFrameSignalValue() const;
+
+	/// <summary>Record that the current frame was submitted with its fence or timeline value, so that the next
+	/// beginFrame() on this slot waits for it. Call it only after the submission succeeded: a frame that skips its
+	/// submission (for example because the swapchain is out of date) must not call it, or the wait would never end.
+	/// </summary>
+	void markFrameSubmitted();
+
+	/// <summary>Get the timeline semaphore the frames signal, if the ring was created with useTimelineSemaphore</summary>
+	/// <returns>The timeline semaphore, or null</returns>
+	const pvrvk::TimelineSemaphore& getTimelineSemaphore() const { return _timelineSemaphore; }
+
+	/// <summary>Keep an object alive until the GPU has finished the current frame, e.g. a buffer replaced while the
+	/// frames in flight may still read the old one.</summary>
+	/// <param name="object">Any pvrvk object, or other reference counted object</param>
+	void deferDestruction(std::shared_ptr<void> object) { _slots[_frameIndex].deferredObjects.emplace_back(std::move(object)); }
+
+	/// <summary>Get the scratch memory of the current frame, reset when its slot is reused</summary>
+	/// <returns>The LinearAllocator of the current slot</returns>
+	LinearAllocator& getScratchAllocator() { return _slots[_frameIndex].scratch; }
+
+	/// <summary>Get the index of the current slot</summary>
+	/// <returns>The index of the current slot, in [0, framesInFlight)</returns>
+	uint32_t getFrameIndex() const { return _frameIndex; }
+
+	/// <summary>Get the number of frames begun so far</summary>
+	/// <returns>The number of calls to beginFrame() since init()</returns>
+	uint64_t getFrameNumber() const { return _frameNumber; }
+
+	/// <summary>Get the number of slots</summary>
+	/// <returns>The maximum number of frames in flight</returns>
+	uint32_t getNumFramesInFlight() const { return static_cast<uint32_t>(_slots.size()); }
+
+	/// <summary>Get the item of a per-frame pvr::Multi that belongs to the current frame</summary>
+	/// <param name="multi">A Multi holding one item per frame in flight</param>
+	/// <returns>The item of the current slot</returns>
+	template<typename T, uint8_t MAX_ITEMS>
+	T& current(Multi<T, MAX_ITEMS>& multi) const
+	{
+		return multi[_frameIndex];
+	}
+
+private:
+	struct Slot
+	{
+		pvrvk::Fence fence;
+		uint64_t timelineValue; // The value signalled by the last frame that used this slot
+		bool pending; // Whether markFrameSubmitted was called by the last frame that used this slot
+		std::vector<std::shared_ptr<void>> deferredObjects;
+		LinearAllocator scratch;
+
+		Slot() : timelineValue(0), pending(false) {}
+	};
+
+	void waitForSlot(Slot& slot);
+
+	std::vector<Slot> _slots;
+	pvrvk::TimelineSemaphore _timelineSemaphore;
+	uint32_t _frameIndex;
+	uint64_t _frameNumber;
+};
+} // namespace utils
+} // namespace pvr
@@ -0,0 +1,161 @@
+/*!
+\brief Implementation of the Vulkan GPU profiler.
+\file PVRUtils/Vulkan/GpuProfilerVk.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/Vulkan/GpuProfilerVk.h"
+#include "PVRUtils/Vulkan/HelperVk.h"
+#include "PVRCore/Log.h"
+#include <algorithm>
+
+namespace pvr {
+namespace utils {
+namespace {
+const uint32_t InvalidZone = static_cast<uint32_t>(-1);
+const char* const FrameZoneName = "GPU Frame";
+} // namespace
+
+bool GpuProfiler::init(pvrvk::Device& device, uint32_t queueFamilyIndex, uint32_t numFramesInFlight, uint32_t maxZonesPerFrame, const std::string& trackName)
+{
+	release();
+	const pvrvk::PhysicalDevice& physicalDevice = device->getPhysicalDevice();
+	const uint32_t validBits = physicalDevice->getQueueFamilyProperties()[queueFamilyIndex].getTimestampValidBits();
+	if (!validBits)
+	{
+		Log(LogLevel::Warning, "GpuProfiler: Queue family %u does not support timestamps. GPU zones will not be recorded.", queueFamilyIndex);
+		return false;
+	}
+
+	_numFramesInFlight = std::max(numFramesInFlight, 1u);
+	_maxZonesPerFrame = maxZonesPerFrame;
+	_timestampPeriodNs = static_cast<double>(physicalDevice->getProperties().getLimits().getTimestampPeriod());
+	_timestampMask = validBits >= 64 ? static_cast<uint64_t>(-1) : ((1ull << validBits) - 1);
+	_trackName = trackName;
+	_lastGpuEndNs = 0;
+	_currentSlot = 0;
+
+	_queryPool = device->createQueryPool(pvrvk::QueryPoolCreateInfo(pvrvk::QueryType::e_TIMESTAMP, getFirstQuery(_numFramesInFlight)));
+	_queryPool->setObjectName("PVRUtilsVk::GpuProfiler::QueryPool");
+
+	_slots.resize(_numFramesInFlight);
+	for (FrameSlot& slot : _slots)
+	{
+		slot.zones.reserve(_maxZonesPerFrame);
+		slot.pending = false;
+		slot.ended = false;
+		slot.depth = 0;
+	}
+	// Each query returns its value followed by its availability.
+	_results.resize(2 * (2 + 2 * _maxZonesPerFrame));
+	return true;
+}
+
+void GpuProfiler::release()
+{
+	_queryPool.reset();
+	_slots.clear();
+	_results.clear();
+}
+
+void GpuProfiler::resolve(FrameSlot& slot, uint32_t slotIndex)
+{
+	slot.pending = false;
+	if (!slot.ended) { return; }
+	const uint32_t numQueries = 2 + 2 * static_cast<uint32_t>(slot.zones.size());
+	// The slot is only reused once its previous submission has completed, so there is no need to wait. Queries whose
+	// zones were never ended are simply reported as unavailable.
+	_queryPool->getResults(getFirstQuery(slotIndex), numQueries, numQueries * 2 * sizeof(uint64_t), _results.data(), 2 * sizeof(uint64_t),
+		pvrvk::QueryResultFlags::e_64_BIT | pvrvk::QueryResultFlags::e_WITH_AVAILABILITY_BIT);
+	if (!_results[1] || !_results[3]) { return; }
+
+	const uint64_t gpuFrameBegin = _results[0] & _timestampMask;
+	const uint64_t baseNs = std::max(slot.cpuBeginNs, _lastGpuEndNs);
+	auto toProfilerNs = [&](uint64_t ticks) -> uint64_t {
+		const uint64_t delta = ((ticks & _timestampMask) - gpuFrameBegin) & _timestampMask;
+		return baseNs + static_cast<uint64_t>(static_cast<double>(delta) * _timestampPeriodNs);
+	};
+
+	Profiler& profiler = Profiler::getInstance();
+	ProfileEvent event = { FrameZoneName, baseNs, toProfilerNs(_results[2]), slot.frame, 0 };
+	profiler.recordTrackEvent(_trackName, event);
+	_lastGpuEndNs = event.endNs;
+
+	for (uint32_t i = 0; i < slot.zones.size(); ++i)
+	{
+		const Zone& zone = slot.zones[i];
+		const uint64_t* begin = &_results[4 + 4 * i];
+		if (!zone.ended || !begin[1] || !begin[3]) { continue; }
+		event.name = zone.name;
+		event.beginNs = toProfilerNs(begin[0]);
+		event.endNs = toProfilerNs(begin[2]);
+		event.depth = static_cast<uint16_t>(zone.depth + 1);
+		profiler.recordTrackEvent(_trackName, event);
+	}
+}
+
+void GpuProfiler::beginFrame(pvrvk::CommandBuffer& commandBuffer, uint32_t frameSlot)
+{
+	if (!isInitialized()) { return; }
+	_currentSlot = frameSlot % _numFramesInFlight;
+	FrameSlot& slot = _slots[_currentSlot];
+	if (slot.pending) { resolve(slot, _currentSlot); }
+
+	Profiler& profiler = Profiler::getInstance();
+	slot.zones.clear();
+	slot.frame = profiler.getFrameIndex();
+	slot.cpuBeginNs = profiler.getTimestampNs();
+	slot.depth = 0;
+	slot.ended = false;
+	slot.pending = profiler.isEnabled();
+	if (!slot.pending) { return; }
+
+	const uint32_t firstQuery = getFirstQuery(_currentSlot);
+	commandBuffer->resetQueryPool(_queryPool, firstQuery, 2 + 2 * _maxZonesPerFrame);
+	commandBuffer->writeTimestamp(_queryPool, firstQuery, pvrvk::PipelineStageFlags::e_TOP_OF_PIPE_BIT);
+}
+
+void GpuProfiler::endFrame(pvrvk::CommandBuffer& commandBuffer)
+{
+	if (!isInitialized()) { return; }
+	FrameSlot& slot = _slots[_currentSlot];
+	if (!slot.pending || slot.ended) { return; }
+	commandBuffer->writeTimestamp(_queryPool, getFirstQuery(_currentSlot) + 1, pvrvk::PipelineStageFlags::e_BOTTOM_OF_PIPE_BIT);
+	slot.ended = true;
+}
+
+uint32_t GpuProfiler::beginZone(pvrvk::CommandBufferBase commandBuffer, const char* name, pvrvk::PipelineStageFlags stage)
+{
+	if (!isInitialized()) { return InvalidZone; }
+	FrameSlot& slot = _slots[_currentSlot];
+	if (!slot.pending || slot.ended || slot.zones.size() >= _maxZonesPerFrame) { return InvalidZone; }
+
+	const uint32_t zone = static_cast<uint32_t>(slot.zones.size());
+	const Zone newZone = { name, slot.depth++, false };
+	slot.zones.push_back(newZone);
+	pvr::utils::beginCommandBufferDebugLabel(commandBuffer, pvrvk::DebugUtilsLabel(name));
+	commandBuffer->writeTimestamp(_queryPool, getFirstQuery(_currentSlot) + 2 + 2 * zone, stage);
+	return zone;
+}
+
+void GpuProfiler::endZone(pvrvk::CommandBufferBase commandBuffer, uint32_t zone, pvrvk::PipelineStageFlags stage)
+{
+	if (zone == InvalidZone || !isInitialized()) { return; }
+	FrameSlot& slot = _slots[_currentSlot];
+	if (zone >= slot.zones.size() || slot.zones[zone].ended) { return; }
+
+	commandBuffer->writeTimestamp(_queryPool, getFirstQuery(_currentSlot) + 3 + 2 * zone, stage);
+	pvr::utils::endCommandBufferDebugLabel(commandBuffer);
+	slot.zones[zone].ended = true;
+	if (slot.depth) { --slot.depth; }
+}
+
+void updateProfilerSummaryText(pvr::ui::Text& text, uint32_t numFrames)
+{
+	text->getTextElement()->setText(Profiler::getInstance().getSummaryString(numFrames));
+	text->commitUpdates();
+}
+} // namespace utils
+} // namespace pvr
+//!\endcond
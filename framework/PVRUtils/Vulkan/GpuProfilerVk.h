@@ -0,0 +1,131 @@
+/*!
+\brief Contains a Vulkan GPU profiler that records timestamp zones into the pvr::Profiler timeline.
+\file PVRUtils/Vulkan/GpuProfilerVk.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRCore/Profiler.h"
+#include "PVRVk/PVRVk.h"
+#include "PVRUtils/Vulkan/SpriteVk.h"
+
+namespace pvr {
+namespace utils {
+/// <summary>Measures GPU zones with pairs of vkCmdWriteTimestamp, and forwards them to pvr::Profiler once they have
+/// been resolved. Each frame in flight owns a slice of a single timestamp query pool: the timestamps of a slice are
+/// read back (without waiting) when the slice is reused numFramesInFlight frames later, at which point the GPU work
+/// is known to have completed. Zones are also wrapped in debug labels so that they show up in external tools.</summary>
+/// <remarks>The GPU timeline is aligned to the CPU timeline by mapping the first timestamp of each frame to the
+/// CPU time at which that frame was begun (or the end of the previous GPU frame, if later). This is an approximation
+/// that makes the GPU track readable next to the CPU tracks, not a calibrated clock domain.</remarks>
+class GpuProfiler
+{
+public:
+	/// <summary>Constructor. Creates an uninitialised profiler. Call init() before use.</summary>
+	GpuProfiler() : _numFramesInFlight(0), _maxZonesPerFrame(0), _timestampPeriodNs(1.0), _timestampMask(0), _lastGpuEndNs(0), _currentSlot(0) {}
+
+	/// <summary>Create the query pool.</summary>
+	/// <param name="device">The device</param>
+	/// <param name="queueFamilyIndex">The queue family the profiled command buffers will be submitted to</param>
+	/// <param name="numFramesInFlight">The number of frames that can be in flight (normally the swapchain length)</param>
+	/// <param name="maxZonesPerFrame">The maximum number of zones per frame. Further zones are ignored.</param>
+	/// <param name="trackName">The name of the track the zones are shown in</param>
+	/// <returns>False if the queue family does not support timestamps, in which case all calls do nothing</returns>
+	bool init(pvrvk::Device& device, uint32_t queueFamilyIndex, uint32_t numFramesInFlight, uint32_t maxZonesPerFrame = 64, const std::string& trackName = "GPU");
+
+	/// <summary>Query if the profiler was successfully initialised.</summary>
+	/// <returns>True if timestamps are being recorded</returns>
+	bool isInitialized() const { return _queryPool != nullptr; }
+
+	/// <summary>Release the query pool.</summary>
+	void release();
+
+	/// <summary>Resolve the timestamps last recorded into this frame slot, reset it, and start a new GPU frame. Must be
+	/// recorded outside of a render pass, before any zone of the frame, and only once the previous submission using this
+	/// slot has completed (normally after waiting for the per swapchain image fence).</summary>
+	/// <param name="commandBuffer">The first command buffer of the frame</param>
+	/// <param name="frameSlot">The index of the frame in flight, in [0, numFramesInFlight)</param>
+	void beginFrame(pvrvk::CommandBuffer& commandBuffer, uint32_t frameSlot);
+
+	/// <summary>End the current GPU frame.</summary>
+	/// <param name="commandBuffer">The last command buffer of the frame</param>
+	void endFrame(pvrvk::CommandBuffer& commandBuffer);
+
+	/// <summary>Begin a GPU zone. Zones may be nested and may be recorded into any command buffer submitted as part of
+	/// the frame, including secondary command buffers, as long as they are recorded from a single thread.</summary>
+	/// <param name="commandBuffer">The command buffer</param>
+	/// <param name="name">The name of the zone. Must outlive the pvr::Profiler (normally a string literal).</param>
+	/// <param name="stage">The pipeline stage to write the timestamp at</param>
+	/// <returns>A handle to pass to endZone</returns>
+	uint32_t beginZone(pvrvk::CommandBufferBase commandBuffer, const char* name, pvrvk::PipelineStageFlags stage = pvrvk::PipelineStageFlags::e_TOP_OF_PIPE_BIT);
+
+	/// <summary>End a GPU zone.</summary>
+	/// <param name="commandBuffer">The command buffer</param>
+	/// <param name="zone">The handle returned by beginZone</param>
+	/// <param name="stage">The pipeline stage to write the timestamp at</param>
+	void endZone(pvrvk::CommandBufferBase commandBuffer, uint32_t zone, pvrvk::PipelineStageFlags stage = pvrvk::PipelineStageFlags::e_BOTTOM_OF_PIPE_BIT);
+
+private:
+	struct Zone
+	{
+		const char* name;
+		uint16_t depth;
+		bool ended;
+	};
+	struct FrameSlot
+	{
+		std::vector<Zone> zones;
+		uint32_t frame;
+		uint64_t cpuBeginNs;
+		uint16_t depth;
+		bool pending;
+		bool ended;
+	};
+
+	uint32_t getFirstQuery(uint32_t slot) const { return slot * (2 + 2 * _maxZonesPerFrame); }
+	void resolve(FrameSlot& slot, uint32_t slotIndex);
+
+	pvrvk::QueryPool _queryPool;
+	std::vector<FrameSlot> _slots;
+	std::vector<uint64_t> _results;
+	std::string _trackName;
+	uint32_t _numFramesInFlight;
+	uint32_t _maxZonesPerFrame;
+	double _timestampPeriodNs;
+	uint64_t _timestampMask;
+	uint64_t _lastGpuEndNs;
+	uint32_t _currentSlot;
+};
+
+/// <summary>Records a GPU zone for the lifetime of the object.</summary>
+class GpuProfileZone
+{
+public:
+	/// <summary>Begin a GPU zone.</summary>
+	/// <param name="profiler">The GPU profiler</param>
+	/// <param name="commandBuffer">The command buffer to record the zone into</param>
+	/// <param name="name">The name of the zone. Must outlive the pvr::Profiler (normally a string literal).</param>
+	GpuProfileZone(GpuProfiler& profiler, pvrvk::CommandBufferBase commandBuffer, const char* name)
+		: _profiler(profiler), _commandBuffer(commandBuffer), _zone(profiler.beginZone(commandBuffer, name))
+	{}
+
+	/// <summary>End the GPU zone.</summary>
+	~GpuProfileZone() { _profiler.endZone(_commandBuffer, _zone); }
+
+private:
+	GpuProfileZone(const GpuProfileZone&) = delete;
+	GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+
+	GpuProfiler& _profiler;
+	pvrvk::CommandBufferBase _commandBuffer;
+	uint32_t _zone;
+};
+
+/// <summary>Update a UIRenderer text object with the pvr::Profiler summary (average time per zone over the last few
+/// frames, CPU and GPU). Only the text is updated: position, scale and colour are left to the application, and the
+/// text still needs to be rendered as part of the UIRenderer pass.</summary>
+/// <param name="text">The text object to update. Should be created with a max length large enough for the summary.</param>
+/// <param name="numFrames">The number of frames to average over</param>
+void updateProfilerSummaryText(pvr::ui::Text& text, uint32_t numFrames = 60);
+} // namespace utils
+} // namespace pvr
@@ -1316,6 +1316,46 @@ void generateTextureAtlas(pvrvk::Device& device, const pvrvk::Image* inputImages
 	pvr::utils::endCommandBufferDebugLabel(cmdBuffer);
 }
 
+uint32_t flushDirtyRanges(const pvrvk::Buffer& buffer, StructuredBufferView& view, uint32_t dynamicSlice)
+{
+	debug_assertion(view.isDirtyRangeTrackingEnabled(), "flushDirtyRanges: Dirty range tracking must be enabled on the StructuredBufferView");
+	DirtyRangeTracker& dirtyRanges = view.getDirtyRanges();
+	if (!dirtyRanges.isDirty(dynamicSlice)) { return 0; }
+
+	uint32_t numRanges = 0;
+	const pvrvk::DeviceMemory& memory = buffer->getDeviceMemory();
+	if (static_cast<uint32_t>(memory->getMemoryFlags() & pvrvk::MemoryPropertyFlags::e_HOST_COHERENT_BIT) == 0)
+	{
+		// Flushed ranges must start and end on a multiple of nonCoherentAtomSize (or at the end of the memory), so align them here, where neighbouring
+		// ranges that end up sharing an atom can be merged, rather than letting each flush round them out separately
+		const uint64_t atomSize = std::max<uint64_t>(buffer->getDevice()->getPhysicalDevice()->getProperties().getLimits().getNonCoherentAtomSize(), 1);
+		DirtyRangeTracker::Range ranges[DirtyRangeTracker::MaxRangesPerSlice];
+		numRanges = dirtyRanges.getAlignedDirtyRanges(dynamicSlice, atomSize, memory->getSize(), ranges);
+		for (uint32_t i = 0; i < numRanges; ++i) { memory->flushRange(ranges[i].begin, ranges[i].size()); }
+	}
+	dirtyRanges.clear(dynamicSlice);
+	return numRanges;
+}
+
+uint32_t copyDirtyRanges(pvrvk::CommandBufferBase cmdBuffer, const pvrvk::Buffer& stagingBuffer, const pvrvk::Buffer& dstBuffer, StructuredBufferView& view, uint32_t dynamicSlice)
+{
+	debug_assertion(view.isDirtyRangeTrackingEnabled(), "copyDirtyRanges: Dirty range tracking must be enabled on the StructuredBufferView");
+	DirtyRangeTracker& dirtyRanges = view.getDirtyRanges();
+	if (!dirtyRanges.isDirty(dynamicSlice)) { return 0; }
+
+	// The copy only needs the exact ranges, but the host writes must reach the staging memory before the copy executes
+	const std::vector<DirtyRangeTracker::Range>& ranges = dirtyRanges.getDirtyRanges(dynamicSlice);
+	pvrvk::BufferCopy regions[DirtyRangeTracker::MaxRangesPerSlice];
+	const uint32_t numRegions = static_cast<uint32_t>(ranges.size());
+	for (uint32_t i = 0; i < numRegions; ++i) { regions[i] = pvrvk::BufferCopy(ranges[i].begin, ranges[i].begin, ranges[i].size()); }
+	flushDirtyRanges(stagingBuffer, view, dynamicSlice);
+
+	pvr::utils::beginCommandBufferDebugLabel(cmdBuffer, pvrvk::DebugUtilsLabel("PVRUtilsVk::copyDirtyRanges"));
+	cmdBuffer->copyBuffer(stagingBuffer, dstBuffer, numRegions, regions);
+	pvr::utils::endCommandBufferDebugLabel(cmdBuffer);
+	return numRegions;
+}
+
 void updateImage(pvrvk::Device& device, pvrvk::CommandBufferBase cbuffTransfer, ImageUpdateInfo* updateInfos, uint32_t numUpdateInfos, pvrvk::Format format,
 	pvrvk::ImageLayout layout, bool isCubeMap, pvrvk::Image& image, vma::Allocator bufferAllocator, bool isSafetyCritical)
 {
@@ -2343,6 +2383,13 @@ pvrvk::Surface createSurface(const pvrvk::Instance& instance, const pvrvk::Physi
 		Log(LogLevel::Information, "Using Instance surface extension: VK_MVK_macos_surface");
 		return pvrvk::Surface(instance->createMacOSSurface(window));
 	}
+#elif defined(Headless)
+	(void)window;
+	if (instance->getEnabledExtensionTable().extHeadlessSurfaceEnabled)
+	{
+		Log(LogLevel::Information, "Using Instance surface extension: VK_EXT_headless_surface");
+		return pvrvk::Surface(instance->createHeadlessSurface());
+	}
 #else // NullWS
 	if (instance->getEnabledExtensionTable().khrDisplayEnabled)
 	{
@@ -2581,6 +2628,11 @@ DeviceExtensions::DeviceExtensions(VulkanVersion vkVersion) : VulkanExtensionLis
 	addExtension(pvrvk::VulkanExtension(VK_IMG_FILTER_CUBIC_EXTENSION_NAME, (uint32_t)-1));
 #endif
 
+#ifdef VK_EXT_memory_budget
+	// attempt to enable heap budget queries, used by pvr::utils::MemoryManager
+	addExtension(pvrvk::VulkanExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, (uint32_t)-1));
+#endif
+
 #ifdef DEBUG
 #ifdef VK_EXT_debug_marker
 	// if the build is Debug then enable the DEBUG_MARKER extension to aid with debugging
@@ -2598,6 +2650,10 @@ DeviceExtensions::DeviceExtensions(VulkanVersion vkVersion) : VulkanExtensionLis
 #ifdef VK_KHR_dedicated_allocation
 		// attempt to enable VK_KHR_dedicated_allocation extension
 		if (!vkVersion.isSafetyCritical) { addExtension(pvrvk::VulkanExtension(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME, (uint32_t)-1)); }
+#endif
+#ifdef VK_KHR_descriptor_update_template
+		// attempt to enable VK_KHR_descriptor_update_template extension
+		if (!vkVersion.isSafetyCritical) { addExtension(pvrvk::VulkanExtension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, (uint32_t)-1)); }
 #endif
 	}
 }
@@ -2666,6 +2722,8 @@ InstanceExtensions::InstanceExtensions(VulkanVersion vkVersion)
 	addExtension(pvrvk::VulkanExtension(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME, (uint32_t)-1));
 #elif defined(VK_USE_PLATFORM_MACOS_MVK)
 	addExtension(pvrvk::VulkanExtension(VK_MVK_MACOS_SURFACE_EXTENSION_NAME, (uint32_t)-1));
+#elif defined(Headless)
+	addExtension(pvrvk::VulkanExtension(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME, (uint32_t)-1));
 #elif defined(VK_KHR_display) // NullWS
 	addExtension(pvrvk::VulkanExtension(VK_KHR_DISPLAY_EXTENSION_NAME, (uint32_t)-1));
 #endif
@@ -25,6 +25,7 @@
 #include "PVRVk/SwapchainVk.h"
 #include "PVRUtils/Vulkan/MemoryAllocator.h"
 #include "PVRUtils/MultiObject.h"
+#include "PVRUtils/StructuredMemory.h"
 #include "PVRVk/ExtensionsVk.h"
 namespace pvr {
 namespace utils {
@@ -685,6 +686,29 @@ inline void updateBufferUsingStagingBuffer(pvrvk::Device& device, pvrvk::Buffer&
 	pvr::utils::endCommandBufferDebugLabel(uploadCmdBuffer);
 }
 
+/// <summary>Utility function to flush only the ranges of a dynamic slice written through a StructuredBufferView since its last flush, instead of
+/// the whole slice. The view must have dirty range tracking enabled (StructuredBufferView::enableDirtyRangeTracking). The ranges are expanded to
+/// the nonCoherentAtomSize of the device and merged where they then touch, so that several values written close to each other are flushed together.
+/// The ranges of the slice are cleared; nothing is flushed if the memory of the buffer is host coherent.</summary>
+/// <param name="buffer">The host visible, mapped buffer the view describes</param>
+/// <param name="view">The StructuredBufferView used to write the buffer</param>
+/// <param name="dynamicSlice">The dynamic slice to flush</param>
+/// <returns>The number of ranges flushed</returns>
+uint32_t flushDirtyRanges(const pvrvk::Buffer& buffer, StructuredBufferView& view, uint32_t dynamicSlice);
+
+/// <summary>Utility function to record the copy of only the ranges of a dynamic slice written through a StructuredBufferView since its last copy,
+/// from a host visible staging buffer to a buffer laid out the same way, typically in device local memory. The view must describe the staging buffer
+/// and have dirty range tracking enabled (StructuredBufferView::enableDirtyRangeTracking). The staging buffer is flushed first if it is not host
+/// coherent, then one region is copied per range, and the ranges of the slice are cleared. The caller remains responsible for the barrier between
+/// the copy and the shaders that read the destination buffer.</summary>
+/// <param name="cmdBuffer">The command buffer to record the copy into</param>
+/// <param name="stagingBuffer">The host visible, mapped buffer the view describes</param>
+/// <param name="dstBuffer">The buffer to copy the ranges to, at the same offsets</param>
+/// <param name="view">The StructuredBufferView used to write the staging buffer</param>
+/// <param name="dynamicSlice">The dynamic slice to copy</param>
+/// <returns>The number of regions copied</returns>
+uint32_t copyDirtyRanges(pvrvk::CommandBufferBase cmdBuffer, const pvrvk::Buffer& stagingBuffer, const pvrvk::Buffer& dstBuffer, StructuredBufferView& view, uint32_t dynamicSlice);
+
 /// <summary>Utility function for generating a texture atlas based on a set of images.</summary>
 /// <param name="device">The device used to create the texture atlas.</param>
 /// <param name="inputImages">A list of input images used to generate the texture atlas from.</param>
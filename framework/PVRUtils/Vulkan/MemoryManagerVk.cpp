@@ -0,0 +1,403 @@
+/*!
+\brief Implementation of the MemoryManager class.
+\file PVRUtils/Vulkan/MemoryManagerVk.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/Vulkan/MemoryManagerVk.h"
+#include "PVRCore/Profiler.h"
+#include "PVRCore/Log.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+namespace pvr {
+namespace utils {
+namespace {
+const char* const categoryCounterNames[] = { "GPU Memory: Texture (MB)", "GPU Memory: Buffer (MB)", "GPU Memory: Attachment (MB)", "GPU Memory: Other (MB)" };
+
+double toMegabytes(pvrvk::DeviceSize bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+bool isDeviceLocalHeap(const pvrvk::PhysicalDeviceMemoryProperties& memoryProperties, uint32_t heapIndex)
+{
+	return static_cast<uint32_t>(memoryProperties.getMemoryHeaps()[heapIndex].getFlags() & pvrvk::MemoryHeapFlags::e_DEVICE_LOCAL_BIT) != 0;
+}
+} // namespace
+
+void MemoryManager::init(const pvrvk::Device& device, const vma::Allocator& allocator, const MemoryManagerCreateInfo& createInfo)
+{
+	_device = device;
+	_allocator = allocator;
+	_createInfo = createInfo;
+	_frame = 0;
+	_nextEvictionFrame = 0;
+	_defragmentCursor = 0;
+	_telemetry = MemoryTelemetry();
+
+	// VK_EXT_memory_budget is queried through vkGetPhysicalDeviceMemoryProperties2
+	const pvrvk::Instance& instance = device->getPhysicalDevice()->getInstance();
+	_budgetExtension = device->getEnabledExtensionTable().extMemoryBudgetEnabled &&
+		(instance->getEnabledExtensionTable().khrGetPhysicalDeviceProperties2Enabled || instance->getVkBindings().vkGetPhysicalDeviceMemoryProperties2 != nullptr);
+	if (!_budgetExtension) { Log(LogLevel::Information, "MemoryManager: VK_EXT_memory_budget is not enabled. Heap budgets will be estimated from the heap sizes."); }
+	pollBudgets();
+}
+
+void MemoryManager::release()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_resources.clear();
+	_allocator.reset();
+	_device.reset();
+}
+
+pvrvk::Image MemoryManager::createImage(const pvrvk::ImageCreateInfo& createInfo, const vma::AllocationCreateInfo& allocationCreateInfo, const std::string& tag,
+	const EvictionCallback& evictionCallback, ResourceId* outId)
+{
+	pvrvk::Image image = _allocator->createImage(createInfo, allocationCreateInfo);
+	const ResourceId id = trackImage(image, tag, evictionCallback);
+	if (outId) { *outId = id; }
+	return image;
+}
+
+pvrvk::Buffer MemoryManager::createBuffer(const pvrvk::BufferCreateInfo& createInfo, const vma::AllocationCreateInfo& allocationCreateInfo, const std::string& tag,
+	const EvictionCallback& evictionCallback, const RelocationCallback& relocationCallback, ResourceId* outId)
+{
+	pvrvk::Buffer buffer = _allocator->createBuffer(createInfo, allocationCreateInfo);
+	const ResourceId id = trackBuffer(buffer, tag, evictionCallback, relocationCallback);
+	if (outId) { *outId = id; }
+	return buffer;
+}
+
+MemoryManager::ResourceId MemoryManager::trackImage(const pvrvk::Image& image, const std::string& tag, const EvictionCallback& evictionCallback)
+{
+	const pvrvk::ImageUsageFlags attachmentUsage = pvrvk::ImageUsageFlags::e_COLOR_ATTACHMENT_BIT | pvrvk::ImageUsageFlags::e_DEPTH_STENCIL_ATTACHMENT_BIT |
+		pvrvk::ImageUsageFlags::e_TRANSIENT_ATTACHMENT_BIT | pvrvk::ImageUsageFlags::e_INPUT_ATTACHMENT_BIT;
+	const MemoryCategory category = static_cast<uint32_t>(image->getUsageFlags() & attachmentUsage) != 0 ? MemoryCategory::Attachment : MemoryCategory::Texture;
+	return track(image, image->getDeviceMemory(), category, tag, evictionCallback, nullptr);
+}
+
+MemoryManager::ResourceId MemoryManager::trackBuffer(
+	const pvrvk::Buffer& buffer, const std::string& tag, const EvictionCallback& evictionCallback, const RelocationCallback& relocationCallback)
+{
+	return track(buffer, buffer->getDeviceMemory(), MemoryCategory::Buffer, tag, evictionCallback, relocationCallback);
+}
+
+MemoryManager::ResourceId MemoryManager::track(const std::shared_ptr<void>& object, const pvrvk::DeviceMemory& memory, MemoryCategory category, const std::string& tag,
+	const EvictionCallback& evictionCallback, const RelocationCallback& relocationCallback)
+{
+	vma::Allocation allocation = std::dynamic_pointer_cast<vma::impl::Allocation_>(memory);
+	if (!allocation) { throw InvalidArgumentError("memory", "MemoryManager: Only resources allocated with the VMA allocator can be tracked"); }
+
+	pvrvk::Device device = _device.lock();
+	if (!device) { throw InvalidOperationError("MemoryManager: Resources can only be tracked between init and release"); }
+	const pvrvk::PhysicalDeviceMemoryProperties& memoryProperties = device->getPhysicalDevice()->getMemoryProperties();
+
+	Resource resource;
+	resource.object = object;
+	resource.allocation = allocation;
+	resource.size = allocation->getSize();
+	resource.heapIndex = memoryProperties.getMemoryTypes()[allocation->getMemoryType()].getHeapIndex();
+	resource.category = category;
+	resource.tag = tag;
+	resource.evictionCallback = evictionCallback;
+	resource.relocationCallback = relocationCallback;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	resource.id = _nextId++;
+	resource.lastUsedFrame = _frame;
+	_resources.emplace_back(std::move(resource));
+	return _resources.back().id;
+}
+
+MemoryManager::Resource* MemoryManager::findResource(ResourceId id)
+{
+	// Resources are appended with increasing ids and removed in place, so the list is always sorted
+	auto it = std::lower_bound(_resources.begin(), _resources.end(), id, [](const Resource& resource, ResourceId id) { return resource.id < id; });
+	return it != _resources.end() && it->id == id ? &*it : nullptr;
+}
+
+void MemoryManager::setCategory(ResourceId id, MemoryCategory category)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Resource* resource = findResource(id);
+	if (resource) { resource->category = category; }
+}
+
+void MemoryManager::untrack(ResourceId id)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Resource* resource = findResource(id);
+	if (resource) { _resources.erase(_resources.begin() + (resource - _resources.data())); }
+}
+
+void MemoryManager::markUsed(ResourceId id)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Resource* resource = findResource(id);
+	if (resource) { resource->lastUsedFrame = _frame; }
+}
+
+void MemoryManager::setBudget(pvrvk::DeviceSize budget) { _createInfo.budget = budget; }
+
+void MemoryManager::nextFrame()
+{
+	if (_device.expired()) { return; }
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		++_frame;
+		_resources.erase(std::remove_if(_resources.begin(), _resources.end(), [](const Resource& resource) { return resource.object.expired() || resource.allocation.expired(); }),
+			_resources.end());
+	}
+	pollBudgets();
+	enforceBudget();
+	defragmentStep();
+	exportTelemetry();
+}
+
+void MemoryManager::pollBudgets()
+{
+	pvrvk::Device device = _device.lock();
+	if (!device) { return; }
+	const pvrvk::PhysicalDevice& physicalDevice = device->getPhysicalDevice();
+	const pvrvk::PhysicalDeviceMemoryProperties& memoryProperties = physicalDevice->getMemoryProperties();
+	const uint32_t numHeaps = memoryProperties.getMemoryHeapCount();
+
+	// The allocator statistics give the size of the VkDeviceMemory blocks, which is how much each heap is used by this process when the budget extension is unavailable
+	const vma::Stats stats = _allocator->calculateStats();
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+	if (_budgetExtension)
+	{
+		budgetProperties.sType = static_cast<VkStructureType>(pvrvk::StructureType::e_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT);
+		VkPhysicalDeviceMemoryProperties2KHR memoryProperties2 = {};
+		memoryProperties2.sType = static_cast<VkStructureType>(pvrvk::StructureType::e_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR);
+		memoryProperties2.pNext = &budgetProperties;
+		const pvrvk::Instance& instance = physicalDevice->getInstance();
+		if (instance->getEnabledExtensionTable().khrGetPhysicalDeviceProperties2Enabled)
+		{ instance->getVkBindings().vkGetPhysicalDeviceMemoryProperties2KHR(physicalDevice->getVkHandle(), &memoryProperties2); }
+		else
+		{
+			instance->getVkBindings().vkGetPhysicalDeviceMemoryProperties2(physicalDevice->getVkHandle(), &memoryProperties2);
+		}
+	}
+
+	// The queries above are done before taking the lock, which readers of the telemetry on other threads wait for
+	std::lock_guard<std::mutex> lock(_mutex);
+	MemoryTelemetry& telemetry = _telemetry;
+	telemetry.heaps.resize(numHeaps);
+	telemetry.budgetExtension = _budgetExtension;
+	telemetry.allocatedBytes = stats.total.getUsedBytes() + stats.total.getUnusedBytes();
+	telemetry.unusedBytes = stats.total.getUnusedBytes();
+	telemetry.deviceLocalBudget = 0;
+	telemetry.deviceLocalUsage = 0;
+	for (uint32_t i = 0; i < numHeaps; ++i)
+	{
+		MemoryHeapBudget& heap = telemetry.heaps[i];
+		heap.size = memoryProperties.getMemoryHeaps()[i].getSize();
+		heap.deviceLocal = isDeviceLocalHeap(memoryProperties, i);
+		if (_budgetExtension)
+		{
+			heap.budget = budgetProperties.heapBudget[i];
+			heap.usage = budgetProperties.heapUsage[i];
+		}
+		else
+		{
+			// Same heuristic as VMA: without the extension, assume 80% of a heap is available to the process
+			heap.budget = heap.size * 8 / 10;
+			heap.usage = stats.memoryHeap[i].getUsedBytes() + stats.memoryHeap[i].getUnusedBytes();
+		}
+		if (heap.deviceLocal)
+		{
+			telemetry.deviceLocalBudget += heap.budget;
+			telemetry.deviceLocalUsage += heap.usage;
+		}
+	}
+	telemetry.budget = _createInfo.budget ? _createInfo.budget : static_cast<pvrvk::DeviceSize>(static_cast<double>(telemetry.deviceLocalBudget) * _createInfo.budgetFraction);
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); ++i)
+	{
+		telemetry.categoryBytes[i] = 0;
+		telemetry.categoryCount[i] = 0;
+	}
+	for (const Resource& resource : _resources)
+	{
+		telemetry.categoryBytes[static_cast<uint32_t>(resource.category)] += resource.size;
+		++telemetry.categoryCount[static_cast<uint32_t>(resource.category)];
+	}
+}
+
+void MemoryManager::enforceBudget()
+{
+	// Evicted resources are only destroyed once the application releases them, and the reported usage lags behind: give the previous
+	// evictions time to take effect before evicting more.
+	if (_telemetry.deviceLocalUsage <= _telemetry.budget || _frame < _nextEvictionFrame) { return; }
+	const pvrvk::DeviceSize excess = _telemetry.deviceLocalUsage - _telemetry.budget;
+	pvrvk::Device device = _device.lock();
+	if (!device) { return; }
+	const pvrvk::PhysicalDeviceMemoryProperties& memoryProperties = device->getPhysicalDevice()->getMemoryProperties();
+
+	std::vector<std::pair<ResourceId, EvictionCallback>> evicted;
+	pvrvk::DeviceSize bytesEvicted = 0;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::vector<const Resource*> candidates;
+		for (const Resource& resource : _resources)
+		{
+			if (resource.evictionCallback && isIdle(resource) && isDeviceLocalHeap(memoryProperties, resource.heapIndex)) { candidates.push_back(&resource); }
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const Resource* a, const Resource* b) { return a->lastUsedFrame < b->lastUsedFrame; });
+		for (const Resource* resource : candidates)
+		{
+			if (bytesEvicted >= excess) { break; }
+			bytesEvicted += resource->size;
+			evicted.emplace_back(resource->id, resource->evictionCallback);
+		}
+		for (const auto& eviction : evicted)
+		{
+			Resource* resource = findResource(eviction.first);
+			_resources.erase(_resources.begin() + (resource - _resources.data()));
+		}
+		_telemetry.evictions += evicted.size();
+		_telemetry.bytesEvicted += bytesEvicted;
+	}
+
+	if (evicted.empty())
+	{
+		// Nothing can be evicted until streaming resources become idle or are added: check again (and warn) about once a second
+		_nextEvictionFrame = _frame + 60;
+		Log(LogLevel::Warning, "MemoryManager: Device local memory usage (%.1f MB) exceeds the budget (%.1f MB) but no streaming resource can be evicted",
+			toMegabytes(_telemetry.deviceLocalUsage), toMegabytes(_telemetry.budget));
+		return;
+	}
+
+	_nextEvictionFrame = _frame + _createInfo.framesInFlight + 1;
+	Log(LogLevel::Debug, "MemoryManager: Evicted %u streaming resources (%.1f MB) to respect the budget of %.1f MB", static_cast<uint32_t>(evicted.size()),
+		toMegabytes(bytesEvicted), toMegabytes(_telemetry.budget));
+	// The callbacks run without the lock held, so that they can release, create or track resources
+	for (const auto& eviction : evicted) { eviction.second(eviction.first); }
+}
+
+void MemoryManager::defragmentStep()
+{
+	if (!_createInfo.defragmentMaxBytesPerFrame || !_createInfo.defragmentMaxAllocationsPerFrame) { return; }
+
+	std::vector<vma::Allocation> allocations;
+	std::vector<ResourceId> ids;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		const size_t numResources = _resources.size();
+		if (!numResources) { return; }
+
+		// Visit the resources round-robin, so that successive frames make progress over all of them
+		const uint32_t maxCandidates = _createInfo.defragmentMaxAllocationsPerFrame * 4;
+		for (size_t visited = 0; visited < numResources && allocations.size() < maxCandidates; ++visited)
+		{
+			const Resource& resource = _resources[(_defragmentCursor + visited) % numResources];
+			if (!resource.relocationCallback || !isIdle(resource)) { continue; }
+			vma::Allocation allocation = resource.allocation.lock();
+			if (!allocation || !allocation->isMappable() || allocation->isMapped()) { continue; }
+			allocations.emplace_back(allocation);
+			ids.emplace_back(resource.id);
+		}
+		_defragmentCursor = (_defragmentCursor + numResources / 8 + 1) % numResources;
+	}
+	if (allocations.empty()) { return; }
+
+	vma::impl::VmaDefragmentationInfo defragmentationInfo;
+	defragmentationInfo.maxBytesToMove = _createInfo.defragmentMaxBytesPerFrame;
+	defragmentationInfo.maxAllocationsToMove = _createInfo.defragmentMaxAllocationsPerFrame;
+	std::vector<pvrvk::Bool32> changed(allocations.size(), false);
+	vma::DefragmentationStats stats;
+	_allocator->defragment(allocations.data(), static_cast<uint32_t>(allocations.size()), &defragmentationInfo, changed.data(), &stats);
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_telemetry.allocationsMoved += stats.getAllocationsMoved();
+		_telemetry.bytesMoved += stats.getBytesMoved();
+		_telemetry.bytesFreed += stats.getBytesFreed();
+	}
+	if (!stats.getAllocationsMoved()) { return; }
+
+	// The moved allocations now point to their new location, but the buffers are still bound to the old one: recreate and rebind them
+	pvrvk::Device device = _device.lock();
+	if (!device) { return; }
+	std::vector<std::pair<pvrvk::Buffer, RelocationCallback>> relocated;
+	std::vector<ResourceId> relocatedIds;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (size_t i = 0; i < allocations.size(); ++i)
+		{
+			if (!changed[i]) { continue; }
+			Resource* resource = findResource(ids[i]);
+			if (!resource) { continue; }
+			pvrvk::Buffer oldBuffer = std::static_pointer_cast<pvrvk::impl::Buffer_>(resource->object.lock());
+			if (!oldBuffer) { continue; }
+			pvrvk::Buffer newBuffer = device->createBuffer(oldBuffer->getCreateInfo());
+			newBuffer->bindMemory(pvrvk::DeviceMemory(allocations[i]), allocations[i]->getOffset());
+			if (!oldBuffer->getObjectName().empty()) { newBuffer->setObjectName(oldBuffer->getObjectName()); }
+			resource->object = newBuffer;
+			relocated.emplace_back(newBuffer, resource->relocationCallback);
+			relocatedIds.emplace_back(resource->id);
+		}
+	}
+	for (size_t i = 0; i < relocated.size(); ++i) { relocated[i].second(relocatedIds[i], relocated[i].first); }
+}
+
+void MemoryManager::exportTelemetry()
+{
+	const MemoryTelemetry& telemetry = _telemetry;
+	Profiler& profiler = Profiler::getInstance();
+	if (_createInfo.exportToProfiler && profiler.isEnabled())
+	{
+		for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); ++i) { profiler.recordCounter(categoryCounterNames[i], toMegabytes(telemetry.categoryBytes[i])); }
+		profiler.recordCounter("GPU Memory: Device Local Usage (MB)", toMegabytes(telemetry.deviceLocalUsage));
+		profiler.recordCounter("GPU Memory: Budget (MB)", toMegabytes(telemetry.budget));
+		profiler.recordCounter("GPU Memory: VMA Unused (MB)", toMegabytes(telemetry.unusedBytes));
+	}
+	if (_createInfo.logInterval && _frame % _createInfo.logInterval == 0) { Log(LogLevel::Information, "MemoryManager:\n%s", getTelemetryString().c_str()); }
+}
+
+std::vector<std::pair<std::string, pvrvk::DeviceSize>> MemoryManager::getUsageByTag() const
+{
+	std::map<std::string, pvrvk::DeviceSize> usage;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const Resource& resource : _resources) { usage[resource.tag] += resource.size; }
+	}
+	std::vector<std::pair<std::string, pvrvk::DeviceSize>> sorted(usage.begin(), usage.end());
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, pvrvk::DeviceSize>& a, const std::pair<std::string, pvrvk::DeviceSize>& b) { return a.second > b.second; });
+	return sorted;
+}
+
+std::string MemoryManager::getTelemetryString() const
+{
+	// Formatted from a copy, so that the lock is not held while formatting
+	const MemoryTelemetry telemetry = getTelemetry();
+	std::string text;
+	char line[160];
+	snprintf(line, sizeof(line), "Device local: %.1f / %.1f MB (budget %.1f MB%s)\n", toMegabytes(telemetry.deviceLocalUsage), toMegabytes(telemetry.deviceLocalBudget),
+		toMegabytes(telemetry.budget), telemetry.budgetExtension ? "" : ", estimated");
+	text += line;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); ++i)
+	{
+		snprintf(line, sizeof(line), "  %s: %.1f MB (%u)\n", toString(static_cast<MemoryCategory>(i)), toMegabytes(telemetry.categoryBytes[i]), telemetry.categoryCount[i]);
+		text += line;
+	}
+	for (size_t i = 0; i < telemetry.heaps.size(); ++i)
+	{
+		const MemoryHeapBudget& heap = telemetry.heaps[i];
+		snprintf(line, sizeof(line), "  Heap %u%s: %.1f / %.1f MB (size %.1f MB)\n", static_cast<uint32_t>(i), heap.deviceLocal ? " (device local)" : "", toMegabytes(heap.usage),
+			toMegabytes(heap.budget), toMegabytes(heap.size));
+		text += line;
+	}
+	snprintf(line, sizeof(line), "VMA: %.1f MB in blocks, %.1f MB unused\n", toMegabytes(telemetry.allocatedBytes), toMegabytes(telemetry.unusedBytes));
+	text += line;
+	snprintf(line, sizeof(line), "Evicted: %llu (%.1f MB), defragmented: %llu (%.1f MB moved, %.1f MB freed)\n", static_cast<unsigned long long>(telemetry.evictions),
+		toMegabytes(telemetry.bytesEvicted), static_cast<unsigned long long>(telemetry.allocationsMoved), toMegabytes(telemetry.bytesMoved), toMegabytes(telemetry.bytesFreed));
+	text += line;
+	return text;
+}
+} // namespace utils
+} // namespace pvr
+//!\endcond
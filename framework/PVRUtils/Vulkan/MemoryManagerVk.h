@@ -0,0 +1,259 @@
+/*!
+\brief Contains a memory manager built on top of the VMA allocator, providing heap budget tracking, per category usage telemetry,
+budget enforcement through eviction of streaming resources and bounded incremental defragmentation.
+\file PVRUtils/Vulkan/MemoryManagerVk.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRUtils/Vulkan/MemoryAllocator.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pvr {
+namespace utils {
+/// <summary>The categories memory usage is reported in.</summary>
+enum class MemoryCategory : uint32_t
+{
+	Texture, //!< Sampled and storage images
+	Buffer, //!< Vertex, index, uniform, storage and staging buffers
+	Attachment, //!< Colour, depth/stencil, input and transient attachments
+	Other, //!< Anything else
+	Count
+};
+
+/// <summary>Get the name of a memory category.</summary>
+/// <param name="category">A memory category</param>
+/// <returns>The name of the category</returns>
+inline const char* toString(MemoryCategory category)
+{
+	switch (category)
+	{
+	case MemoryCategory::Texture: return "Texture";
+	case MemoryCategory::Buffer: return "Buffer";
+	case MemoryCategory::Attachment: return "Attachment";
+	default: return "Other";
+	}
+}
+
+/// <summary>Parameters of a MemoryManager.</summary>
+struct MemoryManagerCreateInfo
+{
+	/// <summary>The number of bytes of device local memory the application may use. If 0, the budget is budgetFraction of the device
+	/// local heap budgets reported by VK_EXT_memory_budget (or of the device local heap sizes if the extension is unavailable).</summary>
+	pvrvk::DeviceSize budget;
+	/// <summary>The fraction of the device local heap budgets used as the budget when budget is 0.</summary>
+	float budgetFraction;
+	/// <summary>The maximum number of bytes defragmentation may move per frame. 0 disables defragmentation.</summary>
+	pvrvk::DeviceSize defragmentMaxBytesPerFrame;
+	/// <summary>The maximum number of allocations defragmentation may move per frame.</summary>
+	uint32_t defragmentMaxAllocationsPerFrame;
+	/// <summary>The number of frames a resource must have been unused for before it can be evicted or moved. Must be at least the
+	/// number of frames in flight, so that the GPU is guaranteed to have finished using it.</summary>
+	uint32_t framesInFlight;
+	/// <summary>The number of frames between two telemetry lines in the log. 0 never logs.</summary>
+	uint32_t logInterval;
+	/// <summary>Record the memory counters into pvr::Profiler every frame (when it is enabled).</summary>
+	bool exportToProfiler;
+
+	/// <summary>Constructor. Uses 90% of the device local budget, moves at most 4MB in 16 allocations per frame, assumes 3 frames in
+	/// flight, does not log and exports to the profiler.</summary>
+	MemoryManagerCreateInfo()
+		: budget(0), budgetFraction(.9f), defragmentMaxBytesPerFrame(4 * 1024 * 1024), defragmentMaxAllocationsPerFrame(16), framesInFlight(3), logInterval(0),
+		  exportToProfiler(true)
+	{}
+};
+
+/// <summary>The budget and usage of a memory heap.</summary>
+struct MemoryHeapBudget
+{
+	pvrvk::DeviceSize size; //!< The size of the heap
+	pvrvk::DeviceSize budget; //!< The amount of memory the process can use from the heap before allocations may fail or cause performance degradation
+	pvrvk::DeviceSize usage; //!< The amount of memory the process currently uses from the heap
+	bool deviceLocal; //!< True if the heap is device local
+};
+
+/// <summary>A snapshot of the memory usage tracked by a MemoryManager.</summary>
+struct MemoryTelemetry
+{
+	pvrvk::DeviceSize categoryBytes[static_cast<uint32_t>(MemoryCategory::Count)]; //!< The bytes allocated by tracked resources, per category
+	uint32_t categoryCount[static_cast<uint32_t>(MemoryCategory::Count)]; //!< The number of tracked resources, per category
+	std::vector<MemoryHeapBudget> heaps; //!< The budget and usage of every memory heap
+	pvrvk::DeviceSize deviceLocalUsage; //!< The total usage of the device local heaps
+	pvrvk::DeviceSize deviceLocalBudget; //!< The total budget of the device local heaps
+	pvrvk::DeviceSize budget; //!< The budget the manager enforces
+	pvrvk::DeviceSize allocatedBytes; //!< The bytes allocated in VkDeviceMemory blocks by the VMA allocator
+	pvrvk::DeviceSize unusedBytes; //!< The bytes of the VMA blocks not used by any allocation (fragmentation and slack)
+	uint64_t evictions; //!< The total number of resources evicted
+	pvrvk::DeviceSize bytesEvicted; //!< The total bytes evicted
+	uint64_t allocationsMoved; //!< The total number of allocations moved by defragmentation
+	pvrvk::DeviceSize bytesMoved; //!< The total bytes moved by defragmentation
+	pvrvk::DeviceSize bytesFreed; //!< The total bytes of VkDeviceMemory released by defragmentation
+	bool budgetExtension; //!< True if heap budgets come from VK_EXT_memory_budget, false if they are estimated
+
+	/// <summary>Constructor. Zero-initialises everything.</summary>
+	MemoryTelemetry()
+		: deviceLocalUsage(0), deviceLocalBudget(0), budget(0), allocatedBytes(0), unusedBytes(0), evictions(0), bytesEvicted(0), allocationsMoved(0), bytesMoved(0), bytesFreed(0),
+		  budgetExtension(false)
+	{
+		for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); ++i)
+		{
+			categoryBytes[i] = 0;
+			categoryCount[i] = 0;
+		}
+	}
+};
+
+/// <summary>Tracks the images and buffers of an application, allocated through a VMA allocator, and keeps the application's device local
+/// memory usage under control over long runs:
+/// - Heap budgets are polled every frame (VK_EXT_memory_budget if enabled, otherwise estimated from the heap sizes and allocator statistics)
+///   and the usage of the tracked resources is reported per category and tag, to the log and to pvr::Profiler as counters.
+/// - Resources registered with an eviction callback are streaming resources. When the usage exceeds the budget, the least recently used of
+///   them are evicted (their callback is called so that the application drops them) until the usage fits the budget again.
+/// - Buffers registered with a relocation callback can be defragmented: every frame, a bounded number of bytes and allocations is moved to
+///   compact the allocator's memory blocks, the affected buffers are recreated and rebound, and their owners are notified.
+/// Call nextFrame() once per frame, after waiting for the fence of the oldest frame in flight.</summary>
+/// <remarks>Tracking holds weak references only: a resource stops being tracked once the application releases it. Defragmentation uses
+/// vmaDefragment, which copies allocations on the CPU and therefore only moves buffers in HOST_VISIBLE memory that are not mapped.
+/// Resources are only ever evicted or moved once they have not been used (see markUsed) for MemoryManagerCreateInfo::framesInFlight frames.</remarks>
+class MemoryManager
+{
+public:
+	/// <summary>Identifies a tracked resource.</summary>
+	typedef uint64_t ResourceId;
+	/// <summary>Called when a streaming resource is evicted. The application must release all of its references to the resource.</summary>
+	typedef std::function<void(ResourceId id)> EvictionCallback;
+	/// <summary>Called when a buffer has been moved by defragmentation. The application must replace all of its references to the old buffer
+	/// with newBuffer (including in descriptor sets) before using it again.</summary>
+	typedef std::function<void(ResourceId id, const pvrvk::Buffer& newBuffer)> RelocationCallback;
+
+	/// <summary>Constructor. Creates an uninitialised manager. Call init() before use.</summary>
+	MemoryManager() : _frame(0), _nextEvictionFrame(0), _nextId(1), _defragmentCursor(0), _budgetExtension(false) {}
+
+	/// <summary>Initialise the manager.</summary>
+	/// <param name="device">The device</param>
+	/// <param name="allocator">The allocator the tracked resources are allocated with</param>
+	/// <param name="createInfo">The budget, defragmentation and telemetry parameters</param>
+	void init(const pvrvk::Device& device, const vma::Allocator& allocator, const MemoryManagerCreateInfo& createInfo = MemoryManagerCreateInfo());
+
+	/// <summary>Stop tracking all resources and release the device and allocator.</summary>
+	void release();
+
+	/// <summary>Create an image with the allocator and track it.</summary>
+	/// <param name="createInfo">The image create info</param>
+	/// <param name="allocationCreateInfo">The allocation create info</param>
+	/// <param name="tag">A tag the usage of the image is reported under</param>
+	/// <param name="evictionCallback">If set, the image is a streaming resource that can be evicted to respect the budget</param>
+	/// <param name="outId">If not null, receives the id of the image</param>
+	/// <returns>The image</returns>
+	pvrvk::Image createImage(const pvrvk::ImageCreateInfo& createInfo, const vma::AllocationCreateInfo& allocationCreateInfo, const std::string& tag = std::string(),
+		const EvictionCallback& evictionCallback = nullptr, ResourceId* outId = nullptr);
+
+	/// <summary>Create a buffer with the allocator and track it.</summary>
+	/// <param name="createInfo">The buffer create info</param>
+	/// <param name="allocationCreateInfo">The allocation create info</param>
+	/// <param name="tag">A tag the usage of the buffer is reported under</param>
+	/// <param name="evictionCallback">If set, the buffer is a streaming resource that can be evicted to respect the budget</param>
+	/// <param name="relocationCallback">If set, the buffer can be moved by defragmentation</param>
+	/// <param name="outId">If not null, receives the id of the buffer</param>
+	/// <returns>The buffer</returns>
+	pvrvk::Buffer createBuffer(const pvrvk::BufferCreateInfo& createInfo, const vma::AllocationCreateInfo& allocationCreateInfo, const std::string& tag = std::string(),
+		const EvictionCallback& evictionCallback = nullptr, const RelocationCallback& relocationCallback = nullptr, ResourceId* outId = nullptr);
+
+	/// <summary>Track an image allocated with the allocator. The category is Attachment for images usable as attachments, Texture otherwise.</summary>
+	/// <param name="image">The image. Its memory must be a vma::Allocation.</param>
+	/// <param name="tag">A tag the usage of the image is reported under</param>
+	/// <param name="evictionCallback">If set, the image is a streaming resource that can be evicted to respect the budget</param>
+	/// <returns>The id of the image</returns>
+	ResourceId trackImage(const pvrvk::Image& image, const std::string& tag = std::string(), const EvictionCallback& evictionCallback = nullptr);
+
+	/// <summary>Track a buffer allocated with the allocator. The category is Buffer.</summary>
+	/// <param name="buffer">The buffer. Its memory must be a vma::Allocation.</param>
+	/// <param name="tag">A tag the usage of the buffer is reported under</param>
+	/// <param name="evictionCallback">If set, the buffer is a streaming resource that can be evicted to respect the budget</param>
+	/// <param name="relocationCallback">If set, the buffer can be moved by defragmentation</param>
+	/// <returns>The id of the buffer</returns>
+	ResourceId trackBuffer(const pvrvk::Buffer& buffer, const std::string& tag = std::string(), const EvictionCallback& evictionCallback = nullptr,
+		const RelocationCallback& relocationCallback = nullptr);
+
+	/// <summary>Override the category a resource is reported in.</summary>
+	/// <param name="id">The id of the resource</param>
+	/// <param name="category">The category</param>
+	void setCategory(ResourceId id, MemoryCategory category);
+
+	/// <summary>Stop tracking a resource. Resources are also untracked automatically once released.</summary>
+	/// <param name="id">The id of the resource</param>
+	void untrack(ResourceId id);
+
+	/// <summary>Record that a resource is used by the current frame. Streaming resources are evicted in least recently used order,
+	/// and resources used in the last framesInFlight frames are never evicted or moved.</summary>
+	/// <param name="id">The id of the resource</param>
+	void markUsed(ResourceId id);
+
+	/// <summary>Start a new frame: poll the heap budgets, evict streaming resources if the usage exceeds the budget, run a bounded
+	/// defragmentation step and export the telemetry. Must be called once per frame, after waiting for the fence of the oldest frame in flight,
+	/// from the thread that records the frame.</summary>
+	void nextFrame();
+
+	/// <summary>Set the budget.</summary>
+	/// <param name="budget">The number of bytes of device local memory the application may use. 0 uses the budgetFraction of the device
+	/// local heap budgets.</param>
+	void setBudget(pvrvk::DeviceSize budget);
+
+	/// <summary>Get a copy of the telemetry as of the last call to nextFrame. May be called from any thread.</summary>
+	/// <returns>The telemetry</returns>
+	MemoryTelemetry getTelemetry() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _telemetry;
+	}
+
+	/// <summary>Get the usage of the tracked resources per tag, largest first.</summary>
+	/// <returns>Pairs of tag and bytes</returns>
+	std::vector<std::pair<std::string, pvrvk::DeviceSize>> getUsageByTag() const;
+
+	/// <summary>Format the telemetry as text, one line per category and heap, suitable for an on-screen overlay or the log. May be called
+	/// from any thread.</summary>
+	/// <returns>The telemetry text</returns>
+	std::string getTelemetryString() const;
+
+private:
+	struct Resource
+	{
+		ResourceId id;
+		std::weak_ptr<void> object;
+		std::weak_ptr<vma::impl::Allocation_> allocation;
+		pvrvk::DeviceSize size;
+		uint32_t heapIndex;
+		MemoryCategory category;
+		std::string tag;
+		uint64_t lastUsedFrame;
+		EvictionCallback evictionCallback;
+		RelocationCallback relocationCallback;
+	};
+
+	ResourceId track(const std::shared_ptr<void>& object, const pvrvk::DeviceMemory& memory, MemoryCategory category, const std::string& tag, const EvictionCallback& evictionCallback,
+		const RelocationCallback& relocationCallback);
+	Resource* findResource(ResourceId id);
+	void pollBudgets();
+	void enforceBudget();
+	void defragmentStep();
+	void exportTelemetry();
+	bool isIdle(const Resource& resource) const { return _frame >= resource.lastUsedFrame + _createInfo.framesInFlight; }
+
+	pvrvk::DeviceWeakPtr _device;
+	vma::Allocator _allocator;
+	MemoryManagerCreateInfo _createInfo;
+	mutable std::mutex _mutex; // Protects _resources and _telemetry. The telemetry is only written by nextFrame, which may read it without the lock.
+	std::vector<Resource> _resources;
+	MemoryTelemetry _telemetry;
+	uint64_t _frame;
+	uint64_t _nextEvictionFrame;
+	ResourceId _nextId;
+	size_t _defragmentCursor;
+	bool _budgetExtension;
+};
+} // namespace utils
+} // namespace pvr
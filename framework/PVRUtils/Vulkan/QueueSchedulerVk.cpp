@@ -0,0 +1,377 @@
+/*!
+\brief Implementation of the QueueScheduler class.
+\file PVRUtils/Vulkan/QueueSchedulerVk.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/Vulkan/QueueSchedulerVk.h"
+#include "PVRCore/Errors.h"
+#include "PVRCore/Log.h"
+#include <algorithm>
+#include <cassert>
+
+namespace pvr {
+namespace utils {
+void QueueScheduler::Batch::clear()
+{
+	commandBuffers.clear();
+	waitSemaphores.clear();
+	waitStages.clear();
+	waitValues.clear();
+	signalSemaphores.clear();
+	signalValues.clear();
+	canMerge = true;
+}
+
+void QueueScheduler::getQueuePopulateInfos(pvrvk::Surface& surface, std::vector<QueuePopulateInfo>& outPopulateInfos)
+{
+	outPopulateInfos.clear();
+	outPopulateInfos.emplace_back(pvrvk::QueueFlags::e_GRAPHICS_BIT, surface);
+	outPopulateInfos.emplace_back(pvrvk::QueueFlags::e_COMPUTE_BIT);
+}
+
+void QueueScheduler::init(const pvrvk::Device& device, const QueueAccessInfo* accessInfos)
+{
+	const QueueAccessInfo& graphics = accessInfos[static_cast<uint32_t>(ScheduledQueue::Graphics)];
+	const QueueAccessInfo& compute = accessInfos[static_cast<uint32_t>(ScheduledQueue::Compute)];
+	if (graphics.familyId == static_cast<uint32_t>(-1)) { throw InvalidArgumentError("accessInfos", "QueueScheduler: No graphics queue was found"); }
+
+	const pvrvk::Queue graphicsQueue = device->getQueue(graphics.familyId, graphics.queueId);
+	if (compute.familyId == static_cast<uint32_t>(-1))
+	{
+		Log(LogLevel::Information, "QueueScheduler: No compute queue was found, compute work will be scheduled on the graphics queue");
+		init(device, graphicsQueue, graphicsQueue);
+	}
+	else
+	{
+		init(device, graphicsQueue, device->getQueue(compute.familyId, compute.queueId));
+	}
+}
+
+void QueueScheduler::init(const pvrvk::Device& device, const pvrvk::Queue& graphicsQueue, const pvrvk::Queue& computeQueue)
+{
+	if (!graphicsQueue) { throw InvalidArgumentError("graphicsQueue", "QueueScheduler: The graphics queue must be valid"); }
+	release();
+
+	_device = device;
+	_timelines[0].queue = graphicsQueue;
+	// If there is only one queue, compute work shares its timeline, so that work on the same queue is never made to wait for work submitted after it
+	_computeTimeline = (computeQueue && computeQueue != graphicsQueue) ? 1 : 0;
+	_timelines[_computeTimeline].queue = computeQueue ? computeQueue : graphicsQueue;
+
+	const char* names[] = { "Graphics", "Compute" };
+	for (uint32_t i = 0; i <= _computeTimeline; ++i)
+	{
+		Timeline& timeline = _timelines[i];
+		pvrvk::SemaphoreCreateInfo semaphoreCreateInfo;
+		timeline.semaphore = device->createTimelineSemaphore(semaphoreCreateInfo);
+		timeline.semaphore->setObjectName(std::string("QueueScheduler") + names[i] + "TimelineSemaphore");
+		timeline.commandPool =
+			device->createCommandPool(pvrvk::CommandPoolCreateInfo(timeline.queue->getFamilyIndex(), pvrvk::CommandPoolCreateFlags::e_RESET_COMMAND_BUFFER_BIT));
+		timeline.commandPool->setObjectName(std::string("QueueScheduler") + names[i] + "CommandPool");
+	}
+
+	Log(LogLevel::Information, "QueueScheduler: Graphics on queue family %u, compute on queue family %u%s", _timelines[0].queue->getFamilyIndex(),
+		_timelines[_computeTimeline].queue->getFamilyIndex(), hasAsyncCompute() ? "" : " (same queue)");
+}
+
+void QueueScheduler::release()
+{
+	if (_timelines[0].semaphore) { waitIdle(); }
+	for (Timeline& timeline : _timelines) { timeline = Timeline(); }
+	_computeTimeline = 0;
+	_bufferStates.clear();
+	_imageStates.clear();
+	_releaseBarriers.clearAllBarriers();
+	_acquireBarriers.clearAllBarriers();
+	_device.reset();
+}
+
+void QueueScheduler::setBufferOwner(const pvrvk::Buffer& buffer, ScheduledQueue queue, pvrvk::PipelineStageFlags stages, pvrvk::AccessFlags access)
+{
+	ResourceState& state = _bufferStates[buffer.get()];
+	state.timeline = getTimelineIndex(queue);
+	state.value = 0;
+	state.stages = stages;
+	state.access = access;
+	state.layout = pvrvk::ImageLayout::e_UNDEFINED;
+}
+
+void QueueScheduler::setImageOwner(const pvrvk::Image& image, ScheduledQueue queue, pvrvk::PipelineStageFlags stages, pvrvk::AccessFlags access, pvrvk::ImageLayout layout)
+{
+	ResourceState& state = _imageStates[image.get()];
+	state.timeline = getTimelineIndex(queue);
+	state.value = 0;
+	state.stages = stages;
+	state.access = access;
+	state.layout = layout;
+}
+
+bool QueueScheduler::needsOwnershipTransfer(uint32_t srcTimeline, uint32_t dstTimeline, pvrvk::SharingMode sharingMode) const
+{
+	return sharingMode == pvrvk::SharingMode::e_EXCLUSIVE && _timelines[srcTimeline].queue->getFamilyIndex() != _timelines[dstTimeline].queue->getFamilyIndex();
+}
+
+QueueScheduler::Batch& QueueScheduler::beginBatch(uint32_t timelineIndex, bool hasWaits)
+{
+	Timeline& timeline = _timelines[timelineIndex];
+	// Work that waits on nothing can be appended to the previous batch, which only delays the point its value is signalled
+	if (!hasWaits && timeline.numBatches && timeline.batches[timeline.numBatches - 1].canMerge) { return timeline.batches[timeline.numBatches - 1]; }
+
+	if (timeline.numBatches == timeline.batches.size()) { timeline.batches.emplace_back(); }
+	Batch& batch = timeline.batches[timeline.numBatches++];
+	batch.clear();
+	// The timeline value is the first signal, and is updated by endBatch as work is merged into the batch
+	batch.signalSemaphores.emplace_back(timeline.semaphore);
+	batch.signalValues.emplace_back(0);
+	return batch;
+}
+
+uint64_t QueueScheduler::endBatch(uint32_t timelineIndex, Batch& batch)
+{
+	batch.signalValues[0] = ++_timelines[timelineIndex].lastScheduledValue;
+	return batch.signalValues[0];
+}
+
+void QueueScheduler::recycleCommandBuffers(Timeline& timeline)
+{
+	if (timeline.inFlightCommandBuffers.empty()) { return; }
+	timeline.completedValue = timeline.semaphore->getCounterValue();
+	while (!timeline.inFlightCommandBuffers.empty() && timeline.inFlightCommandBuffers.front().value <= timeline.completedValue)
+	{
+		timeline.freeCommandBuffers.emplace_back(std::move(timeline.inFlightCommandBuffers.front().commandBuffer));
+		timeline.inFlightCommandBuffers.pop_front();
+	}
+}
+
+pvrvk::CommandBuffer QueueScheduler::recordBarriers(
+	uint32_t timelineIndex, pvrvk::PipelineStageFlags srcStages, pvrvk::PipelineStageFlags dstStages, const pvrvk::MemoryBarrierSet& barriers)
+{
+	Timeline& timeline = _timelines[timelineIndex];
+	if (timeline.freeCommandBuffers.empty()) { recycleCommandBuffers(timeline); }
+
+	pvrvk::CommandBuffer commandBuffer;
+	if (timeline.freeCommandBuffers.empty())
+	{
+		commandBuffer = timeline.commandPool->allocateCommandBuffer();
+		commandBuffer->setObjectName("QueueSchedulerOwnershipTransferCommandBuffer");
+	}
+	else
+	{
+		commandBuffer = std::move(timeline.freeCommandBuffers.back());
+		timeline.freeCommandBuffers.pop_back();
+	}
+
+	// The pool was created with e_RESET_COMMAND_BUFFER_BIT, so begin resets the command buffer
+	commandBuffer->begin(pvrvk::CommandBufferUsageFlags::e_ONE_TIME_SUBMIT_BIT);
+	commandBuffer->pipelineBarrier(srcStages, dstStages, barriers);
+	commandBuffer->end();
+	return commandBuffer;
+}
+
+uint64_t QueueScheduler::schedule(const ScheduledWork& work)
+{
+	if (!_timelines[0].semaphore) { throw InvalidOperationError("QueueScheduler: init must be called before schedule"); }
+	const uint32_t timelineIndex = getTimelineIndex(work.queue);
+	const uint32_t otherTimelineIndex = 1 - timelineIndex;
+	Timeline& timeline = _timelines[timelineIndex];
+	const uint64_t value = timeline.lastScheduledValue + 1;
+
+	// With two queues, every wait is on one of the two timelines, so the waits are folded into the largest value of each
+	uint64_t waitValues[2] = { 0, 0 };
+	pvrvk::PipelineStageFlags waitStages[2] = { pvrvk::PipelineStageFlags(0), pvrvk::PipelineStageFlags(0) };
+	const auto addWait = [&](uint32_t waitTimeline, uint64_t waitValue, pvrvk::PipelineStageFlags stages) {
+		waitValues[waitTimeline] = std::max(waitValues[waitTimeline], waitValue);
+		waitStages[waitTimeline] = waitStages[waitTimeline] | stages;
+	};
+
+	for (uint32_t i = 0; i < work.numWaits; ++i)
+	{
+		const TimelineWait& wait = work.waits[i];
+		const uint32_t waitTimeline = getTimelineIndex(wait.queue);
+		// Waiting for a value that has not been scheduled could wait for work scheduled after this, and deadlock
+		if (wait.value > _timelines[waitTimeline].lastScheduledValue)
+		{ throw InvalidArgumentError("work.waits", "QueueScheduler: Work can only wait for work that was scheduled before it"); }
+		addWait(waitTimeline, wait.value, wait.stages);
+	}
+
+	// Order the work after the last use of its shared resources on the other queue, and transfer their ownership if needed
+	pvrvk::PipelineStageFlags releaseStages = pvrvk::PipelineStageFlags(0);
+	pvrvk::PipelineStageFlags acquireStages = pvrvk::PipelineStageFlags(0);
+	const uint32_t srcFamily = _timelines[otherTimelineIndex].queue ? _timelines[otherTimelineIndex].queue->getFamilyIndex() : 0;
+	const uint32_t dstFamily = timeline.queue->getFamilyIndex();
+	_releaseBarriers.clearAllBarriers();
+	_acquireBarriers.clearAllBarriers();
+
+	for (uint32_t i = 0; i < work.numBufferUses; ++i)
+	{
+		const ScheduledBufferUse& use = work.bufferUses[i];
+		auto it = _bufferStates.find(use.buffer.get());
+		if (it != _bufferStates.end() && it->second.timeline != timelineIndex)
+		{
+			const ResourceState& state = it->second;
+			addWait(state.timeline, state.value, use.stages);
+			if (needsOwnershipTransfer(state.timeline, timelineIndex, use.buffer->getSharingMode()))
+			{
+				const uint32_t size = static_cast<uint32_t>(use.buffer->getSize());
+				_releaseBarriers.addBarrier(pvrvk::BufferMemoryBarrier(state.access, pvrvk::AccessFlags::e_NONE, use.buffer, 0, size, srcFamily, dstFamily));
+				_acquireBarriers.addBarrier(pvrvk::BufferMemoryBarrier(pvrvk::AccessFlags::e_NONE, use.access, use.buffer, 0, size, srcFamily, dstFamily));
+				releaseStages = releaseStages | state.stages;
+				acquireStages = acquireStages | use.stages;
+			}
+		}
+		_bufferStates[use.buffer.get()] = ResourceState{ timelineIndex, value, use.stages, use.access, pvrvk::ImageLayout::e_UNDEFINED };
+	}
+
+	for (uint32_t i = 0; i < work.numImageUses; ++i)
+	{
+		const ScheduledImageUse& use = work.imageUses[i];
+		auto it = _imageStates.find(use.image.get());
+		if (it != _imageStates.end() && it->second.timeline != timelineIndex)
+		{
+			const ResourceState& state = it->second;
+			addWait(state.timeline, state.value, use.stages);
+			if (needsOwnershipTransfer(state.timeline, timelineIndex, use.image->getSharingMode()))
+			{
+				// The release and the acquire must specify the same layouts. The transition happens once, between the two.
+				_releaseBarriers.addBarrier(pvrvk::ImageMemoryBarrier(
+					state.access, pvrvk::AccessFlags::e_NONE, use.image, use.subresourceRange, state.layout, use.layout, srcFamily, dstFamily));
+				_acquireBarriers.addBarrier(
+					pvrvk::ImageMemoryBarrier(pvrvk::AccessFlags::e_NONE, use.access, use.image, use.subresourceRange, state.layout, use.layout, srcFamily, dstFamily));
+				releaseStages = releaseStages | state.stages;
+				acquireStages = acquireStages | use.stages;
+			}
+		}
+		_imageStates[use.image.get()] = ResourceState{ timelineIndex, value, use.stages, use.access, use.layout };
+	}
+
+	pvrvk::CommandBuffer acquireCommandBuffer;
+	if (static_cast<uint32_t>(acquireStages) != 0)
+	{
+		// The release is appended to the work already scheduled on the other queue, and the acquire runs first in this work,
+		// once the release has completed. The acquire barrier starts at the stages the semaphore wait blocks, chaining the two.
+		const pvrvk::CommandBuffer releaseCommandBuffer = recordBarriers(otherTimelineIndex, releaseStages, pvrvk::PipelineStageFlags::e_BOTTOM_OF_PIPE_BIT, _releaseBarriers);
+		Batch& releaseBatch = beginBatch(otherTimelineIndex, false);
+		releaseBatch.commandBuffers.emplace_back(releaseCommandBuffer);
+		const uint64_t releaseValue = endBatch(otherTimelineIndex, releaseBatch);
+		_timelines[otherTimelineIndex].inFlightCommandBuffers.emplace_back(InFlightCommandBuffer{ releaseValue, releaseCommandBuffer });
+
+		addWait(otherTimelineIndex, releaseValue, acquireStages);
+		acquireCommandBuffer = recordBarriers(timelineIndex, acquireStages, acquireStages, _acquireBarriers);
+	}
+
+	// Waits for work that has already completed are dropped, so that more work can be merged into one batch
+	bool hasWaits = work.numWaitSemaphores != 0;
+	for (uint32_t i = 0; i <= _computeTimeline; ++i)
+	{
+		if (waitValues[i] <= _timelines[i].completedValue) { waitValues[i] = 0; }
+		hasWaits = hasWaits || waitValues[i] != 0;
+	}
+
+	Batch& batch = beginBatch(timelineIndex, hasWaits);
+	for (uint32_t i = 0; i <= _computeTimeline; ++i)
+	{
+		if (waitValues[i])
+		{
+			batch.waitSemaphores.emplace_back(_timelines[i].semaphore);
+			batch.waitStages.emplace_back(waitStages[i]);
+			batch.waitValues.emplace_back(waitValues[i]);
+		}
+	}
+	for (uint32_t i = 0; i < work.numWaitSemaphores; ++i)
+	{
+		batch.waitSemaphores.emplace_back(work.waitSemaphores[i]);
+		batch.waitStages.emplace_back(work.waitSemaphoreStages[i]);
+		batch.waitValues.emplace_back(0);
+	}
+
+	if (acquireCommandBuffer)
+	{
+		batch.commandBuffers.emplace_back(acquireCommandBuffer);
+		timeline.inFlightCommandBuffers.emplace_back(InFlightCommandBuffer{ value, acquireCommandBuffer });
+	}
+	batch.commandBuffers.insert(batch.commandBuffers.end(), work.commandBuffers, work.commandBuffers + work.numCommandBuffers);
+
+	for (uint32_t i = 0; i < work.numSignalSemaphores; ++i)
+	{
+		batch.signalSemaphores.emplace_back(work.signalSemaphores[i]);
+		batch.signalValues.emplace_back(0);
+	}
+	// Work merged after a binary semaphore signal would delay it, e.g. delaying the presentation of a frame
+	if (work.numSignalSemaphores) { batch.canMerge = false; }
+
+	const uint64_t scheduledValue = endBatch(timelineIndex, batch);
+	assert(scheduledValue == value);
+	return scheduledValue;
+}
+
+void QueueScheduler::flush()
+{
+	for (uint32_t i = 0; i <= _computeTimeline; ++i)
+	{
+		Timeline& timeline = _timelines[i];
+		if (!timeline.numBatches) { continue; }
+
+		// Resized before taking pointers to the elements
+		_submitInfos.resize(timeline.numBatches);
+		_timelineSubmitInfos.resize(timeline.numBatches);
+		for (uint32_t j = 0; j < timeline.numBatches; ++j)
+		{
+			const Batch& batch = timeline.batches[j];
+			_timelineSubmitInfos[j] = pvrvk::TimelineSemaphoreSubmitInfo(
+				static_cast<uint32_t>(batch.waitValues.size()), batch.waitValues.data(), static_cast<uint32_t>(batch.signalValues.size()), batch.signalValues.data());
+
+			pvrvk::SubmitInfo& submitInfo = _submitInfos[j];
+			submitInfo.waitDstStageMask = batch.waitStages.data();
+			submitInfo.commandBuffers = batch.commandBuffers.data();
+			submitInfo.numCommandBuffers = static_cast<uint32_t>(batch.commandBuffers.size());
+			submitInfo.waitSemaphores = batch.waitSemaphores.data();
+			submitInfo.numWaitSemaphores = static_cast<uint32_t>(batch.waitSemaphores.size());
+			submitInfo.signalSemaphores = batch.signalSemaphores.data();
+			submitInfo.numSignalSemaphores = static_cast<uint32_t>(batch.signalSemaphores.size());
+			submitInfo.timelineSemaphoreSubmitInfo = &_timelineSubmitInfos[j];
+		}
+
+		// Timeline semaphores allow a wait to be submitted before its signal, so the order the queues are submitted in does not matter
+		timeline.queue->submit(_submitInfos.data(), timeline.numBatches);
+		timeline.lastSubmittedValue = timeline.lastScheduledValue;
+
+		// Release the references to the command buffers and semaphores, keeping the capacity of the vectors
+		for (uint32_t j = 0; j < timeline.numBatches; ++j) { timeline.batches[j].clear(); }
+		timeline.numBatches = 0;
+	}
+}
+
+bool QueueScheduler::isComplete(ScheduledQueue queue, uint64_t value)
+{
+	Timeline& timeline = _timelines[getTimelineIndex(queue)];
+	if (value > timeline.completedValue) { timeline.completedValue = timeline.semaphore->getCounterValue(); }
+	return value <= timeline.completedValue;
+}
+
+bool QueueScheduler::wait(ScheduledQueue queue, uint64_t value, uint64_t timeoutNanos)
+{
+	Timeline& timeline = _timelines[getTimelineIndex(queue)];
+	if (value <= timeline.completedValue) { return true; }
+	if (value > timeline.lastSubmittedValue) { throw InvalidOperationError("QueueScheduler: Cannot wait for work that has not been flushed"); }
+	if (!timeline.semaphore->wait(value, timeoutNanos)) { return false; }
+	timeline.completedValue = value;
+	return true;
+}
+
+void QueueScheduler::waitIdle()
+{
+	for (uint32_t i = 0; i <= _computeTimeline; ++i)
+	{
+		Timeline& timeline = _timelines[i];
+		if (timeline.lastSubmittedValue > timeline.completedValue)
+		{
+			timeline.semaphore->wait(timeline.lastSubmittedValue);
+			timeline.completedValue = timeline.lastSubmittedValue;
+		}
+	}
+}
+} // namespace utils
+} // namespace pvr
+//!\endcond
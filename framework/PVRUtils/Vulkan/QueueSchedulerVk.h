@@ -0,0 +1,292 @@
+/*!
+\brief Schedules work on a graphics and a compute queue, ordering it with timeline semaphores so that compute can overlap with rendering.
+\file PVRUtils/Vulkan/QueueSchedulerVk.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRVk/DeviceVk.h"
+#include "PVRVk/QueueVk.h"
+#include "PVRVk/CommandPoolVk.h"
+#include "PVRVk/CommandBufferVk.h"
+#include "PVRVk/TimelineSemaphoreVk.h"
+#include "PVRUtils/Vulkan/HelperVk.h"
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace pvr {
+namespace utils {
+/// <summary>The queues a QueueScheduler submits to</summary>
+enum class ScheduledQueue : uint32_t
+{
+	Graphics, ///< The queue used for rendering and presentation
+	Compute, ///< The queue used for asynchronous compute. May be the graphics queue if the device has no other.
+	Count
+};
+
+/// <summary>A dependency of a work item on another: the work waits until the timeline of a queue reaches a value</summary>
+struct TimelineWait
+{
+	ScheduledQueue queue; //!< The queue whose timeline to wait on
+	uint64_t value; //!< The value returned by QueueScheduler::schedule for the work to wait for
+	pvrvk::PipelineStageFlags stages; //!< The stages of the waiting work that must not start before the value is reached
+
+	/// <summary>Constructor</summary>
+	/// <param name="queue">The queue whose timeline to wait on</param>
+	/// <param name="value">The value returned by QueueScheduler::schedule for the work to wait for</param>
+	/// <param name="stages">The stages of the waiting work that must not start before the value is reached</param>
+	TimelineWait(ScheduledQueue queue = ScheduledQueue::Graphics, uint64_t value = 0, pvrvk::PipelineStageFlags stages = pvrvk::PipelineStageFlags::e_ALL_COMMANDS_BIT)
+		: queue(queue), value(value), stages(stages)
+	{}
+};
+
+/// <summary>A buffer used by a work item, so that the QueueScheduler can order it after the previous use on the other
+/// queue and transfer its ownership between queue families.</summary>
+struct ScheduledBufferUse
+{
+	pvrvk::Buffer buffer; //!< The buffer
+	pvrvk::PipelineStageFlags stages; //!< The stages that access the buffer
+	pvrvk::AccessFlags access; //!< The accesses made to the buffer
+
+	/// <summary>Constructor</summary>
+	/// <param name="buffer">The buffer</param>
+	/// <param name="stages">The stages that access the buffer</param>
+	/// <param name="access">The accesses made to the buffer</param>
+	ScheduledBufferUse(const pvrvk::Buffer& buffer = pvrvk::Buffer(), pvrvk::PipelineStageFlags stages = pvrvk::PipelineStageFlags::e_ALL_COMMANDS_BIT,
+		pvrvk::AccessFlags access = pvrvk::AccessFlags::e_MEMORY_READ_BIT | pvrvk::AccessFlags::e_MEMORY_WRITE_BIT)
+		: buffer(buffer), stages(stages), access(access)
+	{}
+};
+
+/// <summary>An image used by a work item, so that the QueueScheduler can order it after the previous use on the other
+/// queue and transfer its ownership between queue families. When the ownership is transferred, the transfer also
+/// transitions the image from the layout of its previous use to the layout of this one. Otherwise the scheduler does not
+/// change the layout: the image must already be in the given layout at the start of this use.</summary>
+struct ScheduledImageUse
+{
+	pvrvk::Image image; //!< The image
+	pvrvk::ImageSubresourceRange subresourceRange; //!< The part of the image that is used
+	pvrvk::ImageLayout layout; //!< The layout of the image during the work
+	pvrvk::PipelineStageFlags stages; //!< The stages that access the image
+	pvrvk::AccessFlags access; //!< The accesses made to the image
+
+	/// <summary>Constructor</summary>
+	/// <param name="image">The image</param>
+	/// <param name="subresourceRange">The part of the image that is used</param>
+	/// <param name="layout">The layout of the image during the work</param>
+	/// <param name="stages">The stages that access the image</param>
+	/// <param name="access">The accesses made to the image</param>
+	ScheduledImageUse(const pvrvk::Image& image = pvrvk::Image(), const pvrvk::ImageSubresourceRange& subresourceRange = pvrvk::ImageSubresourceRange(),
+		pvrvk::ImageLayout layout = pvrvk::ImageLayout::e_GENERAL, pvrvk::PipelineStageFlags stages = pvrvk::PipelineStageFlags::e_ALL_COMMANDS_BIT,
+		pvrvk::AccessFlags access = pvrvk::AccessFlags::e_MEMORY_READ_BIT | pvrvk::AccessFlags::e_MEMORY_WRITE_BIT)
+		: image(image), subresourceRange(subresourceRange), layout(layout), stages(stages), access(access)
+	{}
+};
+
+/// <summary>A unit of work for a QueueScheduler: command buffers to execute on one queue, what they wait for, and the
+/// resources they share with the other queue. All the arrays are copied by QueueScheduler::schedule.</summary>
+struct ScheduledWork
+{
+	ScheduledQueue queue; //!< The queue to execute the work on
+	const pvrvk::CommandBuffer* commandBuffers; //!< The command buffers to execute, in order
+	uint32_t numCommandBuffers; //!< The number of command buffers
+	const TimelineWait* waits; //!< Previously scheduled work to wait for, on either queue
+	uint32_t numWaits; //!< The number of timeline waits
+	const ScheduledBufferUse* bufferUses; //!< The buffers the work shares with the other queue
+	uint32_t numBufferUses; //!< The number of buffer uses
+	const ScheduledImageUse* imageUses; //!< The images the work shares with the other queue
+	uint32_t numImageUses; //!< The number of image uses
+	const pvrvk::Semaphore* waitSemaphores; //!< Binary semaphores to wait on, e.g. the swapchain image acquisition
+	const pvrvk::PipelineStageFlags* waitSemaphoreStages; //!< The stages waiting on each binary semaphore
+	uint32_t numWaitSemaphores; //!< The number of binary semaphores to wait on
+	const pvrvk::Semaphore* signalSemaphores; //!< Binary semaphores to signal, e.g. to present the swapchain image
+	uint32_t numSignalSemaphores; //!< The number of binary semaphores to signal
+
+	/// <summary>Constructor</summary>
+	/// <param name="queue">The queue to execute the work on</param>
+	/// <param name="commandBuffers">The command buffers to execute, in order</param>
+	/// <param name="numCommandBuffers">The number of command buffers</param>
+	ScheduledWork(ScheduledQueue queue = ScheduledQueue::Graphics, const pvrvk::CommandBuffer* commandBuffers = nullptr, uint32_t numCommandBuffers = 0)
+		: queue(queue), commandBuffers(commandBuffers), numCommandBuffers(numCommandBuffers), waits(nullptr), numWaits(0), bufferUses(nullptr), numBufferUses(0),
+		  imageUses(nullptr), numImageUses(0), waitSemaphores(nullptr), waitSemaphoreStages(nullptr), numWaitSemaphores(0), signalSemaphores(nullptr), numSignalSemaphores(0)
+	{}
+};
+
+/// <summary>Schedules work on the graphics and compute queues returned by createDeviceAndQueues, so that e.g. a particle
+/// simulation can run on the compute queue while the graphics queue renders the previous frame.
+/// Each queue has a timeline semaphore, and schedule() returns the value its timeline reaches when the work completes.
+/// Later work waits for it by listing that value in ScheduledWork::waits; work that declares the buffers and images it
+/// shares with the other queue is additionally ordered after their last use there, and if the queues are from different
+/// families the scheduler records the release and acquire barriers that transfer the ownership of the resources.
+/// Nothing is submitted until flush(), which submits everything scheduled on a queue with a single vkQueueSubmit,
+/// merging consecutive work items that do not wait on anything into one batch.
+/// The device must have been created with the timeline semaphore feature enabled (see the TimelineSemaphores example).
+/// The scheduler is not thread safe.</summary>
+class QueueScheduler
+{
+public:
+	/// <summary>Constructor. Call init() before use.</summary>
+	QueueScheduler() {}
+
+	/// <summary>Destructor. Waits for the scheduled work to complete before releasing the barrier command buffers.</summary>
+	~QueueScheduler() { release(); }
+
+	/// <summary>Get the queue requirements to pass to createDeviceAndQueues: a graphics queue that can present to the
+	/// surface, and a compute queue, which createDeviceAndQueues makes a separate queue whenever the device allows it.</summary>
+	/// <param name="surface">The surface the graphics queue presents to</param>
+	/// <param name="outPopulateInfos">Receives the two QueuePopulateInfo, in ScheduledQueue order</param>
+	static void getQueuePopulateInfos(pvrvk::Surface& surface, std::vector<QueuePopulateInfo>& outPopulateInfos);
+
+	/// <summary>Initialise the scheduler with the queues created by createDeviceAndQueues from getQueuePopulateInfos()</summary>
+	/// <param name="device">The device</param>
+	/// <param name="accessInfos">The two QueueAccessInfo returned by createDeviceAndQueues, in ScheduledQueue order. If the
+	/// compute queue was not found, compute work is scheduled on the graphics queue.</param>
+	void init(const pvrvk::Device& device, const QueueAccessInfo* accessInfos);
+
+	/// <summary>Initialise the scheduler with a graphics and a compute queue. They may be the same queue.</summary>
+	/// <param name="device">The device</param>
+	/// <param name="graphicsQueue">The graphics queue</param>
+	/// <param name="computeQueue">The compute queue</param>
+	void init(const pvrvk::Device& device, const pvrvk::Queue& graphicsQueue, const pvrvk::Queue& computeQueue);
+
+	/// <summary>Wait for all the scheduled work, then release the semaphores and the barrier command buffers. Work that was
+	/// scheduled but not flushed is discarded.</summary>
+	void release();
+
+	/// <summary>Declare that a buffer was last used on a queue outside of the scheduler, e.g. by an upload on the graphics
+	/// queue, so that the first scheduled use on the other queue transfers it. Untracked resources are owned by the queue of
+	/// their first scheduled use.</summary>
+	/// <param name="buffer">The buffer</param>
+	/// <param name="queue">The queue that last used the buffer</param>
+	/// <param name="stages">The stages that last accessed the buffer</param>
+	/// <param name="access">The last accesses made to the buffer</param>
+	void setBufferOwner(const pvrvk::Buffer& buffer, ScheduledQueue queue, pvrvk::PipelineStageFlags stages, pvrvk::AccessFlags access);
+
+	/// <summary>Declare that an image was last used on a queue outside of the scheduler. See setBufferOwner.</summary>
+	/// <param name="image">The image</param>
+	/// <param name="queue">The queue that last used the image</param>
+	/// <param name="stages">The stages that last accessed the image</param>
+	/// <param name="access">The last accesses made to the image</param>
+	/// <param name="layout">The layout the image was left in by its last use</param>
+	void setImageOwner(const pvrvk::Image& image, ScheduledQueue queue, pvrvk::PipelineStageFlags stages, pvrvk::AccessFlags access, pvrvk::ImageLayout layout);
+
+	/// <summary>Stop tracking a buffer, e.g. before it is destroyed</summary>
+	/// <param name="buffer">The buffer</param>
+	void untrackBuffer(const pvrvk::Buffer& buffer) { _bufferStates.erase(buffer.get()); }
+
+	/// <summary>Stop tracking an image, e.g. before it is destroyed</summary>
+	/// <param name="image">The image</param>
+	void untrackImage(const pvrvk::Image& image) { _imageStates.erase(image.get()); }
+
+	/// <summary>Schedule work on a queue. It is submitted by the next flush().</summary>
+	/// <param name="work">The work</param>
+	/// <returns>The value the timeline of work.queue reaches when the work has completed</returns>
+	uint64_t schedule(const ScheduledWork& work);
+
+	/// <summary>Submit all the scheduled work, with one vkQueueSubmit per queue</summary>
+	void flush();
+
+	/// <summary>Check whether scheduled work has completed, without waiting</summary>
+	/// <param name="queue">The queue of the work</param>
+	/// <param name="value">The value returned by schedule</param>
+	/// <returns>True if the work has completed</returns>
+	bool isComplete(ScheduledQueue queue, uint64_t value);
+
+	/// <summary>Wait on the host for scheduled work to complete. The work must have been flushed.</summary>
+	/// <param name="queue">The queue of the work</param>
+	/// <param name="value">The value returned by schedule</param>
+	/// <param name="timeoutNanos">The maximum time to wait</param>
+	/// <returns>True if the work has completed, false if the wait timed out</returns>
+	bool wait(ScheduledQueue queue, uint64_t value, uint64_t timeoutNanos = static_cast<uint64_t>(-1));
+
+	/// <summary>Wait on the host for all the flushed work to complete</summary>
+	void waitIdle();
+
+	/// <summary>Get one of the queues</summary>
+	/// <param name="queue">The queue</param>
+	/// <returns>The queue. Both queues are the same if the device has only one suitable queue.</returns>
+	const pvrvk::Queue& getQueue(ScheduledQueue queue) const { return _timelines[getTimelineIndex(queue)].queue; }
+
+	/// <summary>Get the timeline semaphore of a queue, to wait on or signal it outside of the scheduler</summary>
+	/// <param name="queue">The queue</param>
+	/// <returns>The timeline semaphore</returns>
+	const pvrvk::TimelineSemaphore& getTimelineSemaphore(ScheduledQueue queue) const { return _timelines[getTimelineIndex(queue)].semaphore; }
+
+	/// <summary>Get the value of the last work scheduled on a queue</summary>
+	/// <param name="queue">The queue</param>
+	/// <returns>The value the timeline of the queue reaches when all the work scheduled so far has completed</returns>
+	uint64_t getLastScheduledValue(ScheduledQueue queue) const { return _timelines[getTimelineIndex(queue)].lastScheduledValue; }
+
+	/// <summary>Check whether compute work runs on its own queue, and so can overlap with rendering</summary>
+	/// <returns>True if the graphics and compute queues are different queues</returns>
+	bool hasAsyncCompute() const { return _computeTimeline != 0; }
+
+private:
+	// The submission being built for one batch of work on a timeline. The vectors keep their capacity between flushes.
+	struct Batch
+	{
+		std::vector<pvrvk::CommandBuffer> commandBuffers;
+		std::vector<pvrvk::Semaphore> waitSemaphores;
+		std::vector<pvrvk::PipelineStageFlags> waitStages;
+		std::vector<uint64_t> waitValues; // Zero for binary semaphores
+		std::vector<pvrvk::Semaphore> signalSemaphores;
+		std::vector<uint64_t> signalValues; // The timeline value is always first
+		bool canMerge; // Whether following work without waits may be appended to this batch
+
+		void clear();
+	};
+
+	struct InFlightCommandBuffer
+	{
+		uint64_t value;
+		pvrvk::CommandBuffer commandBuffer;
+	};
+
+	// A queue, with its timeline semaphore, barrier command buffers and the batches scheduled since the last flush.
+	struct Timeline
+	{
+		pvrvk::Queue queue;
+		pvrvk::TimelineSemaphore semaphore;
+		pvrvk::CommandPool commandPool;
+		uint64_t lastScheduledValue;
+		uint64_t lastSubmittedValue;
+		uint64_t completedValue; // Cached counter value of the semaphore
+		std::vector<Batch> batches;
+		uint32_t numBatches;
+		std::vector<pvrvk::CommandBuffer> freeCommandBuffers;
+		std::deque<InFlightCommandBuffer> inFlightCommandBuffers; // In increasing order of value
+
+		Timeline() : lastScheduledValue(0), lastSubmittedValue(0), completedValue(0), numBatches(0) {}
+	};
+
+	// The last use of a tracked resource
+	struct ResourceState
+	{
+		uint32_t timeline;
+		uint64_t value; // The value of the timeline when the last use completes, or 0 for a use outside the scheduler
+		pvrvk::PipelineStageFlags stages;
+		pvrvk::AccessFlags access;
+		pvrvk::ImageLayout layout; // The layout an image was left in by the last use. Unused for buffers.
+	};
+
+	uint32_t getTimelineIndex(ScheduledQueue queue) const { return queue == ScheduledQueue::Compute ? _computeTimeline : 0; }
+	Batch& beginBatch(uint32_t timelineIndex, bool hasWaits);
+	uint64_t endBatch(uint32_t timelineIndex, Batch& batch);
+	pvrvk::CommandBuffer recordBarriers(uint32_t timelineIndex, pvrvk::PipelineStageFlags srcStages, pvrvk::PipelineStageFlags dstStages, const pvrvk::MemoryBarrierSet& barriers);
+	void recycleCommandBuffers(Timeline& timeline);
+	bool needsOwnershipTransfer(uint32_t srcTimeline, uint32_t dstTimeline, pvrvk::SharingMode sharingMode) const;
+
+	pvrvk::DeviceWeakPtr _device;
+	Timeline _timelines[static_cast<uint32_t>(ScheduledQueue::Count)];
+	uint32_t _computeTimeline = 0; // The index of the timeline compute work goes to: 0 if it shares the graphics queue
+	std::unordered_map<const void*, ResourceState> _bufferStates;
+	std::unordered_map<const void*, ResourceState> _imageStates;
+	// Scratch space, kept between calls to avoid allocations
+	pvrvk::MemoryBarrierSet _releaseBarriers;
+	pvrvk::MemoryBarrierSet _acquireBarriers;
+	std::vector<pvrvk::SubmitInfo> _submitInfos;
+	std::vector<pvrvk::TimelineSemaphoreSubmitInfo> _timelineSubmitInfos;
+};
+} // namespace utils
+} // namespace pvr
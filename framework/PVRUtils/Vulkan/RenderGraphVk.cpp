@@ -0,0 +1,1001 @@
+/*!
+\brief Implementation of the Vulkan render graph.
+\file PVRUtils/Vulkan/RenderGraphVk.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/Vulkan/RenderGraphVk.h"
+#include "PVRUtils/Vulkan/HelperVk.h"
+#include "PVRCore/Log.h"
+#include <algorithm>
+#include <map>
+
+namespace pvr {
+namespace utils {
+namespace {
+const uint32_t Invalid = static_cast<uint32_t>(-1);
+const uint32_t MaxFramebufferAttachments = pvrvk::FrameworkCaps::MaxColorAttachments + pvrvk::FrameworkCaps::MaxDepthStencilAttachments;
+
+const pvrvk::AccessFlags WriteAccessMask = pvrvk::AccessFlags::e_COLOR_ATTACHMENT_WRITE_BIT | pvrvk::AccessFlags::e_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+	pvrvk::AccessFlags::e_SHADER_WRITE_BIT | pvrvk::AccessFlags::e_TRANSFER_WRITE_BIT | pvrvk::AccessFlags::e_MEMORY_WRITE_BIT;
+
+bool hasStencil(pvrvk::Format format)
+{
+	return format == pvrvk::Format::e_S8_UINT || format == pvrvk::Format::e_D16_UNORM_S8_UINT || format == pvrvk::Format::e_D24_UNORM_S8_UINT ||
+		format == pvrvk::Format::e_D32_SFLOAT_S8_UINT;
+}
+
+// Whether any memory type allowed by a set of memory type bits is device local.
+bool hasDeviceLocalMemoryType(const pvrvk::PhysicalDevice& physicalDevice, uint32_t memoryTypeBits)
+{
+	const pvrvk::PhysicalDeviceMemoryProperties& properties = physicalDevice->getMemoryProperties();
+	for (uint32_t i = 0; i < properties.getMemoryTypeCount(); ++i)
+	{
+		if ((memoryTypeBits & (1u << i)) && (properties.getMemoryTypes()[i].getPropertyFlags() & pvrvk::MemoryPropertyFlags::e_DEVICE_LOCAL_BIT) != 0) { return true; }
+	}
+	return false;
+}
+
+// The scope a dependency must cover for an output left in a given layout.
+void getOutputScope(pvrvk::ImageLayout layout, pvrvk::PipelineStageFlags& outStages, pvrvk::AccessFlags& outAccess)
+{
+	if (layout == pvrvk::ImageLayout::e_PRESENT_SRC_KHR)
+	{
+		outStages = pvrvk::PipelineStageFlags::e_BOTTOM_OF_PIPE_BIT;
+		outAccess = pvrvk::AccessFlags::e_NONE;
+	}
+	else if (layout == pvrvk::ImageLayout::e_SHADER_READ_ONLY_OPTIMAL)
+	{
+		outStages = pvrvk::PipelineStageFlags::e_FRAGMENT_SHADER_BIT | pvrvk::PipelineStageFlags::e_COMPUTE_SHADER_BIT;
+		outAccess = pvrvk::AccessFlags::e_SHADER_READ_BIT;
+	}
+	else
+	{
+		outStages = pvrvk::PipelineStageFlags::e_ALL_COMMANDS_BIT;
+		outAccess = pvrvk::AccessFlags::e_MEMORY_READ_BIT | pvrvk::AccessFlags::e_MEMORY_WRITE_BIT;
+	}
+}
+} // namespace
+
+RenderGraphPass& RenderGraphPass::addUse(const std::string& name, Access access, pvrvk::AttachmentLoadOp loadOp, const pvrvk::ClearValue& clearValue)
+{
+	ResourceUse use;
+	use.name = name;
+	use.resource = Invalid;
+	use.access = access;
+	use.loadOp = loadOp;
+	use.clearValue = clearValue;
+	_uses.emplace_back(use);
+	return *this;
+}
+
+RenderGraphPass& RenderGraphPass::addColorOutput(const std::string& name, pvrvk::AttachmentLoadOp loadOp, const pvrvk::ClearValue& clearValue)
+{
+	return addUse(name, Access::ColorAttachment, loadOp, clearValue);
+}
+
+RenderGraphPass& RenderGraphPass::setDepthStencilOutput(const std::string& name, pvrvk::AttachmentLoadOp loadOp, const pvrvk::ClearValue& clearValue)
+{
+	return addUse(name, Access::DepthStencilAttachment, loadOp, clearValue);
+}
+
+RenderGraphPass& RenderGraphPass::setDepthStencilInput(const std::string& name)
+{
+	return addUse(name, Access::DepthStencilReadOnly, pvrvk::AttachmentLoadOp::e_LOAD, pvrvk::ClearValue());
+}
+
+RenderGraphPass& RenderGraphPass::addInputAttachment(const std::string& name)
+{
+	return addUse(name, Access::InputAttachment, pvrvk::AttachmentLoadOp::e_LOAD, pvrvk::ClearValue());
+}
+
+RenderGraphPass& RenderGraphPass::addTextureInput(const std::string& name) { return addUse(name, Access::Texture, pvrvk::AttachmentLoadOp::e_LOAD, pvrvk::ClearValue()); }
+
+RenderGraphPass& RenderGraphPass::addStorageInput(const std::string& name)
+{
+	return addUse(name, Access::StorageRead, pvrvk::AttachmentLoadOp::e_LOAD, pvrvk::ClearValue());
+}
+
+RenderGraphPass& RenderGraphPass::addStorageOutput(const std::string& name)
+{
+	return addUse(name, Access::StorageWrite, pvrvk::AttachmentLoadOp::e_DONT_CARE, pvrvk::ClearValue());
+}
+
+bool RenderGraph::isAttachment(const RenderGraphPass::ResourceUse& use)
+{
+	return use.access == RenderGraphPass::Access::ColorAttachment || use.access == RenderGraphPass::Access::DepthStencilAttachment ||
+		use.access == RenderGraphPass::Access::DepthStencilReadOnly || use.access == RenderGraphPass::Access::InputAttachment;
+}
+
+bool RenderGraph::isWrite(const RenderGraphPass::ResourceUse& use)
+{
+	return use.access == RenderGraphPass::Access::ColorAttachment || use.access == RenderGraphPass::Access::DepthStencilAttachment ||
+		use.access == RenderGraphPass::Access::StorageWrite;
+}
+
+bool RenderGraph::readsPreviousContents(const RenderGraphPass::ResourceUse& use)
+{
+	if (use.access == RenderGraphPass::Access::StorageWrite) { return false; }
+	return !isWrite(use) || use.loadOp == pvrvk::AttachmentLoadOp::e_LOAD;
+}
+
+RenderGraph::UseInfo RenderGraph::getUseInfo(const RenderGraphPass::ResourceUse& use, RenderGraphPassType passType) const
+{
+	const bool isDepthStencil = isFormatDepthStencil(_resources[use.resource].description.format);
+	const pvrvk::PipelineStageFlags shaderStages =
+		passType == RenderGraphPassType::Graphics ? pvrvk::PipelineStageFlags::e_FRAGMENT_SHADER_BIT : pvrvk::PipelineStageFlags::e_COMPUTE_SHADER_BIT;
+	const pvrvk::PipelineStageFlags depthStages = pvrvk::PipelineStageFlags::e_EARLY_FRAGMENT_TESTS_BIT | pvrvk::PipelineStageFlags::e_LATE_FRAGMENT_TESTS_BIT;
+
+	UseInfo info;
+	info.isWrite = isWrite(use);
+	switch (use.access)
+	{
+	case RenderGraphPass::Access::ColorAttachment:
+		info.layout = pvrvk::ImageLayout::e_COLOR_ATTACHMENT_OPTIMAL;
+		info.stages = pvrvk::PipelineStageFlags::e_COLOR_ATTACHMENT_OUTPUT_BIT;
+		info.access = pvrvk::AccessFlags::e_COLOR_ATTACHMENT_WRITE_BIT | pvrvk::AccessFlags::e_COLOR_ATTACHMENT_READ_BIT;
+		break;
+	case RenderGraphPass::Access::DepthStencilAttachment:
+		info.layout = pvrvk::ImageLayout::e_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		info.stages = depthStages;
+		info.access = pvrvk::AccessFlags::e_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | pvrvk::AccessFlags::e_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+		break;
+	case RenderGraphPass::Access::DepthStencilReadOnly:
+		info.layout = pvrvk::ImageLayout::e_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		info.stages = depthStages;
+		info.access = pvrvk::AccessFlags::e_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+		break;
+	case RenderGraphPass::Access::InputAttachment:
+		info.layout = isDepthStencil ? pvrvk::ImageLayout::e_DEPTH_STENCIL_READ_ONLY_OPTIMAL : pvrvk::ImageLayout::e_SHADER_READ_ONLY_OPTIMAL;
+		info.stages = pvrvk::PipelineStageFlags::e_FRAGMENT_SHADER_BIT;
+		info.access = pvrvk::AccessFlags::e_INPUT_ATTACHMENT_READ_BIT;
+		break;
+	case RenderGraphPass::Access::Texture:
+		info.layout = isDepthStencil ? pvrvk::ImageLayout::e_DEPTH_STENCIL_READ_ONLY_OPTIMAL : pvrvk::ImageLayout::e_SHADER_READ_ONLY_OPTIMAL;
+		info.stages = shaderStages;
+		info.access = pvrvk::AccessFlags::e_SHADER_READ_BIT;
+		break;
+	case RenderGraphPass::Access::StorageRead:
+		info.layout = pvrvk::ImageLayout::e_GENERAL;
+		info.stages = shaderStages;
+		info.access = pvrvk::AccessFlags::e_SHADER_READ_BIT;
+		break;
+	case RenderGraphPass::Access::StorageWrite:
+		info.layout = pvrvk::ImageLayout::e_GENERAL;
+		info.stages = shaderStages;
+		info.access = pvrvk::AccessFlags::e_SHADER_WRITE_BIT;
+		break;
+	}
+	return info;
+}
+
+// A use needs a dependency if it changes the layout, reads the result of a write that has not been made visible to it
+// yet, or writes before earlier accesses are known to be complete.
+bool RenderGraph::needsDependency(const ResourceState& state, const UseInfo& use)
+{
+	if (state.layout != use.layout) { return true; }
+	if (use.isWrite) { return state.stages != 0 && (use.stages & ~state.writeReadyStages) != 0; }
+	return state.writeAccess != 0 && ((use.stages & ~state.readyStages) != 0 || (use.access & ~state.readyAccess) != 0);
+}
+
+void RenderGraph::applyUse(ResourceState& state, const UseInfo& use, bool dependencyAdded)
+{
+	if (dependencyAdded)
+	{
+		state.stages = use.stages;
+		state.readyStages = use.stages;
+		state.readyAccess = use.access;
+	}
+	else
+	{
+		state.stages |= use.stages;
+	}
+	// Whatever this use is, a later write must wait for it.
+	state.writeReadyStages = pvrvk::PipelineStageFlags(0);
+	if (use.isWrite)
+	{
+		state.writeAccess = use.access & WriteAccessMask;
+		state.readyStages = pvrvk::PipelineStageFlags(0);
+		state.readyAccess = pvrvk::AccessFlags::e_NONE;
+	}
+	state.layout = use.layout;
+}
+
+void RenderGraph::setDimensions(const pvrvk::Extent2D& extent, uint32_t numInstances)
+{
+	if (_compiled) { throw InvalidOperationError("RenderGraph: Cannot modify a compiled graph"); }
+	if (numInstances == 0) { throw InvalidArgumentError("numInstances", "RenderGraph: The number of instances must be at least 1"); }
+	_extent = extent;
+	_numInstances = numInstances;
+}
+
+uint32_t RenderGraph::addResource(const std::string& name)
+{
+	if (_compiled) { throw InvalidOperationError("RenderGraph: Cannot modify a compiled graph"); }
+	if (findResource(name) != Invalid) { throw InvalidArgumentError("name", "RenderGraph: An image named [" + name + "] already exists"); }
+	Resource resource;
+	resource.name = name;
+	resource.isImported = false;
+	resource.isOutput = false;
+	resource.initialLayout = pvrvk::ImageLayout::e_UNDEFINED;
+	resource.finalLayout = pvrvk::ImageLayout::e_UNDEFINED;
+	_resources.emplace_back(resource);
+	return static_cast<uint32_t>(_resources.size() - 1);
+}
+
+void RenderGraph::addImage(const std::string& name, const RenderGraphImageDescription& description)
+{
+	if (description.format == pvrvk::Format::e_UNDEFINED) { throw InvalidArgumentError("description", "RenderGraph: The format of image [" + name + "] is undefined"); }
+	_resources[addResource(name)].description = description;
+}
+
+void RenderGraph::importSwapchain(const std::string& name, const pvrvk::Swapchain& swapchain)
+{
+	std::vector<pvrvk::ImageView> views;
+	for (uint32_t i = 0; i < swapchain->getSwapchainLength(); ++i) { views.emplace_back(swapchain->getImageView(i)); }
+	if (_numInstances == 0) { setDimensions(swapchain->getDimension(), swapchain->getSwapchainLength()); }
+	importImage(name, views, pvrvk::ImageLayout::e_UNDEFINED, pvrvk::ImageLayout::e_PRESENT_SRC_KHR);
+}
+
+void RenderGraph::importImage(const std::string& name, const std::vector<pvrvk::ImageView>& imageViews, pvrvk::ImageLayout initialLayout, pvrvk::ImageLayout finalLayout)
+{
+	if (imageViews.empty() || !imageViews[0]) { throw InvalidArgumentError("imageViews", "RenderGraph: No image views imported for [" + name + "]"); }
+	Resource& resource = _resources[addResource(name)];
+	const pvrvk::Image& image = imageViews[0]->getImage();
+	resource.description = RenderGraphImageDescription(
+		imageViews[0]->getFormat(), pvrvk::Extent2D(image->getExtent().getWidth(), image->getExtent().getHeight()), image->getNumSamples());
+	resource.isImported = true;
+	resource.isOutput = true;
+	resource.initialLayout = initialLayout;
+	resource.finalLayout = finalLayout;
+	resource.views = imageViews;
+}
+
+void RenderGraph::setOutput(const std::string& name, pvrvk::ImageLayout finalLayout)
+{
+	if (_compiled) { throw InvalidOperationError("RenderGraph: Cannot modify a compiled graph"); }
+	const uint32_t index = findResource(name);
+	if (index == Invalid) { throw InvalidArgumentError("name", "RenderGraph: No image named [" + name + "]"); }
+	_resources[index].isOutput = true;
+	_resources[index].finalLayout = finalLayout;
+}
+
+RenderGraphPass& RenderGraph::addPass(const std::string& name, RenderGraphPassType type)
+{
+	if (_compiled) { throw InvalidOperationError("RenderGraph: Cannot modify a compiled graph"); }
+	if (findPass(name) != Invalid) { throw InvalidArgumentError("name", "RenderGraph: A pass named [" + name + "] already exists"); }
+	_passes.emplace_back(new RenderGraphPass(name, type));
+	return *_passes.back();
+}
+
+uint32_t RenderGraph::findResource(const std::string& name) const
+{
+	for (uint32_t i = 0; i < _resources.size(); ++i)
+	{
+		if (_resources[i].name == name) { return i; }
+	}
+	return Invalid;
+}
+
+uint32_t RenderGraph::findPass(const std::string& name) const
+{
+	for (uint32_t i = 0; i < _passes.size(); ++i)
+	{
+		if (_passes[i]->getName() == name) { return i; }
+	}
+	return Invalid;
+}
+
+pvrvk::Extent2D RenderGraph::getResourceExtent(uint32_t resource) const
+{
+	const pvrvk::Extent2D& extent = _resources[resource].description.extent;
+	return (extent.getWidth() == 0 || extent.getHeight() == 0) ? _extent : extent;
+}
+
+void RenderGraph::resolveUses()
+{
+	for (auto& pass : _passes)
+	{
+		uint32_t numColor = 0, numDepth = 0, numInput = 0;
+		pvrvk::Extent2D extent(0, 0);
+		pvrvk::SampleCountFlags samples = pvrvk::SampleCountFlags::e_1_BIT;
+		bool hasAttachments = false;
+		for (auto& use : pass->_uses)
+		{
+			use.resource = findResource(use.name);
+			if (use.resource == Invalid) { throw InvalidOperationError("RenderGraph: Pass [" + pass->getName() + "] uses the undeclared image [" + use.name + "]"); }
+			if (!isAttachment(use)) { continue; }
+
+			if (pass->getType() != RenderGraphPassType::Graphics)
+			{ throw InvalidOperationError("RenderGraph: Compute pass [" + pass->getName() + "] cannot use [" + use.name + "] as an attachment"); }
+			numColor += use.access == RenderGraphPass::Access::ColorAttachment;
+			numDepth += use.access == RenderGraphPass::Access::DepthStencilAttachment || use.access == RenderGraphPass::Access::DepthStencilReadOnly;
+			numInput += use.access == RenderGraphPass::Access::InputAttachment;
+
+			const pvrvk::Extent2D useExtent = getResourceExtent(use.resource);
+			if (!hasAttachments)
+			{
+				extent = useExtent;
+				samples = _resources[use.resource].description.sampleCount;
+				hasAttachments = true;
+			}
+			else if (extent.getWidth() != useExtent.getWidth() || extent.getHeight() != useExtent.getHeight() || samples != _resources[use.resource].description.sampleCount)
+			{
+				throw InvalidOperationError("RenderGraph: The attachments of pass [" + pass->getName() + "] differ in size or sample count");
+			}
+		}
+		if (numColor > pvrvk::FrameworkCaps::MaxColorAttachments || numDepth > 1 || numInput > pvrvk::FrameworkCaps::MaxInputAttachments)
+		{ throw InvalidOperationError("RenderGraph: Pass [" + pass->getName() + "] uses too many attachments"); }
+		if (pass->getType() == RenderGraphPassType::Graphics && numColor + numDepth == 0)
+		{ throw InvalidOperationError("RenderGraph: Graphics pass [" + pass->getName() + "] has no color or depth stencil attachment"); }
+		if (hasAttachments && (extent.getWidth() == 0 || extent.getHeight() == 0))
+		{ throw InvalidOperationError("RenderGraph: Pass [" + pass->getName() + "] uses an image sized to the graph, but the graph has no dimensions"); }
+
+		// A pass may use the same image in several ways only if they agree on its layout (e.g. depth testing and sampling it)
+		for (size_t i = 0; i < pass->_uses.size(); ++i)
+		{
+			for (size_t j = i + 1; j < pass->_uses.size(); ++j)
+			{
+				if (pass->_uses[i].resource == pass->_uses[j].resource &&
+					getUseInfo(pass->_uses[i], pass->getType()).layout != getUseInfo(pass->_uses[j], pass->getType()).layout)
+				{ throw InvalidOperationError("RenderGraph: Pass [" + pass->getName() + "] uses [" + pass->_uses[i].name + "] in incompatible ways"); }
+			}
+		}
+	}
+}
+
+// Walk the passes backwards from the outputs of the graph, keeping the passes that write contents a kept pass or an
+// output will read. A write that does not load ends the interest in the previous contents of an image.
+void RenderGraph::cullPasses()
+{
+	_passCulled.assign(_passes.size(), true);
+	std::vector<bool> needed(_resources.size());
+	for (size_t i = 0; i < _resources.size(); ++i) { needed[i] = _resources[i].isOutput; }
+
+	for (size_t p = _passes.size(); p-- > 0;)
+	{
+		const RenderGraphPass& pass = *_passes[p];
+		bool keep = pass._hasSideEffects;
+		for (const auto& use : pass._uses) { keep = keep || (isWrite(use) && needed[use.resource]); }
+		if (!keep) { continue; }
+
+		_passCulled[p] = false;
+		for (const auto& use : pass._uses)
+		{
+			if (isWrite(use) && !readsPreviousContents(use)) { needed[use.resource] = false; }
+		}
+		for (const auto& use : pass._uses)
+		{
+			if (readsPreviousContents(use)) { needed[use.resource] = true; }
+		}
+	}
+}
+
+bool RenderGraph::canMerge(const PhysicalPass& physicalPass, uint32_t passIndex) const
+{
+	const RenderGraphPass& pass = *_passes[passIndex];
+	if (!physicalPass.isRenderPass || pass.getType() != RenderGraphPassType::Graphics) { return false; }
+
+	std::vector<uint32_t> attachments = physicalPass.attachments;
+	for (const auto& use : pass._uses)
+	{
+		if (isAttachment(use))
+		{
+			const pvrvk::Extent2D extent = getResourceExtent(use.resource);
+			if (extent.getWidth() != physicalPass.extent.getWidth() || extent.getHeight() != physicalPass.extent.getHeight() ||
+				_resources[use.resource].description.sampleCount != physicalPass.sampleCount)
+			{ return false; }
+			// The render pass applies the load operation and clear value of the first use of each attachment only, so a later
+			// pass that clears or discards an attachment already used by the render pass must start a new one.
+			if (use.loadOp != pvrvk::AttachmentLoadOp::e_LOAD &&
+				std::find(physicalPass.attachments.begin(), physicalPass.attachments.end(), use.resource) != physicalPass.attachments.end())
+			{ return false; }
+			if (std::find(attachments.begin(), attachments.end(), use.resource) == attachments.end()) { attachments.emplace_back(use.resource); }
+		}
+		// Reads and writes outside of the attachments need the whole image, so they cannot share a render pass with
+		// another use of that image.
+		for (uint32_t other : physicalPass.passes)
+		{
+			for (const auto& otherUse : _passes[other]->_uses)
+			{
+				if (otherUse.resource == use.resource && (!isAttachment(use) || !isAttachment(otherUse))) { return false; }
+			}
+		}
+	}
+	return attachments.size() <= MaxFramebufferAttachments;
+}
+
+void RenderGraph::mergePasses()
+{
+	_physicalPasses.clear();
+	_passPhysicalPass.assign(_passes.size(), Invalid);
+	_passSubpass.assign(_passes.size(), 0);
+	for (uint32_t p = 0; p < _passes.size(); ++p)
+	{
+		if (_passCulled[p]) { continue; }
+		const RenderGraphPass& pass = *_passes[p];
+
+		if (_physicalPasses.empty() || !canMerge(_physicalPasses.back(), p))
+		{
+			_physicalPasses.emplace_back();
+			PhysicalPass& physicalPass = _physicalPasses.back();
+			physicalPass.isRenderPass = pass.getType() == RenderGraphPassType::Graphics;
+			physicalPass.extent = pvrvk::Extent2D(0, 0);
+			physicalPass.sampleCount = pvrvk::SampleCountFlags::e_1_BIT;
+			for (const auto& use : pass._uses)
+			{
+				if (isAttachment(use))
+				{
+					physicalPass.extent = getResourceExtent(use.resource);
+					physicalPass.sampleCount = _resources[use.resource].description.sampleCount;
+					break;
+				}
+			}
+		}
+		PhysicalPass& physicalPass = _physicalPasses.back();
+		_passPhysicalPass[p] = static_cast<uint32_t>(_physicalPasses.size() - 1);
+		_passSubpass[p] = static_cast<uint32_t>(physicalPass.passes.size());
+		physicalPass.passes.emplace_back(p);
+		for (const auto& use : pass._uses)
+		{
+			if (isAttachment(use) && std::find(physicalPass.attachments.begin(), physicalPass.attachments.end(), use.resource) == physicalPass.attachments.end())
+			{
+				physicalPass.attachments.emplace_back(use.resource);
+				physicalPass.clearValues.emplace_back(use.clearValue);
+			}
+		}
+	}
+}
+
+void RenderGraph::computeLifetimes()
+{
+	for (auto& resource : _resources)
+	{
+		resource.usage = resource.description.additionalUsage;
+		resource.firstPhysicalPass = Invalid;
+		resource.lastPhysicalPass = Invalid;
+		resource.isTransient = false;
+		resource.memorySlot = Invalid;
+		resource.aliasPredecessor = Invalid;
+		resource.state = ResourceState();
+		resource.state.layout = resource.initialLayout;
+	}
+
+	for (uint32_t pp = 0; pp < _physicalPasses.size(); ++pp)
+	{
+		for (uint32_t p : _physicalPasses[pp].passes)
+		{
+			for (const auto& use : _passes[p]->_uses)
+			{
+				Resource& resource = _resources[use.resource];
+				if (resource.firstPhysicalPass == Invalid) { resource.firstPhysicalPass = pp; }
+				resource.lastPhysicalPass = pp;
+				switch (use.access)
+				{
+				case RenderGraphPass::Access::ColorAttachment: resource.usage |= pvrvk::ImageUsageFlags::e_COLOR_ATTACHMENT_BIT; break;
+				case RenderGraphPass::Access::DepthStencilAttachment:
+				case RenderGraphPass::Access::DepthStencilReadOnly: resource.usage |= pvrvk::ImageUsageFlags::e_DEPTH_STENCIL_ATTACHMENT_BIT; break;
+				case RenderGraphPass::Access::InputAttachment: resource.usage |= pvrvk::ImageUsageFlags::e_INPUT_ATTACHMENT_BIT; break;
+				case RenderGraphPass::Access::Texture: resource.usage |= pvrvk::ImageUsageFlags::e_SAMPLED_BIT; break;
+				case RenderGraphPass::Access::StorageRead:
+				case RenderGraphPass::Access::StorageWrite: resource.usage |= pvrvk::ImageUsageFlags::e_STORAGE_BIT; break;
+				}
+			}
+		}
+	}
+
+	// An image only ever used as an attachment of one render pass never needs to leave the tile memory.
+	const pvrvk::ImageUsageFlags transientUsage =
+		pvrvk::ImageUsageFlags::e_COLOR_ATTACHMENT_BIT | pvrvk::ImageUsageFlags::e_DEPTH_STENCIL_ATTACHMENT_BIT | pvrvk::ImageUsageFlags::e_INPUT_ATTACHMENT_BIT;
+	for (auto& resource : _resources)
+	{
+		resource.isTransient = !resource.isImported && !resource.isOutput && resource.firstPhysicalPass != Invalid &&
+			resource.firstPhysicalPass == resource.lastPhysicalPass && _physicalPasses[resource.firstPhysicalPass].isRenderPass && (resource.usage & ~transientUsage) == 0;
+		if (resource.isTransient) { resource.usage |= pvrvk::ImageUsageFlags::e_TRANSIENT_ATTACHMENT_BIT; }
+	}
+}
+
+void RenderGraph::createImages(pvrvk::Device& device)
+{
+	const pvrvk::PhysicalDevice physicalDevice = device->getPhysicalDevice();
+	std::vector<std::vector<pvrvk::Image>> images(_resources.size());
+	std::vector<uint32_t> aliased;
+
+	for (uint32_t r = 0; r < _resources.size(); ++r)
+	{
+		Resource& resource = _resources[r];
+		if (resource.isImported) { continue; }
+		resource.views.clear();
+		if (resource.firstPhysicalPass == Invalid)
+		{
+			Log(LogLevel::Debug, "RenderGraph: Image [%s] is not used by any pass that was kept, and will not be created", resource.name.c_str());
+			continue;
+		}
+
+		const pvrvk::Extent2D extent = getResourceExtent(r);
+		const pvrvk::ImageCreateInfo createInfo(pvrvk::ImageType::e_2D, resource.description.format, pvrvk::Extent3D(extent.getWidth(), extent.getHeight(), 1u),
+			resource.usage, 1, 1, resource.description.sampleCount);
+		images[r].resize(_numInstances);
+		for (uint32_t i = 0; i < _numInstances; ++i)
+		{
+			if (resource.isTransient)
+			{
+				images[r][i] = createImage(device, createInfo, pvrvk::MemoryPropertyFlags::e_DEVICE_LOCAL_BIT, pvrvk::MemoryPropertyFlags::e_LAZILY_ALLOCATED_BIT);
+				if (images[r][i]->getDeviceMemory()->hasPropertyFlag(pvrvk::MemoryPropertyFlags::e_LAZILY_ALLOCATED_BIT)) { ++_numLazilyAllocated; }
+				else
+				{
+					_memoryAllocated += images[r][i]->getMemoryRequirement().getSize();
+					_memoryRequired += images[r][i]->getMemoryRequirement().getSize();
+				}
+			}
+			else
+			{
+				// Memory is bound below, once the images that can share it are known
+				images[r][i] = createImage(device, createInfo, pvrvk::MemoryPropertyFlags::e_NONE);
+			}
+			images[r][i]->setObjectName("RenderGraph " + resource.name + " [" + std::to_string(i) + "]");
+		}
+		if (!resource.isTransient) { aliased.emplace_back(r); }
+	}
+
+	// Outputs must survive until the end of the graph.
+	auto lastUse = [this](uint32_t r) { return _resources[r].isOutput ? Invalid : _resources[r].lastPhysicalPass; };
+
+	// Assign the largest images first, each to the first memory slot that is not in use during its lifetime.
+	std::sort(aliased.begin(), aliased.end(),
+		[&images](uint32_t a, uint32_t b) { return images[a][0]->getMemoryRequirement().getSize() > images[b][0]->getMemoryRequirement().getSize(); });
+	_memorySlots.clear();
+	for (uint32_t r : aliased)
+	{
+		const pvrvk::MemoryRequirements& requirements = images[r][0]->getMemoryRequirement();
+		_memoryRequired += requirements.getSize() * _numInstances;
+		uint32_t slot = Invalid;
+		for (uint32_t s = 0; s < _memorySlots.size() && slot == Invalid; ++s)
+		{
+			const uint32_t memoryTypeBits = _memorySlots[s].memoryTypeBits & requirements.getMemoryTypeBits();
+			if (!hasDeviceLocalMemoryType(physicalDevice, memoryTypeBits)) { continue; }
+			bool overlaps = false;
+			for (uint32_t other : _memorySlots[s].resources)
+			{ overlaps = overlaps || (_resources[r].firstPhysicalPass <= lastUse(other) && _resources[other].firstPhysicalPass <= lastUse(r)); }
+			if (!overlaps) { slot = s; }
+		}
+		if (slot == Invalid)
+		{
+			slot = static_cast<uint32_t>(_memorySlots.size());
+			_memorySlots.emplace_back();
+			_memorySlots.back().size = 0;
+			_memorySlots.back().memoryTypeBits = requirements.getMemoryTypeBits();
+		}
+		MemorySlot& memorySlot = _memorySlots[slot];
+		memorySlot.size = std::max(memorySlot.size, requirements.getSize());
+		memorySlot.memoryTypeBits &= requirements.getMemoryTypeBits();
+		memorySlot.resources.emplace_back(r);
+		_resources[r].memorySlot = slot;
+	}
+
+	// Within a slot, lifetimes are disjoint, so each image only has to wait for the one using the memory before it.
+	_memoryBlocks.clear();
+	for (auto& slot : _memorySlots)
+	{
+		std::sort(slot.resources.begin(), slot.resources.end(), [this](uint32_t a, uint32_t b) { return _resources[a].firstPhysicalPass < _resources[b].firstPhysicalPass; });
+		for (size_t i = 1; i < slot.resources.size(); ++i) { _resources[slot.resources[i]].aliasPredecessor = slot.resources[i - 1]; }
+
+		uint32_t memoryTypeIndex = Invalid;
+		pvrvk::MemoryPropertyFlags memoryPropertyFlags;
+		getMemoryTypeIndex(physicalDevice, slot.memoryTypeBits, pvrvk::MemoryPropertyFlags::e_DEVICE_LOCAL_BIT, pvrvk::MemoryPropertyFlags::e_DEVICE_LOCAL_BIT, memoryTypeIndex,
+			memoryPropertyFlags);
+		if (memoryTypeIndex == Invalid) { throw InvalidOperationError("RenderGraph: Could not find a device local memory type for the images"); }
+		for (uint32_t i = 0; i < _numInstances; ++i)
+		{
+			pvrvk::DeviceMemory memory = device->allocateMemory(pvrvk::MemoryAllocationInfo(slot.size, memoryTypeIndex));
+			for (uint32_t r : slot.resources) { images[r][i]->bindMemoryNonSparse(memory); }
+			_memoryBlocks.emplace_back(memory);
+			_memoryAllocated += slot.size;
+		}
+	}
+
+	for (uint32_t r = 0; r < _resources.size(); ++r)
+	{
+		for (auto& image : images[r]) { _resources[r].views.emplace_back(device->createImageView(pvrvk::ImageViewCreateInfo(image))); }
+	}
+}
+
+bool RenderGraph::isUsedAfter(uint32_t resource, uint32_t physicalPassIndex) const
+{
+	return _resources[resource].lastPhysicalPass != Invalid && _resources[resource].lastPhysicalPass > physicalPassIndex;
+}
+
+// The first use of an image in a physical pass after a given one, preferring uses outside of attachments, which are
+// synchronised first.
+bool RenderGraph::findNextUse(uint32_t resource, uint32_t physicalPassIndex, UseInfo& outUse, bool& outIsAttachment) const
+{
+	for (uint32_t pp = physicalPassIndex + 1; pp < _physicalPasses.size(); ++pp)
+	{
+		bool found = false;
+		for (uint32_t p : _physicalPasses[pp].passes)
+		{
+			for (const auto& use : _passes[p]->_uses)
+			{
+				if (use.resource != resource) { continue; }
+				if (!found || (outIsAttachment && !isAttachment(use)))
+				{
+					outUse = getUseInfo(use, _passes[p]->getType());
+					outIsAttachment = isAttachment(use);
+					found = true;
+				}
+			}
+		}
+		if (found) { return true; }
+	}
+	return false;
+}
+
+// Take the synchronisation state of an image over from the image that used its memory before it.
+void RenderGraph::beginLifetime(uint32_t resource)
+{
+	Resource& res = _resources[resource];
+	if (res.aliasPredecessor == Invalid) { return; }
+	const ResourceState& predecessor = _resources[res.aliasPredecessor].state;
+	res.state.stages = predecessor.stages;
+	res.state.writeAccess = predecessor.writeAccess;
+	res.state.layout = pvrvk::ImageLayout::e_UNDEFINED;
+}
+
+void RenderGraph::addBarrier(Barrier& barrier, uint32_t resource, const UseInfo& use)
+{
+	ResourceState& state = _resources[resource].state;
+	barrier.srcStages |= state.stages != 0 ? state.stages : pvrvk::PipelineStageFlags::e_TOP_OF_PIPE_BIT;
+	barrier.dstStages |= use.stages;
+
+	ImageBarrier imageBarrier;
+	imageBarrier.resource = resource;
+	imageBarrier.srcAccess = state.writeAccess;
+	imageBarrier.dstAccess = use.access;
+	imageBarrier.oldLayout = state.layout;
+	imageBarrier.newLayout = use.layout;
+	// The contents of the previous image in aliased memory are made available with a global barrier
+	if (state.layout == pvrvk::ImageLayout::e_UNDEFINED && state.writeAccess != 0)
+	{
+		barrier.globalSrcAccess |= state.writeAccess;
+		barrier.globalDstAccess |= use.access;
+		imageBarrier.srcAccess = pvrvk::AccessFlags::e_NONE;
+	}
+	barrier.imageBarriers.emplace_back(imageBarrier);
+}
+
+void RenderGraph::createBarrierSets(Barrier& barrier)
+{
+	barrier.barrierSets.clear();
+	barrier.barrierSets.resize(_numInstances);
+	if (barrier.empty()) { return; }
+	for (uint32_t i = 0; i < _numInstances; ++i)
+	{
+		pvrvk::MemoryBarrierSet& barrierSet = barrier.barrierSets[i];
+		if (barrier.globalSrcAccess != 0) { barrierSet.addBarrier(pvrvk::MemoryBarrier(barrier.globalSrcAccess, barrier.globalDstAccess)); }
+		for (const auto& imageBarrier : barrier.imageBarriers)
+		{
+			const pvrvk::ImageView& view = getImageView(_resources[imageBarrier.resource].name, i);
+			barrierSet.addBarrier(pvrvk::ImageMemoryBarrier(imageBarrier.srcAccess, imageBarrier.dstAccess, view->getImage(), view->getSubresourceRange(), imageBarrier.oldLayout,
+				imageBarrier.newLayout, static_cast<uint32_t>(-1), static_cast<uint32_t>(-1)));
+		}
+	}
+}
+
+void RenderGraph::compilePhysicalPass(pvrvk::Device& device, uint32_t physicalPassIndex)
+{
+	PhysicalPass& physicalPass = _physicalPasses[physicalPassIndex];
+
+	// Uses outside of attachments are synchronised by a pipeline barrier before the pass, only where needed.
+	for (uint32_t p : physicalPass.passes)
+	{
+		for (const auto& use : _passes[p]->_uses)
+		{
+			if (isAttachment(use)) { continue; }
+			if (_resources[use.resource].firstPhysicalPass == physicalPassIndex) { beginLifetime(use.resource); }
+			const UseInfo info = getUseInfo(use, _passes[p]->getType());
+			ResourceState& state = _resources[use.resource].state;
+			const bool dependency = needsDependency(state, info);
+			if (dependency) { addBarrier(physicalPass.barrier, use.resource, info); }
+			applyUse(state, info, dependency);
+		}
+	}
+	createBarrierSets(physicalPass.barrier);
+	if (!physicalPass.isRenderPass) { return; }
+
+	// Attachments are transitioned by the render pass itself, and synchronised by its subpass dependencies.
+	const uint32_t numAttachments = static_cast<uint32_t>(physicalPass.attachments.size());
+	const uint32_t numSubpasses = static_cast<uint32_t>(physicalPass.passes.size());
+	std::vector<pvrvk::AttachmentDescription> descriptions(numAttachments);
+	std::vector<uint32_t> firstSubpass(numAttachments, Invalid), lastSubpass(numAttachments, Invalid);
+	std::map<std::pair<uint32_t, uint32_t>, pvrvk::SubpassDependency> dependencies;
+	auto addDependency = [&dependencies](uint32_t src, uint32_t dst, pvrvk::PipelineStageFlags srcStages, pvrvk::PipelineStageFlags dstStages, pvrvk::AccessFlags srcAccess,
+							 pvrvk::AccessFlags dstAccess) {
+		auto it = dependencies.find(std::make_pair(src, dst));
+		if (it == dependencies.end())
+		{
+			const pvrvk::DependencyFlags flags = (src != pvrvk::SubpassExternal && dst != pvrvk::SubpassExternal) ? pvrvk::DependencyFlags::e_BY_REGION_BIT : pvrvk::DependencyFlags::e_NONE;
+			dependencies[std::make_pair(src, dst)] = pvrvk::SubpassDependency(src, dst, srcStages, dstStages, srcAccess, dstAccess, flags);
+		}
+		else
+		{
+			it->second.setSrcStageMask(it->second.getSrcStageMask() | srcStages);
+			it->second.setDstStageMask(it->second.getDstStageMask() | dstStages);
+			it->second.setSrcAccessMask(it->second.getSrcAccessMask() | srcAccess);
+			it->second.setDstAccessMask(it->second.getDstAccessMask() | dstAccess);
+		}
+	};
+
+	pvrvk::RenderPassCreateInfo createInfo;
+	for (uint32_t s = 0; s < numSubpasses; ++s)
+	{
+		const RenderGraphPass& pass = *_passes[physicalPass.passes[s]];
+		pvrvk::SubpassDescription subpass;
+		uint32_t colorIndex = 0, inputIndex = 0;
+		for (const auto& use : pass._uses)
+		{
+			if (!isAttachment(use)) { continue; }
+			const uint32_t a = static_cast<uint32_t>(std::find(physicalPass.attachments.begin(), physicalPass.attachments.end(), use.resource) - physicalPass.attachments.begin());
+			const UseInfo info = getUseInfo(use, pass.getType());
+			Resource& resource = _resources[use.resource];
+			ResourceState& state = resource.state;
+
+			if (firstSubpass[a] == Invalid)
+			{
+				if (resource.firstPhysicalPass == physicalPassIndex) { beginLifetime(use.resource); }
+				firstSubpass[a] = s;
+				pvrvk::AttachmentLoadOp loadOp = use.loadOp;
+				if (state.layout == pvrvk::ImageLayout::e_UNDEFINED && loadOp == pvrvk::AttachmentLoadOp::e_LOAD) { loadOp = pvrvk::AttachmentLoadOp::e_DONT_CARE; }
+				const pvrvk::ImageLayout initialLayout = loadOp == pvrvk::AttachmentLoadOp::e_LOAD ? state.layout : pvrvk::ImageLayout::e_UNDEFINED;
+				descriptions[a] = pvrvk::AttachmentDescription(resource.description.format, initialLayout, info.layout, loadOp, pvrvk::AttachmentStoreOp::e_DONT_CARE,
+					hasStencil(resource.description.format) ? loadOp : pvrvk::AttachmentLoadOp::e_DONT_CARE, pvrvk::AttachmentStoreOp::e_DONT_CARE, resource.description.sampleCount);
+				if (needsDependency(state, info))
+				{
+					// With no earlier use, wait for the stage of this use: this covers the semaphore wait of an acquired swapchain image.
+					addDependency(pvrvk::SubpassExternal, s, state.stages != 0 ? state.stages : info.stages, info.stages, state.writeAccess, info.access);
+					applyUse(state, info, true);
+				}
+				else
+				{
+					applyUse(state, info, false);
+				}
+			}
+			else if (lastSubpass[a] != s)
+			{
+				const bool dependency = needsDependency(state, info);
+				if (dependency) { addDependency(lastSubpass[a], s, state.stages, info.stages, state.writeAccess, info.access); }
+				applyUse(state, info, dependency);
+			}
+			lastSubpass[a] = s;
+
+			switch (use.access)
+			{
+			case RenderGraphPass::Access::ColorAttachment: subpass.setColorAttachmentReference(colorIndex++, pvrvk::AttachmentReference(a, info.layout)); break;
+			case RenderGraphPass::Access::DepthStencilAttachment:
+			case RenderGraphPass::Access::DepthStencilReadOnly: subpass.setDepthStencilAttachmentReference(pvrvk::AttachmentReference(a, info.layout)); break;
+			case RenderGraphPass::Access::InputAttachment: subpass.setInputAttachmentReference(inputIndex++, pvrvk::AttachmentReference(a, info.layout)); break;
+			default: break;
+			}
+		}
+		createInfo.setSubpass(s, subpass);
+	}
+
+	// Attachments used both before and after a subpass that does not use them must be preserved through it.
+	std::vector<uint32_t> numPreserved(numSubpasses, 0);
+	for (uint32_t a = 0; a < numAttachments; ++a)
+	{
+		for (uint32_t s = firstSubpass[a] + 1; s < lastSubpass[a]; ++s)
+		{
+			bool used = false;
+			for (const auto& use : _passes[physicalPass.passes[s]]->_uses) { used = used || use.resource == physicalPass.attachments[a]; }
+			if (!used)
+			{
+				pvrvk::SubpassDescription subpass = createInfo.getSubpass(s);
+				subpass.setPreserveAttachmentReference(numPreserved[s]++, a);
+				createInfo.setSubpass(s, subpass);
+			}
+		}
+	}
+
+	// Store only what is used later, and leave each attachment in the layout of its next use when that use is outside of
+	// a render pass, so that it needs no barrier.
+	for (uint32_t a = 0; a < numAttachments; ++a)
+	{
+		const uint32_t r = physicalPass.attachments[a];
+		Resource& resource = _resources[r];
+		ResourceState& state = resource.state;
+		const bool keep = isUsedAfter(r, physicalPassIndex) || resource.isOutput;
+		pvrvk::AttachmentDescription& description = descriptions[a];
+		const pvrvk::AttachmentStoreOp storeOp = keep ? pvrvk::AttachmentStoreOp::e_STORE : pvrvk::AttachmentStoreOp::e_DONT_CARE;
+		pvrvk::ImageLayout finalLayout = state.layout;
+
+		UseInfo next;
+		bool nextIsAttachment = false;
+		if (findNextUse(r, physicalPassIndex, next, nextIsAttachment))
+		{
+			if (!nextIsAttachment && next.layout != state.layout)
+			{
+				finalLayout = next.layout;
+				addDependency(lastSubpass[a], pvrvk::SubpassExternal, state.stages, next.stages, state.writeAccess, next.access);
+				state.stages = next.stages;
+				state.readyStages = next.stages;
+				state.readyAccess = next.access;
+				state.writeReadyStages = next.stages;
+			}
+		}
+		else if (resource.isOutput)
+		{
+			finalLayout = resource.finalLayout;
+			pvrvk::PipelineStageFlags dstStages;
+			pvrvk::AccessFlags dstAccess;
+			getOutputScope(finalLayout, dstStages, dstAccess);
+			addDependency(lastSubpass[a], pvrvk::SubpassExternal, state.stages, dstStages, state.writeAccess, dstAccess);
+			state.stages = dstStages;
+			state.writeAccess = pvrvk::AccessFlags::e_NONE;
+		}
+		state.layout = finalLayout;
+
+		description = pvrvk::AttachmentDescription(description.getFormat(), description.getInitialLayout(), finalLayout, description.getLoadOp(), storeOp,
+			description.getStencilLoadOp(), hasStencil(description.getFormat()) ? storeOp : pvrvk::AttachmentStoreOp::e_DONT_CARE, description.getSamples());
+		createInfo.setAttachmentDescription(a, description);
+	}
+	for (const auto& dependency : dependencies) { createInfo.addSubpassDependency(dependency.second); }
+
+	physicalPass.renderPass = device->createRenderPass(createInfo);
+	physicalPass.renderPass->setObjectName("RenderGraph " + _passes[physicalPass.passes[0]]->getName());
+	physicalPass.framebuffers.resize(_numInstances);
+	for (uint32_t i = 0; i < _numInstances; ++i)
+	{
+		pvrvk::ImageView views[MaxFramebufferAttachments];
+		for (uint32_t a = 0; a < numAttachments; ++a) { views[a] = getImageView(_resources[physicalPass.attachments[a]].name, i); }
+		physicalPass.framebuffers[i] = device->createFramebuffer(
+			pvrvk::FramebufferCreateInfo(physicalPass.extent.getWidth(), physicalPass.extent.getHeight(), 1, physicalPass.renderPass, numAttachments, views));
+	}
+}
+
+void RenderGraph::compile(pvrvk::Device& device)
+{
+	if (_compiled) { throw InvalidOperationError("RenderGraph: Graph already compiled"); }
+	if (_numInstances == 0) { _numInstances = 1; }
+	for (const auto& resource : _resources)
+	{
+		if (resource.isImported && resource.views.size() != 1 && resource.views.size() != _numInstances)
+		{ throw InvalidOperationError("RenderGraph: Image [" + resource.name + "] must be imported with one view, or one view per instance"); }
+	}
+
+	resolveUses();
+	cullPasses();
+	mergePasses();
+	computeLifetimes();
+	_memoryAllocated = 0;
+	_memoryRequired = 0;
+	_numLazilyAllocated = 0;
+	createImages(device);
+
+	for (uint32_t pp = 0; pp < _physicalPasses.size(); ++pp) { compilePhysicalPass(device, pp); }
+
+	// Leave the outputs in their final layout
+	_finalBarrier.reset();
+	for (uint32_t r = 0; r < _resources.size(); ++r)
+	{
+		const Resource& resource = _resources[r];
+		if (!resource.isOutput || resource.state.layout == resource.finalLayout || resource.finalLayout == pvrvk::ImageLayout::e_UNDEFINED) { continue; }
+		if (resource.views.empty()) { continue; }
+		UseInfo info;
+		getOutputScope(resource.finalLayout, info.stages, info.access);
+		info.layout = resource.finalLayout;
+		info.isWrite = false;
+		addBarrier(_finalBarrier, r, info);
+	}
+	createBarrierSets(_finalBarrier);
+	_compiled = true;
+
+	uint32_t numCulled = 0, numRenderPasses = 0, numTransient = 0;
+	for (bool culled : _passCulled) { numCulled += culled; }
+	for (const auto& physicalPass : _physicalPasses) { numRenderPasses += physicalPass.isRenderPass; }
+	for (const auto& resource : _resources) { numTransient += resource.isTransient; }
+	Log(LogLevel::Information,
+		"RenderGraph: %u passes (%u culled) compiled into %u render passes and %u other passes, with %u pipeline barriers. %u transient attachments (%u images lazily allocated). "
+		"%llu KB of memory allocated for %llu KB of images.",
+		static_cast<uint32_t>(_passes.size()), numCulled, numRenderPasses, static_cast<uint32_t>(_physicalPasses.size()) - numRenderPasses, getNumPipelineBarriers(), numTransient,
+		_numLazilyAllocated, static_cast<unsigned long long>(_memoryAllocated / 1024), static_cast<unsigned long long>(_memoryRequired / 1024));
+}
+
+void RenderGraph::execute(pvrvk::CommandBuffer& commandBuffer, uint32_t instanceIndex)
+{
+	if (!_compiled) { throw InvalidOperationError("RenderGraph: The graph must be compiled before it is executed"); }
+	if (instanceIndex >= _numInstances) { throw InvalidArgumentError("instanceIndex", "RenderGraph: Instance index out of range"); }
+
+	for (auto& physicalPass : _physicalPasses)
+	{
+		if (!physicalPass.barrier.empty())
+		{ commandBuffer->pipelineBarrier(physicalPass.barrier.srcStages, physicalPass.barrier.dstStages, physicalPass.barrier.barrierSets[instanceIndex], false); }
+
+		if (physicalPass.isRenderPass)
+		{
+			commandBuffer->beginRenderPass(physicalPass.framebuffers[instanceIndex], pvrvk::Rect2D(pvrvk::Offset2D(0, 0), physicalPass.extent), true, physicalPass.clearValues.data(),
+				static_cast<uint32_t>(physicalPass.clearValues.size()));
+		}
+		for (size_t s = 0; s < physicalPass.passes.size(); ++s)
+		{
+			if (physicalPass.isRenderPass && s > 0) { commandBuffer->nextSubpass(pvrvk::SubpassContents::e_INLINE); }
+			const RenderGraphPass& pass = *_passes[physicalPass.passes[s]];
+			if (pass._callback) { pass._callback(commandBuffer, instanceIndex); }
+		}
+		if (physicalPass.isRenderPass) { commandBuffer->endRenderPass(); }
+	}
+
+	if (!_finalBarrier.empty()) { commandBuffer->pipelineBarrier(_finalBarrier.srcStages, _finalBarrier.dstStages, _finalBarrier.barrierSets[instanceIndex], false); }
+}
+
+bool RenderGraph::isPassCulled(const std::string& passName) const
+{
+	const uint32_t index = findPass(passName);
+	if (index == Invalid) { throw InvalidArgumentError("passName", "RenderGraph: No pass named [" + passName + "]"); }
+	if (!_compiled) { throw InvalidOperationError("RenderGraph: The graph has not been compiled"); }
+	return _passCulled[index];
+}
+
+const RenderGraph::PhysicalPass& RenderGraph::getPhysicalPass(const std::string& passName) const
+{
+	if (isPassCulled(passName)) { throw InvalidOperationError("RenderGraph: Pass [" + passName + "] was culled"); }
+	return _physicalPasses[_passPhysicalPass[findPass(passName)]];
+}
+
+const pvrvk::RenderPass& RenderGraph::getRenderPass(const std::string& passName) const
+{
+	const PhysicalPass& physicalPass = getPhysicalPass(passName);
+	if (!physicalPass.isRenderPass) { throw InvalidOperationError("RenderGraph: Pass [" + passName + "] is not a graphics pass"); }
+	return physicalPass.renderPass;
+}
+
+uint32_t RenderGraph::getSubpass(const std::string& passName) const
+{
+	getPhysicalPass(passName);
+	return _passSubpass[findPass(passName)];
+}
+
+const pvrvk::Framebuffer& RenderGraph::getFramebuffer(const std::string& passName, uint32_t instanceIndex) const
+{
+	const PhysicalPass& physicalPass = getPhysicalPass(passName);
+	if (!physicalPass.isRenderPass) { throw InvalidOperationError("RenderGraph: Pass [" + passName + "] is not a graphics pass"); }
+	return physicalPass.framebuffers[instanceIndex];
+}
+
+const pvrvk::ImageView& RenderGraph::getImageView(const std::string& name, uint32_t instanceIndex) const
+{
+	const uint32_t index = findResource(name);
+	if (index == Invalid) { throw InvalidArgumentError("name", "RenderGraph: No image named [" + name + "]"); }
+	const Resource& resource = _resources[index];
+	if (resource.views.empty()) { throw InvalidOperationError("RenderGraph: Image [" + name + "] has not been created"); }
+	return resource.views[std::min<size_t>(instanceIndex, resource.views.size() - 1)];
+}
+
+uint32_t RenderGraph::getNumPipelineBarriers() const
+{
+	uint32_t numBarriers = !_finalBarrier.empty();
+	for (const auto& physicalPass : _physicalPasses) { numBarriers += !physicalPass.barrier.empty(); }
+	return numBarriers;
+}
+
+void RenderGraph::release()
+{
+	_physicalPasses.clear();
+	_finalBarrier.reset();
+	for (auto& resource : _resources)
+	{
+		if (!resource.isImported) { resource.views.clear(); }
+	}
+	_memoryBlocks.clear();
+	_memorySlots.clear();
+	_passCulled.clear();
+	_passPhysicalPass.clear();
+	_passSubpass.clear();
+	_memoryAllocated = 0;
+	_memoryRequired = 0;
+	_numLazilyAllocated = 0;
+	_compiled = false;
+}
+} // namespace utils
+} // namespace pvr
+//!\endcond
@@ -0,0 +1,416 @@
+/*!
+\brief A declarative frame graph that builds render passes, framebuffers, barriers and transient attachments from the resources used by each pass.
+\file PVRUtils/Vulkan/RenderGraphVk.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRVk/DeviceVk.h"
+#include "PVRVk/RenderPassVk.h"
+#include "PVRVk/FramebufferVk.h"
+#include "PVRVk/SwapchainVk.h"
+#include "PVRVk/CommandBufferVk.h"
+#include "PVRVk/MemoryBarrierVk.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace pvr {
+namespace utils {
+/// <summary>The type of work recorded by a pass of a RenderGraph.</summary>
+enum class RenderGraphPassType
+{
+	Graphics, //!< The pass renders into attachments, inside a render pass
+	Compute //!< The pass dispatches compute work (or any other work recorded outside of a render pass)
+};
+
+/// <summary>Describes an image owned by a RenderGraph.</summary>
+struct RenderGraphImageDescription
+{
+	/// <summary>The format of the image</summary>
+	pvrvk::Format format;
+
+	/// <summary>The size of the image. A zero width or height means the dimensions of the graph.</summary>
+	pvrvk::Extent2D extent;
+
+	/// <summary>The number of samples of the image</summary>
+	pvrvk::SampleCountFlags sampleCount;
+
+	/// <summary>Usage flags to add to the ones inferred from the passes (for example, TRANSFER_SRC to read it back)</summary>
+	pvrvk::ImageUsageFlags additionalUsage;
+
+	/// <summary>Constructor.</summary>
+	/// <param name="format">The format of the image</param>
+	/// <param name="extent">The size of the image. A zero width or height means the dimensions of the graph.</param>
+	/// <param name="sampleCount">The number of samples of the image</param>
+	RenderGraphImageDescription(pvrvk::Format format = pvrvk::Format::e_UNDEFINED, const pvrvk::Extent2D& extent = pvrvk::Extent2D(0, 0),
+		pvrvk::SampleCountFlags sampleCount = pvrvk::SampleCountFlags::e_1_BIT)
+		: format(format), extent(extent), sampleCount(sampleCount), additionalUsage(pvrvk::ImageUsageFlags::e_NONE)
+	{}
+};
+
+class RenderGraph;
+
+/// <summary>A pass of a RenderGraph. Declares the images the pass reads and writes, and the function that records its
+/// commands. Created by RenderGraph::addPass.</summary>
+class RenderGraphPass
+{
+public:
+	/// <summary>The function recording the commands of a pass. For graphics passes, it is called inside the subpass of the
+	/// pass, so it must use pipelines created for RenderGraph::getRenderPass and RenderGraph::getSubpass of this pass.</summary>
+	typedef std::function<void(pvrvk::CommandBuffer& commandBuffer, uint32_t instanceIndex)> RecordCallback;
+
+	/// <summary>Write a color attachment. Attachments are bound to the color locations in the order they are added.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <param name="loadOp">e_LOAD to keep the contents written by earlier passes, e_CLEAR or e_DONT_CARE to overwrite them</param>
+	/// <param name="clearValue">The clear value, if loadOp is e_CLEAR</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& addColorOutput(const std::string& name, pvrvk::AttachmentLoadOp loadOp = pvrvk::AttachmentLoadOp::e_DONT_CARE,
+		const pvrvk::ClearValue& clearValue = pvrvk::ClearValue(0.f, 0.f, 0.f, 1.f));
+
+	/// <summary>Write (test and write) a depth stencil attachment.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <param name="loadOp">e_LOAD to keep the contents written by earlier passes, e_CLEAR or e_DONT_CARE to overwrite them</param>
+	/// <param name="clearValue">The clear value, if loadOp is e_CLEAR</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& setDepthStencilOutput(const std::string& name, pvrvk::AttachmentLoadOp loadOp = pvrvk::AttachmentLoadOp::e_CLEAR,
+		const pvrvk::ClearValue& clearValue = pvrvk::ClearValue::createDefaultDepthStencilClearValue());
+
+	/// <summary>Test against a depth stencil attachment written by an earlier pass, without writing it.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& setDepthStencilInput(const std::string& name);
+
+	/// <summary>Read an image written by an earlier pass as an input attachment, at the current pixel only. Input attachments
+	/// are bound to the input attachment indices in the order they are added. Passes connected by input attachments only can
+	/// be merged into the subpasses of a single render pass, keeping the intermediate images on chip on tile-based GPUs.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& addInputAttachment(const std::string& name);
+
+	/// <summary>Sample an image written by an earlier pass.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& addTextureInput(const std::string& name);
+
+	/// <summary>Read an image as a storage image.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& addStorageInput(const std::string& name);
+
+	/// <summary>Write an image as a storage image. Add it as a storage input as well to keep its previous contents.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& addStorageOutput(const std::string& name);
+
+	/// <summary>Set the function recording the commands of the pass.</summary>
+	/// <param name="callback">The function</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& setRecordCallback(const RecordCallback& callback)
+	{
+		_callback = callback;
+		return *this;
+	}
+
+	/// <summary>Mark the pass as having effects that are not visible to the graph (for example, writing to a buffer), so it
+	/// is never culled.</summary>
+	/// <param name="hasSideEffects">True to never cull the pass</param>
+	/// <returns>This object (allows chaining)</returns>
+	RenderGraphPass& setHasSideEffects(bool hasSideEffects)
+	{
+		_hasSideEffects = hasSideEffects;
+		return *this;
+	}
+
+	/// <summary>Get the name of the pass.</summary>
+	/// <returns>The name of the pass</returns>
+	const std::string& getName() const { return _name; }
+
+	/// <summary>Get the type of the pass.</summary>
+	/// <returns>The type of the pass</returns>
+	RenderGraphPassType getType() const { return _type; }
+
+private:
+	friend class RenderGraph;
+
+	enum class Access
+	{
+		ColorAttachment,
+		DepthStencilAttachment,
+		DepthStencilReadOnly,
+		InputAttachment,
+		Texture,
+		StorageRead,
+		StorageWrite
+	};
+
+	struct ResourceUse
+	{
+		std::string name;
+		uint32_t resource;
+		Access access;
+		pvrvk::AttachmentLoadOp loadOp;
+		pvrvk::ClearValue clearValue;
+	};
+
+	RenderGraphPass(const std::string& name, RenderGraphPassType type) : _name(name), _type(type), _hasSideEffects(false) {}
+	RenderGraphPass& addUse(const std::string& name, Access access, pvrvk::AttachmentLoadOp loadOp, const pvrvk::ClearValue& clearValue);
+
+	std::string _name;
+	RenderGraphPassType _type;
+	bool _hasSideEffects;
+	RecordCallback _callback;
+	std::vector<ResourceUse> _uses;
+};
+
+/// <summary>A declarative frame graph. Passes declare the images they read and write, and compile() derives everything
+/// the examples otherwise create by hand:
+/// - passes that contribute nothing to the outputs of the graph are culled;
+/// - consecutive graphics passes with attachments of the same size, which only read each other's results as input
+///   attachments, are merged into the subpasses of one render pass, so that tile-based GPUs never write the intermediate
+///   images to memory;
+/// - load and store operations are inferred from which passes use an image next, and layout transitions are folded
+///   into the render passes as initial and final layouts, with the matching subpass dependencies. Pipeline barriers are
+///   only recorded for images used outside of render passes, and only when a hazard or a layout change requires one;
+/// - images only used as attachments within one render pass are created as transient attachments, backed by
+///   LAZILY_ALLOCATED memory where the device supports it. The other images the graph owns share memory blocks whenever
+///   their lifetimes do not overlap.
+/// All images are created once per instance (usually per swapchain image), so that frames in flight never share them.</summary>
+class RenderGraph
+{
+public:
+	/// <summary>Constructor. Creates an empty graph.</summary>
+	RenderGraph() : _extent(0, 0), _numInstances(0), _compiled(false), _memoryAllocated(0), _memoryRequired(0), _numLazilyAllocated(0) {}
+
+	/// <summary>Set the size used for images with no explicit size, and the number of instances of the resources.</summary>
+	/// <param name="extent">The size of the graph</param>
+	/// <param name="numInstances">The number of copies of each resource, usually the number of swapchain images</param>
+	void setDimensions(const pvrvk::Extent2D& extent, uint32_t numInstances);
+
+	/// <summary>Declare an image owned by the graph.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <param name="description">The description of the image</param>
+	void addImage(const std::string& name, const RenderGraphImageDescription& description);
+
+	/// <summary>Import the images of a swapchain. They are outputs of the graph and are left in the PRESENT_SRC_KHR layout.
+	/// If they have not been set yet, also sets the dimensions of the graph to the size and length of the swapchain. The
+	/// semaphore signalled when acquiring an image must be waited for at the COLOR_ATTACHMENT_OUTPUT stage.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <param name="swapchain">The swapchain</param>
+	void importSwapchain(const std::string& name, const pvrvk::Swapchain& swapchain);
+
+	/// <summary>Import images owned by the application. They are outputs of the graph.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <param name="imageViews">One image view per instance, or a single one shared by all instances</param>
+	/// <param name="initialLayout">The layout of the images when the graph is executed. Use e_UNDEFINED if their
+	/// contents need not be kept.</param>
+	/// <param name="finalLayout">The layout to leave the images in</param>
+	void importImage(const std::string& name, const std::vector<pvrvk::ImageView>& imageViews, pvrvk::ImageLayout initialLayout, pvrvk::ImageLayout finalLayout);
+
+	/// <summary>Make an image owned by the graph an output of the graph, so that the passes writing it are not culled and
+	/// its contents are kept after execution.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <param name="finalLayout">The layout to leave the image in</param>
+	void setOutput(const std::string& name, pvrvk::ImageLayout finalLayout = pvrvk::ImageLayout::e_SHADER_READ_ONLY_OPTIMAL);
+
+	/// <summary>Add a pass. Passes are executed in the order they are added.</summary>
+	/// <param name="name">The name of the pass</param>
+	/// <param name="type">The type of the pass</param>
+	/// <returns>The pass, on which to declare the images it uses. The reference stays valid until the graph is destroyed.</returns>
+	RenderGraphPass& addPass(const std::string& name, RenderGraphPassType type = RenderGraphPassType::Graphics);
+
+	/// <summary>Cull and merge the passes, and create the images, render passes and framebuffers. Pipelines for the graphics
+	/// passes can be created once the graph is compiled.</summary>
+	/// <param name="device">The device to create the objects on</param>
+	void compile(pvrvk::Device& device);
+
+	/// <summary>Record the passes of the graph, with their barriers, into a command buffer.</summary>
+	/// <param name="commandBuffer">A command buffer in the recording state, outside of a render pass</param>
+	/// <param name="instanceIndex">The instance of the resources to use, usually the swapchain index</param>
+	void execute(pvrvk::CommandBuffer& commandBuffer, uint32_t instanceIndex);
+
+	/// <summary>Query if a pass was culled by compile().</summary>
+	/// <param name="passName">The name of the pass</param>
+	/// <returns>True if the pass will not be executed</returns>
+	bool isPassCulled(const std::string& passName) const;
+
+	/// <summary>Get the render pass a graphics pass has been compiled into.</summary>
+	/// <param name="passName">The name of the pass</param>
+	/// <returns>The render pass</returns>
+	const pvrvk::RenderPass& getRenderPass(const std::string& passName) const;
+
+	/// <summary>Get the subpass of its render pass a graphics pass has been compiled into.</summary>
+	/// <param name="passName">The name of the pass</param>
+	/// <returns>The subpass index</returns>
+	uint32_t getSubpass(const std::string& passName) const;
+
+	/// <summary>Get the framebuffer a graphics pass renders into.</summary>
+	/// <param name="passName">The name of the pass</param>
+	/// <param name="instanceIndex">The instance</param>
+	/// <returns>The framebuffer</returns>
+	const pvrvk::Framebuffer& getFramebuffer(const std::string& passName, uint32_t instanceIndex) const;
+
+	/// <summary>Get an image of the graph, for example to write it into the descriptor sets of the passes reading it.</summary>
+	/// <param name="name">The name of the image</param>
+	/// <param name="instanceIndex">The instance</param>
+	/// <returns>The image view</returns>
+	const pvrvk::ImageView& getImageView(const std::string& name, uint32_t instanceIndex) const;
+
+	/// <summary>Get the number of render passes and compute passes executed by the graph.</summary>
+	/// <returns>The number of physical passes</returns>
+	uint32_t getNumPhysicalPasses() const { return static_cast<uint32_t>(_physicalPasses.size()); }
+
+	/// <summary>Get the number of pipeline barriers recorded per execution.</summary>
+	/// <returns>The number of pipeline barriers</returns>
+	uint32_t getNumPipelineBarriers() const;
+
+	/// <summary>Get the amount of memory allocated for the images owned by the graph that are not lazily allocated, for all instances.</summary>
+	/// <returns>The size in bytes</returns>
+	VkDeviceSize getAllocatedMemorySize() const { return _memoryAllocated; }
+
+	/// <summary>Get the amount of memory the images owned by the graph that are not lazily allocated would need without aliasing.</summary>
+	/// <returns>The size in bytes</returns>
+	VkDeviceSize getRequiredMemorySize() const { return _memoryRequired; }
+
+	/// <summary>Release all the objects created by compile(), keeping the declarations.</summary>
+	void release();
+
+private:
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	// The synchronisation state of a resource, as the uses of the compiled graph are walked through in order.
+	struct ResourceState
+	{
+		pvrvk::ImageLayout layout;
+		pvrvk::PipelineStageFlags stages; // The stages of the uses since the last dependency
+		pvrvk::AccessFlags writeAccess; // The access of the last write, if any
+		pvrvk::PipelineStageFlags readyStages; // The stages the last write has already been made visible to
+		pvrvk::AccessFlags readyAccess; // The accesses the last write has already been made visible to
+		pvrvk::PipelineStageFlags writeReadyStages; // The stages at which a write is already ordered after all previous uses
+		ResourceState()
+			: layout(pvrvk::ImageLayout::e_UNDEFINED), stages(pvrvk::PipelineStageFlags(0)), writeAccess(pvrvk::AccessFlags::e_NONE), readyStages(pvrvk::PipelineStageFlags(0)),
+			  readyAccess(pvrvk::AccessFlags::e_NONE), writeReadyStages(pvrvk::PipelineStageFlags(0))
+		{}
+	};
+
+	// The layout, stages and access of one use of a resource.
+	struct UseInfo
+	{
+		pvrvk::ImageLayout layout;
+		pvrvk::PipelineStageFlags stages;
+		pvrvk::AccessFlags access;
+		bool isWrite;
+	};
+
+	struct Resource
+	{
+		std::string name;
+		RenderGraphImageDescription description;
+		bool isImported;
+		bool isOutput;
+		pvrvk::ImageLayout initialLayout;
+		pvrvk::ImageLayout finalLayout;
+		std::vector<pvrvk::ImageView> views; // One per instance
+		pvrvk::ImageUsageFlags usage;
+		uint32_t firstPhysicalPass;
+		uint32_t lastPhysicalPass;
+		bool isTransient;
+		uint32_t memorySlot;
+		uint32_t aliasPredecessor; // The image using the same memory before this one
+		ResourceState state;
+	};
+
+	struct ImageBarrier
+	{
+		uint32_t resource;
+		pvrvk::AccessFlags srcAccess;
+		pvrvk::AccessFlags dstAccess;
+		pvrvk::ImageLayout oldLayout;
+		pvrvk::ImageLayout newLayout;
+	};
+
+	struct Barrier
+	{
+		pvrvk::PipelineStageFlags srcStages;
+		pvrvk::PipelineStageFlags dstStages;
+		pvrvk::AccessFlags globalSrcAccess;
+		pvrvk::AccessFlags globalDstAccess;
+		std::vector<ImageBarrier> imageBarriers;
+		std::vector<pvrvk::MemoryBarrierSet> barrierSets; // One per instance
+		Barrier()
+			: srcStages(pvrvk::PipelineStageFlags(0)), dstStages(pvrvk::PipelineStageFlags(0)), globalSrcAccess(pvrvk::AccessFlags::e_NONE),
+			  globalDstAccess(pvrvk::AccessFlags::e_NONE)
+		{}
+		bool empty() const { return imageBarriers.empty() && globalSrcAccess == 0; }
+		void reset()
+		{
+			srcStages = dstStages = pvrvk::PipelineStageFlags(0);
+			globalSrcAccess = globalDstAccess = pvrvk::AccessFlags::e_NONE;
+			imageBarriers.clear();
+			barrierSets.clear();
+		}
+	};
+
+	struct PhysicalPass
+	{
+		std::vector<uint32_t> passes; // The logical passes, one per subpass for render passes
+		bool isRenderPass;
+		pvrvk::Extent2D extent;
+		pvrvk::SampleCountFlags sampleCount;
+		Barrier barrier; // Recorded before the pass
+		std::vector<uint32_t> attachments;
+		std::vector<pvrvk::ClearValue> clearValues;
+		pvrvk::RenderPass renderPass;
+		std::vector<pvrvk::Framebuffer> framebuffers; // One per instance
+	};
+
+	struct MemorySlot
+	{
+		VkDeviceSize size;
+		uint32_t memoryTypeBits;
+		std::vector<uint32_t> resources;
+	};
+
+	static bool isAttachment(const RenderGraphPass::ResourceUse& use);
+	static bool isWrite(const RenderGraphPass::ResourceUse& use);
+	static bool readsPreviousContents(const RenderGraphPass::ResourceUse& use);
+	static bool needsDependency(const ResourceState& state, const UseInfo& use);
+	static void applyUse(ResourceState& state, const UseInfo& use, bool dependencyAdded);
+	UseInfo getUseInfo(const RenderGraphPass::ResourceUse& use, RenderGraphPassType passType) const;
+	uint32_t findResource(const std::string& name) const;
+	uint32_t findPass(const std::string& name) const;
+	uint32_t addResource(const std::string& name);
+	pvrvk::Extent2D getResourceExtent(uint32_t resource) const;
+	const PhysicalPass& getPhysicalPass(const std::string& passName) const;
+	bool canMerge(const PhysicalPass& physicalPass, uint32_t passIndex) const;
+	bool isUsedAfter(uint32_t resource, uint32_t physicalPassIndex) const;
+	bool findNextUse(uint32_t resource, uint32_t physicalPassIndex, UseInfo& outUse, bool& outIsAttachment) const;
+	void resolveUses();
+	void cullPasses();
+	void mergePasses();
+	void computeLifetimes();
+	void createImages(pvrvk::Device& device);
+	void compilePhysicalPass(pvrvk::Device& device, uint32_t physicalPassIndex);
+	void beginLifetime(uint32_t resource);
+	void addBarrier(Barrier& barrier, uint32_t resource, const UseInfo& use);
+	void createBarrierSets(Barrier& barrier);
+
+	std::vector<Resource> _resources;
+	std::vector<std::unique_ptr<RenderGraphPass>> _passes;
+	std::vector<bool> _passCulled;
+	std::vector<uint32_t> _passPhysicalPass;
+	std::vector<uint32_t> _passSubpass;
+	std::vector<PhysicalPass> _physicalPasses;
+	std::vector<MemorySlot> _memorySlots;
+	std::vector<pvrvk::DeviceMemory> _memoryBlocks; // Per instance, per slot
+	Barrier _finalBarrier;
+	pvrvk::Extent2D _extent;
+	uint32_t _numInstances;
+	bool _compiled;
+	VkDeviceSize _memoryAllocated;
+	VkDeviceSize _memoryRequired;
+	uint32_t _numLazilyAllocated;
+};
+} // namespace utils
+} // namespace pvr
@@ -8,8 +8,11 @@
 #include "PVRUtils/Vulkan/ShaderUtilsVk.h"
 #include "PVRVk/ShaderModuleVk.h"
 #include "PVRCore/strings/StringFunctions.h"
+#include "PVRCore/strings/CompileTimeHash.h"
+#include "PVRCore/JobSystem.h"
 #include "glslang/Public/ShaderLang.h"
 #include "SPIRV/GlslangToSpv.h"
+#include <cstring>
 
 namespace pvr {
 namespace utils {
@@ -223,11 +226,35 @@ typedef enum
 	EShTargetVulkan_1_1 = (1 << 22) | (1 << 12),
 	EShTargetOpenGL_450 = 450,
 } EShTargetClientVersion;
-} // namespace
+// Bump whenever the way shaders are compiled changes, so that previously cached SPIR-V is not reused.
+const uint32_t SpirvCacheVersion = 1;
+const uint32_t SpirvMagicNumber = 0x07230203;
 
-pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, pvrvk::ShaderModuleCreateFlags flags,
-	const char* const* defines, uint32_t numDefines)
+// Entries are content addressed: any well formed SPIR-V module with the right name is valid.
+bool isValidSpirvEntry(const void* data, size_t size)
 {
+	uint32_t magic = 0;
+	if (size >= sizeof(magic)) { memcpy(&magic, data, sizeof(magic)); }
+	return size >= 5 * sizeof(uint32_t) && size % sizeof(uint32_t) == 0 && magic == SpirvMagicNumber;
+}
+
+void getTargetVersions(pvrvk::Device& device, glslang::EShTargetClientVersion& outClientVersion, glslang::EShTargetLanguageVersion& outSpirvVersion)
+{
+	uint32_t apiVersion = device->getPhysicalDevice()->getInstance()->getCreateInfo().getApplicationInfo().getApiVersion();
+	uint32_t minor = VK_VERSION_MINOR(apiVersion);
+	outClientVersion = glslang::EShTargetVulkan_1_0;
+	outSpirvVersion = glslang::EShTargetSpv_1_0;
+	if (minor >= 1)
+	{
+		outClientVersion = glslang::EShTargetVulkan_1_1;
+		// Vulkan 1.1 implementations must support SPIR-V 1.3
+		outSpirvVersion = glslang::EShTargetSpv_1_3;
+	}
+}
+
+std::vector<uint32_t> compileWithGlslang(pvrvk::Device& device, const std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, const char* const* defines, uint32_t numDefines)
+{
+	// Function local statics are initialised exactly once even if the first calls are concurrent.
 	static const GlslangProcessInitialiser glslangInitialiser;
 	static const TBuiltInResourceInitialiser glslangResources(device);
 
@@ -238,18 +265,19 @@ pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shade
 
 	// Determine whether a version string is present
 	std::string::size_type versionBegin = shaderSource.find("#version");
-	std::string::size_type versionEnd = 0;
+	std::string::size_type versionEnd = versionBegin;
 	std::string sourceDataStr;
-	// If a version string is present then update the versionBegin variable to the position after the version string
+	// If a version string is present then copy it, up to and including its line break, ahead of the defines
 	if (versionBegin != std::string::npos)
 	{
 		versionEnd = shaderSource.find("\n", versionBegin);
-		sourceDataStr.append(shaderSource.begin() + versionBegin, shaderSource.begin() + versionBegin + versionEnd);
+		if (versionEnd == std::string::npos) { versionEnd = shaderSource.size(); }
+		sourceDataStr.append(shaderSource.begin() + versionBegin, shaderSource.begin() + versionEnd);
 		sourceDataStr.append("\n");
 	}
 	else
 	{
-		versionBegin = 0;
+		versionBegin = versionEnd = 0;
 	}
 	// Insert the defines after the version string if one is present
 	for (uint32_t i = 0; i < numDefines; ++i)
@@ -259,7 +287,8 @@ pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shade
 		sourceDataStr.append("\n");
 	}
 	sourceDataStr.append("\n");
-	sourceDataStr.append(shaderSource.begin() + versionBegin + versionEnd, shaderSource.end());
+	// Anything preceding the version string (comments) is dropped, as was the version string itself
+	sourceDataStr.append(shaderSource.begin() + versionEnd, shaderSource.end());
 
 	const char* const shaderSourceChar = sourceDataStr.c_str();
 
@@ -270,16 +299,9 @@ pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shade
 	// Enable various messages determining what errors and warnings are given
 	EShMessages messages = static_cast<EShMessages>(EShMessages::EShMsgDefault | EShMessages::EShMsgSpvRules | EShMessages::EShMsgVulkanRules);
 
-	uint32_t apiVersion = device->getPhysicalDevice()->getInstance()->getCreateInfo().getApplicationInfo().getApiVersion();
-	uint32_t minor = VK_VERSION_MINOR(apiVersion);
-	glslang::EShTargetClientVersion vulkanClientVersion = glslang::EShTargetVulkan_1_0;
-	glslang::EShTargetLanguageVersion targetSpirvVersion = glslang::EShTargetSpv_1_0;
-	if (minor >= 1)
-	{
-		vulkanClientVersion = glslang::EShTargetVulkan_1_1;
-		// Vulkan 1.1 implementations must support SPIR-V 1.3
-		targetSpirvVersion = glslang::EShTargetSpv_1_3;
-	}
+	glslang::EShTargetClientVersion vulkanClientVersion;
+	glslang::EShTargetLanguageVersion targetSpirvVersion;
+	getTargetVersions(device, vulkanClientVersion, targetSpirvVersion);
 
 	glslangShaderPtr->setEnvClient(glslang::EShClientVulkan, vulkanClientVersion);
 	glslangShaderPtr->setEnvTarget(glslang::EShTargetSpv, targetSpirvVersion);
@@ -328,21 +350,95 @@ pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shade
 	if (logger.getAllMessages().length() > 0)
 	{ throw pvrvk::ErrorUnknown(pvr::strings::createFormatted("pvr::utils::createShaderModule GlslangToSpv failed. Error log is: %s", logger.getAllMessages().c_str()).c_str()); }
 
-	// Create the shader module using the spirv blob
+	return std::vector<uint32_t>(spirvBlob.begin(), spirvBlob.end());
+}
+
+pvrvk::ShaderModule createShaderModuleFromSpirv(pvrvk::Device& device, const std::vector<uint32_t>& spirv, pvrvk::ShaderModuleCreateFlags flags)
+{
 	pvrvk::ShaderModuleCreateInfo createInfo;
 	createInfo.setFlags(flags);
-	createInfo.setShaderSources(spirvBlob);
-
+	createInfo.setShaderSources(spirv);
 	return device->createShaderModule(createInfo);
 }
+} // namespace
+
+SpirvCache::SpirvCache(const std::string& directory) : _cache(directory, ".spv", isValidSpirvEntry) {}
+
+bool SpirvCache::find(uint64_t key, std::vector<uint32_t>& outSpirv)
+{
+	std::vector<char> data;
+	if (!_cache.find(key, data)) { return false; }
+	outSpirv.resize(data.size() / sizeof(uint32_t));
+	memcpy(outSpirv.data(), data.data(), outSpirv.size() * sizeof(uint32_t));
+	return true;
+}
+
+void SpirvCache::insert(uint64_t key, const std::vector<uint32_t>& spirv)
+{
+	const char* data = reinterpret_cast<const char*>(spirv.data());
+	_cache.insert(key, std::vector<char>(data, data + spirv.size() * sizeof(uint32_t)));
+}
+
+uint64_t computeSpirvCacheKey(pvrvk::Device& device, const std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, const char* const* defines, uint32_t numDefines)
+{
+	glslang::EShTargetClientVersion vulkanClientVersion;
+	glslang::EShTargetLanguageVersion targetSpirvVersion;
+	getTargetVersions(device, vulkanClientVersion, targetSpirvVersion);
+	const pvrvk::PhysicalDeviceProperties& properties = device->getPhysicalDevice()->getProperties();
+	const int spirvGeneratorVersion = glslang::GetSpirvGeneratorVersion();
+	const std::string glslVersion = glslang::GetGlslVersionString();
+
+	const uint32_t header[] = { SpirvCacheVersion, static_cast<uint32_t>(spirvGeneratorVersion), static_cast<uint32_t>(shaderStageFlags),
+		static_cast<uint32_t>(vulkanClientVersion), static_cast<uint32_t>(targetSpirvVersion), properties.getVendorID(), properties.getDeviceID(), properties.getDriverVersion(),
+		numDefines };
+	uint64_t key = hash64_bytes(header, sizeof(header));
+	key = hash64_string(glslVersion, key);
+	for (uint32_t i = 0; i < numDefines; ++i) { key = hash64_bytes(defines[i], strlen(defines[i]) + 1, key); }
+	return hash64_bytes(shaderSource.data(), shaderSource.size(), key);
+}
+
+std::vector<uint32_t> compileShaderToSpirv(
+	pvrvk::Device& device, const std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, const char* const* defines, uint32_t numDefines, SpirvCache* cache)
+{
+	std::vector<uint32_t> spirv;
+	uint64_t key = 0;
+	if (cache)
+	{
+		key = computeSpirvCacheKey(device, shaderSource, shaderStageFlags, defines, numDefines);
+		if (cache->find(key, spirv)) { return spirv; }
+	}
+	spirv = compileWithGlslang(device, shaderSource, shaderStageFlags, defines, numDefines);
+	if (cache) { cache->insert(key, spirv); }
+	return spirv;
+}
+
+pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, pvrvk::ShaderModuleCreateFlags flags,
+	const char* const* defines, uint32_t numDefines, SpirvCache* cache)
+{
+	return createShaderModuleFromSpirv(device, compileShaderToSpirv(device, shaderSource, shaderStageFlags, defines, numDefines, cache), flags);
+}
+
+std::vector<pvrvk::ShaderModule> createShaderModules(pvrvk::Device& device, const ShaderModuleCompileInfo* compileInfos, uint32_t numCompileInfos, SpirvCache* cache)
+{
+	std::vector<pvrvk::ShaderModule> shaderModules(numCompileInfos);
+	async::JobSystem::getInstance().parallelFor(0, numCompileInfos, 1, [&](uint32_t first, uint32_t last) {
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const ShaderModuleCompileInfo& info = compileInfos[i];
+			shaderModules[i] =
+				createShaderModuleFromSpirv(device, compileShaderToSpirv(device, *info.shaderSource, info.shaderStageFlags, info.defines, info.numDefines, cache), info.flags);
+		}
+	});
+	return shaderModules;
+}
 
 pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, const Stream& shaderStream, pvrvk::ShaderStageFlags shaderStageFlags, pvrvk::ShaderModuleCreateFlags flags,
-	const char* const* defines, uint32_t numDefines)
+	const char* const* defines, uint32_t numDefines, SpirvCache* cache)
 {
 	std::string shaderSource;
 	shaderStream.readIntoString(shaderSource);
 
-	return createShaderModule(device, shaderSource, shaderStageFlags, flags, defines, numDefines);
+	return createShaderModule(device, shaderSource, shaderStageFlags, flags, defines, numDefines, cache);
 }
 } // namespace utils
 } // namespace pvr
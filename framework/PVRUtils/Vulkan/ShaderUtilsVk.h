@@ -6,11 +6,103 @@
 */
 #pragma once
 #include "PVRCore/stream/Stream.h"
+#include "PVRCore/stream/FileCache.h"
 #include "PVRVk/DeviceVk.h"
 #include "PVRUtils/Vulkan/HelperVk.h"
 
 namespace pvr {
 namespace utils {
+/// <summary>A content addressed cache of compiled SPIR-V. Entries are keyed by computeSpirvCacheKey, i.e. by a hash of
+/// everything that affects the compilation, so stale entries are never returned and never need to be invalidated.
+/// Entries are kept in memory and, if a directory is provided, also stored on disk (one .spv file per entry) so that
+/// they are reused by later launches. Safe to use from multiple threads.</summary>
+class SpirvCache
+{
+public:
+	/// <summary>Constructor.</summary>
+	/// <param name="directory">A writable directory to persist the cache in, for example Shell::getWritePath(). Leave
+	/// empty for an in-memory only cache.</param>
+	explicit SpirvCache(const std::string& directory = std::string());
+
+	/// <summary>Look up an entry.</summary>
+	/// <param name="key">The key, from computeSpirvCacheKey</param>
+	/// <param name="outSpirv">Receives the SPIR-V if the entry is found</param>
+	/// <returns>True if the entry was found in memory or on disk</returns>
+	bool find(uint64_t key, std::vector<uint32_t>& outSpirv);
+
+	/// <summary>Add an entry. Failure to write it to disk is logged and otherwise ignored.</summary>
+	/// <param name="key">The key, from computeSpirvCacheKey</param>
+	/// <param name="spirv">The SPIR-V</param>
+	void insert(uint64_t key, const std::vector<uint32_t>& spirv);
+
+	/// <summary>Get the directory the cache is persisted in.</summary>
+	/// <returns>The directory, or an empty string for an in-memory cache</returns>
+	const std::string& getDirectory() const { return _cache.getDirectory(); }
+
+	/// <summary>Get the number of successful lookups so far.</summary>
+	/// <returns>The number of cache hits</returns>
+	uint32_t getNumHits() const { return _cache.getNumHits(); }
+
+	/// <summary>Get the number of failed lookups so far.</summary>
+	/// <returns>The number of cache misses</returns>
+	uint32_t getNumMisses() const { return _cache.getNumMisses(); }
+
+private:
+	BinaryFileCache _cache;
+};
+
+/// <summary>Compute the SpirvCache key of a shader: a hash of the source, the defines, the stage, the target Vulkan
+/// and SPIR-V versions, the glslang version and the physical device (which determines the resource limits).</summary>
+/// <param name="device">The device the shader is compiled for</param>
+/// <param name="shaderSource">The shader source</param>
+/// <param name="shaderStageFlags">The stage of the shader</param>
+/// <param name="defines">The preprocessor definitions passed to the shader</param>
+/// <param name="numDefines">The number of defines</param>
+/// <returns>The cache key</returns>
+uint64_t computeSpirvCacheKey(pvrvk::Device& device, const std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, const char* const* defines = nullptr,
+	uint32_t numDefines = 0);
+
+/// <summary>Compile GLSL shader source to SPIR-V using glslang. Safe to call from multiple threads.</summary>
+/// <param name="device">The device the shader is compiled for</param>
+/// <param name="shaderSource">The shader source text</param>
+/// <param name="shaderStageFlags">The type (stage) of the shader (vertex, fragment...)</param>
+/// <param name="defines">A number of preprocessor definitions that will be passed to the shader</param>
+/// <param name="numDefines">The number of defines</param>
+/// <param name="cache">An optional SPIR-V cache. If the shader is found in it, glslang is not invoked at all.</param>
+/// <returns>The SPIR-V</returns>
+std::vector<uint32_t> compileShaderToSpirv(pvrvk::Device& device, const std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, const char* const* defines = nullptr,
+	uint32_t numDefines = 0, SpirvCache* cache = nullptr);
+
+/// <summary>Describes one shader module to create with createShaderModules.</summary>
+struct ShaderModuleCompileInfo
+{
+	const std::string* shaderSource; //!< The shader source text
+	pvrvk::ShaderStageFlags shaderStageFlags; //!< The stage of the shader
+	pvrvk::ShaderModuleCreateFlags flags; //!< The flags to create the ShaderModule with
+	const char* const* defines; //!< The preprocessor definitions passed to the shader
+	uint32_t numDefines; //!< The number of defines
+
+	/// <summary>Constructor.</summary>
+	/// <param name="shaderSource">The shader source text. Must stay valid until createShaderModules returns.</param>
+	/// <param name="shaderStageFlags">The stage of the shader</param>
+	/// <param name="defines">The preprocessor definitions. Must stay valid until createShaderModules returns.</param>
+	/// <param name="numDefines">The number of defines</param>
+	/// <param name="flags">The flags to create the ShaderModule with</param>
+	ShaderModuleCompileInfo(const std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags, const char* const* defines = nullptr, uint32_t numDefines = 0,
+		pvrvk::ShaderModuleCreateFlags flags = pvrvk::ShaderModuleCreateFlags::e_NONE)
+		: shaderSource(&shaderSource), shaderStageFlags(shaderStageFlags), flags(flags), defines(defines), numDefines(numDefines)
+	{}
+};
+
+/// <summary>Create a number of ShaderModules, for example all the stage and define permutations an application uses,
+/// compiling them in parallel on the process-wide JobSystem.</summary>
+/// <param name="device">A device from which to create the ShaderModules</param>
+/// <param name="compileInfos">The shader modules to create</param>
+/// <param name="numCompileInfos">The number of shader modules to create</param>
+/// <param name="cache">An optional SPIR-V cache, consulted and updated for each module</param>
+/// <returns>The created ShaderModules, in the order of compileInfos. Throws if any of the shaders fails to compile.</returns>
+std::vector<pvrvk::ShaderModule> createShaderModules(pvrvk::Device& device, const ShaderModuleCompileInfo* compileInfos, uint32_t numCompileInfos, SpirvCache* cache = nullptr);
+
 /// <summary>Load a ShaderModule from shader source using glslang.</summary>
 /// <param name="device">A device from which to create the ShaderModule</param>
 /// <param name="shaderSource">A string containing the shader source text data</param>
@@ -18,9 +110,10 @@ namespace utils {
 /// <param name="flags">A set of pvrvk::ShaderModuleCreateFlags controlling how the ShaderModule will be created</param>
 /// <param name="defines">A number of preprocessor definitions that will be passed to the shader</param>
 /// <param name="numDefines">The number of defines</param>
+/// <param name="cache">An optional SPIR-V cache. If the shader is found in it, glslang is not invoked at all.</param>
 /// <returns>The created ShaderModule object</returns>
 pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags,
-	pvrvk::ShaderModuleCreateFlags flags = pvrvk::ShaderModuleCreateFlags::e_NONE, const char* const* defines = nullptr, uint32_t numDefines = 0);
+	pvrvk::ShaderModuleCreateFlags flags = pvrvk::ShaderModuleCreateFlags::e_NONE, const char* const* defines = nullptr, uint32_t numDefines = 0, SpirvCache* cache = nullptr);
 
 /// <summary>Load a ShaderModule from shader source using glslang.</summary>
 /// <param name="device">A device from which to create the ShaderModule</param>
@@ -29,8 +122,9 @@ pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, std::string& shade
 /// <param name="flags">A set of pvrvk::ShaderModuleCreateFlags controlling how the ShaderModule will be created</param>
 /// <param name="defines">A number of preprocessor definitions that will be passed to the shader</param>
 /// <param name="numDefines">The number of defines</param>
+/// <param name="cache">An optional SPIR-V cache. If the shader is found in it, glslang is not invoked at all.</param>
 /// <returns>The created ShaderModule object</returns>
 pvrvk::ShaderModule createShaderModule(pvrvk::Device& device, const Stream& shaderSource, pvrvk::ShaderStageFlags shaderStageFlags,
-	pvrvk::ShaderModuleCreateFlags flags = pvrvk::ShaderModuleCreateFlags::e_NONE, const char* const* defines = nullptr, uint32_t numDefines = 0);
+	pvrvk::ShaderModuleCreateFlags flags = pvrvk::ShaderModuleCreateFlags::e_NONE, const char* const* defines = nullptr, uint32_t numDefines = 0, SpirvCache* cache = nullptr);
 } // namespace utils
 } // namespace pvr
@@ -0,0 +1,437 @@
+/*!
+\brief Implementation of the SpriteBatch.
+\file PVRUtils/Vulkan/SpriteBatchVk.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+//!\cond NO_DOXYGEN
+#include "PVRUtils/Vulkan/SpriteBatchVk.h"
+#include "PVRUtils/Vulkan/ShaderUtilsVk.h"
+#include "PVRUtils/Vulkan/HelperVk.h"
+#include "PVRCore/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace pvr {
+namespace ui {
+namespace {
+// The batch shaders are compiled at init, so that the vertex layouts below and the shaders cannot get out of sync.
+const char* const SpriteVertShader = R"(#version 320 es
+layout(location = 0) in highp vec4 inAxes;
+layout(location = 1) in highp vec2 inTranslation;
+layout(location = 2) in mediump vec4 inColor;
+layout(location = 3) in uint inAlphaMode;
+layout(location = 4) in highp vec4 inUVRect;
+
+layout(location = 0) out mediump vec2 texCoord;
+layout(location = 1) out mediump vec4 color;
+layout(location = 2) flat out uint alphaMode;
+
+const vec2 corners[6] = vec2[6](vec2(-1.0, 1.0), vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0));
+
+void main()
+{
+	vec2 corner = corners[gl_VertexIndex];
+	gl_Position = vec4(inAxes.xy * corner.x + inAxes.zw * corner.y + inTranslation, 0.0, 1.0);
+	texCoord = inUVRect.xy + inUVRect.zw * (corner * 0.5 + 0.5);
+	color = inColor;
+	alphaMode = inAlphaMode;
+}
+)";
+
+const char* const TextVertShader = R"(#version 320 es
+layout(location = 0) in highp vec2 inPosition;
+layout(location = 1) in mediump vec2 inUV;
+layout(location = 2) in mediump vec4 inColor;
+
+layout(location = 0) out mediump vec2 texCoord;
+layout(location = 1) out mediump vec4 color;
+layout(location = 2) flat out uint alphaMode;
+
+void main()
+{
+	gl_Position = vec4(inPosition, 0.0, 1.0);
+	texCoord = inUV;
+	color = inColor;
+	alphaMode = 1u;
+}
+)";
+
+const char* const FragShader = R"(#version 320 es
+layout(constant_id = 0) const int sRGB_Output = 0;
+
+layout(set = 0, binding = 0) uniform mediump sampler2D spriteTexture;
+
+layout(location = 0) in mediump vec2 texCoord;
+layout(location = 1) in mediump vec4 color;
+layout(location = 2) flat in uint alphaMode;
+
+layout(location = 0) out mediump vec4 oColor;
+
+void main()
+{
+	mediump vec4 vTex = texture(spriteTexture, texCoord);
+	if (alphaMode != 0u) { oColor = vec4(color.rgb, color.a * vTex.a); }
+	else { oColor = color * vTex; }
+
+	if (sRGB_Output == 0)
+	{
+		oColor.rgb = pow(oColor.rgb, vec3(0.4545454545)); // do gamma correction for linear output.
+	}
+}
+)";
+
+// Sort key layout, from the most significant bit: layer (16), blend mode (4), text flag (1), texture (11), submission order (32).
+const uint32_t MaxTexturesPerFrame = 1u << 11;
+
+// Larger than any nonCoherentAtomSize allowed by the specification, so that flushing a whole slice is always valid.
+const VkDeviceSize SliceAlignment = 256;
+
+uint32_t packColor(const glm::vec4& color)
+{
+	const glm::vec4 c = glm::clamp(color, 0.f, 1.f) * 255.f + .5f;
+	return static_cast<uint32_t>(c.r) | (static_cast<uint32_t>(c.g) << 8) | (static_cast<uint32_t>(c.b) << 16) | (static_cast<uint32_t>(c.a) << 24);
+}
+
+VkDeviceSize alignSlice(VkDeviceSize size) { return (size + SliceAlignment - 1) & ~(SliceAlignment - 1); }
+
+void flushIfNonCoherent(pvrvk::Buffer& buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+	if (static_cast<uint32_t>(buffer->getDeviceMemory()->getMemoryFlags() & pvrvk::MemoryPropertyFlags::e_HOST_COHERENT_BIT) == 0)
+	{ buffer->getDeviceMemory()->flushRange(offset, size); }
+}
+} // namespace
+
+void SpriteBatch::init(UIRenderer& uiRenderer, bool isFrameBufferSrgb, uint32_t numFramesInFlight, uint32_t maxSprites, uint32_t maxTextCharacters)
+{
+	release();
+	_uiRenderer = &uiRenderer;
+	_numFramesInFlight = std::max(numFramesInFlight, 1u);
+	_maxSprites = maxSprites;
+	_maxTextQuads = maxTextCharacters;
+	_currentSlot = 0;
+
+	pvrvk::Device device = uiRenderer.getDevice().lock();
+	createPipelines(isFrameBufferSrgb);
+
+	const pvrvk::MemoryPropertyFlags memoryFlags = pvrvk::MemoryPropertyFlags::e_HOST_VISIBLE_BIT;
+	_instanceSliceSize = alignSlice(sizeof(SpriteInstance) * std::max(_maxSprites, 1u));
+	_instanceBuffer = utils::createBuffer(device, pvrvk::BufferCreateInfo(_instanceSliceSize * _numFramesInFlight, pvrvk::BufferUsageFlags::e_VERTEX_BUFFER_BIT), memoryFlags,
+		memoryFlags | pvrvk::MemoryPropertyFlags::e_HOST_COHERENT_BIT, uiRenderer.getMemoryAllocator(), utils::vma::AllocationCreateFlags::e_MAPPED_BIT);
+	_instanceBuffer->setObjectName("PVRUtilsVk::SpriteBatch::InstanceBuffer");
+
+	_textSliceSize = alignSlice(sizeof(TextVertex) * 4 * std::max(_maxTextQuads, 1u));
+	_textBuffer = utils::createBuffer(device, pvrvk::BufferCreateInfo(_textSliceSize * _numFramesInFlight, pvrvk::BufferUsageFlags::e_VERTEX_BUFFER_BIT), memoryFlags,
+		memoryFlags | pvrvk::MemoryPropertyFlags::e_HOST_COHERENT_BIT, uiRenderer.getMemoryAllocator(), utils::vma::AllocationCreateFlags::e_MAPPED_BIT);
+	_textBuffer->setObjectName("PVRUtilsVk::SpriteBatch::TextBuffer");
+
+	_spriteInstances.reserve(_maxSprites);
+	_textVertices.reserve(4 * _maxTextQuads);
+	_items.reserve(_maxSprites);
+}
+
+void SpriteBatch::createPipelines(bool isFrameBufferSrgb)
+{
+	pvrvk::Device device = _uiRenderer->getDevice().lock();
+
+	pvrvk::PipelineLayoutCreateInfo pipeLayoutInfo;
+	pipeLayoutInfo.addDescSetLayout(_uiRenderer->getTexDescriptorSetLayout());
+	_pipelineLayout = device->createPipelineLayout(pipeLayoutInfo);
+	_pipelineLayout->setObjectName("PVRUtilsVk::SpriteBatch::PipelineLayout");
+
+	std::string spriteVertSource(SpriteVertShader);
+	std::string textVertSource(TextVertShader);
+	std::string fragSource(FragShader);
+	const utils::ShaderModuleCompileInfo compileInfos[] = {
+		utils::ShaderModuleCompileInfo(spriteVertSource, pvrvk::ShaderStageFlags::e_VERTEX_BIT),
+		utils::ShaderModuleCompileInfo(textVertSource, pvrvk::ShaderStageFlags::e_VERTEX_BIT),
+		utils::ShaderModuleCompileInfo(fragSource, pvrvk::ShaderStageFlags::e_FRAGMENT_BIT),
+	};
+	std::vector<pvrvk::ShaderModule> shaders = utils::createShaderModules(device, compileInfos, ARRAY_SIZE(compileInfos));
+
+	// Everything but the vertex input and the blend state matches the UIRenderer pipeline.
+	const pvrvk::RenderPass& renderPass = _uiRenderer->_renderpass;
+	pvrvk::GraphicsPipelineCreateInfo pipelineDesc;
+	pipelineDesc.pipelineLayout = _pipelineLayout;
+	pipelineDesc.fragmentShader.setShader(shaders[2]);
+	for (uint32_t i = 1; i < renderPass->getCreateInfo().getSubpass(_uiRenderer->_subpass).getNumColorAttachmentReference(); ++i)
+	{ pipelineDesc.colorBlend.setAttachmentState(i, pvrvk::PipelineColorBlendAttachmentState()); }
+	pipelineDesc.depthStencil.enableDepthTest(false).enableDepthWrite(false);
+	pipelineDesc.rasterizer.setCullMode(pvrvk::CullModeFlags::e_NONE);
+	pipelineDesc.inputAssembler.setPrimitiveTopology(pvrvk::PrimitiveTopology::e_TRIANGLE_LIST);
+	const glm::vec2 dimensions = _uiRenderer->getRenderingDim();
+	pipelineDesc.viewport.setViewportAndScissor(0, pvrvk::Viewport(0, 0, dimensions.x, dimensions.y),
+		pvrvk::Rect2D(pvrvk::Offset2D(0, 0), pvrvk::Extent2D(static_cast<uint32_t>(dimensions.x), static_cast<uint32_t>(dimensions.y))));
+	pipelineDesc.renderPass = renderPass;
+	pipelineDesc.subpass = _uiRenderer->_subpass;
+	pipelineDesc.multiSample.setNumRasterizationSamples(renderPass->getCreateInfo().getAttachmentDescription(0).getSamples());
+	const int32_t shaderConst = static_cast<int32_t>(isFrameBufferSrgb);
+	pipelineDesc.fragmentShader.setShaderConstant(0, pvrvk::ShaderConstantInfo(0, &shaderConst, static_cast<uint32_t>(pvr::getSize(pvr::GpuDatatypes::Integer))));
+
+	const pvrvk::ColorComponentFlags writeMask =
+		pvrvk::ColorComponentFlags::e_R_BIT | pvrvk::ColorComponentFlags::e_G_BIT | pvrvk::ColorComponentFlags::e_B_BIT | pvrvk::ColorComponentFlags::e_A_BIT;
+	const pvrvk::PipelineColorBlendAttachmentState blendStates[] = {
+		pvrvk::PipelineColorBlendAttachmentState(true, pvrvk::BlendFactor::e_SRC_ALPHA, pvrvk::BlendFactor::e_ONE_MINUS_SRC_ALPHA, pvrvk::BlendOp::e_ADD,
+			pvrvk::BlendFactor::e_ZERO, pvrvk::BlendFactor::e_ONE, pvrvk::BlendOp::e_ADD, writeMask),
+		pvrvk::PipelineColorBlendAttachmentState(true, pvrvk::BlendFactor::e_SRC_ALPHA, pvrvk::BlendFactor::e_ONE, pvrvk::BlendOp::e_ADD, pvrvk::BlendFactor::e_ZERO,
+			pvrvk::BlendFactor::e_ONE, pvrvk::BlendOp::e_ADD, writeMask),
+		pvrvk::PipelineColorBlendAttachmentState(false, pvrvk::BlendFactor::e_ONE, pvrvk::BlendFactor::e_ZERO, pvrvk::BlendOp::e_ADD, pvrvk::BlendFactor::e_ONE,
+			pvrvk::BlendFactor::e_ZERO, pvrvk::BlendOp::e_ADD, writeMask),
+	};
+
+	// Sprites: one instance per sprite, the quad corners are generated from gl_VertexIndex.
+	pipelineDesc.vertexShader.setShader(shaders[0]);
+	pipelineDesc.vertexInput.addInputBinding(pvrvk::VertexInputBindingDescription(0, sizeof(SpriteInstance), pvrvk::VertexInputRate::e_INSTANCE))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(0, 0, pvrvk::Format::e_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, axes)))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(1, 0, pvrvk::Format::e_R32G32_SFLOAT, offsetof(SpriteInstance, translation)))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(2, 0, pvrvk::Format::e_R8G8B8A8_UNORM, offsetof(SpriteInstance, color)))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(3, 0, pvrvk::Format::e_R32_UINT, offsetof(SpriteInstance, alphaMode)))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(4, 0, pvrvk::Format::e_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, uvRect)));
+	for (uint32_t i = 0; i < static_cast<uint32_t>(SpriteBlendMode::Count); ++i)
+	{
+		pipelineDesc.colorBlend.setAttachmentState(0, blendStates[i]);
+		_spritePipelines[i] = device->createGraphicsPipeline(pipelineDesc, _uiRenderer->_pipelineCache);
+		_spritePipelines[i]->setObjectName("PVRUtilsVk::SpriteBatch::SpritePipeline" + std::to_string(i));
+	}
+
+	// Texts: pre-transformed vertices, indexed with the UIRenderer font index buffer.
+	pipelineDesc.vertexShader.setShader(shaders[1]);
+	pipelineDesc.vertexInput.clear();
+	pipelineDesc.vertexInput.addInputBinding(pvrvk::VertexInputBindingDescription(0, sizeof(TextVertex), pvrvk::VertexInputRate::e_VERTEX))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(0, 0, pvrvk::Format::e_R32G32_SFLOAT, offsetof(TextVertex, position)))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(1, 0, pvrvk::Format::e_R32G32_SFLOAT, offsetof(TextVertex, uv)))
+		.addInputAttribute(pvrvk::VertexInputAttributeDescription(2, 0, pvrvk::Format::e_R8G8B8A8_UNORM, offsetof(TextVertex, color)));
+	pipelineDesc.colorBlend.setAttachmentState(0, blendStates[static_cast<uint32_t>(SpriteBlendMode::Alpha)]);
+	_textPipeline = device->createGraphicsPipeline(pipelineDesc, _uiRenderer->_pipelineCache);
+	_textPipeline->setObjectName("PVRUtilsVk::SpriteBatch::TextPipeline");
+}
+
+void SpriteBatch::release()
+{
+	_textPipeline.reset();
+	for (pvrvk::GraphicsPipeline& pipeline : _spritePipelines) { pipeline.reset(); }
+	_pipelineLayout.reset();
+	_instanceBuffer.reset();
+	_textBuffer.reset();
+	_spriteInstances.clear();
+	_textVertices.clear();
+	_texts.clear();
+	_items.clear();
+	_textures.clear();
+	_textureIds.clear();
+	_batches.clear();
+	_uiRenderer = nullptr;
+	_isRecording = false;
+}
+
+void SpriteBatch::begin(uint32_t frameSlot)
+{
+	if (!isInitialized()) { throw UIRendererError("SpriteBatch: begin called before init."); }
+	_currentSlot = frameSlot % _numFramesInFlight;
+	_viewProj = _uiRenderer->getScreenRotation() * _uiRenderer->getProjection();
+	_spriteInstances.clear();
+	_textVertices.clear();
+	_texts.clear();
+	_items.clear();
+	_textures.clear();
+	_textureIds.clear();
+	_isRecording = true;
+}
+
+uint32_t SpriteBatch::getTextureId(const pvrvk::DescriptorSet& descriptorSet)
+{
+	auto it = _textureIds.find(descriptorSet.get());
+	if (it != _textureIds.end()) { return it->second; }
+	if (_textures.size() >= MaxTexturesPerFrame) { throw UIRendererInstanceMaxError("SpriteBatch: Too many distinct textures in a single frame."); }
+	const uint32_t id = static_cast<uint32_t>(_textures.size());
+	_textures.emplace_back(descriptorSet);
+	_textureIds[descriptorSet.get()] = id;
+	return id;
+}
+
+void SpriteBatch::addItem(uint16_t layer, SpriteBlendMode blendMode, uint32_t textureId, uint32_t index, bool isText)
+{
+	Item item;
+	item.key = (static_cast<uint64_t>(layer) << 48) | (static_cast<uint64_t>(blendMode) << 44) | (static_cast<uint64_t>(isText) << 43) |
+		(static_cast<uint64_t>(textureId) << 32) | static_cast<uint64_t>(_items.size());
+	item.index = index;
+	item.textureId = textureId;
+	item.blendMode = blendMode;
+	item.isText = isText;
+	_items.emplace_back(item);
+}
+
+void SpriteBatch::draw(const Image& image, SpriteBlendMode blendMode, uint16_t layer)
+{
+	debug_assertion(_isRecording, "SpriteBatch: draw called outside begin/end");
+	if (_spriteInstances.size() >= _maxSprites) { throw UIRendererInstanceMaxError("SpriteBatch: Maximum number of sprites per frame exceeded."); }
+	auto mvp = image->_mvpData.find(0);
+	if (mvp == image->_mvpData.end()) { throw UIRendererError("SpriteBatch: Images must be committed (and not only part of a group) to be drawn."); }
+
+	// The quad corners are at +-1, so the first two columns of the mvp are the clip space half-extents.
+	const glm::mat4& m = mvp->second.mvp;
+	SpriteInstance instance;
+	instance.axes = glm::vec4(m[0][0], m[0][1], m[1][0], m[1][1]);
+	instance.translation = glm::vec2(m[3]);
+	instance.color = packColor(image->_color);
+	instance.alphaMode = static_cast<uint32_t>(image->_alphaMode);
+	instance.uvRect = glm::vec4(image->_uv.getOffset().getX(), image->_uv.getOffset().getY(), image->_uv.getExtent().getWidth(), image->_uv.getExtent().getHeight());
+
+	addItem(layer, blendMode, getTextureId(image->getTexDescriptorSet()), static_cast<uint32_t>(_spriteInstances.size()), false);
+	_spriteInstances.emplace_back(instance);
+}
+
+void SpriteBatch::draw(const Image& image, const glm::vec2& position, const glm::vec2& scale, float rotation, const glm::vec4& color, SpriteBlendMode blendMode, uint16_t layer)
+{
+	debug_assertion(_isRecording, "SpriteBatch: draw called outside begin/end");
+	if (_spriteInstances.size() >= _maxSprites) { throw UIRendererInstanceMaxError("SpriteBatch: Maximum number of sprites per frame exceeded."); }
+
+	// viewProj * translate(position) * rotate(rotation) * scale(halfExtent), without building the intermediate matrices.
+	const glm::vec2 halfExtent = glm::vec2(image->getWidth(), image->getHeight()) * scale * .5f;
+	const float c = std::cos(rotation);
+	const float s = std::sin(rotation);
+	const glm::vec2 xAxis = glm::vec2(_viewProj * glm::vec4(c * halfExtent.x, s * halfExtent.x, 0.f, 0.f));
+	const glm::vec2 yAxis = glm::vec2(_viewProj * glm::vec4(-s * halfExtent.y, c * halfExtent.y, 0.f, 0.f));
+
+	SpriteInstance instance;
+	instance.axes = glm::vec4(xAxis, yAxis);
+	instance.translation = glm::vec2(_viewProj * glm::vec4(position, 0.f, 1.f));
+	instance.color = packColor(color);
+	instance.alphaMode = static_cast<uint32_t>(image->_alphaMode);
+	instance.uvRect = glm::vec4(image->_uv.getOffset().getX(), image->_uv.getOffset().getY(), image->_uv.getExtent().getWidth(), image->_uv.getExtent().getHeight());
+
+	addItem(layer, blendMode, getTextureId(image->getTexDescriptorSet()), static_cast<uint32_t>(_spriteInstances.size()), false);
+	_spriteInstances.emplace_back(instance);
+}
+
+void SpriteBatch::draw(const Text& text, uint16_t layer)
+{
+	debug_assertion(_isRecording, "SpriteBatch: draw called outside begin/end");
+	const impl::TextElement_& element = *text->_textElement;
+	element.updateText();
+	auto mvp = text->_mvpData.find(0);
+	if (mvp == text->_mvpData.end()) { throw UIRendererError("SpriteBatch: Texts must be committed (and not only part of a group) to be drawn."); }
+
+	const uint32_t numQuads = static_cast<uint32_t>(element._numCachedVerts) / 4;
+	if (!numQuads) { return; }
+	const uint32_t firstQuad = static_cast<uint32_t>(_textVertices.size()) / 4;
+	if (firstQuad + numQuads > _maxTextQuads) { throw UIRendererInstanceMaxError("SpriteBatch: Maximum number of text characters per frame exceeded."); }
+
+	// Transform the glyph quads to clip space here, so that texts with different transforms can share a draw.
+	const glm::mat4& m = mvp->second.mvp;
+	const glm::vec2 xAxis(m[0]);
+	const glm::vec2 yAxis(m[1]);
+	const glm::vec2 translation(m[3]);
+	const uint32_t color = packColor(text->_color);
+	const impl::Vertex* source = element._vertices.data();
+	_textVertices.resize(_textVertices.size() + 4 * numQuads);
+	TextVertex* destination = &_textVertices[4 * firstQuad];
+	for (uint32_t i = 0; i < 4 * numQuads; ++i)
+	{
+		destination[i].position = xAxis * source[i].x + yAxis * source[i].y + translation;
+		destination[i].uv = glm::vec2(source[i].tu, source[i].tv);
+		destination[i].color = color;
+	}
+
+	TextItem item;
+	item.firstQuad = firstQuad;
+	item.numQuads = numQuads;
+	addItem(layer, SpriteBlendMode::Alpha, getTextureId(text->getTexDescriptorSet()), static_cast<uint32_t>(_texts.size()), true);
+	_texts.emplace_back(item);
+}
+
+void SpriteBatch::end(pvrvk::CommandBufferBase commandBuffer)
+{
+	PVR_PROFILE_SCOPE("SpriteBatch::end");
+	if (!_isRecording) { throw UIRendererError("SpriteBatch: end called without begin."); }
+	_isRecording = false;
+	_numDrawCalls = 0;
+	if (_items.empty()) { return; }
+
+	std::sort(_items.begin(), _items.end(), [](const Item& a, const Item& b) { return a.key < b.key; });
+
+	// Write the streams in sorted order, merging consecutive items that share a pipeline and texture.
+	SpriteInstance* instances = reinterpret_cast<SpriteInstance*>(static_cast<uint8_t*>(_instanceBuffer->getDeviceMemory()->getMappedData()) + _instanceSliceSize * _currentSlot);
+	TextVertex* textVertices = reinterpret_cast<TextVertex*>(static_cast<uint8_t*>(_textBuffer->getDeviceMemory()->getMappedData()) + _textSliceSize * _currentSlot);
+	uint32_t numInstances = 0;
+	uint32_t numQuads = 0;
+	_batches.clear();
+	for (const Item& item : _items)
+	{
+		uint32_t first;
+		uint32_t count;
+		if (item.isText)
+		{
+			const TextItem& text = _texts[item.index];
+			memcpy(textVertices + 4 * numQuads, &_textVertices[4 * text.firstQuad], sizeof(TextVertex) * 4 * text.numQuads);
+			first = numQuads;
+			count = text.numQuads;
+			numQuads += count;
+		}
+		else
+		{
+			instances[numInstances] = _spriteInstances[item.index];
+			first = numInstances;
+			count = 1;
+			++numInstances;
+		}
+
+		if (!_batches.empty() && _batches.back().textureId == item.textureId && _batches.back().blendMode == item.blendMode && _batches.back().isText == item.isText)
+		{ _batches.back().count += count; }
+		else
+		{
+			DrawBatch batch;
+			batch.textureId = item.textureId;
+			batch.blendMode = item.blendMode;
+			batch.isText = item.isText;
+			batch.first = first;
+			batch.count = count;
+			_batches.emplace_back(batch);
+		}
+	}
+	if (numInstances) { flushIfNonCoherent(_instanceBuffer, _instanceSliceSize * _currentSlot, _instanceSliceSize); }
+	if (numQuads) { flushIfNonCoherent(_textBuffer, _textSliceSize * _currentSlot, _textSliceSize); }
+
+	utils::beginCommandBufferDebugLabel(commandBuffer, pvrvk::DebugUtilsLabel("PVRUtilsVk::SpriteBatch"));
+	for (uint32_t i = 0; i < _batches.size(); ++i) { recordBatch(commandBuffer, _batches[i], i ? &_batches[i - 1] : nullptr); }
+	utils::endCommandBufferDebugLabel(commandBuffer);
+}
+
+void SpriteBatch::recordBatch(pvrvk::CommandBufferBase& commandBuffer, const DrawBatch& batch, const DrawBatch* previous)
+{
+	const bool pipelineChanged = !previous || previous->isText != batch.isText || previous->blendMode != batch.blendMode;
+	if (pipelineChanged) { commandBuffer->bindPipeline(batch.isText ? _textPipeline : _spritePipelines[static_cast<uint32_t>(batch.blendMode)]); }
+	if (!previous || previous->isText != batch.isText)
+	{
+		if (batch.isText)
+		{
+			commandBuffer->bindVertexBuffer(_textBuffer, static_cast<uint32_t>(_textSliceSize * _currentSlot), 0);
+			commandBuffer->bindIndexBuffer(_uiRenderer->getFontIbo(), 0, pvrvk::IndexType::e_UINT16);
+		}
+		else
+		{
+			commandBuffer->bindVertexBuffer(_instanceBuffer, static_cast<uint32_t>(_instanceSliceSize * _currentSlot), 0);
+		}
+	}
+	if (pipelineChanged || previous->textureId != batch.textureId)
+	{ commandBuffer->bindDescriptorSet(pvrvk::PipelineBindPoint::e_GRAPHICS, _pipelineLayout, 0, _textures[batch.textureId], nullptr, 0); }
+
+	if (!batch.isText)
+	{
+		commandBuffer->draw(0, 6, batch.first, batch.count);
+		++_numDrawCalls;
+		return;
+	}
+	// The 16 bit font index buffer addresses MaxRenderableLetters quads, so larger runs are split and rebased with the vertex offset.
+	for (uint32_t quad = 0; quad < batch.count; quad += impl::Font_::MaxRenderableLetters)
+	{
+		const uint32_t count = std::min<uint32_t>(batch.count - quad, impl::Font_::MaxRenderableLetters);
+		commandBuffer->drawIndexed(0, count * 6, static_cast<int32_t>(4 * (batch.first + quad)));
+		++_numDrawCalls;
+	}
+}
+} // namespace ui
+} // namespace pvr
+//!\endcond
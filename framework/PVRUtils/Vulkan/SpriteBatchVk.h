@@ -0,0 +1,177 @@
+/*!
+\brief Contains the SpriteBatch, which renders large numbers of UIRenderer images and texts with a few instanced draws.
+\file PVRUtils/Vulkan/SpriteBatchVk.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRUtils/Vulkan/UIRendererVk.h"
+#include <unordered_map>
+
+namespace pvr {
+namespace ui {
+/// <summary>The blend states a SpriteBatch can draw sprites with.</summary>
+enum class SpriteBlendMode : uint8_t
+{
+	Alpha, //!< Standard alpha blending (the UIRenderer default)
+	Additive, //!< Color is scaled by alpha and added to the destination
+	Opaque, //!< No blending
+	Count
+};
+
+/// <summary>A batched backend for the UIRenderer. Instead of binding a descriptor set, two dynamic uniform buffers and a
+/// vertex buffer and issuing a draw for every Image and Text, all the sprites drawn between begin() and end() are
+/// collected, sorted by layer, blend state and texture, and rendered with one instanced draw per run of sprites sharing
+/// a texture (or atlas) and blend state. Texts sharing a font are likewise merged into a single indexed draw.</summary>
+/// <remarks>Sprite transforms and colors are written to a persistently mapped instance stream, and text quads to a
+/// persistently mapped vertex stream. Both are split into one slice per frame in flight, so writing a frame never
+/// stalls on the GPU reading a previous one. The batch uses the textures, samplers and render pass of the UIRenderer it
+/// is created from, and draws Images and Texts with the transforms computed by their last commitUpdates(). Within a
+/// layer, sprites are reordered by blend state and texture: use layers wherever overlapping translucent sprites must
+/// keep their relative order.</remarks>
+class SpriteBatch
+{
+public:
+	/// <summary>Constructor. Creates an uninitialised batch. Call init() before use.</summary>
+	SpriteBatch()
+		: _uiRenderer(nullptr), _instanceSliceSize(0), _textSliceSize(0), _numFramesInFlight(0), _maxSprites(0), _maxTextQuads(0), _currentSlot(0), _numDrawCalls(0),
+		  _isRecording(false)
+	{}
+
+	/// <summary>Create the pipelines and the instance and text streams.</summary>
+	/// <param name="uiRenderer">An initialised UIRenderer. Must outlive the batch.</param>
+	/// <param name="isFrameBufferSrgb">Whether the framebuffer is sRGB. Must match the value passed to UIRenderer::init.</param>
+	/// <param name="numFramesInFlight">The number of frames that can be in flight (normally the swapchain length)</param>
+	/// <param name="maxSprites">The maximum number of sprites per frame</param>
+	/// <param name="maxTextCharacters">The maximum number of text characters per frame</param>
+	void init(UIRenderer& uiRenderer, bool isFrameBufferSrgb, uint32_t numFramesInFlight, uint32_t maxSprites = 16384, uint32_t maxTextCharacters = 16384);
+
+	/// <summary>Query if the batch has been initialised.</summary>
+	/// <returns>True if init() has been called</returns>
+	bool isInitialized() const { return _uiRenderer != nullptr; }
+
+	/// <summary>Release all the Vulkan objects of the batch.</summary>
+	void release();
+
+	/// <summary>Start collecting the sprites of a frame.</summary>
+	/// <param name="frameSlot">The index of the frame in flight, in [0, numFramesInFlight). The previous submission that
+	/// used this slot must have completed (normally after waiting for the per swapchain image fence).</param>
+	void begin(uint32_t frameSlot);
+
+	/// <summary>Draw an Image with its own position, anchor, scale, rotation, UVs and color, as set up by its last
+	/// commitUpdates(). Images that are part of a group are not supported.</summary>
+	/// <param name="image">The image</param>
+	/// <param name="blendMode">The blend state</param>
+	/// <param name="layer">Sprites are rendered in increasing layer order</param>
+	void draw(const Image& image, SpriteBlendMode blendMode = SpriteBlendMode::Alpha, uint16_t layer = 0);
+
+	/// <summary>Draw an Image at an explicit position. Only the texture and UVs of the Image are used, so the same
+	/// Image can be drawn any number of times per frame.</summary>
+	/// <param name="image">The image</param>
+	/// <param name="position">The position of the center of the sprite, in pixels from the bottom left of the screen</param>
+	/// <param name="scale">The scale. At a scale of 1, the sprite covers the image's size in pixels.</param>
+	/// <param name="rotation">The rotation around the center of the sprite, in radians</param>
+	/// <param name="color">The color the texture is multiplied with</param>
+	/// <param name="blendMode">The blend state</param>
+	/// <param name="layer">Sprites are rendered in increasing layer order</param>
+	void draw(const Image& image, const glm::vec2& position, const glm::vec2& scale = glm::vec2(1.f), float rotation = 0.f, const glm::vec4& color = glm::vec4(1.f),
+		SpriteBlendMode blendMode = SpriteBlendMode::Alpha, uint16_t layer = 0);
+
+	/// <summary>Draw a Text with its own position, anchor, scale, rotation and color, as set up by its last
+	/// commitUpdates(). Texts that are part of a group are not supported.</summary>
+	/// <param name="text">The text</param>
+	/// <param name="layer">Sprites are rendered in increasing layer order</param>
+	void draw(const Text& text, uint16_t layer = 0);
+
+	/// <summary>Sort the sprites collected since begin(), write them to the streams and record the draws. Must be called
+	/// inside the UIRenderer's render pass and subpass.</summary>
+	/// <param name="commandBuffer">The command buffer to record the draws into</param>
+	void end(pvrvk::CommandBufferBase commandBuffer);
+
+	/// <summary>Get the number of draws recorded by the last end().</summary>
+	/// <returns>The number of draws</returns>
+	uint32_t getNumDrawCalls() const { return _numDrawCalls; }
+
+	/// <summary>Get the number of sprites (images and texts) collected since the last begin().</summary>
+	/// <returns>The number of sprites</returns>
+	uint32_t getNumSprites() const { return static_cast<uint32_t>(_items.size()); }
+
+	/// <summary>Get the maximum number of sprites per frame.</summary>
+	/// <returns>The maximum number of sprites per frame</returns>
+	uint32_t getMaxSprites() const { return _maxSprites; }
+
+private:
+	// Matches the per instance vertex input of the sprite pipelines.
+	struct SpriteInstance
+	{
+		glm::vec4 axes; // The clip space images of the x and y half-extents of the quad
+		glm::vec2 translation; // The clip space position of the center of the quad
+		uint32_t color; // RGBA8
+		uint32_t alphaMode; // Non-zero to only use the alpha channel of the texture
+		glm::vec4 uvRect; // UV offset and extent
+	};
+
+	// Matches the vertex input of the text pipeline.
+	struct TextVertex
+	{
+		glm::vec2 position; // Clip space
+		glm::vec2 uv;
+		uint32_t color; // RGBA8
+	};
+
+	struct Item
+	{
+		uint64_t key; // Layer, blend mode, texture and submission order, from the most to the least significant bits
+		uint32_t index; // Into _spriteInstances, or _texts for text items
+		uint32_t textureId;
+		SpriteBlendMode blendMode;
+		bool isText;
+	};
+
+	struct TextItem
+	{
+		uint32_t firstQuad; // Into _textVertices, in quads
+		uint32_t numQuads;
+	};
+
+	struct DrawBatch
+	{
+		uint32_t textureId;
+		SpriteBlendMode blendMode;
+		bool isText;
+		uint32_t first; // Instance for sprites, quad for texts
+		uint32_t count;
+	};
+
+	uint32_t getTextureId(const pvrvk::DescriptorSet& descriptorSet);
+	void addItem(uint16_t layer, SpriteBlendMode blendMode, uint32_t textureId, uint32_t index, bool isText);
+	void recordBatch(pvrvk::CommandBufferBase& commandBuffer, const DrawBatch& batch, const DrawBatch* previous);
+	void createPipelines(bool isFrameBufferSrgb);
+
+	UIRenderer* _uiRenderer;
+	pvrvk::PipelineLayout _pipelineLayout;
+	pvrvk::GraphicsPipeline _spritePipelines[static_cast<uint32_t>(SpriteBlendMode::Count)];
+	pvrvk::GraphicsPipeline _textPipeline;
+	pvrvk::Buffer _instanceBuffer;
+	pvrvk::Buffer _textBuffer;
+	VkDeviceSize _instanceSliceSize;
+	VkDeviceSize _textSliceSize;
+	glm::mat4 _viewProj;
+	uint32_t _numFramesInFlight;
+	uint32_t _maxSprites;
+	uint32_t _maxTextQuads;
+	uint32_t _currentSlot;
+	uint32_t _numDrawCalls;
+	bool _isRecording;
+
+	// Per frame scratch data, kept to avoid reallocating every frame.
+	std::vector<SpriteInstance> _spriteInstances;
+	std::vector<TextVertex> _textVertices;
+	std::vector<TextItem> _texts;
+	std::vector<Item> _items;
+	std::vector<pvrvk::DescriptorSet> _textures;
+	std::unordered_map<const void*, uint32_t> _textureIds;
+	std::vector<DrawBatch> _batches;
+};
+} // namespace ui
+} // namespace pvr
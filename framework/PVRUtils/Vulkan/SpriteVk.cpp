@@ -13,6 +13,7 @@ MatrixGroup_)
 #include "PVRVk/SamplerVk.h"
 #include "PVRVk/ImageVk.h"
 #include "PVRCore/strings/UnicodeConverter.h"
+#include "PVRCore/Simd.h"
 
 using glm::vec2;
 using glm::vec3;
@@ -31,6 +32,46 @@ namespace pvr {
 namespace ui {
 using namespace ::pvrvk;
 namespace impl {
+namespace {
+static_assert(sizeof(Vertex) == sizeof(float) * 6, "The glyph quads are written as arrays of floats");
+
+// Write the 4 vertices of a glyph quad offset by the pen position. The quad is 24 floats, and x and y sit at the same
+// positions of every 12 float (3 vector) block, so this is 6 vector adds with 2 constant offset vectors.
+inline void writeGlyphQuad(Vertex* destination, const Font_::GlyphQuad& quad, float x, float y)
+{
+	const float* source = quad.vertices;
+	float* output = &destination->x;
+#if defined(PVR_SIMD_SSE)
+	const __m128 offsetA = _mm_setr_ps(x, y, 0.f, 0.f); // x0 y0 z0 w0 | x2 y2 z2 w2
+	const __m128 offsetB = _mm_setr_ps(0.f, 0.f, x, y); // u0 v0 x1 y1 | u2 v2 x3 y3
+	for (uint32_t i = 0; i < 24; i += 12)
+	{
+		_mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(source + i), offsetA));
+		_mm_storeu_ps(output + i + 4, _mm_add_ps(_mm_loadu_ps(source + i + 4), offsetB));
+		_mm_storeu_ps(output + i + 8, _mm_loadu_ps(source + i + 8)); // z1 w1 u1 v1 | z3 w3 u3 v3
+	}
+#elif defined(PVR_SIMD_NEON)
+	const float offsetsA[4] = { x, y, 0.f, 0.f };
+	const float offsetsB[4] = { 0.f, 0.f, x, y };
+	const float32x4_t offsetA = vld1q_f32(offsetsA);
+	const float32x4_t offsetB = vld1q_f32(offsetsB);
+	for (uint32_t i = 0; i < 24; i += 12)
+	{
+		vst1q_f32(output + i, vaddq_f32(vld1q_f32(source + i), offsetA));
+		vst1q_f32(output + i + 4, vaddq_f32(vld1q_f32(source + i + 4), offsetB));
+		vst1q_f32(output + i + 8, vld1q_f32(source + i + 8));
+	}
+#else
+	memcpy(output, source, sizeof(quad.vertices));
+	for (uint32_t i = 0; i < 24; i += 6)
+	{
+		output[i] += x;
+		output[i + 1] += y;
+	}
+#endif
+}
+} // namespace
+
 struct UboData
 {
 	glm::mat4 mvp;
@@ -224,41 +265,50 @@ void Font_::loadFontData(const Texture& texture)
 
 		if (found != metaDataMap.end()) { memcpy(&_kerningPairs[0], found->second.getData(), found->second.getDataSize()); }
 	}
+	buildLookupTables();
 }
 
-uint32_t Font_::findCharacter(uint32_t character) const
-{
-	uint32_t* item = reinterpret_cast<uint32_t*>(bsearch(&character, &_characters[0], _characters.size(), sizeof(uint32_t), characterCompFunc));
-
-	if (!item) { return static_cast<uint32_t>(InvalidChar); }
-
-	uint32_t index = static_cast<uint32_t>(item - &_characters[0]);
-	return index;
-}
-
-void Font_::applyKerning(uint32_t charA, uint32_t charB, float& offset)
+void Font_::buildLookupTables()
 {
-	if (_kerningPairs.size())
+	for (uint32_t& index : _directLookup) { index = static_cast<uint32_t>(InvalidChar); }
+	_characterLookup.clear();
+	for (uint32_t i = 0; i < _characters.size(); ++i)
 	{
-		uint64_t uiPairToSearch = (static_cast<uint64_t>(charA) << 32) | static_cast<uint64_t>(charB);
-		KerningPair* pItem = (KerningPair*)bsearch(&uiPairToSearch, &_kerningPairs[0], _kerningPairs.size(), sizeof(KerningPair), kerningCompFunc);
-
-		if (pItem) { offset += static_cast<float>(pItem->offset); }
+		if (_characters[i] < DirectLookupSize) { _directLookup[_characters[i]] = i; }
+		else
+		{
+			_characterLookup[_characters[i]] = i;
+		}
 	}
-}
-
-int32_t Font_::characterCompFunc(const void* a, const void* b) { return (*static_cast<const int32_t*>(a) - *static_cast<const int32_t*>(b)); }
-
-int32_t Font_::kerningCompFunc(const void* a, const void* b)
-{
-	KerningPair* pPairA = (KerningPair*)a;
-	KerningPair* pPairB = (KerningPair*)b;
-
-	if (pPairA->pair > pPairB->pair) { return 1; }
 
-	if (pPairA->pair < pPairB->pair) { return -1; }
+	_glyphQuads.resize(_characters.size());
+	for (uint32_t i = 0; i < _characters.size(); ++i)
+	{
+		// Rounded the same way the vertices have always been, so that adding the (integer) pen position is exact.
+		const float left = glm::round(static_cast<float>(_charMetrics[i].xOff));
+		const float right = left + glm::round(static_cast<float>(_rects[i].getExtent().getWidth()));
+		const float top = static_cast<float>(_yOffsets[i]);
+		const float bottom = top - glm::round(static_cast<float>(_rects[i].getExtent().getHeight()));
+		const CharacterUV& uv = _characterUVs[i];
+		const float vertices[24] = {
+			left, top, 0.f, 1.f, uv.ul, uv.vt, // top left
+			right, top, 0.f, 1.f, uv.ur, uv.vt, // top right
+			left, bottom, 0.f, 1.f, uv.ul, uv.vb, // bottom left
+			right, bottom, 0.f, 1.f, uv.ur, uv.vb, // bottom right
+		};
+		memcpy(_glyphQuads[i].vertices, vertices, sizeof(vertices));
+		_glyphQuads[i].advance = static_cast<float>(_charMetrics[i].characterWidth);
+		_glyphQuads[i].hasKerning = false;
+	}
 
-	return 0;
+	_kerningLookup.clear();
+	_kerningLookup.reserve(_kerningPairs.size());
+	for (const KerningPair& kerningPair : _kerningPairs)
+	{
+		_kerningLookup[kerningPair.pair] = kerningPair.offset;
+		const uint32_t index = findCharacter(static_cast<uint32_t>(kerningPair.pair >> 32));
+		if (index != static_cast<uint32_t>(InvalidChar)) { _glyphQuads[index].hasKerning = true; }
+	}
 }
 
 Font_::Font_(make_shared_enabler, UIRenderer& uiRenderer, const pvrvk::ImageView& tex2D, const TextureHeader& textureHeader, const pvrvk::Sampler& sampler)
@@ -275,43 +325,54 @@ Font_::Font_(make_shared_enabler, UIRenderer& uiRenderer, const pvrvk::ImageView
 	uiRenderer.getDevice().lock()->updateDescriptorSets(&writeDescSet, 1, nullptr, 0);
 }
 
-uint32_t TextElement_::updateVertices(float fZPos, float xPos, float yPos, const std::vector<uint32_t>& text, Vertex* const pVertices) const
+void TextElement_::layoutText(uint32_t firstCharacter) const
 {
-	if (pVertices == NULL || text.empty()) { return 0; }
-	_boundingRect.clear();
-
 	Font tmp = _font;
-	Font_& font = *tmp;
-
-	yPos -= font.getAscent();
+	const Font_& font = *tmp;
 
-	yPos = glm::round(yPos);
-
-	// The original offset (after screen scale modification) of the X coordinate.
-	float preXPos = xPos;
-
-	float kernOffset;
-	float fAOff;
-	float fYOffset;
-	uint32_t vertexCount = 0;
-	int32_t nextChar;
+	// Characters past MaxLetters are ignored, as they have always been.
+	const uint32_t numCharacters = std::min(static_cast<uint32_t>(_utf32.size()), static_cast<uint32_t>(MaxLetters) + 1);
+	_layoutStates.resize(numCharacters + 1);
+	if (!firstCharacter)
+	{
+		// The bounds always include the origin.
+		LayoutState& initial = _layoutStates[0];
+		initial.x = 0.f;
+		initial.y = glm::round(-static_cast<float>(font.getAscent()));
+		initial.numVertices = 0;
+		initial.bounds[0] = initial.bounds[1] = initial.bounds[2] = initial.bounds[3] = 0.f;
+	}
+	firstCharacter = std::min(firstCharacter, numCharacters);
 
-	size_t numCharsInString = text.size();
+	const LayoutState& start = _layoutStates[firstCharacter];
+	float xPos = start.x;
+	float yPos = start.y;
+	uint32_t vertexCount = start.numVertices;
+	float minX = start.bounds[0], minY = start.bounds[1], maxX = start.bounds[2], maxY = start.bounds[3];
+	_firstDirtyVertex = std::min(_firstDirtyVertex, vertexCount);
 
-	for (size_t index = 0; index < numCharsInString; index++)
+	const uint32_t* text = _utf32.data();
+	for (uint32_t index = firstCharacter; index < numCharacters; index++)
 	{
-		if (index > MaxLetters) { break; }
+		LayoutState& state = _layoutStates[index];
+		state.x = xPos;
+		state.y = yPos;
+		state.numVertices = vertexCount;
+		state.bounds[0] = minX;
+		state.bounds[1] = minY;
+		state.bounds[2] = maxX;
+		state.bounds[3] = maxY;
 
 		// Newline
 		if (text[index] == 0x0A)
 		{
-			xPos = preXPos;
+			xPos = 0.f;
 			yPos -= glm::round(static_cast<float>(font.getFontLineSpacing()));
 			continue;
 		}
 
 		// Get the character
-		uint32_t charIndex = font.findCharacter(text[index]);
+		const uint32_t charIndex = font.findCharacter(text[index]);
 
 		// No character found. Add a space.
 		if (charIndex == Font_::InvalidChar)
@@ -320,56 +381,36 @@ uint32_t TextElement_::updateVertices(float fZPos, float xPos, float yPos, const
 			continue;
 		}
 
-		kernOffset = 0;
-		fYOffset = static_cast<float>(font.getYOffset(charIndex));
-		// The A offset. Could include overhang or underhang.
-		fAOff = glm::round(static_cast<float>(font.getCharMetrics(charIndex).xOff));
+		const Font_::GlyphQuad& quad = font.getGlyphQuad(charIndex);
+		writeGlyphQuad(&_vertices[vertexCount], quad, xPos, yPos);
+		minX = std::min(minX, xPos + quad.vertices[0]);
+		maxX = std::max(maxX, xPos + quad.vertices[18]);
+		maxY = std::max(maxY, yPos + quad.vertices[1]);
+		minY = std::min(minY, yPos + quad.vertices[19]);
 
-		if (index < numCharsInString - 1)
-		{
-			nextChar = text[index + 1];
-			font.applyKerning(text[index], nextChar, kernOffset);
-		}
-
-		const Font_::CharacterUV& charUV = font.getCharacterUV(charIndex);
-		// Filling vertex data
-		pVertices[vertexCount + 0].x = (xPos + fAOff);
-		pVertices[vertexCount + 0].y = (yPos + fYOffset);
-		pVertices[vertexCount + 0].z = (fZPos);
-		pVertices[vertexCount + 0].rhw = (1.0f);
-		pVertices[vertexCount + 0].tu = (charUV.ul);
-		pVertices[vertexCount + 0].tv = (charUV.vt);
-		_boundingRect.add(pVertices[vertexCount + 0].x, pVertices[vertexCount + 0].y, 0.0f);
-
-		pVertices[vertexCount + 1].x = (xPos + fAOff + glm::round(static_cast<float>(font.getRectangle(charIndex).getExtent().getWidth())));
-		pVertices[vertexCount + 1].y = (yPos + fYOffset);
-		pVertices[vertexCount + 1].z = (fZPos);
-		pVertices[vertexCount + 1].rhw = (1.0f);
-		pVertices[vertexCount + 1].tu = (charUV.ur);
-		pVertices[vertexCount + 1].tv = (charUV.vt);
-		_boundingRect.add(pVertices[vertexCount + 1].x, pVertices[vertexCount + 1].y, 0.0f);
-
-		pVertices[vertexCount + 2].x = (xPos + fAOff);
-		pVertices[vertexCount + 2].y = (yPos + fYOffset - glm::round(static_cast<float>(font.getRectangle(charIndex).getExtent().getHeight())));
-		pVertices[vertexCount + 2].z = (fZPos);
-		pVertices[vertexCount + 2].rhw = (1.0f);
-		pVertices[vertexCount + 2].tu = (charUV.ul);
-		pVertices[vertexCount + 2].tv = (charUV.vb);
-		_boundingRect.add(pVertices[vertexCount + 2].x, pVertices[vertexCount + 2].y, 0.0f);
-
-		pVertices[vertexCount + 3].x = (xPos + fAOff + glm::round(static_cast<float>(font.getRectangle(charIndex).getExtent().getWidth())));
-		pVertices[vertexCount + 3].y = (yPos + fYOffset - round(static_cast<float>(font.getRectangle(charIndex).getExtent().getHeight())));
-		pVertices[vertexCount + 3].z = (fZPos);
-		pVertices[vertexCount + 3].rhw = (1.0f);
-		pVertices[vertexCount + 3].tu = (charUV.ur);
-		pVertices[vertexCount + 3].tv = (charUV.vb);
-		_boundingRect.add(pVertices[vertexCount + 3].x, pVertices[vertexCount + 3].y, 0.0f);
+		float kernOffset = 0.f;
+		if (quad.hasKerning && index + 1 < _utf32.size()) { kernOffset = static_cast<float>(font.getKerning(text[index], text[index + 1])); }
 
 		// Add on this characters width
-		xPos = xPos + glm::round(static_cast<float>(font.getCharMetrics(charIndex).characterWidth + kernOffset) /** renderParam.scale.x*/);
+		xPos = xPos + glm::round(quad.advance + kernOffset);
 		vertexCount += 4;
 	}
-	return vertexCount;
+
+	LayoutState& end = _layoutStates[numCharacters];
+	end.x = xPos;
+	end.y = yPos;
+	end.numVertices = vertexCount;
+	end.bounds[0] = minX;
+	end.bounds[1] = minY;
+	end.bounds[2] = maxX;
+	end.bounds[3] = maxY;
+
+	_numCachedVerts = static_cast<int32_t>(vertexCount);
+	if (vertexCount) { _boundingRect.setMinMax(glm::vec3(minX, minY, 0.f), glm::vec3(maxX, maxY, 0.f)); }
+	else
+	{
+		_boundingRect.clear();
+	}
 }
 
 void Text_::onAddInstance(uint64_t parentId)
@@ -394,24 +435,76 @@ void TextElement_::createBuffers()
 		_uiRenderer->getMemoryAllocator(), pvr::utils::vma::AllocationCreateFlags::e_MAPPED_BIT);
 }
 
-void TextElement_::regenerateText() const
+uint32_t TextElement_::convertChangedSuffix() const
 {
-	_utf32.clear();
-	if (_isUtf8) { utils::UnicodeConverter::convertUTF8ToUTF32(reinterpret_cast<const utf8*>(_textStr.c_str()), _utf32); }
+	// Find the first code point that differs from the text the vertices were generated from. Everything before it is
+	// kept: its UTF-32 conversion, its vertices and the layout state after it.
+	size_t prefix = 0;
+	uint32_t numCommonCharacters = 0;
+	if (_isUtf8 && _layoutIsUtf8)
+	{
+		const size_t length = std::min(_textStr.size(), _layoutStr.size());
+		while (prefix < length && _textStr[prefix] == _layoutStr[prefix]) { ++prefix; }
+		// Back up to the start of a code point shared by both strings.
+		auto isTail = [](const std::string& str, size_t i) { return i < str.size() && (static_cast<uint8_t>(str[i]) & 0xC0) == 0x80; };
+		while (prefix && (isTail(_textStr, prefix) || isTail(_layoutStr, prefix))) { --prefix; }
+		for (size_t i = 0; i < prefix; ++i) { numCommonCharacters += !isTail(_textStr, i); }
+	}
+	else if (!_isUtf8 && !_layoutIsUtf8)
+	{
+		const size_t length = std::min(_textWStr.size(), _layoutWStr.size());
+		while (prefix < length && _textWStr[prefix] == _layoutWStr[prefix]) { ++prefix; }
+		if (sizeof(wchar_t) == 2)
+		{
+			auto isLowSurrogate = [](const std::wstring& str, size_t i) { return i < str.size() && str[i] >= 0xDC00 && str[i] <= 0xDFFF; };
+			while (prefix && (isLowSurrogate(_textWStr, prefix) || isLowSurrogate(_layoutWStr, prefix))) { --prefix; }
+			for (size_t i = 0; i < prefix; ++i) { numCommonCharacters += !isLowSurrogate(_textWStr, i); }
+		}
+		else
+		{
+			numCommonCharacters = static_cast<uint32_t>(prefix);
+		}
+	}
+
+	_utf32.resize(numCommonCharacters);
+	if (_isUtf8) { utils::UnicodeConverter::convertUTF8ToUTF32(reinterpret_cast<const utf8*>(_textStr.c_str() + prefix), _utf32); }
 	else
 	{
-		if (sizeof(wchar_t) == 2 && _textWStr.length()) { utils::UnicodeConverter::convertUTF16ToUTF32((const utf16*)_textWStr.c_str(), _utf32); }
-		else if (_textWStr.length()) // if (sizeof(wchar_t) == 4)
+		if (sizeof(wchar_t) == 2 && _textWStr.length() > prefix) { utils::UnicodeConverter::convertUTF16ToUTF32((const utf16*)_textWStr.c_str() + prefix, _utf32); }
+		else if (_textWStr.length() > prefix) // if (sizeof(wchar_t) == 4)
 		{
 			_utf32.resize(_textWStr.size());
-			memcpy(&_utf32[0], &_textWStr[0], _textWStr.size() * sizeof(_textWStr[0]));
+			for (size_t i = prefix; i < _textWStr.size(); ++i) { _utf32[i] = static_cast<uint32_t>(_textWStr[i]); }
 		}
 	}
+	return numCommonCharacters;
+}
 
-	_vertices.clear();
-	if (_vertices.size() < (_utf32.size() * 4)) { _vertices.resize(_utf32.size() * 4); }
+void TextElement_::regenerateText() const
+{
+	uint32_t numCommonCharacters;
+	try
+	{
+		numCommonCharacters = convertChangedSuffix();
+	}
+	catch (...)
+	{
+		// Start from scratch next time.
+		_layoutStr.clear();
+		_layoutWStr.clear();
+		_utf32.clear();
+		throw;
+	}
+	_layoutIsUtf8 = _isUtf8;
+	if (_isUtf8) { _layoutStr = _textStr; }
+	else
+	{
+		_layoutWStr = _textWStr;
+	}
 
-	_numCachedVerts = updateVertices(0.0f, 0.f, 0.f, _utf32, _vertices.size() ? &_vertices[0] : 0);
+	_vertices.resize(_utf32.size() * 4);
+	// The last common character is laid out again, as its kerning depends on the character that follows it.
+	layoutText(numCommonCharacters ? numCommonCharacters - 1 : 0);
 	assertion((_numCachedVerts % 4) == 0);
 	assertion((_numCachedVerts / 4) < MaxLetters);
 	_isTextDirty = false;
@@ -419,12 +512,23 @@ void TextElement_::regenerateText() const
 
 void TextElement_::updateVbo() const
 {
-	if (_vertices.size()) { pvr::utils::updateHostVisibleBuffer(_vbo, _vertices.data(), 0, static_cast<uint32_t>(sizeof(Vertex) * _vertices.size()), true); }
+	// Only the vertices of the characters that changed are uploaded. The buffer holds _maxLength characters.
+	const uint32_t numVertices = std::min(static_cast<uint32_t>(_numCachedVerts), _maxLength * 4);
+	if (_firstDirtyVertex < numVertices)
+	{
+		pvr::utils::updateHostVisibleBuffer(_vbo, _vertices.data() + _firstDirtyVertex, sizeof(Vertex) * _firstDirtyVertex,
+			static_cast<uint32_t>(sizeof(Vertex) * (numVertices - _firstDirtyVertex)), true);
+	}
+	_firstDirtyVertex = numVertices;
+
+	const uint32_t indexCount = (glm::min<int32_t>(_numCachedVerts, 0xFFFC) >> 1) * 3;
+	if (indexCount == _indexCount) { return; }
+	_indexCount = indexCount;
 	VkDrawIndexedIndirectCommand cmd;
 	cmd.firstInstance = 0;
 	cmd.firstIndex = 0;
 	cmd.instanceCount = 1;
-	cmd.indexCount = (glm::min<int32_t>(_numCachedVerts, 0xFFFC) >> 1) * 3;
+	cmd.indexCount = indexCount;
 	cmd.vertexOffset = 0;
 
 	pvr::utils::updateHostVisibleBuffer(_drawIndirectBuffer, &cmd, 0, static_cast<VkDeviceSize>(sizeof(VkDrawIndexedIndirectCommand)), true);
@@ -10,6 +10,7 @@
 #include "PVRCore/math/AxisAlignedBox.h"
 #include "PVRCore/strings/StringFunctions.h"
 #include "PVRCore/texture/Texture.h"
+#include <unordered_map>
 
 //!\cond NO_DOXYGEN
 #define NUM_BITS_GROUP_ID 8
@@ -25,6 +26,7 @@ class Texture;
 namespace ui {
 //!\cond NO_DOXYGEN
 class UIRenderer;
+class SpriteBatch;
 namespace impl {
 class Font_;
 class Text_;
@@ -130,6 +132,7 @@ class Sprite_
 {
 private:
 	friend class pvr::ui::UIRenderer;
+	friend class pvr::ui::SpriteBatch;
 	friend class pvr::ui::impl::Group_;
 	friend class pvr::ui::impl::Font_;
 	friend class pvr::ui::impl::PixelGroup_;
@@ -300,6 +303,7 @@ class I2dComponent
 {
 private:
 	friend class pvr::ui::UIRenderer;
+	friend class pvr::ui::SpriteBatch;
 	friend class pvr::ui::impl::PixelGroup_;
 	friend class pvr::ui::impl::Text_;
 	friend class pvr::ui::impl::Image_;
@@ -429,6 +433,7 @@ class Image_ : public Sprite_, public I2dComponent
 {
 private:
 	friend class pvr::ui::UIRenderer;
+	friend class pvr::ui::SpriteBatch;
 
 	class make_shared_enabler
 	{
@@ -591,6 +596,19 @@ public:
 		uint16_t characterWidth;
 	};
 
+	/// <summary>The four vertices (x, y, z, w, u, v each) of the quad of a character, relative to the pen position, in
+	/// the order the font index buffer expects them: top left, top right, bottom left, bottom right. Built when the font
+	/// is loaded, so that laying out a character only requires offsetting its quad by the pen position.</summary>
+	struct GlyphQuad
+	{
+		/// <summary>The vertices, 6 floats each.</summary>
+		float vertices[24];
+		/// <summary>The unrounded advance of the pen after the character, before kerning.</summary>
+		float advance;
+		/// <summary>Whether the character is the first of any kerning pair.</summary>
+		bool hasKerning;
+	};
+
 	/// <summary>Enumeration values useful for text rendering. PVRTexTool uses these values when creating fonts.</summary>
 	enum
 	{
@@ -608,8 +626,10 @@ public:
 private:
 	friend class pvr::ui::UIRenderer;
 
-	static int32_t characterCompFunc(const void* a, const void* b);
-	static int32_t kerningCompFunc(const void* a, const void* b);
+	// Characters below this are looked up in a table indexed by their value, others in a hash map.
+	static const uint32_t DirectLookupSize = 256;
+
+	void buildLookupTables();
 
 	class make_shared_enabler
 	{
@@ -648,6 +668,10 @@ private:
 	std::vector<CharacterUV> _characterUVs;
 	std::vector<pvrvk::Rect2D> _rects;
 	std::vector<int32_t> _yOffsets;
+	std::vector<GlyphQuad> _glyphQuads;
+	uint32_t _directLookup[DirectLookupSize];
+	std::unordered_map<uint32_t, uint32_t> _characterLookup;
+	std::unordered_map<uint64_t, int32_t> _kerningLookup;
 	pvrvk::ImageView _imageView;
 	glm::uvec2 _dim;
 	uint32_t _alphaRenderingMode;
@@ -668,14 +692,35 @@ public:
 	/// <summary>Find the index of a character inside the internal font character list. Only useful for custom font
 	/// use.</summary>
 	/// <param name="character">The value of a character. Accepts ASCII through to UTF32 characters.</param>
-	/// <returns>The index of the character inside the internal font list.</returns>
-	uint32_t findCharacter(uint32_t character) const;
+	/// <returns>The index of the character inside the internal font list, or InvalidChar if the font does not contain it.</returns>
+	uint32_t findCharacter(uint32_t character) const
+	{
+		if (character < DirectLookupSize) { return _directLookup[character]; }
+		auto found = _characterLookup.find(character);
+		return found != _characterLookup.end() ? found->second : static_cast<uint32_t>(InvalidChar);
+	}
+
+	/// <summary>Get the kerning offset of two characters.</summary>
+	/// <param name="charA">The first (left) character of the pair.</param>
+	/// <param name="charB">The second (right) character of the pair.</param>
+	/// <returns>The offset, in pixels, that must be applied to the second character due to kerning.</returns>
+	int32_t getKerning(uint32_t charA, uint32_t charB) const
+	{
+		if (_kerningLookup.empty()) { return 0; }
+		auto found = _kerningLookup.find((static_cast<uint64_t>(charA) << 32) | static_cast<uint64_t>(charB));
+		return found != _kerningLookup.end() ? found->second : 0;
+	}
 
 	/// <summary>Apply kerning to two characters (give the offset required by the specific pair).</summary>
 	/// <param name="charA">The first (left) character of the pair.</param>
 	/// <param name="charB">The second (right) character of the pair.</param>
 	/// <param name="offset">Output parameter, the offset that must be applied to the second character due to kerning.</param>
-	void applyKerning(uint32_t charA, uint32_t charB, float& offset);
+	void applyKerning(uint32_t charA, uint32_t charB, float& offset) const { offset += static_cast<float>(getKerning(charA, charB)); }
+
+	/// <summary>Get the quad of a character, relative to the pen position.</summary>
+	/// <param name="index">The internal index of the character. Use findCharacter to get the index of a specific known character.</param>
+	/// <returns>The quad of the character</returns>
+	const GlyphQuad& getGlyphQuad(uint32_t index) const { return _glyphQuads[index]; }
 
 	/// <summary>Get the character metrix of this font</summary>
 	/// <param name="index">The internal index of the character. Use findCharacter to get the index of a specific known character.</param>
@@ -767,6 +812,7 @@ class TextElement_
 private:
 	friend class pvr::ui::impl::Text_;
 	friend class pvr::ui::UIRenderer;
+	friend class pvr::ui::SpriteBatch;
 
 	class make_shared_enabler
 	{
@@ -804,14 +850,24 @@ private:
 
 	void setUIRenderer(UIRenderer* uiRenderer) { _uiRenderer = uiRenderer; }
 
+	// The pen position, number of vertices and bounds (min x, min y, max x, max y) before laying out a character.
+	struct LayoutState
+	{
+		float x;
+		float y;
+		uint32_t numVertices;
+		float bounds[4];
+	};
+
 	void createBuffers();
 	void regenerateText() const;
+	uint32_t convertChangedSuffix() const;
 	void updateVbo() const;
 	/// <summary>Function that will be automatically called by the uiRenderer. Do not call.</summary>
 	void onRender(pvrvk::CommandBufferBase& commands);
 
 	/// <summary>Function that will be automatically called by the uiRenderer. Do not call.</summary>
-	uint32_t updateVertices(float fZPos, float xPos, float yPos, const std::vector<uint32_t>& text, Vertex* const pVertices) const;
+	void layoutText(uint32_t firstCharacter) const;
 
 	bool _isUtf8;
 	mutable bool _isTextDirty;
@@ -825,6 +881,13 @@ private:
 	mutable std::vector<Vertex> _vertices;
 	mutable int32_t _numCachedVerts;
 	mutable math::AxisAlignedBox _boundingRect; //< Bounding rectangle of the sprite
+	// The text the vertices were last generated from, to only regenerate what follows the first difference.
+	mutable std::string _layoutStr;
+	mutable std::wstring _layoutWStr;
+	mutable bool _layoutIsUtf8;
+	mutable std::vector<LayoutState> _layoutStates;
+	mutable uint32_t _firstDirtyVertex;
+	mutable uint32_t _indexCount;
 	UIRenderer* _uiRenderer;
 
 public:
@@ -834,7 +897,8 @@ public:
 	/// <param name="font">The font to use for the text element.</param>
 	/// <param name="maxTextLength">The maximum number of characters for the text element.</param>
 	TextElement_(make_shared_enabler, UIRenderer& uiRenderer, const Font& font, uint32_t maxTextLength)
-		: _isTextDirty(true), _font(font), _maxLength(maxTextLength), _uiRenderer(&uiRenderer)
+		: _isTextDirty(true), _font(font), _maxLength(maxTextLength), _numCachedVerts(0), _layoutIsUtf8(true), _firstDirtyVertex(0),
+		  _indexCount(static_cast<uint32_t>(-1)), _uiRenderer(&uiRenderer)
 	{
 		_maxLength = _maxLength ? _maxLength : 255;
 		createBuffers();
@@ -848,7 +912,8 @@ public:
 	/// <param name="maxTextLength">The maximum number of characters for the text element. If less than strlen(str),
 	/// it is implicitly set to strlen(<paramref name="str"/>)</param>
 	TextElement_(make_shared_enabler, UIRenderer& uiRenderer, const std::string& str, const Font& font, uint32_t maxTextLength = 0)
-		: _isTextDirty(true), _font(font), _maxLength(std::max<uint32_t>(static_cast<uint32_t>(str.length()), maxTextLength)), _uiRenderer(&uiRenderer)
+		: _isTextDirty(true), _font(font), _maxLength(std::max<uint32_t>(static_cast<uint32_t>(str.length()), maxTextLength)),
+		  _numCachedVerts(0), _layoutIsUtf8(true), _firstDirtyVertex(0), _indexCount(static_cast<uint32_t>(-1)), _uiRenderer(&uiRenderer)
 	{
 		_maxLength = _maxLength ? _maxLength : 255;
 		createBuffers();
@@ -863,7 +928,8 @@ public:
 	/// <param name="maxTextLength">The maximum number of characters for the text element. If less than strlen(str),
 	/// it is implicitly set to strlen(<paramref name="str"/>)</param>
 	TextElement_(make_shared_enabler, UIRenderer& uiRenderer, const std::wstring& str, const Font& font, uint32_t maxTextLength = 0)
-		: _isTextDirty(true), _font(font), _maxLength(std::max<uint32_t>(static_cast<uint32_t>(str.length()), maxTextLength)), _uiRenderer(&uiRenderer)
+		: _isTextDirty(true), _font(font), _maxLength(std::max<uint32_t>(static_cast<uint32_t>(str.length()), maxTextLength)),
+		  _numCachedVerts(0), _layoutIsUtf8(true), _firstDirtyVertex(0), _indexCount(static_cast<uint32_t>(-1)), _uiRenderer(&uiRenderer)
 	{
 		_maxLength = _maxLength ? _maxLength : 255;
 		createBuffers();
@@ -927,6 +993,7 @@ class Text_ : public Sprite_, public I2dComponent
 {
 private:
 	friend class pvr::ui::UIRenderer;
+	friend class pvr::ui::SpriteBatch;
 
 	class make_shared_enabler
 	{
@@ -680,6 +680,7 @@ private:
 	friend class pvr::ui::impl::Group_;
 	friend class pvr::ui::impl::Sprite_;
 	friend class pvr::ui::impl::Font_;
+	friend class pvr::ui::SpriteBatch;
 
 	/// <summary>return the default DescriptorSetLayout. ONLY to be used by the Sprites</summary>
 	/// <returns>const pvrvk::DescriptorSetLayout&</returns>
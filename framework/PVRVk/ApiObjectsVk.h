@@ -15,6 +15,7 @@
 #include "PVRVk/CommandBufferVk.h"
 #include "PVRVk/CommandPoolVk.h"
 #include "PVRVk/DescriptorSetVk.h"
+#include "PVRVk/DescriptorUpdateTemplateVk.h"
 #include "PVRVk/FramebufferVk.h"
 #include "PVRVk/PipelineLayoutVk.h"
 #include "PVRVk/RenderPassVk.h"
@@ -65,8 +65,8 @@ VkBufferMemoryBarrier bufferBarrier(const BufferMemoryBarrier& buffBarrier)
 	barrier.srcAccessMask = static_cast<VkAccessFlags>(buffBarrier.getSrcAccessMask());
 	barrier.dstAccessMask = static_cast<VkAccessFlags>(buffBarrier.getDstAccessMask());
 
-	barrier.dstQueueFamilyIndex = static_cast<uint32_t>(-1);
-	barrier.srcQueueFamilyIndex = static_cast<uint32_t>(-1);
+	barrier.srcQueueFamilyIndex = buffBarrier.getSrcQueueFamilyIndex();
+	barrier.dstQueueFamilyIndex = buffBarrier.getDstQueueFamilyIndex();
 
 	barrier.buffer = buffBarrier.getBuffer()->getVkHandle();
 	barrier.offset = buffBarrier.getOffset();
@@ -0,0 +1,122 @@
+/*!
+\brief Function definitions for the DescriptorUpdateTemplate class.
+\file PVRVk/DescriptorUpdateTemplateVk.cpp
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#include "PVRVk/DescriptorUpdateTemplateVk.h"
+#include "PVRVk/ImageVk.h"
+#include "PVRVk/SamplerVk.h"
+#include "PVRVk/BufferVk.h"
+
+namespace pvrvk {
+namespace impl {
+//!\cond NO_DOXYGEN
+DescriptorUpdateTemplate_::DescriptorUpdateTemplate_(make_shared_enabler, const DeviceWeakPtr& device, const DescriptorUpdateTemplateCreateInfo& createInfo)
+	: PVRVkDeviceObjectBase(device), DeviceObjectDebugUtils(), _createInfo(createInfo)
+{
+	Device deviceSharedPtr = getDevice();
+	const VkDeviceBindings& bindings = deviceSharedPtr->getVkBindings();
+
+	// Prefer the extension entry points when the extension was enabled, as the core ones are only available on Vulkan 1.1 devices.
+	PFN_vkCreateDescriptorUpdateTemplate vkCreateDescriptorUpdateTemplate = nullptr;
+	if (deviceSharedPtr->getEnabledExtensionTable().khrDescriptorUpdateTemplateEnabled && bindings.vkCreateDescriptorUpdateTemplateKHR)
+	{
+		vkCreateDescriptorUpdateTemplate = bindings.vkCreateDescriptorUpdateTemplateKHR;
+		_vkDestroyDescriptorUpdateTemplate = bindings.vkDestroyDescriptorUpdateTemplateKHR;
+		_vkUpdateDescriptorSetWithTemplate = bindings.vkUpdateDescriptorSetWithTemplateKHR;
+	}
+	else if (bindings.vkCreateDescriptorUpdateTemplate)
+	{
+		vkCreateDescriptorUpdateTemplate = bindings.vkCreateDescriptorUpdateTemplate;
+		_vkDestroyDescriptorUpdateTemplate = bindings.vkDestroyDescriptorUpdateTemplate;
+		_vkUpdateDescriptorSetWithTemplate = bindings.vkUpdateDescriptorSetWithTemplate;
+	}
+	else
+	{
+		throw ErrorExtensionNotPresent(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+	}
+
+	if (!_createInfo.getDescriptorSetLayout()) { throw ErrorValidationFailedEXT("DescriptorUpdateTemplate: A descriptor set layout must be provided"); }
+
+	std::vector<VkDescriptorUpdateTemplateEntry> vkEntries(_createInfo.getNumEntries());
+	for (uint32_t i = 0; i < _createInfo.getNumEntries(); ++i) { vkEntries[i] = _createInfo.getEntry(i).get(); }
+
+	VkDescriptorUpdateTemplateCreateInfo vkCreateInfo = {};
+	vkCreateInfo.sType = static_cast<VkStructureType>(StructureType::e_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO);
+	vkCreateInfo.flags = static_cast<VkDescriptorUpdateTemplateCreateFlags>(_createInfo.getFlags());
+	vkCreateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(vkEntries.size());
+	vkCreateInfo.pDescriptorUpdateEntries = vkEntries.data();
+	vkCreateInfo.templateType = static_cast<VkDescriptorUpdateTemplateType>(DescriptorUpdateTemplateType::e_DESCRIPTOR_SET);
+	vkCreateInfo.descriptorSetLayout = _createInfo.getDescriptorSetLayout()->getVkHandle();
+
+	vkThrowIfFailed(vkCreateDescriptorUpdateTemplate(deviceSharedPtr->getVkHandle(), &vkCreateInfo, nullptr, &_vkHandle), "Create Descriptor Update Template failed");
+}
+
+DescriptorUpdateTemplate_::~DescriptorUpdateTemplate_()
+{
+	if (getVkHandle() != VK_NULL_HANDLE)
+	{
+		if (!_device.expired())
+		{
+			_vkDestroyDescriptorUpdateTemplate(getDevice()->getVkHandle(), getVkHandle(), nullptr);
+			_vkHandle = VK_NULL_HANDLE;
+		}
+		else
+		{
+			reportDestroyedAfterDevice();
+		}
+	}
+}
+//!\endcond
+
+void* DescriptorUpdateTemplate_::getDescriptorInfo(void* data, uint32_t binding, uint32_t arrayIndex) const
+{
+	for (uint32_t i = 0; i < _createInfo.getNumEntries(); ++i)
+	{
+		const DescriptorUpdateTemplateEntry& entry = _createInfo.getEntry(i);
+		if (entry.getDstBinding() == binding && arrayIndex >= entry.getDstArrayElement() && arrayIndex < entry.getDstArrayElement() + entry.getDescriptorCount())
+		{ return static_cast<char*>(data) + entry.getOffset() + entry.getStride() * (arrayIndex - entry.getDstArrayElement()); }
+	}
+	throw ErrorValidationFailedEXT("DescriptorUpdateTemplate: The template does not write the requested binding and array element");
+}
+
+void DescriptorUpdateTemplate_::setImageInfo(void* data, uint32_t binding, uint32_t arrayIndex, const DescriptorImageInfo& imageInfo) const
+{
+	VkDescriptorImageInfo& vkImageInfo = *static_cast<VkDescriptorImageInfo*>(getDescriptorInfo(data, binding, arrayIndex));
+	vkImageInfo.sampler = imageInfo.sampler ? imageInfo.sampler->getVkHandle() : VK_NULL_HANDLE;
+	vkImageInfo.imageView = imageInfo.imageView ? imageInfo.imageView->getVkHandle() : VK_NULL_HANDLE;
+	vkImageInfo.imageLayout = static_cast<VkImageLayout>(imageInfo.imageLayout);
+}
+
+void DescriptorUpdateTemplate_::setBufferInfo(void* data, uint32_t binding, uint32_t arrayIndex, const DescriptorBufferInfo& bufferInfo) const
+{
+	VkDescriptorBufferInfo& vkBufferInfo = *static_cast<VkDescriptorBufferInfo*>(getDescriptorInfo(data, binding, arrayIndex));
+	vkBufferInfo.buffer = bufferInfo.buffer ? bufferInfo.buffer->getVkHandle() : VK_NULL_HANDLE;
+	vkBufferInfo.offset = bufferInfo.offset;
+	vkBufferInfo.range = bufferInfo.range;
+}
+
+void DescriptorUpdateTemplate_::setTexelBufferInfo(void* data, uint32_t binding, uint32_t arrayIndex, const BufferView& bufferView) const
+{
+	*static_cast<VkBufferView*>(getDescriptorInfo(data, binding, arrayIndex)) = bufferView ? bufferView->getVkHandle() : VK_NULL_HANDLE;
+}
+
+void DescriptorUpdateTemplate_::update(const DescriptorSet& descriptorSet, const void* data) const
+{
+	assert(descriptorSet->getDescriptorSetLayout()->getCreateInfo() == getDescriptorSetLayout()->getCreateInfo() && "Descriptor set layout incompatible with the template");
+	_vkUpdateDescriptorSetWithTemplate(getDevice()->getVkHandle(), descriptorSet->getVkHandle(), getVkHandle(), data);
+}
+
+void DescriptorUpdateTemplate_::update(const DescriptorSet* descriptorSets, uint32_t numDescriptorSets, const void* data, size_t dataStride) const
+{
+	const VkDevice vkDevice = getDevice()->getVkHandle();
+	const char* setData = static_cast<const char*>(data);
+	for (uint32_t i = 0; i < numDescriptorSets; ++i, setData += dataStride)
+	{
+		assert(descriptorSets[i]->getDescriptorSetLayout()->getCreateInfo() == getDescriptorSetLayout()->getCreateInfo() && "Descriptor set layout incompatible with the template");
+		_vkUpdateDescriptorSetWithTemplate(vkDevice, descriptorSets[i]->getVkHandle(), getVkHandle(), setData);
+	}
+}
+} // namespace impl
+} // namespace pvrvk
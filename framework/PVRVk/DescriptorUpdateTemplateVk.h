@@ -0,0 +1,219 @@
+/*!
+\brief The DescriptorUpdateTemplate class, used to update Descriptor Sets from a packed, application-owned block of memory
+without building WriteDescriptorSet lists.
+\file PVRVk/DescriptorUpdateTemplateVk.h
+\author PowerVR by Imagination, Developer Technology Team
+\copyright Copyright (c) Imagination Technologies Limited.
+*/
+#pragma once
+#include "PVRVk/DescriptorSetVk.h"
+#include <algorithm>
+
+namespace pvrvk {
+/// <summary>Contains all information required to create a Descriptor Update Template: the descriptor set layout of the
+/// sets it will update and, for each range of descriptors it writes, where the corresponding Vulkan descriptor infos
+/// (VkDescriptorImageInfo, VkDescriptorBufferInfo, VkBufferView or VkAccelerationStructureKHR) are found in the update data.</summary>
+struct DescriptorUpdateTemplateCreateInfo
+{
+public:
+	/// <summary>Constructor. No entries and no descriptor set layout.</summary>
+	DescriptorUpdateTemplateCreateInfo() : _flags(DescriptorUpdateTemplateCreateFlags::e_NONE), _dataSize(0) {}
+
+	/// <summary>Constructor. Creates one entry per binding of the descriptor set layout, tightly packing the descriptor infos of
+	/// all of its bindings in increasing binding order: every binding takes descriptorCount consecutive Vulkan info structures of
+	/// the type corresponding to its descriptor type. Use getDataSize and getEntry to find the size and layout of the update data.</summary>
+	/// <param name="descriptorSetLayout">The layout of the descriptor sets the template will update</param>
+	explicit DescriptorUpdateTemplateCreateInfo(const DescriptorSetLayout& descriptorSetLayout)
+		: _descriptorSetLayout(descriptorSetLayout), _flags(DescriptorUpdateTemplateCreateFlags::e_NONE), _dataSize(0)
+	{
+		const DescriptorSetLayoutCreateInfo& layoutInfo = descriptorSetLayout->getCreateInfo();
+		const DescriptorSetLayoutCreateInfo::DescriptorSetLayoutBinding* bindings = layoutInfo.getAllBindings();
+
+		std::vector<const DescriptorSetLayoutCreateInfo::DescriptorSetLayoutBinding*> sortedBindings(layoutInfo.getNumBindings());
+		for (uint32_t i = 0; i < layoutInfo.getNumBindings(); ++i) { sortedBindings[i] = &bindings[i]; }
+		std::sort(sortedBindings.begin(), sortedBindings.end(),
+			[](const DescriptorSetLayoutCreateInfo::DescriptorSetLayoutBinding* a, const DescriptorSetLayoutCreateInfo::DescriptorSetLayoutBinding* b) { return a->binding < b->binding; });
+
+		size_t offset = 0;
+		for (const auto* binding : sortedBindings)
+		{
+			const size_t stride = getDescriptorInfoSize(binding->descriptorType);
+			addEntry(DescriptorUpdateTemplateEntry(binding->binding, 0, binding->descriptorCount, binding->descriptorType, offset, stride));
+			offset += stride * binding->descriptorCount;
+		}
+	}
+
+	/// <summary>Set the layout of the descriptor sets the template will update</summary>
+	/// <param name="descriptorSetLayout">A descriptor set layout</param>
+	/// <returns>This object (allows chaining of calls)</returns>
+	DescriptorUpdateTemplateCreateInfo& setDescriptorSetLayout(const DescriptorSetLayout& descriptorSetLayout)
+	{
+		_descriptorSetLayout = descriptorSetLayout;
+		return *this;
+	}
+
+	/// <summary>Set the creation flags</summary>
+	/// <param name="flags">DescriptorUpdateTemplateCreateFlags</param>
+	/// <returns>This object (allows chaining of calls)</returns>
+	DescriptorUpdateTemplateCreateInfo& setFlags(DescriptorUpdateTemplateCreateFlags flags)
+	{
+		_flags = flags;
+		return *this;
+	}
+
+	/// <summary>Add an entry, describing a range of descriptors of a single binding and where their infos are found in the update data</summary>
+	/// <param name="entry">The entry to add. Its offset and stride are in bytes, relative to the start of the update data.</param>
+	/// <returns>This object (allows chaining of calls)</returns>
+	DescriptorUpdateTemplateCreateInfo& addEntry(const DescriptorUpdateTemplateEntry& entry)
+	{
+		_entries.emplace_back(entry);
+		if (entry.getDescriptorCount())
+		{ _dataSize = std::max(_dataSize, entry.getOffset() + entry.getStride() * (entry.getDescriptorCount() - 1) + getDescriptorInfoSize(entry.getDescriptorType())); }
+		return *this;
+	}
+
+	/// <summary>Clear all entries</summary>
+	/// <returns>This object (allows chaining of calls)</returns>
+	DescriptorUpdateTemplateCreateInfo& clearEntries()
+	{
+		_entries.clear();
+		_dataSize = 0;
+		return *this;
+	}
+
+	/// <summary>Get the layout of the descriptor sets the template will update</summary>
+	/// <returns>The descriptor set layout</returns>
+	const DescriptorSetLayout& getDescriptorSetLayout() const { return _descriptorSetLayout; }
+
+	/// <summary>Get the creation flags</summary>
+	/// <returns>DescriptorUpdateTemplateCreateFlags</returns>
+	DescriptorUpdateTemplateCreateFlags getFlags() const { return _flags; }
+
+	/// <summary>Get the number of entries</summary>
+	/// <returns>The number of entries</returns>
+	uint32_t getNumEntries() const { return static_cast<uint32_t>(_entries.size()); }
+
+	/// <summary>Get an entry</summary>
+	/// <param name="index">The index of the entry</param>
+	/// <returns>The entry at index</returns>
+	const DescriptorUpdateTemplateEntry& getEntry(uint32_t index) const { return _entries[index]; }
+
+	/// <summary>Get all entries</summary>
+	/// <returns>A pointer to the first of getNumEntries entries</returns>
+	const DescriptorUpdateTemplateEntry* getEntries() const { return _entries.data(); }
+
+	/// <summary>Get the minimum size of the update data, i.e. the end of the furthest descriptor info referenced by an entry</summary>
+	/// <returns>The size in bytes of a block of update data</returns>
+	size_t getDataSize() const { return _dataSize; }
+
+	/// <summary>Get the size of the Vulkan structure describing a single descriptor of the given type in the update data</summary>
+	/// <param name="descriptorType">A descriptor type</param>
+	/// <returns>The size of a VkDescriptorImageInfo, VkDescriptorBufferInfo, VkBufferView or VkAccelerationStructureKHR</returns>
+	static size_t getDescriptorInfoSize(DescriptorType descriptorType)
+	{
+		if ((descriptorType >= DescriptorType::e_SAMPLER && descriptorType <= DescriptorType::e_STORAGE_IMAGE) || descriptorType == DescriptorType::e_INPUT_ATTACHMENT)
+		{ return sizeof(VkDescriptorImageInfo); }
+		if (descriptorType >= DescriptorType::e_UNIFORM_BUFFER && descriptorType <= DescriptorType::e_STORAGE_BUFFER_DYNAMIC) { return sizeof(VkDescriptorBufferInfo); }
+		if (descriptorType == DescriptorType::e_UNIFORM_TEXEL_BUFFER || descriptorType == DescriptorType::e_STORAGE_TEXEL_BUFFER) { return sizeof(VkBufferView); }
+		if (descriptorType == DescriptorType::e_ACCELERATION_STRUCTURE_KHR) { return sizeof(VkAccelerationStructureKHR); }
+		throw ErrorValidationFailedEXT("DescriptorUpdateTemplateCreateInfo: Descriptor type not supported by descriptor update templates");
+	}
+
+private:
+	DescriptorSetLayout _descriptorSetLayout;
+	DescriptorUpdateTemplateCreateFlags _flags;
+	std::vector<DescriptorUpdateTemplateEntry> _entries;
+	size_t _dataSize;
+};
+
+namespace impl {
+/// <summary>Vulkan implementation of a Descriptor Update Template. A template is created once for a descriptor set layout and
+/// then applied to any number of descriptor sets of that layout, each time reading the descriptors from a packed block of
+/// application-owned memory (see Device_::updateDescriptorSetWithTemplate). Applying a template performs no heap allocations.
+/// Unlike Device_::updateDescriptorSets, template updates store raw Vulkan handles and do not keep the referenced objects alive:
+/// the application must keep the buffers, images, samplers and views alive for as long as the descriptor sets use them.
+/// Requires Vulkan 1.1 or the VK_KHR_descriptor_update_template device extension.</summary>
+class DescriptorUpdateTemplate_ : public PVRVkDeviceObjectBase<VkDescriptorUpdateTemplate, ObjectType::e_DESCRIPTOR_UPDATE_TEMPLATE>,
+								  public DeviceObjectDebugUtils<DescriptorUpdateTemplate_>
+{
+private:
+	friend class Device_;
+
+	class make_shared_enabler
+	{
+	protected:
+		make_shared_enabler() = default;
+		friend class DescriptorUpdateTemplate_;
+	};
+
+	static DescriptorUpdateTemplate constructShared(const DeviceWeakPtr& device, const DescriptorUpdateTemplateCreateInfo& createInfo)
+	{
+		return std::make_shared<DescriptorUpdateTemplate_>(make_shared_enabler{}, device, createInfo);
+	}
+
+	DescriptorUpdateTemplateCreateInfo _createInfo;
+	PFN_vkUpdateDescriptorSetWithTemplate _vkUpdateDescriptorSetWithTemplate;
+	PFN_vkDestroyDescriptorUpdateTemplate _vkDestroyDescriptorUpdateTemplate;
+
+public:
+	//!\cond NO_DOXYGEN
+	DECLARE_NO_COPY_SEMANTICS(DescriptorUpdateTemplate_)
+	~DescriptorUpdateTemplate_();
+	DescriptorUpdateTemplate_(make_shared_enabler, const DeviceWeakPtr& device, const DescriptorUpdateTemplateCreateInfo& createInfo);
+	//!\endcond
+
+	/// <summary>Get the create info this template was created with</summary>
+	/// <returns>The DescriptorUpdateTemplateCreateInfo</returns>
+	const DescriptorUpdateTemplateCreateInfo& getCreateInfo() const { return _createInfo; }
+
+	/// <summary>Get the layout of the descriptor sets this template updates</summary>
+	/// <returns>The descriptor set layout</returns>
+	const DescriptorSetLayout& getDescriptorSetLayout() const { return _createInfo.getDescriptorSetLayout(); }
+
+	/// <summary>Get the minimum size of a block of update data for this template</summary>
+	/// <returns>The size in bytes of a block of update data</returns>
+	size_t getDataSize() const { return _createInfo.getDataSize(); }
+
+	/// <summary>Write an image descriptor into a block of update data, at the position the template expects it.</summary>
+	/// <param name="data">The block of update data</param>
+	/// <param name="binding">The binding of the descriptor</param>
+	/// <param name="arrayIndex">The array element of the descriptor</param>
+	/// <param name="imageInfo">The image view, sampler and image layout to write</param>
+	void setImageInfo(void* data, uint32_t binding, uint32_t arrayIndex, const DescriptorImageInfo& imageInfo) const;
+
+	/// <summary>Write a buffer descriptor into a block of update data, at the position the template expects it.</summary>
+	/// <param name="data">The block of update data</param>
+	/// <param name="binding">The binding of the descriptor</param>
+	/// <param name="arrayIndex">The array element of the descriptor</param>
+	/// <param name="bufferInfo">The buffer, offset and range to write</param>
+	void setBufferInfo(void* data, uint32_t binding, uint32_t arrayIndex, const DescriptorBufferInfo& bufferInfo) const;
+
+	/// <summary>Write a texel buffer descriptor into a block of update data, at the position the template expects it.</summary>
+	/// <param name="data">The block of update data</param>
+	/// <param name="binding">The binding of the descriptor</param>
+	/// <param name="arrayIndex">The array element of the descriptor</param>
+	/// <param name="bufferView">The buffer view to write</param>
+	void setTexelBufferInfo(void* data, uint32_t binding, uint32_t arrayIndex, const BufferView& bufferView) const;
+
+	/// <summary>Get the location of a descriptor's info in a block of update data.</summary>
+	/// <param name="data">The block of update data</param>
+	/// <param name="binding">The binding of the descriptor</param>
+	/// <param name="arrayIndex">The array element of the descriptor</param>
+	/// <returns>A pointer into data, where the Vulkan info structure of the descriptor must be written</returns>
+	void* getDescriptorInfo(void* data, uint32_t binding, uint32_t arrayIndex) const;
+
+	/// <summary>Update a descriptor set with this template. Equivalent to Device_::updateDescriptorSetWithTemplate.</summary>
+	/// <param name="descriptorSet">The descriptor set to update. Must have been allocated with the layout of the template.</param>
+	/// <param name="data">The block of update data</param>
+	void update(const DescriptorSet& descriptorSet, const void* data) const;
+
+	/// <summary>Update several descriptor sets with this template, each from its own block of update data.
+	/// Equivalent to Device_::updateDescriptorSetsWithTemplate.</summary>
+	/// <param name="descriptorSets">The descriptor sets to update. Must have been allocated with the layout of the template.</param>
+	/// <param name="numDescriptorSets">The number of descriptor sets to update</param>
+	/// <param name="data">The block of update data of the first descriptor set</param>
+	/// <param name="dataStride">The distance in bytes between the blocks of update data of consecutive descriptor sets</param>
+	void update(const DescriptorSet* descriptorSets, uint32_t numDescriptorSets, const void* data, size_t dataStride) const;
+};
+} // namespace impl
+} // namespace pvrvk
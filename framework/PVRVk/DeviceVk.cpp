@@ -13,6 +13,7 @@
 #include "PVRVk/CommandPoolVk.h"
 #include "PVRVk/DescriptorSetVk.h"
 #include "PVRVk/DescriptorSetVk.h"
+#include "PVRVk/DescriptorUpdateTemplateVk.h"
 #include "PVRVk/FramebufferVk.h"
 #include "PVRVk/DeviceMemoryVk.h"
 #include "PVRVk/QueueVk.h"
@@ -341,6 +342,17 @@ void Device_::updateDescriptorSets(const WriteDescriptorSet* writeDescSets, uint
 		getVkHandle(), static_cast<uint32_t>(numWriteDescSets), vkWriteDescSets.data(), static_cast<uint32_t>(numCopyDescSets), vkCopyDescriptorSets.get());
 }
 
+void Device_::updateDescriptorSetWithTemplate(const DescriptorSet& descriptorSet, const DescriptorUpdateTemplate& descriptorUpdateTemplate, const void* data)
+{
+	descriptorUpdateTemplate->update(descriptorSet, data);
+}
+
+void Device_::updateDescriptorSetsWithTemplate(
+	const DescriptorSet* descriptorSets, uint32_t numDescriptorSets, const DescriptorUpdateTemplate& descriptorUpdateTemplate, const void* data, size_t dataStride)
+{
+	descriptorUpdateTemplate->update(descriptorSets, numDescriptorSets, data, dataStride);
+}
+
 ImageView Device_::createImageView(const ImageViewCreateInfo& createInfo)
 {
 	Device device = shared_from_this();
@@ -427,6 +439,12 @@ DescriptorPool Device_::createDescriptorPool(const DescriptorPoolCreateInfo& cre
 	return DescriptorPool_::constructShared(device, createInfo);
 }
 
+DescriptorUpdateTemplate Device_::createDescriptorUpdateTemplate(const DescriptorUpdateTemplateCreateInfo& createInfo)
+{
+	Device device = shared_from_this();
+	return DescriptorUpdateTemplate_::constructShared(device, createInfo);
+}
+
 CommandPool Device_::createCommandPool(const CommandPoolCreateInfo& createInfo)
 {
 	Device device = shared_from_this();
@@ -177,6 +177,11 @@ public:
 	/// <returns>return a valid object if success</returns>.
 	DescriptorPool createDescriptorPool(const DescriptorPoolCreateInfo& createInfo);
 
+	/// <summary>Create a Descriptor Update Template. Requires Vulkan 1.1 or the VK_KHR_descriptor_update_template extension.</summary>
+	/// <param name="createInfo">DescriptorUpdateTemplate createInfo</param>
+	/// <returns>Return a valid object if success</returns>.
+	DescriptorUpdateTemplate createDescriptorUpdateTemplate(const DescriptorUpdateTemplateCreateInfo& createInfo);
+
 	/// <summary>create Descriptor set layout</summary>
 	/// <param name="createInfo">Descriptor layout createInfo</param>
 	/// <returns>Return a valid object if success</returns>.
@@ -276,6 +281,23 @@ public:
 	/// <param name="numCopyDescSets">Number of copy descriptor sets</param>
 	void updateDescriptorSets(const WriteDescriptorSet* writeDescSets, uint32_t numWriteDescSets, const CopyDescriptorSet* copyDescSets, uint32_t numCopyDescSets);
 
+	/// <summary>Update a descriptor set from a packed block of update data laid out as described by a descriptor update template.
+	/// Performs no allocations and, unlike updateDescriptorSets, does not keep the referenced objects alive.</summary>
+	/// <param name="descriptorSet">The descriptor set to update. Must have the layout the template was created with.</param>
+	/// <param name="descriptorUpdateTemplate">The descriptor update template</param>
+	/// <param name="data">The block of update data</param>
+	void updateDescriptorSetWithTemplate(const DescriptorSet& descriptorSet, const DescriptorUpdateTemplate& descriptorUpdateTemplate, const void* data);
+
+	/// <summary>Update several descriptor sets, each from its own block of update data, with a descriptor update template.
+	/// Performs no allocations and, unlike updateDescriptorSets, does not keep the referenced objects alive.</summary>
+	/// <param name="descriptorSets">The descriptor sets to update. Must have the layout the template was created with.</param>
+	/// <param name="numDescriptorSets">The number of descriptor sets</param>
+	/// <param name="descriptorUpdateTemplate">The descriptor update template</param>
+	/// <param name="data">The block of update data of the first descriptor set</param>
+	/// <param name="dataStride">The distance in bytes between the blocks of update data of consecutive descriptor sets</param>
+	void updateDescriptorSetsWithTemplate(
+		const DescriptorSet* descriptorSets, uint32_t numDescriptorSets, const DescriptorUpdateTemplate& descriptorUpdateTemplate, const void* data, size_t dataStride);
+
 	/// <summary>Gets the device dispatch table</summary>
 	/// <returns>The device dispatch table</returns>
 	inline const VkDeviceBindings& getVkBindings() const { return _vkBindings; }
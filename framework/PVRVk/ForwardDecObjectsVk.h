@@ -25,6 +25,7 @@ class RenderPass_;
 class DescriptorSet_;
 class DescriptorSetLayout_;
 class DescriptorPool_;
+class DescriptorUpdateTemplate_;
 class CommandBufferBase_;
 class CommandBuffer_;
 class SecondaryCommandBuffer_;
@@ -53,6 +54,7 @@ class XlibSurface_;
 class WaylandSurface_;
 class MacOSSurface_;
 class DisplayPlaneSurface_;
+class HeadlessSurface_;
 class Queue_;
 class PipelineCache_;
 class Instance_;
@@ -71,6 +73,7 @@ struct DescriptorSetLayoutCreateInfo;
 struct DescriptorPoolCreateInfo;
 struct WriteDescriptorSet;
 struct CopyDescriptorSet;
+struct DescriptorUpdateTemplateCreateInfo;
 struct PipelineLayoutCreateInfo;
 struct SwapchainCreateInfo;
 struct DeviceQueueCreateInfo;
@@ -158,6 +161,9 @@ typedef std::shared_ptr<impl::ImageView_> ImageView;
 /// and the need to lock between them.</summary>
 typedef std::shared_ptr<impl::DescriptorPool_> DescriptorPool;
 
+/// <summary>A Descriptor Update Template describes how to update a DescriptorSet of a specific layout from a packed block of memory.</summary>
+typedef std::shared_ptr<impl::DescriptorUpdateTemplate_> DescriptorUpdateTemplate;
+
 /// <summary>A CommandBuffer(Base) represents a std::string of commands that will be submitted to the GPU in a batch.</summary>
 typedef std::shared_ptr<impl::CommandBufferBase_> CommandBufferBase;
 
@@ -212,6 +218,9 @@ typedef std::shared_ptr<impl::MacOSSurface_> MacOSSurface;
 /// <summary>Forwared-declared reference-counted handle to a DisplayPlaneSurface. For detailed documentation, see PVRVk module</summary>
 typedef std::shared_ptr<impl::DisplayPlaneSurface_> DisplayPlaneSurface;
 
+/// <summary>Forwared-declared reference-counted handle to a HeadlessSurface. For detailed documentation, see PVRVk module</summary>
+typedef std::shared_ptr<impl::HeadlessSurface_> HeadlessSurface;
+
 /// <summary>Forwared-declared weak-reference-counted handle to a Surface. For detailed documentation, see PVRVk module</summary>
 typedef std::weak_ptr<impl::Surface_> SurfaceWeakPtr;
 
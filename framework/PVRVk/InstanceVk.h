@@ -248,6 +248,15 @@ public:
 		return impl::DisplayPlaneSurface_::constructShared(instance, displayMode, imageExtent, flags, planeIndex, planeStackIndex, transformFlags, globalAlpha, alphaFlags);
 	}
 
+	/// <summary>Create a Headless surface. Requires VK_EXT_headless_surface to have been enabled on the instance.</summary>
+	/// <param name="flags">A set of HeadlessSurfaceCreateFlagsEXT flags to use when creating the Headless surface</param>
+	/// <returns>Valid HeadlessSurface object if success.</returns>
+	HeadlessSurface createHeadlessSurface(HeadlessSurfaceCreateFlagsEXT flags = HeadlessSurfaceCreateFlagsEXT::e_NONE)
+	{
+		Instance instance = shared_from_this();
+		return impl::HeadlessSurface_::constructShared(instance, flags);
+	}
+
 	/// <summary>Get a list of enabled extensions which includes names and spec versions</summary>
 	/// <returns>VulkanExtensionList&</returns>
 	const VulkanExtensionList& getEnabledExtensionsList() { return _createInfo.getExtensionList(); }
@@ -308,9 +308,40 @@ public:
 
 
 typedef MemoryBarrierTemplate<pvrvk::AccessFlags> MemoryBarrier;
-typedef BufferMemoryBarrierTemplate<pvrvk::AccessFlags> BufferMemoryBarrier;
 typedef ImageMemoryBarrierTemplate<pvrvk::AccessFlags> ImageMemoryBarrier;
 
+/// <summary>A Buffer memory barrier used only for memory accesses involving a specific range of the specified
+/// buffer object. It is also used to transfer ownership of an buffer range from one queue family to another.</summary>
+class BufferMemoryBarrier : public BufferMemoryBarrierTemplate<pvrvk::AccessFlags>, public BarrierQueueFamilyIndex
+{
+public:
+	/// <summary>Constructor, zero initialization. The queue family indexes are set to VK_QUEUE_FAMILY_IGNORED.</summary>
+	BufferMemoryBarrier() : BarrierQueueFamilyIndex(static_cast<uint32_t>(-1), static_cast<uint32_t>(-1)) {}
+
+	/// <summary>Constructor, individual elements. The queue family indexes are set to VK_QUEUE_FAMILY_IGNORED.</summary>
+	/// <param name="srcAccessMask">Bitmask of pvrvk::AccessFlagBits specifying a source access mask.</param>
+	/// <param name="dstAccessMask">Bitmask of pvrvk::AccessFlagBits specifying a destination access mask.</param>
+	/// <param name="buffer">Handle to the buffer whose backing memory is affected by the barrier.</param>
+	/// <param name="offset">Offset in bytes into the backing memory for buffer. This is relative to the base offset as bound to the buffer</param>
+	/// <param name="size">Size in bytes of the affected area of backing memory for buffer, or VK_WHOLE_SIZE to use the range from offset to the end of the buffer.</param>
+	BufferMemoryBarrier(pvrvk::AccessFlags srcAccessMask, pvrvk::AccessFlags dstAccessMask, Buffer buffer, uint32_t offset, uint32_t size)
+		: BufferMemoryBarrierTemplate(srcAccessMask, dstAccessMask, buffer, offset, size), BarrierQueueFamilyIndex(static_cast<uint32_t>(-1), static_cast<uint32_t>(-1))
+	{}
+
+	/// <summary>Constructor, individual elements, for a queue family ownership transfer.</summary>
+	/// <param name="srcAccessMask">Bitmask of pvrvk::AccessFlagBits specifying a source access mask.</param>
+	/// <param name="dstAccessMask">Bitmask of pvrvk::AccessFlagBits specifying a destination access mask.</param>
+	/// <param name="buffer">Handle to the buffer whose backing memory is affected by the barrier.</param>
+	/// <param name="offset">Offset in bytes into the backing memory for buffer. This is relative to the base offset as bound to the buffer</param>
+	/// <param name="size">Size in bytes of the affected area of backing memory for buffer, or VK_WHOLE_SIZE to use the range from offset to the end of the buffer.</param>
+	/// <param name="srcQueueFamilyIndexParam">Source queue family for a queue family ownership transfer.</param>
+	/// <param name="dstQueueFamilyIndexParam">Destination queue family for a queue family ownership transfer</param>
+	BufferMemoryBarrier(pvrvk::AccessFlags srcAccessMask, pvrvk::AccessFlags dstAccessMask, Buffer buffer, uint32_t offset, uint32_t size, uint32_t srcQueueFamilyIndexParam,
+		uint32_t dstQueueFamilyIndexParam)
+		: BufferMemoryBarrierTemplate(srcAccessMask, dstAccessMask, buffer, offset, size), BarrierQueueFamilyIndex(srcQueueFamilyIndexParam, dstQueueFamilyIndexParam)
+	{}
+};
+
 
 /// <summary>Templatized utility function to hold all the memory, barrier and image barriers for both usual and VK_KHR_synchronization2 structs.</summary>
 template<class MemoryBarrierType, class BufferMemoryBarrierType, class ImageMemoryBarrierType>
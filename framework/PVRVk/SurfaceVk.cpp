@@ -208,6 +208,23 @@ DisplayPlaneSurface_::DisplayPlaneSurface_(make_shared_enabler, Instance& instan
 		throw ErrorUnknown("Display Plane Platform Surface extensions have not been enabled when creating the VkInstance.");
 	}
 }
+
+HeadlessSurface_::HeadlessSurface_(make_shared_enabler, Instance& instance, HeadlessSurfaceCreateFlagsEXT flags) : Surface_(instance), _flags(flags)
+{
+	if (instance->getEnabledExtensionTable().extHeadlessSurfaceEnabled)
+	{
+		// Create a Headless Surface
+		VkHeadlessSurfaceCreateInfoEXT surfaceCreateInfo = {};
+		surfaceCreateInfo.sType = static_cast<VkStructureType>(StructureType::e_HEADLESS_SURFACE_CREATE_INFO_EXT);
+		surfaceCreateInfo.flags = static_cast<VkHeadlessSurfaceCreateFlagsEXT>(_flags);
+
+		vkThrowIfFailed(instance->getVkBindings().vkCreateHeadlessSurfaceEXT(instance->getVkHandle(), &surfaceCreateInfo, nullptr, &_vkHandle), "Could not create Headless Surface");
+	}
+	else
+	{
+		throw ErrorUnknown("Headless Surface extensions have not been enabled when creating the VkInstance.");
+	}
+}
 //!\endcond
 } // namespace impl
 } // namespace pvrvk
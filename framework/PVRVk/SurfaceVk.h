@@ -343,5 +343,37 @@ public:
 	/// <returns>Extent2D&</returns>
 	const Extent2D& getImageExtent() const { return _imageExtent; }
 };
+
+/// <summary>A Headless Surface. Presenting to it does not display anything, but it allows a swapchain to be used
+/// on implementations and machines without a window system, for example for offscreen testing.</summary>
+class HeadlessSurface_ : public Surface_
+{
+private:
+	friend class Instance_;
+
+	class make_shared_enabler
+	{
+	protected:
+		make_shared_enabler() {}
+		friend HeadlessSurface_;
+	};
+
+	static HeadlessSurface constructShared(Instance& instance, HeadlessSurfaceCreateFlagsEXT flags = HeadlessSurfaceCreateFlagsEXT::e_NONE)
+	{
+		return std::make_shared<HeadlessSurface_>(make_shared_enabler{}, instance, flags);
+	}
+
+	HeadlessSurfaceCreateFlagsEXT _flags;
+
+public:
+	//!\cond NO_DOXYGEN
+	DECLARE_NO_COPY_SEMANTICS(HeadlessSurface_)
+	HeadlessSurface_(make_shared_enabler, Instance& instance, HeadlessSurfaceCreateFlagsEXT flags);
+	//!\endcond
+
+	/// <summary>Get HeadlessSurfaceCreateFlagsEXT flags</summary>
+	/// <returns>HeadlessSurfaceCreateFlagsEXT&</returns>
+	const HeadlessSurfaceCreateFlagsEXT& getFlags() const { return _flags; }
+};
 } // namespace impl
 } // namespace pvrvk
@@ -61,6 +61,13 @@ bool TimelineSemaphore_::wait(const uint64_t& waitValue, uint64_t timeoutNanos)
 	vkThrowIfError(res);
 	return (res == Result::e_SUCCESS);
 }
+
+uint64_t TimelineSemaphore_::getCounterValue() const
+{
+	uint64_t value = 0;
+	vkThrowIfFailed(getDevice()->getVkBindings().vkGetSemaphoreCounterValueKHR(getDevice()->getVkHandle(), getVkHandle(), &value), "Failed to get the Semaphore counter value");
+	return value;
+}
 //!\endcond
 } // namespace impl
 } // namespace pvrvk
@@ -40,6 +40,10 @@ public:
 
 	// <summary> Host waits for semaphore /summary>
 	bool wait(const uint64_t& waitValue, uint64_t timeoutNanos = static_cast<uint64_t>(-1));
+
+	/// <summary>Get the current value of the semaphore, without waiting</summary>
+	/// <returns>The largest value signalled so far</returns>
+	uint64_t getCounterValue() const;
 };
 } // namespace impl
 /// <summary>Timeline Semaphore submit info. Contains the information on timeline semaphores</summary>